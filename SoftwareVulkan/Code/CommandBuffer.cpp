@@ -0,0 +1,736 @@
+#include "CommandBuffer.h"
+#include <string.h>
+
+//Dispatches are split into at most this many jobs, each a contiguous run of workgroups
+#define COMMAND_DISPATCH_JOBS 256
+
+/*
+================================================
+commandPool_t
+================================================
+*/
+void CommandPool_Init( commandPool_t * pool ) {
+	HostArena_Init( &pool->arena, false );
+	pool->pFreeChunks = NULL;
+	pool->generation = 0;
+}
+
+void CommandPool_Shutdown( commandPool_t * pool ) {
+	HostArena_Destroy( &pool->arena );
+	pool->pFreeChunks = NULL;
+	pool->generation = 0;
+}
+
+void CommandPool_Reset( commandPool_t * pool ) {
+	HostArena_Reset( &pool->arena );
+	pool->pFreeChunks = NULL;
+	pool->generation++;
+}
+
+/*
+================================================
+Recording
+================================================
+*/
+static void CommandBuffer_Clear( commandBuffer_t * commandBuffer ) {
+	commandBuffer->generation = commandBuffer->pool->generation;
+	commandBuffer->pFirstChunk = NULL;
+	commandBuffer->pLastChunk = NULL;
+	commandBuffer->pCursor = NULL;
+	commandBuffer->pLimit = NULL;
+	commandBuffer->outOfMemory = false;
+	commandBuffer->bindingsDirty = true;
+	commandBuffer->graphicsPipeline = NULL;
+	commandBuffer->computePipeline = NULL;
+	memset( commandBuffer->pDescriptorSets, 0, sizeof( commandBuffer->pDescriptorSets ) );
+	memset( commandBuffer->pVertexBuffers, 0, sizeof( commandBuffer->pVertexBuffers ) );
+	commandBuffer->pIndexBuffer = NULL;
+	commandBuffer->indexType = VK_INDEX_TYPE_UINT32;
+	commandBuffer->pushConstantSize = 0;
+}
+
+void CommandBuffer_Init( commandBuffer_t * commandBuffer, commandPool_t * pool ) {
+	memset( commandBuffer, 0, sizeof( commandBuffer_t ) );
+	commandBuffer->pool = pool;
+	CommandBuffer_Clear( commandBuffer );
+}
+
+void CommandBuffer_Reset( commandBuffer_t * commandBuffer ) {
+	commandPool_t * pool = commandBuffer->pool;
+	//Chunks from before the last pool reset are already gone with the arena
+	if ( commandBuffer->generation == pool->generation ) {
+		commandChunk_t * chunk = commandBuffer->pFirstChunk;
+		while ( chunk != NULL ) {
+			commandChunk_t * pNext = chunk->pNext;
+			if ( chunk->recyclable ) {
+				chunk->pNext = pool->pFreeChunks;
+				pool->pFreeChunks = chunk;
+			}
+			chunk = pNext;
+		}
+	}
+	CommandBuffer_Clear( commandBuffer );
+}
+
+void CommandBuffer_Begin( commandBuffer_t * commandBuffer ) {
+	CommandBuffer_Reset( commandBuffer );
+}
+
+VkResult CommandBuffer_End( commandBuffer_t * commandBuffer ) {
+	CommandBuffer_Emit( commandBuffer, commandOp_t::END, sizeof( commandHeader_t ) );
+	return commandBuffer->outOfMemory ? VK_ERROR_OUT_OF_HOST_MEMORY : VK_SUCCESS;
+}
+
+bool CommandBuffer_IsRecorded( const commandBuffer_t * commandBuffer ) {
+	return commandBuffer->generation == commandBuffer->pool->generation && commandBuffer->pFirstChunk != NULL && !commandBuffer->outOfMemory;
+}
+
+//Starts a new chunk, chained from the current one by a JUMP, then emits into it
+void * CommandBuffer_EmitSlow( commandBuffer_t * commandBuffer, commandOp_t op, uint32 size ) {
+	if ( commandBuffer->outOfMemory ) {
+		return NULL;
+	}
+	commandPool_t * pool = commandBuffer->pool;
+	const size_t needed = sizeof( commandChunk_t ) + size + sizeof( commandJump_t );
+	const size_t chunkSize = ( needed > COMMAND_CHUNK_SIZE ) ? needed : COMMAND_CHUNK_SIZE;
+	commandChunk_t * chunk = NULL;
+	if ( chunkSize == COMMAND_CHUNK_SIZE && pool->pFreeChunks != NULL ) {
+		chunk = pool->pFreeChunks;
+		pool->pFreeChunks = chunk->pNext;
+	} else {
+		chunk = reinterpret_cast< commandChunk_t * >( HostArena_Allocate( &pool->arena, chunkSize, 64 ) );
+	}
+	if ( chunk == NULL ) {
+		commandBuffer->outOfMemory = true;
+		return NULL;
+	}
+	chunk->pNext = NULL;
+	chunk->size = ( uint32 )chunkSize;
+	chunk->recyclable = ( chunkSize == COMMAND_CHUNK_SIZE );
+
+	uint8 * pBegin = reinterpret_cast< uint8 * >( chunk + 1 );
+	if ( commandBuffer->pLastChunk != NULL ) {
+		commandJump_t * jump = reinterpret_cast< commandJump_t * >( commandBuffer->pCursor );
+		jump->header.op = commandOp_t::JUMP;
+		jump->header.size = sizeof( commandJump_t );
+		jump->pNext = pBegin;
+		commandBuffer->pLastChunk->pNext = chunk;
+	} else {
+		commandBuffer->pFirstChunk = chunk;
+	}
+	commandBuffer->pLastChunk = chunk;
+	commandBuffer->pCursor = pBegin;
+	commandBuffer->pLimit = reinterpret_cast< uint8 * >( chunk ) + chunkSize - sizeof( commandJump_t );
+	return CommandBuffer_Emit( commandBuffer, op, size );
+}
+
+void CommandBuffer_BeginRenderPass( commandBuffer_t * commandBuffer, const rasterTarget_t & target, const VkRect2D & renderArea, const float * pClearColor, const float * pClearDepth, const uint32 * pClearStencil ) {
+	commandBeginRenderPass_t * command = CommandBuffer_Emit< commandBeginRenderPass_t >( commandBuffer, commandOp_t::BEGIN_RENDER_PASS );
+	if ( command == NULL ) {
+		return;
+	}
+	command->target = target;
+	command->renderArea = renderArea;
+	command->clearColor = ( pClearColor != NULL );
+	command->clearDepth = ( pClearDepth != NULL );
+	command->clearStencil = ( pClearStencil != NULL );
+	if ( pClearColor != NULL ) {
+		memcpy( command->color, pClearColor, sizeof( command->color ) );
+	}
+	command->depth = ( pClearDepth != NULL ) ? *pClearDepth : 0.0f;
+	command->stencil = ( pClearStencil != NULL ) ? *pClearStencil : 0;
+	//Images the previous pass rendered to may be sampled in this one, so their pending clears are looked at again
+	commandBuffer->bindingsDirty = true;
+}
+
+void CommandBuffer_EndRenderPass( commandBuffer_t * commandBuffer ) {
+	CommandBuffer_Emit( commandBuffer, commandOp_t::END_RENDER_PASS, sizeof( commandHeader_t ) );
+	commandBuffer->bindingsDirty = true;
+}
+
+void CommandBuffer_BindGraphicsPipeline( commandBuffer_t * commandBuffer, const graphicsPipeline_t * pipeline ) {
+	commandBindGraphicsPipeline_t * command = CommandBuffer_Emit< commandBindGraphicsPipeline_t >( commandBuffer, commandOp_t::BIND_GRAPHICS_PIPELINE );
+	if ( command != NULL ) {
+		command->pipeline = pipeline;
+	}
+	commandBuffer->graphicsPipeline = pipeline;
+	commandBuffer->bindingsDirty = true;
+}
+
+void CommandBuffer_BindComputePipeline( commandBuffer_t * commandBuffer, const computePipeline_t * pipeline ) {
+	commandBindComputePipeline_t * command = CommandBuffer_Emit< commandBindComputePipeline_t >( commandBuffer, commandOp_t::BIND_COMPUTE_PIPELINE );
+	if ( command != NULL ) {
+		command->pipeline = pipeline;
+	}
+	commandBuffer->computePipeline = pipeline;
+	commandBuffer->bindingsDirty = true;
+}
+
+void CommandBuffer_SetViewport( commandBuffer_t * commandBuffer, const VkViewport & viewport ) {
+	commandSetViewport_t * command = CommandBuffer_Emit< commandSetViewport_t >( commandBuffer, commandOp_t::SET_VIEWPORT );
+	if ( command != NULL ) {
+		command->viewport = viewport;
+	}
+}
+
+void CommandBuffer_SetScissor( commandBuffer_t * commandBuffer, const VkRect2D & scissor ) {
+	commandSetScissor_t * command = CommandBuffer_Emit< commandSetScissor_t >( commandBuffer, commandOp_t::SET_SCISSOR );
+	if ( command != NULL ) {
+		command->scissor = scissor;
+	}
+}
+
+void CommandBuffer_BindVertexBuffers( commandBuffer_t * commandBuffer, uint32 firstBinding, uint32 bindingCount, const uint8 * const * ppData ) {
+	for ( uint32 i = 0; i < bindingCount && firstBinding + i < PIPELINE_MAX_VERTEX_BINDINGS; i++ ) {
+		commandBuffer->pVertexBuffers[ firstBinding + i ] = ppData[ i ];
+	}
+	commandBuffer->bindingsDirty = true;
+}
+
+void CommandBuffer_BindDescriptorSets( commandBuffer_t * commandBuffer, VkPipelineBindPoint bindPoint, uint32 firstSet, uint32 setCount, const descriptorSet_t * const * ppSets, uint32 dynamicOffsetCount, const uint32 * pDynamicOffsets ) {
+	const uint32 point = ( bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ) ? 1 : 0;
+	for ( uint32 i = 0; i < setCount && firstSet + i < COMMAND_MAX_DESCRIPTOR_SETS; i++ ) {
+		const descriptorSet_t * set = ppSets[ i ];
+		commandBuffer->pDescriptorSets[ point ][ firstSet + i ] = set;
+		const uint32 dynamicCount = ( set != NULL ) ? Min( set->dynamicCount, ( uint32 )DESCRIPTOR_MAX_DYNAMIC_BUFFERS ) : 0;
+		const uint32 taken = Min( dynamicCount, dynamicOffsetCount );
+		uint32 * pOffsets = commandBuffer->dynamicOffsets[ point ][ firstSet + i ];
+		memcpy( pOffsets, pDynamicOffsets, sizeof( uint32 ) * taken );
+		memset( pOffsets + taken, 0, sizeof( uint32 ) * ( DESCRIPTOR_MAX_DYNAMIC_BUFFERS - taken ) );
+		pDynamicOffsets += taken;
+		dynamicOffsetCount -= taken;
+	}
+	commandBuffer->bindingsDirty = true;
+}
+
+void CommandBuffer_BindIndexBuffer( commandBuffer_t * commandBuffer, const uint8 * pData, VkIndexType indexType ) {
+	commandBuffer->pIndexBuffer = pData;
+	commandBuffer->indexType = indexType;
+}
+
+void CommandBuffer_PushConstants( commandBuffer_t * commandBuffer, uint32 offset, uint32 size, const void * pValues ) {
+	if ( offset >= COMMAND_PUSH_CONSTANT_SIZE ) {
+		return;
+	}
+	size = Min( size, COMMAND_PUSH_CONSTANT_SIZE - offset );
+	memcpy( commandBuffer->pushConstants + offset, pValues, size );
+	commandBuffer->pushConstantSize = Max( commandBuffer->pushConstantSize, offset + size );
+	commandBuffer->bindingsDirty = true;
+}
+
+//Where a snapshot's arrays go; every pointer is NULL on the pass that only counts
+struct commandSlotWriter_t {
+	shaderResource_t *			pSlots;
+	const void **				ppElements;			//of dynamic buffers, pointing at pViews
+	shaderBufferView_t *		pViews;
+	const sampledImage_t **		ppResolves;
+	uint32						slotCount;
+	uint32						dynamicCount;
+	uint32						resolveCount;
+};
+
+static void CommandBuffer_AddResolve( commandSlotWriter_t * writer, const sampledImage_t * image ) {
+	if ( writer->ppResolves == NULL ) {
+		writer->resolveCount++;
+		return;
+	}
+	for ( uint32 i = 0; i < writer->resolveCount; i++ ) {
+		if ( writer->ppResolves[ i ] == image ) {
+			return;
+		}
+	}
+	writer->ppResolves[ writer->resolveCount++ ] = image;
+}
+
+//One slot per binding of the program, looked up by set and binding number in the sets bound to point
+static void CommandBuffer_WriteSlots( const commandBuffer_t * commandBuffer, uint32 point, const shaderProgram_t * program, commandSlotWriter_t * writer, shaderResources_t * pResources ) {
+	pResources->pSlots = ( writer->pSlots != NULL ) ? writer->pSlots + writer->slotCount : NULL;
+	for ( uint32 i = 0; i < program->bindingCount; i++ ) {
+		const shaderBinding_t & binding = program->pBindings[ i ];
+		const descriptorSet_t * set = ( binding.set < COMMAND_MAX_DESCRIPTOR_SETS ) ? commandBuffer->pDescriptorSets[ point ][ binding.set ] : NULL;
+		const descriptorLayoutBinding_t * layoutBinding = ( set != NULL ) ? DescriptorSet_FindBinding( set, binding.binding ) : NULL;
+		shaderResource_t resource = { NULL, 0 };
+		if ( layoutBinding != NULL ) {
+			resource = set->pResources[ layoutBinding - set->pBindings ];
+			const descriptorElement_t * pElements = set->pElements + layoutBinding->firstElement;
+			if ( DescriptorSet_IsDynamic( layoutBinding->type ) ) {
+				//The offset moves the window; keeping it inside the buffer is the application's part
+				const uint32 * pOffsets = commandBuffer->dynamicOffsets[ point ][ binding.set ];
+				for ( uint32 e = 0; e < layoutBinding->count && writer->pViews != NULL; e++ ) {
+					shaderBufferView_t & view = writer->pViews[ writer->dynamicCount + e ];
+					view = pElements[ e ].buffer;
+					if ( view.data != NULL && layoutBinding->firstDynamic + e < DESCRIPTOR_MAX_DYNAMIC_BUFFERS ) {
+						view.data += pOffsets[ layoutBinding->firstDynamic + e ];
+					}
+					writer->ppElements[ writer->dynamicCount + e ] = &view;
+				}
+				resource.ppElements = ( writer->ppElements != NULL ) ? writer->ppElements + writer->dynamicCount : NULL;
+				writer->dynamicCount += layoutBinding->count;
+			} else if ( layoutBinding->type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || layoutBinding->type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ) {
+				for ( uint32 e = 0; e < layoutBinding->count; e++ ) {
+					const sampledImage_t * image = pElements[ e ].image.image;
+					if ( image != NULL && image->clearState != NULL ) {
+						CommandBuffer_AddResolve( writer, image );
+					}
+				}
+			}
+		}
+		if ( writer->pSlots != NULL ) {
+			writer->pSlots[ writer->slotCount ] = resource;
+		}
+		writer->slotCount++;
+	}
+}
+
+//Binds change far less often than draws, so the snapshot is only written when something changed.  Descriptor sets
+//may not be updated once bound, so their elements are read here and only dynamic buffers need copies
+static void CommandBuffer_FlushBindings( commandBuffer_t * commandBuffer ) {
+	if ( !commandBuffer->bindingsDirty ) {
+		return;
+	}
+	const graphicsPipeline_t * graphics = commandBuffer->graphicsPipeline;
+	const computePipeline_t * compute = commandBuffer->computePipeline;
+	const shaderProgram_t * programs[ 3 ] = {
+		( graphics != NULL ) ? &graphics->vertexProgram : NULL,
+		( graphics != NULL ) ? &graphics->fragmentProgram : NULL,
+		( compute != NULL ) ? &compute->program : NULL
+	};
+	const uint32 points[ 3 ] = { 0, 0, 1 };
+
+	commandSlotWriter_t writer;
+	memset( &writer, 0, sizeof( writer ) );
+	shaderResources_t counted;
+	for ( uint32 p = 0; p < ARRAY_LENGTH( programs ); p++ ) {
+		if ( programs[ p ] != NULL ) {
+			CommandBuffer_WriteSlots( commandBuffer, points[ p ], programs[ p ], &writer, &counted );
+		}
+	}
+	const uint32 slotsOffset = sizeof( commandBindings_t ) + ( ( commandBuffer->pushConstantSize + 7 ) & ~7U );
+	const uint32 elementsOffset = slotsOffset + sizeof( shaderResource_t ) * writer.slotCount;
+	const uint32 viewsOffset = elementsOffset + sizeof( const void * ) * writer.dynamicCount;
+	const uint32 resolvesOffset = viewsOffset + sizeof( shaderBufferView_t ) * writer.dynamicCount;
+	const uint32 size = resolvesOffset + sizeof( const sampledImage_t * ) * writer.resolveCount;
+	commandBindings_t * command = reinterpret_cast< commandBindings_t * >( CommandBuffer_Emit( commandBuffer, commandOp_t::BINDINGS, size ) );
+	if ( command == NULL ) {
+		return;
+	}
+	uint8 * pBase = reinterpret_cast< uint8 * >( command );
+	uint8 * pPushConstants = reinterpret_cast< uint8 * >( command + 1 );
+	memcpy( pPushConstants, commandBuffer->pushConstants, commandBuffer->pushConstantSize );
+	memcpy( command->graphics.pVertexBuffers, commandBuffer->pVertexBuffers, sizeof( command->graphics.pVertexBuffers ) );
+	shaderResources_t resources;
+	resources.pSlots = NULL;
+	resources.pPushConstants = pPushConstants;
+	resources.pushConstantSize = commandBuffer->pushConstantSize;
+	resources.sample = Sampler_Sample;
+	command->graphics.vertexResources = resources;
+	command->graphics.fragmentResources = resources;
+	command->compute = resources;
+
+	memset( &writer, 0, sizeof( writer ) );
+	writer.pSlots = reinterpret_cast< shaderResource_t * >( pBase + slotsOffset );
+	writer.ppElements = reinterpret_cast< const void ** >( pBase + elementsOffset );
+	writer.pViews = reinterpret_cast< shaderBufferView_t * >( pBase + viewsOffset );
+	writer.ppResolves = reinterpret_cast< const sampledImage_t ** >( pBase + resolvesOffset );
+	shaderResources_t * pTargets[ 3 ] = { &command->graphics.vertexResources, &command->graphics.fragmentResources, &command->compute };
+	for ( uint32 p = 0; p < ARRAY_LENGTH( programs ); p++ ) {
+		if ( programs[ p ] != NULL ) {
+			CommandBuffer_WriteSlots( commandBuffer, points[ p ], programs[ p ], &writer, pTargets[ p ] );
+		}
+	}
+	command->ppResolves = writer.ppResolves;
+	command->resolveCount = writer.resolveCount;
+	commandBuffer->bindingsDirty = false;
+}
+
+void CommandBuffer_Draw( commandBuffer_t * commandBuffer, uint32 vertexCount, uint32 instanceCount, uint32 firstVertex, uint32 firstInstance ) {
+	CommandBuffer_FlushBindings( commandBuffer );
+	commandDraw_t * command = CommandBuffer_Emit< commandDraw_t >( commandBuffer, commandOp_t::DRAW );
+	if ( command == NULL ) {
+		return;
+	}
+	command->vertexCount = vertexCount;
+	command->instanceCount = instanceCount;
+	command->firstVertex = firstVertex;
+	command->firstInstance = firstInstance;
+}
+
+void CommandBuffer_DrawIndexed( commandBuffer_t * commandBuffer, uint32 indexCount, uint32 instanceCount, uint32 firstIndex, int32 vertexOffset, uint32 firstInstance ) {
+	CommandBuffer_FlushBindings( commandBuffer );
+	commandDrawIndexed_t * command = CommandBuffer_Emit< commandDrawIndexed_t >( commandBuffer, commandOp_t::DRAW_INDEXED );
+	if ( command == NULL ) {
+		return;
+	}
+	command->pIndices = commandBuffer->pIndexBuffer;
+	command->indexType = commandBuffer->indexType;
+	command->indexCount = indexCount;
+	command->instanceCount = instanceCount;
+	command->firstIndex = firstIndex;
+	command->vertexOffset = vertexOffset;
+	command->firstInstance = firstInstance;
+}
+
+static void CommandBuffer_EmitIndirect( commandBuffer_t * commandBuffer, commandOp_t op, const uint8 * pArguments, uint32 drawCount, uint32 stride, const uint8 * pCount ) {
+	CommandBuffer_FlushBindings( commandBuffer );
+	commandDrawIndirect_t * command = CommandBuffer_Emit< commandDrawIndirect_t >( commandBuffer, op );
+	if ( command == NULL ) {
+		return;
+	}
+	command->pArguments = pArguments;
+	command->pCount = pCount;
+	command->drawCount = drawCount;
+	command->stride = stride;
+	command->pIndices = commandBuffer->pIndexBuffer;
+	command->indexType = commandBuffer->indexType;
+}
+
+void CommandBuffer_DrawIndirect( commandBuffer_t * commandBuffer, const uint8 * pArguments, uint32 drawCount, uint32 stride, const uint8 * pCount ) {
+	CommandBuffer_EmitIndirect( commandBuffer, commandOp_t::DRAW_INDIRECT, pArguments, drawCount, stride, pCount );
+}
+
+void CommandBuffer_DrawIndexedIndirect( commandBuffer_t * commandBuffer, const uint8 * pArguments, uint32 drawCount, uint32 stride, const uint8 * pCount ) {
+	CommandBuffer_EmitIndirect( commandBuffer, commandOp_t::DRAW_INDEXED_INDIRECT, pArguments, drawCount, stride, pCount );
+}
+
+void CommandBuffer_Dispatch( commandBuffer_t * commandBuffer, uint32 groupCountX, uint32 groupCountY, uint32 groupCountZ ) {
+	CommandBuffer_FlushBindings( commandBuffer );
+	commandDispatch_t * command = CommandBuffer_Emit< commandDispatch_t >( commandBuffer, commandOp_t::DISPATCH );
+	if ( command == NULL ) {
+		return;
+	}
+	command->groupCount[ 0 ] = groupCountX;
+	command->groupCount[ 1 ] = groupCountY;
+	command->groupCount[ 2 ] = groupCountZ;
+}
+
+void CommandBuffer_CopyBuffer( commandBuffer_t * commandBuffer, const uint8 * pSource, uint8 * pDestination, uint64 size ) {
+	commandCopyBuffer_t * command = CommandBuffer_Emit< commandCopyBuffer_t >( commandBuffer, commandOp_t::COPY_BUFFER );
+	if ( command == NULL ) {
+		return;
+	}
+	command->pSource = pSource;
+	command->pDestination = pDestination;
+	command->size = size;
+}
+
+void CommandBuffer_FillBuffer( commandBuffer_t * commandBuffer, uint8 * pDestination, uint64 size, uint32 data ) {
+	commandFillBuffer_t * command = CommandBuffer_Emit< commandFillBuffer_t >( commandBuffer, commandOp_t::FILL_BUFFER );
+	if ( command == NULL ) {
+		return;
+	}
+	command->pDestination = pDestination;
+	command->size = size;
+	command->data = data;
+}
+
+void CommandBuffer_UpdateBuffer( commandBuffer_t * commandBuffer, uint8 * pDestination, uint64 size, const void * pData ) {
+	commandUpdateBuffer_t * command = reinterpret_cast< commandUpdateBuffer_t * >( CommandBuffer_Emit( commandBuffer, commandOp_t::UPDATE_BUFFER, sizeof( commandUpdateBuffer_t ) + ( uint32 )size ) );
+	if ( command == NULL ) {
+		return;
+	}
+	command->pDestination = pDestination;
+	command->size = size;
+	memcpy( command + 1, pData, ( size_t )size );
+}
+
+void CommandBuffer_CopyImageToBuffer( commandBuffer_t * commandBuffer, const imageLayout_t * layout, const imageClearState_t * clearState, const uint8 * pImage, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, uint8 * pDestination, uint64 rowPitch, uint64 depthPitch ) {
+	commandCopyImageToBuffer_t * command = CommandBuffer_Emit< commandCopyImageToBuffer_t >( commandBuffer, commandOp_t::COPY_IMAGE_TO_BUFFER );
+	if ( command == NULL ) {
+		return;
+	}
+	command->layout = layout;
+	command->clearState = clearState;
+	command->pImage = pImage;
+	command->mipLevel = mipLevel;
+	command->arrayLayer = arrayLayer;
+	command->offset = offset;
+	command->extent = extent;
+	command->pDestination = pDestination;
+	command->rowPitch = rowPitch;
+	command->depthPitch = depthPitch;
+}
+
+void CommandBuffer_CopyBufferToImage( commandBuffer_t * commandBuffer, const imageLayout_t * layout, imageClearState_t * clearState, uint8 * pImage, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, const uint8 * pSource, uint64 rowPitch, uint64 depthPitch ) {
+	commandCopyBufferToImage_t * command = CommandBuffer_Emit< commandCopyBufferToImage_t >( commandBuffer, commandOp_t::COPY_BUFFER_TO_IMAGE );
+	if ( command == NULL ) {
+		return;
+	}
+	command->layout = layout;
+	command->clearState = clearState;
+	command->pImage = pImage;
+	command->mipLevel = mipLevel;
+	command->arrayLayer = arrayLayer;
+	command->offset = offset;
+	command->extent = extent;
+	command->pSource = pSource;
+	command->rowPitch = rowPitch;
+	command->depthPitch = depthPitch;
+}
+
+void CommandBuffer_BlitImage( commandBuffer_t * commandBuffer, const imageBlitSurface_t & src, imageClearState_t * srcClearState, const imageBlitSurface_t & dst, imageClearState_t * dstClearState, VkFilter filter ) {
+	commandBlitImage_t * command = CommandBuffer_Emit< commandBlitImage_t >( commandBuffer, commandOp_t::BLIT_IMAGE );
+	if ( command == NULL ) {
+		return;
+	}
+	command->src = src;
+	command->dst = dst;
+	command->srcClearState = srcClearState;
+	command->dstClearState = dstClearState;
+	command->filter = filter;
+}
+
+/*
+================================================
+Replay
+================================================
+*/
+struct commandDispatchJob_t {
+	const computePipeline_t *	pipeline;
+	const shaderResources_t *	resources;
+	uint32						groupCount[ 3 ];
+	uint64						groupTotal;
+	uint32						jobCount;
+};
+
+static void Command_DispatchJob( void * pData, uint32 index, uint32 workerIndex ) {
+	const commandDispatchJob_t * dispatch = reinterpret_cast< const commandDispatchJob_t * >( pData );
+	const uint64 first = dispatch->groupTotal * index / dispatch->jobCount;
+	const uint64 end = dispatch->groupTotal * ( index + 1 ) / dispatch->jobCount;
+	ComputePipeline_RunWorkgroups( dispatch->pipeline, workerIndex, first, end, dispatch->groupCount, dispatch->resources );
+}
+
+static void Command_Dispatch( threadPool_t * pool, const computePipeline_t * pipeline, const shaderResources_t * resources, const uint32 groupCount[ 3 ] ) {
+	commandDispatchJob_t dispatch;
+	dispatch.pipeline = pipeline;
+	dispatch.resources = resources;
+	memcpy( dispatch.groupCount, groupCount, sizeof( dispatch.groupCount ) );
+	dispatch.groupTotal = ( uint64 )groupCount[ 0 ] * groupCount[ 1 ] * groupCount[ 2 ];
+	if ( dispatch.groupTotal == 0 ) {
+		return;
+	}
+	//A few jobs per thread so stealing can even out workgroups of uneven cost
+	const uint64 jobCount = ( uint64 )ThreadPool_Concurrency( pool ) * 4;
+	dispatch.jobCount = ( uint32 )( ( jobCount < dispatch.groupTotal ) ? jobCount : dispatch.groupTotal );
+	dispatch.jobCount = Min( dispatch.jobCount, ( uint32 )COMMAND_DISPATCH_JOBS );
+	job_t jobs[ COMMAND_DISPATCH_JOBS ];
+	ThreadPool_ParallelFor( pool, jobs, dispatch.jobCount, Command_DispatchJob, &dispatch );
+}
+
+static void Command_Fill( uint8 * pDestination, uint64 size, uint32 data ) {
+	uint32 * pWords = reinterpret_cast< uint32 * >( pDestination );
+	for ( uint64 i = 0; i < size / sizeof( uint32 ); i++ ) {
+		pWords[ i ] = data;
+	}
+}
+
+//Every draw goes to the rasterizer as its own draw; the front end packs small ones into shared chunks
+static void Command_DrawIndirect( rasterizer_t * rasterizer, const commandDrawIndirect_t * command, rasterDraw_t * draw ) {
+	uint32 drawCount = command->drawCount;
+	if ( command->pCount != NULL ) {
+		uint32 count;
+		memcpy( &count, command->pCount, sizeof( count ) );
+		drawCount = Min( drawCount, count );
+	}
+	const uint8 * pArguments = command->pArguments;
+	if ( command->header.op == commandOp_t::DRAW_INDIRECT ) {
+		for ( uint32 i = 0; i < drawCount; i++, pArguments += command->stride ) {
+			VkDrawIndirectCommand arguments;
+			memcpy( &arguments, pArguments, sizeof( arguments ) );
+			draw->vertexCount = arguments.vertexCount;
+			draw->instanceCount = arguments.instanceCount;
+			draw->firstVertex = arguments.firstVertex;
+			draw->firstInstance = arguments.firstInstance;
+			Rasterizer_Draw( rasterizer, draw );
+		}
+		return;
+	}
+	for ( uint32 i = 0; i < drawCount; i++, pArguments += command->stride ) {
+		VkDrawIndexedIndirectCommand arguments;
+		memcpy( &arguments, pArguments, sizeof( arguments ) );
+		draw->vertexCount = arguments.indexCount;
+		draw->instanceCount = arguments.instanceCount;
+		draw->firstVertex = arguments.firstIndex;
+		draw->firstInstance = arguments.firstInstance;
+		draw->vertexOffset = arguments.vertexOffset;
+		Rasterizer_Draw( rasterizer, draw );
+	}
+}
+
+void CommandExecutor_Init( commandExecutor_t * executor, rasterizer_t * rasterizer ) {
+	executor->rasterizer = rasterizer;
+	Platform_MutexInit( &executor->renderPassLock );
+	Platform_MutexInit( &executor->dispatchLock );
+}
+
+void CommandExecutor_Shutdown( commandExecutor_t * executor ) {
+	Platform_MutexDestroy( &executor->renderPassLock );
+	Platform_MutexDestroy( &executor->dispatchLock );
+}
+
+void CommandBuffer_Execute( const commandBuffer_t * commandBuffer, commandExecutor_t * executor ) {
+	if ( !CommandBuffer_IsRecorded( commandBuffer ) ) {
+		return;
+	}
+	//Host writes since the last submission may have changed any compressed image
+	Sampler_InvalidateBlockCache();
+	rasterizer_t * rasterizer = executor->rasterizer;
+	bool inRenderPass = false;
+	const graphicsPipeline_t * graphicsPipeline = NULL;
+	const computePipeline_t * computePipeline = NULL;
+	const commandBindings_t * bindings = NULL;
+	VkViewport viewport = {};
+	VkRect2D scissor = {};
+
+	const uint8 * pCommand = reinterpret_cast< const uint8 * >( commandBuffer->pFirstChunk + 1 );
+	for ( ;; ) {
+		const commandHeader_t * header = reinterpret_cast< const commandHeader_t * >( pCommand );
+		switch ( header->op ) {
+			case commandOp_t::END:
+				if ( inRenderPass ) {
+					Rasterizer_EndPass( rasterizer );
+					Platform_MutexUnlock( &executor->renderPassLock );
+				}
+				return;
+			case commandOp_t::JUMP:
+				pCommand = reinterpret_cast< const commandJump_t * >( header )->pNext;
+				continue;
+			case commandOp_t::BEGIN_RENDER_PASS: {
+				const commandBeginRenderPass_t * command = reinterpret_cast< const commandBeginRenderPass_t * >( header );
+				if ( !inRenderPass ) {
+					Platform_MutexLock( &executor->renderPassLock );
+					inRenderPass = true;
+				} else {
+					Rasterizer_EndPass( rasterizer );
+				}
+				Rasterizer_BeginPass( rasterizer, &command->target, command->renderArea, command->clearColor ? command->color : NULL, command->clearDepth ? &command->depth : NULL, command->clearStencil ? &command->stencil : NULL );
+				break;
+			}
+			case commandOp_t::END_RENDER_PASS:
+				if ( inRenderPass ) {
+					Rasterizer_EndPass( rasterizer );
+					Platform_MutexUnlock( &executor->renderPassLock );
+					inRenderPass = false;
+				}
+				break;
+			case commandOp_t::BIND_GRAPHICS_PIPELINE:
+				graphicsPipeline = reinterpret_cast< const commandBindGraphicsPipeline_t * >( header )->pipeline;
+				break;
+			case commandOp_t::BIND_COMPUTE_PIPELINE:
+				computePipeline = reinterpret_cast< const commandBindComputePipeline_t * >( header )->pipeline;
+				break;
+			case commandOp_t::SET_VIEWPORT:
+				viewport = reinterpret_cast< const commandSetViewport_t * >( header )->viewport;
+				break;
+			case commandOp_t::SET_SCISSOR:
+				scissor = reinterpret_cast< const commandSetScissor_t * >( header )->scissor;
+				break;
+			case commandOp_t::BINDINGS:
+				bindings = reinterpret_cast< const commandBindings_t * >( header );
+				for ( uint32 i = 0; i < bindings->resolveCount; i++ ) {
+					ImageClear_Resolve( bindings->ppResolves[ i ]->clearState, bindings->ppResolves[ i ]->data );
+				}
+				break;
+			case commandOp_t::DRAW:
+			case commandOp_t::DRAW_INDEXED: {
+				if ( graphicsPipeline == NULL || bindings == NULL ) {
+					break;
+				}
+				rasterDraw_t draw;
+				draw.pipeline = &graphicsPipeline->raster;
+				draw.viewport = viewport;
+				draw.scissor = scissor;
+				draw.pBindings = &bindings->graphics;
+				if ( header->op == commandOp_t::DRAW ) {
+					const commandDraw_t * command = reinterpret_cast< const commandDraw_t * >( header );
+					draw.vertexCount = command->vertexCount;
+					draw.instanceCount = command->instanceCount;
+					draw.firstVertex = command->firstVertex;
+					draw.firstInstance = command->firstInstance;
+					draw.pIndices = NULL;
+					draw.indexType = VK_INDEX_TYPE_UINT32;
+					draw.vertexOffset = 0;
+				} else {
+					const commandDrawIndexed_t * command = reinterpret_cast< const commandDrawIndexed_t * >( header );
+					if ( command->pIndices == NULL ) {
+						break;
+					}
+					draw.vertexCount = command->indexCount;
+					draw.instanceCount = command->instanceCount;
+					draw.firstVertex = command->firstIndex;
+					draw.firstInstance = command->firstInstance;
+					draw.pIndices = command->pIndices;
+					draw.indexType = command->indexType;
+					draw.vertexOffset = command->vertexOffset;
+				}
+				Rasterizer_Draw( rasterizer, &draw );
+				break;
+			}
+			case commandOp_t::DRAW_INDIRECT:
+			case commandOp_t::DRAW_INDEXED_INDIRECT: {
+				const commandDrawIndirect_t * command = reinterpret_cast< const commandDrawIndirect_t * >( header );
+				const bool indexed = ( header->op == commandOp_t::DRAW_INDEXED_INDIRECT );
+				if ( graphicsPipeline == NULL || bindings == NULL || command->pArguments == NULL || ( indexed && command->pIndices == NULL ) ) {
+					break;
+				}
+				rasterDraw_t draw;
+				draw.pipeline = &graphicsPipeline->raster;
+				draw.viewport = viewport;
+				draw.scissor = scissor;
+				draw.pBindings = &bindings->graphics;
+				draw.pIndices = indexed ? command->pIndices : NULL;
+				draw.indexType = indexed ? command->indexType : VK_INDEX_TYPE_UINT32;
+				draw.vertexOffset = 0;
+				Command_DrawIndirect( rasterizer, command, &draw );
+				break;
+			}
+			case commandOp_t::DISPATCH:
+				if ( computePipeline != NULL && bindings != NULL ) {
+					Platform_MutexLock( &executor->dispatchLock );
+					Command_Dispatch( rasterizer->pool, computePipeline, &bindings->compute, reinterpret_cast< const commandDispatch_t * >( header )->groupCount );
+					Platform_MutexUnlock( &executor->dispatchLock );
+				}
+				break;
+			case commandOp_t::COPY_BUFFER: {
+				const commandCopyBuffer_t * command = reinterpret_cast< const commandCopyBuffer_t * >( header );
+				memcpy( command->pDestination, command->pSource, ( size_t )command->size );
+				break;
+			}
+			case commandOp_t::FILL_BUFFER: {
+				const commandFillBuffer_t * command = reinterpret_cast< const commandFillBuffer_t * >( header );
+				Command_Fill( command->pDestination, command->size, command->data );
+				break;
+			}
+			case commandOp_t::UPDATE_BUFFER: {
+				const commandUpdateBuffer_t * command = reinterpret_cast< const commandUpdateBuffer_t * >( header );
+				memcpy( command->pDestination, command + 1, ( size_t )command->size );
+				break;
+			}
+			case commandOp_t::COPY_IMAGE_TO_BUFFER: {
+				const commandCopyImageToBuffer_t * command = reinterpret_cast< const commandCopyImageToBuffer_t * >( header );
+				ImageClear_CopyToLinear( command->clearState, command->layout, command->pImage, command->mipLevel, command->arrayLayer, command->offset, command->extent, command->pDestination, command->rowPitch, command->depthPitch );
+				break;
+			}
+			case commandOp_t::COPY_BUFFER_TO_IMAGE: {
+				const commandCopyBufferToImage_t * command = reinterpret_cast< const commandCopyBufferToImage_t * >( header );
+				ImageClear_Flush( command->clearState, command->pImage, command->mipLevel, command->arrayLayer );
+				ImageLayout_CopyFromLinear( command->layout, command->pImage, command->mipLevel, command->arrayLayer, command->offset, command->extent, command->pSource, command->rowPitch, command->depthPitch );
+				if ( command->layout->blockShift != 0 ) {
+					Sampler_InvalidateBlockCache();
+				}
+				break;
+			}
+			case commandOp_t::BLIT_IMAGE: {
+				const commandBlitImage_t * command = reinterpret_cast< const commandBlitImage_t * >( header );
+				if ( command->srcClearState != NULL ) {
+					ImageClear_Resolve( command->srcClearState, command->src.data );
+				}
+				ImageClear_Flush( command->dstClearState, command->dst.data, command->dst.mipLevel, command->dst.arrayLayer );
+				ImageLayout_Blit( command->src, command->dst, command->filter );
+				break;
+			}
+			default:
+				break;
+		}
+		pCommand += header->size;
+	}
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "Common.h"
+#include "Descriptor.h"
+#include "HostAllocator.h"
+#include "Pipeline.h"
+#include "Platform.h"
+#include "Rasterizer.h"
+#include "vulkan/vulkan.h"
+
+//Commands are bump-allocated from chunks of this size; small enough to come out of one arena span
+#define COMMAND_CHUNK_SIZE ( 8 * 1024 )
+#define COMMAND_ALIGNMENT 8
+//Matches maxPushConstantsSize
+#define COMMAND_PUSH_CONSTANT_SIZE 1024
+//Matches maxBoundDescriptorSets
+#define COMMAND_MAX_DESCRIPTOR_SETS 16
+
+enum class commandOp_t : uint32 {
+	END,
+	JUMP,							//continue at the next chunk
+	BEGIN_RENDER_PASS,
+	END_RENDER_PASS,
+	BIND_GRAPHICS_PIPELINE,
+	BIND_COMPUTE_PIPELINE,
+	SET_VIEWPORT,
+	SET_SCISSOR,
+	BINDINGS,						//snapshot of vertex buffers, descriptors and push constants for the draws that follow
+	DRAW,
+	DRAW_INDEXED,
+	DRAW_INDIRECT,
+	DRAW_INDEXED_INDIRECT,
+	DISPATCH,
+	COPY_BUFFER,
+	FILL_BUFFER,
+	UPDATE_BUFFER,
+	COPY_IMAGE_TO_BUFFER,
+	COPY_BUFFER_TO_IMAGE,
+	BLIT_IMAGE,
+	COUNT
+};
+
+/*
+Every command is a commandHeader_t followed by its operands, size bytes in all, rounded up to
+COMMAND_ALIGNMENT.  Operands hold what recording resolved the handles to, never the handles themselves,
+so replay is a single pass that reads each command once and never looks anything up.
+*/
+struct commandHeader_t {
+	commandOp_t	op;
+	uint32		size;
+};
+
+struct commandJump_t {
+	commandHeader_t		header;
+	const uint8 *		pNext;
+};
+
+struct commandBeginRenderPass_t {
+	commandHeader_t		header;
+	rasterTarget_t		target;
+	VkRect2D			renderArea;
+	bool				clearColor;
+	bool				clearDepth;
+	bool				clearStencil;
+	float				color[ 4 ];
+	float				depth;
+	uint32				stencil;
+};
+
+struct commandBindGraphicsPipeline_t {
+	commandHeader_t				header;
+	const graphicsPipeline_t *	pipeline;
+};
+
+struct commandBindComputePipeline_t {
+	commandHeader_t				header;
+	const computePipeline_t *	pipeline;
+};
+
+struct commandSetViewport_t {
+	commandHeader_t		header;
+	VkViewport			viewport;
+};
+
+struct commandSetScissor_t {
+	commandHeader_t		header;
+	VkRect2D			scissor;
+};
+
+//Push constants, resource slots, dynamic buffer views and the resolve list follow the struct; the resources
+//already point at them.  Images on the resolve list have their pending clears written before any draw samples them
+struct commandBindings_t {
+	commandHeader_t					header;
+	pipelineBindings_t				graphics;
+	shaderResources_t				compute;
+	const sampledImage_t * const *	ppResolves;
+	uint32							resolveCount;
+};
+
+struct commandDraw_t {
+	commandHeader_t		header;
+	uint32				vertexCount;
+	uint32				instanceCount;
+	uint32				firstVertex;
+	uint32				firstInstance;
+};
+
+struct commandDrawIndexed_t {
+	commandHeader_t		header;
+	const uint8 *		pIndices;			//index buffer at its bound offset
+	VkIndexType			indexType;
+	uint32				indexCount;
+	uint32				instanceCount;
+	uint32				firstIndex;
+	int32				vertexOffset;
+	uint32				firstInstance;
+};
+
+//The arguments are read when the command replays, not when it is recorded; with pCount set, the draw count is
+//the smaller of the value there at replay and drawCount
+struct commandDrawIndirect_t {
+	commandHeader_t		header;
+	const uint8 *		pArguments;			//VkDrawIndirectCommand or VkDrawIndexedIndirectCommand, stride bytes apart
+	const uint8 *		pCount;
+	uint32				drawCount;
+	uint32				stride;
+	const uint8 *		pIndices;			//indexed draws only
+	VkIndexType			indexType;
+};
+
+struct commandDispatch_t {
+	commandHeader_t		header;
+	uint32				groupCount[ 3 ];
+};
+
+struct commandCopyBuffer_t {
+	commandHeader_t		header;
+	const uint8 *		pSource;
+	uint8 *				pDestination;
+	uint64				size;
+};
+
+struct commandFillBuffer_t {
+	commandHeader_t		header;
+	uint8 *				pDestination;
+	uint64				size;
+	uint32				data;
+};
+
+//size bytes of data follow the struct
+struct commandUpdateBuffer_t {
+	commandHeader_t		header;
+	uint8 *				pDestination;
+	uint64				size;
+};
+
+//One array layer of a region; the clear state is read at replay, when it knows which tiles are still pending
+struct commandCopyImageToBuffer_t {
+	commandHeader_t				header;
+	const imageLayout_t *		layout;
+	const imageClearState_t *	clearState;
+	const uint8 *				pImage;
+	uint32						mipLevel;
+	uint32						arrayLayer;
+	VkOffset3D					offset;
+	VkExtent3D					extent;
+	uint8 *						pDestination;
+	uint64						rowPitch;
+	uint64						depthPitch;
+};
+
+//Pending tiles of the destination are written first, since the copy may cover only part of one
+struct commandCopyBufferToImage_t {
+	commandHeader_t				header;
+	const imageLayout_t *		layout;
+	imageClearState_t *			clearState;
+	uint8 *						pImage;
+	uint32						mipLevel;
+	uint32						arrayLayer;
+	VkOffset3D					offset;
+	VkExtent3D					extent;
+	const uint8 *				pSource;
+	uint64						rowPitch;
+	uint64						depthPitch;
+};
+
+//One array layer of a region
+struct commandBlitImage_t {
+	commandHeader_t				header;
+	imageBlitSurface_t			src;
+	imageBlitSurface_t			dst;
+	imageClearState_t *			srcClearState;
+	imageClearState_t *			dstClearState;
+	VkFilter					filter;
+};
+
+/*
+================================================
+commandPool_t
+
+Owns the memory of every command recorded from its command buffers: one arena, externally synchronized
+like the VkCommandPool it backs.  Resetting the pool rewinds the arena and bumps generation in O(1)
+however much was recorded; a command buffer whose generation is stale reads as empty, so none of them is
+visited.  Chunks released by resetting a single command buffer go on a free list and are reused before
+the arena grows.
+================================================
+*/
+struct commandChunk_t {
+	commandChunk_t *	pNext;
+	uint32				size;				//bytes including this header
+	uint32				recyclable;			//COMMAND_CHUNK_SIZE chunks go back on the free list
+};
+
+struct commandPool_t {
+	hostArena_t			arena;
+	commandChunk_t *	pFreeChunks;
+	uint32				generation;
+};
+
+void	CommandPool_Init( commandPool_t * pool );
+void	CommandPool_Shutdown( commandPool_t * pool );
+void	CommandPool_Reset( commandPool_t * pool );
+
+/*
+================================================
+commandBuffer_t
+
+A linear command stream over chunks chained by JUMP commands, plus the recording state that turns
+bind calls into the snapshots draws point at.
+================================================
+*/
+struct commandBuffer_t {
+	commandPool_t *				pool;
+	uint32						generation;
+	commandChunk_t *			pFirstChunk;
+	commandChunk_t *			pLastChunk;
+	uint8 *						pCursor;
+	uint8 *						pLimit;				//the last command of a chunk must start before this, leaving room for a JUMP
+	bool						outOfMemory;
+
+	//Recording state
+	bool						bindingsDirty;
+	const graphicsPipeline_t *	graphicsPipeline;
+	const computePipeline_t *	computePipeline;
+	const descriptorSet_t *		pDescriptorSets[ 2 ][ COMMAND_MAX_DESCRIPTOR_SETS ];	//per VkPipelineBindPoint
+	uint32						dynamicOffsets[ 2 ][ COMMAND_MAX_DESCRIPTOR_SETS ][ DESCRIPTOR_MAX_DYNAMIC_BUFFERS ];
+	const uint8 *				pVertexBuffers[ PIPELINE_MAX_VERTEX_BINDINGS ];
+	const uint8 *				pIndexBuffer;
+	VkIndexType					indexType;
+	uint32						pushConstantSize;	//highest byte written so far
+	alignas( 16 ) uint8			pushConstants[ COMMAND_PUSH_CONSTANT_SIZE ];
+};
+
+void	CommandBuffer_Init( commandBuffer_t * commandBuffer, commandPool_t * pool );
+//Gives the buffer's chunks back to its pool; recording starts over
+void	CommandBuffer_Reset( commandBuffer_t * commandBuffer );
+void	CommandBuffer_Begin( commandBuffer_t * commandBuffer );
+//VK_ERROR_OUT_OF_HOST_MEMORY when any command failed to record
+VkResult	CommandBuffer_End( commandBuffer_t * commandBuffer );
+//True when the buffer holds a stream recorded since its pool was last reset
+bool	CommandBuffer_IsRecorded( const commandBuffer_t * commandBuffer );
+
+void *	CommandBuffer_EmitSlow( commandBuffer_t * commandBuffer, commandOp_t op, uint32 size );
+
+//Appends a command of size bytes, header included, and returns it with the header filled in; NULL when out of memory
+inline void * CommandBuffer_Emit( commandBuffer_t * commandBuffer, commandOp_t op, uint32 size ) {
+	size = ( size + COMMAND_ALIGNMENT - 1 ) & ~( COMMAND_ALIGNMENT - 1 );
+	uint8 * pCommand = commandBuffer->pCursor;
+	if ( size > ( size_t )( commandBuffer->pLimit - pCommand ) ) {
+		return CommandBuffer_EmitSlow( commandBuffer, op, size );
+	}
+	commandBuffer->pCursor = pCommand + size;
+	commandHeader_t * header = reinterpret_cast< commandHeader_t * >( pCommand );
+	header->op = op;
+	header->size = size;
+	return pCommand;
+}
+
+template< typename type_t >
+type_t * CommandBuffer_Emit( commandBuffer_t * commandBuffer, commandOp_t op ) {
+	return reinterpret_cast< type_t * >( CommandBuffer_Emit( commandBuffer, op, sizeof( type_t ) ) );
+}
+
+void	CommandBuffer_BeginRenderPass( commandBuffer_t * commandBuffer, const rasterTarget_t & target, const VkRect2D & renderArea, const float * pClearColor, const float * pClearDepth, const uint32 * pClearStencil );
+void	CommandBuffer_EndRenderPass( commandBuffer_t * commandBuffer );
+void	CommandBuffer_BindGraphicsPipeline( commandBuffer_t * commandBuffer, const graphicsPipeline_t * pipeline );
+void	CommandBuffer_BindComputePipeline( commandBuffer_t * commandBuffer, const computePipeline_t * pipeline );
+void	CommandBuffer_SetViewport( commandBuffer_t * commandBuffer, const VkViewport & viewport );
+void	CommandBuffer_SetScissor( commandBuffer_t * commandBuffer, const VkRect2D & scissor );
+//ppData holds each buffer at its bound offset
+void	CommandBuffer_BindVertexBuffers( commandBuffer_t * commandBuffer, uint32 firstBinding, uint32 bindingCount, const uint8 * const * ppData );
+//Binding a set leaves the sets before and after it bound; dynamic offsets are consumed in set order
+void	CommandBuffer_BindDescriptorSets( commandBuffer_t * commandBuffer, VkPipelineBindPoint bindPoint, uint32 firstSet, uint32 setCount, const descriptorSet_t * const * ppSets, uint32 dynamicOffsetCount, const uint32 * pDynamicOffsets );
+void	CommandBuffer_BindIndexBuffer( commandBuffer_t * commandBuffer, const uint8 * pData, VkIndexType indexType );
+void	CommandBuffer_PushConstants( commandBuffer_t * commandBuffer, uint32 offset, uint32 size, const void * pValues );
+void	CommandBuffer_Draw( commandBuffer_t * commandBuffer, uint32 vertexCount, uint32 instanceCount, uint32 firstVertex, uint32 firstInstance );
+void	CommandBuffer_DrawIndexed( commandBuffer_t * commandBuffer, uint32 indexCount, uint32 instanceCount, uint32 firstIndex, int32 vertexOffset, uint32 firstInstance );
+//pCount is NULL for a fixed drawCount, otherwise drawCount is the most draws the count buffer may ask for
+void	CommandBuffer_DrawIndirect( commandBuffer_t * commandBuffer, const uint8 * pArguments, uint32 drawCount, uint32 stride, const uint8 * pCount );
+void	CommandBuffer_DrawIndexedIndirect( commandBuffer_t * commandBuffer, const uint8 * pArguments, uint32 drawCount, uint32 stride, const uint8 * pCount );
+void	CommandBuffer_Dispatch( commandBuffer_t * commandBuffer, uint32 groupCountX, uint32 groupCountY, uint32 groupCountZ );
+void	CommandBuffer_CopyBuffer( commandBuffer_t * commandBuffer, const uint8 * pSource, uint8 * pDestination, uint64 size );
+void	CommandBuffer_FillBuffer( commandBuffer_t * commandBuffer, uint8 * pDestination, uint64 size, uint32 data );
+void	CommandBuffer_UpdateBuffer( commandBuffer_t * commandBuffer, uint8 * pDestination, uint64 size, const void * pData );
+void	CommandBuffer_CopyImageToBuffer( commandBuffer_t * commandBuffer, const imageLayout_t * layout, const imageClearState_t * clearState, const uint8 * pImage, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, uint8 * pDestination, uint64 rowPitch, uint64 depthPitch );
+void	CommandBuffer_CopyBufferToImage( commandBuffer_t * commandBuffer, const imageLayout_t * layout, imageClearState_t * clearState, uint8 * pImage, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, const uint8 * pSource, uint64 rowPitch, uint64 depthPitch );
+void	CommandBuffer_BlitImage( commandBuffer_t * commandBuffer, const imageBlitSurface_t & src, imageClearState_t * srcClearState, const imageBlitSurface_t & dst, imageClearState_t * dstClearState, VkFilter filter );
+
+/*
+================================================
+commandExecutor_t
+
+What replay needs, shared by every queue of a device.  Render passes take turns on the one rasterizer, and
+dispatches take turns because the thread waiting on each one runs as the same external worker of the
+pool; transfers take no lock, so they overlap with either.
+================================================
+*/
+struct commandExecutor_t {
+	rasterizer_t *		rasterizer;
+	platformMutex_t		renderPassLock;
+	platformMutex_t		dispatchLock;
+};
+
+void	CommandExecutor_Init( commandExecutor_t * executor, rasterizer_t * rasterizer );
+void	CommandExecutor_Shutdown( commandExecutor_t * executor );
+
+//Replays a recorded stream on the calling thread, fanning draws and dispatches out over the rasterizer's pool
+void	CommandBuffer_Execute( const commandBuffer_t * commandBuffer, commandExecutor_t * executor );
@@ -1,44 +1,107 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
 
 typedef uint64_t uint64;
 typedef uint32_t uint32;
+typedef uint16_t uint16;
 typedef uint8_t uint8;
 typedef int32_t int32;
+typedef int64_t int64;
 
-uint32 Min( uint32 a, uint32 b ) {
+inline uint32 Min( uint32 a, uint32 b ) {
 	return a < b ? a : b;
 }
 
-size_t Min( size_t a, size_t b ) {
+inline size_t Min( size_t a, size_t b ) {
 	return a < b ? a : b;
 }
 
-uint32 Min( uint32 a, size_t b ) {
+inline uint32 Min( uint32 a, size_t b ) {
 	return a < ( uint32 )b ? a : ( uint32 )b;
 }
 
-uint32 Min( size_t a, uint32 b ) {
+inline uint32 Min( size_t a, uint32 b ) {
 	return ( uint32 )a < b ? ( uint32 )a : b;
 }
 
-uint32 Max( uint32 a, uint32 b ) {
+inline uint32 Max( uint32 a, uint32 b ) {
 	return a > b ? a : b;
 }
 
-size_t Max( size_t a, size_t b ) {
+inline size_t Max( size_t a, size_t b ) {
 	return a > b ? a : b;
 }
 
-int32 Min( int32 a, uint32 b ) {
+inline int32 Min( int32 a, int32 b ) {
+	return a < b ? a : b;
+}
+
+inline int32 Max( int32 a, int32 b ) {
+	return a > b ? a : b;
+}
+
+inline float Min( float a, float b ) {
+	return a < b ? a : b;
+}
+
+inline float Max( float a, float b ) {
+	return a > b ? a : b;
+}
+
+inline int32 Min( int32 a, uint32 b ) {
 	return a < ( int32 )b ? a : b;
 }
 
-int32 Min( uint32 a, int32 b ) {
+inline int32 Min( uint32 a, int32 b ) {
 	return ( int32 )a < b ? a : b;
 }
 
 #define ARRAY_LENGTH( x ) sizeof( x ) / sizeof( *x )
 
-#define BIT( x ) 1 << x
\ No newline at end of file
+#define BIT( x ) 1 << x
+
+//Index of the lowest set bit; value must be non-zero
+inline uint32 LowestBitIndex( uint32 value ) {
+#if defined( _MSC_VER )
+	unsigned long index;
+	_BitScanForward( &index, value );
+	return index;
+#else
+	return __builtin_ctz( value );
+#endif
+}
+
+inline uint32 LowestBitIndex64( uint64 value ) {
+#if defined( _MSC_VER ) && defined( _M_X64 )
+	unsigned long index;
+	_BitScanForward64( &index, value );
+	return index;
+#elif defined( _MSC_VER )
+	return ( ( uint32 )value != 0 ) ? LowestBitIndex( ( uint32 )value ) : 32 + LowestBitIndex( ( uint32 )( value >> 32 ) );
+#else
+	return __builtin_ctzll( value );
+#endif
+}
+
+//Index of the highest set bit; value must be non-zero
+inline uint32 HighestBitIndex64( uint64 value ) {
+#if defined( _MSC_VER ) && defined( _M_X64 )
+	unsigned long index;
+	_BitScanReverse64( &index, value );
+	return index;
+#elif defined( _MSC_VER )
+	unsigned long index;
+	if ( _BitScanReverse( &index, ( uint32 )( value >> 32 ) ) ) {
+		return 32 + index;
+	}
+	_BitScanReverse( &index, ( uint32 )value );
+	return index;
+#else
+	return 63 - __builtin_clzll( value );
+#endif
+}
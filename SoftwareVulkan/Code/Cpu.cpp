@@ -0,0 +1,92 @@
+#include "Cpu.h"
+#include "Platform.h"
+
+#if CPU_X86
+#if defined( _MSC_VER )
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if CPU_X86
+
+static void Cpuid( uint32 leaf, uint32 subLeaf, uint32 registers[ 4 ] ) {
+#if defined( _MSC_VER )
+	int values[ 4 ];
+	__cpuidex( values, ( int )leaf, ( int )subLeaf );
+	for ( uint32 i = 0; i < 4; i++ ) {
+		registers[ i ] = ( uint32 )values[ i ];
+	}
+#else
+	__cpuid_count( leaf, subLeaf, registers[ 0 ], registers[ 1 ], registers[ 2 ], registers[ 3 ] );
+#endif
+}
+
+//Register state the OS saves on context switch; only valid once OSXSAVE is known to be set
+static uint64 EnabledXStateFeatures() {
+#if defined( _MSC_VER )
+	return _xgetbv( 0 );
+#else
+	uint32 low;
+	uint32 high;
+	__asm__ __volatile__( "xgetbv" : "=a"( low ), "=d"( high ) : "c"( 0 ) );
+	return ( ( uint64 )high << 32 ) | low;
+#endif
+}
+
+static cpuIsa_t DetectHardwareIsa() {
+	uint32 registers[ 4 ];
+	Cpuid( 0, 0, registers );
+	const uint32 maxLeaf = registers[ 0 ];
+	if ( maxLeaf < 1 ) {
+		return cpuIsa_t::SCALAR;
+	}
+	Cpuid( 1, 0, registers );
+	const uint32 features1 = registers[ 2 ];
+	if ( ( features1 & BIT( 19 ) ) == 0 ) {
+		return cpuIsa_t::SCALAR;
+	}
+	//AVX needs both the instructions and an OS that saves the YMM state (XCR0 bits 1 and 2)
+	const bool osxsave = ( features1 & BIT( 27 ) ) != 0;
+	const bool avx = ( features1 & BIT( 28 ) ) != 0;
+	if ( !osxsave || !avx || maxLeaf < 7 ) {
+		return cpuIsa_t::SSE41;
+	}
+	const uint64 xstate = EnabledXStateFeatures();
+	if ( ( xstate & 0x6 ) != 0x6 ) {
+		return cpuIsa_t::SSE41;
+	}
+	Cpuid( 7, 0, registers );
+	const uint32 features7 = registers[ 1 ];
+	const bool avx2 = ( features7 & BIT( 5 ) ) != 0;
+	if ( !avx2 ) {
+		return cpuIsa_t::SSE41;
+	}
+	//AVX-512 additionally needs opmask, upper ZMM and high 16 ZMM state (XCR0 bits 5 to 7)
+	const bool avx512f = ( features7 & BIT( 16 ) ) != 0;
+	if ( !CPU_AVX512_KERNELS || !avx512f || ( xstate & 0xE6 ) != 0xE6 ) {
+		return cpuIsa_t::AVX2;
+	}
+	return cpuIsa_t::AVX512;
+}
+
+#else
+
+static cpuIsa_t DetectHardwareIsa() {
+	return cpuIsa_t::SCALAR;
+}
+
+#endif
+
+cpuIsa_t Cpu_DetectIsa() {
+	const uint32 hardware = ( uint32 )DetectHardwareIsa();
+	const uint32 cap = Platform_GetEnvironmentUInt( "SOFTWARE_VULKAN_MAX_ISA", ( uint32 )cpuIsa_t::COUNT - 1 );
+	return ( cpuIsa_t )Min( hardware, cap );
+}
+
+const char * Cpu_IsaName( cpuIsa_t isa ) {
+	static const char * names[] = { "scalar", "SSE4.1", "AVX2", "AVX-512" };
+	return ( ( uint32 )isa < ARRAY_LENGTH( names ) ) ? names[ ( uint32 )isa ] : "unknown";
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Common.h"
+
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+//MSVC accepts any intrinsic in any function; GCC and Clang need each kernel tagged with the ISA it uses
+#if defined( _MSC_VER )
+#define CPU_TARGET( isa )
+#else
+#define CPU_TARGET( isa ) __attribute__( ( target( isa ) ) )
+#endif
+
+//AVX-512 intrinsics first shipped with the VS2017 15.3 compiler; older toolsets dispatch no wider than AVX2
+#if CPU_X86 && ( !defined( _MSC_VER ) || _MSC_VER >= 1911 )
+#define CPU_AVX512_KERNELS 1
+#else
+#define CPU_AVX512_KERNELS 0
+#endif
+
+//Ordered so that a wider ISA compares greater
+enum class cpuIsa_t : uint32 {
+	SCALAR,
+	SSE41,
+	AVX2,
+	AVX512,
+	COUNT
+};
+
+//Widest ISA both the processor and the OS support, capped by SOFTWARE_VULKAN_MAX_ISA ( 0 scalar .. 3 AVX-512 )
+cpuIsa_t		Cpu_DetectIsa();
+const char *	Cpu_IsaName( cpuIsa_t isa );
@@ -0,0 +1,191 @@
+#include "Descriptor.h"
+#include <string.h>
+
+static const descriptorLayoutBinding_t * Descriptor_FindBinding( const descriptorLayoutBinding_t * pBindings, uint32 bindingCount, uint32 binding ) {
+	uint32 low = 0;
+	uint32 high = bindingCount;
+	while ( low < high ) {
+		const uint32 middle = ( low + high ) / 2;
+		if ( pBindings[ middle ].binding < binding ) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return ( low < bindingCount && pBindings[ low ].binding == binding ) ? &pBindings[ low ] : NULL;
+}
+
+static bool Descriptor_IsImage( VkDescriptorType type ) {
+	return type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE || type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+}
+
+bool DescriptorSet_IsDynamic( VkDescriptorType type ) {
+	return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
+/*
+================================================
+descriptorSetLayout_t
+================================================
+*/
+VkResult DescriptorSetLayout_Init( descriptorSetLayout_t * layout, const VkDescriptorSetLayoutCreateInfo * pCreateInfo, const VkAllocationCallbacks * allocator ) {
+	memset( layout, 0, sizeof( *layout ) );
+	layout->allocator = allocator;
+	layout->bindingCount = pCreateInfo->bindingCount;
+	if ( layout->bindingCount == 0 ) {
+		return VK_SUCCESS;
+	}
+	layout->pBindings = reinterpret_cast< descriptorLayoutBinding_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( descriptorLayoutBinding_t ) * layout->bindingCount, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( layout->pBindings == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	//Insertion sort; layouts have a handful of bindings
+	bool hasImmutableSamplers = false;
+	for ( uint32 i = 0; i < layout->bindingCount; i++ ) {
+		const VkDescriptorSetLayoutBinding & src = pCreateInfo->pBindings[ i ];
+		descriptorLayoutBinding_t binding;
+		memset( &binding, 0, sizeof( binding ) );
+		binding.binding = src.binding;
+		binding.type = src.descriptorType;
+		binding.count = src.descriptorCount;
+		binding.immutableSamplers = src.pImmutableSamplers != NULL && ( src.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER || src.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );
+		hasImmutableSamplers = hasImmutableSamplers || binding.immutableSamplers;
+		uint32 j = i;
+		for ( ; j > 0 && layout->pBindings[ j - 1 ].binding > binding.binding; j-- ) {
+			layout->pBindings[ j ] = layout->pBindings[ j - 1 ];
+		}
+		layout->pBindings[ j ] = binding;
+	}
+	for ( uint32 i = 0; i < layout->bindingCount; i++ ) {
+		descriptorLayoutBinding_t & binding = layout->pBindings[ i ];
+		binding.firstElement = layout->elementCount;
+		binding.firstDynamic = layout->dynamicCount;
+		layout->elementCount += binding.count;
+		layout->dynamicCount += DescriptorSet_IsDynamic( binding.type ) ? binding.count : 0;
+	}
+	if ( hasImmutableSamplers && layout->elementCount > 0 ) {
+		const size_t size = sizeof( const sampler_t * ) * layout->elementCount;
+		layout->ppImmutableSamplers = reinterpret_cast< const sampler_t ** >( allocator->pfnAllocation( allocator->pUserData, size, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+		if ( layout->ppImmutableSamplers == NULL ) {
+			DescriptorSetLayout_Shutdown( layout );
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		memset( layout->ppImmutableSamplers, 0, size );
+	}
+	return VK_SUCCESS;
+}
+
+void DescriptorSetLayout_Shutdown( descriptorSetLayout_t * layout ) {
+	if ( layout->pBindings != NULL ) {
+		layout->allocator->pfnFree( layout->allocator->pUserData, layout->pBindings );
+	}
+	if ( layout->ppImmutableSamplers != NULL ) {
+		layout->allocator->pfnFree( layout->allocator->pUserData, layout->ppImmutableSamplers );
+	}
+	memset( layout, 0, sizeof( *layout ) );
+}
+
+const descriptorLayoutBinding_t * DescriptorSetLayout_FindBinding( const descriptorSetLayout_t * layout, uint32 binding ) {
+	return Descriptor_FindBinding( layout->pBindings, layout->bindingCount, binding );
+}
+
+/*
+================================================
+descriptorSet_t
+================================================
+*/
+VkResult DescriptorSet_Init( descriptorSet_t * set, const descriptorSetLayout_t * layout, const VkAllocationCallbacks * allocator ) {
+	memset( set, 0, sizeof( *set ) );
+	set->allocator = allocator;
+	set->bindingCount = layout->bindingCount;
+	set->elementCount = layout->elementCount;
+	set->dynamicCount = layout->dynamicCount;
+	if ( set->bindingCount == 0 ) {
+		return VK_SUCCESS;
+	}
+	//One allocation: bindings, resources, elements, then element pointers
+	const size_t bindingsSize = sizeof( descriptorLayoutBinding_t ) * set->bindingCount;
+	const size_t resourcesOffset = ( bindingsSize + 15 ) & ~( size_t )15;
+	const size_t elementsOffset = ( resourcesOffset + sizeof( shaderResource_t ) * set->bindingCount + 15 ) & ~( size_t )15;
+	const size_t pointersOffset = elementsOffset + sizeof( descriptorElement_t ) * set->elementCount;
+	const size_t size = pointersOffset + sizeof( const void * ) * set->elementCount;
+	uint8 * pMemory = reinterpret_cast< uint8 * >( allocator->pfnAllocation( allocator->pUserData, size, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( pMemory == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	memset( pMemory, 0, size );
+	set->pBindings = reinterpret_cast< descriptorLayoutBinding_t * >( pMemory );
+	set->pResources = reinterpret_cast< shaderResource_t * >( pMemory + resourcesOffset );
+	set->pElements = reinterpret_cast< descriptorElement_t * >( pMemory + elementsOffset );
+	set->ppElements = reinterpret_cast< const void ** >( pMemory + pointersOffset );
+	memcpy( set->pBindings, layout->pBindings, bindingsSize );
+	for ( uint32 i = 0; i < set->bindingCount; i++ ) {
+		const descriptorLayoutBinding_t & binding = set->pBindings[ i ];
+		set->pResources[ i ].ppElements = set->ppElements + binding.firstElement;
+		set->pResources[ i ].elementCount = binding.count;
+		const bool image = Descriptor_IsImage( binding.type );
+		for ( uint32 e = binding.firstElement; e < binding.firstElement + binding.count; e++ ) {
+			set->ppElements[ e ] = image ? static_cast< const void * >( &set->pElements[ e ].image ) : static_cast< const void * >( &set->pElements[ e ].buffer );
+			if ( binding.immutableSamplers ) {
+				set->pElements[ e ].image.sampler = layout->ppImmutableSamplers[ e ];
+			}
+		}
+	}
+	return VK_SUCCESS;
+}
+
+void DescriptorSet_Shutdown( descriptorSet_t * set ) {
+	if ( set->pBindings != NULL ) {
+		set->allocator->pfnFree( set->allocator->pUserData, set->pBindings );
+	}
+	memset( set, 0, sizeof( *set ) );
+}
+
+const descriptorLayoutBinding_t * DescriptorSet_FindBinding( const descriptorSet_t * set, uint32 binding ) {
+	return Descriptor_FindBinding( set->pBindings, set->bindingCount, binding );
+}
+
+void DescriptorSet_Write( descriptorSet_t * set, uint32 binding, uint32 arrayElement, uint32 count, const descriptorElement_t * pValues ) {
+	const descriptorLayoutBinding_t * first = DescriptorSet_FindBinding( set, binding );
+	if ( first == NULL ) {
+		return;
+	}
+	for ( uint32 index = ( uint32 )( first - set->pBindings ); index < set->bindingCount && count > 0; index++ ) {
+		const descriptorLayoutBinding_t & current = set->pBindings[ index ];
+		if ( arrayElement >= current.count ) {
+			arrayElement -= current.count;
+			continue;
+		}
+		const uint32 run = Min( count, current.count - arrayElement );
+		descriptorElement_t * pElements = set->pElements + current.firstElement + arrayElement;
+		for ( uint32 i = 0; i < run; i++ ) {
+			const sampler_t * immutableSampler = pElements[ i ].image.sampler;
+			pElements[ i ] = pValues[ i ];
+			if ( current.immutableSamplers ) {
+				pElements[ i ].image.sampler = immutableSampler;
+			}
+		}
+		pValues += run;
+		count -= run;
+		arrayElement = 0;
+	}
+}
+
+void DescriptorSet_Read( const descriptorSet_t * set, uint32 binding, uint32 arrayElement, uint32 count, descriptorElement_t * pValues ) {
+	const descriptorLayoutBinding_t * first = DescriptorSet_FindBinding( set, binding );
+	if ( first == NULL ) {
+		return;
+	}
+	for ( uint32 index = ( uint32 )( first - set->pBindings ); index < set->bindingCount && count > 0; index++ ) {
+		const descriptorLayoutBinding_t & current = set->pBindings[ index ];
+		if ( arrayElement >= current.count ) {
+			arrayElement -= current.count;
+			continue;
+		}
+		const uint32 run = Min( count, current.count - arrayElement );
+		memcpy( pValues, set->pElements + current.firstElement + arrayElement, sizeof( descriptorElement_t ) * run );
+		pValues += run;
+		count -= run;
+		arrayElement = 0;
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+#include "Sampler.h"
+#include "Shader.h"
+#include "vulkan/vulkan.h"
+
+//Matches maxDescriptorSetUniformBuffersDynamic plus maxDescriptorSetStorageBuffersDynamic
+#define DESCRIPTOR_MAX_DYNAMIC_BUFFERS 16
+
+struct descriptorLayoutBinding_t {
+	uint32				binding;
+	VkDescriptorType	type;
+	uint32				count;
+	uint32				firstElement;		//of the set's flat element array
+	uint32				firstDynamic;		//of the set's dynamic offsets, for dynamic buffer types
+	bool				immutableSamplers;
+};
+
+/*
+================================================
+descriptorSetLayout_t
+
+Bindings sorted by number, each a run of the set's flat element array, so that rolling a write over into
+the next binding is just carrying on along the array.
+================================================
+*/
+struct descriptorSetLayout_t {
+	const VkAllocationCallbacks *	allocator;
+	descriptorLayoutBinding_t *		pBindings;
+	uint32							bindingCount;
+	uint32							elementCount;
+	uint32							dynamicCount;
+	const sampler_t **				ppImmutableSamplers;	//per element, NULL when the binding has none; NULL when no binding does
+};
+
+//Immutable samplers start out NULL; the caller resolves the handles into ppImmutableSamplers
+VkResult	DescriptorSetLayout_Init( descriptorSetLayout_t * layout, const VkDescriptorSetLayoutCreateInfo * pCreateInfo, const VkAllocationCallbacks * allocator );
+void		DescriptorSetLayout_Shutdown( descriptorSetLayout_t * layout );
+const descriptorLayoutBinding_t *	DescriptorSetLayout_FindBinding( const descriptorSetLayout_t * layout, uint32 binding );
+
+//One element of any type: buffers use the view, images and samplers the sampler descriptor
+struct descriptorElement_t {
+	shaderBufferView_t		buffer;
+	samplerDescriptor_t		image;
+};
+
+/*
+================================================
+descriptorSet_t
+
+Holds its own copy of the layout, since a layout may be destroyed while sets allocated from it live on.
+pResources is what a shader slot bound to each binding points at: element pointers are fixed when the set
+is allocated and writes only change the elements, so binding the set copies no element.  Dynamic buffers
+are the exception, copied with their offsets applied when the bindings are snapshot.
+================================================
+*/
+struct descriptorSet_t {
+	const VkAllocationCallbacks *	allocator;
+	descriptorLayoutBinding_t *		pBindings;
+	uint32							bindingCount;
+	uint32							elementCount;
+	uint32							dynamicCount;
+	shaderResource_t *				pResources;			//per binding
+	descriptorElement_t *			pElements;
+	const void **					ppElements;			//what shaders see of each element
+};
+
+VkResult	DescriptorSet_Init( descriptorSet_t * set, const descriptorSetLayout_t * layout, const VkAllocationCallbacks * allocator );
+void		DescriptorSet_Shutdown( descriptorSet_t * set );
+const descriptorLayoutBinding_t *	DescriptorSet_FindBinding( const descriptorSet_t * set, uint32 binding );
+bool		DescriptorSet_IsDynamic( VkDescriptorType type );
+//count consecutive elements from arrayElement of binding on, rolling over into the bindings after it; immutable samplers are kept
+void		DescriptorSet_Write( descriptorSet_t * set, uint32 binding, uint32 arrayElement, uint32 count, const descriptorElement_t * pValues );
+void		DescriptorSet_Read( const descriptorSet_t * set, uint32 binding, uint32 arrayElement, uint32 count, descriptorElement_t * pValues );
@@ -0,0 +1,542 @@
+#include "DeviceHeap.h"
+#include <string.h>
+
+static const uint64 sizeClasses[ DEVICE_HEAP_SIZE_CLASS_COUNT ] = {
+	64,		128,	192,	256,
+	384,	512,	768,	1024,
+	1536,	2048,	3072,	4096,
+	6144,	8192,	12288,	16384
+};
+
+static uint64 AlignToHeap( uint64 size ) {
+	return ( size + DEVICE_HEAP_ALIGNMENT - 1 ) & ~( DEVICE_HEAP_ALIGNMENT - 1 );
+}
+
+//Grows one of the heap's bookkeeping arrays, leaving it untouched on failure
+template< typename __type__ >
+static bool DeviceHeap_GrowArray( deviceHeap_t * heap, __type__ ** ppArray, uint32 * pCapacity, uint32 minimumCapacity ) {
+	uint32 newCapacity = Max( *pCapacity * 2, minimumCapacity );
+	__type__ * newArray = reinterpret_cast< __type__ * >( heap->allocator->pfnReallocation( heap->allocator->pUserData, *ppArray, sizeof( __type__ ) * newCapacity, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+	if ( newArray == NULL ) {
+		return false;
+	}
+	memset( newArray + *pCapacity, 0, sizeof( __type__ ) * ( newCapacity - *pCapacity ) );
+	*ppArray = newArray;
+	*pCapacity = newCapacity;
+	return true;
+}
+
+/*
+================================================
+TLSF ranges
+
+Free ranges are binned by ( first level = log2 of size, second level = next DEVICE_HEAP_TLSF_SL_BITS bits ).
+Ranges below 1 << DEVICE_HEAP_TLSF_FL_SHIFT share first level 0 and are binned linearly by granule.
+================================================
+*/
+static void Tlsf_Mapping( uint64 size, uint32 * pFirstLevel, uint32 * pSecondLevel ) {
+	if ( size < ( 1ULL << DEVICE_HEAP_TLSF_FL_SHIFT ) ) {
+		*pFirstLevel = 0;
+		*pSecondLevel = ( uint32 )( size >> DEVICE_HEAP_ALIGNMENT_SHIFT );
+	} else {
+		uint32 highBit = HighestBitIndex64( size );
+		*pFirstLevel = highBit - ( DEVICE_HEAP_TLSF_FL_SHIFT - 1 );
+		*pSecondLevel = ( uint32 )( size >> ( highBit - DEVICE_HEAP_TLSF_SL_BITS ) ) ^ DEVICE_HEAP_TLSF_SL_COUNT;
+	}
+}
+
+static void Tlsf_InsertFree( deviceHeap_t * heap, uint32 nodeIndex ) {
+	deviceHeapNode_t * node = &heap->pNodes[ nodeIndex ];
+	uint32 firstLevel;
+	uint32 secondLevel;
+	Tlsf_Mapping( node->size, &firstLevel, &secondLevel );
+	uint32 head = heap->freeRanges[ firstLevel ][ secondLevel ];
+	node->isFree = true;
+	node->prevFree = DEVICE_HEAP_INVALID_INDEX;
+	node->nextFree = head;
+	if ( head != DEVICE_HEAP_INVALID_INDEX ) {
+		heap->pNodes[ head ].prevFree = nodeIndex;
+	}
+	heap->freeRanges[ firstLevel ][ secondLevel ] = nodeIndex;
+	heap->firstLevelBitmap |= 1U << firstLevel;
+	heap->secondLevelBitmap[ firstLevel ] |= 1U << secondLevel;
+}
+
+static void Tlsf_RemoveFree( deviceHeap_t * heap, uint32 nodeIndex ) {
+	deviceHeapNode_t * node = &heap->pNodes[ nodeIndex ];
+	uint32 firstLevel;
+	uint32 secondLevel;
+	Tlsf_Mapping( node->size, &firstLevel, &secondLevel );
+	if ( node->prevFree != DEVICE_HEAP_INVALID_INDEX ) {
+		heap->pNodes[ node->prevFree ].nextFree = node->nextFree;
+	} else {
+		heap->freeRanges[ firstLevel ][ secondLevel ] = node->nextFree;
+		if ( node->nextFree == DEVICE_HEAP_INVALID_INDEX ) {
+			heap->secondLevelBitmap[ firstLevel ] &= ~( 1U << secondLevel );
+			if ( heap->secondLevelBitmap[ firstLevel ] == 0 ) {
+				heap->firstLevelBitmap &= ~( 1U << firstLevel );
+			}
+		}
+	}
+	if ( node->nextFree != DEVICE_HEAP_INVALID_INDEX ) {
+		heap->pNodes[ node->nextFree ].prevFree = node->prevFree;
+	}
+	node->isFree = false;
+	node->prevFree = DEVICE_HEAP_INVALID_INDEX;
+	node->nextFree = DEVICE_HEAP_INVALID_INDEX;
+}
+
+//Returns the head of the first bin whose every range is at least size bytes
+static uint32 Tlsf_FindFree( deviceHeap_t * heap, uint64 size ) {
+	if ( size >= ( 1ULL << DEVICE_HEAP_TLSF_FL_SHIFT ) ) {
+		size += ( 1ULL << ( HighestBitIndex64( size ) - DEVICE_HEAP_TLSF_SL_BITS ) ) - 1;
+	}
+	uint32 firstLevel;
+	uint32 secondLevel;
+	Tlsf_Mapping( size, &firstLevel, &secondLevel );
+	if ( firstLevel >= DEVICE_HEAP_TLSF_FL_COUNT ) {
+		return DEVICE_HEAP_INVALID_INDEX;
+	}
+	uint32 secondLevelMap = heap->secondLevelBitmap[ firstLevel ] & ( ~0U << secondLevel );
+	if ( secondLevelMap == 0 ) {
+		uint32 firstLevelMap = ( firstLevel + 1 < DEVICE_HEAP_TLSF_FL_COUNT ) ? heap->firstLevelBitmap & ( ~0U << ( firstLevel + 1 ) ) : 0;
+		if ( firstLevelMap == 0 ) {
+			return DEVICE_HEAP_INVALID_INDEX;
+		}
+		firstLevel = LowestBitIndex( firstLevelMap );
+		secondLevelMap = heap->secondLevelBitmap[ firstLevel ];
+	}
+	return heap->freeRanges[ firstLevel ][ LowestBitIndex( secondLevelMap ) ];
+}
+
+static uint32 DeviceHeap_AllocateNode( deviceHeap_t * heap ) {
+	if ( heap->freeNodeHead == DEVICE_HEAP_INVALID_INDEX ) {
+		uint32 oldCapacity = heap->nodeCapacity;
+		if ( !DeviceHeap_GrowArray( heap, &heap->pNodes, &heap->nodeCapacity, 256 ) ) {
+			return DEVICE_HEAP_INVALID_INDEX;
+		}
+		for ( uint32 i = oldCapacity; i < heap->nodeCapacity; i++ ) {
+			heap->pNodes[ i ].nextFree = ( i + 1 < heap->nodeCapacity ) ? i + 1 : DEVICE_HEAP_INVALID_INDEX;
+		}
+		heap->freeNodeHead = oldCapacity;
+	}
+	uint32 nodeIndex = heap->freeNodeHead;
+	heap->freeNodeHead = heap->pNodes[ nodeIndex ].nextFree;
+	memset( &heap->pNodes[ nodeIndex ], 0, sizeof( deviceHeapNode_t ) );
+	heap->pNodes[ nodeIndex ].prevPhysical = DEVICE_HEAP_INVALID_INDEX;
+	heap->pNodes[ nodeIndex ].nextPhysical = DEVICE_HEAP_INVALID_INDEX;
+	heap->pNodes[ nodeIndex ].prevFree = DEVICE_HEAP_INVALID_INDEX;
+	heap->pNodes[ nodeIndex ].nextFree = DEVICE_HEAP_INVALID_INDEX;
+	return nodeIndex;
+}
+
+static void DeviceHeap_ReleaseNode( deviceHeap_t * heap, uint32 nodeIndex ) {
+	heap->pNodes[ nodeIndex ].nextFree = heap->freeNodeHead;
+	heap->freeNodeHead = nodeIndex;
+}
+
+//Maps a fresh block and publishes it as a single free range
+static bool DeviceHeap_AddBlock( deviceHeap_t * heap ) {
+	uint32 blockIndex = DEVICE_HEAP_INVALID_INDEX;
+	for ( uint32 i = 0; i < heap->blockCapacity; i++ ) {
+		if ( heap->pBlocks[ i ].mapping.base == NULL ) {
+			blockIndex = i;
+			break;
+		}
+	}
+	if ( blockIndex == DEVICE_HEAP_INVALID_INDEX ) {
+		blockIndex = heap->blockCapacity;
+		if ( !DeviceHeap_GrowArray( heap, &heap->pBlocks, &heap->blockCapacity, 4 ) ) {
+			return false;
+		}
+	}
+	uint32 nodeIndex = DeviceHeap_AllocateNode( heap );
+	if ( nodeIndex == DEVICE_HEAP_INVALID_INDEX ) {
+		return false;
+	}
+	deviceHeapBlock_t * block = &heap->pBlocks[ blockIndex ];
+	if ( !Platform_MapMemory( DEVICE_HEAP_BLOCK_SIZE, heap->largePages, &block->mapping ) ) {
+		DeviceHeap_ReleaseNode( heap, nodeIndex );
+		return false;
+	}
+	block->firstNode = nodeIndex;
+	block->usedBytes = 0;
+	deviceHeapNode_t * node = &heap->pNodes[ nodeIndex ];
+	node->offset = 0;
+	node->size = block->mapping.size;
+	node->block = blockIndex;
+	Tlsf_InsertFree( heap, nodeIndex );
+	heap->emptyBlockCount++;
+	heap->stats.blockCount++;
+	heap->stats.mappedBytes += block->mapping.size;
+	return true;
+}
+
+static uint32 DeviceHeap_AllocateRange( deviceHeap_t * heap, uint64 size ) {
+	uint32 nodeIndex = Tlsf_FindFree( heap, size );
+	if ( nodeIndex == DEVICE_HEAP_INVALID_INDEX ) {
+		if ( !DeviceHeap_AddBlock( heap ) ) {
+			return DEVICE_HEAP_INVALID_INDEX;
+		}
+		nodeIndex = Tlsf_FindFree( heap, size );
+		if ( nodeIndex == DEVICE_HEAP_INVALID_INDEX ) {
+			return DEVICE_HEAP_INVALID_INDEX;
+		}
+	}
+	Tlsf_RemoveFree( heap, nodeIndex );
+
+	//Split off the tail so it stays available; the node table may grow here, so re-fetch pointers after
+	if ( heap->pNodes[ nodeIndex ].size - size >= DEVICE_HEAP_ALIGNMENT ) {
+		uint32 tailIndex = DeviceHeap_AllocateNode( heap );
+		if ( tailIndex != DEVICE_HEAP_INVALID_INDEX ) {
+			deviceHeapNode_t * node = &heap->pNodes[ nodeIndex ];
+			deviceHeapNode_t * tail = &heap->pNodes[ tailIndex ];
+			tail->offset = node->offset + size;
+			tail->size = node->size - size;
+			tail->block = node->block;
+			tail->prevPhysical = nodeIndex;
+			tail->nextPhysical = node->nextPhysical;
+			if ( node->nextPhysical != DEVICE_HEAP_INVALID_INDEX ) {
+				heap->pNodes[ node->nextPhysical ].prevPhysical = tailIndex;
+			}
+			node->nextPhysical = tailIndex;
+			node->size = size;
+			Tlsf_InsertFree( heap, tailIndex );
+		}
+	}
+
+	deviceHeapNode_t * node = &heap->pNodes[ nodeIndex ];
+	deviceHeapBlock_t * block = &heap->pBlocks[ node->block ];
+	if ( block->usedBytes == 0 ) {
+		heap->emptyBlockCount--;
+	}
+	block->usedBytes += node->size;
+	return nodeIndex;
+}
+
+static void DeviceHeap_FreeRange( deviceHeap_t * heap, uint32 nodeIndex ) {
+	deviceHeapNode_t * node = &heap->pNodes[ nodeIndex ];
+	deviceHeapBlock_t * block = &heap->pBlocks[ node->block ];
+	block->usedBytes -= node->size;
+
+	uint32 prevIndex = node->prevPhysical;
+	if ( prevIndex != DEVICE_HEAP_INVALID_INDEX && heap->pNodes[ prevIndex ].isFree ) {
+		deviceHeapNode_t * prev = &heap->pNodes[ prevIndex ];
+		Tlsf_RemoveFree( heap, prevIndex );
+		prev->size += node->size;
+		prev->nextPhysical = node->nextPhysical;
+		if ( node->nextPhysical != DEVICE_HEAP_INVALID_INDEX ) {
+			heap->pNodes[ node->nextPhysical ].prevPhysical = prevIndex;
+		}
+		DeviceHeap_ReleaseNode( heap, nodeIndex );
+		nodeIndex = prevIndex;
+		node = prev;
+	}
+	uint32 nextIndex = node->nextPhysical;
+	if ( nextIndex != DEVICE_HEAP_INVALID_INDEX && heap->pNodes[ nextIndex ].isFree ) {
+		deviceHeapNode_t * next = &heap->pNodes[ nextIndex ];
+		Tlsf_RemoveFree( heap, nextIndex );
+		node->size += next->size;
+		node->nextPhysical = next->nextPhysical;
+		if ( next->nextPhysical != DEVICE_HEAP_INVALID_INDEX ) {
+			heap->pNodes[ next->nextPhysical ].prevPhysical = nodeIndex;
+		}
+		DeviceHeap_ReleaseNode( heap, nextIndex );
+	}
+	Tlsf_InsertFree( heap, nodeIndex );
+
+	if ( block->usedBytes != 0 ) {
+		return;
+	}
+	heap->emptyBlockCount++;
+	if ( heap->emptyBlockCount > 1 ) {
+		//An empty block has coalesced back into the single range it started as
+		Tlsf_RemoveFree( heap, nodeIndex );
+		DeviceHeap_ReleaseNode( heap, nodeIndex );
+		heap->stats.blockCount--;
+		heap->stats.mappedBytes -= block->mapping.size;
+		Platform_UnmapMemory( &block->mapping );
+		heap->emptyBlockCount--;
+	}
+}
+
+/*
+================================================
+Slabs
+================================================
+*/
+static void Slab_Link( deviceHeap_t * heap, uint32 slabIndex ) {
+	deviceHeapSlab_t * slab = &heap->pSlabs[ slabIndex ];
+	uint32 head = heap->partialSlabs[ slab->sizeClass ];
+	slab->prev = DEVICE_HEAP_INVALID_INDEX;
+	slab->next = head;
+	if ( head != DEVICE_HEAP_INVALID_INDEX ) {
+		heap->pSlabs[ head ].prev = slabIndex;
+	}
+	heap->partialSlabs[ slab->sizeClass ] = slabIndex;
+}
+
+static void Slab_Unlink( deviceHeap_t * heap, uint32 slabIndex ) {
+	deviceHeapSlab_t * slab = &heap->pSlabs[ slabIndex ];
+	if ( slab->prev != DEVICE_HEAP_INVALID_INDEX ) {
+		heap->pSlabs[ slab->prev ].next = slab->next;
+	} else {
+		heap->partialSlabs[ slab->sizeClass ] = slab->next;
+	}
+	if ( slab->next != DEVICE_HEAP_INVALID_INDEX ) {
+		heap->pSlabs[ slab->next ].prev = slab->prev;
+	}
+	slab->prev = DEVICE_HEAP_INVALID_INDEX;
+	slab->next = DEVICE_HEAP_INVALID_INDEX;
+}
+
+static uint32 Slab_Create( deviceHeap_t * heap, uint32 sizeClass ) {
+	if ( heap->freeSlabHead == DEVICE_HEAP_INVALID_INDEX ) {
+		uint32 oldCapacity = heap->slabCapacity;
+		if ( !DeviceHeap_GrowArray( heap, &heap->pSlabs, &heap->slabCapacity, 16 ) ) {
+			return DEVICE_HEAP_INVALID_INDEX;
+		}
+		for ( uint32 i = oldCapacity; i < heap->slabCapacity; i++ ) {
+			heap->pSlabs[ i ].next = ( i + 1 < heap->slabCapacity ) ? i + 1 : DEVICE_HEAP_INVALID_INDEX;
+		}
+		heap->freeSlabHead = oldCapacity;
+	}
+	uint32 nodeIndex = DeviceHeap_AllocateRange( heap, DEVICE_HEAP_SLAB_SIZE );
+	if ( nodeIndex == DEVICE_HEAP_INVALID_INDEX ) {
+		return DEVICE_HEAP_INVALID_INDEX;
+	}
+	uint32 slabIndex = heap->freeSlabHead;
+	deviceHeapSlab_t * slab = &heap->pSlabs[ slabIndex ];
+	heap->freeSlabHead = slab->next;
+	memset( slab, 0, sizeof( *slab ) );
+
+	const deviceHeapNode_t & node = heap->pNodes[ nodeIndex ];
+	slab->base = reinterpret_cast< uint8 * >( heap->pBlocks[ node.block ].mapping.base ) + node.offset;
+	slab->node = nodeIndex;
+	slab->sizeClass = sizeClass;
+	slab->slotCount = ( uint32 )( DEVICE_HEAP_SLAB_SIZE / sizeClasses[ sizeClass ] );
+	slab->freeCount = slab->slotCount;
+	//Slots past slotCount are marked used so the search never has to bounds-check them
+	for ( uint32 i = slab->slotCount; i < DEVICE_HEAP_SLAB_SLOTS_MAX; i++ ) {
+		slab->usedSlots[ i >> 6 ] |= 1ULL << ( i & 63 );
+	}
+	Slab_Link( heap, slabIndex );
+	heap->stats.slabCount++;
+	return slabIndex;
+}
+
+static void Slab_Destroy( deviceHeap_t * heap, uint32 slabIndex ) {
+	Slab_Unlink( heap, slabIndex );
+	deviceHeapSlab_t * slab = &heap->pSlabs[ slabIndex ];
+	DeviceHeap_FreeRange( heap, slab->node );
+	slab->base = NULL;
+	slab->next = heap->freeSlabHead;
+	heap->freeSlabHead = slabIndex;
+	heap->stats.slabCount--;
+}
+
+static VkResult DeviceHeap_AllocateSmall( deviceHeap_t * heap, uint64 size, deviceAllocation_t * pAllocation ) {
+	uint32 sizeClass = heap->sizeClassForGranule[ ( size + DEVICE_HEAP_ALIGNMENT - 1 ) >> DEVICE_HEAP_ALIGNMENT_SHIFT ];
+	uint32 slabIndex = heap->partialSlabs[ sizeClass ];
+	if ( slabIndex == DEVICE_HEAP_INVALID_INDEX ) {
+		slabIndex = Slab_Create( heap, sizeClass );
+		if ( slabIndex == DEVICE_HEAP_INVALID_INDEX ) {
+			return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+		}
+	}
+	deviceHeapSlab_t * slab = &heap->pSlabs[ slabIndex ];
+	uint32 slot = 0;
+	for ( uint32 word = 0; word < ARRAY_LENGTH( slab->usedSlots ); word++ ) {
+		if ( ~slab->usedSlots[ word ] != 0 ) {
+			uint32 bit = LowestBitIndex64( ~slab->usedSlots[ word ] );
+			slab->usedSlots[ word ] |= 1ULL << bit;
+			slot = word * 64 + bit;
+			break;
+		}
+	}
+	slab->freeCount--;
+	if ( slab->freeCount == 0 ) {
+		Slab_Unlink( heap, slabIndex );
+	}
+	pAllocation->data = slab->base + slot * sizeClasses[ sizeClass ];
+	pAllocation->reservedSize = sizeClasses[ sizeClass ];
+	pAllocation->kind = deviceAllocationKind_t::SLAB;
+	pAllocation->index = slabIndex;
+	pAllocation->slot = slot;
+	return VK_SUCCESS;
+}
+
+static void DeviceHeap_FreeSmall( deviceHeap_t * heap, const deviceAllocation_t * pAllocation ) {
+	uint32 slabIndex = pAllocation->index;
+	deviceHeapSlab_t * slab = &heap->pSlabs[ slabIndex ];
+	slab->usedSlots[ pAllocation->slot >> 6 ] &= ~( 1ULL << ( pAllocation->slot & 63 ) );
+	if ( slab->freeCount == 0 ) {
+		Slab_Link( heap, slabIndex );
+	}
+	slab->freeCount++;
+	//Keep the last slab of a class around even when empty so a single alloc/free pair cannot thrash it
+	if ( slab->freeCount == slab->slotCount && ( slab->prev != DEVICE_HEAP_INVALID_INDEX || slab->next != DEVICE_HEAP_INVALID_INDEX ) ) {
+		Slab_Destroy( heap, slabIndex );
+	}
+}
+
+static VkResult DeviceHeap_AllocateDedicated( deviceHeap_t * heap, uint64 size, deviceAllocation_t * pAllocation ) {
+	uint32 index = DEVICE_HEAP_INVALID_INDEX;
+	for ( uint32 i = 0; i < heap->dedicatedCapacity; i++ ) {
+		if ( heap->pDedicated[ i ].base == NULL ) {
+			index = i;
+			break;
+		}
+	}
+	if ( index == DEVICE_HEAP_INVALID_INDEX ) {
+		index = heap->dedicatedCapacity;
+		if ( !DeviceHeap_GrowArray( heap, &heap->pDedicated, &heap->dedicatedCapacity, 4 ) ) {
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+	if ( !Platform_MapMemory( ( size_t )size, heap->largePages, &heap->pDedicated[ index ] ) ) {
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+	pAllocation->data = heap->pDedicated[ index ].base;
+	pAllocation->reservedSize = heap->pDedicated[ index ].size;
+	pAllocation->kind = deviceAllocationKind_t::DEDICATED;
+	pAllocation->index = index;
+	heap->stats.dedicatedCount++;
+	heap->stats.mappedBytes += heap->pDedicated[ index ].size;
+	return VK_SUCCESS;
+}
+
+void DeviceHeap_Init( deviceHeap_t * heap, const VkAllocationCallbacks * allocator, bool largePages ) {
+	memset( heap, 0, sizeof( *heap ) );
+	heap->allocator = allocator;
+	heap->largePages = largePages;
+	heap->freeNodeHead = DEVICE_HEAP_INVALID_INDEX;
+	heap->freeSlabHead = DEVICE_HEAP_INVALID_INDEX;
+	for ( uint32 i = 0; i < DEVICE_HEAP_TLSF_FL_COUNT; i++ ) {
+		for ( uint32 j = 0; j < DEVICE_HEAP_TLSF_SL_COUNT; j++ ) {
+			heap->freeRanges[ i ][ j ] = DEVICE_HEAP_INVALID_INDEX;
+		}
+	}
+	for ( uint32 i = 0; i < DEVICE_HEAP_SIZE_CLASS_COUNT; i++ ) {
+		heap->partialSlabs[ i ] = DEVICE_HEAP_INVALID_INDEX;
+	}
+	uint32 sizeClass = 0;
+	for ( uint32 granule = 0; granule < ARRAY_LENGTH( heap->sizeClassForGranule ); granule++ ) {
+		while ( sizeClasses[ sizeClass ] < granule * DEVICE_HEAP_ALIGNMENT ) {
+			sizeClass++;
+		}
+		heap->sizeClassForGranule[ granule ] = ( uint8 )sizeClass;
+	}
+	Platform_MutexInit( &heap->lock );
+}
+
+void DeviceHeap_Shutdown( deviceHeap_t * heap ) {
+#if defined( _DEBUG )
+	if ( heap->stats.allocationCount != 0 ) {
+		Platform_DebugPrintf( "DeviceHeap: %u allocations (%llu bytes) still live at shutdown\n", heap->stats.allocationCount, ( unsigned long long )heap->stats.allocatedBytes );
+	}
+#endif
+	for ( uint32 i = 0; i < heap->blockCapacity; i++ ) {
+		Platform_UnmapMemory( &heap->pBlocks[ i ].mapping );
+	}
+	for ( uint32 i = 0; i < heap->dedicatedCapacity; i++ ) {
+		Platform_UnmapMemory( &heap->pDedicated[ i ] );
+	}
+	heap->allocator->pfnFree( heap->allocator->pUserData, heap->pBlocks );
+	heap->allocator->pfnFree( heap->allocator->pUserData, heap->pNodes );
+	heap->allocator->pfnFree( heap->allocator->pUserData, heap->pSlabs );
+	heap->allocator->pfnFree( heap->allocator->pUserData, heap->pDedicated );
+	Platform_MutexDestroy( &heap->lock );
+	memset( heap, 0, sizeof( *heap ) );
+}
+
+VkResult DeviceHeap_Allocate( deviceHeap_t * heap, uint64 size, deviceAllocation_t * pAllocation ) {
+	memset( pAllocation, 0, sizeof( *pAllocation ) );
+	if ( size == 0 ) {
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+	VkResult result = VK_SUCCESS;
+	Platform_MutexLock( &heap->lock );
+	if ( size <= DEVICE_HEAP_SMALL_MAX ) {
+		result = DeviceHeap_AllocateSmall( heap, size, pAllocation );
+	} else if ( size >= DEVICE_HEAP_DEDICATED_THRESHOLD ) {
+		result = DeviceHeap_AllocateDedicated( heap, size, pAllocation );
+	} else {
+		uint32 nodeIndex = DeviceHeap_AllocateRange( heap, AlignToHeap( size ) );
+		if ( nodeIndex == DEVICE_HEAP_INVALID_INDEX ) {
+			result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+		} else {
+			const deviceHeapNode_t & node = heap->pNodes[ nodeIndex ];
+			pAllocation->data = reinterpret_cast< uint8 * >( heap->pBlocks[ node.block ].mapping.base ) + node.offset;
+			pAllocation->reservedSize = node.size;
+			pAllocation->kind = deviceAllocationKind_t::TLSF;
+			pAllocation->index = nodeIndex;
+		}
+	}
+	if ( result == VK_SUCCESS ) {
+		pAllocation->size = size;
+		heap->stats.allocationCount++;
+		heap->stats.allocatedBytes += size;
+		heap->stats.reservedBytes += pAllocation->reservedSize;
+	}
+	Platform_MutexUnlock( &heap->lock );
+	return result;
+}
+
+void DeviceHeap_Free( deviceHeap_t * heap, deviceAllocation_t * pAllocation ) {
+	if ( pAllocation->kind == deviceAllocationKind_t::NONE ) {
+		return;
+	}
+	Platform_MutexLock( &heap->lock );
+	switch ( pAllocation->kind ) {
+		case deviceAllocationKind_t::SLAB:
+			DeviceHeap_FreeSmall( heap, pAllocation );
+			break;
+		case deviceAllocationKind_t::TLSF:
+			DeviceHeap_FreeRange( heap, pAllocation->index );
+			break;
+		case deviceAllocationKind_t::DEDICATED:
+			heap->stats.dedicatedCount--;
+			heap->stats.mappedBytes -= heap->pDedicated[ pAllocation->index ].size;
+			Platform_UnmapMemory( &heap->pDedicated[ pAllocation->index ] );
+			break;
+		default:
+			break;
+	}
+	heap->stats.allocationCount--;
+	heap->stats.allocatedBytes -= pAllocation->size;
+	heap->stats.reservedBytes -= pAllocation->reservedSize;
+	Platform_MutexUnlock( &heap->lock );
+	memset( pAllocation, 0, sizeof( *pAllocation ) );
+}
+
+//Walks the free lists, so meant for tooling and debug output rather than per-frame use
+void DeviceHeap_GetStatistics( deviceHeap_t * heap, deviceHeapStatistics_t * pStatistics ) {
+	Platform_MutexLock( &heap->lock );
+	*pStatistics = heap->stats;
+	uint64 freeRangeBytes = 0;
+	for ( uint32 i = 0; i < DEVICE_HEAP_TLSF_FL_COUNT; i++ ) {
+		for ( uint32 j = 0; j < DEVICE_HEAP_TLSF_SL_COUNT; j++ ) {
+			for ( uint32 nodeIndex = heap->freeRanges[ i ][ j ]; nodeIndex != DEVICE_HEAP_INVALID_INDEX; nodeIndex = heap->pNodes[ nodeIndex ].nextFree ) {
+				uint64 size = heap->pNodes[ nodeIndex ].size;
+				freeRangeBytes += size;
+				if ( size > pStatistics->largestFreeRange ) {
+					pStatistics->largestFreeRange = size;
+				}
+				pStatistics->freeRangeCount++;
+			}
+		}
+	}
+	uint64 freeSlotBytes = 0;
+	for ( uint32 i = 0; i < heap->slabCapacity; i++ ) {
+		const deviceHeapSlab_t & slab = heap->pSlabs[ i ];
+		if ( slab.base != NULL ) {
+			freeSlotBytes += slab.freeCount * sizeClasses[ slab.sizeClass ];
+		}
+	}
+	Platform_MutexUnlock( &heap->lock );
+
+	pStatistics->freeBytes = freeRangeBytes + freeSlotBytes;
+	pStatistics->externalFragmentation = ( freeRangeBytes != 0 ) ? 1.0f - ( float )( ( double )pStatistics->largestFreeRange / ( double )freeRangeBytes ) : 0.0f;
+	pStatistics->internalFragmentation = ( pStatistics->reservedBytes != 0 ) ? 1.0f - ( float )( ( double )pStatistics->allocatedBytes / ( double )pStatistics->reservedBytes ) : 0.0f;
+}
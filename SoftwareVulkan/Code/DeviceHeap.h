@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Common.h"
+#include "Platform.h"
+#include "vulkan/vulkan.h"
+
+#define DEVICE_HEAP_ALIGNMENT_SHIFT 6
+#define DEVICE_HEAP_ALIGNMENT ( 1ULL << DEVICE_HEAP_ALIGNMENT_SHIFT )
+#define DEVICE_HEAP_BLOCK_SIZE ( 64ULL * 1024 * 1024 )
+//Anything this large gets its own mapping rather than pinning most of a shared block
+#define DEVICE_HEAP_DEDICATED_THRESHOLD ( DEVICE_HEAP_BLOCK_SIZE / 2 )
+#define DEVICE_HEAP_SLAB_SIZE ( 256ULL * 1024 )
+#define DEVICE_HEAP_SLAB_SLOTS_MAX ( DEVICE_HEAP_SLAB_SIZE / DEVICE_HEAP_ALIGNMENT )
+#define DEVICE_HEAP_SIZE_CLASS_COUNT 16
+#define DEVICE_HEAP_SMALL_MAX ( 16ULL * 1024 )
+#define DEVICE_HEAP_TLSF_SL_BITS 5
+#define DEVICE_HEAP_TLSF_SL_COUNT ( 1 << DEVICE_HEAP_TLSF_SL_BITS )
+#define DEVICE_HEAP_TLSF_FL_SHIFT ( DEVICE_HEAP_TLSF_SL_BITS + DEVICE_HEAP_ALIGNMENT_SHIFT )
+#define DEVICE_HEAP_TLSF_FL_COUNT 32
+#define DEVICE_HEAP_INVALID_INDEX 0xFFFFFFFF
+
+enum class deviceAllocationKind_t : uint32 {
+	NONE,
+	SLAB,
+	TLSF,
+	DEDICATED
+};
+
+//Everything DeviceHeap_Free needs, so the heap keeps no pointer-to-allocation lookup
+struct deviceAllocation_t {
+	void *					data;
+	uint64					size;			//bytes the caller asked for
+	uint64					reservedSize;	//bytes actually consumed, after size-class or alignment rounding
+	deviceAllocationKind_t	kind;
+	uint32					index;			//slab, TLSF node or dedicated mapping index, depending on kind
+	uint32					slot;			//slot within the slab
+};
+
+struct deviceHeapStatistics_t {
+	uint32	blockCount;
+	uint32	dedicatedCount;
+	uint32	slabCount;
+	uint32	allocationCount;
+	uint32	freeRangeCount;
+	uint64	mappedBytes;
+	uint64	allocatedBytes;
+	uint64	reservedBytes;
+	uint64	freeBytes;
+	uint64	largestFreeRange;
+	float	externalFragmentation;	//1 - largest free range / free TLSF bytes; 0 when free space is one range
+	float	internalFragmentation;	//1 - requested bytes / consumed bytes, the cost of size-class rounding
+};
+
+struct deviceHeapNode_t {
+	uint64	offset;
+	uint64	size;
+	uint32	block;
+	uint32	prevPhysical;
+	uint32	nextPhysical;
+	uint32	prevFree;
+	uint32	nextFree;
+	bool	isFree;
+};
+
+struct deviceHeapBlock_t {
+	platformMapping_t	mapping;
+	uint32				firstNode;
+	uint64				usedBytes;
+};
+
+struct deviceHeapSlab_t {
+	uint8 *		base;
+	uint32		node;
+	uint32		sizeClass;
+	uint32		slotCount;
+	uint32		freeCount;
+	uint32		prev;
+	uint32		next;
+	uint64		usedSlots[ DEVICE_HEAP_SLAB_SLOTS_MAX / 64 ];
+};
+
+/*
+================================================
+deviceHeap_t
+
+Suballocator behind vkAllocateMemory.  Device memory is carved out of large mapped blocks so steady-state
+allocation never touches the OS and never page-faults fresh pages:
+
+	- up to DEVICE_HEAP_SMALL_MAX, requests round to one of DEVICE_HEAP_SIZE_CLASS_COUNT classes and take
+	  a slot from a bitmap slab of that class
+	- larger requests are served by a two-level segregated fit (TLSF) allocator over the blocks, which
+	  finds a good fit in O(1) and coalesces neighbours on free
+	- requests past DEVICE_HEAP_DEDICATED_THRESHOLD get a dedicated mapping
+
+Every returned pointer is DEVICE_HEAP_ALIGNMENT aligned.  One completely empty block is kept mapped to
+absorb allocate/free churn; further empty blocks are returned to the OS.
+================================================
+*/
+struct deviceHeap_t {
+	const VkAllocationCallbacks *	allocator;
+	platformMutex_t					lock;
+	bool							largePages;
+
+	deviceHeapBlock_t *				pBlocks;
+	uint32							blockCapacity;
+	uint32							emptyBlockCount;
+
+	deviceHeapNode_t *				pNodes;
+	uint32							nodeCapacity;
+	uint32							freeNodeHead;
+
+	uint32							firstLevelBitmap;
+	uint32							secondLevelBitmap[ DEVICE_HEAP_TLSF_FL_COUNT ];
+	uint32							freeRanges[ DEVICE_HEAP_TLSF_FL_COUNT ][ DEVICE_HEAP_TLSF_SL_COUNT ];
+
+	deviceHeapSlab_t *				pSlabs;
+	uint32							slabCapacity;
+	uint32							freeSlabHead;
+	uint32							partialSlabs[ DEVICE_HEAP_SIZE_CLASS_COUNT ];
+	uint8							sizeClassForGranule[ DEVICE_HEAP_SMALL_MAX / DEVICE_HEAP_ALIGNMENT + 1 ];
+
+	platformMapping_t *				pDedicated;
+	uint32							dedicatedCapacity;
+
+	deviceHeapStatistics_t			stats;
+};
+
+void		DeviceHeap_Init( deviceHeap_t * heap, const VkAllocationCallbacks * allocator, bool largePages );
+void		DeviceHeap_Shutdown( deviceHeap_t * heap );
+VkResult	DeviceHeap_Allocate( deviceHeap_t * heap, uint64 size, deviceAllocation_t * pAllocation );
+void		DeviceHeap_Free( deviceHeap_t * heap, deviceAllocation_t * pAllocation );
+void		DeviceHeap_GetStatistics( deviceHeap_t * heap, deviceHeapStatistics_t * pStatistics );
@@ -0,0 +1,602 @@
+#include "Format.h"
+#include <math.h>
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+/*
+================================================
+Format table
+================================================
+*/
+#define FORMAT_BLIT ( VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT )
+#define FORMAT_SAMPLED ( FORMAT_BLIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT )
+#define FORMAT_FILTER ( FORMAT_SAMPLED | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT )
+#define FORMAT_ATTACHMENT ( FORMAT_FILTER | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT )
+#define FORMAT_DEPTH ( VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT )
+//Sampled and blitted from, never written by anything but copies
+#define FORMAT_COMPRESSED ( VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT )
+
+//Uncompressed formats have a block shift of 0 and decode to nothing
+static const formatInfo_t formats[] = {
+	{ VK_FORMAT_R8_UNORM,					1, 1, formatNumeric_t::UNORM,	false, { 8 }, { 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8_SNORM,					1, 1, formatNumeric_t::SNORM,	false, { 8 }, { 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8_UINT,					1, 1, formatNumeric_t::UINT,	false, { 8 }, { 0 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8_SINT,					1, 1, formatNumeric_t::SINT,	false, { 8 }, { 0 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8_SRGB,					1, 1, formatNumeric_t::SRGB,	false, { 8 }, { 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8_UNORM,					2, 2, formatNumeric_t::UNORM,	false, { 8, 8 }, { 0, 8 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8_SNORM,					2, 2, formatNumeric_t::SNORM,	false, { 8, 8 }, { 0, 8 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8_UINT,					2, 2, formatNumeric_t::UINT,	false, { 8, 8 }, { 0, 8 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8_SINT,					2, 2, formatNumeric_t::SINT,	false, { 8, 8 }, { 0, 8 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8_SRGB,					2, 2, formatNumeric_t::SRGB,	false, { 8, 8 }, { 0, 8 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8B8A8_UNORM,				4, 4, formatNumeric_t::UNORM,	false, { 8, 8, 8, 8 }, { 0, 8, 16, 24 }, FORMAT_ATTACHMENT, FORMAT_ATTACHMENT, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8B8A8_SNORM,				4, 4, formatNumeric_t::SNORM,	false, { 8, 8, 8, 8 }, { 0, 8, 16, 24 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8B8A8_UINT,				4, 4, formatNumeric_t::UINT,	false, { 8, 8, 8, 8 }, { 0, 8, 16, 24 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8B8A8_SINT,				4, 4, formatNumeric_t::SINT,	false, { 8, 8, 8, 8 }, { 0, 8, 16, 24 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R8G8B8A8_SRGB,				4, 4, formatNumeric_t::SRGB,	false, { 8, 8, 8, 8 }, { 0, 8, 16, 24 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_B8G8R8A8_UNORM,				4, 4, formatNumeric_t::UNORM,	false, { 8, 8, 8, 8 }, { 16, 8, 0, 24 }, FORMAT_ATTACHMENT, FORMAT_ATTACHMENT, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_B8G8R8A8_SRGB,				4, 4, formatNumeric_t::SRGB,	false, { 8, 8, 8, 8 }, { 16, 8, 0, 24 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16_UNORM,					2, 1, formatNumeric_t::UNORM,	false, { 16 }, { 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16_SNORM,					2, 1, formatNumeric_t::SNORM,	false, { 16 }, { 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16_UINT,					2, 1, formatNumeric_t::UINT,	false, { 16 }, { 0 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16_SINT,					2, 1, formatNumeric_t::SINT,	false, { 16 }, { 0 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16_SFLOAT,					2, 1, formatNumeric_t::SFLOAT,	false, { 16 }, { 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16_UNORM,				4, 2, formatNumeric_t::UNORM,	false, { 16, 16 }, { 0, 16 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16_SNORM,				4, 2, formatNumeric_t::SNORM,	false, { 16, 16 }, { 0, 16 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16_UINT,				4, 2, formatNumeric_t::UINT,	false, { 16, 16 }, { 0, 16 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16_SINT,				4, 2, formatNumeric_t::SINT,	false, { 16, 16 }, { 0, 16 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16_SFLOAT,				4, 2, formatNumeric_t::SFLOAT,	false, { 16, 16 }, { 0, 16 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16B16A16_UNORM,			8, 4, formatNumeric_t::UNORM,	false, { 16, 16, 16, 16 }, { 0, 16, 32, 48 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16B16A16_SNORM,			8, 4, formatNumeric_t::SNORM,	false, { 16, 16, 16, 16 }, { 0, 16, 32, 48 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16B16A16_UINT,			8, 4, formatNumeric_t::UINT,	false, { 16, 16, 16, 16 }, { 0, 16, 32, 48 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16B16A16_SINT,			8, 4, formatNumeric_t::SINT,	false, { 16, 16, 16, 16 }, { 0, 16, 32, 48 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R16G16B16A16_SFLOAT,		8, 4, formatNumeric_t::SFLOAT,	false, { 16, 16, 16, 16 }, { 0, 16, 32, 48 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32_UINT,					4, 1, formatNumeric_t::UINT,	false, { 32 }, { 0 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32_SINT,					4, 1, formatNumeric_t::SINT,	false, { 32 }, { 0 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32_SFLOAT,					4, 1, formatNumeric_t::SFLOAT,	false, { 32 }, { 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32G32_UINT,				8, 2, formatNumeric_t::UINT,	false, { 32, 32 }, { 0, 32 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32G32_SINT,				8, 2, formatNumeric_t::SINT,	false, { 32, 32 }, { 0, 32 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32G32_SFLOAT,				8, 2, formatNumeric_t::SFLOAT,	false, { 32, 32 }, { 0, 32 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32G32B32A32_UINT,			16, 4, formatNumeric_t::UINT,	false, { 32, 32, 32, 32 }, { 0, 32, 64, 96 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32G32B32A32_SINT,			16, 4, formatNumeric_t::SINT,	false, { 32, 32, 32, 32 }, { 0, 32, 64, 96 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R32G32B32A32_SFLOAT,		16, 4, formatNumeric_t::SFLOAT,	false, { 32, 32, 32, 32 }, { 0, 32, 64, 96 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R5G6B5_UNORM_PACK16,		2, 3, formatNumeric_t::UNORM,	false, { 5, 6, 5 }, { 11, 5, 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_B5G6R5_UNORM_PACK16,		2, 3, formatNumeric_t::UNORM,	false, { 5, 6, 5 }, { 0, 5, 11 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_A1R5G5B5_UNORM_PACK16,		2, 4, formatNumeric_t::UNORM,	false, { 5, 5, 5, 1 }, { 10, 5, 0, 15 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_R4G4B4A4_UNORM_PACK16,		2, 4, formatNumeric_t::UNORM,	false, { 4, 4, 4, 4 }, { 12, 8, 4, 0 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_A2R10G10B10_UNORM_PACK32,	4, 4, formatNumeric_t::UNORM,	false, { 10, 10, 10, 2 }, { 20, 10, 0, 30 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_A2B10G10R10_UNORM_PACK32,	4, 4, formatNumeric_t::UNORM,	false, { 10, 10, 10, 2 }, { 0, 10, 20, 30 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_A2B10G10R10_UINT_PACK32,	4, 4, formatNumeric_t::UINT,	false, { 10, 10, 10, 2 }, { 0, 10, 20, 30 }, FORMAT_SAMPLED, FORMAT_SAMPLED, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_B10G11R11_UFLOAT_PACK32,	4, 3, formatNumeric_t::UFLOAT,	false, { 11, 11, 10 }, { 0, 11, 22 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_E5B9G9R9_UFLOAT_PACK32,		4, 3, formatNumeric_t::UFLOAT,	true, { 9, 9, 9, 5 }, { 0, 9, 18, 27 }, FORMAT_FILTER, FORMAT_FILTER, 0, VK_FORMAT_UNDEFINED },
+	//Depth attachments are only ever tiled, which is what keeps an 8x8 block of the hierarchical depth in one tile
+	{ VK_FORMAT_D16_UNORM,					2, 1, formatNumeric_t::DEPTH_STENCIL, false, { 16 }, { 0 }, 0, FORMAT_DEPTH, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_D32_SFLOAT,					4, 1, formatNumeric_t::DEPTH_STENCIL, false, { 32 }, { 0 }, 0, FORMAT_DEPTH, 0, VK_FORMAT_UNDEFINED },
+	{ VK_FORMAT_D24_UNORM_S8_UINT,			4, 2, formatNumeric_t::DEPTH_STENCIL, false, { 24, 8 }, { 0, 24 }, 0, FORMAT_DEPTH, 0, VK_FORMAT_UNDEFINED },
+	//Block-compressed: no fields, bytes per 4x4 block, decoded into the last column
+	{ VK_FORMAT_BC1_RGB_UNORM_BLOCK,		8, 3, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_BC1_RGB_SRGB_BLOCK,			8, 3, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_BC1_RGBA_UNORM_BLOCK,		8, 4, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_BC1_RGBA_SRGB_BLOCK,		8, 4, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_BC2_UNORM_BLOCK,			16, 4, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_BC2_SRGB_BLOCK,				16, 4, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_BC3_UNORM_BLOCK,			16, 4, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_BC3_SRGB_BLOCK,				16, 4, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_BC4_UNORM_BLOCK,			8, 1, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16_UNORM },
+	{ VK_FORMAT_BC4_SNORM_BLOCK,			8, 1, formatNumeric_t::SNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16_SNORM },
+	{ VK_FORMAT_BC5_UNORM_BLOCK,			16, 2, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16G16_UNORM },
+	{ VK_FORMAT_BC5_SNORM_BLOCK,			16, 2, formatNumeric_t::SNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16G16_SNORM },
+	{ VK_FORMAT_BC6H_UFLOAT_BLOCK,			16, 3, formatNumeric_t::UFLOAT,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16G16B16A16_SFLOAT },
+	{ VK_FORMAT_BC6H_SFLOAT_BLOCK,			16, 3, formatNumeric_t::SFLOAT,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16G16B16A16_SFLOAT },
+	{ VK_FORMAT_BC7_UNORM_BLOCK,			16, 4, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_BC7_SRGB_BLOCK,				16, 4, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,	8, 3, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,		8, 3, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK,	8, 4, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK,	8, 4, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,	16, 4, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_UNORM },
+	{ VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,	16, 4, formatNumeric_t::SRGB,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R8G8B8A8_SRGB },
+	{ VK_FORMAT_EAC_R11_UNORM_BLOCK,		8, 1, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16_UNORM },
+	{ VK_FORMAT_EAC_R11_SNORM_BLOCK,		8, 1, formatNumeric_t::SNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16_SNORM },
+	{ VK_FORMAT_EAC_R11G11_UNORM_BLOCK,		16, 2, formatNumeric_t::UNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16G16_UNORM },
+	{ VK_FORMAT_EAC_R11G11_SNORM_BLOCK,		16, 2, formatNumeric_t::SNORM,	false, { 0 }, { 0 }, FORMAT_COMPRESSED, FORMAT_COMPRESSED, 2, VK_FORMAT_R16G16_SNORM },
+};
+
+const formatInfo_t * Format_Find( VkFormat format ) {
+	for ( uint32 i = 0; i < ARRAY_LENGTH( formats ); i++ ) {
+		if ( formats[ i ].format == format ) {
+			return &formats[ i ];
+		}
+	}
+	return NULL;
+}
+
+bool Format_IsInteger( const formatInfo_t * info ) {
+	return info->numeric == formatNumeric_t::UINT || info->numeric == formatNumeric_t::SINT;
+}
+
+/*
+================================================
+Scalar conversions
+================================================
+*/
+static uint32 FloatBits( float value ) {
+	uint32 bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	return bits;
+}
+
+static float BitsFloat( uint32 bits ) {
+	float value;
+	memcpy( &value, &bits, sizeof( value ) );
+	return value;
+}
+
+//Round to nearest even into a float with a 5-bit exponent biased by 15 and mantissaBits of mantissa, no sign
+static uint32 FloatToSmallFloat( uint32 magnitude, uint32 mantissaBits ) {
+	const uint32 shift = 23 - mantissaBits;
+	const uint32 infinity = 0x1F << mantissaBits;
+	if ( magnitude >= ( 127 + 16 ) << 23 ) {
+		return ( magnitude > 0x7F800000 ) ? infinity | ( 1 << ( mantissaBits - 1 ) ) : infinity;
+	}
+	if ( magnitude < ( 113 << 23 ) ) {
+		//Adding a power of two lines the result's mantissa up with the bottom of the float, rounded to nearest even
+		const uint32 magic = ( ( 127 - 15 ) + shift + 1 ) << 23;
+		return FloatBits( BitsFloat( magnitude ) + BitsFloat( magic ) ) - magic;
+	}
+	const uint32 odd = ( magnitude >> shift ) & 1;
+	return ( magnitude + ( ( uint32 )( 15 - 127 ) << 23 ) + ( 1 << ( shift - 1 ) ) - 1 + odd ) >> shift;
+}
+
+uint16 Format_FloatToHalf( float value ) {
+	const uint32 bits = FloatBits( value );
+	return ( uint16 )( ( ( bits >> 16 ) & 0x8000 ) | FloatToSmallFloat( bits & 0x7FFFFFFF, 10 ) );
+}
+
+float Format_HalfToFloat( uint16 value ) {
+	const uint32 shiftedExponent = 0x7C00 << 13;
+	uint32 bits = ( value & 0x7FFF ) << 13;
+	const uint32 exponent = bits & shiftedExponent;
+	bits += ( 127 - 15 ) << 23;
+	if ( exponent == shiftedExponent ) {
+		bits += ( 128 - 16 ) << 23;
+	} else if ( exponent == 0 ) {
+		//Denormals come out exact from one float subtraction
+		bits = FloatBits( BitsFloat( bits + ( 1 << 23 ) ) - BitsFloat( 113 << 23 ) );
+	}
+	return BitsFloat( bits | ( ( value & 0x8000 ) << 16 ) );
+}
+
+static const float srgbToLinear[ 256 ] = {
+	0.0f, 0.000303526991f, 0.000607053982f, 0.000910580973f, 0.00121410796f, 0.00151763496f, 0.00182116195f, 0.00212468882f,
+	0.00242821593f, 0.0027317428f, 0.00303526991f, 0.00334653584f, 0.00367650739f, 0.00402471703f, 0.00439144205f, 0.00477695325f,
+	0.00518151652f, 0.00560539169f, 0.00604883302f, 0.00651209056f, 0.00699541019f, 0.00749903219f, 0.00802319311f, 0.00856812578f,
+	0.00913405884f, 0.00972121768f, 0.010329823f, 0.0109600937f, 0.0116122449f, 0.012286488f, 0.0129830325f, 0.0137020834f,
+	0.0144438436f, 0.0152085144f, 0.0159962941f, 0.0168073755f, 0.0176419541f, 0.01850022f, 0.0193823613f, 0.0202885624f,
+	0.0212190095f, 0.0221738853f, 0.0231533665f, 0.0241576321f, 0.0251868591f, 0.0262412224f, 0.0273208916f, 0.02842604f,
+	0.0295568351f, 0.0307134446f, 0.0318960324f, 0.0331047662f, 0.0343398079f, 0.0356013142f, 0.0368894488f, 0.0382043719f,
+	0.0395462364f, 0.0409151986f, 0.0423114114f, 0.043735031f, 0.045186203f, 0.0466650873f, 0.0481718257f, 0.0497065671f,
+	0.0512694567f, 0.0528606474f, 0.054480277f, 0.0561284907f, 0.0578054301f, 0.0595112368f, 0.0612460524f, 0.0630100146f,
+	0.064803265f, 0.0666259378f, 0.0684781671f, 0.0703600943f, 0.0722718537f, 0.0742135718f, 0.0761853829f, 0.078187421f,
+	0.0802198201f, 0.0822827071f, 0.0843762085f, 0.0865004584f, 0.0886555836f, 0.0908417106f, 0.0930589661f, 0.0953074694f,
+	0.097587347f, 0.0998987257f, 0.102241732f, 0.104616486f, 0.107023105f, 0.10946171f, 0.111932427f, 0.114435375f,
+	0.116970666f, 0.119538426f, 0.122138776f, 0.124771819f, 0.127437681f, 0.130136475f, 0.13286832f, 0.135633335f,
+	0.138431609f, 0.141263291f, 0.144128472f, 0.147027269f, 0.149959788f, 0.152926147f, 0.155926466f, 0.158960834f,
+	0.162029371f, 0.165132195f, 0.168269396f, 0.171441108f, 0.174647406f, 0.177888423f, 0.18116425f, 0.18447499f,
+	0.187820777f, 0.191201687f, 0.194617838f, 0.198069319f, 0.20155625f, 0.205078736f, 0.208636865f, 0.212230757f,
+	0.215860501f, 0.219526201f, 0.223227963f, 0.226965874f, 0.230740055f, 0.23455058f, 0.238397568f, 0.242281124f,
+	0.246201321f, 0.25015828f, 0.254152089f, 0.258182853f, 0.262250662f, 0.266355604f, 0.270497799f, 0.274677306f,
+	0.278894275f, 0.283148736f, 0.287440836f, 0.291770637f, 0.296138257f, 0.300543785f, 0.304987311f, 0.309468925f,
+	0.313988715f, 0.318546772f, 0.323143214f, 0.327778101f, 0.332451522f, 0.337163627f, 0.341914415f, 0.346704066f,
+	0.351532608f, 0.356400132f, 0.361306787f, 0.366252601f, 0.371237695f, 0.376262128f, 0.38132602f, 0.386429429f,
+	0.391572475f, 0.396755219f, 0.401977777f, 0.407240212f, 0.412542611f, 0.417885065f, 0.423267663f, 0.428690493f,
+	0.434153646f, 0.439657182f, 0.445201188f, 0.450785786f, 0.456411034f, 0.462076992f, 0.467783809f, 0.473531485f,
+	0.479320168f, 0.48514995f, 0.491020858f, 0.496932983f, 0.502886474f, 0.50888133f, 0.514917672f, 0.520995557f,
+	0.527115107f, 0.533276379f, 0.539479494f, 0.545724452f, 0.55201143f, 0.558340371f, 0.564711511f, 0.571124852f,
+	0.577580452f, 0.584078431f, 0.590618849f, 0.597201765f, 0.603827357f, 0.610495567f, 0.617206573f, 0.623960376f,
+	0.630757153f, 0.637596846f, 0.644479692f, 0.651405632f, 0.658374846f, 0.665387273f, 0.672443151f, 0.679542482f,
+	0.686685324f, 0.693871737f, 0.701101899f, 0.708375752f, 0.715693474f, 0.723055124f, 0.730460763f, 0.73791039f,
+	0.745404184f, 0.752942204f, 0.760524511f, 0.768151164f, 0.775822222f, 0.783537805f, 0.791297913f, 0.799102724f,
+	0.806952238f, 0.814846575f, 0.822785735f, 0.830769897f, 0.838799f, 0.846873224f, 0.854992628f, 0.863157213f,
+	0.871367097f, 0.8796224f, 0.887923121f, 0.896269381f, 0.904661179f, 0.913098633f, 0.921581864f, 0.930110872f,
+	0.938685715f, 0.947306514f, 0.955973327f, 0.964686275f, 0.973445296f, 0.982250571f, 0.991102099f, 1.0f
+};
+
+/*
+Encoding goes through 104 linear pieces, eight per octave from 2^-13 up to 1, indexed straight from the
+float's exponent and top three mantissa bits.  Each piece is the chord of the curve raised by half its
+sag, so it stays within 0.6 of a step of the exact encoding; the bases include the 0.5 that rounds.
+*/
+#define FORMAT_SRGB_PIECES 104
+#define FORMAT_SRGB_MIN_BITS ( 114U << 23 )
+#define FORMAT_SRGB_MAX_BITS 0x3F7FFFFFU
+
+static const float srgbPieceBase[ FORMAT_SRGB_PIECES ] = {
+	0.902172863f, 0.952444434f, 1.00271606f, 1.05298769f, 1.10325933f, 1.15353084f, 1.20380247f, 1.2540741f,
+	1.30434573f, 1.40488887f, 1.50543213f, 1.60597539f, 1.70651853f, 1.80706179f, 1.90760493f, 2.00814819f,
+	2.10869145f, 2.30977774f, 2.51086426f, 2.71195078f, 2.91303706f, 3.11412358f, 3.31520987f, 3.51629639f,
+	3.71738291f, 4.11955547f, 4.52172852f, 4.92390156f, 5.32607412f, 5.72824717f, 6.13041973f, 6.53259277f,
+	6.93476582f, 7.73911142f, 8.54345703f, 9.34780312f, 10.1533432f, 10.9556255f, 11.7230511f, 12.4591513f,
+	13.171423f, 14.5130434f, 15.7704115f, 16.9564972f, 18.0812988f, 19.1527157f, 20.1771049f, 21.1596813f,
+	22.1104488f, 23.9012985f, 25.5796833f, 27.1629162f, 28.6643486f, 30.0945168f, 31.4619122f, 32.7734947f,
+	34.0426178f, 36.4331131f, 38.6734886f, 40.7868538f, 42.7910233f, 44.7000694f, 46.5253258f, 48.2760735f,
+	49.97015f, 53.1610794f, 56.1516228f, 58.9726257f, 61.6478729f, 64.1961441f, 66.6325684f, 68.9695358f,
+	71.2308578f, 75.490242f, 79.482132f, 83.2477188f, 86.8187485f, 90.2202759f, 93.4725113f, 96.5919952f,
+	99.6104965f, 105.296089f, 110.624626f, 115.651085f, 120.417831f, 124.958328f, 129.299545f, 133.463562f,
+	137.492767f, 145.082123f, 152.19487f, 158.904388f, 165.267227f, 171.328064f, 177.122894f, 182.681183f,
+	188.05954f, 198.190109f, 207.684494f, 216.64061f, 225.133987f, 233.224243f, 240.959412f, 248.37883f
+};
+
+static const float srgbPieceSlope[ FORMAT_SRGB_PIECES ] = {
+	4.79427413e-08f, 4.79427413e-08f, 4.79427413e-08f, 4.79427413e-08f, 4.79427413e-08f, 4.79427413e-08f, 4.79427413e-08f, 4.79427413e-08f,
+	9.58854827e-08f, 9.58854827e-08f, 9.58854827e-08f, 9.58854827e-08f, 9.58854827e-08f, 9.58854827e-08f, 9.58854827e-08f, 9.58854827e-08f,
+	1.91770965e-07f, 1.91770965e-07f, 1.91770965e-07f, 1.91770965e-07f, 1.91770965e-07f, 1.91770965e-07f, 1.91770965e-07f, 1.91770965e-07f,
+	3.83541931e-07f, 3.83541931e-07f, 3.83541931e-07f, 3.83541931e-07f, 3.83541931e-07f, 3.83541931e-07f, 3.83541931e-07f, 3.83541931e-07f,
+	7.67083861e-07f, 7.67083861e-07f, 7.67083861e-07f, 7.67083861e-07f, 7.6427807e-07f, 7.32085653e-07f, 7.02176635e-07f, 6.7536871e-07f,
+	1.28035754e-06f, 1.19979563e-06f, 1.13166698e-06f, 1.07311621e-06f, 1.02212391e-06f, 9.77217155e-07f, 9.3729335e-07f, 9.01509111e-07f,
+	1.70907231e-06f, 1.60153502e-06f, 1.51059419e-06f, 1.43243824e-06f, 1.36437166e-06f, 1.30442834e-06f, 1.2511365e-06f, 1.20337029e-06f,
+	2.28133786e-06f, 2.13779276e-06f, 2.01640137e-06f, 1.9120755e-06f, 1.82121767e-06f, 1.74120294e-06f, 1.67006692e-06f, 1.60630657e-06f,
+	3.04522064e-06f, 2.85361102e-06f, 2.69157272e-06f, 2.55231475e-06f, 2.43103386e-06f, 2.32422713e-06f, 2.22927179e-06f, 2.14416195e-06f,
+	4.06488198e-06f, 3.80911388e-06f, 3.59281876e-06f, 3.40693146e-06f, 3.24504094e-06f, 3.10247083e-06f, 2.97572092e-06f, 2.86211298e-06f,
+	5.42596626e-06f, 5.08455696e-06f, 4.79583741e-06f, 4.5477077e-06f, 4.33160994e-06f, 4.14130182e-06f, 3.97211079e-06f, 3.82046255e-06f,
+	7.24279607e-06f, 6.7870692e-06f, 6.40167491e-06f, 6.0704615e-06f, 5.7820057e-06f, 5.52797474e-06f, 5.30213174e-06f, 5.0997055e-06f,
+	9.66797325e-06f, 9.05965044e-06f, 8.54521113e-06f, 8.10309393e-06f, 7.71805207e-06f, 7.37896107e-06f, 7.07749678e-06f, 6.80728999e-06f
+};
+
+uint32 Format_LinearToSrgb( float value ) {
+	const float clamped = Min( Max( value, BitsFloat( FORMAT_SRGB_MIN_BITS ) ), BitsFloat( FORMAT_SRGB_MAX_BITS ) );
+	const uint32 bits = FloatBits( clamped );
+	const uint32 piece = ( bits - FORMAT_SRGB_MIN_BITS ) >> 20;
+	return ( uint32 )( srgbPieceBase[ piece ] + srgbPieceSlope[ piece ] * ( float )( bits & 0xFFFFF ) );
+}
+
+float Format_SrgbToLinear( uint32 value ) {
+	return srgbToLinear[ value & 0xFF ];
+}
+
+static uint32 ReadField( const uint8 * pTexel, uint32 shift, uint32 bits ) {
+	const uint8 * pBytes = pTexel + ( shift >> 3 );
+	const uint32 bitShift = shift & 7;
+	uint64 word = 0;
+	for ( uint32 i = 0; i < ( bitShift + bits + 7 ) >> 3; i++ ) {
+		word |= ( uint64 )pBytes[ i ] << ( i * 8 );
+	}
+	return ( uint32 )( ( word >> bitShift ) & ( ( 1ULL << bits ) - 1 ) );
+}
+
+//The texel must start out zeroed
+static void WriteField( uint8 * pTexel, uint32 shift, uint32 bits, uint32 value ) {
+	uint8 * pBytes = pTexel + ( shift >> 3 );
+	const uint32 bitShift = shift & 7;
+	const uint64 word = ( uint64 )( value & ( ( 1ULL << bits ) - 1 ) ) << bitShift;
+	for ( uint32 i = 0; i < ( bitShift + bits + 7 ) >> 3; i++ ) {
+		pBytes[ i ] |= ( uint8 )( word >> ( i * 8 ) );
+	}
+}
+
+static float UnormScale( uint32 bits ) {
+	return 1.0f / ( float )( ( 1U << bits ) - 1 );
+}
+
+static int32 SignExtend( uint32 raw, uint32 bits ) {
+	return ( bits == 32 ) ? ( int32 )raw : ( int32 )( raw << ( 32 - bits ) ) >> ( 32 - bits );
+}
+
+static uint32 UnpackComponent( const formatInfo_t * info, uint32 component, uint32 raw ) {
+	const uint32 bits = info->fieldBits[ component ];
+	switch ( info->numeric ) {
+		case formatNumeric_t::UNORM:
+			return FloatBits( ( float )raw * UnormScale( bits ) );
+		case formatNumeric_t::SNORM:
+			return FloatBits( Max( ( float )SignExtend( raw, bits ) * UnormScale( bits - 1 ), -1.0f ) );
+		case formatNumeric_t::UINT:
+			return raw;
+		case formatNumeric_t::SINT:
+			return ( uint32 )SignExtend( raw, bits );
+		case formatNumeric_t::SFLOAT:
+			return ( bits == 16 ) ? FloatBits( Format_HalfToFloat( ( uint16 )raw ) ) : raw;
+		case formatNumeric_t::UFLOAT:
+			//Small floats share the half's exponent, so widening the mantissa makes one
+			return FloatBits( Format_HalfToFloat( ( uint16 )( raw << ( 15 - bits ) ) ) );
+		case formatNumeric_t::SRGB:
+			return ( component < 3 ) ? FloatBits( Format_SrgbToLinear( raw ) ) : FloatBits( ( float )raw * UnormScale( bits ) );
+		case formatNumeric_t::DEPTH_STENCIL:
+			//Depth is a float or fixed point; D24S8's stencil is the integer
+			if ( component != 0 ) {
+				return raw;
+			}
+			return ( bits == 32 ) ? raw : FloatBits( ( float )raw * UnormScale( bits ) );
+		default:
+			return 0;
+	}
+}
+
+static uint32 PackComponent( const formatInfo_t * info, uint32 component, uint32 lane ) {
+	const uint32 bits = info->fieldBits[ component ];
+	const float value = BitsFloat( lane );
+	switch ( info->numeric ) {
+		case formatNumeric_t::UNORM:
+			return ( uint32 )( Min( Max( value, 0.0f ), 1.0f ) * ( float )( ( 1U << bits ) - 1 ) + 0.5f );
+		case formatNumeric_t::SNORM: {
+			const float scaled = Min( Max( value, -1.0f ), 1.0f ) * ( float )( ( 1U << ( bits - 1 ) ) - 1 );
+			return ( uint32 )( int32 )( ( scaled >= 0.0f ) ? scaled + 0.5f : scaled - 0.5f );
+		}
+		case formatNumeric_t::UINT:
+			return ( bits == 32 ) ? lane : Min( lane, ( 1U << bits ) - 1 );
+		case formatNumeric_t::SINT: {
+			if ( bits == 32 ) {
+				return lane;
+			}
+			const int32 limit = ( 1 << ( bits - 1 ) ) - 1;
+			return ( uint32 )Max( Min( ( int32 )lane, limit ), -limit - 1 );
+		}
+		case formatNumeric_t::SFLOAT:
+			return ( bits == 16 ) ? Format_FloatToHalf( value ) : lane;
+		case formatNumeric_t::UFLOAT:
+			return FloatToSmallFloat( FloatBits( Max( value, 0.0f ) ), bits - 5 );
+		case formatNumeric_t::SRGB:
+			return ( component < 3 ) ? Format_LinearToSrgb( value ) : ( uint32 )( Min( Max( value, 0.0f ), 1.0f ) * 255.0f + 0.5f );
+		case formatNumeric_t::DEPTH_STENCIL:
+			if ( component != 0 ) {
+				return Min( lane, ( 1U << bits ) - 1 );
+			}
+			return ( bits == 32 ) ? lane : ( uint32 )( Min( Max( value, 0.0f ), 1.0f ) * ( float )( ( 1U << bits ) - 1 ) + 0.5f );
+		default:
+			return 0;
+	}
+}
+
+//E5B9G9R9: three 9-bit mantissas scaled by one exponent biased by 15, with no implicit leading one
+static void UnpackSharedExponent( uint32 packed, uint32 * pTexel ) {
+	const float scale = ldexpf( 1.0f, ( int )( packed >> 27 ) - 15 - 9 );
+	for ( uint32 c = 0; c < 3; c++ ) {
+		pTexel[ c ] = FloatBits( ( float )( ( packed >> ( c * 9 ) ) & 0x1FF ) * scale );
+	}
+	pTexel[ 3 ] = FloatBits( 1.0f );
+}
+
+static uint32 PackSharedExponent( const uint32 * pTexel ) {
+	const float maxValue = 65408.0f;		//( 2^9 - 1 ) / 2^9 * 2^16
+	float rgb[ 3 ];
+	float largest = 0.0f;
+	for ( uint32 c = 0; c < 3; c++ ) {
+		rgb[ c ] = Min( Max( BitsFloat( pTexel[ c ] ), 0.0f ), maxValue );
+		largest = Max( largest, rgb[ c ] );
+	}
+	int exponent = -16;
+	if ( largest > 0.0f ) {
+		frexpf( largest, &exponent );
+		exponent = Max( exponent - 1, -16 );
+	}
+	exponent += 1 + 15;
+	if ( floorf( largest * ldexpf( 1.0f, 15 + 9 - exponent ) + 0.5f ) == 512.0f ) {
+		exponent++;
+	}
+	const float scale = ldexpf( 1.0f, 15 + 9 - exponent );
+	uint32 packed = ( uint32 )exponent << 27;
+	for ( uint32 c = 0; c < 3; c++ ) {
+		packed |= ( uint32 )floorf( rgb[ c ] * scale + 0.5f ) << ( c * 9 );
+	}
+	return packed;
+}
+
+static void Unpack_Generic( const formatInfo_t * info, const uint8 * pSrc, uint32 count, uint32 * pTexels ) {
+	const uint32 one = Format_IsInteger( info ) ? 1 : FloatBits( 1.0f );
+	for ( uint32 i = 0; i < count; i++ ) {
+		const uint8 * pTexel = pSrc + i * info->bytesPerTexel;
+		uint32 * pLanes = pTexels + i * FORMAT_TEXEL_LANES;
+		if ( info->sharedExponent ) {
+			UnpackSharedExponent( ReadField( pTexel, 0, 32 ), pLanes );
+			continue;
+		}
+		for ( uint32 c = 0; c < FORMAT_TEXEL_LANES; c++ ) {
+			if ( c < info->componentCount ) {
+				pLanes[ c ] = UnpackComponent( info, c, ReadField( pTexel, info->fieldShifts[ c ], info->fieldBits[ c ] ) );
+			} else {
+				pLanes[ c ] = ( c < 3 ) ? 0 : one;
+			}
+		}
+	}
+}
+
+static void Pack_Generic( const formatInfo_t * info, const uint32 * pTexels, uint32 count, uint8 * pDst ) {
+	for ( uint32 i = 0; i < count; i++ ) {
+		uint8 texel[ FORMAT_MAX_TEXEL_BYTES ];
+		memset( texel, 0, sizeof( texel ) );
+		const uint32 * pLanes = pTexels + i * FORMAT_TEXEL_LANES;
+		if ( info->sharedExponent ) {
+			WriteField( texel, 0, 32, PackSharedExponent( pLanes ) );
+		} else {
+			for ( uint32 c = 0; c < info->componentCount; c++ ) {
+				WriteField( texel, info->fieldShifts[ c ], info->fieldBits[ c ], PackComponent( info, c, pLanes[ c ] ) );
+			}
+		}
+		memcpy( pDst + i * info->bytesPerTexel, texel, info->bytesPerTexel );
+	}
+}
+
+//Four 32-bit components are already unpacked texels, whatever they mean
+static void Unpack_Copy128( const formatInfo_t *, const uint8 * pSrc, uint32 count, uint32 * pTexels ) {
+	memcpy( pTexels, pSrc, ( size_t )count * FORMAT_MAX_TEXEL_BYTES );
+}
+
+static void Pack_Copy128( const formatInfo_t *, const uint32 * pTexels, uint32 count, uint8 * pDst ) {
+	memcpy( pDst, pTexels, ( size_t )count * FORMAT_MAX_TEXEL_BYTES );
+}
+
+/*
+================================================
+SSE4.1 kernels
+
+One texel per register, components in lanes.  Each kernel runs the same float operations in the same
+order as the scalar reference, and min and max with the constant second return it for NaN exactly as
+the scalar Min and Max do, so both produce the same bits.
+================================================
+*/
+#if CPU_X86
+
+//Moves blue to lane 0 and red to lane 2; its own inverse
+#define FORMAT_SWIZZLE_BGRA _MM_SHUFFLE( 3, 0, 1, 2 )
+
+CPU_TARGET( "sse4.1" ) static void Unpack_Unorm8_SSE41( const formatInfo_t * info, const uint8 * pSrc, uint32 count, uint32 * pTexels ) {
+	const __m128 scale = _mm_set1_ps( 1.0f / 255.0f );
+	const bool bgra = ( info->fieldShifts[ 0 ] != 0 );
+	for ( uint32 i = 0; i < count; i++ ) {
+		int32 packed;
+		memcpy( &packed, pSrc + i * 4, sizeof( packed ) );
+		__m128i components = _mm_cvtepu8_epi32( _mm_cvtsi32_si128( packed ) );
+		if ( bgra ) {
+			components = _mm_shuffle_epi32( components, FORMAT_SWIZZLE_BGRA );
+		}
+		_mm_storeu_ps( reinterpret_cast< float * >( pTexels + i * FORMAT_TEXEL_LANES ), _mm_mul_ps( _mm_cvtepi32_ps( components ), scale ) );
+	}
+}
+
+CPU_TARGET( "sse4.1" ) static void Pack_Unorm8_SSE41( const formatInfo_t * info, const uint32 * pTexels, uint32 count, uint8 * pDst ) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 scale = _mm_set1_ps( 255.0f );
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const bool bgra = ( info->fieldShifts[ 0 ] != 0 );
+	for ( uint32 i = 0; i < count; i++ ) {
+		const __m128 value = _mm_loadu_ps( reinterpret_cast< const float * >( pTexels + i * FORMAT_TEXEL_LANES ) );
+		__m128i components = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_min_ps( _mm_max_ps( value, zero ), one ), scale ), half ) );
+		if ( bgra ) {
+			components = _mm_shuffle_epi32( components, FORMAT_SWIZZLE_BGRA );
+		}
+		const int32 packed = _mm_cvtsi128_si32( _mm_packus_epi16( _mm_packus_epi32( components, components ), components ) );
+		memcpy( pDst + i * 4, &packed, sizeof( packed ) );
+	}
+}
+
+//Decoding is a table lookup per component; encoding evaluates the pieces four components at a time
+CPU_TARGET( "sse4.1" ) static void Pack_Srgb8_SSE41( const formatInfo_t * info, const uint32 * pTexels, uint32 count, uint8 * pDst ) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 scale = _mm_set1_ps( 255.0f );
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 low = _mm_set1_ps( BitsFloat( FORMAT_SRGB_MIN_BITS ) );
+	const __m128 high = _mm_set1_ps( BitsFloat( FORMAT_SRGB_MAX_BITS ) );
+	const __m128i minBits = _mm_set1_epi32( ( int32 )FORMAT_SRGB_MIN_BITS );
+	const __m128i fraction = _mm_set1_epi32( 0xFFFFF );
+	const bool bgra = ( info->fieldShifts[ 0 ] != 0 );
+	for ( uint32 i = 0; i < count; i++ ) {
+		const __m128 value = _mm_loadu_ps( reinterpret_cast< const float * >( pTexels + i * FORMAT_TEXEL_LANES ) );
+		const __m128i bits = _mm_castps_si128( _mm_min_ps( _mm_max_ps( value, low ), high ) );
+		alignas( 16 ) uint32 pieces[ 4 ];
+		_mm_store_si128( reinterpret_cast< __m128i * >( pieces ), _mm_srli_epi32( _mm_sub_epi32( bits, minBits ), 20 ) );
+		const __m128 base = _mm_setr_ps( srgbPieceBase[ pieces[ 0 ] ], srgbPieceBase[ pieces[ 1 ] ], srgbPieceBase[ pieces[ 2 ] ], 0.0f );
+		const __m128 slope = _mm_setr_ps( srgbPieceSlope[ pieces[ 0 ] ], srgbPieceSlope[ pieces[ 1 ] ], srgbPieceSlope[ pieces[ 2 ] ], 0.0f );
+		const __m128 encoded = _mm_add_ps( base, _mm_mul_ps( slope, _mm_cvtepi32_ps( _mm_and_si128( bits, fraction ) ) ) );
+		const __m128 alpha = _mm_add_ps( _mm_mul_ps( _mm_min_ps( _mm_max_ps( value, zero ), one ), scale ), half );
+		__m128i components = _mm_cvttps_epi32( _mm_blend_ps( encoded, alpha, 0x8 ) );
+		if ( bgra ) {
+			components = _mm_shuffle_epi32( components, FORMAT_SWIZZLE_BGRA );
+		}
+		const int32 packed = _mm_cvtsi128_si32( _mm_packus_epi16( _mm_packus_epi32( components, components ), components ) );
+		memcpy( pDst + i * 4, &packed, sizeof( packed ) );
+	}
+}
+
+//R16, R16G16 and R16G16B16A16 floats; components the format lacks come out as ( 0, 0, 0, 1 ) like the scalar path
+CPU_TARGET( "sse4.1" ) static void Unpack_Half_SSE41( const formatInfo_t * info, const uint8 * pSrc, uint32 count, uint32 * pTexels ) {
+	const __m128i magnitudeMask = _mm_set1_epi32( 0x7FFF );
+	const __m128i shiftedExponent = _mm_set1_epi32( 0x7C00 << 13 );
+	const __m128i rebias = _mm_set1_epi32( ( 127 - 15 ) << 23 );
+	const __m128i infinityRebias = _mm_set1_epi32( ( 128 - 16 ) << 23 );
+	const __m128i denormalRebias = _mm_set1_epi32( 1 << 23 );
+	const __m128 denormalMagic = _mm_castsi128_ps( _mm_set1_epi32( 113 << 23 ) );
+	const __m128i signMask = _mm_set1_epi32( 0x8000 );
+	const __m128i missing = _mm_cmpgt_epi32( _mm_setr_epi32( 0, 1, 2, 3 ), _mm_set1_epi32( info->componentCount - 1 ) );
+	const __m128i defaults = _mm_setr_epi32( 0, 0, 0, 0x3F800000 );
+	const uint32 bytesPerTexel = info->bytesPerTexel;
+	for ( uint32 i = 0; i < count; i++ ) {
+		uint64 packed = 0;
+		memcpy( &packed, pSrc + i * bytesPerTexel, bytesPerTexel );
+		const __m128i halves = _mm_cvtepu16_epi32( _mm_loadl_epi64( reinterpret_cast< const __m128i * >( &packed ) ) );
+		__m128i bits = _mm_slli_epi32( _mm_and_si128( halves, magnitudeMask ), 13 );
+		const __m128i exponent = _mm_and_si128( bits, shiftedExponent );
+		bits = _mm_add_epi32( bits, rebias );
+		const __m128i special = _mm_cmpeq_epi32( exponent, shiftedExponent );
+		const __m128i denormal = _mm_cmpeq_epi32( exponent, _mm_setzero_si128() );
+		bits = _mm_add_epi32( bits, _mm_and_si128( special, infinityRebias ) );
+		const __m128i renormalized = _mm_castps_si128( _mm_sub_ps( _mm_castsi128_ps( _mm_add_epi32( bits, denormalRebias ) ), denormalMagic ) );
+		bits = _mm_blendv_epi8( bits, renormalized, denormal );
+		bits = _mm_or_si128( bits, _mm_slli_epi32( _mm_and_si128( halves, signMask ), 16 ) );
+		bits = _mm_blendv_epi8( bits, defaults, missing );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( pTexels + i * FORMAT_TEXEL_LANES ), bits );
+	}
+}
+
+CPU_TARGET( "sse4.1" ) static void Pack_Half_SSE41( const formatInfo_t * info, const uint32 * pTexels, uint32 count, uint8 * pDst ) {
+	const __m128i signMask = _mm_set1_epi32( ( int32 )0x80000000 );
+	const __m128i overflow = _mm_set1_epi32( ( ( 127 + 16 ) << 23 ) - 1 );
+	const __m128i infinity = _mm_set1_epi32( 0x7F800000 );
+	const __m128i halfInfinity = _mm_set1_epi32( 0x7C00 );
+	const __m128i halfNan = _mm_set1_epi32( 0x7E00 );
+	const __m128i smallest = _mm_set1_epi32( 113 << 23 );
+	const __m128i denormalMagic = _mm_set1_epi32( ( ( 127 - 15 ) + 13 + 1 ) << 23 );
+	const __m128i rebias = _mm_set1_epi32( ( int32 )( ( uint32 )( 15 - 127 ) << 23 ) + 0xFFF );
+	const __m128i one = _mm_set1_epi32( 1 );
+	const uint32 bytesPerTexel = info->bytesPerTexel;
+	for ( uint32 i = 0; i < count; i++ ) {
+		__m128i bits = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pTexels + i * FORMAT_TEXEL_LANES ) );
+		const __m128i sign = _mm_and_si128( bits, signMask );
+		bits = _mm_xor_si128( bits, sign );
+		const __m128i special = _mm_blendv_epi8( halfInfinity, halfNan, _mm_cmpgt_epi32( bits, infinity ) );
+		const __m128i denormal = _mm_sub_epi32( _mm_castps_si128( _mm_add_ps( _mm_castsi128_ps( bits ), _mm_castsi128_ps( denormalMagic ) ) ), denormalMagic );
+		const __m128i odd = _mm_and_si128( _mm_srli_epi32( bits, 13 ), one );
+		const __m128i normal = _mm_srli_epi32( _mm_add_epi32( _mm_add_epi32( bits, rebias ), odd ), 13 );
+		__m128i result = _mm_blendv_epi8( normal, denormal, _mm_cmplt_epi32( bits, smallest ) );
+		result = _mm_blendv_epi8( result, special, _mm_cmpgt_epi32( bits, overflow ) );
+		result = _mm_or_si128( result, _mm_srli_epi32( sign, 16 ) );
+		uint64 packed;
+		_mm_storel_epi64( reinterpret_cast< __m128i * >( &packed ), _mm_packus_epi32( result, result ) );
+		memcpy( pDst + i * bytesPerTexel, &packed, bytesPerTexel );
+	}
+}
+
+#endif
+
+bool Format_SelectConverter( VkFormat format, cpuIsa_t isa, formatConverter_t * pConverter ) {
+	const formatInfo_t * info = Format_Find( format );
+	if ( info == NULL || info->blockShift != 0 ) {
+		return false;
+	}
+	pConverter->info = info;
+	pConverter->unpack = Unpack_Generic;
+	pConverter->pack = Pack_Generic;
+	if ( info->bytesPerTexel == 16 ) {
+		pConverter->unpack = Unpack_Copy128;
+		pConverter->pack = Pack_Copy128;
+		return true;
+	}
+#if CPU_X86
+	if ( isa >= cpuIsa_t::SSE41 ) {
+		switch ( format ) {
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+				pConverter->unpack = Unpack_Unorm8_SSE41;
+				pConverter->pack = Pack_Unorm8_SSE41;
+				break;
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+				pConverter->pack = Pack_Srgb8_SSE41;
+				break;
+			case VK_FORMAT_R16_SFLOAT:
+			case VK_FORMAT_R16G16_SFLOAT:
+			case VK_FORMAT_R16G16B16A16_SFLOAT:
+				pConverter->unpack = Unpack_Half_SSE41;
+				pConverter->pack = Pack_Half_SSE41;
+				break;
+			default:
+				break;
+		}
+	}
+#else
+	( void )isa;
+#endif
+	return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Common.h"
+#include "Cpu.h"
+#include "vulkan/vulkan.h"
+
+//Unpacked texels are four 32-bit lanes in RGBA order, 16 bytes each
+#define FORMAT_TEXEL_LANES 4
+#define FORMAT_MAX_TEXEL_BYTES 16
+//A decoded 4x4 block; no compressed format decodes to more than 8 bytes a texel
+#define FORMAT_MAX_DECODED_BLOCK_BYTES ( 16 * 8 )
+
+//What a component's bits mean, and so what its lane holds once unpacked
+enum class formatNumeric_t : uint8 {
+	UNORM,					//lane is a float in [ 0, 1 ]
+	SNORM,					//float in [ -1, 1 ]
+	UINT,					//the integer itself
+	SINT,
+	SFLOAT,					//float; 16-bit fields are halves
+	UFLOAT,					//float from an unsigned 10 or 11-bit small float, or a shared exponent format
+	SRGB,					//float in [ 0, 1 ]; red, green and blue are decoded to linear, alpha is UNORM
+	DEPTH_STENCIL			//depth is a float in [ 0, 1 ] whether stored as float or fixed point, stencil an integer
+};
+
+/*
+================================================
+formatInfo_t
+
+One row of the format table.  Every color format is described the same way, as up to four bit fields
+within a texel read as a little-endian integer: R8G8B8A8 has fields at bits 0, 8, 16 and 24, B8G8R8A8
+has red at 16 and blue at 0, and packed formats such as A2B10G10R10 are no different.  The generic
+converters need nothing else; the common formats get vector kernels on top that produce the same bits.
+Block-compressed formats have no fields and no converters of their own; their blocks are decoded into an
+uncompressed format that has them.
+================================================
+*/
+//Decodes one 4x4 block into 16 texels of its format's decodedFormat, row by row
+typedef void ( * formatDecodeFunc_t )( const uint8 * pBlock, uint8 * pTexels );
+
+struct formatInfo_t {
+	VkFormat				format;
+	uint8					bytesPerTexel;
+	uint8					componentCount;
+	formatNumeric_t			numeric;
+	bool					sharedExponent;		//E5B9G9R9: the fourth field is the exponent of the other three
+	uint8					fieldBits[ 4 ];		//per RGBA component
+	uint8					fieldShifts[ 4 ];
+	VkFormatFeatureFlags	linearFeatures;
+	VkFormatFeatureFlags	optimalFeatures;
+	uint8					blockShift;			//2 for block-compressed formats, whose bytesPerTexel is per 4x4 block
+	VkFormat				decodedFormat;		//what their blocks decode to, a format with converters
+};
+
+typedef void ( * formatUnpackFunc_t )( const formatInfo_t * info, const uint8 * pSrc, uint32 count, uint32 * pTexels );
+typedef void ( * formatPackFunc_t )( const formatInfo_t * info, const uint32 * pTexels, uint32 count, uint8 * pDst );
+
+//Converts whole runs of texels between memory and unpacked lanes; missing components unpack as ( 0, 0, 0, 1 )
+struct formatConverter_t {
+	const formatInfo_t *	info;
+	formatUnpackFunc_t		unpack;
+	formatPackFunc_t		pack;
+};
+
+//NULL for formats the device does not support
+const formatInfo_t *	Format_Find( VkFormat format );
+//isa picks the widest kernels the host runs; false for formats the device does not support and block-compressed ones
+bool					Format_SelectConverter( VkFormat format, cpuIsa_t isa, formatConverter_t * pConverter );
+//NULL for formats that are not block-compressed
+formatDecodeFunc_t		Format_SelectDecoder( VkFormat format, cpuIsa_t isa );
+bool					Format_IsInteger( const formatInfo_t * info );
+
+//Single values, for clear colors and the like; these are the reference every kernel matches
+uint16					Format_FloatToHalf( float value );
+float					Format_HalfToFloat( uint16 value );
+uint32					Format_LinearToSrgb( float value );
+float					Format_SrgbToLinear( uint32 value );
@@ -0,0 +1,951 @@
+#include "Format.h"
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+/*
+================================================
+Block decoders
+
+Every decoder writes the 16 texels of one 4x4 block row by row in the block's decodedFormat.  BC1 to BC3
+and ETC2 colors decode to RGBA8, leaving sRGB to the converter of the sRGB decoded format; the single and
+two channel formats decode to 16-bit UNORM or SNORM so that their interpolated values keep more than 8 bits,
+and BC6H decodes to the half floats its endpoints are made of.  BC blocks are little-endian, ETC2 and EAC
+blocks big-endian.
+================================================
+*/
+#define BLOCK_TEXELS 16
+
+static uint32 Block_Load32( const uint8 * p ) {
+	return ( uint32 )p[ 0 ] | ( ( uint32 )p[ 1 ] << 8 ) | ( ( uint32 )p[ 2 ] << 16 ) | ( ( uint32 )p[ 3 ] << 24 );
+}
+
+static uint64 Block_Load64( const uint8 * p ) {
+	return ( uint64 )Block_Load32( p ) | ( ( uint64 )Block_Load32( p + 4 ) << 32 );
+}
+
+static uint64 Block_Load64BigEndian( const uint8 * p ) {
+	uint64 value = 0;
+	for ( uint32 i = 0; i < 8; i++ ) {
+		value = ( value << 8 ) | p[ i ];
+	}
+	return value;
+}
+
+static uint32 Block_Rgba( uint32 r, uint32 g, uint32 b, uint32 a ) {
+	return r | ( g << 8 ) | ( b << 16 ) | ( a << 24 );
+}
+
+static int32 Block_Clamp( int32 value, int32 low, int32 high ) {
+	return ( value < low ) ? low : ( ( value > high ) ? high : value );
+}
+
+static int32 Block_Signed8( uint8 value ) {
+	return ( int32 )value - ( ( int32 )( value & 0x80 ) << 1 );
+}
+
+static void Block_Store( uint8 * pTexels, const void * pValues, uint32 bytesPerTexel ) {
+	memcpy( pTexels, pValues, BLOCK_TEXELS * bytesPerTexel );
+}
+
+/*
+================================================
+BC1 to BC5
+
+The palettes are built in scalar code; the kernels only expand the 16 indices through them, which is
+where the time goes.  Both versions of each kernel are plain table lookups, so they agree bit for bit.
+================================================
+*/
+//16 2-bit indices, texel i at bit 2i, through a palette of 4 RGBA8 colors
+typedef void ( * blockColorExpandFunc_t )( const uint32 * pPalette, uint32 indices, uint32 * pTexels );
+//16 3-bit indices, texel i at bit 3i, through a palette of 8 16-bit values
+typedef void ( * blockValueExpandFunc_t )( const uint16 * pPalette, uint64 indices, uint16 * pValues );
+
+static void Block_ExpandColors( const uint32 * pPalette, uint32 indices, uint32 * pTexels ) {
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		pTexels[ i ] = pPalette[ ( indices >> ( 2 * i ) ) & 3 ];
+	}
+}
+
+static void Block_ExpandValues( const uint16 * pPalette, uint64 indices, uint16 * pValues ) {
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		pValues[ i ] = pPalette[ ( indices >> ( 3 * i ) ) & 7 ];
+	}
+}
+
+#if CPU_X86
+//Each lane's index is shifted to the bottom by a multiply, then turned into the byte offsets of its palette entry
+CPU_TARGET( "sse4.1" ) static void Block_ExpandColors_SSE41( const uint32 * pPalette, uint32 indices, uint32 * pTexels ) {
+	const __m128i palette = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pPalette ) );
+	const __m128i shifts = _mm_setr_epi32( 64, 16, 4, 1 );
+	for ( uint32 row = 0; row < 4; row++ ) {
+		const __m128i rowIndices = _mm_set1_epi32( ( int32 )( ( indices >> ( 8 * row ) ) & 0xFF ) );
+		const __m128i select = _mm_and_si128( _mm_srli_epi32( _mm_mullo_epi32( rowIndices, shifts ), 6 ), _mm_set1_epi32( 3 ) );
+		const __m128i control = _mm_add_epi32( _mm_mullo_epi32( select, _mm_set1_epi32( 0x04040404 ) ), _mm_set1_epi32( 0x03020100 ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( pTexels + 4 * row ), _mm_shuffle_epi8( palette, control ) );
+	}
+}
+
+//Eight 16-bit entries fill one register, so a byte shuffle looks up eight values at once
+CPU_TARGET( "sse4.1" ) static void Block_ExpandValues_SSE41( const uint16 * pPalette, uint64 indices, uint16 * pValues ) {
+	const __m128i palette = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pPalette ) );
+	const __m128i shifts = _mm_setr_epi32( 512, 64, 8, 1 );
+	for ( uint32 half = 0; half < 2; half++ ) {
+		const uint32 bits = ( uint32 )( indices >> ( 24 * half ) ) & 0xFFFFFF;
+		const __m128i low = _mm_set1_epi32( ( int32 )( bits & 0xFFF ) );
+		const __m128i high = _mm_set1_epi32( ( int32 )( bits >> 12 ) );
+		const __m128i lowSelect = _mm_and_si128( _mm_srli_epi32( _mm_mullo_epi32( low, shifts ), 9 ), _mm_set1_epi32( 7 ) );
+		const __m128i highSelect = _mm_and_si128( _mm_srli_epi32( _mm_mullo_epi32( high, shifts ), 9 ), _mm_set1_epi32( 7 ) );
+		const __m128i select = _mm_packus_epi32( lowSelect, highSelect );
+		const __m128i control = _mm_add_epi16( _mm_mullo_epi16( select, _mm_set1_epi16( 0x0202 ) ), _mm_set1_epi16( 0x0100 ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( pValues + 8 * half ), _mm_shuffle_epi8( palette, control ) );
+	}
+}
+#endif
+
+//RGB565 endpoints with their top bits replicated down; threeColor allows the mode where color0 <= color1
+static void Block_ColorPalette( const uint8 * pBlock, bool threeColor, bool punchThrough, uint32 * pPalette ) {
+	const uint32 color0 = pBlock[ 0 ] | ( pBlock[ 1 ] << 8 );
+	const uint32 color1 = pBlock[ 2 ] | ( pBlock[ 3 ] << 8 );
+	uint32 endpoints[ 2 ][ 3 ];
+	const uint32 colors[ 2 ] = { color0, color1 };
+	for ( uint32 e = 0; e < 2; e++ ) {
+		const uint32 r = ( colors[ e ] >> 11 ) & 0x1F;
+		const uint32 g = ( colors[ e ] >> 5 ) & 0x3F;
+		const uint32 b = colors[ e ] & 0x1F;
+		endpoints[ e ][ 0 ] = ( r << 3 ) | ( r >> 2 );
+		endpoints[ e ][ 1 ] = ( g << 2 ) | ( g >> 4 );
+		endpoints[ e ][ 2 ] = ( b << 3 ) | ( b >> 2 );
+	}
+	uint32 palette[ 4 ][ 3 ];
+	for ( uint32 c = 0; c < 3; c++ ) {
+		const uint32 a = endpoints[ 0 ][ c ];
+		const uint32 b = endpoints[ 1 ][ c ];
+		palette[ 0 ][ c ] = a;
+		palette[ 1 ][ c ] = b;
+		if ( !threeColor || color0 > color1 ) {
+			palette[ 2 ][ c ] = ( 2 * a + b + 1 ) / 3;
+			palette[ 3 ][ c ] = ( a + 2 * b + 1 ) / 3;
+		} else {
+			palette[ 2 ][ c ] = ( a + b + 1 ) / 2;
+			palette[ 3 ][ c ] = 0;
+		}
+	}
+	for ( uint32 i = 0; i < 4; i++ ) {
+		pPalette[ i ] = Block_Rgba( palette[ i ][ 0 ], palette[ i ][ 1 ], palette[ i ][ 2 ], 0xFF );
+	}
+	if ( threeColor && color0 <= color1 && punchThrough ) {
+		pPalette[ 3 ] = 0;
+	}
+}
+
+//The eight values of a BC4 channel as fractions of its range: weights of the two endpoints over a divisor
+static void Block_ValueWeights( bool eightValues, uint32 index, int32 * pWeight0, int32 * pWeight1, int32 * pDivisor ) {
+	if ( eightValues ) {
+		static const int32 weights[ 8 ] = { 7, 0, 6, 5, 4, 3, 2, 1 };
+		*pWeight0 = weights[ index ];
+		*pWeight1 = 7 - weights[ index ];
+		*pDivisor = 7;
+	} else {
+		static const int32 weights[ 6 ] = { 5, 0, 4, 3, 2, 1 };
+		*pWeight0 = weights[ index ];
+		*pWeight1 = 5 - weights[ index ];
+		*pDivisor = 5;
+	}
+}
+
+//A BC4 block's palette scaled to full 16-bit UNORM or SNORM, or to 8-bit UNORM for BC3 alpha
+static void Block_ValuePalette( const uint8 * pBlock, bool isSigned, uint32 maxValue, uint16 * pPalette ) {
+	const int32 value0 = isSigned ? Block_Clamp( Block_Signed8( pBlock[ 0 ] ), -127, 127 ) : pBlock[ 0 ];
+	const int32 value1 = isSigned ? Block_Clamp( Block_Signed8( pBlock[ 1 ] ), -127, 127 ) : pBlock[ 1 ];
+	const int32 range = isSigned ? 127 : 255;
+	const bool eightValues = isSigned ? ( Block_Signed8( pBlock[ 0 ] ) > Block_Signed8( pBlock[ 1 ] ) ) : ( value0 > value1 );
+	for ( uint32 i = 0; i < 8; i++ ) {
+		int32 result;
+		if ( !eightValues && i >= 6 ) {
+			result = ( i == 6 ) ? ( isSigned ? -( int32 )maxValue : 0 ) : ( int32 )maxValue;
+		} else {
+			int32 weight0;
+			int32 weight1;
+			int32 divisor;
+			Block_ValueWeights( eightValues, i, &weight0, &weight1, &divisor );
+			//Rounded to nearest, away from zero
+			const int32 numerator = ( weight0 * value0 + weight1 * value1 ) * ( int32 )maxValue;
+			const int32 denominator = divisor * range;
+			result = ( numerator >= 0 ) ? ( numerator + denominator / 2 ) / denominator : -( ( -numerator + denominator / 2 ) / denominator );
+		}
+		pPalette[ i ] = ( uint16 )result;
+	}
+}
+
+template< blockColorExpandFunc_t __expand__, bool __punchThrough__ >
+static void Decode_BC1( const uint8 * pBlock, uint8 * pTexels ) {
+	uint32 palette[ 4 ];
+	uint32 texels[ BLOCK_TEXELS ];
+	Block_ColorPalette( pBlock, true, __punchThrough__, palette );
+	__expand__( palette, Block_Load32( pBlock + 4 ), texels );
+	Block_Store( pTexels, texels, 4 );
+}
+
+template< blockColorExpandFunc_t __expand__ >
+static void Decode_BC2( const uint8 * pBlock, uint8 * pTexels ) {
+	uint32 palette[ 4 ];
+	uint32 texels[ BLOCK_TEXELS ];
+	Block_ColorPalette( pBlock + 8, false, false, palette );
+	__expand__( palette, Block_Load32( pBlock + 12 ), texels );
+	const uint64 alphas = Block_Load64( pBlock );
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		const uint32 alpha = ( uint32 )( alphas >> ( 4 * i ) ) & 0xF;
+		texels[ i ] = ( texels[ i ] & 0x00FFFFFF ) | ( ( alpha * 17 ) << 24 );
+	}
+	Block_Store( pTexels, texels, 4 );
+}
+
+template< blockColorExpandFunc_t __expandColors__, blockValueExpandFunc_t __expandValues__ >
+static void Decode_BC3( const uint8 * pBlock, uint8 * pTexels ) {
+	uint32 palette[ 4 ];
+	uint32 texels[ BLOCK_TEXELS ];
+	uint16 alphaPalette[ 8 ];
+	uint16 alphas[ BLOCK_TEXELS ];
+	Block_ColorPalette( pBlock + 8, false, false, palette );
+	__expandColors__( palette, Block_Load32( pBlock + 12 ), texels );
+	Block_ValuePalette( pBlock, false, 0xFF, alphaPalette );
+	__expandValues__( alphaPalette, Block_Load64( pBlock ) >> 16, alphas );
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		texels[ i ] = ( texels[ i ] & 0x00FFFFFF ) | ( ( uint32 )alphas[ i ] << 24 );
+	}
+	Block_Store( pTexels, texels, 4 );
+}
+
+template< blockValueExpandFunc_t __expand__, bool __isSigned__ >
+static void Decode_BC4( const uint8 * pBlock, uint8 * pTexels ) {
+	uint16 palette[ 8 ];
+	uint16 values[ BLOCK_TEXELS ];
+	Block_ValuePalette( pBlock, __isSigned__, __isSigned__ ? 0x7FFF : 0xFFFF, palette );
+	__expand__( palette, Block_Load64( pBlock ) >> 16, values );
+	Block_Store( pTexels, values, 2 );
+}
+
+template< blockValueExpandFunc_t __expand__, bool __isSigned__ >
+static void Decode_BC5( const uint8 * pBlock, uint8 * pTexels ) {
+	uint16 palette[ 8 ];
+	uint16 red[ BLOCK_TEXELS ];
+	uint16 green[ BLOCK_TEXELS ];
+	Block_ValuePalette( pBlock, __isSigned__, __isSigned__ ? 0x7FFF : 0xFFFF, palette );
+	__expand__( palette, Block_Load64( pBlock ) >> 16, red );
+	Block_ValuePalette( pBlock + 8, __isSigned__, __isSigned__ ? 0x7FFF : 0xFFFF, palette );
+	__expand__( palette, Block_Load64( pBlock + 8 ) >> 16, green );
+	uint32 texels[ BLOCK_TEXELS ];
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		texels[ i ] = red[ i ] | ( ( uint32 )green[ i ] << 16 );
+	}
+	Block_Store( pTexels, texels, 4 );
+}
+
+/*
+================================================
+BC6H and BC7
+
+Both read their fields least significant bit first from a 128-bit block.  The partition and anchor tables
+are shared: BC6H uses the first 32 two-subset partitions of BC7.
+================================================
+*/
+struct blockBits_t {
+	uint64	low;
+	uint64	high;
+	uint32	position;
+};
+
+static void BlockBits_Init( blockBits_t * bits, const uint8 * pBlock ) {
+	bits->low = Block_Load64( pBlock );
+	bits->high = Block_Load64( pBlock + 8 );
+	bits->position = 0;
+}
+
+static uint32 BlockBits_Read( blockBits_t * bits, uint32 count ) {
+	if ( count == 0 ) {
+		return 0;
+	}
+	const uint32 position = bits->position;
+	bits->position += count;
+	uint64 value;
+	if ( position >= 64 ) {
+		value = bits->high >> ( position - 64 );
+	} else if ( position + count <= 64 ) {
+		value = bits->low >> position;
+	} else {
+		value = ( bits->low >> position ) | ( bits->high << ( 64 - position ) );
+	}
+	return ( uint32 )( value & ( ( 1ULL << count ) - 1 ) );
+}
+
+static const uint8 blockPartitions2[ 64 ][ BLOCK_TEXELS ] = {
+	{ 0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1 }, { 0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1 }, { 0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1 }, { 0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1 },
+	{ 0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1 },
+	{ 0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1 },
+	{ 0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1 }, { 0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1 },
+	{ 0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1 }, { 0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0 }, { 0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0 },
+	{ 0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1 },
+	{ 0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0 }, { 0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0 },
+	{ 0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0 }, { 0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0 }, { 0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0 }, { 0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0 },
+	{ 0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1 }, { 0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1 }, { 0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0 }, { 0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0 },
+	{ 0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0 }, { 0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0 }, { 0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1 }, { 0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1 },
+	{ 0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0 }, { 0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0 }, { 0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0 }, { 0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0 },
+	{ 0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0 }, { 0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1 }, { 0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1 }, { 0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0 },
+	{ 0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0 }, { 0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0 }, { 0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0 }, { 0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0 },
+	{ 0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0 }, { 0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0 },
+	{ 0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1 }, { 0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1 }, { 0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1 },
+	{ 0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1 }, { 0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0 }, { 0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0 }, { 0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1 }
+};
+
+static const uint8 blockPartitions3[ 64 ][ BLOCK_TEXELS ] = {
+	{ 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 }, { 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+	{ 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 }, { 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+	{ 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+	{ 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 }, { 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+	{ 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 }, { 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+	{ 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 }, { 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+	{ 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 }, { 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+	{ 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 }, { 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+	{ 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 }, { 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+	{ 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 }, { 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+	{ 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+	{ 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 }, { 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+	{ 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 }, { 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+	{ 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 }, { 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+	{ 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 }, { 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+	{ 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 }, { 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 }
+};
+
+//The texel whose index drops its top bit, for the second subset of two and the second and third of three
+static const uint8 blockAnchors2[ 64 ] = {
+	15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15, 15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+	15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,  6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+};
+
+static const uint8 blockAnchors3[ 2 ][ 64 ] = {
+	{
+		 3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,  3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+		 8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,  3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+	},
+	{
+		15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8, 15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+		15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8, 15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+	}
+};
+
+static const int32 blockWeights2[ 4 ] = { 0, 21, 43, 64 };
+static const int32 blockWeights3[ 8 ] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const int32 blockWeights4[ 16 ] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static const int32 * Block_Weights( uint32 indexBits ) {
+	return ( indexBits == 2 ) ? blockWeights2 : ( ( indexBits == 3 ) ? blockWeights3 : blockWeights4 );
+}
+
+static uint32 Block_Subset( uint32 subsetCount, uint32 partition, uint32 texel ) {
+	return ( subsetCount == 1 ) ? 0 : ( ( subsetCount == 2 ) ? blockPartitions2[ partition ][ texel ] : blockPartitions3[ partition ][ texel ] );
+}
+
+static bool Block_IsAnchor( uint32 subsetCount, uint32 partition, uint32 texel ) {
+	if ( texel == 0 ) {
+		return true;
+	}
+	if ( subsetCount == 2 ) {
+		return texel == blockAnchors2[ partition ];
+	}
+	if ( subsetCount == 3 ) {
+		return texel == blockAnchors3[ 0 ][ partition ] || texel == blockAnchors3[ 1 ][ partition ];
+	}
+	return false;
+}
+
+//One index per texel, anchors one bit short
+static void Block_ReadIndices( blockBits_t * bits, uint32 indexBits, uint32 subsetCount, uint32 partition, uint8 * pIndices ) {
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		pIndices[ i ] = ( uint8 )BlockBits_Read( bits, Block_IsAnchor( subsetCount, partition, i ) ? indexBits - 1 : indexBits );
+	}
+}
+
+/*
+BC6H
+*/
+//Which endpoint component a run of header bits belongs to: endpoint * 3 + channel, or the partition
+enum {
+	BC6H_R0, BC6H_G0, BC6H_B0, BC6H_R1, BC6H_G1, BC6H_B1, BC6H_R2, BC6H_G2, BC6H_B2, BC6H_R3, BC6H_G3, BC6H_B3, BC6H_D
+};
+
+struct bc6hField_t {
+	uint8	target;
+	uint8	shift;
+	uint8	count;
+};
+
+struct bc6hMode_t {
+	uint8			code;
+	bool			transformed;
+	uint8			endpointBits;
+	uint8			deltaBits[ 3 ];
+	uint8			fieldCount;
+	bc6hField_t		fields[ 24 ];
+};
+
+//The bit layouts of the fourteen modes, in the order the fields are stored; reversed runs are single bits
+static const bc6hMode_t bc6hModes[ 14 ] = {
+	{ 0x00, true, 10, { 5, 5, 5 }, 20, {
+		{ BC6H_G2, 4, 1 }, { BC6H_B2, 4, 1 }, { BC6H_B3, 4, 1 }, { BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 },
+		{ BC6H_R1, 0, 5 }, { BC6H_G3, 4, 1 }, { BC6H_G2, 0, 4 }, { BC6H_G1, 0, 5 }, { BC6H_B3, 0, 1 }, { BC6H_G3, 0, 4 },
+		{ BC6H_B1, 0, 5 }, { BC6H_B3, 1, 1 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 5 }, { BC6H_B3, 2, 1 }, { BC6H_R3, 0, 5 },
+		{ BC6H_B3, 3, 1 }, { BC6H_D, 0, 5 } } },
+	{ 0x01, true, 7, { 6, 6, 6 }, 24, {
+		{ BC6H_G2, 5, 1 }, { BC6H_G3, 4, 1 }, { BC6H_G3, 5, 1 }, { BC6H_R0, 0, 7 }, { BC6H_B3, 0, 1 }, { BC6H_B3, 1, 1 },
+		{ BC6H_B2, 4, 1 }, { BC6H_G0, 0, 7 }, { BC6H_B2, 5, 1 }, { BC6H_B3, 2, 1 }, { BC6H_G2, 4, 1 }, { BC6H_B0, 0, 7 },
+		{ BC6H_B3, 3, 1 }, { BC6H_B3, 5, 1 }, { BC6H_B3, 4, 1 }, { BC6H_R1, 0, 6 }, { BC6H_G2, 0, 4 }, { BC6H_G1, 0, 6 },
+		{ BC6H_G3, 0, 4 }, { BC6H_B1, 0, 6 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 6 }, { BC6H_R3, 0, 6 }, { BC6H_D, 0, 5 } } },
+	{ 0x02, true, 11, { 5, 4, 4 }, 20, {
+		{ BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 }, { BC6H_R1, 0, 5 }, { BC6H_R0, 10, 1 }, { BC6H_G2, 0, 4 },
+		{ BC6H_G1, 0, 4 }, { BC6H_G0, 10, 1 }, { BC6H_B3, 0, 1 }, { BC6H_G3, 0, 4 }, { BC6H_B1, 0, 4 }, { BC6H_B0, 10, 1 },
+		{ BC6H_B3, 1, 1 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 5 }, { BC6H_B3, 2, 1 }, { BC6H_R3, 0, 5 }, { BC6H_B3, 3, 1 },
+		{ BC6H_D, 0, 5 } } },
+	{ 0x06, true, 11, { 4, 5, 4 }, 22, {
+		{ BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 }, { BC6H_R1, 0, 4 }, { BC6H_R0, 10, 1 }, { BC6H_G3, 4, 1 },
+		{ BC6H_G2, 0, 4 }, { BC6H_G1, 0, 5 }, { BC6H_G0, 10, 1 }, { BC6H_G3, 0, 4 }, { BC6H_B1, 0, 4 }, { BC6H_B0, 10, 1 },
+		{ BC6H_B3, 1, 1 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 4 }, { BC6H_B3, 0, 1 }, { BC6H_B3, 2, 1 }, { BC6H_R3, 0, 4 },
+		{ BC6H_G2, 4, 1 }, { BC6H_B3, 3, 1 }, { BC6H_D, 0, 5 } } },
+	{ 0x0A, true, 11, { 4, 4, 5 }, 22, {
+		{ BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 }, { BC6H_R1, 0, 4 }, { BC6H_R0, 10, 1 }, { BC6H_B2, 4, 1 },
+		{ BC6H_G2, 0, 4 }, { BC6H_G1, 0, 4 }, { BC6H_G0, 10, 1 }, { BC6H_B3, 0, 1 }, { BC6H_G3, 0, 4 }, { BC6H_B1, 0, 5 },
+		{ BC6H_B0, 10, 1 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 4 }, { BC6H_B3, 1, 1 }, { BC6H_B3, 2, 1 }, { BC6H_R3, 0, 4 },
+		{ BC6H_B3, 4, 1 }, { BC6H_B3, 3, 1 }, { BC6H_D, 0, 5 } } },
+	{ 0x0E, true, 9, { 5, 5, 5 }, 20, {
+		{ BC6H_R0, 0, 9 }, { BC6H_B2, 4, 1 }, { BC6H_G0, 0, 9 }, { BC6H_G2, 4, 1 }, { BC6H_B0, 0, 9 }, { BC6H_B3, 4, 1 },
+		{ BC6H_R1, 0, 5 }, { BC6H_G3, 4, 1 }, { BC6H_G2, 0, 4 }, { BC6H_G1, 0, 5 }, { BC6H_B3, 0, 1 }, { BC6H_G3, 0, 4 },
+		{ BC6H_B1, 0, 5 }, { BC6H_B3, 1, 1 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 5 }, { BC6H_B3, 2, 1 }, { BC6H_R3, 0, 5 },
+		{ BC6H_B3, 3, 1 }, { BC6H_D, 0, 5 } } },
+	{ 0x12, true, 8, { 6, 5, 5 }, 20, {
+		{ BC6H_R0, 0, 8 }, { BC6H_G3, 4, 1 }, { BC6H_B2, 4, 1 }, { BC6H_G0, 0, 8 }, { BC6H_B3, 2, 1 }, { BC6H_G2, 4, 1 },
+		{ BC6H_B0, 0, 8 }, { BC6H_B3, 3, 1 }, { BC6H_B3, 4, 1 }, { BC6H_R1, 0, 6 }, { BC6H_G2, 0, 4 }, { BC6H_G1, 0, 5 },
+		{ BC6H_B3, 0, 1 }, { BC6H_G3, 0, 4 }, { BC6H_B1, 0, 5 }, { BC6H_B3, 1, 1 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 6 },
+		{ BC6H_R3, 0, 6 }, { BC6H_D, 0, 5 } } },
+	{ 0x16, true, 8, { 5, 6, 5 }, 23, {
+		{ BC6H_R0, 0, 8 }, { BC6H_B3, 0, 1 }, { BC6H_B2, 4, 1 }, { BC6H_G0, 0, 8 }, { BC6H_G2, 5, 1 }, { BC6H_G2, 4, 1 },
+		{ BC6H_B0, 0, 8 }, { BC6H_G3, 5, 1 }, { BC6H_B3, 4, 1 }, { BC6H_R1, 0, 5 }, { BC6H_G3, 4, 1 }, { BC6H_G2, 0, 4 },
+		{ BC6H_G1, 0, 6 }, { BC6H_G3, 0, 4 }, { BC6H_B1, 0, 5 }, { BC6H_B3, 1, 1 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 5 },
+		{ BC6H_B3, 2, 1 }, { BC6H_R3, 0, 5 }, { BC6H_B3, 3, 1 }, { BC6H_D, 0, 5 } } },
+	{ 0x1A, true, 8, { 5, 5, 6 }, 23, {
+		{ BC6H_R0, 0, 8 }, { BC6H_B3, 1, 1 }, { BC6H_B2, 4, 1 }, { BC6H_G0, 0, 8 }, { BC6H_B2, 5, 1 }, { BC6H_G2, 4, 1 },
+		{ BC6H_B0, 0, 8 }, { BC6H_B3, 5, 1 }, { BC6H_B3, 4, 1 }, { BC6H_R1, 0, 5 }, { BC6H_G3, 4, 1 }, { BC6H_G2, 0, 4 },
+		{ BC6H_G1, 0, 5 }, { BC6H_B3, 0, 1 }, { BC6H_G3, 0, 4 }, { BC6H_B1, 0, 6 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 5 },
+		{ BC6H_B3, 2, 1 }, { BC6H_R3, 0, 5 }, { BC6H_B3, 3, 1 }, { BC6H_D, 0, 5 } } },
+	{ 0x1E, false, 6, { 6, 6, 6 }, 24, {
+		{ BC6H_R0, 0, 6 }, { BC6H_G3, 4, 1 }, { BC6H_B3, 0, 1 }, { BC6H_B3, 1, 1 }, { BC6H_B2, 4, 1 }, { BC6H_G0, 0, 6 },
+		{ BC6H_G2, 5, 1 }, { BC6H_B2, 5, 1 }, { BC6H_B3, 2, 1 }, { BC6H_G2, 4, 1 }, { BC6H_B0, 0, 6 }, { BC6H_G3, 5, 1 },
+		{ BC6H_B3, 3, 1 }, { BC6H_B3, 5, 1 }, { BC6H_B3, 4, 1 }, { BC6H_R1, 0, 6 }, { BC6H_G2, 0, 4 }, { BC6H_G1, 0, 6 },
+		{ BC6H_G3, 0, 4 }, { BC6H_B1, 0, 6 }, { BC6H_B2, 0, 4 }, { BC6H_R2, 0, 6 }, { BC6H_R3, 0, 6 }, { BC6H_D, 0, 5 } } },
+	{ 0x03, false, 10, { 10, 10, 10 }, 6, {
+		{ BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 }, { BC6H_R1, 0, 10 }, { BC6H_G1, 0, 10 }, { BC6H_B1, 0, 10 } } },
+	{ 0x07, true, 11, { 9, 9, 9 }, 9, {
+		{ BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 }, { BC6H_R1, 0, 9 }, { BC6H_R0, 10, 1 }, { BC6H_G1, 0, 9 },
+		{ BC6H_G0, 10, 1 }, { BC6H_B1, 0, 9 }, { BC6H_B0, 10, 1 } } },
+	{ 0x0B, true, 12, { 8, 8, 8 }, 12, {
+		{ BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 }, { BC6H_R1, 0, 8 }, { BC6H_R0, 11, 1 }, { BC6H_R0, 10, 1 },
+		{ BC6H_G1, 0, 8 }, { BC6H_G0, 11, 1 }, { BC6H_G0, 10, 1 }, { BC6H_B1, 0, 8 }, { BC6H_B0, 11, 1 }, { BC6H_B0, 10, 1 } } },
+	{ 0x0F, true, 16, { 4, 4, 4 }, 24, {
+		{ BC6H_R0, 0, 10 }, { BC6H_G0, 0, 10 }, { BC6H_B0, 0, 10 }, { BC6H_R1, 0, 4 }, { BC6H_R0, 15, 1 }, { BC6H_R0, 14, 1 },
+		{ BC6H_R0, 13, 1 }, { BC6H_R0, 12, 1 }, { BC6H_R0, 11, 1 }, { BC6H_R0, 10, 1 }, { BC6H_G1, 0, 4 }, { BC6H_G0, 15, 1 },
+		{ BC6H_G0, 14, 1 }, { BC6H_G0, 13, 1 }, { BC6H_G0, 12, 1 }, { BC6H_G0, 11, 1 }, { BC6H_G0, 10, 1 }, { BC6H_B1, 0, 4 },
+		{ BC6H_B0, 15, 1 }, { BC6H_B0, 14, 1 }, { BC6H_B0, 13, 1 }, { BC6H_B0, 12, 1 }, { BC6H_B0, 11, 1 }, { BC6H_B0, 10, 1 } } }
+};
+
+static int32 Block_SignExtend( uint32 value, uint32 bits ) {
+	const uint32 sign = 1U << ( bits - 1 );
+	return ( int32 )( ( value & ( ( sign << 1 ) - 1 ) ) ^ sign ) - ( int32 )sign;
+}
+
+static int32 BC6H_Unquantize( int32 value, uint32 bits, bool isSigned ) {
+	if ( !isSigned ) {
+		if ( bits >= 15 || value == 0 ) {
+			return value;
+		}
+		if ( value == ( 1 << bits ) - 1 ) {
+			return 0xFFFF;
+		}
+		return ( ( value << 16 ) + 0x8000 ) >> bits;
+	}
+	if ( bits >= 16 ) {
+		return value;
+	}
+	const bool negative = ( value < 0 );
+	const int32 magnitude = negative ? -value : value;
+	int32 result;
+	if ( magnitude == 0 ) {
+		result = 0;
+	} else if ( magnitude >= ( 1 << ( bits - 1 ) ) - 1 ) {
+		result = 0x7FFF;
+	} else {
+		result = ( ( magnitude << 15 ) + 0x4000 ) >> ( bits - 1 );
+	}
+	return negative ? -result : result;
+}
+
+//Interpolated endpoints scaled down to the bits of a half; 31/64 and 31/32 map the top of the range onto the largest finite value
+static uint16 BC6H_Finish( int32 value, bool isSigned ) {
+	if ( !isSigned ) {
+		return ( uint16 )( ( value * 31 ) >> 6 );
+	}
+	return ( value < 0 ) ? ( uint16 )( ( ( -value * 31 ) >> 5 ) | 0x8000 ) : ( uint16 )( ( value * 31 ) >> 5 );
+}
+
+template< bool __isSigned__ >
+static void Decode_BC6H( const uint8 * pBlock, uint8 * pTexels ) {
+	uint16 texels[ BLOCK_TEXELS ][ 4 ];
+	memset( texels, 0, sizeof( texels ) );
+	blockBits_t bits;
+	BlockBits_Init( &bits, pBlock );
+	uint32 code = BlockBits_Read( &bits, 2 );
+	if ( code >= 2 ) {
+		code |= BlockBits_Read( &bits, 3 ) << 2;
+	}
+	const bc6hMode_t * mode = NULL;
+	for ( uint32 i = 0; i < ARRAY_LENGTH( bc6hModes ); i++ ) {
+		if ( bc6hModes[ i ].code == code ) {
+			mode = &bc6hModes[ i ];
+			break;
+		}
+	}
+	//Reserved modes decode to zero
+	if ( mode == NULL ) {
+		for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+			texels[ i ][ 3 ] = 0x3C00;
+		}
+		Block_Store( pTexels, texels, 8 );
+		return;
+	}
+
+	uint32 fields[ BC6H_D + 1 ];
+	memset( fields, 0, sizeof( fields ) );
+	for ( uint32 i = 0; i < mode->fieldCount; i++ ) {
+		const bc6hField_t & field = mode->fields[ i ];
+		fields[ field.target ] |= BlockBits_Read( &bits, field.count ) << field.shift;
+	}
+	const uint32 subsetCount = ( mode->fieldCount > 12 ) ? 2 : 1;
+	const uint32 endpointCount = subsetCount * 2;
+	const uint32 partition = fields[ BC6H_D ];
+
+	int32 endpoints[ 4 ][ 3 ];
+	for ( uint32 c = 0; c < 3; c++ ) {
+		const uint32 endpointBits = mode->endpointBits;
+		endpoints[ 0 ][ c ] = __isSigned__ ? Block_SignExtend( fields[ c ], endpointBits ) : ( int32 )fields[ c ];
+		for ( uint32 e = 1; e < endpointCount; e++ ) {
+			const uint32 value = fields[ e * 3 + c ];
+			if ( mode->transformed ) {
+				const uint32 sum = ( uint32 )( endpoints[ 0 ][ c ] + Block_SignExtend( value, mode->deltaBits[ c ] ) ) & ( ( 1U << endpointBits ) - 1 );
+				endpoints[ e ][ c ] = __isSigned__ ? Block_SignExtend( sum, endpointBits ) : ( int32 )sum;
+			} else {
+				endpoints[ e ][ c ] = __isSigned__ ? Block_SignExtend( value, endpointBits ) : ( int32 )value;
+			}
+		}
+		for ( uint32 e = 0; e < endpointCount; e++ ) {
+			endpoints[ e ][ c ] = BC6H_Unquantize( endpoints[ e ][ c ], endpointBits, __isSigned__ );
+		}
+	}
+
+	const uint32 indexBits = ( subsetCount == 2 ) ? 3 : 4;
+	const int32 * pWeights = Block_Weights( indexBits );
+	uint8 indices[ BLOCK_TEXELS ];
+	Block_ReadIndices( &bits, indexBits, subsetCount, partition, indices );
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		const uint32 subset = Block_Subset( subsetCount, partition, i );
+		const int32 weight = pWeights[ indices[ i ] ];
+		for ( uint32 c = 0; c < 3; c++ ) {
+			const int32 value = ( ( 64 - weight ) * endpoints[ subset * 2 ][ c ] + weight * endpoints[ subset * 2 + 1 ][ c ] + 32 ) >> 6;
+			texels[ i ][ c ] = BC6H_Finish( value, __isSigned__ );
+		}
+		texels[ i ][ 3 ] = 0x3C00;
+	}
+	Block_Store( pTexels, texels, 8 );
+}
+
+/*
+BC7
+*/
+struct bc7Mode_t {
+	uint8	subsetCount;
+	uint8	partitionBits;
+	uint8	rotationBits;
+	uint8	indexSelectionBits;
+	uint8	colorBits;
+	uint8	alphaBits;
+	uint8	endpointPBits;			//one per endpoint
+	uint8	sharedPBits;			//one per subset
+	uint8	indexBits;
+	uint8	secondaryIndexBits;
+};
+
+static const bc7Mode_t bc7Modes[ 8 ] = {
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+};
+
+static uint32 BC7_Expand( uint32 value, uint32 bits ) {
+	value <<= 8 - bits;
+	return value | ( value >> bits );
+}
+
+static void Decode_BC7( const uint8 * pBlock, uint8 * pTexels ) {
+	uint32 texels[ BLOCK_TEXELS ];
+	uint32 modeIndex = 0;
+	while ( modeIndex < 8 && ( pBlock[ 0 ] & ( 1 << modeIndex ) ) == 0 ) {
+		modeIndex++;
+	}
+	//No mode bit set is reserved, and decodes to transparent black
+	if ( modeIndex == 8 ) {
+		memset( pTexels, 0, BLOCK_TEXELS * 4 );
+		return;
+	}
+	const bc7Mode_t & mode = bc7Modes[ modeIndex ];
+	blockBits_t bits;
+	BlockBits_Init( &bits, pBlock );
+	BlockBits_Read( &bits, modeIndex + 1 );
+	const uint32 partition = BlockBits_Read( &bits, mode.partitionBits );
+	const uint32 rotation = BlockBits_Read( &bits, mode.rotationBits );
+	const uint32 indexSelection = BlockBits_Read( &bits, mode.indexSelectionBits );
+
+	const uint32 endpointCount = mode.subsetCount * 2;
+	uint32 endpoints[ 6 ][ 4 ];
+	for ( uint32 c = 0; c < 3; c++ ) {
+		for ( uint32 e = 0; e < endpointCount; e++ ) {
+			endpoints[ e ][ c ] = BlockBits_Read( &bits, mode.colorBits );
+		}
+	}
+	for ( uint32 e = 0; e < endpointCount; e++ ) {
+		endpoints[ e ][ 3 ] = BlockBits_Read( &bits, mode.alphaBits );
+	}
+	uint32 pBits[ 6 ] = { 0, 0, 0, 0, 0, 0 };
+	if ( mode.endpointPBits != 0 ) {
+		for ( uint32 e = 0; e < endpointCount; e++ ) {
+			pBits[ e ] = BlockBits_Read( &bits, 1 );
+		}
+	} else if ( mode.sharedPBits != 0 ) {
+		for ( uint32 s = 0; s < mode.subsetCount; s++ ) {
+			pBits[ s * 2 ] = pBits[ s * 2 + 1 ] = BlockBits_Read( &bits, 1 );
+		}
+	}
+	const uint32 pBitCount = ( mode.endpointPBits != 0 || mode.sharedPBits != 0 ) ? 1 : 0;
+	for ( uint32 e = 0; e < endpointCount; e++ ) {
+		for ( uint32 c = 0; c < 4; c++ ) {
+			const uint32 componentBits = ( c < 3 ) ? mode.colorBits : mode.alphaBits;
+			if ( componentBits == 0 ) {
+				endpoints[ e ][ c ] = 0xFF;
+				continue;
+			}
+			endpoints[ e ][ c ] = BC7_Expand( ( endpoints[ e ][ c ] << pBitCount ) | pBits[ e ], componentBits + pBitCount );
+		}
+	}
+
+	uint8 indices[ BLOCK_TEXELS ];
+	uint8 secondaryIndices[ BLOCK_TEXELS ];
+	Block_ReadIndices( &bits, mode.indexBits, mode.subsetCount, partition, indices );
+	if ( mode.secondaryIndexBits != 0 ) {
+		Block_ReadIndices( &bits, mode.secondaryIndexBits, 1, 0, secondaryIndices );
+	}
+	//Mode 4's selection bit swaps which index set drives color and which alpha
+	const uint8 * pColorIndices = ( indexSelection != 0 ) ? secondaryIndices : indices;
+	const uint8 * pAlphaIndices = ( mode.secondaryIndexBits == 0 ) ? indices : ( ( indexSelection != 0 ) ? indices : secondaryIndices );
+	const uint32 colorIndexBits = ( indexSelection != 0 ) ? mode.secondaryIndexBits : mode.indexBits;
+	const uint32 alphaIndexBits = ( mode.secondaryIndexBits == 0 ) ? mode.indexBits : ( ( indexSelection != 0 ) ? mode.indexBits : mode.secondaryIndexBits );
+	const int32 * pColorWeights = Block_Weights( colorIndexBits );
+	const int32 * pAlphaWeights = Block_Weights( alphaIndexBits );
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		const uint32 subset = Block_Subset( mode.subsetCount, partition, i );
+		const uint32 * e0 = endpoints[ subset * 2 ];
+		const uint32 * e1 = endpoints[ subset * 2 + 1 ];
+		uint32 rgba[ 4 ];
+		for ( uint32 c = 0; c < 4; c++ ) {
+			const int32 weight = ( c < 3 ) ? pColorWeights[ pColorIndices[ i ] ] : pAlphaWeights[ pAlphaIndices[ i ] ];
+			rgba[ c ] = ( uint32 )( ( ( 64 - weight ) * ( int32 )e0[ c ] + weight * ( int32 )e1[ c ] + 32 ) >> 6 );
+		}
+		if ( rotation != 0 ) {
+			const uint32 swap = rgba[ rotation - 1 ];
+			rgba[ rotation - 1 ] = rgba[ 3 ];
+			rgba[ 3 ] = swap;
+		}
+		texels[ i ] = Block_Rgba( rgba[ 0 ], rgba[ 1 ], rgba[ 2 ], rgba[ 3 ] );
+	}
+	Block_Store( pTexels, texels, 4 );
+}
+
+/*
+================================================
+ETC2 and EAC
+
+Texel indices run down the columns: texel ( x, y ) is index x * 4 + y.
+================================================
+*/
+static const int32 etc2Modifiers[ 8 ][ 2 ] = {
+	{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+static const int32 etc2Distances[ 8 ] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int32 eacModifiers[ 16 ][ 8 ] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static uint32 Etc_Bits( uint64 block, uint32 low, uint32 count ) {
+	return ( uint32 )( block >> low ) & ( ( 1U << count ) - 1 );
+}
+
+static uint32 Etc_Expand4( uint32 value ) {
+	return value * 17;
+}
+
+static uint32 Etc_Expand5( uint32 value ) {
+	return ( value << 3 ) | ( value >> 2 );
+}
+
+static uint32 Etc_Rgb( const int32 * pColor, int32 offset ) {
+	return Block_Rgba( Block_Clamp( pColor[ 0 ] + offset, 0, 255 ), Block_Clamp( pColor[ 1 ] + offset, 0, 255 ), Block_Clamp( pColor[ 2 ] + offset, 0, 255 ), 0xFF );
+}
+
+//The 2-bit index of texel ( x, y ): the most significant bit from the top half of the index word
+static uint32 Etc_Index( uint64 block, uint32 x, uint32 y ) {
+	const uint32 texel = x * 4 + y;
+	return ( ( ( uint32 )( block >> ( 16 + texel ) ) & 1 ) << 1 ) | ( ( uint32 )( block >> texel ) & 1 );
+}
+
+//An ETC2 color block into RGBA8; punchThrough reads the differential bit as the opaque bit of RGB8A1
+static void Etc2_DecodeColor( const uint8 * pBlock, bool punchThrough, uint32 * pTexels ) {
+	const uint64 block = Block_Load64BigEndian( pBlock );
+	const bool differential = punchThrough || ( ( block >> 33 ) & 1 ) != 0;
+	const bool opaque = !punchThrough || ( ( block >> 33 ) & 1 ) != 0;
+	int32 colors[ 2 ][ 3 ];
+	if ( differential ) {
+		const int32 r = ( int32 )Etc_Bits( block, 59, 5 );
+		const int32 g = ( int32 )Etc_Bits( block, 51, 5 );
+		const int32 b = ( int32 )Etc_Bits( block, 43, 5 );
+		const int32 r2 = r + Block_SignExtend( Etc_Bits( block, 56, 3 ), 3 );
+		const int32 g2 = g + Block_SignExtend( Etc_Bits( block, 48, 3 ), 3 );
+		const int32 b2 = b + Block_SignExtend( Etc_Bits( block, 40, 3 ), 3 );
+		if ( r2 < 0 || r2 > 31 ) {
+			//T mode: one color and a second spread either side of it by a distance
+			int32 paint[ 4 ][ 3 ];
+			const int32 c0[ 3 ] = { ( int32 )Etc_Expand4( ( Etc_Bits( block, 59, 2 ) << 2 ) | Etc_Bits( block, 56, 2 ) ), ( int32 )Etc_Expand4( Etc_Bits( block, 52, 4 ) ), ( int32 )Etc_Expand4( Etc_Bits( block, 48, 4 ) ) };
+			const int32 c1[ 3 ] = { ( int32 )Etc_Expand4( Etc_Bits( block, 44, 4 ) ), ( int32 )Etc_Expand4( Etc_Bits( block, 40, 4 ) ), ( int32 )Etc_Expand4( Etc_Bits( block, 36, 4 ) ) };
+			const int32 distance = etc2Distances[ ( Etc_Bits( block, 34, 2 ) << 1 ) | Etc_Bits( block, 32, 1 ) ];
+			for ( uint32 c = 0; c < 3; c++ ) {
+				paint[ 0 ][ c ] = c0[ c ];
+				paint[ 1 ][ c ] = c1[ c ] + distance;
+				paint[ 2 ][ c ] = c1[ c ];
+				paint[ 3 ][ c ] = c1[ c ] - distance;
+			}
+			for ( uint32 y = 0; y < 4; y++ ) {
+				for ( uint32 x = 0; x < 4; x++ ) {
+					const uint32 index = Etc_Index( block, x, y );
+					pTexels[ y * 4 + x ] = ( !opaque && index == 2 ) ? 0 : Etc_Rgb( paint[ index ], 0 );
+				}
+			}
+			return;
+		}
+		if ( g2 < 0 || g2 > 31 ) {
+			//H mode: two colors, each spread either side by a distance
+			const uint32 r0 = Etc_Bits( block, 59, 4 );
+			const uint32 g0 = ( Etc_Bits( block, 56, 3 ) << 1 ) | Etc_Bits( block, 52, 1 );
+			const uint32 b0 = ( Etc_Bits( block, 51, 1 ) << 3 ) | Etc_Bits( block, 47, 3 );
+			const uint32 r1 = Etc_Bits( block, 43, 4 );
+			const uint32 g1 = Etc_Bits( block, 39, 4 );
+			const uint32 b1 = Etc_Bits( block, 35, 4 );
+			const uint32 order = ( ( ( r0 << 8 ) | ( g0 << 4 ) | b0 ) >= ( ( r1 << 8 ) | ( g1 << 4 ) | b1 ) ) ? 1 : 0;
+			const int32 distance = etc2Distances[ ( Etc_Bits( block, 34, 1 ) << 2 ) | ( Etc_Bits( block, 32, 1 ) << 1 ) | order ];
+			const int32 c0[ 3 ] = { ( int32 )Etc_Expand4( r0 ), ( int32 )Etc_Expand4( g0 ), ( int32 )Etc_Expand4( b0 ) };
+			const int32 c1[ 3 ] = { ( int32 )Etc_Expand4( r1 ), ( int32 )Etc_Expand4( g1 ), ( int32 )Etc_Expand4( b1 ) };
+			const uint32 paint[ 4 ] = { Etc_Rgb( c0, distance ), Etc_Rgb( c0, -distance ), Etc_Rgb( c1, distance ), Etc_Rgb( c1, -distance ) };
+			for ( uint32 y = 0; y < 4; y++ ) {
+				for ( uint32 x = 0; x < 4; x++ ) {
+					const uint32 index = Etc_Index( block, x, y );
+					pTexels[ y * 4 + x ] = ( !opaque && index == 2 ) ? 0 : paint[ index ];
+				}
+			}
+			return;
+		}
+		if ( b2 < 0 || b2 > 31 ) {
+			//Planar mode: a color at the origin and gradients along each axis, always opaque
+			const int32 ro = ( int32 )Etc_Bits( block, 57, 6 );
+			const int32 go = ( int32 )( ( Etc_Bits( block, 56, 1 ) << 6 ) | Etc_Bits( block, 49, 6 ) );
+			const int32 bo = ( int32 )( ( Etc_Bits( block, 48, 1 ) << 5 ) | ( Etc_Bits( block, 43, 2 ) << 3 ) | Etc_Bits( block, 39, 3 ) );
+			const int32 rh = ( int32 )( ( Etc_Bits( block, 34, 5 ) << 1 ) | Etc_Bits( block, 32, 1 ) );
+			const int32 gh = ( int32 )Etc_Bits( block, 25, 7 );
+			const int32 bh = ( int32 )Etc_Bits( block, 19, 6 );
+			const int32 rv = ( int32 )Etc_Bits( block, 13, 6 );
+			const int32 gv = ( int32 )Etc_Bits( block, 6, 7 );
+			const int32 bv = ( int32 )Etc_Bits( block, 0, 6 );
+			const int32 origin[ 3 ] = { ( ro << 2 ) | ( ro >> 4 ), ( go << 1 ) | ( go >> 6 ), ( bo << 2 ) | ( bo >> 4 ) };
+			const int32 horizontal[ 3 ] = { ( rh << 2 ) | ( rh >> 4 ), ( gh << 1 ) | ( gh >> 6 ), ( bh << 2 ) | ( bh >> 4 ) };
+			const int32 vertical[ 3 ] = { ( rv << 2 ) | ( rv >> 4 ), ( gv << 1 ) | ( gv >> 6 ), ( bv << 2 ) | ( bv >> 4 ) };
+			for ( uint32 y = 0; y < 4; y++ ) {
+				for ( uint32 x = 0; x < 4; x++ ) {
+					int32 rgb[ 3 ];
+					for ( uint32 c = 0; c < 3; c++ ) {
+						rgb[ c ] = Block_Clamp( ( ( int32 )x * ( horizontal[ c ] - origin[ c ] ) + ( int32 )y * ( vertical[ c ] - origin[ c ] ) + 4 * origin[ c ] + 2 ) >> 2, 0, 255 );
+					}
+					pTexels[ y * 4 + x ] = Block_Rgba( rgb[ 0 ], rgb[ 1 ], rgb[ 2 ], 0xFF );
+				}
+			}
+			return;
+		}
+		colors[ 0 ][ 0 ] = Etc_Expand5( r );
+		colors[ 0 ][ 1 ] = Etc_Expand5( g );
+		colors[ 0 ][ 2 ] = Etc_Expand5( b );
+		colors[ 1 ][ 0 ] = Etc_Expand5( r2 );
+		colors[ 1 ][ 1 ] = Etc_Expand5( g2 );
+		colors[ 1 ][ 2 ] = Etc_Expand5( b2 );
+	} else {
+		for ( uint32 c = 0; c < 3; c++ ) {
+			colors[ 0 ][ c ] = Etc_Expand4( Etc_Bits( block, 60 - 8 * c, 4 ) );
+			colors[ 1 ][ c ] = Etc_Expand4( Etc_Bits( block, 56 - 8 * c, 4 ) );
+		}
+	}
+
+	//Individual and differential modes: two half-block colors shifted by a modifier per texel
+	const bool flip = ( ( block >> 32 ) & 1 ) != 0;
+	const uint32 tables[ 2 ] = { Etc_Bits( block, 37, 3 ), Etc_Bits( block, 34, 3 ) };
+	for ( uint32 y = 0; y < 4; y++ ) {
+		for ( uint32 x = 0; x < 4; x++ ) {
+			const uint32 half = flip ? ( y >> 1 ) : ( x >> 1 );
+			const uint32 index = Etc_Index( block, x, y );
+			const int32 * pModifiers = etc2Modifiers[ tables[ half ] ];
+			if ( !opaque && index == 2 ) {
+				pTexels[ y * 4 + x ] = 0;
+				continue;
+			}
+			//Without the opaque bit the small modifiers are dropped, leaving index 0 as the base color
+			const int32 magnitude = ( index & 1 ) ? pModifiers[ 1 ] : ( opaque ? pModifiers[ 0 ] : 0 );
+			pTexels[ y * 4 + x ] = Etc_Rgb( colors[ half ], ( index & 2 ) ? -magnitude : magnitude );
+		}
+	}
+}
+
+//An EAC channel, as 8-bit alpha or as an 11-bit value widened to 16-bit UNORM or SNORM
+static void Eac_Decode( const uint8 * pBlock, bool eleven, bool isSigned, uint16 * pValues ) {
+	const uint64 block = Block_Load64BigEndian( pBlock );
+	const int32 base = isSigned ? Block_Clamp( Block_Signed8( pBlock[ 0 ] ), -127, 127 ) : pBlock[ 0 ];
+	const int32 multiplier = ( int32 )Etc_Bits( block, 52, 4 );
+	const int32 * pModifiers = eacModifiers[ Etc_Bits( block, 48, 4 ) ];
+	for ( uint32 y = 0; y < 4; y++ ) {
+		for ( uint32 x = 0; x < 4; x++ ) {
+			const int32 modifier = pModifiers[ Etc_Bits( block, 45 - 3 * ( x * 4 + y ), 3 ) ];
+			int32 value;
+			if ( !eleven ) {
+				value = Block_Clamp( base + modifier * multiplier, 0, 255 );
+			} else if ( !isSigned ) {
+				value = Block_Clamp( base * 8 + 4 + modifier * ( ( multiplier != 0 ) ? multiplier * 8 : 1 ), 0, 2047 );
+				value = ( value << 5 ) | ( value >> 6 );
+			} else {
+				value = Block_Clamp( base * 8 + modifier * ( ( multiplier != 0 ) ? multiplier * 8 : 1 ), -1023, 1023 );
+				value = ( value >= 0 ) ? ( ( value << 5 ) | ( value >> 5 ) ) : -( ( -value << 5 ) | ( -value >> 5 ) );
+			}
+			pValues[ y * 4 + x ] = ( uint16 )value;
+		}
+	}
+}
+
+template< bool __punchThrough__ >
+static void Decode_Etc2Rgb( const uint8 * pBlock, uint8 * pTexels ) {
+	uint32 texels[ BLOCK_TEXELS ];
+	Etc2_DecodeColor( pBlock, __punchThrough__, texels );
+	Block_Store( pTexels, texels, 4 );
+}
+
+static void Decode_Etc2Rgba( const uint8 * pBlock, uint8 * pTexels ) {
+	uint32 texels[ BLOCK_TEXELS ];
+	uint16 alphas[ BLOCK_TEXELS ];
+	Etc2_DecodeColor( pBlock + 8, false, texels );
+	Eac_Decode( pBlock, false, false, alphas );
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		texels[ i ] = ( texels[ i ] & 0x00FFFFFF ) | ( ( uint32 )alphas[ i ] << 24 );
+	}
+	Block_Store( pTexels, texels, 4 );
+}
+
+template< bool __isSigned__ >
+static void Decode_EacR11( const uint8 * pBlock, uint8 * pTexels ) {
+	uint16 values[ BLOCK_TEXELS ];
+	Eac_Decode( pBlock, true, __isSigned__, values );
+	Block_Store( pTexels, values, 2 );
+}
+
+template< bool __isSigned__ >
+static void Decode_EacRG11( const uint8 * pBlock, uint8 * pTexels ) {
+	uint16 red[ BLOCK_TEXELS ];
+	uint16 green[ BLOCK_TEXELS ];
+	Eac_Decode( pBlock, true, __isSigned__, red );
+	Eac_Decode( pBlock + 8, true, __isSigned__, green );
+	uint32 texels[ BLOCK_TEXELS ];
+	for ( uint32 i = 0; i < BLOCK_TEXELS; i++ ) {
+		texels[ i ] = red[ i ] | ( ( uint32 )green[ i ] << 16 );
+	}
+	Block_Store( pTexels, texels, 4 );
+}
+
+/*
+================================================
+Selection
+================================================
+*/
+template< blockColorExpandFunc_t __colors__, blockValueExpandFunc_t __values__ >
+static formatDecodeFunc_t Format_SelectBC( VkFormat format ) {
+	switch ( format ) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:		return Decode_BC1< __colors__, false >;
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:		return Decode_BC1< __colors__, true >;
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:			return Decode_BC2< __colors__ >;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:			return Decode_BC3< __colors__, __values__ >;
+		case VK_FORMAT_BC4_UNORM_BLOCK:			return Decode_BC4< __values__, false >;
+		case VK_FORMAT_BC4_SNORM_BLOCK:			return Decode_BC4< __values__, true >;
+		case VK_FORMAT_BC5_UNORM_BLOCK:			return Decode_BC5< __values__, false >;
+		case VK_FORMAT_BC5_SNORM_BLOCK:			return Decode_BC5< __values__, true >;
+		default:								return NULL;
+	}
+}
+
+formatDecodeFunc_t Format_SelectDecoder( VkFormat format, cpuIsa_t isa ) {
+	switch ( format ) {
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:			return Decode_BC6H< false >;
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:			return Decode_BC6H< true >;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:				return Decode_BC7;
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:		return Decode_Etc2Rgb< false >;
+		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:	return Decode_Etc2Rgb< true >;
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:	return Decode_Etc2Rgba;
+		case VK_FORMAT_EAC_R11_UNORM_BLOCK:			return Decode_EacR11< false >;
+		case VK_FORMAT_EAC_R11_SNORM_BLOCK:			return Decode_EacR11< true >;
+		case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:		return Decode_EacRG11< false >;
+		case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:		return Decode_EacRG11< true >;
+		default:
+			break;
+	}
+#if CPU_X86
+	if ( isa >= cpuIsa_t::SSE41 ) {
+		return Format_SelectBC< Block_ExpandColors_SSE41, Block_ExpandValues_SSE41 >( format );
+	}
+#else
+	( void )isa;
+#endif
+	return Format_SelectBC< Block_ExpandColors, Block_ExpandValues >( format );
+}
@@ -0,0 +1,551 @@
+#include "HostAllocator.h"
+#include <string.h>
+#include <thread>
+
+#define HOST_SUPERBLOCK_SIZE ( 4 * 1024 * 1024 )
+
+//Four classes per doubling above 128 bytes keeps worst-case rounding waste under 25%
+static const uint32 hostSizeClasses[ HOST_SIZE_CLASS_COUNT ] = {
+	16,		32,		48,		64,		80,		96,		112,	128,
+	160,	192,	224,	256,	320,	384,	448,	512,
+	640,	768,	896,	1024,	1280,	1536,	1792,	2048,
+	2560,	3072,	3584,	4096,	5120,	6144,	7168,	8192
+};
+
+//Blocks moved between a thread cache and the central list at once: about 32KB worth, clamped to [ 4, 64 ]
+static const uint8 hostBatchSizes[ HOST_SIZE_CLASS_COUNT ] = {
+	64,		64,		64,		64,		64,		64,		64,		64,
+	64,		64,		64,		64,		64,		64,		64,		64,
+	51,		42,		36,		32,		25,		21,		18,		16,
+	12,		10,		9,		8,		6,		5,		4,		4
+};
+
+static size_t AlignSize( size_t size, size_t alignment ) {
+	return ( size + alignment - 1 ) & ~( alignment - 1 );
+}
+
+static hostSpan_t * SpanOf( void * pMemory ) {
+	return reinterpret_cast< hostSpan_t * >( reinterpret_cast< uintptr_t >( pMemory ) & ~( uintptr_t )( HOST_SPAN_SIZE - 1 ) );
+}
+
+static void SpinLock( std::atomic< uint32 > & lock ) {
+	while ( lock.exchange( 1, std::memory_order_acquire ) != 0 ) {
+		while ( lock.load( std::memory_order_relaxed ) != 0 ) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+static void SpinUnlock( std::atomic< uint32 > & lock ) {
+	lock.store( 0, std::memory_order_release );
+}
+
+static uint32 SizeClassForSize( size_t size ) {
+	if ( size <= 128 ) {
+		return ( size == 0 ) ? 0 : ( uint32 )( ( size + 15 ) >> 4 ) - 1;
+	}
+	uint32 highBit = HighestBitIndex64( size - 1 );
+	return 8 + ( highBit - 7 ) * 4 + ( uint32 )( ( ( size - 1 ) - ( ( size_t )1 << highBit ) ) >> ( highBit - 2 ) );
+}
+
+//Objects are packed from the end of the span header, so a class serves an alignment only if its size is a multiple of it
+static uint32 SizeClassForRequest( size_t size, size_t alignment ) {
+	uint32 sizeClass = SizeClassForSize( size );
+	while ( sizeClass < HOST_SIZE_CLASS_COUNT && ( hostSizeClasses[ sizeClass ] & ( alignment - 1 ) ) != 0 ) {
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+static uint32 BatchSize( uint32 sizeClass ) {
+	return hostBatchSizes[ sizeClass ];
+}
+
+/*
+================================================
+Small allocations
+
+Each thread keeps a free list per size class and only takes a lock to move a batch to or from the
+shared central list, so recording threads do not serialize on a global heap lock.  Blocks freed on a
+thread other than the one that allocated them simply join the freeing thread's cache.
+================================================
+*/
+struct hostCentralList_t {
+	std::atomic< uint32 >	lock;
+	void *					head;
+	uint32					count;
+};
+
+static hostCentralList_t centralLists[ HOST_SIZE_CLASS_COUNT ];
+static std::atomic< uint32 > spanSourceLock;
+static uint8 * spanSourceNext;
+static uint8 * spanSourceEnd;
+
+static void * & NextFree( void * block ) {
+	return *reinterpret_cast< void ** >( block );
+}
+
+static void Central_Push( uint32 sizeClass, void * head, void * tail, uint32 count ) {
+	hostCentralList_t & central = centralLists[ sizeClass ];
+	SpinLock( central.lock );
+	NextFree( tail ) = central.head;
+	central.head = head;
+	central.count += count;
+	SpinUnlock( central.lock );
+}
+
+struct hostThreadCache_t {
+	void *	freeLists[ HOST_SIZE_CLASS_COUNT ];
+	uint32	counts[ HOST_SIZE_CLASS_COUNT ];
+
+	~hostThreadCache_t() {
+		for ( uint32 i = 0; i < HOST_SIZE_CLASS_COUNT; i++ ) {
+			if ( counts[ i ] == 0 ) {
+				continue;
+			}
+			void * tail = freeLists[ i ];
+			while ( NextFree( tail ) != NULL ) {
+				tail = NextFree( tail );
+			}
+			Central_Push( i, freeLists[ i ], tail, counts[ i ] );
+			freeLists[ i ] = NULL;
+			counts[ i ] = 0;
+		}
+	}
+};
+
+static thread_local hostThreadCache_t threadCache;
+
+//Spans are carved from superblocks that are never returned; small-object memory is recycled, not unmapped
+static hostSpan_t * Span_Acquire() {
+	SpinLock( spanSourceLock );
+	if ( spanSourceNext == spanSourceEnd ) {
+		platformMapping_t superblock;
+		if ( !Platform_ReserveMemory( HOST_SUPERBLOCK_SIZE, &superblock ) ) {
+			SpinUnlock( spanSourceLock );
+			return NULL;
+		}
+		spanSourceNext = reinterpret_cast< uint8 * >( superblock.base );
+		spanSourceEnd = spanSourceNext + superblock.size;
+	}
+	uint8 * base = spanSourceNext;
+	spanSourceNext += HOST_SPAN_SIZE;
+	SpinUnlock( spanSourceLock );
+
+	if ( !Platform_CommitMemory( base, HOST_SPAN_SIZE ) ) {
+		return NULL;
+	}
+	return reinterpret_cast< hostSpan_t * >( base );
+}
+
+static bool ThreadCache_Refill( hostThreadCache_t & cache, uint32 sizeClass ) {
+	hostCentralList_t & central = centralLists[ sizeClass ];
+	uint32 batch = BatchSize( sizeClass );
+	SpinLock( central.lock );
+	if ( central.head != NULL ) {
+		void * head = central.head;
+		void * tail = head;
+		uint32 count = 1;
+		while ( count < batch && NextFree( tail ) != NULL ) {
+			tail = NextFree( tail );
+			count++;
+		}
+		central.head = NextFree( tail );
+		central.count -= count;
+		SpinUnlock( central.lock );
+		NextFree( tail ) = cache.freeLists[ sizeClass ];
+		cache.freeLists[ sizeClass ] = head;
+		cache.counts[ sizeClass ] += count;
+		return true;
+	}
+	SpinUnlock( central.lock );
+
+	hostSpan_t * span = Span_Acquire();
+	if ( span == NULL ) {
+		return false;
+	}
+	memset( span, 0, sizeof( *span ) );
+	span->kind = hostSpanKind_t::SMALL;
+	span->sizeClass = sizeClass;
+	span->reservedSize = HOST_SPAN_SIZE;
+	span->committedSize = HOST_SPAN_SIZE;
+	uint32 objectSize = hostSizeClasses[ sizeClass ];
+	uint32 objectCount = ( HOST_SPAN_SIZE - HOST_SPAN_HEADER_SIZE ) / objectSize;
+	uint8 * objects = reinterpret_cast< uint8 * >( span ) + HOST_SPAN_HEADER_SIZE;
+	for ( uint32 i = 0; i < objectCount - 1; i++ ) {
+		NextFree( objects + i * objectSize ) = objects + ( i + 1 ) * objectSize;
+	}
+	//The first batch feeds this thread; the rest of the span goes where every thread can reach it
+	uint32 cached = Min( batch, objectCount );
+	void * cacheTail = objects + ( cached - 1 ) * objectSize;
+	if ( cached < objectCount ) {
+		Central_Push( sizeClass, objects + cached * objectSize, objects + ( objectCount - 1 ) * objectSize, objectCount - cached );
+	}
+	NextFree( cacheTail ) = cache.freeLists[ sizeClass ];
+	cache.freeLists[ sizeClass ] = objects;
+	cache.counts[ sizeClass ] += cached;
+	return true;
+}
+
+static void * Small_Allocate( uint32 sizeClass ) {
+	hostThreadCache_t & cache = threadCache;
+	if ( cache.freeLists[ sizeClass ] == NULL && !ThreadCache_Refill( cache, sizeClass ) ) {
+		return NULL;
+	}
+	void * block = cache.freeLists[ sizeClass ];
+	cache.freeLists[ sizeClass ] = NextFree( block );
+	cache.counts[ sizeClass ]--;
+	return block;
+}
+
+static void Small_Free( void * pMemory, uint32 sizeClass ) {
+	hostThreadCache_t & cache = threadCache;
+	NextFree( pMemory ) = cache.freeLists[ sizeClass ];
+	cache.freeLists[ sizeClass ] = pMemory;
+	cache.counts[ sizeClass ]++;
+
+	uint32 batch = BatchSize( sizeClass );
+	if ( cache.counts[ sizeClass ] > batch * 2 ) {
+		void * head = cache.freeLists[ sizeClass ];
+		void * tail = head;
+		for ( uint32 i = 1; i < batch; i++ ) {
+			tail = NextFree( tail );
+		}
+		cache.freeLists[ sizeClass ] = NextFree( tail );
+		cache.counts[ sizeClass ] -= batch;
+		Central_Push( sizeClass, head, tail, batch );
+	}
+}
+
+/*
+================================================
+Large allocations
+
+Each gets its own reservation with room to double, so realloc can usually grow by committing more pages
+rather than copying.
+================================================
+*/
+static void * Large_Allocate( size_t size, size_t alignment ) {
+	size_t dataOffset = AlignSize( HOST_SPAN_HEADER_SIZE, alignment );
+	if ( dataOffset >= HOST_SPAN_SIZE ) {
+		return NULL;
+	}
+	size_t totalSize = dataOffset + size;
+	platformMapping_t mapping;
+	if ( !Platform_ReserveMemory( totalSize * 2, &mapping ) ) {
+		return NULL;
+	}
+	size_t commitSize = AlignSize( totalSize, Platform_PageSize() );
+	if ( !Platform_CommitMemory( mapping.base, commitSize ) ) {
+		Platform_UnmapMemory( &mapping );
+		return NULL;
+	}
+	hostSpan_t * span = reinterpret_cast< hostSpan_t * >( mapping.base );
+	memset( span, 0, sizeof( *span ) );
+	span->kind = hostSpanKind_t::LARGE;
+	span->reservedSize = mapping.size;
+	span->committedSize = commitSize;
+	span->dataOffset = dataOffset;
+	return reinterpret_cast< uint8 * >( span ) + dataOffset;
+}
+
+static bool Large_GrowInPlace( hostSpan_t * span, size_t size ) {
+	size_t totalSize = span->dataOffset + size;
+	if ( totalSize > span->reservedSize ) {
+		return false;
+	}
+	size_t commitSize = AlignSize( totalSize, Platform_PageSize() );
+	if ( commitSize > span->committedSize ) {
+		if ( !Platform_CommitMemory( reinterpret_cast< uint8 * >( span ) + span->committedSize, commitSize - span->committedSize ) ) {
+			return false;
+		}
+		span->committedSize = commitSize;
+	}
+	return true;
+}
+
+static void Large_Free( hostSpan_t * span ) {
+	platformMapping_t mapping;
+	mapping.base = span;
+	mapping.size = span->reservedSize;
+	mapping.largePages = false;
+	Platform_UnmapMemory( &mapping );
+}
+
+/*
+================================================
+Arenas
+================================================
+*/
+static hostSpan_t * Arena_NewChunk( hostArena_t * arena, size_t size ) {
+	platformMapping_t mapping;
+	if ( !Platform_ReserveMemory( size, &mapping ) ) {
+		return NULL;
+	}
+	size_t commitSize = AlignSize( size, Platform_PageSize() );
+	if ( !Platform_CommitMemory( mapping.base, commitSize ) ) {
+		Platform_UnmapMemory( &mapping );
+		return NULL;
+	}
+	hostSpan_t * chunk = reinterpret_cast< hostSpan_t * >( mapping.base );
+	memset( chunk, 0, sizeof( *chunk ) );
+	chunk->kind = hostSpanKind_t::ARENA;
+	chunk->reservedSize = mapping.size;
+	chunk->committedSize = commitSize;
+	chunk->top = reinterpret_cast< uint8 * >( chunk ) + HOST_SPAN_HEADER_SIZE;
+	chunk->arena = arena;
+	return chunk;
+}
+
+static void Arena_FreeChunks( hostSpan_t * chunk ) {
+	while ( chunk != NULL ) {
+		hostSpan_t * next = chunk->nextChunk;
+		Large_Free( chunk );
+		chunk = next;
+	}
+}
+
+static void * Arena_Bump( hostSpan_t * chunk, size_t size, size_t alignment ) {
+	uint8 * data = reinterpret_cast< uint8 * >( AlignSize( reinterpret_cast< size_t >( chunk->top ), alignment ) );
+	if ( data + size > reinterpret_cast< uint8 * >( chunk ) + HOST_SPAN_SIZE ) {
+		return NULL;
+	}
+	chunk->top = data + size;
+	chunk->lastAllocation = data;
+	return data;
+}
+
+static void * Arena_AllocateLocked( hostArena_t * arena, size_t size, size_t alignment ) {
+	size_t dataOffset = AlignSize( HOST_SPAN_HEADER_SIZE, alignment );
+	if ( dataOffset + size > HOST_SPAN_SIZE ) {
+		//The data still starts inside the first span of the chunk, so SpanOf finds the header
+		if ( dataOffset >= HOST_SPAN_SIZE ) {
+			return NULL;
+		}
+		hostSpan_t * chunk = Arena_NewChunk( arena, dataOffset + size );
+		if ( chunk == NULL ) {
+			return NULL;
+		}
+		chunk->nextChunk = arena->dedicatedChunks;
+		arena->dedicatedChunks = chunk;
+		chunk->lastAllocation = reinterpret_cast< uint8 * >( chunk ) + dataOffset;
+		chunk->top = chunk->lastAllocation + size;
+		return chunk->lastAllocation;
+	}
+
+	hostSpan_t * chunk = arena->currentChunk;
+	while ( chunk != NULL ) {
+		void * data = Arena_Bump( chunk, size, alignment );
+		if ( data != NULL ) {
+			return data;
+		}
+		if ( chunk->nextChunk == NULL ) {
+			break;
+		}
+		//Chunks past the current one still hold data from before the last Reset; rewind them as we reach them
+		chunk = chunk->nextChunk;
+		chunk->top = reinterpret_cast< uint8 * >( chunk ) + HOST_SPAN_HEADER_SIZE;
+		chunk->lastAllocation = NULL;
+		arena->currentChunk = chunk;
+	}
+
+	hostSpan_t * newChunk = Arena_NewChunk( arena, HOST_SPAN_SIZE );
+	if ( newChunk == NULL ) {
+		return NULL;
+	}
+	if ( chunk == NULL ) {
+		arena->firstChunk = newChunk;
+	} else {
+		chunk->nextChunk = newChunk;
+	}
+	arena->currentChunk = newChunk;
+	return Arena_Bump( newChunk, size, alignment );
+}
+
+void HostArena_Init( hostArena_t * arena, bool threadSafe ) {
+	arena->firstChunk = NULL;
+	arena->currentChunk = NULL;
+	arena->dedicatedChunks = NULL;
+	arena->threadSafe = threadSafe;
+	arena->lock.store( 0, std::memory_order_relaxed );
+}
+
+void HostArena_Destroy( hostArena_t * arena ) {
+	Arena_FreeChunks( arena->firstChunk );
+	Arena_FreeChunks( arena->dedicatedChunks );
+	arena->firstChunk = NULL;
+	arena->currentChunk = NULL;
+	arena->dedicatedChunks = NULL;
+}
+
+void * HostArena_Allocate( hostArena_t * arena, size_t size, size_t alignment ) {
+	if ( arena->threadSafe ) {
+		SpinLock( arena->lock );
+	}
+	void * data = Arena_AllocateLocked( arena, size, alignment );
+	if ( arena->threadSafe ) {
+		SpinUnlock( arena->lock );
+	}
+	return data;
+}
+
+void HostArena_Reset( hostArena_t * arena ) {
+	if ( arena->threadSafe ) {
+		SpinLock( arena->lock );
+	}
+	Arena_FreeChunks( arena->dedicatedChunks );
+	arena->dedicatedChunks = NULL;
+	arena->currentChunk = arena->firstChunk;
+	if ( arena->firstChunk != NULL ) {
+		arena->firstChunk->top = reinterpret_cast< uint8 * >( arena->firstChunk ) + HOST_SPAN_HEADER_SIZE;
+		arena->firstChunk->lastAllocation = NULL;
+	}
+	if ( arena->threadSafe ) {
+		SpinUnlock( arena->lock );
+	}
+}
+
+//Only the newest allocation of a chunk can be given back; anything else waits for Reset or Destroy
+static void Arena_Free( hostSpan_t * chunk, void * pMemory ) {
+	hostArena_t * arena = chunk->arena;
+	if ( arena->threadSafe ) {
+		SpinLock( arena->lock );
+	}
+	if ( chunk->lastAllocation == pMemory ) {
+		chunk->top = chunk->lastAllocation;
+		chunk->lastAllocation = NULL;
+	}
+	if ( arena->threadSafe ) {
+		SpinUnlock( arena->lock );
+	}
+}
+
+static bool Arena_GrowInPlace( hostSpan_t * chunk, void * pMemory, size_t size ) {
+	hostArena_t * arena = chunk->arena;
+	bool grown = false;
+	if ( arena->threadSafe ) {
+		SpinLock( arena->lock );
+	}
+	uint8 * data = reinterpret_cast< uint8 * >( pMemory );
+	if ( chunk->lastAllocation == data && data + size <= reinterpret_cast< uint8 * >( chunk ) + chunk->committedSize ) {
+		chunk->top = data + size;
+		grown = true;
+	}
+	if ( arena->threadSafe ) {
+		SpinUnlock( arena->lock );
+	}
+	return grown;
+}
+
+/*
+================================================
+Allocation callbacks
+================================================
+*/
+//Bytes that may safely be copied out of an allocation; arena allocations do not record their size, so this is
+//an upper bound that stays inside the chunk
+static size_t UsableSize( hostSpan_t * span, void * pMemory ) {
+	uint8 * spanEnd = reinterpret_cast< uint8 * >( span ) + span->committedSize;
+	switch ( span->kind ) {
+		case hostSpanKind_t::SMALL:
+			return hostSizeClasses[ span->sizeClass ];
+		case hostSpanKind_t::LARGE:
+			return span->committedSize - span->dataOffset;
+		default:
+			return ( span->lastAllocation == pMemory ) ? span->top - span->lastAllocation : spanEnd - reinterpret_cast< uint8 * >( pMemory );
+	}
+}
+
+static void * VKAPI_PTR vkAllocateHostMemory( void * pUserData, size_t size, size_t alignment, VkSystemAllocationScope allocationScope ) {
+	if ( size == 0 ) {
+		return NULL;
+	}
+	if ( alignment == 0 ) {
+		alignment = 1;
+	}
+	if ( allocationScope == VK_SYSTEM_ALLOCATION_SCOPE_DEVICE && pUserData != NULL && size <= HOST_ARENA_CHUNK_MAX ) {
+		return HostArena_Allocate( reinterpret_cast< hostArena_t * >( pUserData ), size, alignment );
+	}
+	if ( size <= HOST_SMALL_MAX && alignment <= HOST_SMALL_ALIGNMENT_MAX ) {
+		uint32 sizeClass = SizeClassForRequest( size, alignment );
+		if ( sizeClass < HOST_SIZE_CLASS_COUNT ) {
+			return Small_Allocate( sizeClass );
+		}
+	}
+	return Large_Allocate( size, alignment );
+}
+
+static void VKAPI_PTR vkFreeHostMemory( void *, void * pMemory ) {
+	if ( pMemory == NULL ) {
+		return;
+	}
+	hostSpan_t * span = SpanOf( pMemory );
+	switch ( span->kind ) {
+		case hostSpanKind_t::SMALL:
+			Small_Free( pMemory, span->sizeClass );
+			break;
+		case hostSpanKind_t::LARGE:
+			Large_Free( span );
+			break;
+		case hostSpanKind_t::ARENA:
+			Arena_Free( span, pMemory );
+			break;
+	}
+}
+
+static void * VKAPI_PTR vkReallocateHostMemory( void * pUserData, void * pOriginal, size_t size, size_t alignment, VkSystemAllocationScope allocationScope ) {
+	if ( pOriginal == NULL ) {
+		return vkAllocateHostMemory( pUserData, size, alignment, allocationScope );
+	}
+
+	if ( size == 0 ) {
+		vkFreeHostMemory( pUserData, pOriginal );
+		return NULL;
+	}
+
+	//The original block is untouched on failure, as the spec requires
+	if ( alignment != 0 && ( reinterpret_cast< uintptr_t >( pOriginal ) & ( alignment - 1 ) ) != 0 ) {
+		return NULL;
+	}
+
+	hostSpan_t * span = SpanOf( pOriginal );
+	switch ( span->kind ) {
+		case hostSpanKind_t::SMALL:
+			if ( size <= hostSizeClasses[ span->sizeClass ] ) {
+				return pOriginal;
+			}
+			break;
+		case hostSpanKind_t::LARGE:
+			if ( Large_GrowInPlace( span, size ) ) {
+				return pOriginal;
+			}
+			break;
+		case hostSpanKind_t::ARENA:
+			if ( Arena_GrowInPlace( span, pOriginal, size ) ) {
+				return pOriginal;
+			}
+			break;
+	}
+
+	void * result = vkAllocateHostMemory( pUserData, size, alignment, allocationScope );
+	if ( result == NULL ) {
+		return NULL;
+	}
+	memcpy( result, pOriginal, Min( size, UsableSize( span, pOriginal ) ) );
+	vkFreeHostMemory( pUserData, pOriginal );
+	return result;
+}
+
+VkAllocationCallbacks defaultAllocator = {
+	NULL,
+	vkAllocateHostMemory,
+	vkReallocateHostMemory,
+	vkFreeHostMemory,
+	NULL,
+	NULL
+};
+
+void HostAllocator_MakeDeviceCallbacks( hostArena_t * arena, VkAllocationCallbacks * pCallbacks ) {
+	*pCallbacks = defaultAllocator;
+	pCallbacks->pUserData = arena;
+}
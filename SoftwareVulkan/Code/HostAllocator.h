@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Common.h"
+#include "Platform.h"
+#include "vulkan/vulkan.h"
+#include <atomic>
+
+//Every host allocation lives in the first HOST_SPAN_SIZE bytes of a span-aligned region headed by a hostSpan_t,
+//so free and realloc recover the owner by masking the pointer instead of reading a per-allocation header
+#define HOST_SPAN_SIZE PLATFORM_RESERVE_ALIGNMENT
+#define HOST_SPAN_HEADER_SIZE 64
+#define HOST_SMALL_MAX 8192
+#define HOST_SMALL_ALIGNMENT_MAX HOST_SPAN_HEADER_SIZE
+#define HOST_SIZE_CLASS_COUNT 32
+//Device-scope requests past this skip the device arena so they can be returned individually
+#define HOST_ARENA_CHUNK_MAX ( 16 * 1024 )
+
+enum class hostSpanKind_t : uint32 {
+	SMALL,
+	LARGE,
+	ARENA
+};
+
+struct hostArena_t;
+
+struct hostSpan_t {
+	hostSpanKind_t	kind;
+	uint32			sizeClass;		//SMALL
+	size_t			reservedSize;
+	size_t			committedSize;
+	size_t			dataOffset;		//LARGE
+	uint8 *			top;			//ARENA
+	uint8 *			lastAllocation;
+	hostSpan_t *	nextChunk;
+	hostArena_t *	arena;
+};
+
+static_assert( sizeof( hostSpan_t ) <= HOST_SPAN_HEADER_SIZE, "hostSpan_t must fit in the span header" );
+
+/*
+================================================
+hostArena_t
+
+Bump allocator over a chain of spans.  Reset rewinds to the first span in O(1); later spans are kept and
+rewound lazily as the bump pointer reaches them, so a steady-state workload never maps memory again.
+Requests that do not fit a span get a dedicated one, released on the next Reset.
+
+Freeing the most recent allocation of a span gives its space back; any other free is a no-op until Reset
+or Destroy.  Only arenas created with threadSafe may be used from several threads at once.
+================================================
+*/
+struct hostArena_t {
+	hostSpan_t *			firstChunk;
+	hostSpan_t *			currentChunk;
+	hostSpan_t *			dedicatedChunks;
+	bool					threadSafe;
+	std::atomic< uint32 >	lock;
+};
+
+extern VkAllocationCallbacks defaultAllocator;
+
+void	HostArena_Init( hostArena_t * arena, bool threadSafe );
+void	HostArena_Destroy( hostArena_t * arena );
+void *	HostArena_Allocate( hostArena_t * arena, size_t size, size_t alignment );
+void	HostArena_Reset( hostArena_t * arena );
+
+//defaultAllocator with DEVICE-scope requests routed to arena; the arena must outlive every allocation made through it
+void	HostAllocator_MakeDeviceCallbacks( hostArena_t * arena, VkAllocationCallbacks * pCallbacks );
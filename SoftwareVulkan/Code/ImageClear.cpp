@@ -0,0 +1,146 @@
+#include "ImageClear.h"
+#include <string.h>
+
+static void FillSpan( uint8 * dst, uint64 bytes, const uint8 * value, uint32 bytesPerTexel ) {
+	if ( bytesPerTexel == 4 ) {
+		uint32 texel;
+		memcpy( &texel, value, sizeof( texel ) );
+		uint32 * dst32 = reinterpret_cast< uint32 * >( dst );
+		for ( uint64 i = 0; i < bytes / 4; i++ ) {
+			dst32[ i ] = texel;
+		}
+	} else if ( bytesPerTexel == 2 ) {
+		uint16 texel;
+		memcpy( &texel, value, sizeof( texel ) );
+		uint16 * dst16 = reinterpret_cast< uint16 * >( dst );
+		for ( uint64 i = 0; i < bytes / 2; i++ ) {
+			dst16[ i ] = texel;
+		}
+	} else {
+		for ( uint64 i = 0; i < bytes; i += bytesPerTexel ) {
+			memcpy( dst + i, value, bytesPerTexel );
+		}
+	}
+}
+
+bool ImageClear_Init( imageClearState_t * state, const imageLayout_t * layout, const VkAllocationCallbacks * allocator ) {
+	memset( state, 0, sizeof( *state ) );
+	if ( layout->bytesPerTexel == 0 || layout->bytesPerTexel > IMAGE_CLEAR_MAX_TEXEL_BYTES ) {
+		return false;
+	}
+	state->layout = layout;
+	state->tilesX = ( layout->mips[ 0 ].width + IMAGE_CLEAR_TILE_SIZE - 1 ) >> IMAGE_CLEAR_TILE_SHIFT;
+	state->tilesY = ( layout->mips[ 0 ].height + IMAGE_CLEAR_TILE_SIZE - 1 ) >> IMAGE_CLEAR_TILE_SHIFT;
+	const size_t size = sizeof( imageClearTile_t ) * state->tilesX * state->tilesY;
+	state->pTiles = reinterpret_cast< imageClearTile_t * >( allocator->pfnAllocation( allocator->pUserData, size, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( state->pTiles == NULL ) {
+		return false;
+	}
+	memset( state->pTiles, 0, size );
+	return true;
+}
+
+void ImageClear_Shutdown( imageClearState_t * state, const VkAllocationCallbacks * allocator ) {
+	if ( state->pTiles != NULL ) {
+		allocator->pfnFree( allocator->pUserData, state->pTiles );
+	}
+	memset( state, 0, sizeof( *state ) );
+}
+
+bool ImageClear_Tracks( const imageClearState_t * state, uint32 mipLevel, uint32 arrayLayer ) {
+	return state != NULL && state->pTiles != NULL && state->mipLevel == mipLevel && state->arrayLayer == arrayLayer;
+}
+
+//Optimal mips are padded out to whole 8x8 tiles, so a row of them is filled as one run, padding and all
+void ImageClear_FillTile( const imageClearState_t * state, uint8 * imageData, uint32 tileX, uint32 tileY ) {
+	const imageLayout_t * layout = state->layout;
+	const imageMipLayout_t & mip = layout->mips[ state->mipLevel ];
+	const uint32 x0 = tileX << IMAGE_CLEAR_TILE_SHIFT;
+	const uint32 y0 = tileY << IMAGE_CLEAR_TILE_SHIFT;
+	const uint32 x1 = Min( x0 + IMAGE_CLEAR_TILE_SIZE, mip.width );
+	const uint32 y1 = Min( y0 + IMAGE_CLEAR_TILE_SIZE, mip.height );
+	if ( layout->tiled ) {
+		const uint32 firstTileX = x0 >> IMAGE_TILE_SHIFT;
+		const uint32 tileCount = ( ( x1 + IMAGE_TILE_MASK ) >> IMAGE_TILE_SHIFT ) - firstTileX;
+		for ( uint32 imageTileY = y0 >> IMAGE_TILE_SHIFT; ( imageTileY << IMAGE_TILE_SHIFT ) < y1; imageTileY++ ) {
+			uint8 * run = imageData + ImageLayout_TileOffset( layout, state->mipLevel, state->arrayLayer, firstTileX, imageTileY, 0 );
+			FillSpan( run, ( uint64 )tileCount * IMAGE_TILE_TEXELS * layout->bytesPerTexel, state->value, layout->bytesPerTexel );
+		}
+		return;
+	}
+	for ( uint32 y = y0; y < y1; y++ ) {
+		uint8 * row = imageData + ImageLayout_TexelOffset( layout, state->mipLevel, state->arrayLayer, x0, y, 0 );
+		FillSpan( row, ( uint64 )( x1 - x0 ) * layout->bytesPerTexel, state->value, layout->bytesPerTexel );
+	}
+}
+
+void ImageClear_Resolve( imageClearState_t * state, uint8 * imageData ) {
+	if ( state->pTiles == NULL ) {
+		return;
+	}
+	for ( uint32 tileY = 0; tileY < state->tilesY; tileY++ ) {
+		for ( uint32 tileX = 0; tileX < state->tilesX; tileX++ ) {
+			imageClearTile_t & tile = state->pTiles[ tileY * state->tilesX + tileX ];
+			if ( tile == imageClearTile_t::PENDING ) {
+				ImageClear_FillTile( state, imageData, tileX, tileY );
+				tile = imageClearTile_t::RESOLVED;
+			}
+		}
+	}
+}
+
+//A tile partly overwritten no longer holds the value, so nothing is left RESOLVED either
+void ImageClear_Flush( imageClearState_t * state, uint8 * imageData, uint32 mipLevel, uint32 arrayLayer ) {
+	if ( !ImageClear_Tracks( state, mipLevel, arrayLayer ) ) {
+		return;
+	}
+	ImageClear_Resolve( state, imageData );
+	memset( state->pTiles, 0, sizeof( imageClearTile_t ) * state->tilesX * state->tilesY );
+}
+
+void ImageClear_Retarget( imageClearState_t * state, uint8 * imageData, uint32 mipLevel, uint32 arrayLayer, const uint8 * value ) {
+	const uint32 bytesPerTexel = state->layout->bytesPerTexel;
+	if ( ImageClear_Tracks( state, mipLevel, arrayLayer ) && memcmp( state->value, value, bytesPerTexel ) == 0 ) {
+		return;
+	}
+	ImageClear_Resolve( state, imageData );
+	const imageMipLayout_t & mip = state->layout->mips[ mipLevel ];
+	state->mipLevel = mipLevel;
+	state->arrayLayer = arrayLayer;
+	state->tilesX = ( mip.width + IMAGE_CLEAR_TILE_SIZE - 1 ) >> IMAGE_CLEAR_TILE_SHIFT;
+	state->tilesY = ( mip.height + IMAGE_CLEAR_TILE_SIZE - 1 ) >> IMAGE_CLEAR_TILE_SHIFT;
+	memcpy( state->value, value, bytesPerTexel );
+	memset( state->pTiles, 0, sizeof( imageClearTile_t ) * state->tilesX * state->tilesY );
+}
+
+void ImageClear_CopyToLinear( const imageClearState_t * state, const imageLayout_t * layout, const void * imageData, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, void * dst, uint64 dstRowPitch, uint64 dstDepthPitch ) {
+	if ( !ImageClear_Tracks( state, mipLevel, arrayLayer ) ) {
+		ImageLayout_CopyToLinear( layout, imageData, mipLevel, arrayLayer, offset, extent, dst, dstRowPitch, dstDepthPitch );
+		return;
+	}
+	const uint32 bytesPerTexel = layout->bytesPerTexel;
+	const uint32 x0 = offset.x;
+	const uint32 y0 = offset.y;
+	const uint32 x1 = offset.x + extent.width;
+	const uint32 y1 = offset.y + extent.height;
+	for ( uint32 tileY = y0 >> IMAGE_CLEAR_TILE_SHIFT; ( tileY << IMAGE_CLEAR_TILE_SHIFT ) < y1; tileY++ ) {
+		const uint32 rowStart = Max( tileY << IMAGE_CLEAR_TILE_SHIFT, y0 );
+		const uint32 rowEnd = Min( ( tileY + 1 ) << IMAGE_CLEAR_TILE_SHIFT, y1 );
+		for ( uint32 tileX = x0 >> IMAGE_CLEAR_TILE_SHIFT; ( tileX << IMAGE_CLEAR_TILE_SHIFT ) < x1; tileX++ ) {
+			const uint32 columnStart = Max( tileX << IMAGE_CLEAR_TILE_SHIFT, x0 );
+			const uint32 columnEnd = Min( ( tileX + 1 ) << IMAGE_CLEAR_TILE_SHIFT, x1 );
+			uint8 * corner = reinterpret_cast< uint8 * >( dst ) + ( rowStart - y0 ) * dstRowPitch + ( columnStart - x0 ) * bytesPerTexel;
+			if ( state->pTiles[ tileY * state->tilesX + tileX ] != imageClearTile_t::PENDING ) {
+				const VkOffset3D tileOffset = { ( int32 )columnStart, ( int32 )rowStart, offset.z };
+				const VkExtent3D tileExtent = { columnEnd - columnStart, rowEnd - rowStart, extent.depth };
+				ImageLayout_CopyToLinear( layout, imageData, mipLevel, arrayLayer, tileOffset, tileExtent, corner, dstRowPitch, dstDepthPitch );
+				continue;
+			}
+			for ( uint32 z = 0; z < extent.depth; z++ ) {
+				for ( uint32 y = rowStart; y < rowEnd; y++ ) {
+					FillSpan( corner + z * dstDepthPitch + ( y - rowStart ) * dstRowPitch, ( uint64 )( columnEnd - columnStart ) * bytesPerTexel, state->value, bytesPerTexel );
+				}
+			}
+		}
+	}
+}
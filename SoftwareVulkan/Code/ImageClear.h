@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Common.h"
+#include "ImageLayout.h"
+#include "vulkan/vulkan.h"
+
+//Clears are tracked per 64x64 texel tile, the rasterizer's screen tile, so each back-end job owns one tile outright
+#define IMAGE_CLEAR_TILE_SHIFT 6
+#define IMAGE_CLEAR_TILE_SIZE ( 1 << IMAGE_CLEAR_TILE_SHIFT )
+#define IMAGE_CLEAR_MAX_TEXEL_BYTES 8
+
+enum class imageClearTile_t : uint8 {
+	STORED,					//memory holds the tile's contents
+	PENDING,				//cleared to the value, memory not written yet
+	RESOLVED				//cleared to the value, and memory holds it as well
+};
+
+/*
+================================================
+imageClearState_t
+
+Lazy clears for one subresource of a render target at a time.  A clear load op marks whole tiles as
+holding the clear value instead of writing them, and a tile is only filled once something needs its
+texels: a draw that touches it, a read back, or a present.  Tiles a frame never draws to are never
+written, which is most of a depth buffer cleared every frame.  A resolved tile remembers that its memory
+already holds the value, so clearing it again to the same value writes nothing either.
+
+Tile states are bytes, so the rasterizer's tile jobs update their own without locking; everything else
+happens on the queue executing the commands, outside render passes.
+================================================
+*/
+struct imageClearState_t {
+	const imageLayout_t *	layout;
+	uint32					mipLevel;				//the subresource the tile states describe
+	uint32					arrayLayer;
+	uint32					tilesX;
+	uint32					tilesY;
+	uint8					value[ IMAGE_CLEAR_MAX_TEXEL_BYTES ];	//packed in the image's format
+	imageClearTile_t *		pTiles;					//sized for mip 0; NULL when the image is not tracked
+};
+
+bool	ImageClear_Init( imageClearState_t * state, const imageLayout_t * layout, const VkAllocationCallbacks * allocator );
+void	ImageClear_Shutdown( imageClearState_t * state, const VkAllocationCallbacks * allocator );
+//Whether the tile states describe ( mipLevel, arrayLayer ); a state that is not tracked describes nothing
+bool	ImageClear_Tracks( const imageClearState_t * state, uint32 mipLevel, uint32 arrayLayer );
+//Points the tile states at a subresource cleared to value; tiles still pending a different clear are written first
+void	ImageClear_Retarget( imageClearState_t * state, uint8 * imageData, uint32 mipLevel, uint32 arrayLayer, const uint8 * value );
+//Writes the value over one tile of the tracked subresource, leaving its state alone
+void	ImageClear_FillTile( const imageClearState_t * state, uint8 * imageData, uint32 tileX, uint32 tileY );
+//Writes every pending tile, for readers that take the image straight from memory
+void	ImageClear_Resolve( imageClearState_t * state, uint8 * imageData );
+//Writes every pending tile of ( mipLevel, arrayLayer ) and forgets the value, for writers that bypass the rasterizer
+void	ImageClear_Flush( imageClearState_t * state, uint8 * imageData, uint32 mipLevel, uint32 arrayLayer );
+//ImageLayout_CopyToLinear that fills pending tiles from the value instead of reading them
+void	ImageClear_CopyToLinear( const imageClearState_t * state, const imageLayout_t * layout, const void * imageData, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, void * dst, uint64 dstRowPitch, uint64 dstDepthPitch );
@@ -0,0 +1,245 @@
+#include "ImageLayout.h"
+#include <math.h>
+#include <string.h>
+
+const uint8 imageMortonX[ IMAGE_TILE_SIZE ] = { 0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15 };
+const uint8 imageMortonY[ IMAGE_TILE_SIZE ] = { 0x00, 0x02, 0x08, 0x0A, 0x20, 0x22, 0x28, 0x2A };
+
+static uint64 AlignTo( uint64 value, uint64 alignment ) {
+	return ( value + alignment - 1 ) & ~( alignment - 1 );
+}
+
+uint32 ImageLayout_BytesPerTexel( VkFormat format ) {
+	const formatInfo_t * info = Format_Find( format );
+	return ( info != NULL ) ? info->bytesPerTexel : 0;
+}
+
+void ImageLayout_Init( imageLayout_t * layout, const VkImageCreateInfo * pCreateInfo ) {
+	memset( layout, 0, sizeof( *layout ) );
+	//A 1D image has no second axis to keep local, so tiling it would only pad each row out by 8x
+	layout->tiled = ( pCreateInfo->tiling == VK_IMAGE_TILING_OPTIMAL ) && ( pCreateInfo->imageType != VK_IMAGE_TYPE_1D );
+	const formatInfo_t * info = Format_Find( pCreateInfo->format );
+	layout->bytesPerTexel = ( info != NULL ) ? info->bytesPerTexel : 0;
+	layout->blockShift = ( info != NULL ) ? info->blockShift : 0;
+	layout->mipLevels = Min( pCreateInfo->mipLevels, ( uint32 )IMAGE_MAX_MIP_LEVELS );
+	layout->arrayLayers = pCreateInfo->arrayLayers;
+	layout->alignment = IMAGE_MEMORY_ALIGNMENT;
+
+	uint64 offset = 0;
+	for ( uint32 level = 0; level < layout->mipLevels; level++ ) {
+		imageMipLayout_t & mip = layout->mips[ level ];
+		mip.width = Max( pCreateInfo->extent.width >> level, 1U );
+		mip.height = Max( pCreateInfo->extent.height >> level, 1U );
+		mip.depth = Max( pCreateInfo->extent.depth >> level, 1U );
+		const uint32 blocksX = ImageLayout_Blocks( layout, mip.width );
+		const uint32 blocksY = ImageLayout_Blocks( layout, mip.height );
+		if ( layout->tiled ) {
+			mip.tilesX = ( blocksX + IMAGE_TILE_MASK ) >> IMAGE_TILE_SHIFT;
+			mip.tilesY = ( blocksY + IMAGE_TILE_MASK ) >> IMAGE_TILE_SHIFT;
+			mip.rowPitch = ( uint64 )mip.tilesX * IMAGE_TILE_TEXELS * layout->bytesPerTexel;
+			mip.depthPitch = mip.rowPitch * mip.tilesY;
+		} else {
+			mip.rowPitch = ( uint64 )blocksX * layout->bytesPerTexel;
+			mip.depthPitch = mip.rowPitch * blocksY;
+		}
+		//Every mip starts on a cache line so tiles never straddle one
+		mip.offset = offset;
+		mip.size = mip.depthPitch * mip.depth;
+		offset = AlignTo( offset + mip.size, IMAGE_MEMORY_ALIGNMENT );
+	}
+	layout->arrayPitch = offset;
+	layout->size = offset * layout->arrayLayers;
+}
+
+//Only meaningful for linear images; the spec leaves optimal layouts opaque, so they report zeros
+void ImageLayout_GetSubresourceLayout( const imageLayout_t * layout, uint32 mipLevel, uint32 arrayLayer, VkSubresourceLayout * pLayout ) {
+	memset( pLayout, 0, sizeof( *pLayout ) );
+	if ( layout->tiled || mipLevel >= layout->mipLevels || arrayLayer >= layout->arrayLayers ) {
+		return;
+	}
+	const imageMipLayout_t & mip = layout->mips[ mipLevel ];
+	pLayout->offset = arrayLayer * layout->arrayPitch + mip.offset;
+	pLayout->size = mip.size;
+	pLayout->rowPitch = mip.rowPitch;
+	pLayout->depthPitch = mip.depthPitch;
+	pLayout->arrayPitch = layout->arrayPitch;
+}
+
+static void CopyTexel( uint8 * dst, const uint8 * src, uint32 bytesPerTexel ) {
+	if ( bytesPerTexel == 4 ) {
+		*reinterpret_cast< uint32 * >( dst ) = *reinterpret_cast< const uint32 * >( src );
+	} else {
+		memcpy( dst, src, bytesPerTexel );
+	}
+}
+
+//Walks the region a tile at a time so each image tile is read or written while it is hot, whichever direction the copy goes
+template< bool __toLinear__ >
+static void CopyRegion( const imageLayout_t * layout, uint8 * imageData, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, uint8 * linear, uint64 linearRowPitch, uint64 linearDepthPitch ) {
+	const uint32 bytesPerTexel = layout->bytesPerTexel;
+	for ( uint32 z = 0; z < extent.depth; z++ ) {
+		uint8 * linearSlice = linear + z * linearDepthPitch;
+		if ( !layout->tiled ) {
+			for ( uint32 y = 0; y < extent.height; y++ ) {
+				uint8 * image = imageData + ImageLayout_TexelOffset( layout, mipLevel, arrayLayer, offset.x, offset.y + y, offset.z + z );
+				uint8 * row = linearSlice + y * linearRowPitch;
+				if ( __toLinear__ ) {
+					memcpy( row, image, ( size_t )extent.width * bytesPerTexel );
+				} else {
+					memcpy( image, row, ( size_t )extent.width * bytesPerTexel );
+				}
+			}
+			continue;
+		}
+
+		const uint32 x0 = offset.x;
+		const uint32 y0 = offset.y;
+		const uint32 x1 = offset.x + extent.width;
+		const uint32 y1 = offset.y + extent.height;
+		for ( uint32 tileY = y0 >> IMAGE_TILE_SHIFT; ( tileY << IMAGE_TILE_SHIFT ) < y1; tileY++ ) {
+			const uint32 rowStart = Max( tileY << IMAGE_TILE_SHIFT, y0 );
+			const uint32 rowEnd = Min( ( tileY + 1 ) << IMAGE_TILE_SHIFT, y1 );
+			for ( uint32 tileX = x0 >> IMAGE_TILE_SHIFT; ( tileX << IMAGE_TILE_SHIFT ) < x1; tileX++ ) {
+				const uint32 columnStart = Max( tileX << IMAGE_TILE_SHIFT, x0 );
+				const uint32 columnEnd = Min( ( tileX + 1 ) << IMAGE_TILE_SHIFT, x1 );
+				uint8 * tile = imageData + ImageLayout_TileOffset( layout, mipLevel, arrayLayer, tileX, tileY, offset.z + z );
+				for ( uint32 y = rowStart; y < rowEnd; y++ ) {
+					const uint32 mortonY = imageMortonY[ y & IMAGE_TILE_MASK ];
+					uint8 * row = linearSlice + ( y - y0 ) * linearRowPitch + ( columnStart - x0 ) * bytesPerTexel;
+					for ( uint32 x = columnStart; x < columnEnd; x++, row += bytesPerTexel ) {
+						uint8 * texel = tile + ( mortonY | imageMortonX[ x & IMAGE_TILE_MASK ] ) * bytesPerTexel;
+						if ( __toLinear__ ) {
+							CopyTexel( row, texel, bytesPerTexel );
+						} else {
+							CopyTexel( texel, row, bytesPerTexel );
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+//Compressed regions start on block boundaries and end on them or at the edge of the mip, so they copy as whole blocks
+static void CopyRegionInBlocks( const imageLayout_t * layout, const VkOffset3D & offset, const VkExtent3D & extent, VkOffset3D * pBlockOffset, VkExtent3D * pBlockExtent ) {
+	*pBlockOffset = offset;
+	*pBlockExtent = extent;
+	pBlockOffset->x = offset.x >> layout->blockShift;
+	pBlockOffset->y = offset.y >> layout->blockShift;
+	pBlockExtent->width = ImageLayout_Blocks( layout, extent.width );
+	pBlockExtent->height = ImageLayout_Blocks( layout, extent.height );
+}
+
+void ImageLayout_CopyToLinear( const imageLayout_t * layout, const void * imageData, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, void * dst, uint64 dstRowPitch, uint64 dstDepthPitch ) {
+	VkOffset3D blockOffset;
+	VkExtent3D blockExtent;
+	CopyRegionInBlocks( layout, offset, extent, &blockOffset, &blockExtent );
+	CopyRegion< true >( layout, reinterpret_cast< uint8 * >( const_cast< void * >( imageData ) ), mipLevel, arrayLayer, blockOffset, blockExtent, reinterpret_cast< uint8 * >( dst ), dstRowPitch, dstDepthPitch );
+}
+
+void ImageLayout_CopyFromLinear( const imageLayout_t * layout, void * imageData, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, const void * src, uint64 srcRowPitch, uint64 srcDepthPitch ) {
+	VkOffset3D blockOffset;
+	VkExtent3D blockExtent;
+	CopyRegionInBlocks( layout, offset, extent, &blockOffset, &blockExtent );
+	CopyRegion< false >( layout, reinterpret_cast< uint8 * >( imageData ), mipLevel, arrayLayer, blockOffset, blockExtent, reinterpret_cast< uint8 * >( const_cast< void * >( src ) ), srcRowPitch, srcDepthPitch );
+}
+
+/*
+================================================
+Blits
+================================================
+*/
+//Destination texels are converted this many at a time, which keeps every staging buffer on the stack
+#define IMAGE_BLIT_SPAN 64
+#define IMAGE_BLIT_MAX_TAPS 4
+
+//Where the center of destination texel dstCoord lands in the source, as the two texels either side of it and the
+//weight of the second; both are clamped to the edge of the subresource, as a sampler would
+static float BlitTaps( int32 dstCoord, int32 dstOrigin, float scale, int32 srcOrigin, uint32 srcSize, bool linear, int32 * pTaps ) {
+	const float position = ( ( float )( dstCoord - dstOrigin ) + 0.5f ) * scale + ( float )srcOrigin;
+	const float center = linear ? position - 0.5f : position;
+	const float first = floorf( center );
+	const int32 last = ( int32 )srcSize - 1;
+	pTaps[ 0 ] = Min( Max( ( int32 )first, 0 ), last );
+	pTaps[ 1 ] = linear ? Min( Max( ( int32 )first + 1, 0 ), last ) : pTaps[ 0 ];
+	return linear ? center - first : 0.0f;
+}
+
+static float Lerp( float a, float b, float weight ) {
+	return a + ( b - a ) * weight;
+}
+
+void ImageLayout_Blit( const imageBlitSurface_t & src, const imageBlitSurface_t & dst, VkFilter filter ) {
+	const imageMipLayout_t & srcMip = src.layout->mips[ src.mipLevel ];
+	const imageMipLayout_t & dstMip = dst.layout->mips[ dst.mipLevel ];
+	const int32 dstWidth = dst.offsets[ 1 ].x - dst.offsets[ 0 ].x;
+	const int32 dstHeight = dst.offsets[ 1 ].y - dst.offsets[ 0 ].y;
+	if ( dstWidth == 0 || dstHeight == 0 ) {
+		return;
+	}
+	const int32 minX = Max( Min( dst.offsets[ 0 ].x, dst.offsets[ 1 ].x ), 0 );
+	const int32 maxX = Min( Max( dst.offsets[ 0 ].x, dst.offsets[ 1 ].x ), ( int32 )dstMip.width );
+	const int32 minY = Max( Min( dst.offsets[ 0 ].y, dst.offsets[ 1 ].y ), 0 );
+	const int32 maxY = Min( Max( dst.offsets[ 0 ].y, dst.offsets[ 1 ].y ), ( int32 )dstMip.height );
+	const float scaleX = ( float )( src.offsets[ 1 ].x - src.offsets[ 0 ].x ) / ( float )dstWidth;
+	const float scaleY = ( float )( src.offsets[ 1 ].y - src.offsets[ 0 ].y ) / ( float )dstHeight;
+	//Integers are never filtered
+	const bool linear = ( filter == VK_FILTER_LINEAR ) && !Format_IsInteger( src.converter.info );
+	const uint32 taps = linear ? IMAGE_BLIT_MAX_TAPS : 1;
+	const uint32 srcBytes = src.converter.info->bytesPerTexel;
+	const uint32 dstBytes = dst.layout->bytesPerTexel;
+	//Neighbouring taps mostly fall in the same block, so the last one decoded is kept
+	uint8 decoded[ FORMAT_MAX_DECODED_BLOCK_BYTES ];
+	const uint8 * pDecodedBlock = NULL;
+
+	uint8 raw[ IMAGE_BLIT_SPAN * IMAGE_BLIT_MAX_TAPS * FORMAT_MAX_TEXEL_BYTES ];
+	uint32 texels[ IMAGE_BLIT_SPAN * IMAGE_BLIT_MAX_TAPS * FORMAT_TEXEL_LANES ];
+	int32 columns[ IMAGE_BLIT_SPAN ][ 2 ];
+	float columnWeights[ IMAGE_BLIT_SPAN ];
+	for ( int32 y = minY; y < maxY; y++ ) {
+		int32 rows[ 2 ];
+		const float rowWeight = BlitTaps( y, dst.offsets[ 0 ].y, scaleY, src.offsets[ 0 ].y, srcMip.height, linear, rows );
+		for ( int32 spanX = minX; spanX < maxX; spanX += IMAGE_BLIT_SPAN ) {
+			const uint32 count = ( uint32 )Min( maxX - spanX, IMAGE_BLIT_SPAN );
+			for ( uint32 i = 0; i < count; i++ ) {
+				columnWeights[ i ] = BlitTaps( spanX + ( int32 )i, dst.offsets[ 0 ].x, scaleX, src.offsets[ 0 ].x, srcMip.width, linear, columns[ i ] );
+			}
+			//Taps are gathered raw and unpacked in one run, so the format kernels see whole spans
+			uint8 * pTap = raw;
+			for ( uint32 i = 0; i < count; i++ ) {
+				for ( uint32 t = 0; t < taps; t++, pTap += srcBytes ) {
+					const uint32 x = columns[ i ][ t & 1 ];
+					const uint32 y = rows[ t >> 1 ];
+					if ( src.decode == NULL ) {
+						memcpy( pTap, src.data + ImageLayout_TexelOffset( src.layout, src.mipLevel, src.arrayLayer, x, y, 0 ), srcBytes );
+						continue;
+					}
+					const uint8 * pBlock = src.data + ImageLayout_TexelOffset( src.layout, src.mipLevel, src.arrayLayer, x >> 2, y >> 2, 0 );
+					if ( pBlock != pDecodedBlock ) {
+						src.decode( pBlock, decoded );
+						pDecodedBlock = pBlock;
+					}
+					memcpy( pTap, decoded + ( ( y & 3 ) * 4 + ( x & 3 ) ) * srcBytes, srcBytes );
+				}
+			}
+			src.converter.unpack( src.converter.info, raw, count * taps, texels );
+			if ( linear ) {
+				//Each texel's result only overwrites the taps of texels already filtered
+				for ( uint32 i = 0; i < count; i++ ) {
+					const float * pTaps = reinterpret_cast< const float * >( texels + i * IMAGE_BLIT_MAX_TAPS * FORMAT_TEXEL_LANES );
+					float filtered[ FORMAT_TEXEL_LANES ];
+					for ( uint32 c = 0; c < FORMAT_TEXEL_LANES; c++ ) {
+						const float top = Lerp( pTaps[ c ], pTaps[ FORMAT_TEXEL_LANES + c ], columnWeights[ i ] );
+						const float bottom = Lerp( pTaps[ 2 * FORMAT_TEXEL_LANES + c ], pTaps[ 3 * FORMAT_TEXEL_LANES + c ], columnWeights[ i ] );
+						filtered[ c ] = Lerp( top, bottom, rowWeight );
+					}
+					memcpy( texels + i * FORMAT_TEXEL_LANES, filtered, sizeof( filtered ) );
+				}
+			}
+			dst.converter.pack( dst.converter.info, texels, count, raw );
+			for ( uint32 i = 0; i < count; i++ ) {
+				memcpy( dst.data + ImageLayout_TexelOffset( dst.layout, dst.mipLevel, dst.arrayLayer, spanX + i, y, 0 ), raw + i * dstBytes, dstBytes );
+			}
+		}
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Common.h"
+#include "Format.h"
+#include "vulkan/vulkan.h"
+
+#define IMAGE_MAX_MIP_LEVELS 15
+//Optimal images are stored as 8x8 texel tiles; 256 bytes for a 32-bit format, four cache lines
+#define IMAGE_TILE_SHIFT 3
+#define IMAGE_TILE_SIZE ( 1 << IMAGE_TILE_SHIFT )
+#define IMAGE_TILE_TEXELS ( IMAGE_TILE_SIZE * IMAGE_TILE_SIZE )
+#define IMAGE_TILE_MASK ( IMAGE_TILE_SIZE - 1 )
+#define IMAGE_MEMORY_ALIGNMENT 64
+
+struct imageMipLayout_t {
+	uint64	offset;			//from the start of an array layer
+	uint64	size;
+	uint64	rowPitch;		//linear: bytes per row; tiled: bytes per row of tiles
+	uint64	depthPitch;
+	uint32	width;
+	uint32	height;
+	uint32	depth;
+	uint32	tilesX;
+	uint32	tilesY;
+};
+
+/*
+================================================
+imageLayout_t
+
+Where every texel of an image lives in its bound memory.  Linear images are row-major with tightly packed
+rows so the host can map them.  Optimal 2D and 3D images are stored as row-major runs of 8x8 tiles, and
+texels inside a tile follow Morton (Z) order, so any 2x2, 4x4 or 8x8 neighbourhood shares a handful of
+cache lines no matter how wide the image is.  Each mip is padded out to whole tiles.  Block-compressed
+images are laid out the same way with each 4x4 block standing in for a texel, so their pitches, tiles and
+texel offsets are all in blocks; only mip extents stay in texels.
+================================================
+*/
+struct imageLayout_t {
+	bool				tiled;
+	uint32				bytesPerTexel;		//per block when compressed
+	uint32				blockShift;			//0, or 2 for 4x4 blocks
+	uint32				mipLevels;
+	uint32				arrayLayers;
+	uint64				arrayPitch;
+	uint64				size;
+	uint64				alignment;
+	imageMipLayout_t	mips[ IMAGE_MAX_MIP_LEVELS ];
+};
+
+//Bit-interleave tables for a coordinate inside a tile: x lands on the even bits, y on the odd bits
+extern const uint8 imageMortonX[ IMAGE_TILE_SIZE ];
+extern const uint8 imageMortonY[ IMAGE_TILE_SIZE ];
+
+uint32	ImageLayout_BytesPerTexel( VkFormat format );
+void	ImageLayout_Init( imageLayout_t * layout, const VkImageCreateInfo * pCreateInfo );
+void	ImageLayout_GetSubresourceLayout( const imageLayout_t * layout, uint32 mipLevel, uint32 arrayLayer, VkSubresourceLayout * pLayout );
+
+//Blocks along an axis of texels, rounding up the partial blocks at the edge of a mip
+inline uint32 ImageLayout_Blocks( const imageLayout_t * layout, uint32 texels ) {
+	return ( texels + ( 1U << layout->blockShift ) - 1 ) >> layout->blockShift;
+}
+
+//x and y count blocks for a compressed image
+inline uint64 ImageLayout_TexelOffset( const imageLayout_t * layout, uint32 mipLevel, uint32 arrayLayer, uint32 x, uint32 y, uint32 z ) {
+	const imageMipLayout_t & mip = layout->mips[ mipLevel ];
+	uint64 base = arrayLayer * layout->arrayPitch + mip.offset + z * mip.depthPitch;
+	if ( !layout->tiled ) {
+		return base + y * mip.rowPitch + x * layout->bytesPerTexel;
+	}
+	uint32 texelInTile = imageMortonX[ x & IMAGE_TILE_MASK ] | imageMortonY[ y & IMAGE_TILE_MASK ];
+	return base + ( y >> IMAGE_TILE_SHIFT ) * mip.rowPitch + ( ( uint64 )( x >> IMAGE_TILE_SHIFT ) * IMAGE_TILE_TEXELS + texelInTile ) * layout->bytesPerTexel;
+}
+
+//First byte of the tile holding ( tileX, tileY ); raster and sampling kernels work a tile at a time from here
+inline uint64 ImageLayout_TileOffset( const imageLayout_t * layout, uint32 mipLevel, uint32 arrayLayer, uint32 tileX, uint32 tileY, uint32 z ) {
+	const imageMipLayout_t & mip = layout->mips[ mipLevel ];
+	return arrayLayer * layout->arrayPitch + mip.offset + z * mip.depthPitch + tileY * mip.rowPitch + ( uint64 )tileX * IMAGE_TILE_TEXELS * layout->bytesPerTexel;
+}
+
+//Copy kernels between an image subresource and tightly described linear memory, walking whole tiles where the layout allows;
+//offset and extent are in texels even for compressed images, the pitches are in bytes of whole blocks
+void	ImageLayout_CopyToLinear( const imageLayout_t * layout, const void * imageData, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, void * dst, uint64 dstRowPitch, uint64 dstDepthPitch );
+void	ImageLayout_CopyFromLinear( const imageLayout_t * layout, void * imageData, uint32 mipLevel, uint32 arrayLayer, const VkOffset3D & offset, const VkExtent3D & extent, const void * src, uint64 srcRowPitch, uint64 srcDepthPitch );
+
+//One side of a blit: a subresource of a 2D image, the corners of its region and the converter for its format,
+//or for a compressed source the converter of the format its blocks decode to
+struct imageBlitSurface_t {
+	const imageLayout_t *	layout;
+	uint8 *					data;
+	uint32					mipLevel;
+	uint32					arrayLayer;
+	formatConverter_t		converter;
+	formatDecodeFunc_t		decode;				//NULL unless block-compressed
+	VkOffset3D				offsets[ 2 ];
+};
+
+//Scales src's region onto dst's, flipping where the corners are swapped; every texel goes through unpacked lanes,
+//so any two formats with converters blit, and linear filtering happens on linear values even for sRGB
+void	ImageLayout_Blit( const imageBlitSurface_t & src, const imageBlitSurface_t & dst, VkFilter filter );
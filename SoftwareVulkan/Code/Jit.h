@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Cpu.h"
+#include "Pipeline.h"
+
+/*
+================================================
+Pipeline JIT
+
+Translates a pipeline's shader IR, together with its fixed-function stages, into x86-64 SSE4.1 code
+operating on the same register file and pipelineFrame_t as the interpreter.  Arithmetic, comparisons,
+selects and derivatives are emitted inline four lanes at a time; every other instruction calls back
+into ShaderExecution_Step, so control flow, memory access and sampling keep a single implementation.
+A pipeline that cannot be compiled, on a host below SSE4.1 or in a 32-bit build, is left on the
+interpreter.
+================================================
+*/
+
+//On success sets nativeCode and the native entry points; on failure leaves the pipeline untouched
+bool	Jit_CompileGraphicsPipeline( graphicsPipeline_t * pipeline, cpuIsa_t isa );
+bool	Jit_CompileComputePipeline( computePipeline_t * pipeline, cpuIsa_t isa );
@@ -0,0 +1,1634 @@
+#include "Jit.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined( _M_X64 ) || defined( __x86_64__ )
+
+/*
+================================================
+Assembler
+
+Code is emitted into a growable buffer, then copied to an executable mapping with the constant pool
+placed after it.  Jumps and RIP-relative constant references are recorded as fixups and patched once
+every label is bound.
+================================================
+*/
+enum jitGpr_t : uint32 {
+	JIT_RAX,
+	JIT_RCX,
+	JIT_RDX,
+	JIT_RBX,
+	JIT_RSP,
+	JIT_RBP,
+	JIT_RSI,
+	JIT_RDI,
+	JIT_R8,
+	JIT_R9,
+	JIT_R10,
+	JIT_R11,
+	JIT_R12,
+	JIT_R13,
+	JIT_R14,
+	JIT_R15
+};
+
+//Integer arguments of the native calling convention
+#if defined( _WIN32 )
+static const uint32 jitArguments[ 4 ] = { JIT_RCX, JIT_RDX, JIT_R8, JIT_R9 };
+#else
+static const uint32 jitArguments[ 4 ] = { JIT_RDI, JIT_RSI, JIT_RDX, JIT_RCX };
+#endif
+
+//Legacy prefix in the top byte, then a two or three byte opcode
+enum jitSseOp_t : uint32 {
+	JIT_MOVUPS_LOAD		= 0x00000F10,
+	JIT_MOVUPS_STORE	= 0x00000F11,
+	JIT_MOVAPS_LOAD		= 0x00000F28,
+	JIT_MOVAPS_STORE	= 0x00000F29,
+	JIT_MOVMSKPS		= 0x00000F50,
+	JIT_SQRTPS			= 0x00000F51,
+	JIT_ANDPS			= 0x00000F54,
+	JIT_ANDNPS			= 0x00000F55,
+	JIT_ORPS			= 0x00000F56,
+	JIT_XORPS			= 0x00000F57,
+	JIT_ADDPS			= 0x00000F58,
+	JIT_MULPS			= 0x00000F59,
+	JIT_CVTDQ2PS		= 0x00000F5B,
+	JIT_SUBPS			= 0x00000F5C,
+	JIT_MINPS			= 0x00000F5D,
+	JIT_DIVPS			= 0x00000F5E,
+	JIT_MAXPS			= 0x00000F5F,
+	JIT_CMPPS			= 0x00000FC2,
+	JIT_SHUFPS			= 0x00000FC6,
+	JIT_MOVSS_LOAD		= 0xF3000F10,
+	JIT_MOVSS_STORE		= 0xF3000F11,
+	JIT_CVTSI2SS		= 0xF3000F2A,
+	JIT_MULSS			= 0xF3000F59,
+	JIT_CVTTPS2DQ		= 0xF3000F5B,
+	JIT_MAXSS			= 0xF3000F5F,
+	JIT_PCMPGTD			= 0x66000F66,
+	JIT_MOVD_LOAD		= 0x66000F6E,
+	JIT_PSHUFD			= 0x66000F70,
+	JIT_PSHIFTD			= 0x66000F72,		//immediate shifts, the operation in the reg field
+	JIT_PSHIFTDQ		= 0x66000F73,		//whole-register byte shifts, likewise
+	JIT_PCMPEQD			= 0x66000F76,
+	JIT_PAND			= 0x66000FDB,
+	JIT_PANDN			= 0x66000FDF,
+	JIT_POR				= 0x66000FEB,
+	JIT_PXOR			= 0x66000FEF,
+	JIT_PSUBD			= 0x66000FFA,
+	JIT_PADDD			= 0x66000FFE,
+	JIT_PABSD			= 0x660F381E,
+	JIT_PMINSD			= 0x660F3839,
+	JIT_PMINUD			= 0x660F383B,
+	JIT_PMAXSD			= 0x660F383D,
+	JIT_PMAXUD			= 0x660F383F,
+	JIT_PMULLD			= 0x660F3840,
+	JIT_ROUNDPS			= 0x660F3A08
+};
+
+//Reg field values of JIT_PSHIFTD
+#define JIT_SHIFT_RIGHT_LOGICAL 2
+#define JIT_SHIFT_RIGHT_ARITHMETIC 4
+#define JIT_SHIFT_LEFT 6
+//Reg field values of JIT_PSHIFTDQ
+#define JIT_SHIFT_RIGHT_BYTES 3
+#define JIT_SHIFT_LEFT_BYTES 7
+
+//cmpps predicates
+#define JIT_CMP_EQ 0
+#define JIT_CMP_LT 1
+#define JIT_CMP_LE 2
+#define JIT_CMP_UNORD 3
+#define JIT_CMP_NEQ 4
+#define JIT_CMP_NLT 5
+#define JIT_CMP_NLE 6
+#define JIT_CMP_ORD 7
+
+//Jump conditions
+#define JIT_ALWAYS 0xFFFFFFFF
+#define JIT_EQUAL 0x4
+#define JIT_NOT_EQUAL 0x5
+#define JIT_BELOW_OR_EQUAL 0x6
+
+#define JIT_MAX_CONSTANTS 256
+
+enum jitOperandKind_t : uint32 {
+	JIT_OPERAND_REGISTER,
+	JIT_OPERAND_MEMORY,
+	JIT_OPERAND_CONSTANT
+};
+
+//A register, [ base + displacement ], or an entry of the constant pool
+struct jitOperand_t {
+	jitOperandKind_t	kind;
+	uint32				reg;				//register, base register or constant index
+	int32				displacement;
+};
+
+struct jitFixup_t {
+	uint32		position;			//of the 32-bit displacement
+	uint32		end;				//of the instruction, which the displacement is relative to
+	uint32		target;				//label, or constant index
+	bool		constant;
+};
+
+struct jitAssembler_t {
+	const VkAllocationCallbacks *	allocator;
+	uint8 *							pCode;
+	uint32							size;
+	uint32							capacity;
+	uint32 *						pLabels;			//code offset of each label, JIT_UNBOUND until bound
+	uint32							labelCount;
+	uint32							labelCapacity;
+	jitFixup_t *					pFixups;
+	uint32							fixupCount;
+	uint32							fixupCapacity;
+	uint32							constants[ JIT_MAX_CONSTANTS ][ 4 ];
+	uint32							constantCount;
+	bool							failed;
+};
+
+#define JIT_UNBOUND 0xFFFFFFFF
+
+static void Jit_Init( jitAssembler_t * a, const VkAllocationCallbacks * allocator ) {
+	memset( a, 0, sizeof( jitAssembler_t ) );
+	a->allocator = allocator;
+}
+
+static void Jit_Shutdown( jitAssembler_t * a ) {
+	a->allocator->pfnFree( a->allocator->pUserData, a->pCode );
+	a->allocator->pfnFree( a->allocator->pUserData, a->pLabels );
+	a->allocator->pfnFree( a->allocator->pUserData, a->pFixups );
+}
+
+//Grows an array to hold at least count elements; sets failed and returns false when out of memory
+static bool Jit_Reserve( jitAssembler_t * a, void ** ppData, uint32 * pCapacity, uint32 count, size_t elementSize ) {
+	if ( count <= *pCapacity ) {
+		return true;
+	}
+	if ( a->failed ) {
+		return false;
+	}
+	const uint32 capacity = Max( Max( *pCapacity * 2, count ), 256u );
+	void * pData = a->allocator->pfnReallocation( a->allocator->pUserData, *ppData, capacity * elementSize, 16, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND );
+	if ( pData == NULL ) {
+		a->failed = true;
+		return false;
+	}
+	*ppData = pData;
+	*pCapacity = capacity;
+	return true;
+}
+
+static void Jit_Byte( jitAssembler_t * a, uint32 value ) {
+	if ( Jit_Reserve( a, reinterpret_cast< void ** >( &a->pCode ), &a->capacity, a->size + 1, 1 ) ) {
+		a->pCode[ a->size++ ] = ( uint8 )value;
+	}
+}
+
+static void Jit_Dword( jitAssembler_t * a, uint32 value ) {
+	for ( uint32 i = 0; i < 4; i++ ) {
+		Jit_Byte( a, value >> ( i * 8 ) );
+	}
+}
+
+static uint32 Jit_NewLabels( jitAssembler_t * a, uint32 count ) {
+	const uint32 first = a->labelCount;
+	if ( !Jit_Reserve( a, reinterpret_cast< void ** >( &a->pLabels ), &a->labelCapacity, first + count, sizeof( uint32 ) ) ) {
+		return 0;
+	}
+	for ( uint32 i = 0; i < count; i++ ) {
+		a->pLabels[ first + i ] = JIT_UNBOUND;
+	}
+	a->labelCount += count;
+	return first;
+}
+
+static void Jit_Bind( jitAssembler_t * a, uint32 label ) {
+	if ( !a->failed ) {
+		a->pLabels[ label ] = a->size;
+	}
+}
+
+//Adds a 32-bit displacement to patch, relative to an instruction ending trailingBytes after it
+static void Jit_Fixup( jitAssembler_t * a, uint32 target, bool constant, uint32 trailingBytes ) {
+	if ( Jit_Reserve( a, reinterpret_cast< void ** >( &a->pFixups ), &a->fixupCapacity, a->fixupCount + 1, sizeof( jitFixup_t ) ) ) {
+		jitFixup_t * fixup = &a->pFixups[ a->fixupCount++ ];
+		fixup->position = a->size;
+		fixup->end = a->size + 4 + trailingBytes;
+		fixup->target = target;
+		fixup->constant = constant;
+	}
+	Jit_Dword( a, 0 );
+}
+
+static jitOperand_t Jit_Register( uint32 reg ) {
+	jitOperand_t operand = { JIT_OPERAND_REGISTER, reg, 0 };
+	return operand;
+}
+
+static jitOperand_t Jit_Memory( uint32 base, int32 displacement ) {
+	jitOperand_t operand = { JIT_OPERAND_MEMORY, base, displacement };
+	return operand;
+}
+
+//A 16-byte pool entry, shared between identical values
+static jitOperand_t Jit_Constant( jitAssembler_t * a, uint32 x, uint32 y, uint32 z, uint32 w ) {
+	const uint32 value[ 4 ] = { x, y, z, w };
+	uint32 index = 0;
+	while ( index < a->constantCount && memcmp( a->constants[ index ], value, sizeof( value ) ) != 0 ) {
+		index++;
+	}
+	if ( index == a->constantCount ) {
+		if ( index == JIT_MAX_CONSTANTS ) {
+			a->failed = true;
+			index = 0;
+		} else {
+			memcpy( a->constants[ a->constantCount++ ], value, sizeof( value ) );
+		}
+	}
+	jitOperand_t operand = { JIT_OPERAND_CONSTANT, index, 0 };
+	return operand;
+}
+
+static uint32 Jit_FloatBits( float value ) {
+	uint32 bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	return bits;
+}
+
+static jitOperand_t Jit_Broadcast( jitAssembler_t * a, uint32 value ) {
+	return Jit_Constant( a, value, value, value, value );
+}
+
+static jitOperand_t Jit_BroadcastFloat( jitAssembler_t * a, float value ) {
+	return Jit_Broadcast( a, Jit_FloatBits( value ) );
+}
+
+/*
+Encodes prefix, REX, opcode, ModRM, SIB and displacement, then an immediateBytes immediate.  opcode
+holds opcodeBytes bytes, most significant first.
+*/
+static void Jit_Encode( jitAssembler_t * a, uint32 prefix, uint32 opcode, uint32 opcodeBytes, bool wide, uint32 reg, const jitOperand_t & rm, uint32 immediateBytes, uint32 immediate ) {
+	if ( prefix != 0 ) {
+		Jit_Byte( a, prefix );
+	}
+	const uint32 rmExtension = ( rm.kind == JIT_OPERAND_CONSTANT ) ? 0 : ( ( rm.reg >> 3 ) & 1 );
+	const uint32 rex = 0x40 | ( wide ? 8 : 0 ) | ( ( ( reg >> 3 ) & 1 ) << 2 ) | rmExtension;
+	if ( rex != 0x40 ) {
+		Jit_Byte( a, rex );
+	}
+	for ( uint32 i = opcodeBytes; i-- > 0; ) {
+		Jit_Byte( a, opcode >> ( i * 8 ) );
+	}
+	const uint32 regField = ( reg & 7 ) << 3;
+	switch ( rm.kind ) {
+		case JIT_OPERAND_REGISTER:
+			Jit_Byte( a, 0xC0 | regField | ( rm.reg & 7 ) );
+			break;
+		case JIT_OPERAND_CONSTANT:
+			Jit_Byte( a, 0x05 | regField );
+			Jit_Fixup( a, rm.reg, true, immediateBytes );
+			break;
+		default: {
+			//rbp and r13 have no displacement-free form, rsp and r12 always need a SIB byte
+			const uint32 base = rm.reg & 7;
+			const int32 displacement = rm.displacement;
+			const uint32 mod = ( displacement == 0 && base != 5 ) ? 0 : ( ( displacement >= -128 && displacement <= 127 ) ? 1 : 2 );
+			Jit_Byte( a, ( mod << 6 ) | regField | base );
+			if ( base == 4 ) {
+				Jit_Byte( a, 0x24 );
+			}
+			if ( mod == 1 ) {
+				Jit_Byte( a, ( uint32 )displacement );
+			} else if ( mod == 2 ) {
+				Jit_Dword( a, ( uint32 )displacement );
+			}
+			break;
+		}
+	}
+	for ( uint32 i = 0; i < immediateBytes; i++ ) {
+		Jit_Byte( a, immediate >> ( i * 8 ) );
+	}
+}
+
+static void Jit_SseImmediate( jitAssembler_t * a, jitSseOp_t op, uint32 reg, const jitOperand_t & rm, uint32 immediate ) {
+	const uint32 opcode = op & 0xFFFFFF;
+	const uint32 escape = opcode >> 8;
+	const uint32 opcodeBytes = ( escape == 0x0F38 || escape == 0x0F3A ) ? 3 : 2;
+	Jit_Encode( a, op >> 24, opcode, opcodeBytes, false, reg, rm, 1, immediate );
+}
+
+static void Jit_Sse( jitAssembler_t * a, jitSseOp_t op, uint32 reg, const jitOperand_t & rm ) {
+	const uint32 opcode = op & 0xFFFFFF;
+	const uint32 escape = opcode >> 8;
+	const uint32 opcodeBytes = ( escape == 0x0F38 || escape == 0x0F3A ) ? 3 : 2;
+	Jit_Encode( a, op >> 24, opcode, opcodeBytes, false, reg, rm, 0, 0 );
+}
+
+static void Jit_SseRegister( jitAssembler_t * a, jitSseOp_t op, uint32 dst, uint32 src ) {
+	Jit_Sse( a, op, dst, Jit_Register( src ) );
+}
+
+//General-purpose instructions with a ModRM operand
+static void Jit_Gpr( jitAssembler_t * a, uint32 opcode, uint32 opcodeBytes, bool wide, uint32 reg, const jitOperand_t & rm ) {
+	Jit_Encode( a, 0, opcode, opcodeBytes, wide, reg, rm, 0, 0 );
+}
+
+static void Jit_Load32( jitAssembler_t * a, uint32 dst, const jitOperand_t & src ) {
+	Jit_Gpr( a, 0x8B, 1, false, dst, src );
+}
+
+static void Jit_Load64( jitAssembler_t * a, uint32 dst, const jitOperand_t & src ) {
+	Jit_Gpr( a, 0x8B, 1, true, dst, src );
+}
+
+static void Jit_Store32( jitAssembler_t * a, const jitOperand_t & dst, uint32 src ) {
+	Jit_Gpr( a, 0x89, 1, false, src, dst );
+}
+
+static void Jit_Move64( jitAssembler_t * a, uint32 dst, uint32 src ) {
+	Jit_Gpr( a, 0x8B, 1, true, dst, Jit_Register( src ) );
+}
+
+static void Jit_StoreImmediate32( jitAssembler_t * a, const jitOperand_t & dst, uint32 value ) {
+	Jit_Encode( a, 0, 0xC7, 1, false, 0, dst, 4, value );
+}
+
+static void Jit_MoveImmediate32( jitAssembler_t * a, uint32 dst, uint32 value ) {
+	if ( dst >= 8 ) {
+		Jit_Byte( a, 0x41 );
+	}
+	Jit_Byte( a, 0xB8 + ( dst & 7 ) );
+	Jit_Dword( a, value );
+}
+
+static void Jit_MoveImmediate64( jitAssembler_t * a, uint32 dst, uint64 value ) {
+	Jit_Byte( a, 0x48 | ( ( dst >> 3 ) & 1 ) );
+	Jit_Byte( a, 0xB8 + ( dst & 7 ) );
+	Jit_Dword( a, ( uint32 )value );
+	Jit_Dword( a, ( uint32 )( value >> 32 ) );
+}
+
+//cmp r/m32, imm32
+static void Jit_Compare32( jitAssembler_t * a, const jitOperand_t & lhs, uint32 value ) {
+	Jit_Encode( a, 0, 0x81, 1, false, 7, lhs, 4, value );
+}
+
+static void Jit_Push( jitAssembler_t * a, uint32 reg ) {
+	if ( reg >= 8 ) {
+		Jit_Byte( a, 0x41 );
+	}
+	Jit_Byte( a, 0x50 + ( reg & 7 ) );
+}
+
+static void Jit_Pop( jitAssembler_t * a, uint32 reg ) {
+	if ( reg >= 8 ) {
+		Jit_Byte( a, 0x41 );
+	}
+	Jit_Byte( a, 0x58 + ( reg & 7 ) );
+}
+
+static void Jit_Jump( jitAssembler_t * a, uint32 condition, uint32 label ) {
+	if ( condition == JIT_ALWAYS ) {
+		Jit_Byte( a, 0xE9 );
+	} else {
+		Jit_Byte( a, 0x0F );
+		Jit_Byte( a, 0x80 + condition );
+	}
+	Jit_Fixup( a, label, false, 0 );
+}
+
+static void Jit_Call( jitAssembler_t * a, const void * pFunction ) {
+	Jit_MoveImmediate64( a, JIT_RAX, ( uint64 )( size_t )pFunction );
+	Jit_Gpr( a, 0xFF, 1, false, 2, Jit_Register( JIT_RAX ) );
+}
+
+static void Jit_AlignCode( jitAssembler_t * a ) {
+	while ( ( a->size & 15 ) != 0 ) {
+		Jit_Byte( a, 0xCC );
+	}
+}
+
+/*
+Places the constant pool after the code, patches every fixup and moves the result into an executable
+mapping.  Returns false when anything failed along the way.
+*/
+static bool Jit_Finish( jitAssembler_t * a, platformMapping_t * pMapping ) {
+	Jit_AlignCode( a );
+	if ( a->failed ) {
+		return false;
+	}
+	const uint32 poolOffset = a->size;
+	const uint32 totalSize = poolOffset + a->constantCount * 16;
+	for ( uint32 i = 0; i < a->fixupCount; i++ ) {
+		const jitFixup_t & fixup = a->pFixups[ i ];
+		const uint32 target = fixup.constant ? poolOffset + fixup.target * 16 : a->pLabels[ fixup.target ];
+		if ( target == JIT_UNBOUND ) {
+			return false;
+		}
+		const uint32 displacement = target - fixup.end;
+		memcpy( a->pCode + fixup.position, &displacement, sizeof( displacement ) );
+	}
+	if ( !Platform_MapMemory( totalSize, false, pMapping ) ) {
+		return false;
+	}
+	memcpy( pMapping->base, a->pCode, poolOffset );
+	memcpy( reinterpret_cast< uint8 * >( pMapping->base ) + poolOffset, a->constants, a->constantCount * 16 );
+	if ( !Platform_ProtectExecutable( pMapping->base, pMapping->size ) ) {
+		Platform_UnmapMemory( pMapping );
+		return false;
+	}
+	return true;
+}
+
+/*
+================================================
+Shader bodies
+
+rbx holds the register file and r12 the pipelineFrame_t.  Inline sequences work on one 4-lane group
+of a register at a time in xmm0 to xmm5, which both calling conventions leave volatile, so nothing
+lives in vector registers across instructions and call-outs need no spilling.
+================================================
+*/
+#define JIT_FRAME_REGISTER JIT_R12
+#define JIT_REGISTER_FILE JIT_RBX
+#define JIT_GROUPS ( SHADER_LANES / 4 )
+
+static jitOperand_t Jit_Frame( size_t offset ) {
+	return Jit_Memory( JIT_FRAME_REGISTER, ( int32 )offset );
+}
+
+static jitOperand_t Jit_Lane( uint32 reg, uint32 group ) {
+	return Jit_Memory( JIT_REGISTER_FILE, ( int32 )( reg * sizeof( shaderRegister_t ) + group * 16 ) );
+}
+
+static jitOperand_t Jit_ExecutionLanes( uint32 group ) {
+	return Jit_Frame( offsetof( pipelineFrame_t, execution ) + offsetof( shaderExecution_t, lanes ) + group * 16 );
+}
+
+static void Jit_Prologue( jitAssembler_t * a ) {
+	//Five pushes leave the stack 16-byte aligned for calls, plus the 32 bytes of Win64 shadow space
+	Jit_Push( a, JIT_RBX );
+	Jit_Push( a, JIT_RBP );
+	Jit_Push( a, JIT_RSI );
+	Jit_Push( a, JIT_RDI );
+	Jit_Push( a, JIT_R12 );
+	Jit_Encode( a, 0, 0x83, 1, true, 5, Jit_Register( JIT_RSP ), 1, 32 );
+	Jit_Move64( a, JIT_FRAME_REGISTER, jitArguments[ 0 ] );
+	Jit_Load64( a, JIT_REGISTER_FILE, Jit_Frame( offsetof( pipelineFrame_t, pRegisters ) ) );
+}
+
+static void Jit_Epilogue( jitAssembler_t * a ) {
+	Jit_Encode( a, 0, 0x83, 1, true, 0, Jit_Register( JIT_RSP ), 1, 32 );
+	Jit_Pop( a, JIT_R12 );
+	Jit_Pop( a, JIT_RDI );
+	Jit_Pop( a, JIT_RSI );
+	Jit_Pop( a, JIT_RBP );
+	Jit_Pop( a, JIT_RBX );
+	Jit_Byte( a, 0xC3 );
+}
+
+//Stores xmm to one group of the destination, keeping the lanes outside the execution mask on masked writes
+static void Jit_WriteGroup( jitAssembler_t * a, const shaderInstruction_t & inst, uint32 group, uint32 xmm, uint32 scratch ) {
+	if ( ( inst.flags & SHADER_MASKED ) != 0 ) {
+		Jit_Sse( a, JIT_MOVAPS_LOAD, scratch, Jit_ExecutionLanes( group ) );
+		Jit_SseRegister( a, JIT_ANDPS, xmm, scratch );
+		Jit_Sse( a, JIT_ANDNPS, scratch, Jit_Lane( inst.dst, group ) );
+		Jit_SseRegister( a, JIT_ORPS, xmm, scratch );
+	}
+	Jit_Sse( a, JIT_MOVAPS_STORE, xmm, Jit_Lane( inst.dst, group ) );
+}
+
+//xmm0 = lhs op rhs
+static void Jit_Binary( jitAssembler_t * a, jitSseOp_t op, const jitOperand_t & lhs, const jitOperand_t & rhs ) {
+	Jit_Sse( a, JIT_MOVAPS_LOAD, 0, lhs );
+	Jit_Sse( a, op, 0, rhs );
+}
+
+static void Jit_Compare( jitAssembler_t * a, uint32 predicate, const jitOperand_t & lhs, const jitOperand_t & rhs ) {
+	Jit_Sse( a, JIT_MOVAPS_LOAD, 0, lhs );
+	Jit_SseImmediate( a, JIT_CMPPS, 0, rhs, predicate );
+}
+
+//xmm0 = pcmpgtd( lhs, rhs ) on unsigned values
+static void Jit_CompareUnsigned( jitAssembler_t * a, const jitOperand_t & lhs, const jitOperand_t & rhs ) {
+	const jitOperand_t sign = Jit_Broadcast( a, 0x80000000u );
+	Jit_Sse( a, JIT_MOVAPS_LOAD, 0, lhs );
+	Jit_Sse( a, JIT_PXOR, 0, sign );
+	Jit_Sse( a, JIT_MOVAPS_LOAD, 1, rhs );
+	Jit_Sse( a, JIT_PXOR, 1, sign );
+	Jit_SseRegister( a, JIT_PCMPGTD, 0, 1 );
+}
+
+static void Jit_Invert( jitAssembler_t * a, uint32 xmm ) {
+	Jit_Sse( a, JIT_PXOR, xmm, Jit_Broadcast( a, ~0u ) );
+}
+
+//Ops with an inline sequence, matching the interpreter lane for lane
+static bool Jit_IsInline( const shaderProgram_t * program, const shaderInstruction_t & inst ) {
+	switch ( inst.op ) {
+		case shaderOp_t::MOV:
+		case shaderOp_t::FADD:
+		case shaderOp_t::FSUB:
+		case shaderOp_t::FMUL:
+		case shaderOp_t::FDIV:
+		case shaderOp_t::FNEG:
+		case shaderOp_t::FABS:
+		case shaderOp_t::FMIN:
+		case shaderOp_t::FMAX:
+		case shaderOp_t::FFLOOR:
+		case shaderOp_t::FCEIL:
+		case shaderOp_t::FTRUNC:
+		case shaderOp_t::FROUND_EVEN:
+		case shaderOp_t::FSQRT:
+		case shaderOp_t::FRSQRT:
+		case shaderOp_t::IADD:
+		case shaderOp_t::ISUB:
+		case shaderOp_t::IMUL:
+		case shaderOp_t::INEG:
+		case shaderOp_t::IABS:
+		case shaderOp_t::UMIN:
+		case shaderOp_t::UMAX:
+		case shaderOp_t::SMIN:
+		case shaderOp_t::SMAX:
+		case shaderOp_t::AND:
+		case shaderOp_t::OR:
+		case shaderOp_t::XOR:
+		case shaderOp_t::NOT:
+		case shaderOp_t::S2F:
+		case shaderOp_t::FORD_EQ:
+		case shaderOp_t::FORD_NE:
+		case shaderOp_t::FORD_LT:
+		case shaderOp_t::FORD_LE:
+		case shaderOp_t::FUNORD_EQ:
+		case shaderOp_t::FUNORD_NE:
+		case shaderOp_t::FUNORD_LT:
+		case shaderOp_t::FUNORD_LE:
+		case shaderOp_t::IEQ:
+		case shaderOp_t::INE:
+		case shaderOp_t::ULT:
+		case shaderOp_t::ULE:
+		case shaderOp_t::SLT:
+		case shaderOp_t::SLE:
+		case shaderOp_t::ISNAN:
+		case shaderOp_t::ISINF:
+		case shaderOp_t::SELECT:
+		case shaderOp_t::DPDX_FINE:
+		case shaderOp_t::DPDY_FINE:
+		case shaderOp_t::DPDX_COARSE:
+		case shaderOp_t::DPDY_COARSE:
+		case shaderOp_t::SUBGROUP_BUILTIN:
+		case shaderOp_t::SUBGROUP_ELECT:
+		case shaderOp_t::SUBGROUP_ALL:
+		case shaderOp_t::SUBGROUP_ANY:
+		case shaderOp_t::SUBGROUP_ALL_EQUAL:
+		case shaderOp_t::SUBGROUP_BALLOT:
+		case shaderOp_t::SUBGROUP_INVERSE_BALLOT:
+		case shaderOp_t::SUBGROUP_BROADCAST_FIRST:
+		case shaderOp_t::SUBGROUP_REDUCE:
+		case shaderOp_t::SUBGROUP_INCLUSIVE_SCAN:
+		case shaderOp_t::SUBGROUP_EXCLUSIVE_SCAN:
+			return true;
+		//Only shifts by a constant have an immediate form, and only shuffles by one a fixed permutation
+		case shaderOp_t::SUBGROUP_SHUFFLE:
+		case shaderOp_t::SUBGROUP_SHUFFLE_XOR:
+		case shaderOp_t::SUBGROUP_SHUFFLE_UP:
+		case shaderOp_t::SUBGROUP_SHUFFLE_DOWN:
+		case shaderOp_t::SHL:
+		case shaderOp_t::SHR:
+		case shaderOp_t::SAR:
+			return inst.src[ 1 ] < program->constantCount;
+		default:
+			return false;
+	}
+}
+
+//Leaves one group of a lane-wise op's result in xmm0
+static void Jit_EmitGroup( jitAssembler_t * a, const shaderProgram_t * program, const shaderInstruction_t & inst, uint32 group ) {
+	const jitOperand_t x = Jit_Lane( inst.src[ 0 ], group );
+	const jitOperand_t y = Jit_Lane( inst.src[ 1 ], group );
+	switch ( inst.op ) {
+		case shaderOp_t::MOV:			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, x ); break;
+		case shaderOp_t::FADD:			Jit_Binary( a, JIT_ADDPS, x, y ); break;
+		case shaderOp_t::FSUB:			Jit_Binary( a, JIT_SUBPS, x, y ); break;
+		case shaderOp_t::FMUL:			Jit_Binary( a, JIT_MULPS, x, y ); break;
+		case shaderOp_t::FDIV:			Jit_Binary( a, JIT_DIVPS, x, y ); break;
+		case shaderOp_t::FNEG:			Jit_Binary( a, JIT_XORPS, x, Jit_Broadcast( a, 0x80000000u ) ); break;
+		case shaderOp_t::FABS:			Jit_Binary( a, JIT_ANDPS, x, Jit_Broadcast( a, 0x7FFFFFFFu ) ); break;
+		//minps and maxps return their second operand on ties and NaNs, as the interpreter's comparisons do
+		case shaderOp_t::FMIN:			Jit_Binary( a, JIT_MINPS, y, x ); break;
+		case shaderOp_t::FMAX:			Jit_Binary( a, JIT_MAXPS, y, x ); break;
+		case shaderOp_t::FFLOOR:		Jit_SseImmediate( a, JIT_ROUNDPS, 0, x, 9 ); break;
+		case shaderOp_t::FCEIL:			Jit_SseImmediate( a, JIT_ROUNDPS, 0, x, 10 ); break;
+		case shaderOp_t::FTRUNC:		Jit_SseImmediate( a, JIT_ROUNDPS, 0, x, 11 ); break;
+		case shaderOp_t::FROUND_EVEN:	Jit_SseImmediate( a, JIT_ROUNDPS, 0, x, 8 ); break;
+		case shaderOp_t::FSQRT:			Jit_Sse( a, JIT_SQRTPS, 0, x ); break;
+		case shaderOp_t::FRSQRT:
+			Jit_Sse( a, JIT_SQRTPS, 1, x );
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_BroadcastFloat( a, 1.0f ) );
+			Jit_SseRegister( a, JIT_DIVPS, 0, 1 );
+			break;
+
+		case shaderOp_t::IADD:			Jit_Binary( a, JIT_PADDD, x, y ); break;
+		case shaderOp_t::ISUB:			Jit_Binary( a, JIT_PSUBD, x, y ); break;
+		case shaderOp_t::IMUL:			Jit_Binary( a, JIT_PMULLD, x, y ); break;
+		case shaderOp_t::INEG:
+			Jit_SseRegister( a, JIT_PXOR, 0, 0 );
+			Jit_Sse( a, JIT_PSUBD, 0, x );
+			break;
+		case shaderOp_t::IABS:			Jit_Sse( a, JIT_PABSD, 0, x ); break;
+		case shaderOp_t::UMIN:			Jit_Binary( a, JIT_PMINUD, x, y ); break;
+		case shaderOp_t::UMAX:			Jit_Binary( a, JIT_PMAXUD, x, y ); break;
+		case shaderOp_t::SMIN:			Jit_Binary( a, JIT_PMINSD, x, y ); break;
+		case shaderOp_t::SMAX:			Jit_Binary( a, JIT_PMAXSD, x, y ); break;
+		case shaderOp_t::AND:			Jit_Binary( a, JIT_PAND, x, y ); break;
+		case shaderOp_t::OR:			Jit_Binary( a, JIT_POR, x, y ); break;
+		case shaderOp_t::XOR:			Jit_Binary( a, JIT_PXOR, x, y ); break;
+		case shaderOp_t::NOT:
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, x );
+			Jit_Invert( a, 0 );
+			break;
+		case shaderOp_t::SHL:
+		case shaderOp_t::SHR:
+		case shaderOp_t::SAR: {
+			const uint32 shift = program->pConstants[ inst.src[ 1 ] ] & 31;
+			const uint32 kind = ( inst.op == shaderOp_t::SHL ) ? JIT_SHIFT_LEFT : ( ( inst.op == shaderOp_t::SHR ) ? JIT_SHIFT_RIGHT_LOGICAL : JIT_SHIFT_RIGHT_ARITHMETIC );
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, x );
+			Jit_SseImmediate( a, JIT_PSHIFTD, kind, Jit_Register( 0 ), shift );
+			break;
+		}
+		case shaderOp_t::S2F:			Jit_Sse( a, JIT_CVTDQ2PS, 0, x ); break;
+
+		case shaderOp_t::FORD_EQ:		Jit_Compare( a, JIT_CMP_EQ, x, y ); break;
+		case shaderOp_t::FORD_LT:		Jit_Compare( a, JIT_CMP_LT, x, y ); break;
+		case shaderOp_t::FORD_LE:		Jit_Compare( a, JIT_CMP_LE, x, y ); break;
+		case shaderOp_t::FUNORD_NE:		Jit_Compare( a, JIT_CMP_NEQ, x, y ); break;
+		case shaderOp_t::FUNORD_LT:		Jit_Compare( a, JIT_CMP_NLE, y, x ); break;
+		case shaderOp_t::FUNORD_LE:		Jit_Compare( a, JIT_CMP_NLT, y, x ); break;
+		case shaderOp_t::FORD_NE:
+		case shaderOp_t::FUNORD_EQ: {
+			const bool ordered = ( inst.op == shaderOp_t::FORD_NE );
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, x );
+			Jit_SseRegister( a, JIT_MOVAPS_LOAD, 1, 0 );
+			Jit_SseImmediate( a, JIT_CMPPS, 0, y, ordered ? JIT_CMP_NEQ : JIT_CMP_EQ );
+			Jit_SseImmediate( a, JIT_CMPPS, 1, y, ordered ? JIT_CMP_ORD : JIT_CMP_UNORD );
+			Jit_SseRegister( a, ordered ? JIT_ANDPS : JIT_ORPS, 0, 1 );
+			break;
+		}
+		case shaderOp_t::IEQ:			Jit_Binary( a, JIT_PCMPEQD, x, y ); break;
+		case shaderOp_t::INE:
+			Jit_Binary( a, JIT_PCMPEQD, x, y );
+			Jit_Invert( a, 0 );
+			break;
+		case shaderOp_t::SLT:			Jit_Binary( a, JIT_PCMPGTD, y, x ); break;
+		case shaderOp_t::SLE:
+			Jit_Binary( a, JIT_PCMPGTD, x, y );
+			Jit_Invert( a, 0 );
+			break;
+		case shaderOp_t::ULT:			Jit_CompareUnsigned( a, y, x ); break;
+		case shaderOp_t::ULE:
+			Jit_CompareUnsigned( a, x, y );
+			Jit_Invert( a, 0 );
+			break;
+		case shaderOp_t::ISNAN:
+		case shaderOp_t::ISINF:
+			Jit_Binary( a, JIT_PAND, x, Jit_Broadcast( a, 0x7FFFFFFFu ) );
+			Jit_Sse( a, ( inst.op == shaderOp_t::ISNAN ) ? JIT_PCMPGTD : JIT_PCMPEQD, 0, Jit_Broadcast( a, 0x7F800000u ) );
+			break;
+		case shaderOp_t::SELECT:
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 1, x );
+			Jit_SseRegister( a, JIT_PXOR, 2, 2 );
+			Jit_SseRegister( a, JIT_PCMPEQD, 1, 2 );
+			Jit_SseRegister( a, JIT_MOVAPS_LOAD, 0, 1 );
+			Jit_Sse( a, JIT_PAND, 0, Jit_Lane( inst.src[ 2 ], group ) );
+			Jit_Sse( a, JIT_PANDN, 1, y );
+			Jit_SseRegister( a, JIT_POR, 0, 1 );
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+Derivatives read other groups of the source, so all four results are formed in xmm0 to xmm3 before any
+is stored.  Groups are rows of the 4x4 block: x differences shuffle within a group, y differences
+subtract the even row of a quad from the odd one.
+*/
+static void Jit_EmitDerivative( jitAssembler_t * a, const shaderInstruction_t & inst ) {
+	const uint32 src = inst.src[ 0 ];
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		switch ( inst.op ) {
+			case shaderOp_t::DPDX_FINE:
+			case shaderOp_t::DPDX_COARSE: {
+				const uint32 row = ( inst.op == shaderOp_t::DPDX_FINE ) ? group : ( group & ~1u );
+				Jit_SseImmediate( a, JIT_PSHUFD, group, Jit_Lane( src, row ), 0xF5 );
+				Jit_SseImmediate( a, JIT_PSHUFD, 4, Jit_Lane( src, row ), 0xA0 );
+				Jit_SseRegister( a, JIT_SUBPS, group, 4 );
+				break;
+			}
+			case shaderOp_t::DPDY_FINE:
+				Jit_Sse( a, JIT_MOVAPS_LOAD, group, Jit_Lane( src, group | 1 ) );
+				Jit_Sse( a, JIT_SUBPS, group, Jit_Lane( src, group & ~1u ) );
+				break;
+			default:
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 4, Jit_Lane( src, group | 1 ) );
+				Jit_Sse( a, JIT_SUBPS, 4, Jit_Lane( src, group & ~1u ) );
+				Jit_SseImmediate( a, JIT_PSHUFD, group, Jit_Register( 4 ), 0xA0 );
+				break;
+		}
+	}
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		Jit_WriteGroup( a, inst, group, group, 4 );
+	}
+}
+
+//xmm = all ones in the lanes of group whose bit is set in gpr, with scratch clobbered
+static void Jit_EmitExpandMask( jitAssembler_t * a, uint32 xmm, uint32 scratch, uint32 gpr, uint32 group ) {
+	const uint32 shift = group * 4;
+	Jit_Sse( a, JIT_MOVD_LOAD, xmm, Jit_Register( gpr ) );
+	Jit_SseImmediate( a, JIT_PSHUFD, xmm, Jit_Register( xmm ), 0x00 );
+	Jit_Sse( a, JIT_MOVAPS_LOAD, scratch, Jit_Constant( a, 1u << shift, 2u << shift, 4u << shift, 8u << shift ) );
+	Jit_SseRegister( a, JIT_PAND, xmm, scratch );
+	Jit_SseRegister( a, JIT_PCMPEQD, xmm, scratch );
+}
+
+/*
+Subgroups are aligned runs of subgroupSize lanes, so a subgroup of 4 is one group and wider ones take
+two or four.  Reductions and scans keep every group of the source in xmm0 to xmm3 and combine them in
+the interpreter's order, op( lane, other ): shuffles and byte shifts move lanes within a group, whole
+registers move between groups.  Votes and ballots gather the lanes into a mask in edx and work on its
+subgroupSize-bit fields.  Shuffles by a constant become a fixed lane permutation; only shuffles by a
+value that differs per lane go through the interpreter.
+*/
+static uint32 Jit_SubgroupMask( uint32 subgroupSize, uint32 subgroup ) {
+	return ( uint32 )( ( 1ull << subgroupSize ) - 1 ) << ( subgroup * subgroupSize );
+}
+
+//edx = the active lanes where src is not zero
+static void Jit_EmitActiveBits( jitAssembler_t * a, uint32 src ) {
+	Jit_Gpr( a, 0x33, 1, false, JIT_RDX, Jit_Register( JIT_RDX ) );
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Lane( src, group ) );
+		Jit_SseRegister( a, JIT_PXOR, 1, 1 );
+		Jit_SseRegister( a, JIT_PCMPEQD, 0, 1 );
+		Jit_Sse( a, JIT_PANDN, 0, Jit_ExecutionLanes( group ) );
+		Jit_Gpr( a, 0x0F50, 2, false, JIT_RAX, Jit_Register( 0 ) );
+		if ( group != 0 ) {
+			Jit_Encode( a, 0, 0xC1, 1, false, 4, Jit_Register( JIT_RAX ), 1, group * 4 );
+		}
+		Jit_Gpr( a, 0x0B, 1, false, JIT_RDX, Jit_Register( JIT_RAX ) );
+	}
+}
+
+static void Jit_LoadExecutionMask( jitAssembler_t * a, uint32 gpr ) {
+	Jit_Load32( a, gpr, Jit_Frame( offsetof( pipelineFrame_t, execution ) + offsetof( shaderExecution_t, exec ) ) );
+}
+
+//Writes true to every lane of each subgroup where edx has a bit set, or has none for all
+static void Jit_EmitVote( jitAssembler_t * a, const shaderInstruction_t & inst, uint32 subgroupSize, bool all ) {
+	Jit_Gpr( a, 0x33, 1, false, JIT_RCX, Jit_Register( JIT_RCX ) );
+	for ( uint32 subgroup = 0; subgroup < SHADER_LANES / subgroupSize; subgroup++ ) {
+		const uint32 mask = Jit_SubgroupMask( subgroupSize, subgroup );
+		//eax = mask when the field has any bit set, by way of neg setting the carry for non-zero values
+		Jit_Gpr( a, 0x8B, 1, false, JIT_RAX, Jit_Register( JIT_RDX ) );
+		Jit_Encode( a, 0, 0x81, 1, false, 4, Jit_Register( JIT_RAX ), 4, mask );
+		Jit_Encode( a, 0, 0xF7, 1, false, 3, Jit_Register( JIT_RAX ), 0, 0 );
+		Jit_Gpr( a, 0x1B, 1, false, JIT_RAX, Jit_Register( JIT_RAX ) );
+		if ( all ) {
+			Jit_Encode( a, 0, 0xF7, 1, false, 2, Jit_Register( JIT_RAX ), 0, 0 );
+		}
+		Jit_Encode( a, 0, 0x81, 1, false, 4, Jit_Register( JIT_RAX ), 4, mask );
+		Jit_Gpr( a, 0x0B, 1, false, JIT_RCX, Jit_Register( JIT_RAX ) );
+	}
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		Jit_EmitExpandMask( a, 0, 1, JIT_RCX, group );
+		Jit_WriteGroup( a, inst, group, 0, 1 );
+	}
+}
+
+//xmm = src of the lowest active lane of the subgroup, or of its first lane when none is active, in every lane
+static void Jit_EmitBroadcastFirst( jitAssembler_t * a, uint32 xmm, uint32 src, uint32 subgroupSize, uint32 subgroup ) {
+	const uint32 first = subgroup * subgroupSize;
+	//bsf finds the bit above the field when it is empty, which the final and turns into lane 0
+	Jit_LoadExecutionMask( a, JIT_RAX );
+	if ( first != 0 ) {
+		Jit_Encode( a, 0, 0xC1, 1, false, 5, Jit_Register( JIT_RAX ), 1, first );
+	}
+	Jit_Encode( a, 0, 0x81, 1, false, 4, Jit_Register( JIT_RAX ), 4, Jit_SubgroupMask( subgroupSize, 0 ) );
+	Jit_Encode( a, 0, 0x81, 1, false, 1, Jit_Register( JIT_RAX ), 4, 1u << subgroupSize );
+	Jit_Gpr( a, 0x0FBC, 2, false, JIT_RAX, Jit_Register( JIT_RAX ) );
+	Jit_Encode( a, 0, 0x81, 1, false, 4, Jit_Register( JIT_RAX ), 4, subgroupSize - 1 );
+	Jit_Encode( a, 0, 0xC1, 1, false, 4, Jit_Register( JIT_RAX ), 1, 2 );
+	Jit_Gpr( a, 0x03, 1, true, JIT_RAX, Jit_Register( JIT_REGISTER_FILE ) );
+	Jit_Sse( a, JIT_MOVD_LOAD, xmm, Jit_Memory( JIT_RAX, ( int32 )( src * sizeof( shaderRegister_t ) + first * sizeof( uint32 ) ) ) );
+	Jit_SseImmediate( a, JIT_PSHUFD, xmm, Jit_Register( xmm ), 0x00 );
+}
+
+//dst = op( dst, other ), clobbering other
+static void Jit_EmitCombine( jitAssembler_t * a, shaderOp_t op, uint32 dst, uint32 other ) {
+	switch ( op ) {
+		case shaderOp_t::IADD:	Jit_SseRegister( a, JIT_PADDD, dst, other ); break;
+		case shaderOp_t::IMUL:	Jit_SseRegister( a, JIT_PMULLD, dst, other ); break;
+		case shaderOp_t::FADD:	Jit_SseRegister( a, JIT_ADDPS, dst, other ); break;
+		case shaderOp_t::FMUL:	Jit_SseRegister( a, JIT_MULPS, dst, other ); break;
+		case shaderOp_t::UMIN:	Jit_SseRegister( a, JIT_PMINUD, dst, other ); break;
+		case shaderOp_t::UMAX:	Jit_SseRegister( a, JIT_PMAXUD, dst, other ); break;
+		case shaderOp_t::SMIN:	Jit_SseRegister( a, JIT_PMINSD, dst, other ); break;
+		case shaderOp_t::SMAX:	Jit_SseRegister( a, JIT_PMAXSD, dst, other ); break;
+		case shaderOp_t::AND:	Jit_SseRegister( a, JIT_PAND, dst, other ); break;
+		case shaderOp_t::OR:	Jit_SseRegister( a, JIT_POR, dst, other ); break;
+		case shaderOp_t::XOR:	Jit_SseRegister( a, JIT_PXOR, dst, other ); break;
+		//As FMIN and FMAX, with the other lane as the first operand
+		case shaderOp_t::FMIN:
+		case shaderOp_t::FMAX:
+			Jit_SseRegister( a, ( op == shaderOp_t::FMIN ) ? JIT_MINPS : JIT_MAXPS, other, dst );
+			Jit_SseRegister( a, JIT_MOVAPS_LOAD, dst, other );
+			break;
+		default:
+			a->failed = true;
+			break;
+	}
+}
+
+static void Jit_EmitArithmetic( jitAssembler_t * a, const shaderInstruction_t & inst, uint32 subgroupSize ) {
+	const shaderOp_t op = ( shaderOp_t )inst.src[ 1 ];
+	const uint32 identity = ShaderSubgroup_Identity( op );
+	const uint32 groupsPerSubgroup = subgroupSize / 4;
+	//Inactive lanes take part as the identity
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		Jit_Sse( a, JIT_MOVAPS_LOAD, group, Jit_Lane( inst.src[ 0 ], group ) );
+		Jit_Sse( a, JIT_MOVAPS_LOAD, 4, Jit_ExecutionLanes( group ) );
+		Jit_SseRegister( a, JIT_PAND, group, 4 );
+		Jit_Sse( a, JIT_PANDN, 4, Jit_Broadcast( a, identity ) );
+		Jit_SseRegister( a, JIT_POR, group, 4 );
+	}
+	if ( inst.op == shaderOp_t::SUBGROUP_REDUCE ) {
+		const uint32 width = ( inst.src[ 2 ] != 0 && inst.src[ 2 ] < subgroupSize ) ? inst.src[ 2 ] : subgroupSize;
+		for ( uint32 step = 1; step < width; step <<= 1 ) {
+			if ( step < 4 ) {
+				for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+					Jit_SseImmediate( a, JIT_PSHUFD, 4, Jit_Register( group ), ( step == 1 ) ? 0xB1 : 0x4E );
+					Jit_EmitCombine( a, op, group, 4 );
+				}
+				continue;
+			}
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				const uint32 partner = group ^ ( step / 4 );
+				if ( partner > group ) {
+					Jit_SseRegister( a, JIT_MOVAPS_LOAD, 4, group );
+					Jit_SseRegister( a, JIT_MOVAPS_LOAD, 5, partner );
+					Jit_EmitCombine( a, op, group, 5 );
+					Jit_EmitCombine( a, op, partner, 4 );
+				}
+			}
+		}
+	} else {
+		//Scans shift lanes up the subgroup, so each group is updated before the one below it is read
+		const uint32 firstStep = ( inst.op == shaderOp_t::SUBGROUP_EXCLUSIVE_SCAN ) ? 0 : 1;
+		for ( uint32 step = firstStep; step < subgroupSize; step = ( step == 0 ) ? 1 : step << 1 ) {
+			const uint32 shift = ( step == 0 ) ? 1 : step;
+			for ( uint32 group = JIT_GROUPS; group-- > 0; ) {
+				const uint32 index = group % groupsPerSubgroup;
+				if ( shift < 4 ) {
+					Jit_SseRegister( a, JIT_MOVAPS_LOAD, 4, group );
+					Jit_SseImmediate( a, JIT_PSHIFTDQ, JIT_SHIFT_LEFT_BYTES, Jit_Register( 4 ), shift * 4 );
+					if ( index != 0 ) {
+						Jit_SseRegister( a, JIT_MOVAPS_LOAD, 5, group - 1 );
+						Jit_SseImmediate( a, JIT_PSHIFTDQ, JIT_SHIFT_RIGHT_BYTES, Jit_Register( 5 ), 16 - shift * 4 );
+						Jit_SseRegister( a, JIT_POR, 4, 5 );
+					} else {
+						Jit_Sse( a, JIT_POR, 4, Jit_Constant( a, identity, ( shift > 1 ) ? identity : 0, ( shift > 2 ) ? identity : 0, 0 ) );
+					}
+				} else if ( index >= shift / 4 ) {
+					Jit_SseRegister( a, JIT_MOVAPS_LOAD, 4, group - shift / 4 );
+				} else {
+					Jit_Sse( a, JIT_MOVAPS_LOAD, 4, Jit_Broadcast( a, identity ) );
+				}
+				if ( step == 0 ) {
+					Jit_SseRegister( a, JIT_MOVAPS_LOAD, group, 4 );
+				} else {
+					Jit_EmitCombine( a, op, group, 4 );
+				}
+			}
+		}
+	}
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		Jit_WriteGroup( a, inst, group, group, 4 );
+	}
+}
+
+//Shuffles by a constant read a fixed lane of src into every lane, gathered into each group from the groups holding them
+static void Jit_EmitShuffle( jitAssembler_t * a, const shaderProgram_t * program, const shaderInstruction_t & inst, uint32 subgroupSize ) {
+	const uint32 value = program->pConstants[ inst.src[ 1 ] ];
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		uint32 sources[ 4 ];
+		for ( uint32 k = 0; k < 4; k++ ) {
+			const uint32 lane = group * 4 + k;
+			const uint32 id = lane & ( subgroupSize - 1 );
+			uint32 source = value;
+			switch ( inst.op ) {
+				case shaderOp_t::SUBGROUP_SHUFFLE_XOR:	source ^= id; break;
+				case shaderOp_t::SUBGROUP_SHUFFLE_UP:	source = id - source; break;
+				case shaderOp_t::SUBGROUP_SHUFFLE_DOWN:	source = id + source; break;
+				default:								break;
+			}
+			sources[ k ] = ( source < subgroupSize ) ? lane - id + source : lane;
+		}
+		Jit_SseRegister( a, JIT_PXOR, group, group );
+		for ( uint32 from = 0; from < JIT_GROUPS; from++ ) {
+			uint32 order = 0;
+			uint32 select[ 4 ] = { 0, 0, 0, 0 };
+			bool used = false;
+			for ( uint32 k = 0; k < 4; k++ ) {
+				if ( sources[ k ] / 4 == from ) {
+					order |= ( sources[ k ] & 3 ) << ( k * 2 );
+					select[ k ] = ~0u;
+					used = true;
+				}
+			}
+			if ( used ) {
+				Jit_SseImmediate( a, JIT_PSHUFD, 4, Jit_Lane( inst.src[ 0 ], from ), order );
+				Jit_Sse( a, JIT_PAND, 4, Jit_Constant( a, select[ 0 ], select[ 1 ], select[ 2 ], select[ 3 ] ) );
+				Jit_SseRegister( a, JIT_POR, group, 4 );
+			}
+		}
+	}
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		Jit_WriteGroup( a, inst, group, group, 4 );
+	}
+}
+
+static void Jit_EmitSubgroup( jitAssembler_t * a, const shaderProgram_t * program, const shaderInstruction_t & inst, uint32 subgroupSize ) {
+	const uint32 groupsPerSubgroup = subgroupSize / 4;
+	switch ( inst.op ) {
+		case shaderOp_t::SUBGROUP_BUILTIN:
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				uint32 values[ 4 ];
+				for ( uint32 k = 0; k < 4; k++ ) {
+					values[ k ] = ShaderSubgroup_BuiltIn( ( spvBuiltIn_t )inst.src[ 0 ], group * 4 + k, subgroupSize );
+				}
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Constant( a, values[ 0 ], values[ 1 ], values[ 2 ], values[ 3 ] ) );
+				Jit_WriteGroup( a, inst, group, 0, 1 );
+			}
+			break;
+		case shaderOp_t::SUBGROUP_ELECT:
+			//ecx = the lowest bit of each subgroup's field of the execution mask
+			Jit_LoadExecutionMask( a, JIT_RDX );
+			Jit_Gpr( a, 0x33, 1, false, JIT_RCX, Jit_Register( JIT_RCX ) );
+			for ( uint32 subgroup = 0; subgroup < SHADER_LANES / subgroupSize; subgroup++ ) {
+				Jit_Gpr( a, 0x8B, 1, false, JIT_RAX, Jit_Register( JIT_RDX ) );
+				Jit_Encode( a, 0, 0x81, 1, false, 4, Jit_Register( JIT_RAX ), 4, Jit_SubgroupMask( subgroupSize, subgroup ) );
+				Jit_Gpr( a, 0x8B, 1, false, JIT_R8, Jit_Register( JIT_RAX ) );
+				Jit_Encode( a, 0, 0xF7, 1, false, 3, Jit_Register( JIT_R8 ), 0, 0 );
+				Jit_Gpr( a, 0x23, 1, false, JIT_RAX, Jit_Register( JIT_R8 ) );
+				Jit_Gpr( a, 0x0B, 1, false, JIT_RCX, Jit_Register( JIT_RAX ) );
+			}
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				Jit_EmitExpandMask( a, 0, 1, JIT_RCX, group );
+				Jit_WriteGroup( a, inst, group, 0, 1 );
+			}
+			break;
+		case shaderOp_t::SUBGROUP_ALL:
+			//Every active lane is true when no active lane is false
+			Jit_EmitActiveBits( a, inst.src[ 0 ] );
+			Jit_LoadExecutionMask( a, JIT_RAX );
+			Jit_Encode( a, 0, 0xF7, 1, false, 2, Jit_Register( JIT_RDX ), 0, 0 );
+			Jit_Gpr( a, 0x23, 1, false, JIT_RDX, Jit_Register( JIT_RAX ) );
+			Jit_EmitVote( a, inst, subgroupSize, true );
+			break;
+		case shaderOp_t::SUBGROUP_ANY:
+			Jit_EmitActiveBits( a, inst.src[ 0 ] );
+			Jit_EmitVote( a, inst, subgroupSize, false );
+			break;
+		case shaderOp_t::SUBGROUP_ALL_EQUAL:
+			//edx = the active lanes that differ from the first active lane of their subgroup
+			Jit_Gpr( a, 0x33, 1, false, JIT_RDX, Jit_Register( JIT_RDX ) );
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				if ( group % groupsPerSubgroup == 0 ) {
+					Jit_EmitBroadcastFirst( a, 2, inst.src[ 0 ], subgroupSize, group / groupsPerSubgroup );
+				}
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Lane( inst.src[ 0 ], group ) );
+				Jit_SseRegister( a, JIT_PCMPEQD, 0, 2 );
+				Jit_Sse( a, JIT_PANDN, 0, Jit_ExecutionLanes( group ) );
+				Jit_Gpr( a, 0x0F50, 2, false, JIT_RAX, Jit_Register( 0 ) );
+				if ( group != 0 ) {
+					Jit_Encode( a, 0, 0xC1, 1, false, 4, Jit_Register( JIT_RAX ), 1, group * 4 );
+				}
+				Jit_Gpr( a, 0x0B, 1, false, JIT_RDX, Jit_Register( JIT_RAX ) );
+			}
+			Jit_EmitVote( a, inst, subgroupSize, true );
+			break;
+		case shaderOp_t::SUBGROUP_BALLOT:
+			Jit_EmitActiveBits( a, inst.src[ 0 ] );
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				const uint32 first = ( group / groupsPerSubgroup ) * subgroupSize;
+				Jit_Gpr( a, 0x8B, 1, false, JIT_RAX, Jit_Register( JIT_RDX ) );
+				if ( first != 0 ) {
+					Jit_Encode( a, 0, 0xC1, 1, false, 5, Jit_Register( JIT_RAX ), 1, first );
+				}
+				Jit_Encode( a, 0, 0x81, 1, false, 4, Jit_Register( JIT_RAX ), 4, Jit_SubgroupMask( subgroupSize, 0 ) );
+				Jit_Sse( a, JIT_MOVD_LOAD, 0, Jit_Register( JIT_RAX ) );
+				Jit_SseImmediate( a, JIT_PSHUFD, 0, Jit_Register( 0 ), 0x00 );
+				Jit_WriteGroup( a, inst, group, 0, 1 );
+			}
+			break;
+		case shaderOp_t::SUBGROUP_INVERSE_BALLOT:
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				const uint32 id = ( group * 4 ) & ( subgroupSize - 1 );
+				const jitOperand_t bits = Jit_Constant( a, 1u << id, 2u << id, 4u << id, 8u << id );
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Lane( inst.src[ 0 ], group ) );
+				Jit_Sse( a, JIT_PAND, 0, bits );
+				Jit_Sse( a, JIT_PCMPEQD, 0, bits );
+				Jit_WriteGroup( a, inst, group, 0, 1 );
+			}
+			break;
+		case shaderOp_t::SUBGROUP_BROADCAST_FIRST:
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				if ( group % groupsPerSubgroup == 0 ) {
+					Jit_EmitBroadcastFirst( a, 2, inst.src[ 0 ], subgroupSize, group / groupsPerSubgroup );
+				}
+				Jit_SseRegister( a, JIT_MOVAPS_LOAD, 0, 2 );
+				Jit_WriteGroup( a, inst, group, 0, 1 );
+			}
+			break;
+		case shaderOp_t::SUBGROUP_SHUFFLE:
+		case shaderOp_t::SUBGROUP_SHUFFLE_XOR:
+		case shaderOp_t::SUBGROUP_SHUFFLE_UP:
+		case shaderOp_t::SUBGROUP_SHUFFLE_DOWN:
+			Jit_EmitShuffle( a, program, inst, subgroupSize );
+			break;
+		default:
+			Jit_EmitArithmetic( a, inst, subgroupSize );
+			break;
+	}
+}
+
+//Hands the instruction at pc to the interpreter and follows the jump it reports
+static void Jit_EmitStep( jitAssembler_t * a, const shaderInstruction_t & inst, uint32 pc, uint32 firstLabel ) {
+	Jit_Move64( a, jitArguments[ 0 ], JIT_FRAME_REGISTER );
+	Jit_Load64( a, jitArguments[ 1 ], Jit_Frame( offsetof( pipelineFrame_t, context ) ) );
+	Jit_Load64( a, jitArguments[ 2 ], Jit_Frame( offsetof( pipelineFrame_t, resources ) ) );
+	Jit_MoveImmediate32( a, jitArguments[ 3 ], pc );
+	Jit_Call( a, reinterpret_cast< const void * >( ShaderExecution_Step ) );
+	uint32 target = JIT_UNBOUND;
+	switch ( inst.op ) {
+		case shaderOp_t::IF:
+		case shaderOp_t::ELSE:
+		case shaderOp_t::LOOP_BEGIN:
+		case shaderOp_t::SWITCH_BEGIN:
+			target = inst.src[ 1 ];
+			break;
+		case shaderOp_t::LOOP_END:
+			target = inst.src[ 0 ];
+			break;
+		default:
+			return;
+	}
+	Jit_Compare32( a, Jit_Register( JIT_RAX ), pc + 1 );
+	Jit_Jump( a, JIT_NOT_EQUAL, firstLabel + target );
+}
+
+//Emits the whole program, which must be entered with pRegisters loaded and the execution masks begun
+static void Jit_EmitProgram( jitAssembler_t * a, const shaderProgram_t * program, uint32 subgroupSize ) {
+	const uint32 firstLabel = Jit_NewLabels( a, program->instructionCount + 1 );
+	if ( a->failed ) {
+		return;
+	}
+	static_assert( offsetof( pipelineFrame_t, execution ) == 0, "the execution state is passed to ShaderExecution_Step as the frame itself" );
+	for ( uint32 pc = 0; pc < program->instructionCount; pc++ ) {
+		const shaderInstruction_t & inst = program->pInstructions[ pc ];
+		Jit_Bind( a, firstLabel + pc );
+		if ( !Jit_IsInline( program, inst ) ) {
+			Jit_EmitStep( a, inst, pc, firstLabel );
+		} else if ( inst.op >= shaderOp_t::SUBGROUP_BUILTIN ) {
+			Jit_EmitSubgroup( a, program, inst, subgroupSize );
+		} else if ( inst.op >= shaderOp_t::DPDX_FINE ) {
+			Jit_EmitDerivative( a, inst );
+		} else {
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				Jit_EmitGroup( a, program, inst, group );
+				Jit_WriteGroup( a, inst, group, 0, 1 );
+			}
+		}
+	}
+	Jit_Bind( a, firstLabel + program->instructionCount );
+}
+
+/*
+================================================
+Vertex stage
+================================================
+*/
+static void Jit_EmitAttributeComponent( jitAssembler_t * a, const vertexFormat_t * format, uint32 component, const jitOperand_t & dst ) {
+	const bool integer = ( format->kind == vertexComponentKind_t::UINT || format->kind == vertexComponentKind_t::SINT );
+	if ( component >= format->componentCount ) {
+		Jit_StoreImmediate32( a, dst, ( component < 3 ) ? 0 : ( integer ? 1 : Jit_FloatBits( 1.0f ) ) );
+		return;
+	}
+	const uint32 source = ( format->bgra && component < 3 ) ? 2 - component : component;
+	const jitOperand_t src = Jit_Memory( JIT_RDI, ( int32 )( source * format->componentBytes ) );
+	const bool signedSource = ( format->kind == vertexComponentKind_t::SINT || format->kind == vertexComponentKind_t::SNORM );
+	switch ( format->componentBytes ) {
+		case 1:		Jit_Gpr( a, signedSource ? 0x0FBE : 0x0FB6, 2, false, JIT_RAX, src ); break;
+		case 2:		Jit_Gpr( a, signedSource ? 0x0FBF : 0x0FB7, 2, false, JIT_RAX, src ); break;
+		default:	Jit_Load32( a, JIT_RAX, src ); break;
+	}
+	if ( format->kind == vertexComponentKind_t::UNORM || format->kind == vertexComponentKind_t::SNORM ) {
+		const bool snorm = ( format->kind == vertexComponentKind_t::SNORM );
+		const float scale = ( format->componentBytes == 1 ) ? ( snorm ? 1.0f / 127.0f : 1.0f / 255.0f ) : ( snorm ? 1.0f / 32767.0f : 1.0f / 65535.0f );
+		Jit_Sse( a, JIT_CVTSI2SS, 0, Jit_Register( JIT_RAX ) );
+		Jit_Sse( a, JIT_MULSS, 0, Jit_BroadcastFloat( a, scale ) );
+		if ( snorm ) {
+			Jit_Sse( a, JIT_MAXSS, 0, Jit_BroadcastFloat( a, -1.0f ) );
+		}
+		Jit_Sse( a, JIT_MOVSS_STORE, 0, dst );
+		return;
+	}
+	Jit_Store32( a, dst, JIT_RAX );
+}
+
+//rdi = pVertexBuffers[ binding ] + element * stride + offset, element taken from the dword at elementSource
+static void Jit_EmitAttributeAddress( jitAssembler_t * a, const pipelineVertexBinding_t & binding, const pipelineVertexAttribute_t & attribute, const jitOperand_t & elementSource ) {
+	Jit_Load32( a, JIT_RDI, elementSource );
+	Jit_Encode( a, 0, 0x69, 1, true, JIT_RDI, Jit_Register( JIT_RDI ), 4, binding.stride );
+	Jit_Load64( a, JIT_RSI, Jit_Frame( offsetof( pipelineFrame_t, bindings ) ) );
+	Jit_Gpr( a, 0x03, 1, true, JIT_RDI, Jit_Memory( JIT_RSI, ( int32 )( offsetof( pipelineBindings_t, pVertexBuffers ) + attribute.binding * sizeof( const uint8 * ) ) ) );
+	if ( attribute.offset != 0 ) {
+		Jit_Encode( a, 0, 0x81, 1, true, 0, Jit_Register( JIT_RDI ), 4, attribute.offset );
+	}
+}
+
+static void Jit_EmitVertexFetch( jitAssembler_t * a, const graphicsPipeline_t * pipeline ) {
+	for ( uint32 i = 0; i < pipeline->vertexAttributeCount; i++ ) {
+		const pipelineVertexAttribute_t & attribute = pipeline->vertexAttributes[ i ];
+		const pipelineVertexBinding_t & binding = pipeline->vertexBindings[ attribute.binding ];
+		if ( binding.inputRate == VK_VERTEX_INPUT_RATE_INSTANCE ) {
+			//Every lane reads the same element: fetch it once into lane 0, then broadcast
+			Jit_EmitAttributeAddress( a, binding, attribute, Jit_Frame( offsetof( pipelineFrame_t, instanceIndex ) ) );
+			for ( uint32 c = 0; c < 4; c++ ) {
+				const uint32 reg = attribute.registers[ c ];
+				if ( reg == SHADER_NO_REGISTER ) {
+					continue;
+				}
+				Jit_EmitAttributeComponent( a, attribute.format, c, Jit_Lane( reg, 0 ) );
+				Jit_SseImmediate( a, JIT_PSHUFD, 0, Jit_Lane( reg, 0 ), 0x00 );
+				for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+					Jit_Sse( a, JIT_MOVAPS_STORE, 0, Jit_Lane( reg, group ) );
+				}
+			}
+			continue;
+		}
+		for ( uint32 lane = 0; lane < SHADER_LANES; lane++ ) {
+			Jit_EmitAttributeAddress( a, binding, attribute, Jit_Frame( offsetof( pipelineFrame_t, vertexIndices ) + lane * sizeof( uint32 ) ) );
+			for ( uint32 c = 0; c < 4; c++ ) {
+				const uint32 reg = attribute.registers[ c ];
+				if ( reg != SHADER_NO_REGISTER ) {
+					Jit_EmitAttributeComponent( a, attribute.format, c, Jit_Memory( JIT_REGISTER_FILE, ( int32 )( reg * sizeof( shaderRegister_t ) + lane * sizeof( uint32 ) ) ) );
+				}
+			}
+		}
+	}
+}
+
+//Broadcasts the dword at src to every lane of reg
+static void Jit_EmitBroadcast( jitAssembler_t * a, const jitOperand_t & src, uint32 reg ) {
+	if ( reg == SHADER_NO_REGISTER ) {
+		return;
+	}
+	Jit_Sse( a, JIT_MOVSS_LOAD, 0, src );
+	Jit_SseImmediate( a, JIT_PSHUFD, 0, Jit_Register( 0 ), 0x00 );
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		Jit_Sse( a, JIT_MOVAPS_STORE, 0, Jit_Lane( reg, group ) );
+	}
+}
+
+//Copies position and varyings of the first vertexCount lanes to pOutput
+static void Jit_EmitVertexOutput( jitAssembler_t * a, const graphicsPipeline_t * pipeline ) {
+	const uint32 varyingCount = pipeline->raster.varyingCount;
+	const uint32 stride = 4 + varyingCount;
+	const uint32 doneLabel = Jit_NewLabels( a, 1 );
+	Jit_Load64( a, JIT_RDI, Jit_Frame( offsetof( pipelineFrame_t, pOutput ) ) );
+	for ( uint32 lane = 0; lane < SHADER_LANES; lane++ ) {
+		Jit_Compare32( a, Jit_Frame( offsetof( pipelineFrame_t, vertexCount ) ), lane );
+		Jit_Jump( a, JIT_BELOW_OR_EQUAL, doneLabel );
+		for ( uint32 k = 0; k < stride; k++ ) {
+			const uint32 reg = ( k < 4 ) ? pipeline->positionRegisters[ k ] : pipeline->varyingRegisters[ k - 4 ];
+			const jitOperand_t dst = Jit_Memory( JIT_RDI, ( int32 )( ( lane * stride + k ) * sizeof( float ) ) );
+			if ( reg == SHADER_NO_REGISTER ) {
+				Jit_StoreImmediate32( a, dst, 0 );
+				continue;
+			}
+			Jit_Load32( a, JIT_RAX, Jit_Memory( JIT_REGISTER_FILE, ( int32 )( reg * sizeof( shaderRegister_t ) + lane * sizeof( uint32 ) ) ) );
+			Jit_Store32( a, dst, JIT_RAX );
+		}
+	}
+	Jit_Bind( a, doneLabel );
+}
+
+static void Jit_EmitVertexFunction( jitAssembler_t * a, const graphicsPipeline_t * pipeline ) {
+	Jit_Prologue( a );
+	Jit_EmitVertexFetch( a, pipeline );
+	if ( pipeline->vertexIndexRegister != SHADER_NO_REGISTER ) {
+		for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Frame( offsetof( pipelineFrame_t, vertexIndices ) + group * 16 ) );
+			Jit_Sse( a, JIT_MOVAPS_STORE, 0, Jit_Lane( pipeline->vertexIndexRegister, group ) );
+		}
+	}
+	Jit_EmitBroadcast( a, Jit_Frame( offsetof( pipelineFrame_t, instanceIndex ) ), pipeline->instanceIndexRegister );
+	Jit_EmitProgram( a, &pipeline->vertexProgram, pipeline->subgroupSize );
+	Jit_EmitVertexOutput( a, pipeline );
+	Jit_Epilogue( a );
+}
+
+/*
+================================================
+Fragment stage
+================================================
+*/
+//xmm = the float at src in every lane
+static void Jit_EmitSplat( jitAssembler_t * a, uint32 xmm, const jitOperand_t & src ) {
+	Jit_Sse( a, JIT_MOVSS_LOAD, xmm, src );
+	Jit_SseImmediate( a, JIT_SHUFPS, xmm, Jit_Register( xmm ), 0x00 );
+}
+
+//xmm0 = ( a * dx + b * dy ) + c for the plane at rsi + plane * 12, with dx in xmm4 and dy in xmm5
+static void Jit_EmitPlane( jitAssembler_t * a, uint32 plane ) {
+	const int32 offset = ( int32 )( plane * 3 * sizeof( float ) );
+	Jit_EmitSplat( a, 0, Jit_Memory( JIT_RSI, offset ) );
+	Jit_SseRegister( a, JIT_MULPS, 0, 4 );
+	Jit_EmitSplat( a, 1, Jit_Memory( JIT_RSI, offset + 4 ) );
+	Jit_SseRegister( a, JIT_MULPS, 1, 5 );
+	Jit_SseRegister( a, JIT_ADDPS, 0, 1 );
+	Jit_EmitSplat( a, 1, Jit_Memory( JIT_RSI, offset + 8 ) );
+	Jit_SseRegister( a, JIT_ADDPS, 0, 1 );
+}
+
+static void Jit_StoreIfUsed( jitAssembler_t * a, uint32 xmm, uint32 reg, uint32 group ) {
+	if ( reg != SHADER_NO_REGISTER ) {
+		Jit_Sse( a, JIT_MOVAPS_STORE, xmm, Jit_Lane( reg, group ) );
+	}
+}
+
+static void Jit_EmitInterpolation( jitAssembler_t * a, const graphicsPipeline_t * pipeline ) {
+	const bool shaded = ( pipeline->pFragmentContexts != NULL );
+	bool perspective = ( pipeline->fragCoordRegisters[ 3 ] != SHADER_NO_REGISTER );
+	for ( uint32 v = 0; v < pipeline->raster.varyingCount; v++ ) {
+		perspective |= ( pipeline->fragmentVaryingRegisters[ v ] != SHADER_NO_REGISTER );
+	}
+	Jit_Load64( a, JIT_RSI, Jit_Frame( offsetof( pipelineFrame_t, pPlanes ) ) );
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		const float row = ( float )group;
+		Jit_EmitSplat( a, 4, Jit_Frame( offsetof( pipelineFrame_t, planeX ) ) );
+		Jit_Sse( a, JIT_ADDPS, 4, Jit_Constant( a, Jit_FloatBits( 0.0f ), Jit_FloatBits( 1.0f ), Jit_FloatBits( 2.0f ), Jit_FloatBits( 3.0f ) ) );
+		Jit_EmitSplat( a, 5, Jit_Frame( offsetof( pipelineFrame_t, planeY ) ) );
+		Jit_Sse( a, JIT_ADDPS, 5, Jit_BroadcastFloat( a, row ) );
+
+		Jit_EmitPlane( a, 0 );
+		Jit_Sse( a, JIT_MOVAPS_STORE, 0, Jit_Frame( offsetof( pipelineFrame_t, z ) + group * 16 ) );
+		if ( !shaded ) {
+			continue;
+		}
+		Jit_StoreIfUsed( a, 0, pipeline->fragCoordRegisters[ 2 ], group );
+		if ( perspective ) {
+			Jit_EmitPlane( a, 1 );
+			Jit_StoreIfUsed( a, 0, pipeline->fragCoordRegisters[ 3 ], group );
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 3, Jit_BroadcastFloat( a, 1.0f ) );
+			Jit_SseRegister( a, JIT_DIVPS, 3, 0 );
+			for ( uint32 v = 0; v < pipeline->raster.varyingCount; v++ ) {
+				if ( pipeline->fragmentVaryingRegisters[ v ] != SHADER_NO_REGISTER ) {
+					Jit_EmitPlane( a, 2 + v );
+					Jit_SseRegister( a, JIT_MULPS, 0, 3 );
+					Jit_StoreIfUsed( a, 0, pipeline->fragmentVaryingRegisters[ v ], group );
+				}
+			}
+		}
+		if ( pipeline->fragCoordRegisters[ 0 ] != SHADER_NO_REGISTER ) {
+			Jit_EmitSplat( a, 0, Jit_Frame( offsetof( pipelineFrame_t, fragmentX ) ) );
+			Jit_Sse( a, JIT_ADDPS, 0, Jit_Constant( a, Jit_FloatBits( 0.0f ), Jit_FloatBits( 1.0f ), Jit_FloatBits( 2.0f ), Jit_FloatBits( 3.0f ) ) );
+			Jit_StoreIfUsed( a, 0, pipeline->fragCoordRegisters[ 0 ], group );
+		}
+		if ( pipeline->fragCoordRegisters[ 1 ] != SHADER_NO_REGISTER ) {
+			Jit_EmitSplat( a, 0, Jit_Frame( offsetof( pipelineFrame_t, fragmentY ) ) );
+			Jit_Sse( a, JIT_ADDPS, 0, Jit_BroadcastFloat( a, row ) );
+			Jit_StoreIfUsed( a, 0, pipeline->fragCoordRegisters[ 1 ], group );
+		}
+	}
+	if ( shaded ) {
+		Jit_EmitBroadcast( a, Jit_Frame( offsetof( pipelineFrame_t, frontFacing ) ), pipeline->frontFacingRegister );
+	}
+}
+
+static void Jit_EmitSaturate( jitAssembler_t * a, uint32 xmm ) {
+	Jit_Sse( a, JIT_MAXPS, xmm, Jit_BroadcastFloat( a, 0.0f ) );
+	Jit_Sse( a, JIT_MINPS, xmm, Jit_BroadcastFloat( a, 1.0f ) );
+}
+
+//Narrows frame->coverageMask to the lanes passing the depth test, and writes their depth when asked to
+static void Jit_EmitDepthTest( jitAssembler_t * a, const graphicsPipeline_t * pipeline, bool write ) {
+	if ( !pipeline->depthTest ) {
+		return;
+	}
+	//Round to the fixed-point target's steps in place, as Rasterizer_QuantizeDepth does; doing it twice changes nothing
+	const rasterDepthEncoding_t & encoding = pipeline->depthEncoding;
+	if ( encoding.scale != 0.0f ) {
+		for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+			const jitOperand_t fragment = Jit_Frame( offsetof( pipelineFrame_t, z ) + group * 16 );
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, fragment );
+			Jit_EmitSaturate( a, 0 );
+			Jit_Sse( a, JIT_MULPS, 0, Jit_BroadcastFloat( a, encoding.scale ) );
+			Jit_Sse( a, JIT_MINPS, 0, Jit_BroadcastFloat( a, encoding.maxCode ) );
+			Jit_SseImmediate( a, JIT_ROUNDPS, 0, Jit_Register( 0 ), 8 );
+			Jit_Sse( a, JIT_MULPS, 0, Jit_BroadcastFloat( a, 1.0f / encoding.scale ) );
+			Jit_Sse( a, JIT_MOVAPS_STORE, 0, fragment );
+		}
+	}
+	Jit_Load64( a, JIT_RSI, Jit_Frame( offsetof( pipelineFrame_t, batch ) ) );
+	Jit_Load32( a, JIT_RDI, Jit_Frame( offsetof( pipelineFrame_t, coverageMask ) ) );
+	Jit_Gpr( a, 0x33, 1, false, JIT_RDX, Jit_Register( JIT_RDX ) );
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		const jitOperand_t fragment = Jit_Frame( offsetof( pipelineFrame_t, z ) + group * 16 );
+		const jitOperand_t stored = Jit_Memory( JIT_RSI, ( int32 )( offsetof( rasterFragmentBatch_t, depth ) + group * 16 ) );
+		switch ( pipeline->depthCompare ) {
+			case VK_COMPARE_OP_NEVER:				Jit_SseRegister( a, JIT_XORPS, 0, 0 ); break;
+			case VK_COMPARE_OP_LESS:				Jit_Compare( a, JIT_CMP_LT, fragment, stored ); break;
+			case VK_COMPARE_OP_EQUAL:				Jit_Compare( a, JIT_CMP_EQ, fragment, stored ); break;
+			case VK_COMPARE_OP_LESS_OR_EQUAL:		Jit_Compare( a, JIT_CMP_LE, fragment, stored ); break;
+			case VK_COMPARE_OP_GREATER:				Jit_Compare( a, JIT_CMP_LT, stored, fragment ); break;
+			case VK_COMPARE_OP_NOT_EQUAL:			Jit_Compare( a, JIT_CMP_NEQ, fragment, stored ); break;
+			case VK_COMPARE_OP_GREATER_OR_EQUAL:	Jit_Compare( a, JIT_CMP_LE, stored, fragment ); break;
+			default:								Jit_SseRegister( a, JIT_PCMPEQD, 0, 0 ); break;
+		}
+		//edx collects the passing lanes of every group
+		Jit_Gpr( a, 0x0F50, 2, false, JIT_RAX, Jit_Register( 0 ) );
+		if ( group != 0 ) {
+			Jit_Encode( a, 0, 0xC1, 1, false, 4, Jit_Register( JIT_RAX ), 1, group * 4 );
+		}
+		Jit_Gpr( a, 0x0B, 1, false, JIT_RDX, Jit_Register( JIT_RAX ) );
+	}
+	Jit_Gpr( a, 0x23, 1, false, JIT_RDI, Jit_Register( JIT_RDX ) );
+	Jit_Store32( a, Jit_Frame( offsetof( pipelineFrame_t, coverageMask ) ), JIT_RDI );
+	if ( !write || !pipeline->depthWrite ) {
+		return;
+	}
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		const jitOperand_t stored = Jit_Memory( JIT_RSI, ( int32 )( offsetof( rasterFragmentBatch_t, depth ) + group * 16 ) );
+		Jit_EmitExpandMask( a, 1, 2, JIT_RDI, group );
+		Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Frame( offsetof( pipelineFrame_t, z ) + group * 16 ) );
+		Jit_SseRegister( a, JIT_ANDPS, 0, 1 );
+		Jit_Sse( a, JIT_ANDNPS, 1, stored );
+		Jit_SseRegister( a, JIT_ORPS, 0, 1 );
+		Jit_Sse( a, JIT_MOVAPS_STORE, 0, stored );
+	}
+}
+
+static jitOperand_t Jit_BlendSource( uint32 channel ) {
+	return Jit_Frame( offsetof( pipelineFrame_t, blendSource ) + channel * 16 );
+}
+
+static jitOperand_t Jit_BlendDestination( uint32 channel ) {
+	return Jit_Frame( offsetof( pipelineFrame_t, blendDestination ) + channel * 16 );
+}
+
+//xmm1 = blend factor for channel, with xmm3 clobbered
+static void Jit_EmitBlendFactor( jitAssembler_t * a, VkBlendFactor factor, const float * constants, uint32 channel ) {
+	const jitOperand_t one = Jit_BroadcastFloat( a, 1.0f );
+	switch ( factor ) {
+		case VK_BLEND_FACTOR_ONE:						Jit_Sse( a, JIT_MOVAPS_LOAD, 1, one ); break;
+		case VK_BLEND_FACTOR_SRC_COLOR:					Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BlendSource( channel ) ); break;
+		case VK_BLEND_FACTOR_DST_COLOR:					Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BlendDestination( channel ) ); break;
+		case VK_BLEND_FACTOR_SRC_ALPHA:					Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BlendSource( 3 ) ); break;
+		case VK_BLEND_FACTOR_DST_ALPHA:					Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BlendDestination( 3 ) ); break;
+		case VK_BLEND_FACTOR_CONSTANT_COLOR:			Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BroadcastFloat( a, constants[ channel ] ) ); break;
+		case VK_BLEND_FACTOR_CONSTANT_ALPHA:			Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BroadcastFloat( a, constants[ 3 ] ) ); break;
+		case VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR:	Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BroadcastFloat( a, 1.0f - constants[ channel ] ) ); break;
+		case VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA:	Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BroadcastFloat( a, 1.0f - constants[ 3 ] ) ); break;
+		case VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR:		Jit_Binary( a, JIT_SUBPS, one, Jit_BlendSource( channel ) ); Jit_SseRegister( a, JIT_MOVAPS_LOAD, 1, 0 ); break;
+		case VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR:		Jit_Binary( a, JIT_SUBPS, one, Jit_BlendDestination( channel ) ); Jit_SseRegister( a, JIT_MOVAPS_LOAD, 1, 0 ); break;
+		case VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA:		Jit_Binary( a, JIT_SUBPS, one, Jit_BlendSource( 3 ) ); Jit_SseRegister( a, JIT_MOVAPS_LOAD, 1, 0 ); break;
+		case VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA:		Jit_Binary( a, JIT_SUBPS, one, Jit_BlendDestination( 3 ) ); Jit_SseRegister( a, JIT_MOVAPS_LOAD, 1, 0 ); break;
+		case VK_BLEND_FACTOR_SRC_ALPHA_SATURATE:
+			if ( channel == 3 ) {
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 1, one );
+				break;
+			}
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 3, one );
+			Jit_Sse( a, JIT_SUBPS, 3, Jit_BlendDestination( 3 ) );
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 1, Jit_BlendSource( 3 ) );
+			Jit_SseRegister( a, JIT_MINPS, 1, 3 );
+			break;
+		default:										Jit_SseRegister( a, JIT_XORPS, 1, 1 ); break;
+	}
+}
+
+//xmm0 = blended channel, from blendSource and blendDestination; clobbers xmm1 to xmm3
+static void Jit_EmitBlendChannel( jitAssembler_t * a, const pipelineColorBlend_t & blend, uint32 channel ) {
+	const bool alpha = ( channel == 3 );
+	const VkBlendOp op = alpha ? blend.alphaOp : blend.colorOp;
+	if ( op == VK_BLEND_OP_MIN || op == VK_BLEND_OP_MAX ) {
+		Jit_Binary( a, ( op == VK_BLEND_OP_MIN ) ? JIT_MINPS : JIT_MAXPS, Jit_BlendSource( channel ), Jit_BlendDestination( channel ) );
+		return;
+	}
+	Jit_EmitBlendFactor( a, alpha ? blend.dstAlphaFactor : blend.dstColorFactor, blend.constants, channel );
+	Jit_Sse( a, JIT_MOVAPS_LOAD, 2, Jit_BlendDestination( channel ) );
+	Jit_SseRegister( a, JIT_MULPS, 2, 1 );
+	Jit_EmitBlendFactor( a, alpha ? blend.srcAlphaFactor : blend.srcColorFactor, blend.constants, channel );
+	Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_BlendSource( channel ) );
+	Jit_SseRegister( a, JIT_MULPS, 0, 1 );
+	switch ( op ) {
+		case VK_BLEND_OP_SUBTRACT:
+			Jit_SseRegister( a, JIT_SUBPS, 0, 2 );
+			break;
+		case VK_BLEND_OP_REVERSE_SUBTRACT:
+			Jit_SseRegister( a, JIT_SUBPS, 2, 0 );
+			Jit_SseRegister( a, JIT_MOVAPS_LOAD, 0, 2 );
+			break;
+		default:
+			Jit_SseRegister( a, JIT_ADDPS, 0, 2 );
+			break;
+	}
+}
+
+//Blends and packs the shader's color into the covered lanes of batch->color
+static void Jit_EmitColorWrite( jitAssembler_t * a, const graphicsPipeline_t * pipeline ) {
+	uint32 shifts[ 4 ];
+	if ( pipeline->pFragmentContexts == NULL || !Pipeline_ColorChannelShifts( pipeline->colorFormat, shifts ) || pipeline->blend.writeMask == 0 ) {
+		return;
+	}
+	const pipelineColorBlend_t & blend = pipeline->blend;
+	uint32 keep = 0;
+	for ( uint32 c = 0; c < 4; c++ ) {
+		if ( ( blend.writeMask & BIT( c ) ) == 0 ) {
+			keep |= 0xFFu << shifts[ c ];
+		}
+	}
+	Jit_Load64( a, JIT_RSI, Jit_Frame( offsetof( pipelineFrame_t, batch ) ) );
+	for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+		const jitOperand_t target = Jit_Memory( JIT_RSI, ( int32 )( offsetof( rasterFragmentBatch_t, color ) + group * 16 ) );
+		for ( uint32 c = 0; c < 4; c++ ) {
+			const uint32 reg = pipeline->colorRegisters[ c ];
+			if ( reg == SHADER_NO_REGISTER ) {
+				Jit_SseRegister( a, JIT_XORPS, 0, 0 );
+			} else {
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Lane( reg, group ) );
+			}
+			Jit_EmitSaturate( a, 0 );
+			Jit_Sse( a, JIT_MOVAPS_STORE, 0, Jit_BlendSource( c ) );
+			if ( blend.enable ) {
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 0, target );
+				if ( shifts[ c ] != 0 ) {
+					Jit_SseImmediate( a, JIT_PSHIFTD, JIT_SHIFT_RIGHT_LOGICAL, Jit_Register( 0 ), shifts[ c ] );
+				}
+				Jit_Sse( a, JIT_PAND, 0, Jit_Broadcast( a, 0xFF ) );
+				Jit_SseRegister( a, JIT_CVTDQ2PS, 0, 0 );
+				Jit_Sse( a, JIT_MULPS, 0, Jit_BroadcastFloat( a, 1.0f / 255.0f ) );
+				Jit_Sse( a, JIT_MOVAPS_STORE, 0, Jit_BlendDestination( c ) );
+			}
+		}
+		Jit_SseRegister( a, JIT_PXOR, 5, 5 );
+		for ( uint32 c = 0; c < 4; c++ ) {
+			if ( ( blend.writeMask & BIT( c ) ) == 0 ) {
+				continue;
+			}
+			if ( blend.enable ) {
+				Jit_EmitBlendChannel( a, blend, c );
+			} else {
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_BlendSource( c ) );
+			}
+			Jit_EmitSaturate( a, 0 );
+			Jit_Sse( a, JIT_MULPS, 0, Jit_BroadcastFloat( a, 255.0f ) );
+			Jit_Sse( a, JIT_ADDPS, 0, Jit_BroadcastFloat( a, 0.5f ) );
+			Jit_SseRegister( a, JIT_CVTTPS2DQ, 0, 0 );
+			if ( shifts[ c ] != 0 ) {
+				Jit_SseImmediate( a, JIT_PSHIFTD, JIT_SHIFT_LEFT, Jit_Register( 0 ), shifts[ c ] );
+			}
+			Jit_SseRegister( a, JIT_POR, 5, 0 );
+		}
+		if ( keep != 0 ) {
+			Jit_Sse( a, JIT_MOVAPS_LOAD, 0, target );
+			Jit_Sse( a, JIT_PAND, 0, Jit_Broadcast( a, keep ) );
+			Jit_SseRegister( a, JIT_POR, 5, 0 );
+		}
+		//Only covered lanes take the new color
+		Jit_Load32( a, JIT_RDI, Jit_Frame( offsetof( pipelineFrame_t, coverageMask ) ) );
+		Jit_EmitExpandMask( a, 1, 2, JIT_RDI, group );
+		Jit_SseRegister( a, JIT_PAND, 5, 1 );
+		Jit_Sse( a, JIT_PANDN, 1, target );
+		Jit_SseRegister( a, JIT_POR, 5, 1 );
+		Jit_Sse( a, JIT_MOVAPS_STORE, 5, target );
+	}
+}
+
+static void Jit_EmitFragmentFunction( jitAssembler_t * a, const graphicsPipeline_t * pipeline ) {
+	const uint32 returnLabel = Jit_NewLabels( a, 1 );
+	const bool shaded = ( pipeline->pFragmentContexts != NULL );
+	Jit_Prologue( a );
+	Jit_EmitInterpolation( a, pipeline );
+	if ( pipeline->earlyFragmentTests || pipeline->earlyDepthReject ) {
+		Jit_EmitDepthTest( a, pipeline, pipeline->earlyFragmentTests );
+		//Lanes that failed only feed derivatives from here on
+		Jit_Load32( a, JIT_RAX, Jit_Frame( offsetof( pipelineFrame_t, coverageMask ) ) );
+		Jit_Gpr( a, 0xF7, 1, false, 2, Jit_Register( JIT_RAX ) );
+		Jit_Encode( a, 0, 0x81, 1, false, 4, Jit_Register( JIT_RAX ), 4, SHADER_ALL_LANES );
+		Jit_Store32( a, Jit_Frame( offsetof( pipelineFrame_t, execution ) + offsetof( shaderExecution_t, helpers ) ), JIT_RAX );
+		Jit_Compare32( a, Jit_Frame( offsetof( pipelineFrame_t, coverageMask ) ), 0 );
+		Jit_Jump( a, JIT_EQUAL, returnLabel );
+	}
+	if ( shaded ) {
+		Jit_EmitProgram( a, &pipeline->fragmentProgram, pipeline->subgroupSize );
+		if ( ( pipeline->fragmentProgram.flags & SHADER_PROGRAM_USES_KILL ) != 0 ) {
+			Jit_Load32( a, JIT_RAX, Jit_Frame( offsetof( pipelineFrame_t, execution ) + offsetof( shaderExecution_t, killed ) ) );
+			Jit_Gpr( a, 0xF7, 1, false, 2, Jit_Register( JIT_RAX ) );
+			Jit_Gpr( a, 0x21, 1, false, JIT_RAX, Jit_Frame( offsetof( pipelineFrame_t, coverageMask ) ) );
+		}
+	}
+	if ( !pipeline->earlyFragmentTests ) {
+		if ( pipeline->fragDepthRegister != SHADER_NO_REGISTER ) {
+			for ( uint32 group = 0; group < JIT_GROUPS; group++ ) {
+				Jit_Sse( a, JIT_MOVAPS_LOAD, 0, Jit_Lane( pipeline->fragDepthRegister, group ) );
+				Jit_EmitSaturate( a, 0 );
+				Jit_Sse( a, JIT_MOVAPS_STORE, 0, Jit_Frame( offsetof( pipelineFrame_t, z ) + group * 16 ) );
+			}
+		}
+		Jit_EmitDepthTest( a, pipeline, true );
+	}
+	Jit_EmitColorWrite( a, pipeline );
+	Jit_Bind( a, returnLabel );
+	Jit_Load64( a, JIT_RSI, Jit_Frame( offsetof( pipelineFrame_t, batch ) ) );
+	Jit_Load32( a, JIT_RAX, Jit_Frame( offsetof( pipelineFrame_t, coverageMask ) ) );
+	Jit_Store32( a, Jit_Memory( JIT_RSI, ( int32 )offsetof( rasterFragmentBatch_t, coverageMask ) ), JIT_RAX );
+	Jit_Epilogue( a );
+}
+
+/*
+================================================
+Pipelines
+================================================
+*/
+static bool Jit_Supported( cpuIsa_t isa ) {
+	return isa >= cpuIsa_t::SSE41;
+}
+
+bool Jit_CompileGraphicsPipeline( graphicsPipeline_t * pipeline, cpuIsa_t isa ) {
+	if ( !Jit_Supported( isa ) ) {
+		return false;
+	}
+	jitAssembler_t * a = reinterpret_cast< jitAssembler_t * >( pipeline->allocator->pfnAllocation( pipeline->allocator->pUserData, sizeof( jitAssembler_t ), 16, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ) );
+	if ( a == NULL ) {
+		return false;
+	}
+	Jit_Init( a, pipeline->allocator );
+	Jit_EmitVertexFunction( a, pipeline );
+	Jit_AlignCode( a );
+	const uint32 fragmentOffset = a->size;
+	Jit_EmitFragmentFunction( a, pipeline );
+	platformMapping_t mapping;
+	const bool compiled = Jit_Finish( a, &mapping );
+	Jit_Shutdown( a );
+	pipeline->allocator->pfnFree( pipeline->allocator->pUserData, a );
+	if ( !compiled ) {
+		return false;
+	}
+	pipeline->nativeCode = mapping;
+	pipeline->nativeVertex = reinterpret_cast< pipelineNativeFunc_t >( mapping.base );
+	pipeline->nativeFragment = reinterpret_cast< pipelineNativeFunc_t >( reinterpret_cast< uint8 * >( mapping.base ) + fragmentOffset );
+	return true;
+}
+
+bool Jit_CompileComputePipeline( computePipeline_t * pipeline, cpuIsa_t isa ) {
+	if ( !Jit_Supported( isa ) ) {
+		return false;
+	}
+	jitAssembler_t * a = reinterpret_cast< jitAssembler_t * >( pipeline->allocator->pfnAllocation( pipeline->allocator->pUserData, sizeof( jitAssembler_t ), 16, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ) );
+	if ( a == NULL ) {
+		return false;
+	}
+	Jit_Init( a, pipeline->allocator );
+	Jit_Prologue( a );
+	Jit_EmitProgram( a, &pipeline->program, pipeline->subgroupSize );
+	Jit_Epilogue( a );
+	platformMapping_t mapping;
+	const bool compiled = Jit_Finish( a, &mapping );
+	Jit_Shutdown( a );
+	pipeline->allocator->pfnFree( pipeline->allocator->pUserData, a );
+	if ( !compiled ) {
+		return false;
+	}
+	pipeline->nativeCode = mapping;
+	pipeline->nativeMain = reinterpret_cast< pipelineNativeFunc_t >( mapping.base );
+	return true;
+}
+
+#else
+
+//32-bit builds keep every pipeline on the interpreter
+bool Jit_CompileGraphicsPipeline( graphicsPipeline_t *, cpuIsa_t ) {
+	return false;
+}
+
+bool Jit_CompileComputePipeline( computePipeline_t *, cpuIsa_t ) {
+	return false;
+}
+
+#endif
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "Common.h"
+#include "vulkan/vulkan.h"
+#include <atomic>
+#include <new>
+
+//Non-dispatchable handles are packed as [ class : 16 | generation : 24 | index : 24 ]
+#define HANDLE_CLASS_BITS 16
+#define HANDLE_GENERATION_BITS 24
+#define HANDLE_INDEX_BITS 24
+#define HANDLE_GENERATION_MASK ( ( 1ULL << HANDLE_GENERATION_BITS ) - 1ULL )
+#define HANDLE_INDEX_MASK ( ( 1ULL << HANDLE_INDEX_BITS ) - 1ULL )
+#define ENCODE_OBJECT_HANDLE( handleClass, generation, index ) ( ( ( uint64 )handleClass << ( 64ULL - HANDLE_CLASS_BITS ) ) | ( ( ( uint64 )generation & HANDLE_GENERATION_MASK ) << HANDLE_INDEX_BITS ) | ( ( uint64 )index & HANDLE_INDEX_MASK ) )
+#define DECODE_OBJECT_HANDLE( handle ) ( ( uint64 )handle & HANDLE_INDEX_MASK )
+#define DECODE_OBJECT_GENERATION( handle ) ( ( ( uint64 )handle >> HANDLE_INDEX_BITS ) & HANDLE_GENERATION_MASK )
+#define DECODE_OBJECT_CLASS( handle ) ( ( ( uint64 )handle >> ( 64ULL - HANDLE_CLASS_BITS ) ) & ( ( 1ULL << HANDLE_CLASS_BITS ) - 1ULL ) )
+
+/*
+================================================
+VkObjectTable
+
+Slot map backing every non-dispatchable object class of a device.  Slots live in fixed pages that are
+never reallocated, so object pointers stay put for the lifetime of the object.  Allocation pops a
+lock-free free list (or bumps the high-water mark), and freeing pushes the slot back after advancing
+its generation, so a handle that outlives its object no longer resolves.
+
+A zeroed table is valid but empty; call Init before the first Allocate and Shutdown to release pages.
+================================================
+*/
+template< typename __objectType__ >
+class VkObjectTable {
+public:
+	static const uint32 PAGE_SHIFT = 10;
+	static const uint32 PAGE_SLOTS = 1 << PAGE_SHIFT;
+	static const uint32 MAX_PAGES = 1024;
+	static const uint32 MAX_OBJECTS = PAGE_SLOTS * MAX_PAGES;
+
+	void Init( uint32 handleClass, const VkAllocationCallbacks * pAllocator ) {
+		this->handleClass = handleClass;
+		this->allocator = pAllocator;
+		freeHead.store( 0, std::memory_order_relaxed );
+		highWater.store( 0, std::memory_order_relaxed );
+		liveCount.store( 0, std::memory_order_relaxed );
+		for ( uint32 i = 0; i < MAX_PAGES; i++ ) {
+			pages[ i ].store( NULL, std::memory_order_relaxed );
+		}
+	}
+
+	void Shutdown() {
+		for ( uint32 i = 0; i < MAX_PAGES; i++ ) {
+			slot_t * page = pages[ i ].exchange( NULL, std::memory_order_acquire );
+			if ( page != NULL ) {
+				allocator->pfnFree( allocator->pUserData, page );
+			}
+		}
+		freeHead.store( 0, std::memory_order_relaxed );
+		highWater.store( 0, std::memory_order_relaxed );
+		liveCount.store( 0, std::memory_order_relaxed );
+	}
+
+	//Returns a zeroed object and its encoded handle, or NULL when the table is full or out of memory
+	__objectType__ * Allocate( uint64 * pHandle ) {
+		uint32 index;
+		slot_t * slot = PopFreeSlot( &index );
+		if ( slot == NULL ) {
+			//The high-water mark only moves once its slot's page exists, so a failed page allocation leaves it where it was
+			slot_t * page;
+			index = highWater.load( std::memory_order_relaxed );
+			do {
+				if ( index >= MAX_OBJECTS ) {
+					return NULL;
+				}
+				page = PageForIndex( index );
+				if ( page == NULL ) {
+					return NULL;
+				}
+			} while ( !highWater.compare_exchange_weak( index, index + 1, std::memory_order_relaxed ) );
+			slot = &page[ index & ( PAGE_SLOTS - 1 ) ];
+		}
+
+		new ( &slot->object ) __objectType__();
+		uint32 generation = slot->state.load( std::memory_order_relaxed ) >> 1;
+		slot->state.store( ( generation << 1 ) | 1, std::memory_order_release );
+		liveCount.fetch_add( 1, std::memory_order_relaxed );
+		*pHandle = ENCODE_OBJECT_HANDLE( handleClass, generation, index );
+		return &slot->object;
+	}
+
+	//Resolves a handle, returning NULL for VK_NULL_HANDLE, handles of another class and stale handles
+	template< typename __handleType__ >
+	__objectType__ * Get( __handleType__ vHandle ) const {
+		uint64 handle = ( uint64 )vHandle;
+		slot_t * slot = SlotForHandle( handle );
+		return ( slot != NULL ) ? &slot->object : NULL;
+	}
+
+	//Retires the handle's slot; returns false if the handle was already stale
+	template< typename __handleType__ >
+	bool Free( __handleType__ vHandle ) {
+		uint64 handle = ( uint64 )vHandle;
+		slot_t * slot = SlotForHandle( handle );
+		if ( slot == NULL ) {
+			return false;
+		}
+		uint32 expected = ( uint32 )( DECODE_OBJECT_GENERATION( handle ) << 1 ) | 1;
+		uint32 retired = ( uint32 )( ( ( DECODE_OBJECT_GENERATION( handle ) + 1 ) & HANDLE_GENERATION_MASK ) << 1 );
+		if ( !slot->state.compare_exchange_strong( expected, retired, std::memory_order_acq_rel ) ) {
+			return false;
+		}
+		liveCount.fetch_sub( 1, std::memory_order_relaxed );
+		PushFreeSlot( slot, ( uint32 )DECODE_OBJECT_HANDLE( handle ) );
+		return true;
+	}
+
+	//Visits every live object; not safe against concurrent Allocate/Free
+	template< typename __visitor__ >
+	void ForEach( __visitor__ visitor ) {
+		uint32 count = Min( highWater.load( std::memory_order_acquire ), MAX_OBJECTS );
+		for ( uint32 index = 0; index < count; index++ ) {
+			slot_t * page = pages[ index >> PAGE_SHIFT ].load( std::memory_order_acquire );
+			if ( page == NULL ) {
+				continue;
+			}
+			slot_t * slot = &page[ index & ( PAGE_SLOTS - 1 ) ];
+			uint32 state = slot->state.load( std::memory_order_acquire );
+			if ( ( state & 1 ) != 0 ) {
+				visitor( &slot->object, ENCODE_OBJECT_HANDLE( handleClass, state >> 1, index ) );
+			}
+		}
+	}
+
+	uint32 LiveCount() const { return liveCount.load( std::memory_order_relaxed ); }
+
+private:
+	struct slot_t {
+		std::atomic< uint32 >	state;		//( generation << 1 ) | live
+		std::atomic< uint32 >	nextFree;	//1-based index of the next free slot, 0 terminates the list
+		__objectType__			object;
+	};
+
+	slot_t * SlotForHandle( uint64 handle ) const {
+		if ( handle == 0 || DECODE_OBJECT_CLASS( handle ) != handleClass ) {
+			return NULL;
+		}
+		uint32 index = ( uint32 )DECODE_OBJECT_HANDLE( handle );
+		if ( index >= MAX_OBJECTS ) {
+			return NULL;
+		}
+		slot_t * page = pages[ index >> PAGE_SHIFT ].load( std::memory_order_acquire );
+		if ( page == NULL ) {
+			return NULL;
+		}
+		slot_t * slot = &page[ index & ( PAGE_SLOTS - 1 ) ];
+		uint32 state = slot->state.load( std::memory_order_acquire );
+		if ( ( state & 1 ) == 0 || ( state >> 1 ) != DECODE_OBJECT_GENERATION( handle ) ) {
+			return NULL;
+		}
+		return slot;
+	}
+
+	slot_t * PageForIndex( uint32 index ) {
+		std::atomic< slot_t * > & pageRef = pages[ index >> PAGE_SHIFT ];
+		slot_t * page = pageRef.load( std::memory_order_acquire );
+		if ( page == NULL ) {
+			//Several threads may race to create the same page; the loser frees its copy and uses the winner's
+			slot_t * newPage = reinterpret_cast< slot_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( slot_t ) * PAGE_SLOTS, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+			if ( newPage == NULL ) {
+				return NULL;
+			}
+			for ( uint32 i = 0; i < PAGE_SLOTS; i++ ) {
+				new ( &newPage[ i ] ) slot_t();
+			}
+			if ( pageRef.compare_exchange_strong( page, newPage, std::memory_order_acq_rel ) ) {
+				page = newPage;
+			} else {
+				allocator->pfnFree( allocator->pUserData, newPage );
+			}
+		}
+		return page;
+	}
+
+	//The free list head is [ tag : 32 | index + 1 : 32 ]; the tag advances on every pop so a recycled head cannot ABA the CAS
+	slot_t * PopFreeSlot( uint32 * pIndex ) {
+		uint64 head = freeHead.load( std::memory_order_acquire );
+		while ( ( uint32 )head != 0 ) {
+			uint32 index = ( uint32 )head - 1;
+			slot_t * slot = &pages[ index >> PAGE_SHIFT ].load( std::memory_order_acquire )[ index & ( PAGE_SLOTS - 1 ) ];
+			uint64 next = ( ( ( head >> 32 ) + 1 ) << 32 ) | slot->nextFree.load( std::memory_order_relaxed );
+			if ( freeHead.compare_exchange_weak( head, next, std::memory_order_acq_rel, std::memory_order_acquire ) ) {
+				*pIndex = index;
+				return slot;
+			}
+		}
+		return NULL;
+	}
+
+	void PushFreeSlot( slot_t * slot, uint32 index ) {
+		uint64 head = freeHead.load( std::memory_order_relaxed );
+		uint64 next;
+		do {
+			slot->nextFree.store( ( uint32 )head, std::memory_order_relaxed );
+			next = ( head & 0xFFFFFFFF00000000ULL ) | ( index + 1 );
+		} while ( !freeHead.compare_exchange_weak( head, next, std::memory_order_release, std::memory_order_relaxed ) );
+	}
+
+	uint64							handleClass;
+	const VkAllocationCallbacks *	allocator;
+	std::atomic< uint64 >			freeHead;
+	std::atomic< uint32 >			highWater;
+	std::atomic< uint32 >			liveCount;
+	std::atomic< slot_t * >			pages[ MAX_PAGES ];
+};
@@ -0,0 +1,855 @@
+#include "Pipeline.h"
+#include "Format.h"
+#include "Jit.h"
+#include <string.h>
+
+/*
+================================================
+Vertex formats
+================================================
+*/
+static const vertexFormat_t vertexFormats[] = {
+	{ VK_FORMAT_R32_SFLOAT,				1, 4, vertexComponentKind_t::FLOAT, false },
+	{ VK_FORMAT_R32G32_SFLOAT,			2, 4, vertexComponentKind_t::FLOAT, false },
+	{ VK_FORMAT_R32G32B32_SFLOAT,		3, 4, vertexComponentKind_t::FLOAT, false },
+	{ VK_FORMAT_R32G32B32A32_SFLOAT,	4, 4, vertexComponentKind_t::FLOAT, false },
+	{ VK_FORMAT_R32_UINT,				1, 4, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R32G32_UINT,			2, 4, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R32G32B32_UINT,			3, 4, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R32G32B32A32_UINT,		4, 4, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R32_SINT,				1, 4, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R32G32_SINT,			2, 4, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R32G32B32_SINT,			3, 4, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R32G32B32A32_SINT,		4, 4, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R16_UNORM,				1, 2, vertexComponentKind_t::UNORM, false },
+	{ VK_FORMAT_R16G16_UNORM,			2, 2, vertexComponentKind_t::UNORM, false },
+	{ VK_FORMAT_R16G16B16A16_UNORM,		4, 2, vertexComponentKind_t::UNORM, false },
+	{ VK_FORMAT_R16_SNORM,				1, 2, vertexComponentKind_t::SNORM, false },
+	{ VK_FORMAT_R16G16_SNORM,			2, 2, vertexComponentKind_t::SNORM, false },
+	{ VK_FORMAT_R16G16B16A16_SNORM,		4, 2, vertexComponentKind_t::SNORM, false },
+	{ VK_FORMAT_R16_UINT,				1, 2, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R16G16_UINT,			2, 2, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R16G16B16A16_UINT,		4, 2, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R16_SINT,				1, 2, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R16G16_SINT,			2, 2, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R16G16B16A16_SINT,		4, 2, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R8_UNORM,				1, 1, vertexComponentKind_t::UNORM, false },
+	{ VK_FORMAT_R8G8_UNORM,				2, 1, vertexComponentKind_t::UNORM, false },
+	{ VK_FORMAT_R8G8B8A8_UNORM,			4, 1, vertexComponentKind_t::UNORM, false },
+	{ VK_FORMAT_B8G8R8A8_UNORM,			4, 1, vertexComponentKind_t::UNORM, true },
+	{ VK_FORMAT_R8_SNORM,				1, 1, vertexComponentKind_t::SNORM, false },
+	{ VK_FORMAT_R8G8_SNORM,				2, 1, vertexComponentKind_t::SNORM, false },
+	{ VK_FORMAT_R8G8B8A8_SNORM,			4, 1, vertexComponentKind_t::SNORM, false },
+	{ VK_FORMAT_R8_UINT,				1, 1, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R8G8_UINT,				2, 1, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R8G8B8A8_UINT,			4, 1, vertexComponentKind_t::UINT, false },
+	{ VK_FORMAT_R8_SINT,				1, 1, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R8G8_SINT,				2, 1, vertexComponentKind_t::SINT, false },
+	{ VK_FORMAT_R8G8B8A8_SINT,			4, 1, vertexComponentKind_t::SINT, false },
+};
+
+const vertexFormat_t * Pipeline_FindVertexFormat( VkFormat format ) {
+	for ( uint32 i = 0; i < ARRAY_LENGTH( vertexFormats ); i++ ) {
+		if ( vertexFormats[ i ].format == format ) {
+			return &vertexFormats[ i ];
+		}
+	}
+	return NULL;
+}
+
+static uint32 Pipeline_FloatBits( float value ) {
+	uint32 bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	return bits;
+}
+
+//Components the format lacks read as ( 0, 0, 0, 1 )
+static uint32 Pipeline_FetchComponent( const vertexFormat_t * format, const uint8 * pAttribute, uint32 component ) {
+	const bool integer = ( format->kind == vertexComponentKind_t::UINT || format->kind == vertexComponentKind_t::SINT );
+	if ( component >= format->componentCount ) {
+		return ( component < 3 ) ? 0 : ( integer ? 1 : Pipeline_FloatBits( 1.0f ) );
+	}
+	const uint32 source = ( format->bgra && component < 3 ) ? 2 - component : component;
+	const uint8 * pSource = pAttribute + source * format->componentBytes;
+	uint32 raw = 0;
+	int32 signedRaw = 0;
+	switch ( format->componentBytes ) {
+		case 1:
+			raw = pSource[ 0 ];
+			signedRaw = ( int8_t )pSource[ 0 ];
+			break;
+		case 2: {
+			uint16_t value;
+			memcpy( &value, pSource, sizeof( value ) );
+			raw = value;
+			signedRaw = ( int16_t )value;
+			break;
+		}
+		default:
+			memcpy( &raw, pSource, sizeof( raw ) );
+			signedRaw = ( int32 )raw;
+			break;
+	}
+	const float unsignedScale = ( format->componentBytes == 1 ) ? ( 1.0f / 255.0f ) : ( 1.0f / 65535.0f );
+	const float signedScale = ( format->componentBytes == 1 ) ? ( 1.0f / 127.0f ) : ( 1.0f / 32767.0f );
+	switch ( format->kind ) {
+		case vertexComponentKind_t::UNORM:	return Pipeline_FloatBits( ( float )( int32 )raw * unsignedScale );
+		case vertexComponentKind_t::SNORM:	return Pipeline_FloatBits( Max( ( float )signedRaw * signedScale, -1.0f ) );
+		case vertexComponentKind_t::SINT:	return ( uint32 )signedRaw;
+		default:							return raw;
+	}
+}
+
+/*
+================================================
+Fixed-function helpers
+
+The compiled stages emit these same operations in the same order, so both paths produce identical
+results and a pipeline can move between them without visible differences.
+================================================
+*/
+static bool Pipeline_CompareDepth( VkCompareOp op, float fragment, float stored ) {
+	switch ( op ) {
+		case VK_COMPARE_OP_NEVER:				return false;
+		case VK_COMPARE_OP_LESS:				return fragment < stored;
+		case VK_COMPARE_OP_EQUAL:				return fragment == stored;
+		case VK_COMPARE_OP_LESS_OR_EQUAL:		return fragment <= stored;
+		case VK_COMPARE_OP_GREATER:				return stored < fragment;
+		case VK_COMPARE_OP_NOT_EQUAL:			return fragment != stored;
+		case VK_COMPARE_OP_GREATER_OR_EQUAL:	return stored <= fragment;
+		default:								return true;
+	}
+}
+
+static float Pipeline_Saturate( float value ) {
+	return Min( Max( value, 0.0f ), 1.0f );
+}
+
+//Returns the lanes of coverage that pass, writing their depth when asked to and the pipeline writes depth
+static uint32 Pipeline_DepthTest( const graphicsPipeline_t * pipeline, const float * z, uint32 coverage, bool write, rasterFragmentBatch_t * batch ) {
+	if ( !pipeline->depthTest ) {
+		return coverage;
+	}
+	uint32 passed = 0;
+	for ( uint32 mask = coverage; mask != 0; mask &= mask - 1 ) {
+		const uint32 lane = LowestBitIndex( mask );
+		const float fragment = Rasterizer_QuantizeDepth( pipeline->depthEncoding, z[ lane ] );
+		if ( Pipeline_CompareDepth( pipeline->depthCompare, fragment, batch->depth[ lane ] ) ) {
+			passed |= BIT( lane );
+			if ( write && pipeline->depthWrite ) {
+				batch->depth[ lane ] = fragment;
+			}
+		}
+	}
+	return passed;
+}
+
+static float Pipeline_BlendFactor( VkBlendFactor factor, const float * src, const float * dst, const float * constants, uint32 channel ) {
+	switch ( factor ) {
+		case VK_BLEND_FACTOR_ONE:						return 1.0f;
+		case VK_BLEND_FACTOR_SRC_COLOR:					return src[ channel ];
+		case VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR:		return 1.0f - src[ channel ];
+		case VK_BLEND_FACTOR_DST_COLOR:					return dst[ channel ];
+		case VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR:		return 1.0f - dst[ channel ];
+		case VK_BLEND_FACTOR_SRC_ALPHA:					return src[ 3 ];
+		case VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA:		return 1.0f - src[ 3 ];
+		case VK_BLEND_FACTOR_DST_ALPHA:					return dst[ 3 ];
+		case VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA:		return 1.0f - dst[ 3 ];
+		case VK_BLEND_FACTOR_CONSTANT_COLOR:			return constants[ channel ];
+		case VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR:	return 1.0f - constants[ channel ];
+		case VK_BLEND_FACTOR_CONSTANT_ALPHA:			return constants[ 3 ];
+		case VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA:	return 1.0f - constants[ 3 ];
+		case VK_BLEND_FACTOR_SRC_ALPHA_SATURATE:		return ( channel == 3 ) ? 1.0f : Min( src[ 3 ], 1.0f - dst[ 3 ] );
+		default:										return 0.0f;
+	}
+}
+
+static float Pipeline_BlendChannel( const pipelineColorBlend_t & blend, const float * src, const float * dst, uint32 channel ) {
+	const bool alpha = ( channel == 3 );
+	const VkBlendOp op = alpha ? blend.alphaOp : blend.colorOp;
+	if ( op == VK_BLEND_OP_MIN ) {
+		return Min( src[ channel ], dst[ channel ] );
+	}
+	if ( op == VK_BLEND_OP_MAX ) {
+		return Max( src[ channel ], dst[ channel ] );
+	}
+	const float s = src[ channel ] * Pipeline_BlendFactor( alpha ? blend.srcAlphaFactor : blend.srcColorFactor, src, dst, blend.constants, channel );
+	const float d = dst[ channel ] * Pipeline_BlendFactor( alpha ? blend.dstAlphaFactor : blend.dstColorFactor, src, dst, blend.constants, channel );
+	switch ( op ) {
+		case VK_BLEND_OP_SUBTRACT:				return s - d;
+		case VK_BLEND_OP_REVERSE_SUBTRACT:		return d - s;
+		default:								return s + d;
+	}
+}
+
+//Every format that can be a color attachment has four 8-bit UNORM components, so the shifts are all that differ
+bool Pipeline_ColorChannelShifts( VkFormat format, uint32 * pShifts ) {
+	const formatInfo_t * info = Format_Find( format );
+	if ( info == NULL || ( info->optimalFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT ) == 0 ) {
+		return false;
+	}
+	for ( uint32 c = 0; c < 4; c++ ) {
+		pShifts[ c ] = info->fieldShifts[ c ];
+	}
+	return true;
+}
+
+//Subgroups never span more lanes than one instruction of the host holds, so their operations stay within registers
+uint32 Pipeline_SubgroupSize( cpuIsa_t isa ) {
+	switch ( isa ) {
+		case cpuIsa_t::AVX512:	return 16;
+		case cpuIsa_t::AVX2:	return 8;
+		default:				return 4;
+	}
+}
+
+static void Pipeline_WriteColor( const graphicsPipeline_t * pipeline, const shaderRegister_t * pRegisters, uint32 coverage, rasterFragmentBatch_t * batch ) {
+	uint32 shifts[ 4 ];
+	if ( !Pipeline_ColorChannelShifts( pipeline->colorFormat, shifts ) || pipeline->blend.writeMask == 0 ) {
+		return;
+	}
+	const pipelineColorBlend_t & blend = pipeline->blend;
+	for ( uint32 mask = coverage; mask != 0; mask &= mask - 1 ) {
+		const uint32 lane = LowestBitIndex( mask );
+		const uint32 old = batch->color[ lane ];
+		float src[ 4 ];
+		float dst[ 4 ];
+		for ( uint32 c = 0; c < 4; c++ ) {
+			const uint32 reg = pipeline->colorRegisters[ c ];
+			src[ c ] = Pipeline_Saturate( ( reg != SHADER_NO_REGISTER ) ? pRegisters[ reg ].f[ lane ] : 0.0f );
+			dst[ c ] = ( float )( int32 )( ( old >> shifts[ c ] ) & 0xFF ) * ( 1.0f / 255.0f );
+		}
+		uint32 packed = 0;
+		uint32 keep = 0;
+		for ( uint32 c = 0; c < 4; c++ ) {
+			if ( ( blend.writeMask & BIT( c ) ) == 0 ) {
+				keep |= 0xFFu << shifts[ c ];
+				continue;
+			}
+			const float value = blend.enable ? Pipeline_BlendChannel( blend, src, dst, c ) : src[ c ];
+			packed |= ( uint32 )( int32 )( Pipeline_Saturate( value ) * 255.0f + 0.5f ) << shifts[ c ];
+		}
+		batch->color[ lane ] = packed | ( old & keep );
+	}
+}
+
+static uint32 Pipeline_LaneMask( uint32 count ) {
+	return ( count >= SHADER_LANES ) ? SHADER_ALL_LANES : ( BIT( count ) ) - 1;
+}
+
+static void Pipeline_Broadcast( shaderRegister_t * pRegisters, uint32 reg, uint32 value ) {
+	if ( reg != SHADER_NO_REGISTER ) {
+		for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+			pRegisters[ reg ].u[ l ] = value;
+		}
+	}
+}
+
+/*
+================================================
+Interpreted stages
+================================================
+*/
+static void Pipeline_InterpretVertices( const void * pShaderData, const void * pBindings, uint32 workerIndex, const uint32 * pVertexIndices, uint32 count, uint32 instanceIndex, float * pOutput, uint32 stride ) {
+	const graphicsPipeline_t * pipeline = reinterpret_cast< const graphicsPipeline_t * >( pShaderData );
+	const pipelineBindings_t * bindings = reinterpret_cast< const pipelineBindings_t * >( pBindings );
+	shaderContext_t * context = &pipeline->pVertexContexts[ workerIndex ];
+	shaderRegister_t * pRegisters = context->pRegisters;
+
+	for ( uint32 a = 0; a < pipeline->vertexAttributeCount; a++ ) {
+		const pipelineVertexAttribute_t & attribute = pipeline->vertexAttributes[ a ];
+		const pipelineVertexBinding_t & binding = pipeline->vertexBindings[ attribute.binding ];
+		for ( uint32 l = 0; l < count; l++ ) {
+			const uint32 element = ( binding.inputRate == VK_VERTEX_INPUT_RATE_INSTANCE ) ? instanceIndex : pVertexIndices[ l ];
+			const uint8 * pAttribute = bindings->pVertexBuffers[ attribute.binding ] + ( uint64 )element * binding.stride + attribute.offset;
+			for ( uint32 c = 0; c < 4; c++ ) {
+				if ( attribute.registers[ c ] != SHADER_NO_REGISTER ) {
+					pRegisters[ attribute.registers[ c ] ].u[ l ] = Pipeline_FetchComponent( attribute.format, pAttribute, c );
+				}
+			}
+		}
+	}
+	if ( pipeline->vertexIndexRegister != SHADER_NO_REGISTER ) {
+		for ( uint32 l = 0; l < count; l++ ) {
+			pRegisters[ pipeline->vertexIndexRegister ].u[ l ] = pVertexIndices[ l ];
+		}
+	}
+	Pipeline_Broadcast( pRegisters, pipeline->instanceIndexRegister, instanceIndex );
+
+	ShaderContext_Run( context, Pipeline_LaneMask( count ), 0, &bindings->vertexResources );
+
+	const uint32 varyingCount = pipeline->raster.varyingCount;
+	for ( uint32 l = 0; l < count; l++ ) {
+		float * pVertex = pOutput + l * stride;
+		for ( uint32 c = 0; c < 4; c++ ) {
+			const uint32 reg = pipeline->positionRegisters[ c ];
+			pVertex[ c ] = ( reg != SHADER_NO_REGISTER ) ? pRegisters[ reg ].f[ l ] : 0.0f;
+		}
+		for ( uint32 v = 0; v < varyingCount; v++ ) {
+			const uint32 reg = pipeline->varyingRegisters[ v ];
+			pVertex[ 4 + v ] = ( reg != SHADER_NO_REGISTER ) ? pRegisters[ reg ].f[ l ] : 0.0f;
+		}
+	}
+}
+
+static void Pipeline_InterpretFragments( const void * pShaderData, const void * pBindings, uint32 workerIndex, const rasterTriangle_t * triangle, rasterFragmentBatch_t * batch ) {
+	const graphicsPipeline_t * pipeline = reinterpret_cast< const graphicsPipeline_t * >( pShaderData );
+	const pipelineBindings_t * bindings = reinterpret_cast< const pipelineBindings_t * >( pBindings );
+	shaderContext_t * context = ( pipeline->pFragmentContexts != NULL ) ? &pipeline->pFragmentContexts[ workerIndex ] : NULL;
+	shaderRegister_t * pRegisters = ( context != NULL ) ? context->pRegisters : NULL;
+
+	//Planes are evaluated relative to the triangle's first vertex, in pixels
+	const float * planes = triangle->planes;
+	const float planeX = ( float )batch->x + 0.5f - triangle->originX;
+	const float planeY = ( float )batch->y + 0.5f - triangle->originY;
+	const float fragmentX = ( float )batch->x + 0.5f;
+	const float fragmentY = ( float )batch->y + 0.5f;
+	float z[ RASTER_FRAGMENT_BATCH ];
+	for ( uint32 lane = 0; lane < RASTER_FRAGMENT_BATCH; lane++ ) {
+		const float dx = planeX + ( float )( lane & ( RASTER_BLOCK_SIZE - 1 ) );
+		const float dy = planeY + ( float )( lane >> RASTER_BLOCK_SHIFT );
+		z[ lane ] = planes[ 0 ] * dx + planes[ 1 ] * dy + planes[ 2 ];
+		if ( context == NULL ) {
+			continue;
+		}
+		const float inverseW = planes[ 3 ] * dx + planes[ 4 ] * dy + planes[ 5 ];
+		const float w = 1.0f / inverseW;
+		const float fragCoord[ 4 ] = { fragmentX + ( float )( lane & ( RASTER_BLOCK_SIZE - 1 ) ), fragmentY + ( float )( lane >> RASTER_BLOCK_SHIFT ), z[ lane ], inverseW };
+		for ( uint32 c = 0; c < 4; c++ ) {
+			if ( pipeline->fragCoordRegisters[ c ] != SHADER_NO_REGISTER ) {
+				pRegisters[ pipeline->fragCoordRegisters[ c ] ].f[ lane ] = fragCoord[ c ];
+			}
+		}
+		const float * plane = planes + 6;
+		for ( uint32 v = 0; v < pipeline->raster.varyingCount; v++, plane += 3 ) {
+			if ( pipeline->fragmentVaryingRegisters[ v ] != SHADER_NO_REGISTER ) {
+				pRegisters[ pipeline->fragmentVaryingRegisters[ v ] ].f[ lane ] = ( plane[ 0 ] * dx + plane[ 1 ] * dy + plane[ 2 ] ) * w;
+			}
+		}
+	}
+
+	uint32 coverage = batch->coverageMask;
+	if ( pipeline->earlyFragmentTests || pipeline->earlyDepthReject ) {
+		coverage = Pipeline_DepthTest( pipeline, z, coverage, pipeline->earlyFragmentTests, batch );
+		if ( coverage == 0 ) {
+			batch->coverageMask = 0;
+			return;
+		}
+	}
+	if ( context != NULL ) {
+		Pipeline_Broadcast( pRegisters, pipeline->frontFacingRegister, batch->frontFacing ? ~0u : 0u );
+		coverage &= ShaderContext_Run( context, SHADER_ALL_LANES, SHADER_ALL_LANES & ~coverage, &bindings->fragmentResources );
+	}
+	if ( !pipeline->earlyFragmentTests ) {
+		if ( pipeline->fragDepthRegister != SHADER_NO_REGISTER ) {
+			for ( uint32 lane = 0; lane < RASTER_FRAGMENT_BATCH; lane++ ) {
+				z[ lane ] = Pipeline_Saturate( pRegisters[ pipeline->fragDepthRegister ].f[ lane ] );
+			}
+		}
+		coverage = Pipeline_DepthTest( pipeline, z, coverage, true, batch );
+	}
+	if ( context != NULL ) {
+		Pipeline_WriteColor( pipeline, pRegisters, coverage, batch );
+	}
+	batch->coverageMask = coverage;
+}
+
+/*
+================================================
+Compiled stages
+================================================
+*/
+static void Pipeline_NativeVertices( const void * pShaderData, const void * pBindings, uint32 workerIndex, const uint32 * pVertexIndices, uint32 count, uint32 instanceIndex, float * pOutput, uint32 ) {
+	const graphicsPipeline_t * pipeline = reinterpret_cast< const graphicsPipeline_t * >( pShaderData );
+	const pipelineBindings_t * bindings = reinterpret_cast< const pipelineBindings_t * >( pBindings );
+	shaderContext_t * context = &pipeline->pVertexContexts[ workerIndex ];
+	pipelineFrame_t frame;
+	for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+		frame.vertexIndices[ l ] = pVertexIndices[ ( l < count ) ? l : 0 ];
+	}
+	frame.context = context;
+	frame.resources = &bindings->vertexResources;
+	frame.pRegisters = context->pRegisters;
+	frame.bindings = bindings;
+	frame.vertexCount = count;
+	frame.instanceIndex = instanceIndex;
+	frame.pOutput = pOutput;
+	ShaderExecution_Begin( &frame.execution, context, Pipeline_LaneMask( count ), 0 );
+	pipeline->nativeVertex( &frame );
+}
+
+static void Pipeline_NativeFragments( const void * pShaderData, const void * pBindings, uint32 workerIndex, const rasterTriangle_t * triangle, rasterFragmentBatch_t * batch ) {
+	const graphicsPipeline_t * pipeline = reinterpret_cast< const graphicsPipeline_t * >( pShaderData );
+	const pipelineBindings_t * bindings = reinterpret_cast< const pipelineBindings_t * >( pBindings );
+	shaderContext_t * context = ( pipeline->pFragmentContexts != NULL ) ? &pipeline->pFragmentContexts[ workerIndex ] : NULL;
+	pipelineFrame_t frame;
+	frame.context = context;
+	frame.resources = &bindings->fragmentResources;
+	frame.pRegisters = ( context != NULL ) ? context->pRegisters : NULL;
+	frame.bindings = bindings;
+	frame.pPlanes = triangle->planes;
+	frame.batch = batch;
+	frame.planeX = ( float )batch->x + 0.5f - triangle->originX;
+	frame.planeY = ( float )batch->y + 0.5f - triangle->originY;
+	frame.fragmentX = ( float )batch->x + 0.5f;
+	frame.fragmentY = ( float )batch->y + 0.5f;
+	frame.coverageMask = batch->coverageMask;
+	frame.frontFacing = batch->frontFacing ? ~0u : 0u;
+	frame.execution.killed = 0;
+	if ( context != NULL ) {
+		ShaderExecution_Begin( &frame.execution, context, SHADER_ALL_LANES, SHADER_ALL_LANES & ~batch->coverageMask );
+	}
+	pipeline->nativeFragment( &frame );
+}
+
+/*
+================================================
+graphicsPipeline_t
+================================================
+*/
+static void Pipeline_DestroyContexts( shaderContext_t * pContexts, uint32 workerCount, const VkAllocationCallbacks * allocator ) {
+	if ( pContexts == NULL ) {
+		return;
+	}
+	for ( uint32 i = 0; i < workerCount; i++ ) {
+		ShaderContext_Shutdown( &pContexts[ i ] );
+	}
+	allocator->pfnFree( allocator->pUserData, pContexts );
+}
+
+static shaderContext_t * Pipeline_CreateContexts( const shaderProgram_t * program, uint32 workerCount, uint32 subgroupSize, const VkAllocationCallbacks * allocator ) {
+	shaderContext_t * pContexts = reinterpret_cast< shaderContext_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( shaderContext_t ) * workerCount, 64, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( pContexts == NULL ) {
+		return NULL;
+	}
+	memset( pContexts, 0, sizeof( shaderContext_t ) * workerCount );
+	for ( uint32 i = 0; i < workerCount; i++ ) {
+		if ( !ShaderContext_Init( &pContexts[ i ], program, subgroupSize, allocator ) ) {
+			Pipeline_DestroyContexts( pContexts, workerCount, allocator );
+			return NULL;
+		}
+	}
+	return pContexts;
+}
+
+//SOFTWARE_VULKAN_INTERPRETER keeps every pipeline on the interpreter, for debugging the JIT against it
+static bool Pipeline_UseJit() {
+	return !Platform_GetEnvironmentFlag( "SOFTWARE_VULKAN_INTERPRETER" );
+}
+
+static void Pipeline_LinkVertexInput( graphicsPipeline_t * pipeline, const VkPipelineVertexInputStateCreateInfo * pState, VkResult * pResult ) {
+	const shaderProgram_t * program = &pipeline->vertexProgram;
+	for ( uint32 i = 0; i < pState->vertexBindingDescriptionCount; i++ ) {
+		const VkVertexInputBindingDescription & description = pState->pVertexBindingDescriptions[ i ];
+		if ( description.binding >= PIPELINE_MAX_VERTEX_BINDINGS ) {
+			*pResult = VK_ERROR_VALIDATION_FAILED_EXT;
+			return;
+		}
+		pipeline->vertexBindings[ description.binding ].stride = description.stride;
+		pipeline->vertexBindings[ description.binding ].inputRate = description.inputRate;
+	}
+	for ( uint32 i = 0; i < pState->vertexAttributeDescriptionCount; i++ ) {
+		const VkVertexInputAttributeDescription & description = pState->pVertexAttributeDescriptions[ i ];
+		pipelineVertexAttribute_t * attribute = &pipeline->vertexAttributes[ pipeline->vertexAttributeCount ];
+		attribute->binding = description.binding;
+		attribute->offset = description.offset;
+		attribute->format = Pipeline_FindVertexFormat( description.format );
+		if ( attribute->format == NULL || description.binding >= PIPELINE_MAX_VERTEX_BINDINGS ) {
+			Platform_DebugPrintf( "SoftwareVulkan: vertex attribute format %u is not supported\n", ( uint32 )description.format );
+			*pResult = VK_ERROR_FORMAT_NOT_SUPPORTED;
+			return;
+		}
+		bool used = false;
+		for ( uint32 c = 0; c < 4; c++ ) {
+			attribute->registers[ c ] = ShaderProgram_FindLocation( program, false, description.location, c );
+			used |= ( attribute->registers[ c ] != SHADER_NO_REGISTER );
+		}
+		//Attributes the shader never reads are not fetched at all
+		if ( used ) {
+			pipeline->vertexAttributeCount++;
+		}
+	}
+	pipeline->vertexIndexRegister = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::VERTEX_INDEX, 0 );
+	pipeline->instanceIndexRegister = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::INSTANCE_INDEX, 0 );
+	for ( uint32 c = 0; c < 4; c++ ) {
+		pipeline->positionRegisters[ c ] = ShaderProgram_FindBuiltIn( program, true, spvBuiltIn_t::POSITION, c );
+	}
+}
+
+//Every user input of the fragment shader becomes one varying, fed by the vertex output at the same location and component
+static bool Pipeline_LinkVaryings( graphicsPipeline_t * pipeline ) {
+	const shaderProgram_t * fragmentProgram = &pipeline->fragmentProgram;
+	uint32 varyingCount = 0;
+	for ( uint32 i = 0; i < fragmentProgram->inputCount; i++ ) {
+		const shaderInterface_t & input = fragmentProgram->pInputs[ i ];
+		if ( input.builtIn != SHADER_NO_BUILTIN ) {
+			continue;
+		}
+		if ( varyingCount == RASTER_MAX_VARYINGS ) {
+			return false;
+		}
+		pipeline->fragmentVaryingRegisters[ varyingCount ] = input.reg;
+		pipeline->varyingRegisters[ varyingCount ] = ShaderProgram_FindLocation( &pipeline->vertexProgram, true, input.location, input.component );
+		varyingCount++;
+	}
+	pipeline->raster.varyingCount = varyingCount;
+	for ( uint32 c = 0; c < 4; c++ ) {
+		pipeline->fragCoordRegisters[ c ] = ShaderProgram_FindBuiltIn( fragmentProgram, false, spvBuiltIn_t::FRAG_COORD, c );
+		pipeline->colorRegisters[ c ] = ShaderProgram_FindLocation( fragmentProgram, true, 0, c );
+	}
+	pipeline->frontFacingRegister = ShaderProgram_FindBuiltIn( fragmentProgram, false, spvBuiltIn_t::FRONT_FACING, 0 );
+	pipeline->fragDepthRegister = ShaderProgram_FindBuiltIn( fragmentProgram, true, spvBuiltIn_t::FRAG_DEPTH, 0 );
+	return true;
+}
+
+VkResult GraphicsPipeline_Init( graphicsPipeline_t * pipeline, const VkGraphicsPipelineCreateInfo * pCreateInfo, const shaderModule_t * const * pModules, pipelineCache_t * cache, const pipelineTargetFormats_t & targetFormats, uint32 workerCount, cpuIsa_t isa, const VkAllocationCallbacks * allocator ) {
+	memset( pipeline, 0, sizeof( graphicsPipeline_t ) );
+	pipeline->allocator = allocator;
+	pipeline->workerCount = workerCount;
+	pipeline->subgroupSize = Pipeline_SubgroupSize( isa );
+	for ( uint32 i = 0; i < RASTER_MAX_VARYINGS; i++ ) {
+		pipeline->varyingRegisters[ i ] = SHADER_NO_REGISTER;
+		pipeline->fragmentVaryingRegisters[ i ] = SHADER_NO_REGISTER;
+	}
+	for ( uint32 c = 0; c < 4; c++ ) {
+		pipeline->fragCoordRegisters[ c ] = SHADER_NO_REGISTER;
+		pipeline->colorRegisters[ c ] = SHADER_NO_REGISTER;
+	}
+	pipeline->frontFacingRegister = SHADER_NO_REGISTER;
+	pipeline->fragDepthRegister = SHADER_NO_REGISTER;
+
+	VkResult result = VK_SUCCESS;
+	const VkPipelineShaderStageCreateInfo * pVertexStage = NULL;
+	const VkPipelineShaderStageCreateInfo * pFragmentStage = NULL;
+	const shaderModule_t * vertexModule = NULL;
+	const shaderModule_t * fragmentModule = NULL;
+	const VkPipelineDepthStencilStateCreateInfo * pDepthState = pCreateInfo->pDepthStencilState;
+	const VkPipelineColorBlendStateCreateInfo * pBlendState = pCreateInfo->pColorBlendState;
+	uint32 fragmentFlags = 0;
+	for ( uint32 i = 0; i < pCreateInfo->stageCount; i++ ) {
+		const VkPipelineShaderStageCreateInfo * pStage = &pCreateInfo->pStages[ i ];
+		if ( pStage->stage == VK_SHADER_STAGE_VERTEX_BIT ) {
+			pVertexStage = pStage;
+			vertexModule = pModules[ i ];
+		} else if ( pStage->stage == VK_SHADER_STAGE_FRAGMENT_BIT ) {
+			pFragmentStage = pStage;
+			fragmentModule = pModules[ i ];
+		} else {
+			Platform_DebugPrintf( "SoftwareVulkan: only vertex and fragment stages are supported in graphics pipelines\n" );
+			result = VK_ERROR_FEATURE_NOT_PRESENT;
+			goto pipelineFailed;
+		}
+	}
+	if ( pVertexStage == NULL ) {
+		result = VK_ERROR_VALIDATION_FAILED_EXT;
+		goto pipelineFailed;
+	}
+	if ( !PipelineCache_BuildProgram( cache, &pipeline->vertexProgram, vertexModule, VK_SHADER_STAGE_VERTEX_BIT, pVertexStage->pName, pVertexStage->pSpecializationInfo, allocator ) ) {
+		result = VK_ERROR_INITIALIZATION_FAILED;
+		goto pipelineFailed;
+	}
+	if ( pFragmentStage != NULL && !PipelineCache_BuildProgram( cache, &pipeline->fragmentProgram, fragmentModule, VK_SHADER_STAGE_FRAGMENT_BIT, pFragmentStage->pName, pFragmentStage->pSpecializationInfo, allocator ) ) {
+		result = VK_ERROR_INITIALIZATION_FAILED;
+		goto pipelineFailed;
+	}
+
+	if ( pCreateInfo->pVertexInputState != NULL ) {
+		Pipeline_LinkVertexInput( pipeline, pCreateInfo->pVertexInputState, &result );
+		if ( result != VK_SUCCESS ) {
+			goto pipelineFailed;
+		}
+	}
+	if ( pFragmentStage != NULL && !Pipeline_LinkVaryings( pipeline ) ) {
+		result = VK_ERROR_INITIALIZATION_FAILED;
+		goto pipelineFailed;
+	}
+	pipeline->raster.topology = pCreateInfo->pInputAssemblyState->topology;
+	pipeline->raster.primitiveRestart = ( pCreateInfo->pInputAssemblyState->primitiveRestartEnable != VK_FALSE );
+	pipeline->raster.cullMode = pCreateInfo->pRasterizationState->cullMode;
+	pipeline->raster.frontFace = pCreateInfo->pRasterizationState->frontFace;
+	pipeline->raster.pShaderData = pipeline;
+
+	fragmentFlags = pipeline->fragmentProgram.flags;
+	pipeline->depthTest = ( pDepthState != NULL && pDepthState->depthTestEnable && targetFormats.depth != VK_FORMAT_UNDEFINED );
+	pipeline->depthWrite = ( pipeline->depthTest && pDepthState->depthWriteEnable );
+	pipeline->depthCompare = pipeline->depthTest ? pDepthState->depthCompareOp : VK_COMPARE_OP_ALWAYS;
+	pipeline->depthEncoding = Rasterizer_DepthEncoding( targetFormats.depth );
+	//Testing ahead of the shader is only invisible when the shader can neither discard, move depth nor write memory.
+	//A discard only matters to the depth write, so such shaders still reject failing fragments early and write late
+	pipeline->earlyFragmentTests = ( fragmentFlags & SHADER_PROGRAM_EARLY_FRAGMENT_TESTS ) != 0
+		|| ( fragmentFlags & ( SHADER_PROGRAM_USES_KILL | SHADER_PROGRAM_DEPTH_REPLACING | SHADER_PROGRAM_WRITES_BUFFERS ) ) == 0;
+	if ( pipeline->earlyFragmentTests ) {
+		pipeline->fragDepthRegister = SHADER_NO_REGISTER;
+	}
+	pipeline->earlyDepthReject = !pipeline->earlyFragmentTests && pipeline->depthTest
+		&& ( fragmentFlags & ( SHADER_PROGRAM_DEPTH_REPLACING | SHADER_PROGRAM_WRITES_BUFFERS ) ) == 0 && pipeline->fragDepthRegister == SHADER_NO_REGISTER;
+	//The back end may then skip whole triangles and blocks against the hierarchical depth
+	pipeline->raster.depthCull = ( pipeline->earlyFragmentTests || pipeline->earlyDepthReject ) ? pipeline->depthCompare : VK_COMPARE_OP_ALWAYS;
+	pipeline->raster.depthWrite = pipeline->depthWrite;
+	pipeline->colorFormat = targetFormats.color;
+	if ( pBlendState != NULL && pBlendState->attachmentCount > 0 ) {
+		const VkPipelineColorBlendAttachmentState & attachment = pBlendState->pAttachments[ 0 ];
+		pipeline->blend.enable = ( attachment.blendEnable != VK_FALSE );
+		pipeline->blend.srcColorFactor = attachment.srcColorBlendFactor;
+		pipeline->blend.dstColorFactor = attachment.dstColorBlendFactor;
+		pipeline->blend.colorOp = attachment.colorBlendOp;
+		pipeline->blend.srcAlphaFactor = attachment.srcAlphaBlendFactor;
+		pipeline->blend.dstAlphaFactor = attachment.dstAlphaBlendFactor;
+		pipeline->blend.alphaOp = attachment.alphaBlendOp;
+		pipeline->blend.writeMask = attachment.colorWriteMask;
+		memcpy( pipeline->blend.constants, pBlendState->blendConstants, sizeof( pipeline->blend.constants ) );
+	}
+
+	pipeline->pVertexContexts = Pipeline_CreateContexts( &pipeline->vertexProgram, workerCount, pipeline->subgroupSize, allocator );
+	if ( pipeline->pVertexContexts == NULL ) {
+		result = VK_ERROR_OUT_OF_HOST_MEMORY;
+		goto pipelineFailed;
+	}
+	if ( pFragmentStage != NULL ) {
+		pipeline->pFragmentContexts = Pipeline_CreateContexts( &pipeline->fragmentProgram, workerCount, pipeline->subgroupSize, allocator );
+		if ( pipeline->pFragmentContexts == NULL ) {
+			result = VK_ERROR_OUT_OF_HOST_MEMORY;
+			goto pipelineFailed;
+		}
+	}
+
+	pipeline->raster.vertexShader = Pipeline_InterpretVertices;
+	pipeline->raster.fragmentShader = Pipeline_InterpretFragments;
+	if ( Pipeline_UseJit() && Jit_CompileGraphicsPipeline( pipeline, isa ) ) {
+		pipeline->raster.vertexShader = Pipeline_NativeVertices;
+		pipeline->raster.fragmentShader = Pipeline_NativeFragments;
+	}
+	return VK_SUCCESS;
+
+pipelineFailed:
+	GraphicsPipeline_Shutdown( pipeline );
+	return result;
+}
+
+void GraphicsPipeline_Shutdown( graphicsPipeline_t * pipeline ) {
+	if ( pipeline->allocator == NULL ) {
+		return;
+	}
+	Pipeline_DestroyContexts( pipeline->pVertexContexts, pipeline->workerCount, pipeline->allocator );
+	Pipeline_DestroyContexts( pipeline->pFragmentContexts, pipeline->workerCount, pipeline->allocator );
+	ShaderProgram_Destroy( &pipeline->vertexProgram );
+	ShaderProgram_Destroy( &pipeline->fragmentProgram );
+	Platform_UnmapMemory( &pipeline->nativeCode );
+	memset( pipeline, 0, sizeof( graphicsPipeline_t ) );
+}
+
+/*
+================================================
+computePipeline_t
+================================================
+*/
+//Fills the invocation ids of the batch whose lane 0 is local invocation first and returns its lane mask
+static uint32 Compute_BeginBatch( const computePipeline_t * pipeline, shaderRegister_t * pRegisters, uint32 first, const uint32 workgroupId[ 3 ] ) {
+	const uint32 * localSize = pipeline->program.localSize;
+	const uint32 count = Min( localSize[ 0 ] * localSize[ 1 ] * localSize[ 2 ] - first, ( uint32 )SHADER_LANES );
+	for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+		const uint32 index = first + ( ( l < count ) ? l : 0 );
+		const uint32 local[ 3 ] = { index % localSize[ 0 ], ( index / localSize[ 0 ] ) % localSize[ 1 ], index / ( localSize[ 0 ] * localSize[ 1 ] ) };
+		for ( uint32 c = 0; c < 3; c++ ) {
+			if ( pipeline->localInvocationRegisters[ c ] != SHADER_NO_REGISTER ) {
+				pRegisters[ pipeline->localInvocationRegisters[ c ] ].u[ l ] = local[ c ];
+			}
+			if ( pipeline->globalInvocationRegisters[ c ] != SHADER_NO_REGISTER ) {
+				pRegisters[ pipeline->globalInvocationRegisters[ c ] ].u[ l ] = workgroupId[ c ] * localSize[ c ] + local[ c ];
+			}
+		}
+		if ( pipeline->localIndexRegister != SHADER_NO_REGISTER ) {
+			pRegisters[ pipeline->localIndexRegister ].u[ l ] = index;
+		}
+		if ( pipeline->subgroupIdRegister != SHADER_NO_REGISTER ) {
+			pRegisters[ pipeline->subgroupIdRegister ].u[ l ] = ( first + l ) / pipeline->subgroupSize;
+		}
+	}
+	if ( pipeline->numSubgroupsRegister != SHADER_NO_REGISTER ) {
+		Pipeline_Broadcast( pRegisters, pipeline->numSubgroupsRegister, ( localSize[ 0 ] * localSize[ 1 ] * localSize[ 2 ] + pipeline->subgroupSize - 1 ) / pipeline->subgroupSize );
+	}
+	return Pipeline_LaneMask( count );
+}
+
+static void Compute_RunBatch( const computePipeline_t * pipeline, shaderContext_t * context, uint32 laneMask, const shaderResources_t * resources ) {
+	if ( pipeline->nativeMain == NULL ) {
+		ShaderContext_Run( context, laneMask, 0, resources );
+		return;
+	}
+	pipelineFrame_t frame;
+	frame.context = context;
+	frame.resources = resources;
+	frame.pRegisters = context->pRegisters;
+	ShaderExecution_Begin( &frame.execution, context, laneMask, 0 );
+	pipeline->nativeMain( &frame );
+}
+
+//Body of every batch fiber: one batch of a workgroup each time the worker switches in
+static void Compute_BatchFiber( void * pArgument ) {
+	computeBatch_t * batch = reinterpret_cast< computeBatch_t * >( pArgument );
+	for ( ;; ) {
+		const uint32 laneMask = Compute_BeginBatch( batch->pipeline, batch->context->pRegisters, batch->first, batch->pWorkgroupId );
+		Compute_RunBatch( batch->pipeline, batch->context, laneMask, batch->resources );
+		batch->done = true;
+		Platform_SwitchFiber( &batch->fiber, batch->pWorkerFiber );
+	}
+}
+
+static void Compute_Barrier( void * pArgument ) {
+	computeBatch_t * batch = reinterpret_cast< computeBatch_t * >( pArgument );
+	Platform_SwitchFiber( &batch->fiber, batch->pWorkerFiber );
+}
+
+static void Compute_RunWorkgroup( const computePipeline_t * pipeline, uint32 workerIndex, const uint32 workgroupId[ 3 ], const uint32 workgroupCount[ 3 ], const shaderResources_t * resources ) {
+	shaderContext_t * pContexts = &pipeline->pContexts[ workerIndex * pipeline->contextsPerWorker ];
+	for ( uint32 i = 0; i < pipeline->contextsPerWorker; i++ ) {
+		for ( uint32 c = 0; c < 3; c++ ) {
+			Pipeline_Broadcast( pContexts[ i ].pRegisters, pipeline->workgroupRegisters[ c ], workgroupId[ c ] );
+			Pipeline_Broadcast( pContexts[ i ].pRegisters, pipeline->workgroupCountRegisters[ c ], workgroupCount[ c ] );
+		}
+	}
+	if ( pipeline->pWorkers == NULL ) {
+		for ( uint32 b = 0; b < pipeline->batchCount; b++ ) {
+			const uint32 laneMask = Compute_BeginBatch( pipeline, pContexts->pRegisters, b * SHADER_LANES, workgroupId );
+			Compute_RunBatch( pipeline, pContexts, laneMask, resources );
+		}
+		return;
+	}
+	computeWorker_t * worker = &pipeline->pWorkers[ workerIndex ];
+	for ( uint32 b = 0; b < pipeline->batchCount; b++ ) {
+		computeBatch_t * batch = &worker->batches[ b ];
+		batch->pWorkgroupId = workgroupId;
+		batch->resources = resources;
+		batch->done = false;
+	}
+	//Each pass takes every batch still running on to its next barrier, or to its end
+	for ( bool running = true; running; ) {
+		running = false;
+		for ( uint32 b = 0; b < pipeline->batchCount; b++ ) {
+			computeBatch_t * batch = &worker->batches[ b ];
+			if ( !batch->done ) {
+				Platform_SwitchFiber( &worker->thread, &batch->fiber );
+				running = running || !batch->done;
+			}
+		}
+	}
+}
+
+VkResult ComputePipeline_Init( computePipeline_t * pipeline, const VkComputePipelineCreateInfo * pCreateInfo, const shaderModule_t * module, pipelineCache_t * cache, uint32 workerCount, cpuIsa_t isa, const VkAllocationCallbacks * allocator ) {
+	memset( pipeline, 0, sizeof( computePipeline_t ) );
+	pipeline->allocator = allocator;
+	pipeline->workerCount = workerCount;
+	const VkPipelineShaderStageCreateInfo & stage = pCreateInfo->stage;
+	if ( stage.stage != VK_SHADER_STAGE_COMPUTE_BIT ) {
+		return VK_ERROR_VALIDATION_FAILED_EXT;
+	}
+	if ( !PipelineCache_BuildProgram( cache, &pipeline->program, module, VK_SHADER_STAGE_COMPUTE_BIT, stage.pName, stage.pSpecializationInfo, allocator ) ) {
+		ComputePipeline_Shutdown( pipeline );
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+	const shaderProgram_t * program = &pipeline->program;
+	for ( uint32 c = 0; c < 3; c++ ) {
+		pipeline->localInvocationRegisters[ c ] = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::LOCAL_INVOCATION_ID, c );
+		pipeline->globalInvocationRegisters[ c ] = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::GLOBAL_INVOCATION_ID, c );
+		pipeline->workgroupRegisters[ c ] = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::WORKGROUP_ID, c );
+		pipeline->workgroupCountRegisters[ c ] = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::NUM_WORKGROUPS, c );
+	}
+	pipeline->localIndexRegister = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::LOCAL_INVOCATION_INDEX, 0 );
+	pipeline->subgroupIdRegister = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::SUBGROUP_ID, 0 );
+	pipeline->numSubgroupsRegister = ShaderProgram_FindBuiltIn( program, false, spvBuiltIn_t::NUM_SUBGROUPS, 0 );
+	pipeline->subgroupSize = Pipeline_SubgroupSize( isa );
+
+	const uint32 invocationCount = program->localSize[ 0 ] * program->localSize[ 1 ] * program->localSize[ 2 ];
+	pipeline->batchCount = ( invocationCount + SHADER_LANES - 1 ) / SHADER_LANES;
+	const bool fibers = ( program->flags & SHADER_PROGRAM_USES_BARRIERS ) != 0 && pipeline->batchCount > 1;
+	pipeline->contextsPerWorker = fibers ? pipeline->batchCount : 1;
+	pipeline->pContexts = Pipeline_CreateContexts( program, workerCount * pipeline->contextsPerWorker, pipeline->subgroupSize, allocator );
+	if ( pipeline->pContexts == NULL ) {
+		ComputePipeline_Shutdown( pipeline );
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	//Whole cache lines per worker, so neighbouring workers never share one
+	pipeline->workgroupMemoryStride = ( program->workgroupMemorySize + 63 ) & ~63u;
+	if ( pipeline->workgroupMemoryStride != 0 ) {
+		const size_t size = ( size_t )pipeline->workgroupMemoryStride * workerCount;
+		pipeline->pWorkgroupMemory = reinterpret_cast< uint8 * >( allocator->pfnAllocation( allocator->pUserData, size, 64, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+		if ( pipeline->pWorkgroupMemory == NULL ) {
+			ComputePipeline_Shutdown( pipeline );
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		memset( pipeline->pWorkgroupMemory, 0, size );
+	}
+	if ( fibers ) {
+		pipeline->pWorkers = reinterpret_cast< computeWorker_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( computeWorker_t ) * workerCount, 64, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+		if ( pipeline->pWorkers == NULL ) {
+			ComputePipeline_Shutdown( pipeline );
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		memset( pipeline->pWorkers, 0, sizeof( computeWorker_t ) * workerCount );
+	}
+	for ( uint32 w = 0; w < workerCount; w++ ) {
+		for ( uint32 i = 0; i < pipeline->contextsPerWorker; i++ ) {
+			shaderContext_t * context = &pipeline->pContexts[ w * pipeline->contextsPerWorker + i ];
+			context->pWorkgroupMemory = ( pipeline->pWorkgroupMemory != NULL ) ? pipeline->pWorkgroupMemory + ( size_t )w * pipeline->workgroupMemoryStride : NULL;
+			if ( !fibers ) {
+				continue;
+			}
+			computeBatch_t * batch = &pipeline->pWorkers[ w ].batches[ i ];
+			batch->pWorkerFiber = &pipeline->pWorkers[ w ].thread;
+			batch->pipeline = pipeline;
+			batch->context = context;
+			batch->first = i * SHADER_LANES;
+			context->barrier = Compute_Barrier;
+			context->pBarrierArgument = batch;
+			if ( !Platform_CreateFiber( Compute_BatchFiber, batch, COMPUTE_FIBER_STACK_SIZE, &batch->fiber ) ) {
+				ComputePipeline_Shutdown( pipeline );
+				return VK_ERROR_OUT_OF_HOST_MEMORY;
+			}
+		}
+	}
+	if ( Pipeline_UseJit() ) {
+		Jit_CompileComputePipeline( pipeline, isa );
+	}
+	return VK_SUCCESS;
+}
+
+void ComputePipeline_Shutdown( computePipeline_t * pipeline ) {
+	if ( pipeline->allocator == NULL ) {
+		return;
+	}
+	if ( pipeline->pWorkers != NULL ) {
+		for ( uint32 w = 0; w < pipeline->workerCount; w++ ) {
+			for ( uint32 b = 0; b < pipeline->batchCount; b++ ) {
+				Platform_DestroyFiber( &pipeline->pWorkers[ w ].batches[ b ].fiber );
+			}
+		}
+		pipeline->allocator->pfnFree( pipeline->allocator->pUserData, pipeline->pWorkers );
+	}
+	if ( pipeline->pWorkgroupMemory != NULL ) {
+		pipeline->allocator->pfnFree( pipeline->allocator->pUserData, pipeline->pWorkgroupMemory );
+	}
+	Pipeline_DestroyContexts( pipeline->pContexts, pipeline->workerCount * pipeline->contextsPerWorker, pipeline->allocator );
+	ShaderProgram_Destroy( &pipeline->program );
+	Platform_UnmapMemory( &pipeline->nativeCode );
+	memset( pipeline, 0, sizeof( computePipeline_t ) );
+}
+
+//A worker becomes a fiber for the whole run rather than for each workgroup
+void ComputePipeline_RunWorkgroups( const computePipeline_t * pipeline, uint32 workerIndex, uint64 first, uint64 end, const uint32 workgroupCount[ 3 ], const shaderResources_t * resources ) {
+	computeWorker_t * worker = ( pipeline->pWorkers != NULL ) ? &pipeline->pWorkers[ workerIndex ] : NULL;
+	if ( worker != NULL && !Platform_ThreadToFiber( &worker->thread ) ) {
+		return;
+	}
+	const uint64 sliceSize = ( uint64 )workgroupCount[ 0 ] * workgroupCount[ 1 ];
+	for ( uint64 group = first; group < end; group++ ) {
+		const uint32 workgroupId[ 3 ] = {
+			( uint32 )( group % workgroupCount[ 0 ] ),
+			( uint32 )( ( group / workgroupCount[ 0 ] ) % workgroupCount[ 1 ] ),
+			( uint32 )( group / sliceSize )
+		};
+		Compute_RunWorkgroup( pipeline, workerIndex, workgroupId, workgroupCount, resources );
+	}
+	if ( worker != NULL ) {
+		Platform_FiberToThread( &worker->thread );
+	}
+}
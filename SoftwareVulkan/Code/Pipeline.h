@@ -0,0 +1,224 @@
+#pragma once
+
+#include "Common.h"
+#include "Cpu.h"
+#include "Platform.h"
+#include "PipelineCache.h"
+#include "Rasterizer.h"
+#include "Shader.h"
+#include "vulkan/vulkan.h"
+
+//Match maxVertexInputBindings and maxVertexInputAttributes
+#define PIPELINE_MAX_VERTEX_BINDINGS 32
+#define PIPELINE_MAX_VERTEX_ATTRIBUTES 32
+
+enum class vertexComponentKind_t : uint32 {
+	FLOAT,
+	UNORM,
+	SNORM,
+	UINT,
+	SINT
+};
+
+//How one attribute is read: componentCount components of componentBytes each, swizzled from BGRA when bgra is set
+struct vertexFormat_t {
+	VkFormat				format;
+	uint32					componentCount;
+	uint32					componentBytes;
+	vertexComponentKind_t	kind;
+	bool					bgra;
+};
+
+//NULL for formats that cannot be used as vertex attributes
+const vertexFormat_t *	Pipeline_FindVertexFormat( VkFormat format );
+
+struct pipelineVertexBinding_t {
+	uint32				stride;
+	VkVertexInputRate	inputRate;
+};
+
+struct pipelineVertexAttribute_t {
+	uint32					binding;
+	uint32					offset;
+	const vertexFormat_t *	format;
+	uint32					registers[ 4 ];		//vertex shader input register of each component, SHADER_NO_REGISTER when unused
+};
+
+//What a draw binds: vertex buffers at their bound offsets and the resources of each stage
+struct pipelineBindings_t {
+	const uint8 *		pVertexBuffers[ PIPELINE_MAX_VERTEX_BINDINGS ];
+	shaderResources_t	vertexResources;
+	shaderResources_t	fragmentResources;
+};
+
+/*
+================================================
+pipelineFrame_t
+
+State shared between a stage's C entry point and its compiled body, which receives a pointer to it and
+addresses every field by offset.  The entry point fills in the per-call inputs, starts the execution
+masks, calls the compiled code and picks up the results.
+================================================
+*/
+struct pipelineFrame_t {
+	shaderExecution_t			execution;
+	alignas( 16 ) uint32		vertexIndices[ SHADER_LANES ];			//padded out to every lane with the first index
+	alignas( 16 ) float			z[ SHADER_LANES ];						//interpolated, or shader written, fragment depth
+	alignas( 16 ) float			blendSource[ 4 ][ 4 ];					//scratch for the group being blended
+	alignas( 16 ) float			blendDestination[ 4 ][ 4 ];
+	const uint8 *				pVertexAddresses[ SHADER_LANES ];
+	shaderContext_t *			context;
+	const shaderResources_t *	resources;
+	shaderRegister_t *			pRegisters;
+	const pipelineBindings_t *	bindings;
+	//Vertex stage
+	uint32						vertexCount;
+	uint32						instanceIndex;
+	float *						pOutput;
+	//Fragment stage
+	const float *				pPlanes;
+	rasterFragmentBatch_t *		batch;
+	float						planeX;				//block origin pixel centre relative to the triangle's plane origin
+	float						planeY;
+	float						fragmentX;			//block origin pixel centre in framebuffer coordinates
+	float						fragmentY;
+	uint32						coverageMask;
+	uint32						frontFacing;		//all ones or zero
+};
+
+typedef void ( * pipelineNativeFunc_t )( pipelineFrame_t * frame );
+
+struct pipelineColorBlend_t {
+	bool					enable;
+	VkBlendFactor			srcColorFactor;
+	VkBlendFactor			dstColorFactor;
+	VkBlendOp				colorOp;
+	VkBlendFactor			srcAlphaFactor;
+	VkBlendFactor			dstAlphaFactor;
+	VkBlendOp				alphaOp;
+	VkColorComponentFlags	writeMask;
+	float					constants[ 4 ];
+};
+
+//Bit offset of each RGBA channel in a packed color target texel; false for formats the fragment stage cannot write
+bool	Pipeline_ColorChannelShifts( VkFormat format, uint32 * pShifts );
+//Lanes in a subgroup: the float lanes of the widest vector registers isa has, which is what the device reports
+uint32	Pipeline_SubgroupSize( cpuIsa_t isa );
+
+/*
+================================================
+graphicsPipeline_t
+
+The two shader stages with everything fixed-function folded in: vertex fetch ahead of the vertex shader,
+and interpolation, depth test, blending and packing to the target format around the fragment shader.
+Stages run through compiled x86-64 code when the JIT accepts the pipeline and through the interpreter
+otherwise; both take the same per-worker shader contexts, indexed by the rasterizer's workerIndex.
+================================================
+*/
+struct graphicsPipeline_t {
+	const VkAllocationCallbacks *	allocator;
+	rasterPipeline_t				raster;
+	shaderProgram_t					vertexProgram;
+	shaderProgram_t					fragmentProgram;
+
+	pipelineVertexBinding_t			vertexBindings[ PIPELINE_MAX_VERTEX_BINDINGS ];
+	pipelineVertexAttribute_t		vertexAttributes[ PIPELINE_MAX_VERTEX_ATTRIBUTES ];
+	uint32							vertexAttributeCount;
+	uint32							vertexIndexRegister;
+	uint32							instanceIndexRegister;
+	uint32							positionRegisters[ 4 ];
+	uint32							varyingRegisters[ RASTER_MAX_VARYINGS ];		//vertex output behind each varying
+	uint32							fragmentVaryingRegisters[ RASTER_MAX_VARYINGS ];//fragment input each varying feeds
+	uint32							fragCoordRegisters[ 4 ];
+	uint32							frontFacingRegister;
+	uint32							fragDepthRegister;
+	uint32							colorRegisters[ 4 ];							//fragment output location 0
+
+	bool							depthTest;
+	bool							depthWrite;
+	VkCompareOp						depthCompare;
+	rasterDepthEncoding_t			depthEncoding;		//fragment depth is rounded to a fixed-point target's steps before testing
+	bool							earlyFragmentTests;	//test and write depth ahead of the shader
+	bool							earlyDepthReject;	//test without writing ahead of a shader that may still discard, then test again after it
+	VkFormat						colorFormat;
+	pipelineColorBlend_t			blend;
+
+	uint32							workerCount;
+	uint32							subgroupSize;
+	shaderContext_t *				pVertexContexts;
+	shaderContext_t *				pFragmentContexts;
+	platformMapping_t				nativeCode;
+	pipelineNativeFunc_t			nativeVertex;
+	pipelineNativeFunc_t			nativeFragment;
+};
+
+//Formats of the subpass the pipeline renders in; VK_FORMAT_UNDEFINED when it has no such attachment
+struct pipelineTargetFormats_t {
+	VkFormat	color;
+	VkFormat	depth;
+};
+
+//pModules holds the shader module of each stage in pCreateInfo->pStages order; cache may be NULL
+VkResult	GraphicsPipeline_Init( graphicsPipeline_t * pipeline, const VkGraphicsPipelineCreateInfo * pCreateInfo, const shaderModule_t * const * pModules, pipelineCache_t * cache, const pipelineTargetFormats_t & targetFormats, uint32 workerCount, cpuIsa_t isa, const VkAllocationCallbacks * allocator );
+void		GraphicsPipeline_Shutdown( graphicsPipeline_t * pipeline );
+
+/*
+================================================
+computePipeline_t
+
+A workgroup runs as batches of SHADER_LANES invocations on one worker, with its workgroup variables in
+a region of that worker's own that stays in cache from one workgroup to the next.  Without barriers the
+batches run one after another on a single context.  With them, each batch gets registers and a fiber of
+its own: a barrier switches back to the worker, which resumes the batches round robin, so every batch
+reaches a barrier before any goes on past it and no batch ever needs a thread of its own.
+================================================
+*/
+#define COMPUTE_MAX_BATCHES ( SHADER_MAX_WORKGROUP_INVOCATIONS / SHADER_LANES )
+//Reserved per batch fiber; the interpreter, compiled code and samplers stay far below it
+#define COMPUTE_FIBER_STACK_SIZE ( 256 * 1024 )
+
+struct computePipeline_t;
+
+struct computeBatch_t {
+	platformFiber_t				fiber;
+	platformFiber_t *			pWorkerFiber;		//resumed at every barrier and once the batch is done
+	const computePipeline_t *	pipeline;
+	shaderContext_t *			context;
+	uint32						first;				//local invocation index of lane 0
+	const uint32 *				pWorkgroupId;
+	const shaderResources_t *	resources;
+	bool						done;
+};
+
+struct computeWorker_t {
+	platformFiber_t				thread;
+	computeBatch_t				batches[ COMPUTE_MAX_BATCHES ];
+};
+
+struct computePipeline_t {
+	const VkAllocationCallbacks *	allocator;
+	shaderProgram_t					program;
+	uint32							localInvocationRegisters[ 3 ];
+	uint32							globalInvocationRegisters[ 3 ];
+	uint32							workgroupRegisters[ 3 ];
+	uint32							workgroupCountRegisters[ 3 ];
+	uint32							localIndexRegister;
+	uint32							subgroupIdRegister;
+	uint32							numSubgroupsRegister;
+
+	uint32							workerCount;
+	uint32							subgroupSize;
+	uint32							batchCount;				//per workgroup
+	uint32							contextsPerWorker;		//batchCount when batches meet at barriers, else 1
+	shaderContext_t *				pContexts;
+	uint8 *							pWorkgroupMemory;		//workgroupMemoryStride bytes per worker
+	uint32							workgroupMemoryStride;
+	computeWorker_t *				pWorkers;				//NULL when the batches never meet
+	platformMapping_t				nativeCode;
+	pipelineNativeFunc_t			nativeMain;
+};
+
+VkResult	ComputePipeline_Init( computePipeline_t * pipeline, const VkComputePipelineCreateInfo * pCreateInfo, const shaderModule_t * module, pipelineCache_t * cache, uint32 workerCount, cpuIsa_t isa, const VkAllocationCallbacks * allocator );
+void		ComputePipeline_Shutdown( computePipeline_t * pipeline );
+//Runs workgroups first .. end - 1 of a dispatch, counting with x fastest, on the contexts of workerIndex
+void		ComputePipeline_RunWorkgroups( const computePipeline_t * pipeline, uint32 workerIndex, uint64 first, uint64 end, const uint32 workgroupCount[ 3 ], const shaderResources_t * resources );
@@ -0,0 +1,469 @@
+#include "PipelineCache.h"
+#include <string.h>
+
+#define PIPELINE_CACHE_PROGRAM_ARRAYS 7
+
+static uint64 PipelineCache_Align( uint64 size ) {
+	return ( size + PIPELINE_CACHE_ALIGNMENT - 1 ) & ~( uint64 )( PIPELINE_CACHE_ALIGNMENT - 1 );
+}
+
+/*
+================================================
+Hashing
+
+Two independent 64-bit streams over the same bytes: FNV-1a and a multiply-xorshift mix.  Keys use both
+halves, so a false hit needs a 128-bit collision; the blob checksum uses the first.
+================================================
+*/
+struct pipelineCacheHash_t {
+	uint64	h[ 2 ];
+};
+
+static void PipelineCache_HashBegin( pipelineCacheHash_t * hash ) {
+	hash->h[ 0 ] = 14695981039346656037ULL;
+	hash->h[ 1 ] = 0x9E3779B97F4A7C15ULL;
+}
+
+static void PipelineCache_HashBytes( pipelineCacheHash_t * hash, const void * pData, size_t size ) {
+	const uint8 * pBytes = reinterpret_cast< const uint8 * >( pData );
+	uint64 h0 = hash->h[ 0 ];
+	uint64 h1 = hash->h[ 1 ];
+	for ( size_t i = 0; i < size; i++ ) {
+		h0 = ( h0 ^ pBytes[ i ] ) * 1099511628211ULL;
+		h1 = ( h1 ^ pBytes[ i ] ) * 0xBF58476D1CE4E5B9ULL;
+		h1 ^= h1 >> 29;
+	}
+	hash->h[ 0 ] = h0;
+	hash->h[ 1 ] = h1;
+}
+
+//Everything ShaderProgram_Build reads: the module, the stage, the entry point name and the specialization
+static void PipelineCache_ProgramKey( const shaderModule_t * module, VkShaderStageFlagBits stage, const char * pEntryName, const VkSpecializationInfo * pSpecializationInfo, uint64 key[ 2 ] ) {
+	pipelineCacheHash_t hash;
+	PipelineCache_HashBegin( &hash );
+	PipelineCache_HashBytes( &hash, module->pWords, sizeof( uint32 ) * module->wordCount );
+	const uint32 stageWord = ( uint32 )stage;
+	PipelineCache_HashBytes( &hash, &stageWord, sizeof( stageWord ) );
+	PipelineCache_HashBytes( &hash, pEntryName, strlen( pEntryName ) + 1 );
+	if ( pSpecializationInfo != NULL ) {
+		for ( uint32 i = 0; i < pSpecializationInfo->mapEntryCount; i++ ) {
+			const VkSpecializationMapEntry & entry = pSpecializationInfo->pMapEntries[ i ];
+			const uint32 words[] = { entry.constantID, entry.offset, ( uint32 )entry.size };
+			PipelineCache_HashBytes( &hash, words, sizeof( words ) );
+		}
+		PipelineCache_HashBytes( &hash, pSpecializationInfo->pData, pSpecializationInfo->dataSize );
+	}
+	key[ 0 ] = hash.h[ 0 ];
+	key[ 1 ] = hash.h[ 1 ];
+}
+
+static uint64 PipelineCache_Checksum( const uint8 * pData, size_t size ) {
+	pipelineCacheHash_t hash;
+	PipelineCache_HashBegin( &hash );
+	PipelineCache_HashBytes( &hash, pData, size );
+	return hash.h[ 0 ];
+}
+
+uint32 PipelineCache_Fingerprint( cpuIsa_t isa ) {
+	const uint32 architecture = CPU_X86 ? 1 : 0;
+	return ( uint32 )isa | ( uint32 )sizeof( void * ) << 8 | architecture << 16;
+}
+
+/*
+================================================
+Records
+================================================
+*/
+struct pipelineCacheArray_t {
+	void **		ppData;
+	uint32 *	pCount;
+	size_t		elementSize;
+};
+
+//The variable-length parts of a program, in record order
+static void PipelineCache_ProgramArrays( shaderProgram_t * program, pipelineCacheArray_t * pArrays ) {
+	const pipelineCacheArray_t arrays[ PIPELINE_CACHE_PROGRAM_ARRAYS ] = {
+		{ reinterpret_cast< void ** >( &program->pInstructions ),	&program->instructionCount,		sizeof( shaderInstruction_t ) },
+		{ reinterpret_cast< void ** >( &program->pConstants ),		&program->constantCount,		sizeof( uint32 ) },
+		{ reinterpret_cast< void ** >( &program->pInputs ),			&program->inputCount,			sizeof( shaderInterface_t ) },
+		{ reinterpret_cast< void ** >( &program->pOutputs ),		&program->outputCount,			sizeof( shaderInterface_t ) },
+		{ reinterpret_cast< void ** >( &program->pBindings ),		&program->bindingCount,			sizeof( shaderBinding_t ) },
+		{ reinterpret_cast< void ** >( &program->pBufferAccesses ),	&program->bufferAccessCount,	sizeof( shaderBufferAccess_t ) },
+		{ reinterpret_cast< void ** >( &program->pSampleOps ),		&program->sampleOpCount,		sizeof( shaderSampleOp_t ) },
+	};
+	memcpy( pArrays, arrays, sizeof( arrays ) );
+}
+
+static uint64 PipelineCache_RecordSize( shaderProgram_t * program ) {
+	pipelineCacheArray_t arrays[ PIPELINE_CACHE_PROGRAM_ARRAYS ];
+	PipelineCache_ProgramArrays( program, arrays );
+	uint64 size = PipelineCache_Align( sizeof( pipelineCacheRecord_t ) );
+	for ( uint32 i = 0; i < PIPELINE_CACHE_PROGRAM_ARRAYS; i++ ) {
+		size += PipelineCache_Align( arrays[ i ].elementSize * *arrays[ i ].pCount );
+	}
+	return size;
+}
+
+//pRecord holds PipelineCache_RecordSize bytes
+static void PipelineCache_WriteRecord( shaderProgram_t * program, uint8 * pRecord ) {
+	pipelineCacheArray_t arrays[ PIPELINE_CACHE_PROGRAM_ARRAYS ];
+	PipelineCache_ProgramArrays( program, arrays );
+	pipelineCacheRecord_t * record = reinterpret_cast< pipelineCacheRecord_t * >( pRecord );
+	memset( pRecord, 0, PipelineCache_RecordSize( program ) );
+	record->stage = ( uint32 )program->stage;
+	record->flags = program->flags;
+	memcpy( record->localSize, program->localSize, sizeof( record->localSize ) );
+	record->registerCount = program->registerCount;
+	record->frameDepth = program->frameDepth;
+	record->workgroupMemorySize = program->workgroupMemorySize;
+	uint64 offset = PipelineCache_Align( sizeof( pipelineCacheRecord_t ) );
+	for ( uint32 i = 0; i < PIPELINE_CACHE_PROGRAM_ARRAYS; i++ ) {
+		const size_t bytes = arrays[ i ].elementSize * *arrays[ i ].pCount;
+		record->counts[ i ] = *arrays[ i ].pCount;
+		if ( bytes > 0 ) {
+			memcpy( pRecord + offset, *arrays[ i ].ppData, bytes );
+		}
+		offset += PipelineCache_Align( bytes );
+	}
+}
+
+//Rebuilds a program from a record of size bytes; false when the record is inconsistent or memory runs out
+static bool PipelineCache_ReadRecord( shaderProgram_t * program, const uint8 * pRecord, uint64 size, const VkAllocationCallbacks * allocator ) {
+	memset( program, 0, sizeof( shaderProgram_t ) );
+	if ( size < sizeof( pipelineCacheRecord_t ) ) {
+		return false;
+	}
+	const pipelineCacheRecord_t * record = reinterpret_cast< const pipelineCacheRecord_t * >( pRecord );
+	program->allocator = allocator;
+	program->stage = ( VkShaderStageFlagBits )record->stage;
+	program->flags = record->flags;
+	memcpy( program->localSize, record->localSize, sizeof( program->localSize ) );
+	program->registerCount = record->registerCount;
+	program->frameDepth = record->frameDepth;
+	program->workgroupMemorySize = record->workgroupMemorySize;
+
+	pipelineCacheArray_t arrays[ PIPELINE_CACHE_PROGRAM_ARRAYS ];
+	PipelineCache_ProgramArrays( program, arrays );
+	uint64 offset = PipelineCache_Align( sizeof( pipelineCacheRecord_t ) );
+	for ( uint32 i = 0; i < PIPELINE_CACHE_PROGRAM_ARRAYS; i++ ) {
+		const uint64 bytes = ( uint64 )arrays[ i ].elementSize * record->counts[ i ];
+		if ( offset + bytes > size ) {
+			ShaderProgram_Destroy( program );
+			return false;
+		}
+		*arrays[ i ].pCount = record->counts[ i ];
+		if ( bytes > 0 ) {
+			*arrays[ i ].ppData = allocator->pfnAllocation( allocator->pUserData, ( size_t )bytes, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT );
+			if ( *arrays[ i ].ppData == NULL ) {
+				ShaderProgram_Destroy( program );
+				return false;
+			}
+			memcpy( *arrays[ i ].ppData, pRecord + offset, ( size_t )bytes );
+		}
+		offset += PipelineCache_Align( bytes );
+	}
+	return true;
+}
+
+/*
+================================================
+Entries
+================================================
+*/
+static int PipelineCache_CompareKeys( const uint64 a[ 2 ], const uint64 b[ 2 ] ) {
+	if ( a[ 0 ] != b[ 0 ] ) {
+		return ( a[ 0 ] < b[ 0 ] ) ? -1 : 1;
+	}
+	if ( a[ 1 ] != b[ 1 ] ) {
+		return ( a[ 1 ] < b[ 1 ] ) ? -1 : 1;
+	}
+	return 0;
+}
+
+//Index of the first entry not below key
+static uint32 PipelineCache_LowerBound( const pipelineCache_t * cache, const uint64 key[ 2 ] ) {
+	uint32 first = 0;
+	uint32 count = cache->entryCount;
+	while ( count > 0 ) {
+		const uint32 half = count / 2;
+		if ( PipelineCache_CompareKeys( cache->pEntries[ first + half ].key, key ) < 0 ) {
+			first += half + 1;
+			count -= half + 1;
+		} else {
+			count = half;
+		}
+	}
+	return first;
+}
+
+static const pipelineCacheEntry_t * PipelineCache_Find( const pipelineCache_t * cache, const uint64 key[ 2 ] ) {
+	const uint32 index = PipelineCache_LowerBound( cache, key );
+	if ( index < cache->entryCount && PipelineCache_CompareKeys( cache->pEntries[ index ].key, key ) == 0 ) {
+		return &cache->pEntries[ index ];
+	}
+	return NULL;
+}
+
+//Takes ownership of pRecord when it returns true; false when the key is already present or memory runs out
+static bool PipelineCache_Insert( pipelineCache_t * cache, const uint64 key[ 2 ], const uint8 * pRecord, uint64 size, bool owned ) {
+	const uint32 index = PipelineCache_LowerBound( cache, key );
+	if ( index < cache->entryCount && PipelineCache_CompareKeys( cache->pEntries[ index ].key, key ) == 0 ) {
+		return false;
+	}
+	if ( cache->entryCount == cache->entryCapacity ) {
+		const uint32 newCapacity = ( cache->entryCapacity > 0 ) ? cache->entryCapacity * 2 : 16;
+		void * pNewEntries = cache->allocator->pfnReallocation( cache->allocator->pUserData, cache->pEntries, sizeof( pipelineCacheEntry_t ) * newCapacity, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT );
+		if ( pNewEntries == NULL ) {
+			return false;
+		}
+		cache->pEntries = reinterpret_cast< pipelineCacheEntry_t * >( pNewEntries );
+		cache->entryCapacity = newCapacity;
+	}
+	memmove( &cache->pEntries[ index + 1 ], &cache->pEntries[ index ], sizeof( pipelineCacheEntry_t ) * ( cache->entryCount - index ) );
+	pipelineCacheEntry_t * entry = &cache->pEntries[ index ];
+	entry->key[ 0 ] = key[ 0 ];
+	entry->key[ 1 ] = key[ 1 ];
+	entry->pRecord = pRecord;
+	entry->size = size;
+	entry->owned = owned;
+	cache->entryCount++;
+	return true;
+}
+
+static uint8 * PipelineCache_CopyRecord( pipelineCache_t * cache, const uint8 * pRecord, uint64 size ) {
+	uint8 * pCopy = reinterpret_cast< uint8 * >( cache->allocator->pfnAllocation( cache->allocator->pUserData, ( size_t )size, PIPELINE_CACHE_ALIGNMENT, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( pCopy != NULL ) {
+		memcpy( pCopy, pRecord, ( size_t )size );
+	}
+	return pCopy;
+}
+
+/*
+================================================
+Blobs
+================================================
+*/
+static bool PipelineCache_ValidateBlob( const pipelineCache_t * cache, const uint8 * pData, size_t size ) {
+	if ( size < sizeof( pipelineCacheBlobHeader_t ) ) {
+		return false;
+	}
+	const pipelineCacheBlobHeader_t * header = reinterpret_cast< const pipelineCacheBlobHeader_t * >( pData );
+	if ( memcmp( &header->vulkan, &cache->header, sizeof( pipelineCacheHeader_t ) ) != 0 ) {
+		return false;
+	}
+	if ( header->magic != PIPELINE_CACHE_MAGIC || header->formatVersion != PIPELINE_CACHE_FORMAT_VERSION || header->fingerprint != cache->fingerprint ) {
+		return false;
+	}
+	if ( header->size != size || header->entryCount > ( size - sizeof( pipelineCacheBlobHeader_t ) ) / sizeof( pipelineCacheBlobEntry_t ) ) {
+		return false;
+	}
+	if ( header->checksum != PipelineCache_Checksum( pData + sizeof( pipelineCacheBlobHeader_t ), size - sizeof( pipelineCacheBlobHeader_t ) ) ) {
+		return false;
+	}
+	const pipelineCacheBlobEntry_t * pEntries = reinterpret_cast< const pipelineCacheBlobEntry_t * >( header + 1 );
+	const uint64 recordsBegin = sizeof( pipelineCacheBlobHeader_t ) + sizeof( pipelineCacheBlobEntry_t ) * header->entryCount;
+	for ( uint32 i = 0; i < header->entryCount; i++ ) {
+		const pipelineCacheBlobEntry_t & entry = pEntries[ i ];
+		if ( entry.offset < recordsBegin || entry.offset % PIPELINE_CACHE_ALIGNMENT != 0 || entry.size > size || entry.offset > size - entry.size ) {
+			return false;
+		}
+		if ( i > 0 && PipelineCache_CompareKeys( pEntries[ i - 1 ].key, entry.key ) >= 0 ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+VkResult PipelineCache_Init( pipelineCache_t * cache, const VkPhysicalDeviceProperties & properties, cpuIsa_t isa, const void * pInitialData, size_t initialDataSize, const VkAllocationCallbacks * allocator ) {
+	memset( cache, 0, sizeof( pipelineCache_t ) );
+	cache->allocator = allocator;
+	Platform_MutexInit( &cache->mutex );
+	cache->header.headerSize = sizeof( pipelineCacheHeader_t );
+	cache->header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+	cache->header.vendorID = properties.vendorID;
+	cache->header.deviceID = properties.deviceID;
+	memcpy( cache->header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE );
+	cache->fingerprint = PipelineCache_Fingerprint( isa );
+	if ( pInitialData == NULL || initialDataSize == 0 ) {
+		return VK_SUCCESS;
+	}
+
+	//Copied once to an aligned allocation so records are read in place whatever alignment the caller's data has
+	cache->pInitialData = reinterpret_cast< uint8 * >( allocator->pfnAllocation( allocator->pUserData, initialDataSize, PIPELINE_CACHE_ALIGNMENT, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( cache->pInitialData == NULL ) {
+		PipelineCache_Shutdown( cache );
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	memcpy( cache->pInitialData, pInitialData, initialDataSize );
+	if ( !PipelineCache_ValidateBlob( cache, cache->pInitialData, initialDataSize ) ) {
+		Platform_DebugPrintf( "SoftwareVulkan: ignoring pipeline cache data from another device, build or format version\n" );
+		allocator->pfnFree( allocator->pUserData, cache->pInitialData );
+		cache->pInitialData = NULL;
+		return VK_SUCCESS;
+	}
+
+	const pipelineCacheBlobHeader_t * header = reinterpret_cast< const pipelineCacheBlobHeader_t * >( cache->pInitialData );
+	const pipelineCacheBlobEntry_t * pBlobEntries = reinterpret_cast< const pipelineCacheBlobEntry_t * >( header + 1 );
+	if ( header->entryCount > 0 ) {
+		cache->pEntries = reinterpret_cast< pipelineCacheEntry_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( pipelineCacheEntry_t ) * header->entryCount, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+		if ( cache->pEntries == NULL ) {
+			PipelineCache_Shutdown( cache );
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		cache->entryCapacity = header->entryCount;
+	}
+	//The blob table is already sorted, so the entries are taken over in order
+	for ( uint32 i = 0; i < header->entryCount; i++ ) {
+		pipelineCacheEntry_t * entry = &cache->pEntries[ i ];
+		entry->key[ 0 ] = pBlobEntries[ i ].key[ 0 ];
+		entry->key[ 1 ] = pBlobEntries[ i ].key[ 1 ];
+		entry->pRecord = cache->pInitialData + pBlobEntries[ i ].offset;
+		entry->size = pBlobEntries[ i ].size;
+		entry->owned = false;
+	}
+	cache->entryCount = header->entryCount;
+	return VK_SUCCESS;
+}
+
+void PipelineCache_Shutdown( pipelineCache_t * cache ) {
+	const VkAllocationCallbacks * allocator = cache->allocator;
+	if ( allocator == NULL ) {
+		return;
+	}
+	for ( uint32 i = 0; i < cache->entryCount; i++ ) {
+		if ( cache->pEntries[ i ].owned ) {
+			allocator->pfnFree( allocator->pUserData, const_cast< uint8 * >( cache->pEntries[ i ].pRecord ) );
+		}
+	}
+	allocator->pfnFree( allocator->pUserData, cache->pEntries );
+	allocator->pfnFree( allocator->pUserData, cache->pInitialData );
+	Platform_MutexDestroy( &cache->mutex );
+	memset( cache, 0, sizeof( pipelineCache_t ) );
+}
+
+bool PipelineCache_BuildProgram( pipelineCache_t * cache, shaderProgram_t * program, const shaderModule_t * module, VkShaderStageFlagBits stage, const char * pEntryName, const VkSpecializationInfo * pSpecializationInfo, const VkAllocationCallbacks * allocator ) {
+	if ( cache == NULL ) {
+		return ShaderProgram_Build( program, module, stage, pEntryName, pSpecializationInfo, allocator );
+	}
+	uint64 key[ 2 ];
+	PipelineCache_ProgramKey( module, stage, pEntryName, pSpecializationInfo, key );
+
+	Platform_MutexLock( &cache->mutex );
+	const pipelineCacheEntry_t * entry = PipelineCache_Find( cache, key );
+	const bool hit = ( entry != NULL ) && PipelineCache_ReadRecord( program, entry->pRecord, entry->size, allocator );
+	Platform_MutexUnlock( &cache->mutex );
+	if ( hit ) {
+		return true;
+	}
+
+	//Lowering runs unlocked; when two threads race on one key the second insert is dropped
+	if ( !ShaderProgram_Build( program, module, stage, pEntryName, pSpecializationInfo, allocator ) ) {
+		return false;
+	}
+	const uint64 size = PipelineCache_RecordSize( program );
+	uint8 * pRecord = reinterpret_cast< uint8 * >( cache->allocator->pfnAllocation( cache->allocator->pUserData, ( size_t )size, PIPELINE_CACHE_ALIGNMENT, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( pRecord == NULL ) {
+		return true;
+	}
+	PipelineCache_WriteRecord( program, pRecord );
+	Platform_MutexLock( &cache->mutex );
+	const bool inserted = PipelineCache_Insert( cache, key, pRecord, size, true );
+	Platform_MutexUnlock( &cache->mutex );
+	if ( !inserted ) {
+		cache->allocator->pfnFree( cache->allocator->pUserData, pRecord );
+	}
+	return true;
+}
+
+//Bytes of a blob holding the first count entries
+static uint64 PipelineCache_BlobSize( const pipelineCache_t * cache, uint32 count ) {
+	uint64 size = PipelineCache_Align( sizeof( pipelineCacheBlobHeader_t ) + sizeof( pipelineCacheBlobEntry_t ) * count );
+	for ( uint32 i = 0; i < count; i++ ) {
+		size += cache->pEntries[ i ].size;
+	}
+	return size;
+}
+
+VkResult PipelineCache_GetData( pipelineCache_t * cache, size_t * pDataSize, void * pData ) {
+	Platform_MutexLock( &cache->mutex );
+	if ( pData == NULL ) {
+		*pDataSize = ( size_t )PipelineCache_BlobSize( cache, cache->entryCount );
+		Platform_MutexUnlock( &cache->mutex );
+		return VK_SUCCESS;
+	}
+	if ( *pDataSize < sizeof( pipelineCacheBlobHeader_t ) ) {
+		Platform_MutexUnlock( &cache->mutex );
+		*pDataSize = 0;
+		return VK_INCOMPLETE;
+	}
+	//Entries go out in key order, so a short buffer gets the longest prefix that fits, still a valid blob
+	uint32 count = cache->entryCount;
+	uint64 size = PipelineCache_BlobSize( cache, count );
+	while ( size > *pDataSize ) {
+		count--;
+		size = PipelineCache_BlobSize( cache, count );
+	}
+
+	uint8 * pBytes = reinterpret_cast< uint8 * >( pData );
+	memset( pBytes, 0, ( size_t )size );
+	pipelineCacheBlobHeader_t * header = reinterpret_cast< pipelineCacheBlobHeader_t * >( pBytes );
+	pipelineCacheBlobEntry_t * pBlobEntries = reinterpret_cast< pipelineCacheBlobEntry_t * >( header + 1 );
+	header->vulkan = cache->header;
+	header->magic = PIPELINE_CACHE_MAGIC;
+	header->formatVersion = PIPELINE_CACHE_FORMAT_VERSION;
+	header->fingerprint = cache->fingerprint;
+	header->entryCount = count;
+	header->size = size;
+	uint64 offset = PipelineCache_Align( sizeof( pipelineCacheBlobHeader_t ) + sizeof( pipelineCacheBlobEntry_t ) * count );
+	for ( uint32 i = 0; i < count; i++ ) {
+		const pipelineCacheEntry_t & entry = cache->pEntries[ i ];
+		pBlobEntries[ i ].key[ 0 ] = entry.key[ 0 ];
+		pBlobEntries[ i ].key[ 1 ] = entry.key[ 1 ];
+		pBlobEntries[ i ].offset = offset;
+		pBlobEntries[ i ].size = entry.size;
+		memcpy( pBytes + offset, entry.pRecord, ( size_t )entry.size );
+		offset += entry.size;
+	}
+	header->checksum = PipelineCache_Checksum( pBytes + sizeof( pipelineCacheBlobHeader_t ), ( size_t )size - sizeof( pipelineCacheBlobHeader_t ) );
+	const bool complete = ( count == cache->entryCount );
+	Platform_MutexUnlock( &cache->mutex );
+	*pDataSize = ( size_t )size;
+	return complete ? VK_SUCCESS : VK_INCOMPLETE;
+}
+
+VkResult PipelineCache_Merge( pipelineCache_t * destination, pipelineCache_t * source ) {
+	if ( destination == source ) {
+		return VK_SUCCESS;
+	}
+	//Only one cache is locked at a time, so merges in opposite directions cannot deadlock
+	VkResult result = VK_SUCCESS;
+	Platform_MutexLock( &source->mutex );
+	pipelineCacheEntry_t * pCopies = NULL;
+	const uint32 count = source->entryCount;
+	if ( count > 0 ) {
+		pCopies = reinterpret_cast< pipelineCacheEntry_t * >( destination->allocator->pfnAllocation( destination->allocator->pUserData, sizeof( pipelineCacheEntry_t ) * count, 8, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ) );
+	}
+	if ( count > 0 && pCopies == NULL ) {
+		Platform_MutexUnlock( &source->mutex );
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	for ( uint32 i = 0; i < count; i++ ) {
+		pCopies[ i ] = source->pEntries[ i ];
+		pCopies[ i ].pRecord = PipelineCache_CopyRecord( destination, source->pEntries[ i ].pRecord, source->pEntries[ i ].size );
+		pCopies[ i ].owned = true;
+		if ( pCopies[ i ].pRecord == NULL ) {
+			result = VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+	Platform_MutexUnlock( &source->mutex );
+
+	Platform_MutexLock( &destination->mutex );
+	for ( uint32 i = 0; i < count; i++ ) {
+		if ( pCopies[ i ].pRecord != NULL && !PipelineCache_Insert( destination, pCopies[ i ].key, pCopies[ i ].pRecord, pCopies[ i ].size, true ) ) {
+			destination->allocator->pfnFree( destination->allocator->pUserData, const_cast< uint8 * >( pCopies[ i ].pRecord ) );
+		}
+	}
+	Platform_MutexUnlock( &destination->mutex );
+	destination->allocator->pfnFree( destination->allocator->pUserData, pCopies );
+	return result;
+}
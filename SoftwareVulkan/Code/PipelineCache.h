@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common.h"
+#include "Cpu.h"
+#include "Platform.h"
+#include "Shader.h"
+#include "vulkan/vulkan.h"
+
+//Bump whenever shader lowering or the layout of any serialized struct changes, so stale blobs are dropped
+#define PIPELINE_CACHE_FORMAT_VERSION 4
+#define PIPELINE_CACHE_MAGIC ( 'S' | 'V' << 8 | 'P' << 16 | 'C' << 24 )
+//Every record and every array inside one starts on this boundary
+#define PIPELINE_CACHE_ALIGNMENT 16
+
+/*
+Blob layout, all native endian.  It opens with the header every Vulkan pipeline cache starts with, then:
+
+	pipelineCacheBlobHeader_t
+	pipelineCacheBlobEntry_t[ entryCount ]		sorted by key
+	records										one per entry, each at a PIPELINE_CACHE_ALIGNMENT offset
+
+A record is a pipelineCacheRecord_t followed by the arrays of one shaderProgram_t, each aligned, so a
+validated blob is used in place: lookups binary search the entry table and a hit copies the arrays out.
+*/
+struct pipelineCacheHeader_t {
+	uint32	headerSize;
+	uint32	headerVersion;					//VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+	uint32	vendorID;
+	uint32	deviceID;
+	uint8	pipelineCacheUUID[ VK_UUID_SIZE ];
+};
+
+struct pipelineCacheBlobHeader_t {
+	pipelineCacheHeader_t	vulkan;
+	uint32					magic;
+	uint32					formatVersion;
+	uint32					fingerprint;		//PipelineCache_Fingerprint of the device that wrote the blob
+	uint32					entryCount;
+	uint64					size;				//whole blob, header included
+	uint64					checksum;			//of everything past the header
+};
+
+struct pipelineCacheBlobEntry_t {
+	uint64	key[ 2 ];
+	uint64	offset;
+	uint64	size;
+};
+
+struct pipelineCacheRecord_t {
+	uint32	stage;
+	uint32	flags;
+	uint32	localSize[ 3 ];
+	uint32	registerCount;
+	uint32	frameDepth;
+	uint32	workgroupMemorySize;
+	uint32	counts[ 7 ];					//instructions, constants, inputs, outputs, bindings, buffer accesses, sample ops
+};
+
+struct pipelineCacheEntry_t {
+	uint64			key[ 2 ];				//hash of the module words, stage, entry point name and specialization
+	const uint8 *	pRecord;
+	uint64			size;
+	bool			owned;					//false for records inside the initial data
+};
+
+/*
+================================================
+pipelineCache_t
+
+Lowered shader programs keyed on everything lowering reads.  Native code is not stored: it embeds the
+addresses of the interpreter entry points and its constant pool, and the code generator is a single pass
+that costs far less than the SPIR-V lowering it follows.  Internally synchronized, as VkPipelineCache is.
+================================================
+*/
+struct pipelineCache_t {
+	const VkAllocationCallbacks *	allocator;
+	platformMutex_t					mutex;
+	pipelineCacheHeader_t			header;
+	uint32							fingerprint;
+	uint8 *							pInitialData;		//aligned copy of the creation data when it validated
+	pipelineCacheEntry_t *			pEntries;			//sorted by key
+	uint32							entryCount;
+	uint32							entryCapacity;
+};
+
+//Processor architecture, pointer width and SIMD level; blobs only load on a device with the same fingerprint
+uint32		PipelineCache_Fingerprint( cpuIsa_t isa );
+//Initial data that fails validation is ignored and the cache starts empty, as the specification asks
+VkResult	PipelineCache_Init( pipelineCache_t * cache, const VkPhysicalDeviceProperties & properties, cpuIsa_t isa, const void * pInitialData, size_t initialDataSize, const VkAllocationCallbacks * allocator );
+void		PipelineCache_Shutdown( pipelineCache_t * cache );
+//ShaderProgram_Build through the cache; cache may be NULL
+bool		PipelineCache_BuildProgram( pipelineCache_t * cache, shaderProgram_t * program, const shaderModule_t * module, VkShaderStageFlagBits stage, const char * pEntryName, const VkSpecializationInfo * pSpecializationInfo, const VkAllocationCallbacks * allocator );
+//vkGetPipelineCacheData semantics: size query when pData is NULL, VK_INCOMPLETE when only some entries fit
+VkResult	PipelineCache_GetData( pipelineCache_t * cache, size_t * pDataSize, void * pData );
+VkResult	PipelineCache_Merge( pipelineCache_t * destination, pipelineCache_t * source );
@@ -0,0 +1,591 @@
+#include "Platform.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#pragma comment( lib, "Synchronization" )
+#else
+#include <pthread.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#if defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+static size_t AlignSize( size_t size, size_t alignment ) {
+	return ( size + alignment - 1 ) & ~( alignment - 1 );
+}
+
+#if defined( _WIN32 )
+
+size_t Platform_PageSize() {
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo( &systemInfo );
+	return systemInfo.dwPageSize;
+}
+
+size_t Platform_LargePageSize() {
+	return GetLargePageMinimum();
+}
+
+//MEM_LARGE_PAGES needs SeLockMemoryPrivilege; enabling it only succeeds if the account already holds the right
+static bool EnableLockMemoryPrivilege() {
+	static int enabled = -1;
+	if ( enabled != -1 ) {
+		return enabled != 0;
+	}
+	enabled = 0;
+	HANDLE token;
+	if ( !OpenProcessToken( GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token ) ) {
+		return false;
+	}
+	TOKEN_PRIVILEGES privileges;
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[ 0 ].Attributes = SE_PRIVILEGE_ENABLED;
+	if ( LookupPrivilegeValueA( NULL, "SeLockMemoryPrivilege", &privileges.Privileges[ 0 ].Luid ) ) {
+		AdjustTokenPrivileges( token, FALSE, &privileges, 0, NULL, NULL );
+		enabled = ( GetLastError() == ERROR_SUCCESS ) ? 1 : 0;
+	}
+	CloseHandle( token );
+	return enabled != 0;
+}
+
+bool Platform_MapMemory( size_t size, bool largePages, platformMapping_t * pMapping ) {
+	size_t largePageSize = Platform_LargePageSize();
+	if ( largePages && largePageSize != 0 && EnableLockMemoryPrivilege() ) {
+		size_t largeSize = AlignSize( size, largePageSize );
+		void * base = VirtualAlloc( NULL, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+		if ( base != NULL ) {
+			pMapping->base = base;
+			pMapping->size = largeSize;
+			pMapping->largePages = true;
+			return true;
+		}
+	}
+	size_t pageSize = AlignSize( size, Platform_PageSize() );
+	void * base = VirtualAlloc( NULL, pageSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+	if ( base == NULL ) {
+		return false;
+	}
+	pMapping->base = base;
+	pMapping->size = pageSize;
+	pMapping->largePages = false;
+	return true;
+}
+
+void Platform_UnmapMemory( platformMapping_t * pMapping ) {
+	if ( pMapping->base != NULL ) {
+		VirtualFree( pMapping->base, 0, MEM_RELEASE );
+	}
+	memset( pMapping, 0, sizeof( *pMapping ) );
+}
+
+//VirtualAlloc reservations are already aligned to the 64KB allocation granularity
+bool Platform_ReserveMemory( size_t size, platformMapping_t * pMapping ) {
+	size_t reserveSize = AlignSize( size, PLATFORM_RESERVE_ALIGNMENT );
+	void * base = VirtualAlloc( NULL, reserveSize, MEM_RESERVE, PAGE_NOACCESS );
+	if ( base == NULL ) {
+		return false;
+	}
+	pMapping->base = base;
+	pMapping->size = reserveSize;
+	pMapping->largePages = false;
+	return true;
+}
+
+bool Platform_CommitMemory( void * address, size_t size ) {
+	return VirtualAlloc( address, size, MEM_COMMIT, PAGE_READWRITE ) != NULL;
+}
+
+bool Platform_ProtectExecutable( void * address, size_t size ) {
+	DWORD oldProtect;
+	if ( !VirtualProtect( address, size, PAGE_EXECUTE_READ, &oldProtect ) ) {
+		return false;
+	}
+	return FlushInstructionCache( GetCurrentProcess(), address, size ) != FALSE;
+}
+
+//A section backed by the paging file for "shm:", by the file otherwise; creating a file-backed section larger than the
+//file extends it, and an existing section larger than asked for is mapped whole
+bool Platform_MapShared( const char * name, size_t size, platformSharedMapping_t * pMapping ) {
+	HANDLE section = NULL;
+	if ( strncmp( name, "shm:", 4 ) == 0 ) {
+		section = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, ( DWORD )( ( uint64 )size >> 32 ), ( DWORD )size, name + 4 );
+	} else {
+		HANDLE file = CreateFileA( name, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+		if ( file == INVALID_HANDLE_VALUE ) {
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if ( GetFileSizeEx( file, &fileSize ) && ( uint64 )fileSize.QuadPart > ( uint64 )size ) {
+			size = ( size_t )fileSize.QuadPart;
+		}
+		section = CreateFileMappingA( file, NULL, PAGE_READWRITE, ( DWORD )( ( uint64 )size >> 32 ), ( DWORD )size, NULL );
+		CloseHandle( file );
+	}
+	if ( section == NULL ) {
+		return false;
+	}
+	void * base = MapViewOfFile( section, FILE_MAP_ALL_ACCESS, 0, 0, size );
+	if ( base == NULL ) {
+		CloseHandle( section );
+		return false;
+	}
+	pMapping->base = base;
+	pMapping->size = size;
+	pMapping->handle = reinterpret_cast< uint64 >( section );
+	return true;
+}
+
+void Platform_UnmapShared( platformSharedMapping_t * pMapping ) {
+	if ( pMapping->base != NULL ) {
+		UnmapViewOfFile( pMapping->base );
+		CloseHandle( reinterpret_cast< HANDLE >( pMapping->handle ) );
+	}
+	memset( pMapping, 0, sizeof( *pMapping ) );
+}
+
+static_assert( sizeof( SRWLOCK ) <= sizeof( platformMutex_t ), "platformMutex_t storage is too small" );
+
+void Platform_MutexInit( platformMutex_t * pMutex ) {
+	InitializeSRWLock( reinterpret_cast< SRWLOCK * >( pMutex->storage ) );
+}
+
+void Platform_MutexDestroy( platformMutex_t * ) {
+}
+
+void Platform_MutexLock( platformMutex_t * pMutex ) {
+	AcquireSRWLockExclusive( reinterpret_cast< SRWLOCK * >( pMutex->storage ) );
+}
+
+void Platform_MutexUnlock( platformMutex_t * pMutex ) {
+	ReleaseSRWLockExclusive( reinterpret_cast< SRWLOCK * >( pMutex->storage ) );
+}
+
+static DWORD WINAPI ThreadTrampoline( LPVOID pParameter ) {
+	platformThread_t * thread = reinterpret_cast< platformThread_t * >( pParameter );
+	thread->func( thread->pArgument );
+	return 0;
+}
+
+bool Platform_CreateThread( platformThreadFunc_t func, void * pArgument, platformThread_t * pThread ) {
+	pThread->func = func;
+	pThread->pArgument = pArgument;
+	HANDLE handle = CreateThread( NULL, 0, ThreadTrampoline, pThread, 0, NULL );
+	pThread->handle = reinterpret_cast< uint64 >( handle );
+	return handle != NULL;
+}
+
+void Platform_JoinThread( platformThread_t * pThread ) {
+	HANDLE handle = reinterpret_cast< HANDLE >( pThread->handle );
+	WaitForSingleObject( handle, INFINITE );
+	CloseHandle( handle );
+	pThread->handle = 0;
+}
+
+//Counts every processor group, so machines with more than 64 logical processors are not cut short
+uint32 Platform_ProcessorCount() {
+	return GetActiveProcessorCount( ALL_PROCESSOR_GROUPS );
+}
+
+void Platform_Yield() {
+	SwitchToThread();
+}
+
+static VOID WINAPI FiberTrampoline( LPVOID pParameter ) {
+	platformFiber_t * fiber = reinterpret_cast< platformFiber_t * >( pParameter );
+	fiber->func( fiber->pArgument );
+}
+
+bool Platform_CreateFiber( platformFiberFunc_t func, void * pArgument, size_t stackSize, platformFiber_t * pFiber ) {
+	memset( pFiber, 0, sizeof( *pFiber ) );
+	pFiber->func = func;
+	pFiber->pArgument = pArgument;
+	//Nothing committed up front; the stack grows page by page up to the reserve
+	LPVOID handle = CreateFiberEx( 0, stackSize, FIBER_FLAG_FLOAT_SWITCH, FiberTrampoline, pFiber );
+	pFiber->handle = reinterpret_cast< uint64 >( handle );
+	return handle != NULL;
+}
+
+void Platform_DestroyFiber( platformFiber_t * pFiber ) {
+	if ( pFiber->handle != 0 ) {
+		DeleteFiber( reinterpret_cast< LPVOID >( pFiber->handle ) );
+	}
+	memset( pFiber, 0, sizeof( *pFiber ) );
+}
+
+//A thread the application already runs as a fiber is used as it is and left that way
+bool Platform_ThreadToFiber( platformFiber_t * pFiber ) {
+	memset( pFiber, 0, sizeof( *pFiber ) );
+	if ( IsThreadAFiber() ) {
+		pFiber->handle = reinterpret_cast< uint64 >( GetCurrentFiber() );
+		return true;
+	}
+	LPVOID handle = ConvertThreadToFiberEx( NULL, FIBER_FLAG_FLOAT_SWITCH );
+	pFiber->handle = reinterpret_cast< uint64 >( handle );
+	pFiber->converted = handle != NULL;
+	return handle != NULL;
+}
+
+void Platform_FiberToThread( platformFiber_t * pFiber ) {
+	if ( pFiber->converted ) {
+		ConvertFiberToThread();
+	}
+	memset( pFiber, 0, sizeof( *pFiber ) );
+}
+
+void Platform_SwitchFiber( platformFiber_t *, platformFiber_t * pTo ) {
+	SwitchToFiber( reinterpret_cast< LPVOID >( pTo->handle ) );
+}
+
+bool Platform_FutexWait( std::atomic< uint32 > * pAddress, uint32 expected, uint64 timeoutNanoseconds ) {
+	DWORD milliseconds = INFINITE;
+	if ( timeoutNanoseconds != PLATFORM_WAIT_INFINITE ) {
+		milliseconds = ( DWORD )Min( ( timeoutNanoseconds + 999999 ) / 1000000, ( uint64 )( INFINITE - 1 ) );
+	}
+	if ( WaitOnAddress( pAddress, &expected, sizeof( expected ), milliseconds ) ) {
+		return true;
+	}
+	return GetLastError() != ERROR_TIMEOUT;
+}
+
+void Platform_FutexWake( std::atomic< uint32 > * pAddress, bool wakeAll ) {
+	if ( wakeAll ) {
+		WakeByAddressAll( pAddress );
+	} else {
+		WakeByAddressSingle( pAddress );
+	}
+}
+
+uint64 Platform_Nanoseconds() {
+	static LARGE_INTEGER frequency;
+	if ( frequency.QuadPart == 0 ) {
+		QueryPerformanceFrequency( &frequency );
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+	const uint64 seconds = ( uint64 )counter.QuadPart / ( uint64 )frequency.QuadPart;
+	const uint64 remainder = ( uint64 )counter.QuadPart % ( uint64 )frequency.QuadPart;
+	return seconds * 1000000000ULL + remainder * 1000000000ULL / ( uint64 )frequency.QuadPart;
+}
+
+void Platform_DebugPrintf( const char * fmt, ... ) {
+	char buffer[ 1024 ];
+	va_list args;
+	va_start( args, fmt );
+	vsnprintf( buffer, sizeof( buffer ), fmt, args );
+	va_end( args );
+	OutputDebugStringA( buffer );
+}
+
+#else
+
+size_t Platform_PageSize() {
+	return ( size_t )sysconf( _SC_PAGESIZE );
+}
+
+size_t Platform_LargePageSize() {
+	return 2 * 1024 * 1024;
+}
+
+bool Platform_MapMemory( size_t size, bool largePages, platformMapping_t * pMapping ) {
+#if defined( MAP_HUGETLB )
+	if ( largePages ) {
+		size_t largeSize = AlignSize( size, Platform_LargePageSize() );
+		void * base = mmap( NULL, largeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+		if ( base != MAP_FAILED ) {
+			pMapping->base = base;
+			pMapping->size = largeSize;
+			pMapping->largePages = true;
+			return true;
+		}
+	}
+#endif
+	size_t pageSize = AlignSize( size, Platform_PageSize() );
+	void * base = mmap( NULL, pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if ( base == MAP_FAILED ) {
+		return false;
+	}
+#if defined( MADV_HUGEPAGE )
+	//No reserved hugetlbfs pool; let transparent huge pages back the mapping where the kernel allows it
+	if ( largePages ) {
+		madvise( base, pageSize, MADV_HUGEPAGE );
+	}
+#endif
+	pMapping->base = base;
+	pMapping->size = pageSize;
+	pMapping->largePages = false;
+	return true;
+}
+
+void Platform_UnmapMemory( platformMapping_t * pMapping ) {
+	if ( pMapping->base != NULL ) {
+		munmap( pMapping->base, pMapping->size );
+	}
+	memset( pMapping, 0, sizeof( *pMapping ) );
+}
+
+//mmap only promises page alignment, so over-reserve and trim the slack on either side
+bool Platform_ReserveMemory( size_t size, platformMapping_t * pMapping ) {
+	size_t reserveSize = AlignSize( size, PLATFORM_RESERVE_ALIGNMENT );
+	size_t paddedSize = reserveSize + PLATFORM_RESERVE_ALIGNMENT;
+	void * padded = mmap( NULL, paddedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	if ( padded == MAP_FAILED ) {
+		return false;
+	}
+	uintptr_t start = reinterpret_cast< uintptr_t >( padded );
+	uintptr_t alignedStart = AlignSize( start, PLATFORM_RESERVE_ALIGNMENT );
+	if ( alignedStart != start ) {
+		munmap( padded, alignedStart - start );
+	}
+	size_t tail = ( start + paddedSize ) - ( alignedStart + reserveSize );
+	if ( tail != 0 ) {
+		munmap( reinterpret_cast< void * >( alignedStart + reserveSize ), tail );
+	}
+	pMapping->base = reinterpret_cast< void * >( alignedStart );
+	pMapping->size = reserveSize;
+	pMapping->largePages = false;
+	return true;
+}
+
+bool Platform_CommitMemory( void * address, size_t size ) {
+	return mprotect( address, size, PROT_READ | PROT_WRITE ) == 0;
+}
+
+bool Platform_ProtectExecutable( void * address, size_t size ) {
+	return mprotect( address, size, PROT_READ | PROT_EXEC ) == 0;
+}
+
+//The descriptor is not needed once the pages are mapped; the object itself stays until it is unlinked or deleted
+bool Platform_MapShared( const char * name, size_t size, platformSharedMapping_t * pMapping ) {
+	int fd;
+	if ( strncmp( name, "shm:", 4 ) == 0 ) {
+		//shm_open wants a single leading slash and no others
+		char objectName[ 256 ];
+		snprintf( objectName, sizeof( objectName ), "/%s", name + 4 + ( name[ 4 ] == '/' ? 1 : 0 ) );
+		fd = shm_open( objectName, O_RDWR | O_CREAT, 0600 );
+	} else {
+		fd = open( name, O_RDWR | O_CREAT, 0644 );
+	}
+	if ( fd < 0 ) {
+		return false;
+	}
+	struct stat status;
+	if ( fstat( fd, &status ) != 0 ) {
+		close( fd );
+		return false;
+	}
+	//Only ever grow: shrinking would fault any reader still mapping the old tail
+	if ( ( uint64 )status.st_size < ( uint64 )size ) {
+		if ( ftruncate( fd, ( off_t )size ) != 0 ) {
+			close( fd );
+			return false;
+		}
+	} else {
+		size = ( size_t )status.st_size;
+	}
+	void * base = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	close( fd );
+	if ( base == MAP_FAILED ) {
+		return false;
+	}
+	pMapping->base = base;
+	pMapping->size = size;
+	pMapping->handle = 0;
+	return true;
+}
+
+void Platform_UnmapShared( platformSharedMapping_t * pMapping ) {
+	if ( pMapping->base != NULL ) {
+		munmap( pMapping->base, pMapping->size );
+	}
+	memset( pMapping, 0, sizeof( *pMapping ) );
+}
+
+static_assert( sizeof( pthread_mutex_t ) <= sizeof( platformMutex_t ), "platformMutex_t storage is too small" );
+
+void Platform_MutexInit( platformMutex_t * pMutex ) {
+	pthread_mutex_init( reinterpret_cast< pthread_mutex_t * >( pMutex->storage ), NULL );
+}
+
+void Platform_MutexDestroy( platformMutex_t * pMutex ) {
+	pthread_mutex_destroy( reinterpret_cast< pthread_mutex_t * >( pMutex->storage ) );
+}
+
+void Platform_MutexLock( platformMutex_t * pMutex ) {
+	pthread_mutex_lock( reinterpret_cast< pthread_mutex_t * >( pMutex->storage ) );
+}
+
+void Platform_MutexUnlock( platformMutex_t * pMutex ) {
+	pthread_mutex_unlock( reinterpret_cast< pthread_mutex_t * >( pMutex->storage ) );
+}
+
+static void * ThreadTrampoline( void * pParameter ) {
+	platformThread_t * thread = reinterpret_cast< platformThread_t * >( pParameter );
+	thread->func( thread->pArgument );
+	return NULL;
+}
+
+bool Platform_CreateThread( platformThreadFunc_t func, void * pArgument, platformThread_t * pThread ) {
+	pThread->func = func;
+	pThread->pArgument = pArgument;
+	pthread_t thread;
+	if ( pthread_create( &thread, NULL, ThreadTrampoline, pThread ) != 0 ) {
+		pThread->handle = 0;
+		return false;
+	}
+	pThread->handle = ( uint64 )thread;
+	return true;
+}
+
+void Platform_JoinThread( platformThread_t * pThread ) {
+	pthread_join( ( pthread_t )pThread->handle, NULL );
+	pThread->handle = 0;
+}
+
+uint32 Platform_ProcessorCount() {
+	long count = sysconf( _SC_NPROCESSORS_ONLN );
+	return ( count > 0 ) ? ( uint32 )count : 1;
+}
+
+void Platform_Yield() {
+	sched_yield();
+}
+
+//makecontext passes int arguments only, so the fiber's address travels in two halves
+static void FiberTrampoline( int low, int high ) {
+	platformFiber_t * fiber = reinterpret_cast< platformFiber_t * >( ( uintptr_t )( uint32 )high << 32 | ( uint32 )low );
+	fiber->func( fiber->pArgument );
+}
+
+//The ucontext_t, a guard page the stack overflows into, then the stack
+bool Platform_CreateFiber( platformFiberFunc_t func, void * pArgument, size_t stackSize, platformFiber_t * pFiber ) {
+	memset( pFiber, 0, sizeof( *pFiber ) );
+	pFiber->func = func;
+	pFiber->pArgument = pArgument;
+	const size_t pageSize = Platform_PageSize();
+	const size_t contextSize = AlignSize( sizeof( ucontext_t ), pageSize );
+	const size_t size = contextSize + pageSize + AlignSize( stackSize, pageSize );
+	void * base = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if ( base == MAP_FAILED ) {
+		return false;
+	}
+	uint8 * pBytes = reinterpret_cast< uint8 * >( base );
+	ucontext_t * context = reinterpret_cast< ucontext_t * >( base );
+	if ( mprotect( pBytes + contextSize, pageSize, PROT_NONE ) != 0 || getcontext( context ) != 0 ) {
+		munmap( base, size );
+		return false;
+	}
+	context->uc_stack.ss_sp = pBytes + contextSize + pageSize;
+	context->uc_stack.ss_size = size - contextSize - pageSize;
+	context->uc_link = NULL;
+	const uint64 address = ( uint64 )( uintptr_t )pFiber;
+	makecontext( context, reinterpret_cast< void ( * )() >( FiberTrampoline ), 2, ( int )( uint32 )address, ( int )( uint32 )( address >> 32 ) );
+	pFiber->handle = ( uint64 )( uintptr_t )base;
+	pFiber->size = size;
+	return true;
+}
+
+void Platform_DestroyFiber( platformFiber_t * pFiber ) {
+	if ( pFiber->handle != 0 ) {
+		munmap( reinterpret_cast< void * >( ( uintptr_t )pFiber->handle ), pFiber->size );
+	}
+	memset( pFiber, 0, sizeof( *pFiber ) );
+}
+
+//Only somewhere to save the thread's registers while another fiber runs
+bool Platform_ThreadToFiber( platformFiber_t * pFiber ) {
+	memset( pFiber, 0, sizeof( *pFiber ) );
+	void * context = malloc( sizeof( ucontext_t ) );
+	pFiber->handle = ( uint64 )( uintptr_t )context;
+	pFiber->converted = context != NULL;
+	return context != NULL;
+}
+
+void Platform_FiberToThread( platformFiber_t * pFiber ) {
+	free( reinterpret_cast< void * >( ( uintptr_t )pFiber->handle ) );
+	memset( pFiber, 0, sizeof( *pFiber ) );
+}
+
+void Platform_SwitchFiber( platformFiber_t * pFrom, platformFiber_t * pTo ) {
+	swapcontext( reinterpret_cast< ucontext_t * >( ( uintptr_t )pFrom->handle ), reinterpret_cast< ucontext_t * >( ( uintptr_t )pTo->handle ) );
+}
+
+bool Platform_FutexWait( std::atomic< uint32 > * pAddress, uint32 expected, uint64 timeoutNanoseconds ) {
+	struct timespec timeout;
+	timeout.tv_sec = ( time_t )( timeoutNanoseconds / 1000000000ULL );
+	timeout.tv_nsec = ( long )( timeoutNanoseconds % 1000000000ULL );
+#if defined( __linux__ )
+	long result = syscall( SYS_futex, reinterpret_cast< uint32 * >( pAddress ), FUTEX_WAIT_PRIVATE, expected, ( timeoutNanoseconds == PLATFORM_WAIT_INFINITE ) ? NULL : &timeout, NULL, 0 );
+	return !( result == -1 && errno == ETIMEDOUT );
+#else
+	//No futex; poll with short sleeps, which is enough for the rare waits that reach here
+	struct timespec start;
+	clock_gettime( CLOCK_MONOTONIC, &start );
+	while ( pAddress->load( std::memory_order_acquire ) == expected ) {
+		struct timespec now;
+		clock_gettime( CLOCK_MONOTONIC, &now );
+		uint64 elapsed = ( uint64 )( now.tv_sec - start.tv_sec ) * 1000000000ULL + ( uint64 )( now.tv_nsec - start.tv_nsec );
+		if ( timeoutNanoseconds != PLATFORM_WAIT_INFINITE && elapsed >= timeoutNanoseconds ) {
+			return false;
+		}
+		struct timespec pause = { 0, 50000 };
+		nanosleep( &pause, NULL );
+	}
+	return true;
+#endif
+}
+
+void Platform_FutexWake( std::atomic< uint32 > * pAddress, bool wakeAll ) {
+#if defined( __linux__ )
+	syscall( SYS_futex, reinterpret_cast< uint32 * >( pAddress ), FUTEX_WAKE_PRIVATE, wakeAll ? 0x7FFFFFFF : 1, NULL, NULL, 0 );
+#else
+	( void )pAddress;
+	( void )wakeAll;
+#endif
+}
+
+uint64 Platform_Nanoseconds() {
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return ( uint64 )now.tv_sec * 1000000000ULL + ( uint64 )now.tv_nsec;
+}
+
+void Platform_DebugPrintf( const char * fmt, ... ) {
+	va_list args;
+	va_start( args, fmt );
+	vfprintf( stderr, fmt, args );
+	va_end( args );
+}
+
+#endif
+
+bool Platform_GetEnvironmentFlag( const char * name ) {
+	const char * value = getenv( name );
+	return value != NULL && value[ 0 ] != '\0' && strcmp( value, "0" ) != 0;
+}
+
+uint32 Platform_GetEnvironmentUInt( const char * name, uint32 defaultValue ) {
+	const char * value = getenv( name );
+	if ( value == NULL || value[ 0 ] == '\0' ) {
+		return defaultValue;
+	}
+	return ( uint32 )strtoul( value, NULL, 10 );
+}
+
+const char * Platform_GetEnvironmentString( const char * name ) {
+	const char * value = getenv( name );
+	return ( value != NULL && value[ 0 ] != '\0' ) ? value : NULL;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common.h"
+#include <atomic>
+
+//Thin OS layer so the engine modules stay free of windows.h and POSIX headers
+
+//Page-granular virtual memory, committed and zeroed on return
+struct platformMapping_t {
+	void *	base;
+	size_t	size;
+	bool	largePages;
+};
+
+size_t	Platform_PageSize();
+size_t	Platform_LargePageSize();
+//Maps at least size bytes; when largePages is requested but unavailable the mapping silently falls back to normal pages
+bool	Platform_MapMemory( size_t size, bool largePages, platformMapping_t * pMapping );
+void	Platform_UnmapMemory( platformMapping_t * pMapping );
+
+//Address space only, aligned to PLATFORM_RESERVE_ALIGNMENT; commit ranges before touching them and release with Platform_UnmapMemory
+#define PLATFORM_RESERVE_ALIGNMENT ( 64 * 1024 )
+bool	Platform_ReserveMemory( size_t size, platformMapping_t * pMapping );
+bool	Platform_CommitMemory( void * address, size_t size );
+//Makes committed pages read-only and executable once generated code has been written to them
+bool	Platform_ProtectExecutable( void * address, size_t size );
+
+//Memory another process can map by name: "shm:<name>" is a shared memory object, any other name a file on disk.
+//The object is created when missing and grown to size bytes; it outlives the mapping so readers can attach at any time
+struct platformSharedMapping_t {
+	void *	base;
+	size_t	size;
+	uint64	handle;			//keeps a named Windows section alive; unused on POSIX
+};
+
+bool	Platform_MapShared( const char * name, size_t size, platformSharedMapping_t * pMapping );
+void	Platform_UnmapShared( platformSharedMapping_t * pMapping );
+
+//Opaque so callers need no OS headers; zero-filled storage is not a valid mutex, call Platform_MutexInit
+struct platformMutex_t {
+	uint64	storage[ 8 ];
+};
+
+void	Platform_MutexInit( platformMutex_t * pMutex );
+void	Platform_MutexDestroy( platformMutex_t * pMutex );
+void	Platform_MutexLock( platformMutex_t * pMutex );
+void	Platform_MutexUnlock( platformMutex_t * pMutex );
+
+//Threads; the platformThread_t must stay put until Platform_JoinThread returns
+typedef void ( * platformThreadFunc_t )( void * pArgument );
+
+struct platformThread_t {
+	uint64					handle;
+	platformThreadFunc_t	func;
+	void *					pArgument;
+};
+
+bool	Platform_CreateThread( platformThreadFunc_t func, void * pArgument, platformThread_t * pThread );
+void	Platform_JoinThread( platformThread_t * pThread );
+uint32	Platform_ProcessorCount();
+void	Platform_Yield();
+
+//Fibers: stacks one thread switches between by hand.  A thread turns itself into a fiber before switching
+//to any other and back once control has returned to it.  A fiber's func must never return; it switches
+//away for the last time instead.  Like threads, the platformFiber_t must stay put while the fiber lives
+typedef void ( * platformFiberFunc_t )( void * pArgument );
+
+struct platformFiber_t {
+	uint64					handle;			//the Windows fiber, or on POSIX its ucontext_t, followed by the stack
+	size_t					size;			//of the POSIX allocation
+	platformFiberFunc_t		func;
+	void *					pArgument;
+	bool					converted;		//Platform_ThreadToFiber made the thread a fiber and so undoes it
+};
+
+//stackSize is reserved, and committed only as the fiber grows into it
+bool	Platform_CreateFiber( platformFiberFunc_t func, void * pArgument, size_t stackSize, platformFiber_t * pFiber );
+void	Platform_DestroyFiber( platformFiber_t * pFiber );
+bool	Platform_ThreadToFiber( platformFiber_t * pFiber );
+void	Platform_FiberToThread( platformFiber_t * pFiber );
+//Saves the running fiber, which pFrom describes, and resumes pTo
+void	Platform_SwitchFiber( platformFiber_t * pFrom, platformFiber_t * pTo );
+
+//Futex-style wait on a 32-bit word: sleeps while *pAddress == expected; returns false only on timeout
+#define PLATFORM_WAIT_INFINITE 0xFFFFFFFFFFFFFFFFULL
+bool	Platform_FutexWait( std::atomic< uint32 > * pAddress, uint32 expected, uint64 timeoutNanoseconds );
+void	Platform_FutexWake( std::atomic< uint32 > * pAddress, bool wakeAll );
+//Monotonic clock for timeouts
+uint64	Platform_Nanoseconds();
+
+bool	Platform_GetEnvironmentFlag( const char * name );
+uint32	Platform_GetEnvironmentUInt( const char * name, uint32 defaultValue );
+//NULL when the variable is unset or empty
+const char *	Platform_GetEnvironmentString( const char * name );
+void	Platform_DebugPrintf( const char * fmt, ... );
@@ -0,0 +1,74 @@
+#include "PresentRing.h"
+#include <string.h>
+
+static uint64 AlignTo( uint64 value, uint64 alignment ) {
+	return ( value + alignment - 1 ) & ~( alignment - 1 );
+}
+
+bool PresentRing_Init( presentRing_t * ring, uint32 imageCount, uint32 width, uint32 height, VkFormat format, uint32 rowPitch, uint64 imageSize ) {
+	memset( &ring->shared, 0, sizeof( ring->shared ) );
+	memset( &ring->local, 0, sizeof( ring->local ) );
+	ring->header = NULL;
+	ring->frameCount.store( 0 );
+	if ( imageCount > PRESENT_RING_MAX_IMAGES ) {
+		return false;
+	}
+
+	const uint64 headerSize = AlignTo( sizeof( presentRingHeader_t ), PRESENT_RING_IMAGE_ALIGNMENT );
+	const uint64 imageStride = AlignTo( imageSize, PRESENT_RING_IMAGE_ALIGNMENT );
+	const size_t size = ( size_t )( headerSize + imageStride * imageCount );
+	const char * output = Platform_GetEnvironmentString( PRESENT_RING_OUTPUT_VARIABLE );
+	uint8 * base = NULL;
+	if ( output != NULL ) {
+		if ( !Platform_MapShared( output, size, &ring->shared ) ) {
+			return false;
+		}
+		base = reinterpret_cast< uint8 * >( ring->shared.base );
+	} else {
+		if ( !Platform_MapMemory( size, false, &ring->local ) ) {
+			return false;
+		}
+		base = reinterpret_cast< uint8 * >( ring->local.base );
+	}
+
+	//Readers that are already attached drop the old layout before any field changes under them
+	presentRingHeader_t * header = reinterpret_cast< presentRingHeader_t * >( base );
+	header->magic.store( 0 );
+	header->version = PRESENT_RING_VERSION;
+	header->headerSize = ( uint32 )sizeof( presentRingHeader_t );
+	header->imageCount = imageCount;
+	header->width = width;
+	header->height = height;
+	header->format = ( uint32 )format;
+	header->rowPitch = rowPitch;
+	header->imageSize = imageSize;
+	for ( uint32 i = 0; i < PRESENT_RING_MAX_IMAGES; i++ ) {
+		header->imageOffsets[ i ] = ( i < imageCount ) ? headerSize + imageStride * i : 0;
+		header->imageFrame[ i ].store( 0 );
+	}
+	header->latest.store( 0 );
+	header->magic.store( PRESENT_RING_MAGIC );
+	ring->header = header;
+	return true;
+}
+
+void PresentRing_Shutdown( presentRing_t * ring ) {
+	Platform_UnmapShared( &ring->shared );
+	Platform_UnmapMemory( &ring->local );
+	ring->header = NULL;
+}
+
+uint8 * PresentRing_Image( const presentRing_t * ring, uint32 imageIndex ) {
+	return reinterpret_cast< uint8 * >( ring->header ) + ring->header->imageOffsets[ imageIndex ];
+}
+
+void PresentRing_Acquire( presentRing_t * ring, uint32 imageIndex ) {
+	ring->header->imageFrame[ imageIndex ].store( 0 );
+}
+
+//Runs once rendering has finished; the release orders every texel write before the frame becomes visible
+void PresentRing_Present( presentRing_t * ring, uint32 imageIndex ) {
+	const uint64 frame = ring->frameCount.fetch_add( 1 ) + 1;
+	ring->header->imageFrame[ imageIndex ].store( frame, std::memory_order_release );
+	ring->header->latest.store( ( frame << PRESENT_RING_INDEX_BITS ) | imageIndex, std::memory_order_release );
+}
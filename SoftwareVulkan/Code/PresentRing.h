@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Common.h"
+#include "Platform.h"
+#include "vulkan/vulkan.h"
+#include <atomic>
+
+#define PRESENT_RING_MAGIC ( 'S' | 'V' << 8 | 'P' << 16 | 'R' << 24 )
+#define PRESENT_RING_VERSION 1
+#define PRESENT_RING_MAX_IMAGES 8
+//Images start on their own pages so a reader can map or hand on each one separately
+#define PRESENT_RING_IMAGE_ALIGNMENT 4096
+//Names the file, or "shm:<name>" shared memory object, headless swapchains present into
+#define PRESENT_RING_OUTPUT_VARIABLE "SOFTWARE_VULKAN_PRESENT_OUTPUT"
+#define PRESENT_RING_INDEX_BITS 8
+
+/*
+================================================
+presentRing_t
+
+The backing store of a headless swapchain, laid out so another process can map the same file or shared
+memory object and read presented frames where they were rendered.  A header at offset 0 describes the
+images, which follow at page-aligned offsets as linear rows of rowPitch bytes.  The swapchain images are
+bound straight to that memory, so presenting copies nothing and never waits on a display: it publishes
+which image holds the newest frame and returns.
+
+Readers use a sequence lock per image:
+	latest = header->latest, loaded with acquire; frame = latest >> PRESENT_RING_INDEX_BITS, the image its low bits
+	skip the image unless imageFrame[ image ] == frame, then read its texels
+	after an acquire fence imageFrame[ image ] must still equal frame, otherwise it was handed back for
+	rendering while being read and the copy is torn
+A magic of zero means the producer is laying the ring out again; readers remap and start over.
+================================================
+*/
+struct presentRingHeader_t {
+	std::atomic< uint32 >	magic;
+	uint32					version;
+	uint32					headerSize;
+	uint32					imageCount;
+	uint32					width;
+	uint32					height;
+	uint32					format;					//VkFormat
+	uint32					rowPitch;
+	uint64					imageSize;
+	uint64					imageOffsets[ PRESENT_RING_MAX_IMAGES ];	//from the start of the mapping
+	std::atomic< uint64 >	latest;					//0 until the first present
+	std::atomic< uint64 >	imageFrame[ PRESENT_RING_MAX_IMAGES ];		//0 while an image is being rendered
+};
+
+struct presentRing_t {
+	platformSharedMapping_t		shared;
+	platformMapping_t			local;					//used instead when no output is named
+	presentRingHeader_t *		header;
+	std::atomic< uint64 >		frameCount;
+};
+
+//Maps the output named by PRESENT_RING_OUTPUT_VARIABLE, private memory when it is unset, and lays out the images
+bool	PresentRing_Init( presentRing_t * ring, uint32 imageCount, uint32 width, uint32 height, VkFormat format, uint32 rowPitch, uint64 imageSize );
+//Leaves the shared object and its last frame in place for readers
+void	PresentRing_Shutdown( presentRing_t * ring );
+uint8 *	PresentRing_Image( const presentRing_t * ring, uint32 imageIndex );
+//The image is about to be rendered again, so a reader still holding its previous frame will see it torn
+void	PresentRing_Acquire( presentRing_t * ring, uint32 imageIndex );
+void	PresentRing_Present( presentRing_t * ring, uint32 imageIndex );
@@ -0,0 +1,202 @@
+#include "PresentScheduler.h"
+#include <string.h>
+
+//Hands an image back once nothing reads it any more; with holdDisplayed the newest frame stays out until replaced
+static void PresentScheduler_Release( presentScheduler_t * scheduler, uint32 imageIndex ) {
+	Platform_MutexLock( &scheduler->lock );
+	if ( scheduler->holdDisplayed ) {
+		if ( scheduler->displayed != PRESENT_INVALID_IMAGE ) {
+			scheduler->states[ scheduler->displayed ] = presentImageState_t::AVAILABLE;
+		}
+		scheduler->displayed = imageIndex;
+		scheduler->states[ imageIndex ] = presentImageState_t::DISPLAYED;
+	} else {
+		scheduler->states[ imageIndex ] = presentImageState_t::AVAILABLE;
+	}
+	Platform_MutexUnlock( &scheduler->lock );
+	SyncEvent_Notify( &scheduler->event );
+}
+
+static void PresentScheduler_Display( presentScheduler_t * scheduler, uint32 imageIndex, bool vsync ) {
+	Platform_MutexLock( &scheduler->displayLock );
+	scheduler->display( scheduler->pArgument, imageIndex, vsync );
+	Platform_MutexUnlock( &scheduler->displayLock );
+	if ( vsync ) {
+		scheduler->lastVblank.store( Platform_Nanoseconds() );
+	}
+	PresentScheduler_Release( scheduler, imageIndex );
+}
+
+//Shows one pending frame per vertical blank; only exits once nothing is pending
+static void PresentScheduler_Thread( void * pArgument ) {
+	presentScheduler_t * scheduler = reinterpret_cast< presentScheduler_t * >( pArgument );
+	for ( ;; ) {
+		const uint32 epoch = scheduler->event.epoch.load();
+		uint32 imageIndex = PRESENT_INVALID_IMAGE;
+		Platform_MutexLock( &scheduler->lock );
+		if ( scheduler->pendingCount != 0 ) {
+			imageIndex = scheduler->pending[ scheduler->pendingHead ];
+			scheduler->pendingHead = ( scheduler->pendingHead + 1 ) % PRESENT_MAX_IMAGES;
+			scheduler->pendingCount--;
+		}
+		Platform_MutexUnlock( &scheduler->lock );
+		if ( imageIndex == PRESENT_INVALID_IMAGE ) {
+			if ( scheduler->shutdown.load() != 0 ) {
+				return;
+			}
+			SyncEvent_Wait( &scheduler->event, epoch, PLATFORM_WAIT_INFINITE );
+			continue;
+		}
+		PresentScheduler_Display( scheduler, imageIndex, true );
+	}
+}
+
+bool PresentScheduler_Init( presentScheduler_t * scheduler, uint32 imageCount, VkPresentModeKHR presentMode, uint64 syncInterval, bool holdDisplayed, presentDisplayFunc_t display, void * pArgument ) {
+	if ( imageCount > PRESENT_MAX_IMAGES ) {
+		return false;
+	}
+	scheduler->display = display;
+	scheduler->pArgument = pArgument;
+	scheduler->presentMode = presentMode;
+	scheduler->imageCount = imageCount;
+	scheduler->holdDisplayed = holdDisplayed;
+	scheduler->threaded = ( syncInterval != 0 ) && ( presentMode != VK_PRESENT_MODE_IMMEDIATE_KHR );
+	scheduler->syncInterval = syncInterval;
+	Platform_MutexInit( &scheduler->lock );
+	Platform_MutexInit( &scheduler->displayLock );
+	SyncEvent_Init( &scheduler->event );
+	for ( uint32 i = 0; i < PRESENT_MAX_IMAGES; i++ ) {
+		scheduler->states[ i ] = presentImageState_t::AVAILABLE;
+		scheduler->acquireTimes[ i ] = 0;
+	}
+	scheduler->pendingHead = 0;
+	scheduler->pendingCount = 0;
+	scheduler->displayed = PRESENT_INVALID_IMAGE;
+	scheduler->nextAcquire = 0;
+	scheduler->lastVblank.store( 0 );
+	scheduler->frameTime.store( 0 );
+	scheduler->shutdown.store( 0 );
+	memset( &scheduler->thread, 0, sizeof( scheduler->thread ) );
+	if ( scheduler->threaded && !Platform_CreateThread( PresentScheduler_Thread, scheduler, &scheduler->thread ) ) {
+		Platform_MutexDestroy( &scheduler->lock );
+		Platform_MutexDestroy( &scheduler->displayLock );
+		return false;
+	}
+	return true;
+}
+
+void PresentScheduler_Shutdown( presentScheduler_t * scheduler ) {
+	if ( scheduler->threaded ) {
+		scheduler->shutdown.store( 1 );
+		SyncEvent_Notify( &scheduler->event );
+		Platform_JoinThread( &scheduler->thread );
+	}
+	Platform_MutexDestroy( &scheduler->lock );
+	Platform_MutexDestroy( &scheduler->displayLock );
+}
+
+//Sleeps until the frame can start as late as possible and still make its vertical blank.  Under FIFO every frame
+//already queued or pending takes a blank of its own first; under MAILBOX a new frame replaces them
+static void PresentScheduler_Pace( presentScheduler_t * scheduler, uint64 deadline ) {
+	const uint64 lastVblank = scheduler->lastVblank.load();
+	const uint64 frameTime = scheduler->frameTime.load();
+	if ( !scheduler->threaded || lastVblank == 0 || frameTime == 0 ) {
+		return;
+	}
+	uint32 framesAhead = 0;
+	if ( scheduler->presentMode == VK_PRESENT_MODE_FIFO_KHR ) {
+		Platform_MutexLock( &scheduler->lock );
+		for ( uint32 i = 0; i < scheduler->imageCount; i++ ) {
+			if ( scheduler->states[ i ] == presentImageState_t::QUEUED || scheduler->states[ i ] == presentImageState_t::PENDING ) {
+				framesAhead++;
+			}
+		}
+		Platform_MutexUnlock( &scheduler->lock );
+	}
+
+	const uint64 interval = scheduler->syncInterval;
+	const uint64 lead = frameTime + PRESENT_PACING_MARGIN_NS;
+	const uint64 now = Platform_Nanoseconds();
+	const uint64 ready = now + lead;
+	uint64 target = lastVblank + ( ( ready - lastVblank ) / interval + 1 ) * interval;
+	const uint64 earliest = lastVblank + ( framesAhead + 1 ) * interval;
+	if ( target < earliest ) {
+		target = earliest;
+	}
+	uint64 start = target - lead;
+	if ( start > deadline ) {
+		start = deadline;
+	}
+	for ( ;; ) {
+		const uint32 epoch = scheduler->event.epoch.load();
+		if ( !SyncEvent_Wait( &scheduler->event, epoch, start ) ) {
+			return;
+		}
+	}
+}
+
+VkResult PresentScheduler_Acquire( presentScheduler_t * scheduler, uint64 timeout, uint32 * pImageIndex ) {
+	const uint64 deadline = Sync_Deadline( timeout );
+	uint32 imageIndex = PRESENT_INVALID_IMAGE;
+	for ( ;; ) {
+		const uint32 epoch = scheduler->event.epoch.load();
+		Platform_MutexLock( &scheduler->lock );
+		for ( uint32 i = 0; i < scheduler->imageCount; i++ ) {
+			const uint32 candidate = ( scheduler->nextAcquire + i ) % scheduler->imageCount;
+			if ( scheduler->states[ candidate ] == presentImageState_t::AVAILABLE ) {
+				scheduler->states[ candidate ] = presentImageState_t::ACQUIRED;
+				scheduler->nextAcquire = ( candidate + 1 ) % scheduler->imageCount;
+				imageIndex = candidate;
+				break;
+			}
+		}
+		Platform_MutexUnlock( &scheduler->lock );
+		if ( imageIndex != PRESENT_INVALID_IMAGE ) {
+			break;
+		}
+		if ( timeout == 0 ) {
+			return VK_NOT_READY;
+		}
+		if ( !SyncEvent_Wait( &scheduler->event, epoch, deadline ) ) {
+			return VK_TIMEOUT;
+		}
+	}
+	PresentScheduler_Pace( scheduler, deadline );
+	scheduler->acquireTimes[ imageIndex ] = Platform_Nanoseconds();
+	*pImageIndex = imageIndex;
+	return VK_SUCCESS;
+}
+
+bool PresentScheduler_Queue( presentScheduler_t * scheduler, uint32 imageIndex ) {
+	Platform_MutexLock( &scheduler->lock );
+	const bool owned = ( imageIndex < scheduler->imageCount ) && ( scheduler->states[ imageIndex ] == presentImageState_t::ACQUIRED );
+	if ( owned ) {
+		scheduler->states[ imageIndex ] = presentImageState_t::QUEUED;
+	}
+	Platform_MutexUnlock( &scheduler->lock );
+	return owned;
+}
+
+void PresentScheduler_Present( presentScheduler_t * scheduler, uint32 imageIndex ) {
+	//Concurrent presents from several queues may lose a sample; the average only steers pacing
+	const uint64 sample = Platform_Nanoseconds() - scheduler->acquireTimes[ imageIndex ];
+	const uint64 average = scheduler->frameTime.load();
+	scheduler->frameTime.store( ( average == 0 ) ? sample : ( average * 7 + sample ) / 8 );
+	if ( !scheduler->threaded ) {
+		PresentScheduler_Display( scheduler, imageIndex, false );
+		return;
+	}
+
+	Platform_MutexLock( &scheduler->lock );
+	if ( scheduler->presentMode == VK_PRESENT_MODE_MAILBOX_KHR && scheduler->pendingCount != 0 ) {
+		//The frame waiting for the next blank will never be shown, so it goes straight back to the application
+		scheduler->states[ scheduler->pending[ scheduler->pendingHead ] ] = presentImageState_t::AVAILABLE;
+		scheduler->pending[ scheduler->pendingHead ] = imageIndex;
+	} else {
+		scheduler->pending[ ( scheduler->pendingHead + scheduler->pendingCount ) % PRESENT_MAX_IMAGES ] = imageIndex;
+		scheduler->pendingCount++;
+	}
+	scheduler->states[ imageIndex ] = presentImageState_t::PENDING;
+	Platform_MutexUnlock( &scheduler->lock );
+	SyncEvent_Notify( &scheduler->event );
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Common.h"
+#include "Platform.h"
+#include "Queue.h"
+#include "vulkan/vulkan.h"
+#include <atomic>
+
+#define PRESENT_MAX_IMAGES 8
+#define PRESENT_INVALID_IMAGE 0xFFFFFFFF
+//Slack left between a paced frame's expected finish and the vertical blank it is aimed at
+#define PRESENT_PACING_MARGIN_NS 1000000ULL
+
+enum class presentImageState_t : uint32 {
+	AVAILABLE,				//the engine's, free to acquire
+	ACQUIRED,				//the application's
+	QUEUED,					//handed to vkQueuePresentKHR, waiting on the queue
+	PENDING,				//rendered, waiting for a vertical blank
+	DISPLAYED				//being read where it was rendered; released when a newer frame replaces it
+};
+
+//Shows an image; with vsync it returns once the image has been scanned out, and the image is free afterwards
+typedef void ( * presentDisplayFunc_t )( void * pArgument, uint32 imageIndex, bool vsync );
+
+/*
+================================================
+presentScheduler_t
+
+Owns a swapchain's images between presents.  An image goes back to the application only once the
+presentation side is done with it, so acquire blocks, or reports VK_NOT_READY, rather than hand out an
+image still being read.
+
+With a display to pace against, FIFO and MAILBOX frames go to a display thread that shows one per
+vertical blank: FIFO queues every frame, MAILBOX keeps only the newest and releases the one it replaces
+at once.  IMMEDIATE frames, and every frame when there is no vertical blank to wait for, are shown on the
+presenting queue as soon as their waits clear.
+
+Pacing lets acquire return as late as possible: it tracks how long frames take from acquire to being ready
+and holds acquire back until that long, plus a margin, before the first vertical blank the frame can
+still make.  A frame that starts then spends the least time waiting for display, which is the latency
+between reading input and showing its result.
+================================================
+*/
+struct presentScheduler_t {
+	presentDisplayFunc_t	display;
+	void *					pArgument;
+	VkPresentModeKHR		presentMode;
+	uint32					imageCount;
+	bool					holdDisplayed;		//the backing store is read in place, so the newest frame stays put
+	bool					threaded;
+	uint64					syncInterval;		//nanoseconds between vertical blanks, 0 when there are none
+
+	platformMutex_t			lock;				//image states and the pending list
+	platformMutex_t			displayLock;		//one display call at a time, whichever thread makes it
+	syncEvent_t				event;				//notified when an image is released or a frame is pending
+	presentImageState_t		states[ PRESENT_MAX_IMAGES ];
+	uint64					acquireTimes[ PRESENT_MAX_IMAGES ];
+	uint32					pending[ PRESENT_MAX_IMAGES ];		//FIFO order; MAILBOX keeps at most one
+	uint32					pendingHead;
+	uint32					pendingCount;
+	uint32					displayed;
+	uint32					nextAcquire;
+
+	std::atomic< uint64 >	lastVblank;
+	std::atomic< uint64 >	frameTime;			//moving average, acquire to ready for display
+	std::atomic< uint32 >	shutdown;
+	platformThread_t		thread;
+};
+
+bool		PresentScheduler_Init( presentScheduler_t * scheduler, uint32 imageCount, VkPresentModeKHR presentMode, uint64 syncInterval, bool holdDisplayed, presentDisplayFunc_t display, void * pArgument );
+//Shows whatever is still pending, then stops the display thread
+void		PresentScheduler_Shutdown( presentScheduler_t * scheduler );
+//vkAcquireNextImageKHR semantics, pacing included
+VkResult	PresentScheduler_Acquire( presentScheduler_t * scheduler, uint64 timeout, uint32 * pImageIndex );
+//The application gives an acquired image up to a present; false when it does not own the image
+bool		PresentScheduler_Queue( presentScheduler_t * scheduler, uint32 imageIndex );
+//Runs on the presenting queue once the present's waits are satisfied
+void		PresentScheduler_Present( presentScheduler_t * scheduler, uint32 imageIndex );
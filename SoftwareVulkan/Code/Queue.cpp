@@ -0,0 +1,230 @@
+#include "Queue.h"
+#include <string.h>
+
+/*
+================================================
+syncEvent_t
+================================================
+*/
+void SyncEvent_Init( syncEvent_t * event ) {
+	event->epoch.store( 0 );
+	event->waiters.store( 0 );
+}
+
+//Both sides use sequentially consistent read-modify-writes, so either the notifier sees the waiter's count
+//or the waiter's futex compare sees the new epoch
+void SyncEvent_Notify( syncEvent_t * event ) {
+	event->epoch.fetch_add( 1 );
+	if ( event->waiters.load() != 0 ) {
+		Platform_FutexWake( &event->epoch, true );
+	}
+}
+
+bool SyncEvent_Wait( syncEvent_t * event, uint32 epoch, uint64 deadline ) {
+	uint64 timeout = PLATFORM_WAIT_INFINITE;
+	if ( deadline != PLATFORM_WAIT_INFINITE ) {
+		const uint64 now = Platform_Nanoseconds();
+		if ( now >= deadline ) {
+			return false;
+		}
+		timeout = deadline - now;
+	}
+	event->waiters.fetch_add( 1 );
+	Platform_FutexWait( &event->epoch, epoch, timeout );
+	event->waiters.fetch_sub( 1 );
+	return true;
+}
+
+uint64 Sync_Deadline( uint64 timeout ) {
+	if ( timeout == PLATFORM_WAIT_INFINITE ) {
+		return PLATFORM_WAIT_INFINITE;
+	}
+	const uint64 now = Platform_Nanoseconds();
+	return ( timeout < PLATFORM_WAIT_INFINITE - now ) ? now + timeout : PLATFORM_WAIT_INFINITE - 1;
+}
+
+//Sleeps until all, or any, of count conditions hold
+template< typename test_t >
+static VkResult Sync_WaitFor( syncEvent_t * event, uint32 count, bool waitAll, uint64 timeout, const test_t & test ) {
+	const uint64 deadline = Sync_Deadline( timeout );
+	for ( ;; ) {
+		const uint32 epoch = event->epoch.load();
+		uint32 satisfied = 0;
+		for ( uint32 i = 0; i < count; i++ ) {
+			satisfied += test( i ) ? 1 : 0;
+		}
+		if ( waitAll ? ( satisfied == count ) : ( satisfied > 0 ) ) {
+			return VK_SUCCESS;
+		}
+		if ( !SyncEvent_Wait( event, epoch, deadline ) ) {
+			return VK_TIMEOUT;
+		}
+	}
+}
+
+/*
+================================================
+syncFence_t
+================================================
+*/
+void Fence_Init( syncFence_t * fence, syncEvent_t * event, bool signaled ) {
+	fence->event = event;
+	fence->signaled.store( signaled ? 1 : 0 );
+}
+
+void Fence_Signal( syncFence_t * fence ) {
+	fence->signaled.store( 1 );
+	SyncEvent_Notify( fence->event );
+}
+
+void Fence_Reset( syncFence_t * fence ) {
+	fence->signaled.store( 0 );
+}
+
+bool Fence_IsSignaled( const syncFence_t * fence ) {
+	return fence->signaled.load() != 0;
+}
+
+VkResult Fence_Wait( syncEvent_t * event, syncFence_t * const * ppFences, uint32 fenceCount, bool waitAll, uint64 timeout ) {
+	return Sync_WaitFor( event, fenceCount, waitAll, timeout, [ppFences]( uint32 i ) { return Fence_IsSignaled( ppFences[ i ] ); } );
+}
+
+/*
+================================================
+syncSemaphore_t
+================================================
+*/
+void Semaphore_Init( syncSemaphore_t * semaphore, syncEvent_t * event, bool timeline, uint64 initialValue ) {
+	semaphore->event = event;
+	semaphore->timeline = timeline;
+	semaphore->value.store( timeline ? initialValue : 0 );
+	semaphore->signalsIssued = 0;
+	semaphore->waitsIssued = 0;
+}
+
+//Signals from different queues and the host can land out of order, so the value only ever moves up
+void Semaphore_Signal( syncSemaphore_t * semaphore, uint64 value ) {
+	uint64 current = semaphore->value.load();
+	while ( current < value && !semaphore->value.compare_exchange_weak( current, value ) ) {
+	}
+	SyncEvent_Notify( semaphore->event );
+}
+
+uint64 Semaphore_Value( const syncSemaphore_t * semaphore ) {
+	return semaphore->value.load();
+}
+
+uint64 Semaphore_NextSignal( syncSemaphore_t * semaphore ) {
+	return ++semaphore->signalsIssued;
+}
+
+uint64 Semaphore_NextWait( syncSemaphore_t * semaphore ) {
+	return ++semaphore->waitsIssued;
+}
+
+VkResult Semaphore_Wait( syncEvent_t * event, syncSemaphore_t * const * ppSemaphores, const uint64 * pValues, uint32 semaphoreCount, bool waitAll, uint64 timeout ) {
+	return Sync_WaitFor( event, semaphoreCount, waitAll, timeout, [ppSemaphores, pValues]( uint32 i ) { return Semaphore_Value( ppSemaphores[ i ] ) >= pValues[ i ]; } );
+}
+
+/*
+================================================
+queue_t
+================================================
+*/
+static void Queue_Run( queue_t * queue, const queueOperation_t & operation ) {
+	switch ( operation.op ) {
+		case queueOp_t::EXECUTE:
+			CommandBuffer_Execute( reinterpret_cast< const commandBuffer_t * >( operation.pObject ), queue->executor );
+			break;
+		case queueOp_t::WAIT: {
+			syncSemaphore_t * semaphore = reinterpret_cast< syncSemaphore_t * >( operation.pObject );
+			Semaphore_Wait( semaphore->event, &semaphore, &operation.value, 1, true, PLATFORM_WAIT_INFINITE );
+			break;
+		}
+		case queueOp_t::SIGNAL:
+			Semaphore_Signal( reinterpret_cast< syncSemaphore_t * >( operation.pObject ), operation.value );
+			break;
+		case queueOp_t::FENCE:
+			Fence_Signal( reinterpret_cast< syncFence_t * >( operation.pObject ) );
+			break;
+		case queueOp_t::CALL: {
+			const queueCall_t * call = reinterpret_cast< const queueCall_t * >( operation.pObject );
+			call->func( call->pArgument, operation.value );
+			break;
+		}
+	}
+}
+
+static void Queue_Worker( void * pArgument ) {
+	queue_t * queue = reinterpret_cast< queue_t * >( pArgument );
+	for ( ;; ) {
+		const uint32 tail = queue->tail.load( std::memory_order_relaxed );
+		const uint32 epoch = queue->workEvent.epoch.load();
+		if ( queue->head.load( std::memory_order_acquire ) == tail ) {
+			if ( queue->shutdown.load() != 0 ) {
+				return;
+			}
+			SyncEvent_Wait( &queue->workEvent, epoch, PLATFORM_WAIT_INFINITE );
+			continue;
+		}
+		Queue_Run( queue, queue->ring[ tail & ( QUEUE_RING_SIZE - 1 ) ] );
+		queue->tail.store( tail + 1, std::memory_order_release );
+		SyncEvent_Notify( &queue->progressEvent );
+	}
+}
+
+bool Queue_Init( queue_t * queue, commandExecutor_t * executor ) {
+	queue->executor = executor;
+	queue->shutdown.store( 0 );
+	SyncEvent_Init( &queue->workEvent );
+	SyncEvent_Init( &queue->progressEvent );
+	queue->pendingHead = 0;
+	queue->head.store( 0 );
+	queue->tail.store( 0 );
+	return Platform_CreateThread( Queue_Worker, queue, &queue->thread );
+}
+
+void Queue_Shutdown( queue_t * queue ) {
+	Queue_Publish( queue );
+	queue->shutdown.store( 1 );
+	SyncEvent_Notify( &queue->workEvent );
+	Platform_JoinThread( &queue->thread );
+}
+
+void Queue_Push( queue_t * queue, queueOp_t op, void * pObject, uint64 value ) {
+	if ( queue->pendingHead - queue->tail.load( std::memory_order_acquire ) == QUEUE_RING_SIZE ) {
+		//Whatever is written so far has to run before a slot frees up
+		Queue_Publish( queue );
+		for ( ;; ) {
+			const uint32 epoch = queue->progressEvent.epoch.load();
+			if ( queue->pendingHead - queue->tail.load( std::memory_order_acquire ) < QUEUE_RING_SIZE ) {
+				break;
+			}
+			SyncEvent_Wait( &queue->progressEvent, epoch, PLATFORM_WAIT_INFINITE );
+		}
+	}
+	queueOperation_t & operation = queue->ring[ queue->pendingHead & ( QUEUE_RING_SIZE - 1 ) ];
+	operation.op = op;
+	operation.value = value;
+	operation.pObject = pObject;
+	queue->pendingHead++;
+}
+
+void Queue_Publish( queue_t * queue ) {
+	if ( queue->head.load( std::memory_order_relaxed ) == queue->pendingHead ) {
+		return;
+	}
+	queue->head.store( queue->pendingHead, std::memory_order_release );
+	SyncEvent_Notify( &queue->workEvent );
+}
+
+void Queue_WaitIdle( queue_t * queue ) {
+	const uint32 target = queue->head.load( std::memory_order_relaxed );
+	for ( ;; ) {
+		const uint32 epoch = queue->progressEvent.epoch.load();
+		if ( queue->tail.load( std::memory_order_acquire ) == target ) {
+			return;
+		}
+		SyncEvent_Wait( &queue->progressEvent, epoch, PLATFORM_WAIT_INFINITE );
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Common.h"
+#include "CommandBuffer.h"
+#include "Platform.h"
+#include "vulkan/vulkan.h"
+#include <atomic>
+
+//Operations in flight per queue; a submission that finds the ring full waits for the worker to catch up, so
+//waits submitted ahead of their signals must stay under this many
+#define QUEUE_RING_SIZE 1024
+
+/*
+================================================
+syncEvent_t
+
+A futex word bumped on every notification.  Waiters read the epoch, test their condition and sleep only
+while the epoch is unchanged, so a notification that lands between the test and the sleep is never lost.
+The waiter count lets notifiers skip the wake call when nobody sleeps, which is the common case.
+================================================
+*/
+struct syncEvent_t {
+	std::atomic< uint32 >	epoch;
+	std::atomic< uint32 >	waiters;
+};
+
+void	SyncEvent_Init( syncEvent_t * event );
+void	SyncEvent_Notify( syncEvent_t * event );
+//Sleeps while the epoch still reads epoch; false once deadline has passed, true on any wake, spurious ones included
+bool	SyncEvent_Wait( syncEvent_t * event, uint32 epoch, uint64 deadline );
+//Absolute Platform_Nanoseconds deadline for a Vulkan timeout, PLATFORM_WAIT_INFINITE for UINT64_MAX
+uint64	Sync_Deadline( uint64 timeout );
+
+/*
+================================================
+syncFence_t / syncSemaphore_t
+
+Every fence and semaphore of a device notifies the same event, so a host wait on any mix of them sleeps on
+a single futex.  Binary semaphores are kept as counters: each queued signal is assigned the next count
+and each queued wait the count it needs, both at submit time, which makes waiting on either kind of
+semaphore the same test of value against a target.
+================================================
+*/
+struct syncFence_t {
+	syncEvent_t *			event;
+	std::atomic< uint32 >	signaled;
+};
+
+void	Fence_Init( syncFence_t * fence, syncEvent_t * event, bool signaled );
+void	Fence_Signal( syncFence_t * fence );
+void	Fence_Reset( syncFence_t * fence );
+bool	Fence_IsSignaled( const syncFence_t * fence );
+//vkWaitForFences semantics, VK_TIMEOUT when the timeout runs out first
+VkResult	Fence_Wait( syncEvent_t * event, syncFence_t * const * ppFences, uint32 fenceCount, bool waitAll, uint64 timeout );
+
+struct syncSemaphore_t {
+	syncEvent_t *			event;
+	bool					timeline;
+	std::atomic< uint64 >	value;				//timeline payload, or signals completed so far for a binary semaphore
+	uint64					signalsIssued;		//binary only, externally synchronized like the submissions that use them
+	uint64					waitsIssued;
+};
+
+void	Semaphore_Init( syncSemaphore_t * semaphore, syncEvent_t * event, bool timeline, uint64 initialValue );
+void	Semaphore_Signal( syncSemaphore_t * semaphore, uint64 value );
+uint64	Semaphore_Value( const syncSemaphore_t * semaphore );
+//Targets for the next signal and wait queued on a binary semaphore
+uint64	Semaphore_NextSignal( syncSemaphore_t * semaphore );
+uint64	Semaphore_NextWait( syncSemaphore_t * semaphore );
+//vkWaitSemaphoresKHR semantics
+VkResult	Semaphore_Wait( syncEvent_t * event, syncSemaphore_t * const * ppSemaphores, const uint64 * pValues, uint32 semaphoreCount, bool waitAll, uint64 timeout );
+
+/*
+================================================
+queue_t
+
+One worker thread per VkQueue, fed through a single-producer ring: vkQueueSubmit is externally
+synchronized per queue, so the submitting side needs no lock and returns as soon as the operations are
+written.  The worker runs them in order and advances tail after each, so everything before tail has
+completed.
+================================================
+*/
+enum class queueOp_t : uint32 {
+	EXECUTE,				//pObject is a commandBuffer_t
+	WAIT,					//pObject is a syncSemaphore_t, value its target
+	SIGNAL,
+	FENCE,					//pObject is a syncFence_t
+	CALL					//pObject is a queueCall_t, value is passed on to it
+};
+
+//Work that has to happen in queue order without being a command buffer, such as a present behind its waits
+typedef void ( * queueFunc_t )( void * pArgument, uint64 value );
+
+struct queueCall_t {
+	queueFunc_t		func;
+	void *			pArgument;
+};
+
+struct queueOperation_t {
+	queueOp_t	op;
+	uint64		value;
+	void *		pObject;
+};
+
+struct queue_t {
+	commandExecutor_t *		executor;
+	platformThread_t		thread;
+	std::atomic< uint32 >	shutdown;
+	syncEvent_t				workEvent;			//notified when operations are published
+	syncEvent_t				progressEvent;		//notified as the worker completes them
+	uint32					pendingHead;		//submitting thread only: written but not yet published
+
+	alignas( 64 ) std::atomic< uint32 >	head;
+	alignas( 64 ) std::atomic< uint32 >	tail;
+	alignas( 64 ) queueOperation_t		ring[ QUEUE_RING_SIZE ];
+};
+
+bool	Queue_Init( queue_t * queue, commandExecutor_t * executor );
+//Lets the worker finish everything queued, then joins it
+void	Queue_Shutdown( queue_t * queue );
+//Writes one operation, waiting for the worker when the ring is full; nothing runs before Queue_Publish
+void	Queue_Push( queue_t * queue, queueOp_t op, void * pObject, uint64 value );
+void	Queue_Publish( queue_t * queue );
+void	Queue_WaitIdle( queue_t * queue );
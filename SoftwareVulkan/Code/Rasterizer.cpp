@@ -0,0 +1,1280 @@
+#include "Rasterizer.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+//Six clip planes can add at most one vertex each to a triangle, which fans out into seven triangles
+#define RASTER_MAX_CLIP_VERTICES 9
+#define RASTER_MAX_CLIP_TRIANGLES ( RASTER_MAX_CLIP_VERTICES - 2 )
+#define RASTER_VERTEX_STRIDE_MAX ( 4 + RASTER_MAX_VARYINGS )
+#define RASTER_CHUNK_ELEMENTS ( RASTER_CHUNK_PRIMITIVES * 3 + 1 )
+//Entries in a worker's post-transform cache; a chunk uses the smallest power of two that covers its elements
+#define RASTER_VERTEX_CACHE_SIZE 1024
+#define RASTER_NO_SLOT 0xFFFF
+//Tile scratch holds a 32-bit color texel and at most a 32-bit depth texel per pixel
+#define RASTER_SCRATCH_PLANE_BYTES ( RASTER_TILE_SIZE * RASTER_TILE_SIZE * sizeof( uint32 ) )
+
+static_assert( RASTER_TILE_SHIFT == IMAGE_CLEAR_TILE_SHIFT, "a tile job owns exactly one tile of a target's clear state" );
+
+enum rasterClipPlane_t {
+	RASTER_CLIP_NEAR	= BIT( 0 ),
+	RASTER_CLIP_FAR		= BIT( 1 ),
+	RASTER_CLIP_RIGHT	= BIT( 2 ),
+	RASTER_CLIP_LEFT	= BIT( 3 ),
+	RASTER_CLIP_BOTTOM	= BIT( 4 ),
+	RASTER_CLIP_TOP		= BIT( 5 )
+};
+#define RASTER_CLIP_PLANE_COUNT 6
+
+//A run of primitives from one instance of a draw
+struct rasterPiece_t {
+	const rasterDraw_t *	draw;
+	uint32					instanceIndex;
+	uint32					firstPrimitive;
+	uint32					primitiveCount;
+	uint32					stripStart;				//first element of the strip or fan the piece begins in
+};
+
+//Consecutive pieces of at most RASTER_CHUNK_PRIMITIVES primitives in all, so small draws share a front-end job
+struct rasterChunk_t {
+	const rasterPiece_t *	pPieces;
+	uint32					pieceCount;
+	uint32 *				pTileOffsets;			//tileCount + 1 entries, NULL when nothing survived setup
+	rasterTriangle_t **		ppTileTriangles;
+};
+
+struct rasterDrawNode_t {
+	rasterDraw_t		draw;
+	rasterDrawNode_t *	pNext;
+};
+
+struct rasterPass_t {
+	rasterizer_t *		rasterizer;
+	rasterPiece_t *		pPieces;
+	rasterChunk_t *		pChunks;
+	uint32				chunkCount;
+	uint32				tilesX;
+	uint32				tilesY;
+	uint32				firstTileX;			//back-end jobs cover the tiles of the render area only
+	uint32				firstTileY;
+	uint32				areaTilesX;
+};
+
+//A tile job's hierarchical depth, in the same float values the fragment stage compares against
+struct rasterHiZ_t {
+	float	minZ[ RASTER_HIZ_TILE_BLOCKS ];		//+FLT_MAX and -FLT_MAX for blocks with no texel in the tile's area
+	float	maxZ[ RASTER_HIZ_TILE_BLOCKS ];
+	float	tileMinZ;
+	float	tileMaxZ;
+	bool	valid;
+	bool	tileDirty;						//tileMinZ and tileMaxZ are stale
+};
+
+//Where a tile job reads and writes an attachment: the image itself, or tile scratch whose texel ( 0, 0 ) is the tile's corner
+struct rasterSurface_t {
+	uint8 *					data;				//NULL when the pass has no such attachment
+	const imageLayout_t *	layout;
+	uint32					mipLevel;
+	uint32					arrayLayer;
+	int32					originX;
+	int32					originY;
+};
+
+static uint8 * Surface_Texel( const rasterSurface_t & surface, int32 x, int32 y ) {
+	return surface.data + ImageLayout_TexelOffset( surface.layout, surface.mipLevel, surface.arrayLayer, x - surface.originX, y - surface.originY, 0 );
+}
+
+//What a tile job works on: its pixels, clipped to the render area, and their hierarchical depth
+struct rasterTileState_t {
+	int32			minX;
+	int32			minY;
+	int32			maxX;
+	int32			maxY;
+	rasterSurface_t	color;
+	rasterSurface_t	depth;
+	rasterDepthEncoding_t	depthEncoding;
+	rasterHiZ_t		hiZ;
+};
+
+//Per front-end job state shared by clipping and setup
+struct rasterSetup_t {
+	const rasterDraw_t *		draw;
+	const rasterPipeline_t *	pipeline;
+	rasterWorker_t *			worker;
+	uint32						stride;
+	float						offsetX;
+	float						offsetY;
+	float						scaleX;
+	float						scaleY;
+	float						minDepth;
+	float						depthRange;
+	float						guardX;
+	float						guardY;
+	int32						clipMinX;
+	int32						clipMinY;
+	int32						clipMaxX;
+	int32						clipMaxY;
+	uint32						triangleCount;
+};
+
+static uint32 PrimitiveCount( const rasterDraw_t * draw ) {
+	switch ( draw->pipeline->topology ) {
+		case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST:
+			return draw->vertexCount / 3;
+		case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
+			return ( draw->vertexCount >= 3 ) ? draw->vertexCount - 2 : 0;
+		default:
+			return 0;
+	}
+}
+
+static uint32 ElementIndex( const rasterDraw_t * draw, uint32 element ) {
+	return ( draw->indexType == VK_INDEX_TYPE_UINT16 ) ? reinterpret_cast< const uint16 * >( draw->pIndices )[ draw->firstVertex + element ] : reinterpret_cast< const uint32 * >( draw->pIndices )[ draw->firstVertex + element ];
+}
+
+static uint32 ElementVertex( const rasterDraw_t * draw, uint32 element ) {
+	if ( draw->pIndices != NULL ) {
+		return ( uint32 )( ( int32 )ElementIndex( draw, element ) + draw->vertexOffset );
+	}
+	return draw->firstVertex + element;
+}
+
+static bool UsesRestart( const rasterDraw_t * draw ) {
+	return draw->pIndices != NULL && draw->pipeline->primitiveRestart && draw->pipeline->topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+}
+
+//The all-ones index of the index type, compared before vertexOffset is added
+static bool IsRestart( const rasterDraw_t * draw, uint32 element ) {
+	return ElementIndex( draw, element ) == ( ( draw->indexType == VK_INDEX_TYPE_UINT16 ) ? 0xFFFFu : 0xFFFFFFFFu );
+}
+
+/*
+================================================
+Primitive assembly
+
+A chunk gives every vertex its primitives reference a slot in the worker's vertex buffer, and the vertex
+shader then runs once per slot, RASTER_VERTEX_BATCH slots at a time.  Elements of a strip or fan are
+shared by up to three neighbouring triangles and get their slot once through a window over the chunk's
+elements.  Indexed draws also look every vertex index up in a direct-mapped post-transform cache, so an
+index repeated anywhere in the chunk is shaded once; a collision merely shades the vertex again.  Mesh
+index buffers reference nearby vertices, so the low bits of the index make a good key.
+
+With primitive restart, the all-ones index ends the current strip or fan and the next element starts a
+new one.  The chunks still cover one slot per potential triangle, and a slot whose three elements do not
+all belong to the same strip is skipped.
+================================================
+*/
+struct rasterCacheEntry_t {
+	uint32	vertex;
+	uint32	slot;				//RASTER_NO_SLOT when empty
+};
+
+struct rasterAssembly_t {
+	const rasterDraw_t *	draw;
+	rasterCacheEntry_t *	pCache;				//NULL for draws without an index buffer, which never repeat a vertex
+	uint32					cacheMask;
+	uint32					firstElement;		//the window
+	uint32					elementCount;
+	uint16					elementSlots[ RASTER_CHUNK_ELEMENTS ];
+	uint32					vertexIndices[ RASTER_CHUNK_ELEMENTS ];		//the vertex each slot holds
+	uint32					slotCount;
+};
+
+static void Assembly_Init( rasterAssembly_t * assembly, const rasterDraw_t * draw, rasterWorker_t * worker, uint32 firstElement, uint32 elementCount ) {
+	assembly->draw = draw;
+	assembly->pCache = NULL;
+	assembly->cacheMask = 0;
+	assembly->firstElement = firstElement;
+	assembly->elementCount = elementCount;
+	assembly->slotCount = 0;
+	memset( assembly->elementSlots, 0xFF, sizeof( uint16 ) * elementCount );
+	if ( draw->pIndices != NULL ) {
+		uint32 cacheSize = 64;
+		while ( cacheSize < elementCount && cacheSize < RASTER_VERTEX_CACHE_SIZE ) {
+			cacheSize *= 2;
+		}
+		assembly->pCache = worker->pVertexCache;
+		assembly->cacheMask = cacheSize - 1;
+		for ( uint32 i = 0; i < cacheSize; i++ ) {
+			assembly->pCache[ i ].slot = RASTER_NO_SLOT;
+		}
+	}
+}
+
+static uint32 Assembly_FetchVertex( rasterAssembly_t * assembly, uint32 element ) {
+	const uint32 vertex = ElementVertex( assembly->draw, element );
+	if ( assembly->pCache != NULL ) {
+		rasterCacheEntry_t & entry = assembly->pCache[ vertex & assembly->cacheMask ];
+		if ( entry.slot != RASTER_NO_SLOT && entry.vertex == vertex ) {
+			return entry.slot;
+		}
+		entry.vertex = vertex;
+		entry.slot = assembly->slotCount;
+	}
+	assembly->vertexIndices[ assembly->slotCount ] = vertex;
+	return assembly->slotCount++;
+}
+
+//Only a fan's hub can lie before the window
+static uint32 Assembly_Slot( rasterAssembly_t * assembly, uint32 element ) {
+	const uint32 offset = element - assembly->firstElement;
+	if ( offset >= assembly->elementCount ) {
+		return Assembly_FetchVertex( assembly, element );
+	}
+	if ( assembly->elementSlots[ offset ] == RASTER_NO_SLOT ) {
+		assembly->elementSlots[ offset ] = ( uint16 )Assembly_FetchVertex( assembly, element );
+	}
+	return assembly->elementSlots[ offset ];
+}
+
+/*
+================================================
+Clipping
+
+Triangles are clipped in clip space against the near and far planes and against a guard band, never the
+viewport itself: anything between the viewport and the guard band is simply rejected by the edge tests.
+Intersections are always computed from the inside vertex so an edge shared by two triangles is split at
+bit-identical points.
+================================================
+*/
+static uint32 ClipCode( const float * v, float guardX, float guardY ) {
+	uint32 code = 0;
+	code |= ( v[ 2 ] < 0.0f ) ? RASTER_CLIP_NEAR : 0;
+	code |= ( v[ 2 ] > v[ 3 ] ) ? RASTER_CLIP_FAR : 0;
+	code |= ( v[ 0 ] > guardX * v[ 3 ] ) ? RASTER_CLIP_RIGHT : 0;
+	code |= ( v[ 0 ] < -guardX * v[ 3 ] ) ? RASTER_CLIP_LEFT : 0;
+	code |= ( v[ 1 ] > guardY * v[ 3 ] ) ? RASTER_CLIP_BOTTOM : 0;
+	code |= ( v[ 1 ] < -guardY * v[ 3 ] ) ? RASTER_CLIP_TOP : 0;
+	return code;
+}
+
+static float ClipDistance( const float * v, uint32 plane, float guardX, float guardY ) {
+	switch ( plane ) {
+		case RASTER_CLIP_NEAR:		return v[ 2 ];
+		case RASTER_CLIP_FAR:		return v[ 3 ] - v[ 2 ];
+		case RASTER_CLIP_RIGHT:		return guardX * v[ 3 ] - v[ 0 ];
+		case RASTER_CLIP_LEFT:		return guardX * v[ 3 ] + v[ 0 ];
+		case RASTER_CLIP_BOTTOM:	return guardY * v[ 3 ] - v[ 1 ];
+		default:					return guardY * v[ 3 ] + v[ 1 ];
+	}
+}
+
+static void SetupTriangle( rasterSetup_t * setup, const float * v0, const float * v1, const float * v2 );
+
+static void ClipTriangle( rasterSetup_t * setup, const float * v0, const float * v1, const float * v2 ) {
+	const uint32 code0 = ClipCode( v0, setup->guardX, setup->guardY );
+	const uint32 code1 = ClipCode( v1, setup->guardX, setup->guardY );
+	const uint32 code2 = ClipCode( v2, setup->guardX, setup->guardY );
+	if ( ( code0 | code1 | code2 ) == 0 ) {
+		SetupTriangle( setup, v0, v1, v2 );
+		return;
+	}
+	if ( ( code0 & code1 & code2 ) != 0 ) {
+		return;
+	}
+
+	const uint32 stride = setup->stride;
+	float polygons[ 2 ][ RASTER_MAX_CLIP_VERTICES ][ RASTER_VERTEX_STRIDE_MAX ];
+	uint32 count = 3;
+	memcpy( polygons[ 0 ][ 0 ], v0, stride * sizeof( float ) );
+	memcpy( polygons[ 0 ][ 1 ], v1, stride * sizeof( float ) );
+	memcpy( polygons[ 0 ][ 2 ], v2, stride * sizeof( float ) );
+	uint32 current = 0;
+	const uint32 planes = code0 | code1 | code2;
+	for ( uint32 p = 0; p < RASTER_CLIP_PLANE_COUNT && count >= 3; p++ ) {
+		const uint32 plane = BIT( p );
+		if ( ( planes & plane ) == 0 ) {
+			continue;
+		}
+		float ( * in )[ RASTER_VERTEX_STRIDE_MAX ] = polygons[ current ];
+		float ( * out )[ RASTER_VERTEX_STRIDE_MAX ] = polygons[ current ^ 1 ];
+		uint32 outCount = 0;
+		for ( uint32 i = 0; i < count; i++ ) {
+			const float * a = in[ i ];
+			const float * b = in[ ( i + 1 ) % count ];
+			const float da = ClipDistance( a, plane, setup->guardX, setup->guardY );
+			const float db = ClipDistance( b, plane, setup->guardX, setup->guardY );
+			if ( da >= 0.0f ) {
+				memcpy( out[ outCount++ ], a, stride * sizeof( float ) );
+			}
+			if ( ( da >= 0.0f ) != ( db >= 0.0f ) ) {
+				const float * inside = ( da >= 0.0f ) ? a : b;
+				const float * outside = ( da >= 0.0f ) ? b : a;
+				const float dIn = ( da >= 0.0f ) ? da : db;
+				const float dOut = ( da >= 0.0f ) ? db : da;
+				const float t = dIn / ( dIn - dOut );
+				for ( uint32 c = 0; c < stride; c++ ) {
+					out[ outCount ][ c ] = inside[ c ] + t * ( outside[ c ] - inside[ c ] );
+				}
+				outCount++;
+			}
+		}
+		count = outCount;
+		current ^= 1;
+	}
+
+	for ( uint32 i = 2; i < count; i++ ) {
+		SetupTriangle( setup, polygons[ current ][ 0 ], polygons[ current ][ i - 1 ], polygons[ current ][ i ] );
+	}
+}
+
+/*
+================================================
+Setup
+================================================
+*/
+static void PlaneSetup( float * plane, float f0, float f1, float f2, float dx1, float dy1, float dx2, float dy2, float invArea ) {
+	plane[ 0 ] = ( ( f1 - f0 ) * dy2 - ( f2 - f0 ) * dy1 ) * invArea;
+	plane[ 1 ] = ( ( f2 - f0 ) * dx1 - ( f1 - f0 ) * dx2 ) * invArea;
+	plane[ 2 ] = f0;
+}
+
+static void SetupTriangle( rasterSetup_t * setup, const float * v0, const float * v1, const float * v2 ) {
+	const float * vertices[ 3 ] = { v0, v1, v2 };
+	int32 fixedX[ 3 ];
+	int32 fixedY[ 3 ];
+	float depth[ 3 ];
+	float invW[ 3 ];
+	for ( uint32 i = 0; i < 3; i++ ) {
+		const float * v = vertices[ i ];
+		if ( v[ 3 ] <= 0.0f ) {
+			return;
+		}
+		invW[ i ] = 1.0f / v[ 3 ];
+		const float x = setup->offsetX + v[ 0 ] * invW[ i ] * setup->scaleX;
+		const float y = setup->offsetY + v[ 1 ] * invW[ i ] * setup->scaleY;
+		fixedX[ i ] = ( int32 )floorf( x * RASTER_SUBPIXEL_ONE + 0.5f );
+		fixedY[ i ] = ( int32 )floorf( y * RASTER_SUBPIXEL_ONE + 0.5f );
+		depth[ i ] = setup->minDepth + v[ 2 ] * invW[ i ] * setup->depthRange;
+	}
+
+	int64 area2 = ( int64 )( fixedX[ 1 ] - fixedX[ 0 ] ) * ( fixedY[ 2 ] - fixedY[ 0 ] ) - ( int64 )( fixedY[ 1 ] - fixedY[ 0 ] ) * ( fixedX[ 2 ] - fixedX[ 0 ] );
+	if ( area2 == 0 ) {
+		return;
+	}
+	//Vulkan's signed area is the negation of area2 because framebuffer y points down
+	const rasterPipeline_t * pipeline = setup->pipeline;
+	const bool frontFacing = ( pipeline->frontFace == VK_FRONT_FACE_COUNTER_CLOCKWISE ) == ( area2 < 0 );
+	if ( ( pipeline->cullMode & ( frontFacing ? VK_CULL_MODE_FRONT_BIT : VK_CULL_MODE_BACK_BIT ) ) != 0 ) {
+		return;
+	}
+	uint32 order[ 3 ] = { 0, 1, 2 };
+	if ( area2 < 0 ) {
+		order[ 1 ] = 2;
+		order[ 2 ] = 1;
+		area2 = -area2;
+	}
+
+	//Pixel centres sit at +128 subpixels, so only those within the fixed-point bounds can be covered
+	const int32 minFixedX = Min( Min( fixedX[ 0 ], fixedX[ 1 ] ), fixedX[ 2 ] );
+	const int32 minFixedY = Min( Min( fixedY[ 0 ], fixedY[ 1 ] ), fixedY[ 2 ] );
+	const int32 maxFixedX = Max( Max( fixedX[ 0 ], fixedX[ 1 ] ), fixedX[ 2 ] );
+	const int32 maxFixedY = Max( Max( fixedY[ 0 ], fixedY[ 1 ] ), fixedY[ 2 ] );
+	const int32 half = RASTER_SUBPIXEL_ONE / 2;
+	const int32 minX = Max( ( minFixedX + half - 1 ) >> RASTER_SUBPIXEL_BITS, setup->clipMinX );
+	const int32 minY = Max( ( minFixedY + half - 1 ) >> RASTER_SUBPIXEL_BITS, setup->clipMinY );
+	const int32 maxX = Min( ( ( maxFixedX - half ) >> RASTER_SUBPIXEL_BITS ) + 1, setup->clipMaxX );
+	const int32 maxY = Min( ( ( maxFixedY - half ) >> RASTER_SUBPIXEL_BITS ) + 1, setup->clipMaxY );
+	if ( minX >= maxX || minY >= maxY ) {
+		return;
+	}
+
+	const uint32 planeCount = 2 + pipeline->varyingCount;
+	rasterTriangle_t * triangle = reinterpret_cast< rasterTriangle_t * >( HostArena_Allocate( &setup->worker->arena, sizeof( rasterTriangle_t ) + planeCount * 3 * sizeof( float ), 16 ) );
+	if ( triangle == NULL ) {
+		return;
+	}
+	triangle->minX = minX;
+	triangle->minY = minY;
+	triangle->maxX = maxX;
+	triangle->maxY = maxY;
+	triangle->frontFacing = frontFacing;
+	triangle->draw = setup->draw;
+	triangle->planes = reinterpret_cast< float * >( triangle + 1 );
+
+	for ( uint32 k = 0; k < 3; k++ ) {
+		const uint32 a = order[ k ];
+		const uint32 b = order[ ( k + 1 ) % 3 ];
+		const int32 edgeA = fixedY[ a ] - fixedY[ b ];
+		const int32 edgeB = fixedX[ b ] - fixedX[ a ];
+		//Top-left rule: with this winding a left edge has A > 0 and a top edge has A == 0, B > 0
+		const bool topLeft = ( edgeA > 0 ) || ( edgeA == 0 && edgeB > 0 );
+		triangle->edgeA[ k ] = edgeA;
+		triangle->edgeB[ k ] = edgeB;
+		triangle->edgeC[ k ] = ( int64 )fixedX[ a ] * fixedY[ b ] - ( int64 )fixedX[ b ] * fixedY[ a ] - ( topLeft ? 0 : 1 );
+	}
+
+	const uint32 i0 = order[ 0 ];
+	const uint32 i1 = order[ 1 ];
+	const uint32 i2 = order[ 2 ];
+	const float scale = 1.0f / RASTER_SUBPIXEL_ONE;
+	triangle->originX = fixedX[ i0 ] * scale;
+	triangle->originY = fixedY[ i0 ] * scale;
+	const float dx1 = ( fixedX[ i1 ] - fixedX[ i0 ] ) * scale;
+	const float dy1 = ( fixedY[ i1 ] - fixedY[ i0 ] ) * scale;
+	const float dx2 = ( fixedX[ i2 ] - fixedX[ i0 ] ) * scale;
+	const float dy2 = ( fixedY[ i2 ] - fixedY[ i0 ] ) * scale;
+	const float invArea = 1.0f / ( dx1 * dy2 - dy1 * dx2 );
+	float * plane = triangle->planes;
+	PlaneSetup( plane, depth[ i0 ], depth[ i1 ], depth[ i2 ], dx1, dy1, dx2, dy2, invArea );
+	//Every interpolated depth lies between the plane's values at the vertices, give or take rounding in the plane and its evaluation
+	const float extentX = Max( fabsf( minX + 0.5f - triangle->originX ), fabsf( maxX - 0.5f - triangle->originX ) );
+	const float extentY = Max( fabsf( minY + 0.5f - triangle->originY ), fabsf( maxY - 0.5f - triangle->originY ) );
+	triangle->zError = 16.0f * FLT_EPSILON * ( fabsf( plane[ 0 ] ) * extentX + fabsf( plane[ 1 ] ) * extentY + fabsf( plane[ 2 ] ) + fabsf( depth[ i1 ] ) + fabsf( depth[ i2 ] ) );
+	triangle->minZ = Min( Min( depth[ 0 ], depth[ 1 ] ), depth[ 2 ] ) - triangle->zError;
+	triangle->maxZ = Max( Max( depth[ 0 ], depth[ 1 ] ), depth[ 2 ] ) + triangle->zError;
+	plane += 3;
+	PlaneSetup( plane, invW[ i0 ], invW[ i1 ], invW[ i2 ], dx1, dy1, dx2, dy2, invArea );
+	plane += 3;
+	for ( uint32 i = 0; i < pipeline->varyingCount; i++, plane += 3 ) {
+		PlaneSetup( plane, vertices[ i0 ][ 4 + i ] * invW[ i0 ], vertices[ i1 ][ 4 + i ] * invW[ i1 ], vertices[ i2 ][ 4 + i ] * invW[ i2 ], dx1, dy1, dx2, dy2, invArea );
+	}
+
+	setup->worker->ppTriangles[ setup->triangleCount++ ] = triangle;
+}
+
+/*
+================================================
+Binning
+================================================
+*/
+//Rejects tiles the bounding box overlaps but the triangle misses, testing each edge at the tile's most inside pixel centre
+static bool TriangleTouchesTile( const rasterTriangle_t * triangle, uint32 tileX, uint32 tileY ) {
+	const int64 x0 = ( ( int64 )tileX << ( RASTER_TILE_SHIFT + RASTER_SUBPIXEL_BITS ) ) + RASTER_SUBPIXEL_ONE / 2;
+	const int64 y0 = ( ( int64 )tileY << ( RASTER_TILE_SHIFT + RASTER_SUBPIXEL_BITS ) ) + RASTER_SUBPIXEL_ONE / 2;
+	const int64 extent = ( int64 )( RASTER_TILE_SIZE - 1 ) << RASTER_SUBPIXEL_BITS;
+	for ( uint32 k = 0; k < 3; k++ ) {
+		const int64 x = ( triangle->edgeA[ k ] > 0 ) ? x0 + extent : x0;
+		const int64 y = ( triangle->edgeB[ k ] > 0 ) ? y0 + extent : y0;
+		if ( triangle->edgeA[ k ] * x + triangle->edgeB[ k ] * y + triangle->edgeC[ k ] < 0 ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool TriangleCoversTile( const rasterTriangle_t * triangle, uint32 tileX, uint32 tileY ) {
+	if ( ( ( uint32 )triangle->minX >> RASTER_TILE_SHIFT ) == ( ( uint32 )( triangle->maxX - 1 ) >> RASTER_TILE_SHIFT ) &&
+		( ( uint32 )triangle->minY >> RASTER_TILE_SHIFT ) == ( ( uint32 )( triangle->maxY - 1 ) >> RASTER_TILE_SHIFT ) ) {
+		return true;
+	}
+	return TriangleTouchesTile( triangle, tileX, tileY );
+}
+
+//Counting pass, prefix sum, then a reverse fill that leaves pTileOffsets[ t ] at the start of tile t's run
+static void BinTriangles( rasterPass_t * pass, rasterChunk_t * chunk, rasterWorker_t * worker, uint32 triangleCount ) {
+	const uint32 tileCount = pass->tilesX * pass->tilesY;
+	uint32 * offsets = reinterpret_cast< uint32 * >( HostArena_Allocate( &worker->arena, ( tileCount + 1 ) * sizeof( uint32 ), 16 ) );
+	if ( offsets == NULL ) {
+		return;
+	}
+	memset( offsets, 0, ( tileCount + 1 ) * sizeof( uint32 ) );
+	for ( uint32 i = 0; i < triangleCount; i++ ) {
+		const rasterTriangle_t * triangle = worker->ppTriangles[ i ];
+		for ( uint32 ty = ( uint32 )triangle->minY >> RASTER_TILE_SHIFT; ty <= ( uint32 )( triangle->maxY - 1 ) >> RASTER_TILE_SHIFT; ty++ ) {
+			for ( uint32 tx = ( uint32 )triangle->minX >> RASTER_TILE_SHIFT; tx <= ( uint32 )( triangle->maxX - 1 ) >> RASTER_TILE_SHIFT; tx++ ) {
+				if ( TriangleCoversTile( triangle, tx, ty ) ) {
+					offsets[ ty * pass->tilesX + tx ]++;
+				}
+			}
+		}
+	}
+	uint32 total = 0;
+	for ( uint32 t = 0; t < tileCount; t++ ) {
+		total += offsets[ t ];
+		offsets[ t ] = total;
+	}
+	offsets[ tileCount ] = total;
+	if ( total == 0 ) {
+		return;
+	}
+
+	rasterTriangle_t ** refs = reinterpret_cast< rasterTriangle_t ** >( HostArena_Allocate( &worker->arena, total * sizeof( rasterTriangle_t * ), 16 ) );
+	if ( refs == NULL ) {
+		return;
+	}
+	for ( uint32 i = triangleCount; i-- > 0; ) {
+		rasterTriangle_t * triangle = worker->ppTriangles[ i ];
+		for ( uint32 ty = ( uint32 )triangle->minY >> RASTER_TILE_SHIFT; ty <= ( uint32 )( triangle->maxY - 1 ) >> RASTER_TILE_SHIFT; ty++ ) {
+			for ( uint32 tx = ( uint32 )triangle->minX >> RASTER_TILE_SHIFT; tx <= ( uint32 )( triangle->maxX - 1 ) >> RASTER_TILE_SHIFT; tx++ ) {
+				if ( TriangleCoversTile( triangle, tx, ty ) ) {
+					refs[ --offsets[ ty * pass->tilesX + tx ] ] = triangle;
+				}
+			}
+		}
+	}
+	chunk->pTileOffsets = offsets;
+	chunk->ppTileTriangles = refs;
+}
+
+//Shades, clips and sets up one piece, appending its triangles to the worker's list
+static void FrontEnd_Piece( rasterSetup_t * setup, const rasterizer_t * rasterizer, const rasterPiece_t * piece, uint32 workerIndex ) {
+	const rasterDraw_t * draw = piece->draw;
+	const rasterPipeline_t * pipeline = draw->pipeline;
+	setup->draw = draw;
+	setup->pipeline = pipeline;
+	setup->stride = 4 + pipeline->varyingCount;
+	setup->scaleX = draw->viewport.width * 0.5f;
+	setup->scaleY = draw->viewport.height * 0.5f;
+	setup->offsetX = draw->viewport.x + setup->scaleX;
+	setup->offsetY = draw->viewport.y + setup->scaleY;
+	setup->minDepth = draw->viewport.minDepth;
+	setup->depthRange = draw->viewport.maxDepth - draw->viewport.minDepth;
+	setup->guardX = Max( ( RASTER_GUARD_BAND - fabsf( setup->offsetX ) ) / fabsf( setup->scaleX ), 1.0f );
+	setup->guardY = Max( ( RASTER_GUARD_BAND - fabsf( setup->offsetY ) ) / fabsf( setup->scaleY ), 1.0f );
+	setup->clipMinX = Max( draw->scissor.offset.x, rasterizer->renderArea.offset.x );
+	setup->clipMinY = Max( draw->scissor.offset.y, rasterizer->renderArea.offset.y );
+	setup->clipMaxX = Min( draw->scissor.offset.x + ( int32 )draw->scissor.extent.width, rasterizer->renderArea.offset.x + ( int32 )rasterizer->renderArea.extent.width );
+	setup->clipMaxY = Min( draw->scissor.offset.y + ( int32 )draw->scissor.extent.height, rasterizer->renderArea.offset.y + ( int32 )rasterizer->renderArea.extent.height );
+
+	//Assemble the triangles as slot triples first, so the vertex shader sees only distinct vertices
+	const bool list = ( pipeline->topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST );
+	const uint32 firstElement = list ? piece->firstPrimitive * 3 : piece->firstPrimitive;
+	const uint32 elementCount = list ? piece->primitiveCount * 3 : piece->primitiveCount + 2;
+	rasterAssembly_t assembly;
+	Assembly_Init( &assembly, draw, setup->worker, firstElement, elementCount );
+	uint16 triangles[ RASTER_CHUNK_PRIMITIVES ][ 3 ];
+	uint32 triangleCount = 0;
+	if ( list ) {
+		for ( uint32 p = 0; p < piece->primitiveCount; p++, triangleCount++ ) {
+			for ( uint32 k = 0; k < 3; k++ ) {
+				triangles[ triangleCount ][ k ] = ( uint16 )Assembly_Slot( &assembly, firstElement + p * 3 + k );
+			}
+		}
+	} else {
+		const bool restart = UsesRestart( draw );
+		const bool fan = ( pipeline->topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN );
+		uint32 stripStart = piece->stripStart;
+		uint32 hubSlot = RASTER_NO_SLOT;
+		for ( uint32 p = 0; p < piece->primitiveCount; p++ ) {
+			//Slot p ends at element + 2; the piece's stripStart already accounts for the two elements before it
+			const uint32 element = firstElement + p;
+			if ( restart && IsRestart( draw, element + 2 ) ) {
+				stripStart = element + 3;
+				hubSlot = RASTER_NO_SLOT;
+				continue;
+			}
+			if ( element < stripStart ) {
+				continue;
+			}
+			uint16 * triangle = triangles[ triangleCount++ ];
+			if ( fan ) {
+				if ( hubSlot == RASTER_NO_SLOT ) {
+					hubSlot = Assembly_Slot( &assembly, stripStart );
+				}
+				triangle[ 0 ] = ( uint16 )Assembly_Slot( &assembly, element + 1 );
+				triangle[ 1 ] = ( uint16 )Assembly_Slot( &assembly, element + 2 );
+				triangle[ 2 ] = ( uint16 )hubSlot;
+			} else {
+				//Odd triangles of a strip swap their first two vertices to keep the winding
+				const uint32 odd = ( element - stripStart ) & 1;
+				triangle[ 0 ] = ( uint16 )Assembly_Slot( &assembly, element + odd );
+				triangle[ 1 ] = ( uint16 )Assembly_Slot( &assembly, element + ( odd ^ 1 ) );
+				triangle[ 2 ] = ( uint16 )Assembly_Slot( &assembly, element + 2 );
+			}
+		}
+	}
+
+	const uint32 stride = setup->stride;
+	float * vertices = setup->worker->pVertices;
+	const uint32 instanceIndex = draw->firstInstance + piece->instanceIndex;
+	for ( uint32 first = 0; first < assembly.slotCount; first += RASTER_VERTEX_BATCH ) {
+		const uint32 count = Min( assembly.slotCount - first, ( uint32 )RASTER_VERTEX_BATCH );
+		pipeline->vertexShader( pipeline->pShaderData, draw->pBindings, workerIndex, assembly.vertexIndices + first, count, instanceIndex, vertices + first * stride, stride );
+	}
+
+	for ( uint32 t = 0; t < triangleCount; t++ ) {
+		ClipTriangle( setup, vertices + triangles[ t ][ 0 ] * stride, vertices + triangles[ t ][ 1 ] * stride, vertices + triangles[ t ][ 2 ] * stride );
+	}
+}
+
+static void FrontEnd_Job( void * pData, uint32 index, uint32 workerIndex ) {
+	rasterPass_t * pass = reinterpret_cast< rasterPass_t * >( pData );
+	rasterizer_t * rasterizer = pass->rasterizer;
+	rasterChunk_t * chunk = &pass->pChunks[ index ];
+	rasterSetup_t setup;
+	setup.worker = &rasterizer->pWorkers[ workerIndex ];
+	setup.triangleCount = 0;
+	for ( uint32 i = 0; i < chunk->pieceCount; i++ ) {
+		FrontEnd_Piece( &setup, rasterizer, &chunk->pPieces[ i ], workerIndex );
+	}
+	if ( setup.triangleCount != 0 ) {
+		BinTriangles( pass, chunk, setup.worker, setup.triangleCount );
+	}
+}
+
+/*
+================================================
+Depth
+
+The fragment stages round their depth the way the target stores it before testing, so a fragment compares
+against exactly what an earlier one stored, and the hierarchical depth holds those same values.
+================================================
+*/
+rasterDepthEncoding_t Rasterizer_DepthEncoding( VkFormat format ) {
+	rasterDepthEncoding_t encoding = { 0.0f, 0.0f };
+	switch ( format ) {
+		case VK_FORMAT_D16_UNORM:
+			encoding.scale = 65535.0f;
+			encoding.maxCode = 65535.0f;
+			break;
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+			encoding.scale = 16777216.0f;
+			encoding.maxCode = 16777215.0f;
+			break;
+		default:
+			break;
+	}
+	return encoding;
+}
+
+static uint32 EncodeDepth( const rasterDepthEncoding_t & encoding, float z ) {
+	return ( uint32 )nearbyintf( Min( Min( Max( z, 0.0f ), 1.0f ) * encoding.scale, encoding.maxCode ) );
+}
+
+static float LoadDepth( VkFormat format, const uint8 * texel ) {
+	const rasterDepthEncoding_t encoding = Rasterizer_DepthEncoding( format );
+	switch ( format ) {
+		case VK_FORMAT_D16_UNORM: {
+			uint16 bits;
+			memcpy( &bits, texel, sizeof( bits ) );
+			return ( float )bits * ( 1.0f / encoding.scale );
+		}
+		case VK_FORMAT_D24_UNORM_S8_UINT: {
+			uint32 bits;
+			memcpy( &bits, texel, sizeof( bits ) );
+			return ( float )( bits & 0x00FFFFFF ) * ( 1.0f / encoding.scale );
+		}
+		default: {
+			float z;
+			memcpy( &z, texel, sizeof( z ) );
+			return z;
+		}
+	}
+}
+
+//D24S8 keeps its stencil byte
+static void StoreDepth( VkFormat format, uint8 * texel, float z ) {
+	const rasterDepthEncoding_t encoding = Rasterizer_DepthEncoding( format );
+	switch ( format ) {
+		case VK_FORMAT_D16_UNORM: {
+			const uint16 bits = ( uint16 )EncodeDepth( encoding, z );
+			memcpy( texel, &bits, sizeof( bits ) );
+			break;
+		}
+		case VK_FORMAT_D24_UNORM_S8_UINT: {
+			uint32 bits;
+			memcpy( &bits, texel, sizeof( bits ) );
+			bits = ( bits & 0xFF000000 ) | EncodeDepth( encoding, z );
+			memcpy( texel, &bits, sizeof( bits ) );
+			break;
+		}
+		default:
+			memcpy( texel, &z, sizeof( z ) );
+			break;
+	}
+}
+
+static void StoreStencil( VkFormat format, uint8 * texel, uint32 stencil ) {
+	if ( format != VK_FORMAT_D24_UNORM_S8_UINT ) {
+		return;
+	}
+	uint32 bits;
+	memcpy( &bits, texel, sizeof( bits ) );
+	bits = ( bits & 0x00FFFFFF ) | ( stencil << 24 );
+	memcpy( texel, &bits, sizeof( bits ) );
+}
+
+//True when no depth in [ minZ, maxZ ] can pass op against any stored depth in [ storedMin, storedMax ]
+static bool DepthRejects( VkCompareOp op, float minZ, float maxZ, float storedMin, float storedMax ) {
+	switch ( op ) {
+		case VK_COMPARE_OP_NEVER:				return true;
+		case VK_COMPARE_OP_LESS:				return minZ >= storedMax;
+		case VK_COMPARE_OP_EQUAL:				return maxZ < storedMin || minZ > storedMax;
+		case VK_COMPARE_OP_LESS_OR_EQUAL:		return minZ > storedMax;
+		case VK_COMPARE_OP_GREATER:				return maxZ <= storedMin;
+		case VK_COMPARE_OP_NOT_EQUAL:			return minZ == maxZ && storedMin == storedMax && minZ == storedMin;
+		case VK_COMPARE_OP_GREATER_OR_EQUAL:	return maxZ < storedMin;
+		default:								return false;
+	}
+}
+
+/*
+================================================
+Hierarchical depth
+================================================
+*/
+static uint32 HiZ_Block( int32 x, int32 y ) {
+	return ( ( y & ( RASTER_TILE_SIZE - 1 ) ) >> RASTER_HIZ_SHIFT ) * ( RASTER_TILE_SIZE / RASTER_HIZ_SIZE ) + ( ( x & ( RASTER_TILE_SIZE - 1 ) ) >> RASTER_HIZ_SHIFT );
+}
+
+//Rereads one block's texels that lie inside the tile's area
+static void HiZ_ScanBlock( const rasterTarget_t & target, rasterTileState_t * tile, uint32 block ) {
+	const int32 blockX = ( tile->minX & ~( RASTER_TILE_SIZE - 1 ) ) + ( int32 )( block % ( RASTER_TILE_SIZE / RASTER_HIZ_SIZE ) ) * RASTER_HIZ_SIZE;
+	const int32 blockY = ( tile->minY & ~( RASTER_TILE_SIZE - 1 ) ) + ( int32 )( block / ( RASTER_TILE_SIZE / RASTER_HIZ_SIZE ) ) * RASTER_HIZ_SIZE;
+	float minZ = FLT_MAX;
+	float maxZ = -FLT_MAX;
+	for ( int32 y = Max( blockY, tile->minY ); y < Min( blockY + RASTER_HIZ_SIZE, tile->maxY ); y++ ) {
+		for ( int32 x = Max( blockX, tile->minX ); x < Min( blockX + RASTER_HIZ_SIZE, tile->maxX ); x++ ) {
+			const float z = LoadDepth( target.depthFormat, Surface_Texel( tile->depth, x, y ) );
+			minZ = Min( minZ, z );
+			maxZ = Max( maxZ, z );
+		}
+	}
+	tile->hiZ.minZ[ block ] = minZ;
+	tile->hiZ.maxZ[ block ] = maxZ;
+	tile->hiZ.tileDirty = true;
+}
+
+static void HiZ_Build( const rasterTarget_t & target, rasterTileState_t * tile ) {
+	for ( uint32 block = 0; block < RASTER_HIZ_TILE_BLOCKS; block++ ) {
+		HiZ_ScanBlock( target, tile, block );
+	}
+	tile->hiZ.valid = true;
+}
+
+static void HiZ_Clear( rasterTileState_t * tile, float z ) {
+	for ( uint32 block = 0; block < RASTER_HIZ_TILE_BLOCKS; block++ ) {
+		tile->hiZ.minZ[ block ] = z;
+		tile->hiZ.maxZ[ block ] = z;
+	}
+	tile->hiZ.tileMinZ = z;
+	tile->hiZ.tileMaxZ = z;
+	tile->hiZ.tileDirty = false;
+	tile->hiZ.valid = true;
+}
+
+static void HiZ_UpdateTile( rasterHiZ_t * hiZ ) {
+	if ( !hiZ->tileDirty ) {
+		return;
+	}
+	hiZ->tileMinZ = FLT_MAX;
+	hiZ->tileMaxZ = -FLT_MAX;
+	for ( uint32 block = 0; block < RASTER_HIZ_TILE_BLOCKS; block++ ) {
+		hiZ->tileMinZ = Min( hiZ->tileMinZ, hiZ->minZ[ block ] );
+		hiZ->tileMaxZ = Max( hiZ->tileMaxZ, hiZ->maxZ[ block ] );
+	}
+	hiZ->tileDirty = false;
+}
+
+//Folds the depth a block just wrote into its 8x8 block; only overwriting the block's farthest texel with something nearer forces a rescan
+static void HiZ_Write( const rasterTarget_t & target, rasterTileState_t * tile, const rasterFragmentBatch_t * batch, const float * previous ) {
+	const uint32 block = HiZ_Block( batch->x, batch->y );
+	rasterHiZ_t * hiZ = &tile->hiZ;
+	float minZ = hiZ->minZ[ block ];
+	float maxZ = hiZ->maxZ[ block ];
+	bool rescan = false;
+	for ( uint32 mask = batch->coverageMask; mask != 0; mask &= mask - 1 ) {
+		const uint32 lane = LowestBitIndex( mask );
+		const float z = batch->depth[ lane ];
+		minZ = Min( minZ, z );
+		rescan |= ( previous[ lane ] == hiZ->maxZ[ block ] && z < previous[ lane ] );
+		maxZ = Max( maxZ, z );
+	}
+	if ( rescan ) {
+		HiZ_ScanBlock( target, tile, block );
+		return;
+	}
+	if ( minZ != hiZ->minZ[ block ] || maxZ != hiZ->maxZ[ block ] ) {
+		hiZ->minZ[ block ] = minZ;
+		hiZ->maxZ[ block ] = maxZ;
+		hiZ->tileDirty = true;
+	}
+}
+
+/*
+================================================
+Back end
+================================================
+*/
+//Color attachments are 32-bit, so the packed clear fits a single store per texel
+static bool PackColor( VkFormat format, const float * rgba, uint32 * pPacked ) {
+	formatConverter_t converter;
+	if ( !Format_SelectConverter( format, cpuIsa_t::SCALAR, &converter ) || converter.info->bytesPerTexel != sizeof( *pPacked ) || Format_IsInteger( converter.info ) ) {
+		return false;
+	}
+	uint32 texel[ FORMAT_TEXEL_LANES ];
+	memcpy( texel, rgba, sizeof( texel ) );
+	converter.pack( converter.info, texel, 1, reinterpret_cast< uint8 * >( pPacked ) );
+	return true;
+}
+
+//Lanes of the block at ( blockX, blockY ) that fall inside [ minX, maxX ) x [ minY, maxY )
+static uint32 BlockRectMask( int32 blockX, int32 blockY, int32 minX, int32 minY, int32 maxX, int32 maxY ) {
+	uint32 columns = 0;
+	for ( int32 lx = 0; lx < RASTER_BLOCK_SIZE; lx++ ) {
+		columns |= ( blockX + lx >= minX && blockX + lx < maxX ) ? BIT( lx ) : 0;
+	}
+	uint32 mask = 0;
+	for ( int32 ly = 0; ly < RASTER_BLOCK_SIZE; ly++ ) {
+		mask |= ( blockY + ly >= minY && blockY + ly < maxY ) ? columns << ( ly * RASTER_BLOCK_SIZE ) : 0;
+	}
+	return mask;
+}
+
+//Gathers the block's target texels, runs the pipeline's fragment stage and writes back the lanes it kept
+static void ShadeBlock( const rasterizer_t * rasterizer, const rasterDraw_t * draw, const rasterTriangle_t * triangle, uint32 workerIndex, rasterTileState_t * tile, rasterFragmentBatch_t * batch ) {
+	const rasterTarget_t & target = rasterizer->target;
+	const rasterPipeline_t * pipeline = draw->pipeline;
+	uint8 * colorTexels[ RASTER_FRAGMENT_BATCH ];
+	uint8 * depthTexels[ RASTER_FRAGMENT_BATCH ];
+	for ( uint32 mask = batch->coverageMask; mask != 0; mask &= mask - 1 ) {
+		const uint32 lane = LowestBitIndex( mask );
+		const int32 x = batch->x + ( int32 )( lane & ( RASTER_BLOCK_SIZE - 1 ) );
+		const int32 y = batch->y + ( int32 )( lane >> RASTER_BLOCK_SHIFT );
+		if ( tile->color.data != NULL ) {
+			colorTexels[ lane ] = Surface_Texel( tile->color, x, y );
+			memcpy( &batch->color[ lane ], colorTexels[ lane ], sizeof( uint32 ) );
+		}
+		if ( tile->depth.data != NULL ) {
+			depthTexels[ lane ] = Surface_Texel( tile->depth, x, y );
+			batch->depth[ lane ] = LoadDepth( target.depthFormat, depthTexels[ lane ] );
+		}
+	}
+	const bool writeDepth = ( tile->depth.data != NULL && pipeline->depthWrite );
+	float previous[ RASTER_FRAGMENT_BATCH ];
+	if ( writeDepth && tile->hiZ.valid ) {
+		memcpy( previous, batch->depth, sizeof( previous ) );
+	}
+
+	pipeline->fragmentShader( pipeline->pShaderData, draw->pBindings, workerIndex, triangle, batch );
+
+	for ( uint32 mask = batch->coverageMask; mask != 0; mask &= mask - 1 ) {
+		const uint32 lane = LowestBitIndex( mask );
+		if ( tile->color.data != NULL ) {
+			memcpy( colorTexels[ lane ], &batch->color[ lane ], sizeof( uint32 ) );
+		}
+		if ( writeDepth ) {
+			StoreDepth( target.depthFormat, depthTexels[ lane ], batch->depth[ lane ] );
+		}
+	}
+	if ( writeDepth && tile->hiZ.valid && batch->coverageMask != 0 ) {
+		HiZ_Write( target, tile, batch, previous );
+	}
+}
+
+static void RasterizeTriangle( const rasterizer_t * rasterizer, const rasterDraw_t * draw, const rasterTriangle_t * triangle, uint32 workerIndex, rasterTileState_t * tile ) {
+	const int32 minX = Max( triangle->minX, tile->minX );
+	const int32 minY = Max( triangle->minY, tile->minY );
+	const int32 maxX = Min( triangle->maxX, tile->maxX );
+	const int32 maxY = Min( triangle->maxY, tile->maxY );
+	if ( minX >= maxX || minY >= maxY ) {
+		return;
+	}
+	const VkCompareOp depthCull = ( tile->depth.data != NULL ) ? draw->pipeline->depthCull : VK_COMPARE_OP_ALWAYS;
+	if ( depthCull != VK_COMPARE_OP_ALWAYS ) {
+		if ( !tile->hiZ.valid ) {
+			HiZ_Build( rasterizer->target, tile );
+		}
+		HiZ_UpdateTile( &tile->hiZ );
+		if ( DepthRejects( depthCull, Rasterizer_QuantizeDepth( tile->depthEncoding, triangle->minZ ), Rasterizer_QuantizeDepth( tile->depthEncoding, triangle->maxZ ), tile->hiZ.tileMinZ, tile->hiZ.tileMaxZ ) ) {
+			return;
+		}
+	}
+	const float * depthPlane = triangle->planes;
+	const float blockSpan = ( float )( RASTER_BLOCK_SIZE - 1 );
+
+	rasterFragmentBatch_t batch;
+	batch.frontFacing = triangle->frontFacing;
+	const int32 firstBlockX = minX & ~( RASTER_BLOCK_SIZE - 1 );
+	const uint32 blockCount = ( uint32 )( maxX - firstBlockX + RASTER_BLOCK_SIZE - 1 ) >> RASTER_BLOCK_SHIFT;
+	uint32 masks[ RASTER_TILE_SIZE / RASTER_BLOCK_SIZE ];
+	for ( int32 blockY = minY & ~( RASTER_BLOCK_SIZE - 1 ); blockY < maxY; blockY += RASTER_BLOCK_SIZE ) {
+		rasterizer->coverage( triangle, firstBlockX, blockY, blockCount, masks );
+		for ( uint32 b = 0; b < blockCount; b++ ) {
+			const int32 blockX = firstBlockX + ( int32 )( b << RASTER_BLOCK_SHIFT );
+			const uint32 mask = masks[ b ] & BlockRectMask( blockX, blockY, minX, minY, maxX, maxY );
+			if ( mask == 0 ) {
+				continue;
+			}
+			if ( depthCull != VK_COMPARE_OP_ALWAYS ) {
+				//The block's depth range from the plane, tested against the 8x8 block that holds it
+				const float z = depthPlane[ 0 ] * ( blockX + 0.5f - triangle->originX ) + depthPlane[ 1 ] * ( blockY + 0.5f - triangle->originY ) + depthPlane[ 2 ];
+				const float low = z + Min( depthPlane[ 0 ] * blockSpan, 0.0f ) + Min( depthPlane[ 1 ] * blockSpan, 0.0f ) - triangle->zError;
+				const float high = z + Max( depthPlane[ 0 ] * blockSpan, 0.0f ) + Max( depthPlane[ 1 ] * blockSpan, 0.0f ) + triangle->zError;
+				const uint32 block = HiZ_Block( blockX, blockY );
+				if ( DepthRejects( depthCull, Rasterizer_QuantizeDepth( tile->depthEncoding, Max( low, triangle->minZ ) ), Rasterizer_QuantizeDepth( tile->depthEncoding, Min( high, triangle->maxZ ) ), tile->hiZ.minZ[ block ], tile->hiZ.maxZ[ block ] ) ) {
+					continue;
+				}
+			}
+			batch.x = blockX;
+			batch.y = blockY;
+			batch.coverageMask = mask;
+			ShadeBlock( rasterizer, draw, triangle, workerIndex, tile, &batch );
+		}
+	}
+}
+
+static bool TileTouched( const rasterPass_t * pass, uint32 tileIndex ) {
+	for ( uint32 c = 0; c < pass->chunkCount; c++ ) {
+		const rasterChunk_t & chunk = pass->pChunks[ c ];
+		if ( chunk.pTileOffsets != NULL && chunk.pTileOffsets[ tileIndex ] != chunk.pTileOffsets[ tileIndex + 1 ] ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+Brings a tile of a lazily cleared target up to date before the pass writes to it, and returns whether the
+pass still has to clear the tile's part of the render area itself.  A tile the clear covers whole and no
+triangle touches is only marked.  *pHoldsClear is set when the tile's memory holds the clear state's value.
+*/
+static bool PrepareClearTile( imageClearState_t * state, uint8 * data, const rasterTileState_t & tile, uint32 tileX, uint32 tileY, bool clear, bool lazy, bool touched, bool * pHoldsClear ) {
+	*pHoldsClear = false;
+	if ( state == NULL || data == NULL ) {
+		return clear;
+	}
+	const imageMipLayout_t & mip = state->layout->mips[ state->mipLevel ];
+	const bool wholeTile = tile.minX == ( int32 )( tileX << RASTER_TILE_SHIFT ) && tile.minY == ( int32 )( tileY << RASTER_TILE_SHIFT ) &&
+		tile.maxX == ( int32 )Min( ( tileX + 1 ) << RASTER_TILE_SHIFT, mip.width ) && tile.maxY == ( int32 )Min( ( tileY + 1 ) << RASTER_TILE_SHIFT, mip.height );
+	imageClearTile_t & tileState = state->pTiles[ tileY * state->tilesX + tileX ];
+	if ( clear && lazy && wholeTile ) {
+		if ( !touched ) {
+			if ( tileState == imageClearTile_t::STORED ) {
+				tileState = imageClearTile_t::PENDING;
+			}
+			return false;
+		}
+		if ( tileState != imageClearTile_t::RESOLVED ) {
+			ImageClear_FillTile( state, data, tileX, tileY );
+		}
+		tileState = imageClearTile_t::STORED;
+		*pHoldsClear = true;
+		return false;
+	}
+	if ( !clear && !touched ) {
+		return false;
+	}
+	//The pass writes part of the tile, so the rest has to hold the value it was cleared to
+	if ( tileState == imageClearTile_t::PENDING ) {
+		ImageClear_FillTile( state, data, tileX, tileY );
+	}
+	*pHoldsClear = ( tileState != imageClearTile_t::STORED );
+	tileState = imageClearTile_t::STORED;
+	return clear;
+}
+
+static void InitSurface( rasterSurface_t * surface, uint8 * data, const imageLayout_t * layout, uint32 mipLevel, uint32 arrayLayer, int32 originX, int32 originY ) {
+	surface->data = data;
+	surface->layout = layout;
+	surface->mipLevel = mipLevel;
+	surface->arrayLayer = arrayLayer;
+	surface->originX = originX;
+	surface->originY = originY;
+}
+
+static void BackEnd_Job( void * pData, uint32 index, uint32 workerIndex ) {
+	rasterPass_t * pass = reinterpret_cast< rasterPass_t * >( pData );
+	const rasterizer_t * rasterizer = pass->rasterizer;
+	const uint32 tileX = pass->firstTileX + index % pass->areaTilesX;
+	const uint32 tileY = pass->firstTileY + index / pass->areaTilesX;
+	const uint32 tileIndex = tileY * pass->tilesX + tileX;
+	const VkRect2D & area = rasterizer->renderArea;
+	rasterTileState_t tile;
+	tile.minX = Max( ( int32 )( tileX << RASTER_TILE_SHIFT ), area.offset.x );
+	tile.minY = Max( ( int32 )( tileY << RASTER_TILE_SHIFT ), area.offset.y );
+	tile.maxX = Min( ( int32 )( ( tileX + 1 ) << RASTER_TILE_SHIFT ), area.offset.x + ( int32 )area.extent.width );
+	tile.maxY = Min( ( int32 )( ( tileY + 1 ) << RASTER_TILE_SHIFT ), area.offset.y + ( int32 )area.extent.height );
+	tile.hiZ.valid = false;
+
+	const rasterTarget_t & target = rasterizer->target;
+	const int32 tileOriginX = ( int32 )( tileX << RASTER_TILE_SHIFT );
+	const int32 tileOriginY = ( int32 )( tileY << RASTER_TILE_SHIFT );
+	uint8 * scratch = rasterizer->pWorkers[ workerIndex ].pTileScratch;
+	if ( target.transient ) {
+		InitSurface( &tile.color, scratch, &rasterizer->scratchLayout, 0, 0, tileOriginX, tileOriginY );
+	} else {
+		InitSurface( &tile.color, target.data, target.layout, target.mipLevel, target.arrayLayer, 0, 0 );
+	}
+	if ( target.depthTransient ) {
+		InitSurface( &tile.depth, scratch + RASTER_SCRATCH_PLANE_BYTES, &rasterizer->scratchDepthLayout, 0, 0, tileOriginX, tileOriginY );
+	} else {
+		InitSurface( &tile.depth, target.depthData, target.depthLayout, target.mipLevel, target.arrayLayer, 0, 0 );
+	}
+	tile.depthEncoding = Rasterizer_DepthEncoding( target.depthFormat );
+	const bool touched = TileTouched( pass, tileIndex );
+	bool colorHoldsClear;
+	bool depthHoldsClear;
+	const bool clearColor = PrepareClearTile( rasterizer->colorTiles, target.data, tile, tileX, tileY, rasterizer->clear, rasterizer->lazyClear, touched, &colorHoldsClear );
+	const bool clearDepth = PrepareClearTile( rasterizer->depthTiles, target.depthData, tile, tileX, tileY, rasterizer->clearDepth || rasterizer->clearStencil, rasterizer->lazyClearDepth, touched, &depthHoldsClear );
+	uint32 packedClear;
+	if ( clearColor && tile.color.data != NULL && PackColor( target.format, rasterizer->clearColor, &packedClear ) ) {
+		for ( int32 y = tile.minY; y < tile.maxY; y++ ) {
+			for ( int32 x = tile.minX; x < tile.maxX; x++ ) {
+				*reinterpret_cast< uint32 * >( Surface_Texel( tile.color, x, y ) ) = packedClear;
+			}
+		}
+	}
+	if ( clearDepth && tile.depth.data != NULL ) {
+		for ( int32 y = tile.minY; y < tile.maxY; y++ ) {
+			for ( int32 x = tile.minX; x < tile.maxX; x++ ) {
+				uint8 * texel = Surface_Texel( tile.depth, x, y );
+				if ( rasterizer->clearDepth ) {
+					StoreDepth( target.depthFormat, texel, rasterizer->clearDepthValue );
+				}
+				if ( rasterizer->clearStencil ) {
+					StoreStencil( target.depthFormat, texel, rasterizer->clearStencilValue );
+				}
+			}
+		}
+	}
+	if ( rasterizer->clearDepth && tile.depth.data != NULL ) {
+		HiZ_Clear( &tile, Rasterizer_QuantizeDepth( tile.depthEncoding, rasterizer->clearDepthValue ) );
+	} else if ( depthHoldsClear ) {
+		HiZ_Clear( &tile, LoadDepth( target.depthFormat, rasterizer->depthTiles->value ) );
+	}
+
+	for ( uint32 c = 0; c < pass->chunkCount; c++ ) {
+		const rasterChunk_t & chunk = pass->pChunks[ c ];
+		if ( chunk.pTileOffsets == NULL ) {
+			continue;
+		}
+		for ( uint32 i = chunk.pTileOffsets[ tileIndex ]; i < chunk.pTileOffsets[ tileIndex + 1 ]; i++ ) {
+			const rasterTriangle_t * triangle = chunk.ppTileTriangles[ i ];
+			RasterizeTriangle( rasterizer, triangle->draw, triangle, workerIndex, &tile );
+		}
+	}
+}
+
+/*
+================================================
+rasterizer_t
+================================================
+*/
+bool Rasterizer_Init( rasterizer_t * rasterizer, threadPool_t * pool, const VkAllocationCallbacks * allocator, cpuIsa_t isa ) {
+	rasterizer->pool = pool;
+	rasterizer->allocator = allocator;
+	rasterizer->coverage = Rasterizer_SelectCoverage( isa );
+	rasterizer->workerCount = 0;
+	rasterizer->pWorkers = NULL;
+	HostArena_Init( &rasterizer->passArena, false );
+	//The rest of the pass state is set by Rasterizer_BeginPass
+	rasterizer->pDrawHead = NULL;
+	rasterizer->pDrawTail = NULL;
+
+	//One slot per pool thread plus the external waiter, indexed by the workerIndex jobs receive
+	const uint32 workerCount = ThreadPool_Concurrency( pool );
+	rasterizer->pWorkers = reinterpret_cast< rasterWorker_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( rasterWorker_t ) * workerCount, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+	if ( rasterizer->pWorkers == NULL ) {
+		return false;
+	}
+	//Every worker is cleared before any allocation, so Rasterizer_Shutdown can unwind a partial init
+	for ( uint32 i = 0; i < workerCount; i++ ) {
+		rasterWorker_t * worker = &rasterizer->pWorkers[ i ];
+		HostArena_Init( &worker->arena, false );
+		worker->pVertices = NULL;
+		worker->pVertexCache = NULL;
+		worker->ppTriangles = NULL;
+		worker->pTileScratch = NULL;
+	}
+	rasterizer->workerCount = workerCount;
+	for ( uint32 i = 0; i < workerCount; i++ ) {
+		rasterWorker_t * worker = &rasterizer->pWorkers[ i ];
+		worker->pVertices = reinterpret_cast< float * >( allocator->pfnAllocation( allocator->pUserData, sizeof( float ) * RASTER_CHUNK_ELEMENTS * RASTER_VERTEX_STRIDE_MAX, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+		worker->pVertexCache = reinterpret_cast< rasterCacheEntry_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( rasterCacheEntry_t ) * RASTER_VERTEX_CACHE_SIZE, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+		worker->ppTriangles = reinterpret_cast< rasterTriangle_t ** >( allocator->pfnAllocation( allocator->pUserData, sizeof( rasterTriangle_t * ) * RASTER_CHUNK_PRIMITIVES * RASTER_MAX_CLIP_TRIANGLES, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+		worker->pTileScratch = reinterpret_cast< uint8 * >( allocator->pfnAllocation( allocator->pUserData, RASTER_SCRATCH_PLANE_BYTES * 2, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+		if ( worker->pVertices == NULL || worker->pVertexCache == NULL || worker->ppTriangles == NULL || worker->pTileScratch == NULL ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Rasterizer_Shutdown( rasterizer_t * rasterizer ) {
+	const VkAllocationCallbacks * allocator = rasterizer->allocator;
+	for ( uint32 i = 0; i < rasterizer->workerCount; i++ ) {
+		rasterWorker_t * worker = &rasterizer->pWorkers[ i ];
+		HostArena_Destroy( &worker->arena );
+		if ( worker->pVertices != NULL ) {
+			allocator->pfnFree( allocator->pUserData, worker->pVertices );
+		}
+		if ( worker->pVertexCache != NULL ) {
+			allocator->pfnFree( allocator->pUserData, worker->pVertexCache );
+		}
+		if ( worker->ppTriangles != NULL ) {
+			allocator->pfnFree( allocator->pUserData, worker->ppTriangles );
+		}
+		if ( worker->pTileScratch != NULL ) {
+			allocator->pfnFree( allocator->pUserData, worker->pTileScratch );
+		}
+	}
+	if ( rasterizer->pWorkers != NULL ) {
+		allocator->pfnFree( allocator->pUserData, rasterizer->pWorkers );
+	}
+	HostArena_Destroy( &rasterizer->passArena );
+	rasterizer->workerCount = 0;
+	rasterizer->pWorkers = NULL;
+}
+
+//One tile of an attachment as an optimal image, so scratch texels sit where they would in the image's own tiles
+static void ScratchLayout( imageLayout_t * layout, VkFormat format ) {
+	VkImageCreateInfo createInfo;
+	memset( &createInfo, 0, sizeof( createInfo ) );
+	createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	createInfo.imageType = VK_IMAGE_TYPE_2D;
+	createInfo.format = format;
+	createInfo.extent = { RASTER_TILE_SIZE, RASTER_TILE_SIZE, 1 };
+	createInfo.mipLevels = 1;
+	createInfo.arrayLayers = 1;
+	createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	ImageLayout_Init( layout, &createInfo );
+}
+
+void Rasterizer_BeginPass( rasterizer_t * rasterizer, const rasterTarget_t * target, const VkRect2D & renderArea, const float * pClearColor, const float * pClearDepth, const uint32 * pClearStencil ) {
+	rasterizer->target = *target;
+	if ( target->transient ) {
+		ScratchLayout( &rasterizer->scratchLayout, target->format );
+	}
+	if ( target->depthTransient ) {
+		ScratchLayout( &rasterizer->scratchDepthLayout, target->depthFormat );
+	}
+	//Clamp once here so the back end can trust the render area to lie inside the target
+	const int32 minX = Max( renderArea.offset.x, 0 );
+	const int32 minY = Max( renderArea.offset.y, 0 );
+	const int32 maxX = Min( renderArea.offset.x + ( int32 )renderArea.extent.width, ( int32 )target->width );
+	const int32 maxY = Min( renderArea.offset.y + ( int32 )renderArea.extent.height, ( int32 )target->height );
+	rasterizer->renderArea.offset.x = minX;
+	rasterizer->renderArea.offset.y = minY;
+	rasterizer->renderArea.extent.width = ( maxX > minX ) ? maxX - minX : 0;
+	rasterizer->renderArea.extent.height = ( maxY > minY ) ? maxY - minY : 0;
+	rasterizer->clear = ( pClearColor != NULL );
+	if ( pClearColor != NULL ) {
+		memcpy( rasterizer->clearColor, pClearColor, sizeof( rasterizer->clearColor ) );
+	}
+	rasterizer->clearDepth = ( pClearDepth != NULL );
+	if ( pClearDepth != NULL ) {
+		rasterizer->clearDepthValue = *pClearDepth;
+	}
+	rasterizer->clearStencil = ( pClearStencil != NULL );
+	if ( pClearStencil != NULL ) {
+		rasterizer->clearStencilValue = *pClearStencil;
+	}
+
+	//A clear can only be deferred when it sets whole texels; clearing D24S8 depth alone keeps the stencil in memory
+	uint8 value[ IMAGE_CLEAR_MAX_TEXEL_BYTES ];
+	uint32 packedClear;
+	rasterizer->lazyClear = false;
+	if ( rasterizer->clear && target->data != NULL && target->clearState != NULL && PackColor( target->format, rasterizer->clearColor, &packedClear ) ) {
+		memcpy( value, &packedClear, sizeof( packedClear ) );
+		ImageClear_Retarget( target->clearState, target->data, target->mipLevel, target->arrayLayer, value );
+		rasterizer->lazyClear = true;
+	}
+	rasterizer->lazyClearDepth = false;
+	if ( rasterizer->clearDepth && target->depthData != NULL && target->depthClearState != NULL && ( target->depthFormat != VK_FORMAT_D24_UNORM_S8_UINT || rasterizer->clearStencil ) ) {
+		memset( value, 0, sizeof( value ) );
+		StoreDepth( target->depthFormat, value, rasterizer->clearDepthValue );
+		StoreStencil( target->depthFormat, value, rasterizer->clearStencilValue );
+		ImageClear_Retarget( target->depthClearState, target->depthData, target->mipLevel, target->arrayLayer, value );
+		rasterizer->lazyClearDepth = true;
+	}
+	rasterizer->colorTiles = ( target->data != NULL && ImageClear_Tracks( target->clearState, target->mipLevel, target->arrayLayer ) ) ? target->clearState : NULL;
+	rasterizer->depthTiles = ( target->depthData != NULL && ImageClear_Tracks( target->depthClearState, target->mipLevel, target->arrayLayer ) ) ? target->depthClearState : NULL;
+	rasterizer->pDrawHead = NULL;
+	rasterizer->pDrawTail = NULL;
+}
+
+void Rasterizer_Draw( rasterizer_t * rasterizer, const rasterDraw_t * draw ) {
+	if ( draw->instanceCount == 0 || draw->pipeline->varyingCount > RASTER_MAX_VARYINGS || PrimitiveCount( draw ) == 0 ) {
+		return;
+	}
+	rasterDrawNode_t * node = reinterpret_cast< rasterDrawNode_t * >( HostArena_Allocate( &rasterizer->passArena, sizeof( rasterDrawNode_t ), 16 ) );
+	if ( node == NULL ) {
+		return;
+	}
+	node->draw = *draw;
+	node->pNext = NULL;
+	if ( rasterizer->pDrawTail != NULL ) {
+		rasterizer->pDrawTail->pNext = node;
+	} else {
+		rasterizer->pDrawHead = node;
+	}
+	rasterizer->pDrawTail = node;
+}
+
+void Rasterizer_EndPass( rasterizer_t * rasterizer ) {
+	const VkRect2D & area = rasterizer->renderArea;
+	if ( area.extent.width == 0 || area.extent.height == 0 ) {
+		HostArena_Reset( &rasterizer->passArena );
+		return;
+	}
+
+	rasterPass_t pass;
+	pass.rasterizer = rasterizer;
+	pass.tilesX = ( rasterizer->target.width + RASTER_TILE_SIZE - 1 ) >> RASTER_TILE_SHIFT;
+	pass.tilesY = ( rasterizer->target.height + RASTER_TILE_SIZE - 1 ) >> RASTER_TILE_SHIFT;
+	pass.firstTileX = area.offset.x >> RASTER_TILE_SHIFT;
+	pass.firstTileY = area.offset.y >> RASTER_TILE_SHIFT;
+	pass.areaTilesX = ( ( area.offset.x + area.extent.width - 1 ) >> RASTER_TILE_SHIFT ) - pass.firstTileX + 1;
+	const uint32 areaTilesY = ( ( area.offset.y + area.extent.height - 1 ) >> RASTER_TILE_SHIFT ) - pass.firstTileY + 1;
+
+	uint32 pieceCount = 0;
+	for ( rasterDrawNode_t * node = rasterizer->pDrawHead; node != NULL; node = node->pNext ) {
+		const uint32 primitiveCount = PrimitiveCount( &node->draw );
+		pieceCount += node->draw.instanceCount * ( ( primitiveCount + RASTER_CHUNK_PRIMITIVES - 1 ) / RASTER_CHUNK_PRIMITIVES );
+	}
+	const uint32 tileJobCount = pass.areaTilesX * areaTilesY;
+	pass.pPieces = reinterpret_cast< rasterPiece_t * >( HostArena_Allocate( &rasterizer->passArena, sizeof( rasterPiece_t ) * Max( pieceCount, 1U ), 16 ) );
+	pass.pChunks = reinterpret_cast< rasterChunk_t * >( HostArena_Allocate( &rasterizer->passArena, sizeof( rasterChunk_t ) * Max( pieceCount, 1U ), 16 ) );
+	job_t * pJobs = reinterpret_cast< job_t * >( HostArena_Allocate( &rasterizer->passArena, sizeof( job_t ) * Max( pieceCount, tileJobCount ), 16 ) );
+	if ( pass.pPieces == NULL || pass.pChunks == NULL || pJobs == NULL ) {
+		HostArena_Reset( &rasterizer->passArena );
+		return;
+	}
+
+	rasterPiece_t * piece = pass.pPieces;
+	for ( rasterDrawNode_t * node = rasterizer->pDrawHead; node != NULL; node = node->pNext ) {
+		const uint32 primitiveCount = PrimitiveCount( &node->draw );
+		const uint32 piecesPerInstance = ( primitiveCount + RASTER_CHUNK_PRIMITIVES - 1 ) / RASTER_CHUNK_PRIMITIVES;
+		const bool restart = UsesRestart( &node->draw );
+		uint32 stripStart = 0;
+		uint32 scanned = 0;
+		for ( uint32 instance = 0; instance < node->draw.instanceCount; instance++ ) {
+			for ( uint32 first = 0; first < primitiveCount; first += RASTER_CHUNK_PRIMITIVES, piece++ ) {
+				piece->draw = &node->draw;
+				piece->instanceIndex = instance;
+				piece->firstPrimitive = first;
+				piece->primitiveCount = Min( primitiveCount - first, ( uint32 )RASTER_CHUNK_PRIMITIVES );
+				//One pass over the indices finds the strip each piece begins in; later instances copy the first's
+				if ( instance == 0 ) {
+					for ( ; restart && scanned < first + 2; scanned++ ) {
+						stripStart = IsRestart( &node->draw, scanned ) ? scanned + 1 : stripStart;
+					}
+					piece->stripStart = stripStart;
+				} else {
+					piece->stripStart = piece[ -( int32 )piecesPerInstance ].stripStart;
+				}
+			}
+		}
+	}
+
+	//Pack pieces into chunks in submission order; a long draw fills chunks of its own, thousands of small
+	//ones share a few, which keeps both the front-end jobs and the back end's walk over the chunks short
+	pass.chunkCount = 0;
+	uint32 chunkPrimitives = RASTER_CHUNK_PRIMITIVES;
+	for ( uint32 i = 0; i < pieceCount; i++ ) {
+		if ( chunkPrimitives + pass.pPieces[ i ].primitiveCount > RASTER_CHUNK_PRIMITIVES ) {
+			rasterChunk_t * chunk = &pass.pChunks[ pass.chunkCount++ ];
+			chunk->pPieces = &pass.pPieces[ i ];
+			chunk->pieceCount = 0;
+			chunk->pTileOffsets = NULL;
+			chunk->ppTileTriangles = NULL;
+			chunkPrimitives = 0;
+		}
+		pass.pChunks[ pass.chunkCount - 1 ].pieceCount++;
+		chunkPrimitives += pass.pPieces[ i ].primitiveCount;
+	}
+
+	ThreadPool_ParallelFor( rasterizer->pool, pJobs, pass.chunkCount, FrontEnd_Job, &pass );
+	ThreadPool_ParallelFor( rasterizer->pool, pJobs, tileJobCount, BackEnd_Job, &pass );
+
+	for ( uint32 i = 0; i < rasterizer->workerCount; i++ ) {
+		HostArena_Reset( &rasterizer->pWorkers[ i ].arena );
+	}
+	HostArena_Reset( &rasterizer->passArena );
+	rasterizer->pDrawHead = NULL;
+	rasterizer->pDrawTail = NULL;
+}
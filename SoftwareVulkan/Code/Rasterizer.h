@@ -0,0 +1,227 @@
+#pragma once
+
+#include "Common.h"
+#include "Cpu.h"
+#include "HostAllocator.h"
+#include "ImageClear.h"
+#include "ImageLayout.h"
+#include "ThreadPool.h"
+#include "vulkan/vulkan.h"
+#include <math.h>
+
+//Screen tiles are the unit of back-end parallelism: 64x64 pixels, 16 KiB of RGBA8
+#define RASTER_TILE_SHIFT 6
+#define RASTER_TILE_SIZE ( 1 << RASTER_TILE_SHIFT )
+#define RASTER_SUBPIXEL_BITS 8
+#define RASTER_SUBPIXEL_ONE ( 1 << RASTER_SUBPIXEL_BITS )
+//Clipping keeps every snapped vertex within this many pixels of the origin, so edge coefficients fit in 32 bits
+#define RASTER_GUARD_BAND 8192.0f
+//Fragments are shaded a 4x4 block at a time; lane = y * 4 + x, so lanes ( 0, 1, 4, 5 ) form the first quad
+#define RASTER_BLOCK_SHIFT 2
+#define RASTER_BLOCK_SIZE ( 1 << RASTER_BLOCK_SHIFT )
+#define RASTER_FRAGMENT_BATCH ( RASTER_BLOCK_SIZE * RASTER_BLOCK_SIZE )
+//Matches maxVertexOutputComponents and maxFragmentInputComponents
+#define RASTER_MAX_VARYINGS 32
+//Hierarchical depth keeps a min and max per 8x8 block, one image tile, so a screen tile has 64 of them
+#define RASTER_HIZ_SHIFT 3
+#define RASTER_HIZ_SIZE ( 1 << RASTER_HIZ_SHIFT )
+#define RASTER_HIZ_TILE_BLOCKS ( ( RASTER_TILE_SIZE / RASTER_HIZ_SIZE ) * ( RASTER_TILE_SIZE / RASTER_HIZ_SIZE ) )
+//Vertices per vertex shader call, one per shader lane
+#define RASTER_VERTEX_BATCH 16
+//Primitives per front-end job, from one draw or several small ones
+#define RASTER_CHUNK_PRIMITIVES 256
+
+/*
+One 4x4 block on its way through the fragment stage.  The rasterizer fills in the covered lanes' target
+texels, packed in the target's format, and depth values as floats; the fragment function interpolates, shades,
+runs the depth test and blends, updating both arrays in place and clearing the coverage of every lane
+that must not be written back.
+*/
+struct rasterFragmentBatch_t {
+	alignas( 16 ) uint32	color[ RASTER_FRAGMENT_BATCH ];
+	alignas( 16 ) float		depth[ RASTER_FRAGMENT_BATCH ];
+	int32					x;						//block origin
+	int32					y;
+	uint32					coverageMask;			//lanes inside the triangle; the others are helpers for derivatives only
+	bool					frontFacing;
+};
+
+struct rasterTriangle_t;
+
+//Shades up to RASTER_VERTEX_BATCH vertices; vertex i writes its clip-space position then varyingCount varyings at pOutput + i * stride
+typedef void ( * rasterVertexFunc_t )( const void * pShaderData, const void * pBindings, uint32 workerIndex, const uint32 * pVertexIndices, uint32 count, uint32 instanceIndex, float * pOutput, uint32 stride );
+typedef void ( * rasterFragmentFunc_t )( const void * pShaderData, const void * pBindings, uint32 workerIndex, const rasterTriangle_t * triangle, rasterFragmentBatch_t * batch );
+
+struct rasterPipeline_t {
+	VkPrimitiveTopology		topology;			//triangle list, strip or fan
+	VkCullModeFlags			cullMode;
+	VkFrontFace				frontFace;
+	bool					primitiveRestart;	//honoured by indexed strips and fans
+	uint32					varyingCount;
+	rasterVertexFunc_t		vertexShader;
+	rasterFragmentFunc_t	fragmentShader;
+	const void *			pShaderData;
+	VkCompareOp				depthCull;			//depth test the back end may run ahead of shading; VK_COMPARE_OP_ALWAYS when it cannot
+	bool					depthWrite;
+};
+
+//Color must be a 32-bit format; data and depthData are NULL when the pass has no such attachment, and depth is
+//VK_FORMAT_D16_UNORM, VK_FORMAT_D32_SFLOAT or VK_FORMAT_D24_UNORM_S8_UINT.  The clear states are NULL for images
+//that are always cleared in full.  A transient attachment has no memory at all: it lives in tile scratch for the
+//length of the pass, so its data is NULL and its contents are undefined unless the pass clears it
+struct rasterTarget_t {
+	bool					transient;
+	bool					depthTransient;
+	uint8 *					data;
+	const imageLayout_t *	layout;
+	imageClearState_t *		clearState;
+	uint32					mipLevel;
+	uint32					arrayLayer;
+	VkFormat				format;
+	uint32					width;
+	uint32					height;
+	uint8 *					depthData;
+	const imageLayout_t *	depthLayout;
+	imageClearState_t *		depthClearState;
+	VkFormat				depthFormat;
+};
+
+//Everything a draw points at must stay alive until Rasterizer_EndPass returns
+struct rasterDraw_t {
+	const rasterPipeline_t *	pipeline;
+	VkViewport					viewport;
+	VkRect2D					scissor;
+	uint32						vertexCount;		//index count when pIndices is set
+	uint32						instanceCount;
+	uint32						firstVertex;		//first index when pIndices is set
+	uint32						firstInstance;
+	const void *				pIndices;
+	VkIndexType					indexType;
+	int32						vertexOffset;
+	const void *				pBindings;			//passed through to the shader functions
+};
+
+/*
+Edge k runs from vertex k to vertex k + 1 and is A * x + B * y + C in subpixel units, non-negative on the
+pixel centres it covers; C already carries the top-left bias.  Interpolation planes are in pixels relative
+to vertex 0: plane 0 is depth, plane 1 is 1 / w and plane 2 + i is varying i / w.
+*/
+struct rasterTriangle_t {
+	int32		minX;			//covered pixels, clipped to scissor and render area; max is exclusive
+	int32		minY;
+	int32		maxX;
+	int32		maxY;
+	int32		edgeA[ 3 ];
+	int32		edgeB[ 3 ];
+	int64		edgeC[ 3 ];
+	float		originX;
+	float		originY;
+	bool		frontFacing;
+	float		minZ;			//depth range over the triangle, widened by zError
+	float		maxZ;
+	float		zError;			//bound on how far an interpolated depth can stray from the exact plane
+	float *		planes;
+	const rasterDraw_t *	draw;		//a chunk can hold the triangles of several draws
+};
+
+//Coverage of blockCount 4x4 blocks, left to right from ( blockX, blockY ); every ISA variant returns the same masks
+typedef void ( * rasterCoverageFunc_t )( const rasterTriangle_t * triangle, int32 blockX, int32 blockY, uint32 blockCount, uint32 * pMasks );
+
+rasterCoverageFunc_t	Rasterizer_SelectCoverage( cpuIsa_t isa );
+
+struct rasterChunk_t;
+struct rasterDrawNode_t;
+struct rasterCacheEntry_t;
+
+struct rasterWorker_t {
+	hostArena_t			arena;
+	float *				pVertices;
+	rasterCacheEntry_t *	pVertexCache;		//post-transform cache for indexed draws
+	rasterTriangle_t **	ppTriangles;
+	uint8 *				pTileScratch;		//transient color then depth for the tile the worker is shading
+};
+
+/*
+================================================
+rasterizer_t
+
+Sort-middle tile binning.  Rasterizer_EndPass replays the recorded draws in two parallel phases on the
+device thread pool.  The front end packs the draws into chunks of up to RASTER_CHUNK_PRIMITIVES, splitting
+long draws and coalescing runs of short ones; each chunk job assembles its primitives, shades every
+distinct vertex they reference once, clips, snaps to RASTER_SUBPIXEL_BITS of fixed point, culls, sets up
+edge functions and interpolation planes, and bins the surviving triangles into per-tile lists.  The back
+end runs one job per screen tile, walking the chunks in submission order so primitive order is kept
+without any locking, and shades covered 4x4 blocks straight into the target.  Block coverage runs through
+the widest kernel the host supports, chosen once at init.
+
+Each tile job also keeps a hierarchical depth buffer for its tile: the min and max stored depth of every
+8x8 block and of the tile as a whole, set from the clear value or built from the depth target the first
+time a draw can use it, and kept current as fragments write depth.  When a pipeline's depth test can run
+ahead of shading, triangles whose depth range fails against the whole tile are skipped, and so are 4x4
+blocks that fail against their 8x8 block, before coverage is shaded or the target is touched.
+
+Clears are lazy where the target tracks them: a tile the clear covers whole and no triangle reaches is
+only marked as cleared in the image's clear state, and is written when a later pass draws to it or the
+image is read.  A tile that holds a clear value in memory seeds its hierarchical depth from that value.
+
+Transient attachments never leave the back end: each worker keeps one tile of color and one of depth in
+scratch memory, laid out like a 64x64 optimal image, and a tile job renders the whole pass for its tile
+there before moving on.  What is left in scratch is simply overwritten by the next tile.
+
+Front-end output lives in per-worker arenas that are rewound when the pass ends.  A rasterizer runs one
+pass at a time.
+================================================
+*/
+struct rasterizer_t {
+	threadPool_t *					pool;
+	const VkAllocationCallbacks *	allocator;
+	rasterCoverageFunc_t			coverage;
+	uint32							workerCount;
+	rasterWorker_t *				pWorkers;
+	hostArena_t						passArena;
+
+	rasterTarget_t					target;
+	VkRect2D						renderArea;
+	bool							clear;
+	bool							clearDepth;
+	bool							clearStencil;
+	float							clearColor[ 4 ];
+	float							clearDepthValue;
+	uint32							clearStencilValue;
+	imageClearState_t *				colorTiles;			//the targets' clear states when they track the subresource rendered
+	imageClearState_t *				depthTiles;
+	bool							lazyClear;			//the clear states were pointed at this pass's clear values
+	bool							lazyClearDepth;
+	imageLayout_t					scratchLayout;		//one tile of each transient attachment, in pTileScratch
+	imageLayout_t					scratchDepthLayout;
+	rasterDrawNode_t *				pDrawHead;
+	rasterDrawNode_t *				pDrawTail;
+};
+
+/*
+Fixed-point depth is stored as round( z * scale ), clamped to maxCode, and reads back as code / scale.  D24
+counts in steps of 2^-24 rather than 1 / ( 2^24 - 1 ), so every code is exactly a float and survives the
+trip through the fragment stage unchanged; it differs from the exact conversion by at most one step.
+*/
+struct rasterDepthEncoding_t {
+	float	scale;				//0 for floating-point formats
+	float	maxCode;
+};
+
+rasterDepthEncoding_t	Rasterizer_DepthEncoding( VkFormat format );
+
+//What a fragment depth reads back as once stored; both fragment stages test exactly this
+inline float Rasterizer_QuantizeDepth( const rasterDepthEncoding_t & encoding, float z ) {
+	if ( encoding.scale == 0.0f ) {
+		return z;
+	}
+	return nearbyintf( Min( Min( Max( z, 0.0f ), 1.0f ) * encoding.scale, encoding.maxCode ) ) * ( 1.0f / encoding.scale );
+}
+
+//isa picks the widest coverage kernel the host runs
+bool	Rasterizer_Init( rasterizer_t * rasterizer, threadPool_t * pool, const VkAllocationCallbacks * allocator, cpuIsa_t isa );
+void	Rasterizer_Shutdown( rasterizer_t * rasterizer );
+//pClearColor, pClearDepth and pClearStencil, when set, clear renderArea before the first draw
+void	Rasterizer_BeginPass( rasterizer_t * rasterizer, const rasterTarget_t * target, const VkRect2D & renderArea, const float * pClearColor, const float * pClearDepth, const uint32 * pClearStencil );
+void	Rasterizer_Draw( rasterizer_t * rasterizer, const rasterDraw_t * draw );
+void	Rasterizer_EndPass( rasterizer_t * rasterizer );
@@ -0,0 +1,181 @@
+#include "Rasterizer.h"
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+/*
+================================================
+Coverage kernels
+
+Every kernel evaluates the three edge functions exactly, in 64-bit integers, at the 16 pixel centres of
+each block; a pixel is covered when no edge is negative.  Only additions follow the one multiply per edge
+at the first block, so the vector kernels produce the same masks as the scalar reference by construction
+rather than by tolerance.
+================================================
+*/
+
+static void EdgesAtBlock( const rasterTriangle_t * triangle, int32 blockX, int32 blockY, int64 edges[ 3 ] ) {
+	const int64 x = ( ( int64 )blockX << RASTER_SUBPIXEL_BITS ) + RASTER_SUBPIXEL_ONE / 2;
+	const int64 y = ( ( int64 )blockY << RASTER_SUBPIXEL_BITS ) + RASTER_SUBPIXEL_ONE / 2;
+	for ( uint32 k = 0; k < 3; k++ ) {
+		edges[ k ] = triangle->edgeA[ k ] * x + triangle->edgeB[ k ] * y + triangle->edgeC[ k ];
+	}
+}
+
+static void Coverage_Scalar( const rasterTriangle_t * triangle, int32 blockX, int32 blockY, uint32 blockCount, uint32 * pMasks ) {
+	int64 edges[ 3 ];
+	EdgesAtBlock( triangle, blockX, blockY, edges );
+	int64 stepX[ 3 ];
+	int64 stepY[ 3 ];
+	for ( uint32 k = 0; k < 3; k++ ) {
+		stepX[ k ] = ( int64 )triangle->edgeA[ k ] << RASTER_SUBPIXEL_BITS;
+		stepY[ k ] = ( int64 )triangle->edgeB[ k ] << RASTER_SUBPIXEL_BITS;
+	}
+	for ( uint32 b = 0; b < blockCount; b++ ) {
+		uint32 mask = 0;
+		int64 rows[ 3 ] = { edges[ 0 ], edges[ 1 ], edges[ 2 ] };
+		for ( uint32 ly = 0; ly < RASTER_BLOCK_SIZE; ly++ ) {
+			int64 e0 = rows[ 0 ];
+			int64 e1 = rows[ 1 ];
+			int64 e2 = rows[ 2 ];
+			for ( uint32 lx = 0; lx < RASTER_BLOCK_SIZE; lx++ ) {
+				if ( ( e0 | e1 | e2 ) >= 0 ) {
+					mask |= 1u << ( ly * RASTER_BLOCK_SIZE + lx );
+				}
+				e0 += stepX[ 0 ];
+				e1 += stepX[ 1 ];
+				e2 += stepX[ 2 ];
+			}
+			for ( uint32 k = 0; k < 3; k++ ) {
+				rows[ k ] += stepY[ k ];
+			}
+		}
+		pMasks[ b ] = mask;
+		for ( uint32 k = 0; k < 3; k++ ) {
+			edges[ k ] += stepX[ k ] * RASTER_BLOCK_SIZE;
+		}
+	}
+}
+
+#if CPU_X86
+
+//Two lanes per register, ( 0, 1 ) ( 2, 3 ) of each row; the sign bits of the ORed edges come out through movmskpd
+CPU_TARGET( "sse4.1" ) static void Coverage_SSE41( const rasterTriangle_t * triangle, int32 blockX, int32 blockY, uint32 blockCount, uint32 * pMasks ) {
+	int64 edges[ 3 ];
+	EdgesAtBlock( triangle, blockX, blockY, edges );
+	__m128i offsets[ 3 ][ 8 ];
+	int64 blockStep[ 3 ];
+	for ( uint32 k = 0; k < 3; k++ ) {
+		const int64 stepX = ( int64 )triangle->edgeA[ k ] << RASTER_SUBPIXEL_BITS;
+		const int64 stepY = ( int64 )triangle->edgeB[ k ] << RASTER_SUBPIXEL_BITS;
+		const __m128i x01 = _mm_set_epi64x( stepX, 0 );
+		const __m128i x23 = _mm_set_epi64x( stepX * 3, stepX * 2 );
+		for ( uint32 ly = 0; ly < RASTER_BLOCK_SIZE; ly++ ) {
+			const __m128i y = _mm_set1_epi64x( stepY * ly );
+			offsets[ k ][ ly * 2 + 0 ] = _mm_add_epi64( x01, y );
+			offsets[ k ][ ly * 2 + 1 ] = _mm_add_epi64( x23, y );
+		}
+		blockStep[ k ] = stepX * RASTER_BLOCK_SIZE;
+	}
+	for ( uint32 b = 0; b < blockCount; b++ ) {
+		const __m128i e0 = _mm_set1_epi64x( edges[ 0 ] );
+		const __m128i e1 = _mm_set1_epi64x( edges[ 1 ] );
+		const __m128i e2 = _mm_set1_epi64x( edges[ 2 ] );
+		uint32 outside = 0;
+		for ( uint32 j = 0; j < 8; j++ ) {
+			const __m128i any = _mm_or_si128( _mm_or_si128( _mm_add_epi64( e0, offsets[ 0 ][ j ] ), _mm_add_epi64( e1, offsets[ 1 ][ j ] ) ), _mm_add_epi64( e2, offsets[ 2 ][ j ] ) );
+			outside |= ( uint32 )_mm_movemask_pd( _mm_castsi128_pd( any ) ) << ( j * 2 );
+		}
+		pMasks[ b ] = ~outside & 0xFFFF;
+		for ( uint32 k = 0; k < 3; k++ ) {
+			edges[ k ] += blockStep[ k ];
+		}
+	}
+}
+
+//One row of the block per register
+CPU_TARGET( "avx2" ) static void Coverage_AVX2( const rasterTriangle_t * triangle, int32 blockX, int32 blockY, uint32 blockCount, uint32 * pMasks ) {
+	int64 edges[ 3 ];
+	EdgesAtBlock( triangle, blockX, blockY, edges );
+	__m256i offsets[ 3 ][ RASTER_BLOCK_SIZE ];
+	int64 blockStep[ 3 ];
+	for ( uint32 k = 0; k < 3; k++ ) {
+		const int64 stepX = ( int64 )triangle->edgeA[ k ] << RASTER_SUBPIXEL_BITS;
+		const int64 stepY = ( int64 )triangle->edgeB[ k ] << RASTER_SUBPIXEL_BITS;
+		const __m256i row = _mm256_set_epi64x( stepX * 3, stepX * 2, stepX, 0 );
+		for ( uint32 ly = 0; ly < RASTER_BLOCK_SIZE; ly++ ) {
+			offsets[ k ][ ly ] = _mm256_add_epi64( row, _mm256_set1_epi64x( stepY * ly ) );
+		}
+		blockStep[ k ] = stepX * RASTER_BLOCK_SIZE;
+	}
+	for ( uint32 b = 0; b < blockCount; b++ ) {
+		const __m256i e0 = _mm256_set1_epi64x( edges[ 0 ] );
+		const __m256i e1 = _mm256_set1_epi64x( edges[ 1 ] );
+		const __m256i e2 = _mm256_set1_epi64x( edges[ 2 ] );
+		uint32 outside = 0;
+		for ( uint32 ly = 0; ly < RASTER_BLOCK_SIZE; ly++ ) {
+			const __m256i any = _mm256_or_si256( _mm256_or_si256( _mm256_add_epi64( e0, offsets[ 0 ][ ly ] ), _mm256_add_epi64( e1, offsets[ 1 ][ ly ] ) ), _mm256_add_epi64( e2, offsets[ 2 ][ ly ] ) );
+			outside |= ( uint32 )_mm256_movemask_pd( _mm256_castsi256_pd( any ) ) << ( ly * RASTER_BLOCK_SIZE );
+		}
+		pMasks[ b ] = ~outside & 0xFFFF;
+		for ( uint32 k = 0; k < 3; k++ ) {
+			edges[ k ] += blockStep[ k ];
+		}
+	}
+	_mm256_zeroupper();
+}
+
+#endif
+
+#if CPU_AVX512_KERNELS
+
+//Two rows per register, so a block is two compares into opmask registers
+CPU_TARGET( "avx512f" ) static void Coverage_AVX512( const rasterTriangle_t * triangle, int32 blockX, int32 blockY, uint32 blockCount, uint32 * pMasks ) {
+	int64 edges[ 3 ];
+	EdgesAtBlock( triangle, blockX, blockY, edges );
+	__m512i offsets[ 3 ][ 2 ];
+	int64 blockStep[ 3 ];
+	for ( uint32 k = 0; k < 3; k++ ) {
+		const int64 stepX = ( int64 )triangle->edgeA[ k ] << RASTER_SUBPIXEL_BITS;
+		const int64 stepY = ( int64 )triangle->edgeB[ k ] << RASTER_SUBPIXEL_BITS;
+		const __m512i rows01 = _mm512_set_epi64( stepX * 3 + stepY, stepX * 2 + stepY, stepX + stepY, stepY, stepX * 3, stepX * 2, stepX, 0 );
+		offsets[ k ][ 0 ] = rows01;
+		offsets[ k ][ 1 ] = _mm512_add_epi64( rows01, _mm512_set1_epi64( stepY * 2 ) );
+		blockStep[ k ] = stepX * RASTER_BLOCK_SIZE;
+	}
+	const __m512i zero = _mm512_setzero_si512();
+	for ( uint32 b = 0; b < blockCount; b++ ) {
+		const __m512i e0 = _mm512_set1_epi64( edges[ 0 ] );
+		const __m512i e1 = _mm512_set1_epi64( edges[ 1 ] );
+		const __m512i e2 = _mm512_set1_epi64( edges[ 2 ] );
+		const __m512i any01 = _mm512_or_si512( _mm512_or_si512( _mm512_add_epi64( e0, offsets[ 0 ][ 0 ] ), _mm512_add_epi64( e1, offsets[ 1 ][ 0 ] ) ), _mm512_add_epi64( e2, offsets[ 2 ][ 0 ] ) );
+		const __m512i any23 = _mm512_or_si512( _mm512_or_si512( _mm512_add_epi64( e0, offsets[ 0 ][ 1 ] ), _mm512_add_epi64( e1, offsets[ 1 ][ 1 ] ) ), _mm512_add_epi64( e2, offsets[ 2 ][ 1 ] ) );
+		const uint32 inside01 = ( uint32 )_mm512_cmpge_epi64_mask( any01, zero );
+		const uint32 inside23 = ( uint32 )_mm512_cmpge_epi64_mask( any23, zero );
+		pMasks[ b ] = inside01 | ( inside23 << 8 );
+		for ( uint32 k = 0; k < 3; k++ ) {
+			edges[ k ] += blockStep[ k ];
+		}
+	}
+	_mm256_zeroupper();
+}
+
+#endif
+
+rasterCoverageFunc_t Rasterizer_SelectCoverage( cpuIsa_t isa ) {
+#if CPU_AVX512_KERNELS
+	if ( isa >= cpuIsa_t::AVX512 ) {
+		return Coverage_AVX512;
+	}
+#endif
+#if CPU_X86
+	if ( isa >= cpuIsa_t::AVX2 ) {
+		return Coverage_AVX2;
+	}
+	if ( isa >= cpuIsa_t::SSE41 ) {
+		return Coverage_SSE41;
+	}
+#endif
+	return Coverage_Scalar;
+}
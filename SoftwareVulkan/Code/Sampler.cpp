@@ -0,0 +1,613 @@
+#include "Sampler.h"
+#include "SpirV.h"
+#include <atomic>
+#include <math.h>
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+//Texel coordinates are clamped this far out before converting to integers; beyond it floats have no fraction left
+#define SAMPLER_COORDINATE_LIMIT 16777216.0f
+
+static uint32 FloatBits( float value ) {
+	uint32 bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	return bits;
+}
+
+static float BitsFloat( uint32 bits ) {
+	float value;
+	memcpy( &value, &bits, sizeof( value ) );
+	return value;
+}
+
+/*
+================================================
+Sampled images
+================================================
+*/
+static samplerSwizzle_t SampledImage_Component( VkComponentSwizzle swizzle, samplerSwizzle_t identity ) {
+	switch ( swizzle ) {
+		case VK_COMPONENT_SWIZZLE_ZERO:	return samplerSwizzle_t::ZERO;
+		case VK_COMPONENT_SWIZZLE_ONE:	return samplerSwizzle_t::ONE;
+		case VK_COMPONENT_SWIZZLE_R:	return samplerSwizzle_t::R;
+		case VK_COMPONENT_SWIZZLE_G:	return samplerSwizzle_t::G;
+		case VK_COMPONENT_SWIZZLE_B:	return samplerSwizzle_t::B;
+		case VK_COMPONENT_SWIZZLE_A:	return samplerSwizzle_t::A;
+		default:						return identity;
+	}
+}
+
+bool SampledImage_Init( sampledImage_t * image, const imageLayout_t * layout, uint8 * data, imageClearState_t * clearState, const VkImageViewCreateInfo * pCreateInfo, cpuIsa_t isa ) {
+	memset( image, 0, sizeof( *image ) );
+	const formatInfo_t * info = Format_Find( pCreateInfo->format );
+	if ( info == NULL || info->bytesPerTexel != layout->bytesPerTexel || info->blockShift != layout->blockShift ) {
+		return false;
+	}
+	formatConverter_t converter;
+	if ( !Format_SelectConverter( ( info->blockShift != 0 ) ? info->decodedFormat : pCreateInfo->format, isa, &converter ) ) {
+		return false;
+	}
+	const VkImageSubresourceRange & range = pCreateInfo->subresourceRange;
+	const bool depth = ( converter.info->numeric == formatNumeric_t::DEPTH_STENCIL );
+	//Stencil is read through integer views of its own, which the device does not offer
+	if ( depth && ( range.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT ) == 0 ) {
+		return false;
+	}
+	image->layout = layout;
+	image->data = data;
+	image->clearState = clearState;
+	image->converter = converter;
+	image->decode = Format_SelectDecoder( pCreateInfo->format, isa );
+	image->baseMipLevel = range.baseMipLevel;
+	image->levelCount = ( range.levelCount == VK_REMAINING_MIP_LEVELS ) ? layout->mipLevels - range.baseMipLevel : range.levelCount;
+	image->baseArrayLayer = range.baseArrayLayer;
+	image->layerCount = ( range.layerCount == VK_REMAINING_ARRAY_LAYERS ) ? layout->arrayLayers - range.baseArrayLayer : range.layerCount;
+	image->integer = Format_IsInteger( converter.info );
+	image->fixedPoint = depth && converter.info->fieldBits[ 0 ] != 32;
+
+	//Depth views read as ( D, 0, 0, 1 ) underneath the view's own swizzle
+	const samplerSwizzle_t identity[ 4 ] = { samplerSwizzle_t::R, samplerSwizzle_t::G, samplerSwizzle_t::B, samplerSwizzle_t::A };
+	const samplerSwizzle_t depthComponents[ 4 ] = { samplerSwizzle_t::R, samplerSwizzle_t::ZERO, samplerSwizzle_t::ZERO, samplerSwizzle_t::ONE };
+	const VkComponentSwizzle components[ 4 ] = { pCreateInfo->components.r, pCreateInfo->components.g, pCreateInfo->components.b, pCreateInfo->components.a };
+	image->identitySwizzle = true;
+	for ( uint32 c = 0; c < 4; c++ ) {
+		samplerSwizzle_t swizzle = SampledImage_Component( components[ c ], identity[ c ] );
+		if ( depth && swizzle <= samplerSwizzle_t::A ) {
+			swizzle = depthComponents[ ( uint32 )swizzle ];
+		}
+		image->swizzle[ c ] = swizzle;
+		image->identitySwizzle = image->identitySwizzle && swizzle == identity[ c ];
+	}
+	return true;
+}
+
+/*
+================================================
+Decoded block cache
+
+Per thread, so lookups take no lock: a small set-associative cache of decoded 4x4 blocks keyed by block
+address, evicting the least recently used way.  Tap pointers stay valid until the footprint that gathered
+them is blended, so a way used since the footprint began is never evicted; when every way of a set is,
+the block is decoded into a spill slot that lasts for the footprint.  Invalidation bumps a global epoch
+that each thread checks before sampling, rather than reaching into other threads' caches.
+================================================
+*/
+#define SAMPLER_BLOCK_CACHE_SET_SHIFT 6
+#define SAMPLER_BLOCK_CACHE_SETS ( 1 << SAMPLER_BLOCK_CACHE_SET_SHIFT )
+#define SAMPLER_BLOCK_CACHE_WAYS 4
+//Well short of wrapping, with room for every tap of a sample call
+#define SAMPLER_BLOCK_CACHE_CLOCK_LIMIT 0xFFFF0000U
+
+struct samplerBlockEntry_t {
+	const uint8 *			pBlock;			//NULL when empty
+	formatDecodeFunc_t		decode;			//views of one image may decode its blocks differently
+	uint32					lastUse;		//0 when empty
+	uint8					texels[ FORMAT_MAX_DECODED_BLOCK_BYTES ];
+};
+
+struct samplerBlockCache_t {
+	samplerBlockEntry_t		entries[ SAMPLER_BLOCK_CACHE_SETS ][ SAMPLER_BLOCK_CACHE_WAYS ];
+	uint32					epoch;
+	uint32					clock;
+	uint32					footprintStart;	//entries used after this belong to the footprint being gathered
+	uint32					spillCount;
+	uint8					spill[ SAMPLER_MAX_TAPS ][ FORMAT_MAX_DECODED_BLOCK_BYTES ];
+};
+
+static std::atomic< uint32 > samplerBlockEpoch( 0 );
+static thread_local samplerBlockCache_t samplerBlockCache;
+
+void Sampler_InvalidateBlockCache() {
+	samplerBlockEpoch.fetch_add( 1, std::memory_order_relaxed );
+}
+
+static void Sampler_ValidateBlockCache() {
+	samplerBlockCache_t & cache = samplerBlockCache;
+	const uint32 epoch = samplerBlockEpoch.load( std::memory_order_relaxed );
+	if ( cache.epoch == epoch && cache.clock < SAMPLER_BLOCK_CACHE_CLOCK_LIMIT ) {
+		return;
+	}
+	for ( uint32 set = 0; set < SAMPLER_BLOCK_CACHE_SETS; set++ ) {
+		for ( uint32 way = 0; way < SAMPLER_BLOCK_CACHE_WAYS; way++ ) {
+			cache.entries[ set ][ way ].pBlock = NULL;
+			cache.entries[ set ][ way ].lastUse = 0;
+		}
+	}
+	cache.epoch = epoch;
+	cache.clock = 0;
+	cache.footprintStart = 0;
+}
+
+static void Sampler_BeginFootprint() {
+	samplerBlockCache.footprintStart = samplerBlockCache.clock;
+	samplerBlockCache.spillCount = 0;
+}
+
+//( x, y ) in texels; returns the texel inside its decoded block
+static const uint8 * Sampler_CachedTexel( const sampledImage_t * image, uint32 level, uint32 layer, int32 x, int32 y ) {
+	samplerBlockCache_t & cache = samplerBlockCache;
+	const uint8 * pBlock = image->data + ImageLayout_TexelOffset( image->layout, level, layer, x >> 2, y >> 2, 0 );
+	const uint32 texelOffset = ( ( y & 3 ) * 4 + ( x & 3 ) ) * image->converter.info->bytesPerTexel;
+	const uint32 set = ( ( uint32 )( ( size_t )pBlock >> 3 ) * 0x9E3779B1U ) >> ( 32 - SAMPLER_BLOCK_CACHE_SET_SHIFT );
+	samplerBlockEntry_t * pWays = cache.entries[ set ];
+	samplerBlockEntry_t * pVictim = &pWays[ 0 ];
+	const uint32 now = ++cache.clock;
+	for ( uint32 way = 0; way < SAMPLER_BLOCK_CACHE_WAYS; way++ ) {
+		samplerBlockEntry_t & entry = pWays[ way ];
+		if ( entry.pBlock == pBlock && entry.decode == image->decode ) {
+			entry.lastUse = now;
+			return entry.texels + texelOffset;
+		}
+		pVictim = ( entry.lastUse < pVictim->lastUse ) ? &entry : pVictim;
+	}
+	//One tap per call, so the footprint never needs more spill slots than it has taps
+	if ( pVictim->lastUse > cache.footprintStart ) {
+		uint8 * pSpill = cache.spill[ cache.spillCount++ ];
+		image->decode( pBlock, pSpill );
+		return pSpill + texelOffset;
+	}
+	image->decode( pBlock, pVictim->texels );
+	pVictim->pBlock = pBlock;
+	pVictim->decode = image->decode;
+	pVictim->lastUse = now;
+	return pVictim->texels + texelOffset;
+}
+
+/*
+================================================
+Addressing
+
+SAMPLER_ADDRESS_MIXED stands for "each axis as the sampler says", the one instantiation that switches at
+run time.  Every other instantiation folds its switch away.
+================================================
+*/
+#define SAMPLER_ADDRESS_MIXED ( ( VkSamplerAddressMode )0x7FFFFFFF )
+
+static int32 Sampler_Floor( float value ) {
+	//Written so that NaN lands on the lower limit
+	value = ( value > -SAMPLER_COORDINATE_LIMIT ) ? value : -SAMPLER_COORDINATE_LIMIT;
+	value = ( value < SAMPLER_COORDINATE_LIMIT ) ? value : SAMPLER_COORDINATE_LIMIT;
+	return ( int32 )floorf( value );
+}
+
+//Texel index along one axis after addressing, or -1 for the border
+template< VkSamplerAddressMode __address__ >
+static int32 Sampler_Wrap( VkSamplerAddressMode mode, int32 i, int32 size ) {
+	switch ( ( __address__ == SAMPLER_ADDRESS_MIXED ) ? mode : __address__ ) {
+		case VK_SAMPLER_ADDRESS_MODE_REPEAT: {
+			const int32 wrapped = i % size;
+			return ( wrapped < 0 ) ? wrapped + size : wrapped;
+		}
+		case VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT: {
+			const int32 period = size * 2;
+			int32 wrapped = i % period;
+			wrapped = ( wrapped < 0 ) ? wrapped + period : wrapped;
+			return ( wrapped < size ) ? wrapped : period - 1 - wrapped;
+		}
+		case VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER:
+			return ( i < 0 || i >= size ) ? -1 : i;
+		case VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE:
+			return Min( ( i >= 0 ) ? i : -1 - i, size - 1 );
+		default:
+			return Min( Max( i, 0 ), size - 1 );
+	}
+}
+
+template< VkSamplerAddressMode __address__ >
+static const uint8 * Sampler_Texel( const sampledImage_t * image, uint32 level, uint32 layer, int32 x, int32 y ) {
+	if ( __address__ == VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER || __address__ == SAMPLER_ADDRESS_MIXED ) {
+		if ( x < 0 || y < 0 ) {
+			return NULL;
+		}
+	}
+	if ( image->decode != NULL ) {
+		return Sampler_CachedTexel( image, level, layer, x, y );
+	}
+	return image->data + ImageLayout_TexelOffset( image->layout, level, layer, x, y, 0 );
+}
+
+template< VkSamplerAddressMode __address__, bool __linear__ >
+static uint32 Sampler_Taps( const sampler_t * sampler, const sampledImage_t * image, uint32 level, uint32 layer, float x, float y, float weight, samplerTap_t * pTaps ) {
+	const imageMipLayout_t & mip = image->layout->mips[ level ];
+	const int32 width = ( int32 )mip.width;
+	const int32 height = ( int32 )mip.height;
+	if ( !__linear__ ) {
+		const int32 i = Sampler_Wrap< __address__ >( sampler->addressU, Sampler_Floor( x ), width );
+		const int32 j = Sampler_Wrap< __address__ >( sampler->addressV, Sampler_Floor( y ), height );
+		pTaps[ 0 ].pTexel = Sampler_Texel< __address__ >( image, level, layer, i, j );
+		pTaps[ 0 ].weight = weight;
+		return 1;
+	}
+	const int32 i0 = Sampler_Floor( x - 0.5f );
+	const int32 j0 = Sampler_Floor( y - 0.5f );
+	const float alpha = Min( Max( x - 0.5f - ( float )i0, 0.0f ), 1.0f );
+	const float beta = Min( Max( y - 0.5f - ( float )j0, 0.0f ), 1.0f );
+	const int32 u0 = Sampler_Wrap< __address__ >( sampler->addressU, i0, width );
+	const int32 u1 = Sampler_Wrap< __address__ >( sampler->addressU, i0 + 1, width );
+	const int32 v0 = Sampler_Wrap< __address__ >( sampler->addressV, j0, height );
+	const int32 v1 = Sampler_Wrap< __address__ >( sampler->addressV, j0 + 1, height );
+	pTaps[ 0 ].pTexel = Sampler_Texel< __address__ >( image, level, layer, u0, v0 );
+	pTaps[ 0 ].weight = weight * ( 1.0f - alpha ) * ( 1.0f - beta );
+	pTaps[ 1 ].pTexel = Sampler_Texel< __address__ >( image, level, layer, u1, v0 );
+	pTaps[ 1 ].weight = weight * alpha * ( 1.0f - beta );
+	pTaps[ 2 ].pTexel = Sampler_Texel< __address__ >( image, level, layer, u0, v1 );
+	pTaps[ 2 ].weight = weight * ( 1.0f - alpha ) * beta;
+	pTaps[ 3 ].pTexel = Sampler_Texel< __address__ >( image, level, layer, u1, v1 );
+	pTaps[ 3 ].weight = weight * alpha * beta;
+	return 4;
+}
+
+template< VkSamplerAddressMode __address__ >
+static samplerTapFunc_t Sampler_SelectFilter( bool linear ) {
+	if ( linear ) {
+		return Sampler_Taps< __address__, true >;
+	}
+	return Sampler_Taps< __address__, false >;
+}
+
+static samplerTapFunc_t Sampler_SelectTaps( VkSamplerAddressMode addressU, VkSamplerAddressMode addressV, bool linear ) {
+	if ( addressU != addressV ) {
+		return Sampler_SelectFilter< SAMPLER_ADDRESS_MIXED >( linear );
+	}
+	switch ( addressU ) {
+		case VK_SAMPLER_ADDRESS_MODE_REPEAT:				return Sampler_SelectFilter< VK_SAMPLER_ADDRESS_MODE_REPEAT >( linear );
+		case VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT:		return Sampler_SelectFilter< VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT >( linear );
+		case VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER:		return Sampler_SelectFilter< VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER >( linear );
+		case VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE:	return Sampler_SelectFilter< VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE >( linear );
+		default:											return Sampler_SelectFilter< VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE >( linear );
+	}
+}
+
+/*
+================================================
+Accumulate kernels
+
+Both multiply and then add in tap order, so every kernel returns the same bits.
+================================================
+*/
+static void Sampler_Accumulate( const uint32 * pTexels, const samplerTap_t * pTaps, uint32 count, uint32 * pResult ) {
+	float sum[ FORMAT_TEXEL_LANES ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for ( uint32 i = 0; i < count; i++ ) {
+		for ( uint32 c = 0; c < FORMAT_TEXEL_LANES; c++ ) {
+			const float product = pTaps[ i ].weight * BitsFloat( pTexels[ i * FORMAT_TEXEL_LANES + c ] );
+			sum[ c ] = sum[ c ] + product;
+		}
+	}
+	for ( uint32 c = 0; c < FORMAT_TEXEL_LANES; c++ ) {
+		pResult[ c ] = FloatBits( sum[ c ] );
+	}
+}
+
+#if CPU_X86
+CPU_TARGET( "sse4.1" ) static void Sampler_Accumulate_SSE41( const uint32 * pTexels, const samplerTap_t * pTaps, uint32 count, uint32 * pResult ) {
+	__m128 sum = _mm_setzero_ps();
+	for ( uint32 i = 0; i < count; i++ ) {
+		const __m128 texel = _mm_loadu_ps( reinterpret_cast< const float * >( pTexels + i * FORMAT_TEXEL_LANES ) );
+		sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( pTaps[ i ].weight ), texel ) );
+	}
+	_mm_storeu_ps( reinterpret_cast< float * >( pResult ), sum );
+}
+#endif
+
+/*
+================================================
+Samplers
+================================================
+*/
+static void Sampler_BorderColor( VkBorderColor color, uint32 * pFloat, uint32 * pInt ) {
+	const bool opaque = ( color != VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK && color != VK_BORDER_COLOR_INT_TRANSPARENT_BLACK );
+	const bool white = ( color == VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE || color == VK_BORDER_COLOR_INT_OPAQUE_WHITE );
+	for ( uint32 c = 0; c < 3; c++ ) {
+		pFloat[ c ] = white ? FloatBits( 1.0f ) : 0;
+		pInt[ c ] = white ? 1 : 0;
+	}
+	pFloat[ 3 ] = opaque ? FloatBits( 1.0f ) : 0;
+	pInt[ 3 ] = opaque ? 1 : 0;
+}
+
+void Sampler_Init( sampler_t * sampler, const VkSamplerCreateInfo * pCreateInfo, cpuIsa_t isa ) {
+	memset( sampler, 0, sizeof( *sampler ) );
+	sampler->addressU = pCreateInfo->addressModeU;
+	sampler->addressV = pCreateInfo->addressModeV;
+	sampler->magTaps = Sampler_SelectTaps( sampler->addressU, sampler->addressV, pCreateInfo->magFilter == VK_FILTER_LINEAR );
+	sampler->minTaps = Sampler_SelectTaps( sampler->addressU, sampler->addressV, pCreateInfo->minFilter == VK_FILTER_LINEAR );
+	sampler->nearestTaps = Sampler_SelectTaps( sampler->addressU, sampler->addressV, false );
+	sampler->accumulate = Sampler_Accumulate;
+#if CPU_X86
+	if ( isa >= cpuIsa_t::SSE41 ) {
+		sampler->accumulate = Sampler_Accumulate_SSE41;
+	}
+#else
+	( void )isa;
+#endif
+	sampler->mipmapLinear = ( pCreateInfo->mipmapMode == VK_SAMPLER_MIPMAP_MODE_LINEAR );
+	sampler->unnormalized = ( pCreateInfo->unnormalizedCoordinates != VK_FALSE );
+	sampler->compareEnable = ( pCreateInfo->compareEnable != VK_FALSE );
+	sampler->compareOp = pCreateInfo->compareOp;
+	sampler->lodBias = Min( Max( pCreateInfo->mipLodBias, -SAMPLER_MAX_LOD_BIAS ), SAMPLER_MAX_LOD_BIAS );
+	sampler->minLod = pCreateInfo->minLod;
+	sampler->maxLod = Max( pCreateInfo->maxLod, pCreateInfo->minLod );
+	sampler->maxAnisotropy = 1;
+	if ( pCreateInfo->anisotropyEnable != VK_FALSE ) {
+		sampler->maxAnisotropy = Min( ( uint32 )Max( pCreateInfo->maxAnisotropy, 1.0f ), ( uint32 )SAMPLER_MAX_ANISOTROPY );
+	}
+	Sampler_BorderColor( pCreateInfo->borderColor, sampler->floatBorder, sampler->intBorder );
+}
+
+/*
+================================================
+Sampling
+================================================
+*/
+
+//Where a lane samples: the level of detail before biasing and clamping, and the anisotropic line
+struct samplerFootprint_t {
+	float	lambda;
+	uint32	sampleCount;
+	float	axisU;				//major axis of the footprint in coordinate units, zero for one sample
+	float	axisV;
+};
+
+//2x2 quads of the 4x4 lane block; a quad is its base lane plus 0, 1, 4 and 5
+static const uint32 samplerQuadBases[ 4 ] = { 0, 2, 8, 10 };
+#define SAMPLER_QUAD_LANES 0x33
+
+static void Sampler_Footprint( const sampler_t * sampler, const sampledImage_t * image, float dudx, float dvdx, float dudy, float dvdy, samplerFootprint_t * pFootprint ) {
+	const imageMipLayout_t & mip = image->layout->mips[ image->baseMipLevel ];
+	const float width = sampler->unnormalized ? 1.0f : ( float )mip.width;
+	const float height = sampler->unnormalized ? 1.0f : ( float )mip.height;
+	const float rhoX = sqrtf( ( dudx * width ) * ( dudx * width ) + ( dvdx * height ) * ( dvdx * height ) );
+	const float rhoY = sqrtf( ( dudy * width ) * ( dudy * width ) + ( dvdy * height ) * ( dvdy * height ) );
+	const float rhoMax = Max( rhoX, rhoY );
+	const float rhoMin = Min( rhoX, rhoY );
+	pFootprint->sampleCount = 1;
+	pFootprint->axisU = 0.0f;
+	pFootprint->axisV = 0.0f;
+	if ( sampler->maxAnisotropy > 1 && rhoMax > rhoMin ) {
+		const float ratio = ( rhoMin > 0.0f ) ? ceilf( rhoMax / rhoMin ) : ( float )sampler->maxAnisotropy;
+		pFootprint->sampleCount = ( uint32 )Min( ratio, ( float )sampler->maxAnisotropy );
+	}
+	if ( pFootprint->sampleCount > 1 ) {
+		pFootprint->axisU = ( rhoX >= rhoY ) ? dudx : dudy;
+		pFootprint->axisV = ( rhoX >= rhoY ) ? dvdx : dvdy;
+	}
+	pFootprint->lambda = log2f( rhoMax / ( float )pFootprint->sampleCount );
+}
+
+static bool Sampler_Compare( VkCompareOp op, float reference, float texel ) {
+	switch ( op ) {
+		case VK_COMPARE_OP_NEVER:				return false;
+		case VK_COMPARE_OP_LESS:				return reference < texel;
+		case VK_COMPARE_OP_EQUAL:				return reference == texel;
+		case VK_COMPARE_OP_LESS_OR_EQUAL:		return reference <= texel;
+		case VK_COMPARE_OP_GREATER:				return reference > texel;
+		case VK_COMPARE_OP_NOT_EQUAL:			return reference != texel;
+		case VK_COMPARE_OP_GREATER_OR_EQUAL:	return reference >= texel;
+		default:								return true;
+	}
+}
+
+//Gathers the taps raw, decodes them in one call, and blends; pReference is NULL without depth comparison
+static void Sampler_Blend( const sampler_t * sampler, const sampledImage_t * image, const samplerTap_t * pTaps, uint32 tapCount, const float * pReference, uint32 * pResult ) {
+	const uint32 bytesPerTexel = image->converter.info->bytesPerTexel;
+	uint8 raw[ SAMPLER_MAX_TAPS * FORMAT_MAX_TEXEL_BYTES ];
+	uint32 texels[ SAMPLER_MAX_TAPS * FORMAT_TEXEL_LANES ];
+	bool border = false;
+	for ( uint32 i = 0; i < tapCount; i++ ) {
+		if ( pTaps[ i ].pTexel != NULL ) {
+			memcpy( raw + i * bytesPerTexel, pTaps[ i ].pTexel, bytesPerTexel );
+		} else {
+			memset( raw + i * bytesPerTexel, 0, bytesPerTexel );
+			border = true;
+		}
+	}
+	image->converter.unpack( image->converter.info, raw, tapCount, texels );
+	if ( border ) {
+		const uint32 * pBorder = image->integer ? sampler->intBorder : sampler->floatBorder;
+		for ( uint32 i = 0; i < tapCount; i++ ) {
+			if ( pTaps[ i ].pTexel == NULL ) {
+				memcpy( texels + i * FORMAT_TEXEL_LANES, pBorder, FORMAT_TEXEL_LANES * sizeof( uint32 ) );
+			}
+		}
+	}
+	if ( pReference != NULL ) {
+		for ( uint32 i = 0; i < tapCount; i++ ) {
+			const bool pass = Sampler_Compare( sampler->compareOp, *pReference, BitsFloat( texels[ i * FORMAT_TEXEL_LANES ] ) );
+			texels[ i * FORMAT_TEXEL_LANES ] = pass ? FloatBits( 1.0f ) : 0;
+		}
+	}
+	if ( image->integer ) {
+		memcpy( pResult, texels, FORMAT_TEXEL_LANES * sizeof( uint32 ) );
+		return;
+	}
+	sampler->accumulate( texels, pTaps, tapCount, pResult );
+}
+
+static uint32 Sampler_Layer( const sampledImage_t * image, const shaderSampleOp_t * op, const shaderRegister_t * pRegisters, uint32 lane ) {
+	if ( !op->arrayed || op->coordinateCount < 3 ) {
+		return image->baseArrayLayer;
+	}
+	const float layer = floorf( pRegisters[ op->coordinateRegister + 2 ].f[ lane ] + 0.5f );
+	return image->baseArrayLayer + ( uint32 )Min( Max( layer, 0.0f ), ( float )( image->layerCount - 1 ) );
+}
+
+static void Sampler_Filter( const sampler_t * sampler, const sampledImage_t * image, const shaderSampleOp_t * op, const shaderRegister_t * pRegisters, uint32 lane, const samplerFootprint_t & footprint, uint32 * pTexel ) {
+	const float shaderBias = ( ( op->flags & SHADER_SAMPLE_BIAS ) != 0 ) ? pRegisters[ op->lodRegister ].f[ lane ] : 0.0f;
+	float lambda = footprint.lambda + Min( Max( sampler->lodBias + shaderBias, -SAMPLER_MAX_LOD_BIAS ), SAMPLER_MAX_LOD_BIAS );
+	lambda = Min( Max( lambda, sampler->minLod ), sampler->maxLod );
+	const bool magnify = !( lambda > 0.0f );
+	const samplerTapFunc_t taps = image->integer ? sampler->nearestTaps : ( magnify ? sampler->magTaps : sampler->minTaps );
+
+	//Levels relative to the view's base, then made absolute
+	const uint32 lastLevel = image->levelCount - 1;
+	const float levelOfDetail = ( magnify || sampler->unnormalized ) ? 0.0f : Min( lambda, ( float )lastLevel );
+	uint32 levels[ 2 ] = { 0, 0 };
+	float levelWeights[ 2 ] = { 1.0f, 0.0f };
+	uint32 levelCount = 1;
+	if ( sampler->mipmapLinear && !image->integer ) {
+		const float level = floorf( levelOfDetail );
+		levels[ 0 ] = ( uint32 )level;
+		levels[ 1 ] = Min( levels[ 0 ] + 1, lastLevel );
+		levelWeights[ 1 ] = levelOfDetail - level;
+		levelWeights[ 0 ] = 1.0f - levelWeights[ 1 ];
+		levelCount = ( levelWeights[ 1 ] > 0.0f ) ? 2 : 1;
+	} else {
+		levels[ 0 ] = Min( ( uint32 )( ceilf( levelOfDetail + 0.5f ) - 1.0f ), lastLevel );
+	}
+
+	const uint32 layer = Sampler_Layer( image, op, pRegisters, lane );
+	const float u = pRegisters[ op->coordinateRegister + 0 ].f[ lane ];
+	const float v = pRegisters[ op->coordinateRegister + 1 ].f[ lane ];
+	float offsetX = 0.0f;
+	float offsetY = 0.0f;
+	if ( ( op->flags & SHADER_SAMPLE_OFFSET ) != 0 ) {
+		offsetX = ( float )pRegisters[ op->offsetRegister + 0 ].i[ lane ];
+		offsetY = ( float )pRegisters[ op->offsetRegister + 1 ].i[ lane ];
+	}
+	const uint32 sampleCount = image->integer ? 1 : footprint.sampleCount;
+	samplerTap_t pTaps[ SAMPLER_MAX_TAPS ];
+	uint32 tapCount = 0;
+	if ( image->decode != NULL ) {
+		Sampler_BeginFootprint();
+	}
+	for ( uint32 l = 0; l < levelCount; l++ ) {
+		const uint32 level = image->baseMipLevel + levels[ l ];
+		const imageMipLayout_t & mip = image->layout->mips[ level ];
+		const float width = sampler->unnormalized ? 1.0f : ( float )mip.width;
+		const float height = sampler->unnormalized ? 1.0f : ( float )mip.height;
+		const float weight = levelWeights[ l ] / ( float )sampleCount;
+		for ( uint32 k = 0; k < sampleCount; k++ ) {
+			const float t = ( ( float )k + 0.5f ) / ( float )sampleCount - 0.5f;
+			const float x = ( u + t * footprint.axisU ) * width + offsetX;
+			const float y = ( v + t * footprint.axisV ) * height + offsetY;
+			tapCount += taps( sampler, image, level, layer, x, y, weight, pTaps + tapCount );
+		}
+	}
+
+	float reference = 0.0f;
+	const bool compare = ( op->flags & SHADER_SAMPLE_DREF ) != 0 && sampler->compareEnable;
+	if ( compare ) {
+		reference = pRegisters[ op->drefRegister ].f[ lane ];
+		reference = image->fixedPoint ? Min( Max( reference, 0.0f ), 1.0f ) : reference;
+	}
+	Sampler_Blend( sampler, image, pTaps, tapCount, compare ? &reference : NULL, pTexel );
+}
+
+//OpImageFetch: integer coordinates and level, nothing filtered; false when outside the view
+static bool Sampler_Fetch( const sampledImage_t * image, const shaderSampleOp_t * op, const shaderRegister_t * pRegisters, uint32 lane, uint32 * pTexel ) {
+	int32 x = pRegisters[ op->coordinateRegister + 0 ].i[ lane ];
+	int32 y = pRegisters[ op->coordinateRegister + 1 ].i[ lane ];
+	if ( ( op->flags & SHADER_SAMPLE_OFFSET ) != 0 ) {
+		x += pRegisters[ op->offsetRegister + 0 ].i[ lane ];
+		y += pRegisters[ op->offsetRegister + 1 ].i[ lane ];
+	}
+	const int32 level = ( op->lodRegister != SHADER_NO_REGISTER ) ? pRegisters[ op->lodRegister ].i[ lane ] : 0;
+	const int32 layer = ( op->arrayed && op->coordinateCount >= 3 ) ? pRegisters[ op->coordinateRegister + 2 ].i[ lane ] : 0;
+	if ( level < 0 || ( uint32 )level >= image->levelCount || layer < 0 || ( uint32 )layer >= image->layerCount ) {
+		return false;
+	}
+	const uint32 mipLevel = image->baseMipLevel + level;
+	const imageMipLayout_t & mip = image->layout->mips[ mipLevel ];
+	if ( x < 0 || ( uint32 )x >= mip.width || y < 0 || ( uint32 )y >= mip.height ) {
+		return false;
+	}
+	if ( image->decode != NULL ) {
+		Sampler_BeginFootprint();
+	}
+	const uint8 * pSrc = Sampler_Texel< VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE >( image, mipLevel, image->baseArrayLayer + layer, x, y );
+	image->converter.unpack( image->converter.info, pSrc, 1, pTexel );
+	return true;
+}
+
+static void Sampler_Write( const sampledImage_t * image, const uint32 * pTexel, uint32 lane, uint32 resultCount, shaderRegister_t * pResult ) {
+	if ( image->identitySwizzle ) {
+		for ( uint32 c = 0; c < resultCount; c++ ) {
+			pResult[ c ].u[ lane ] = pTexel[ c ];
+		}
+		return;
+	}
+	const uint32 one = image->integer ? 1 : FloatBits( 1.0f );
+	for ( uint32 c = 0; c < resultCount; c++ ) {
+		const samplerSwizzle_t swizzle = image->swizzle[ c ];
+		pResult[ c ].u[ lane ] = ( swizzle == samplerSwizzle_t::ZERO ) ? 0 : ( swizzle == samplerSwizzle_t::ONE ) ? one : pTexel[ ( uint32 )swizzle ];
+	}
+}
+
+void Sampler_Sample( const void * pImage, const void * pSampler, const shaderSampleOp_t * op, const shaderRegister_t * pRegisters, uint32 laneMask, shaderRegister_t * pResult ) {
+	const samplerDescriptor_t * imageDescriptor = reinterpret_cast< const samplerDescriptor_t * >( pImage );
+	const samplerDescriptor_t * samplerDescriptor = reinterpret_cast< const samplerDescriptor_t * >( pSampler );
+	const sampledImage_t * image = ( imageDescriptor != NULL ) ? imageDescriptor->image : NULL;
+	const sampler_t * sampler = ( samplerDescriptor != NULL ) ? samplerDescriptor->sampler : NULL;
+	const uint32 resultCount = Min( op->resultCount, ( uint32 )FORMAT_TEXEL_LANES );
+	const bool fetch = ( op->flags & SHADER_SAMPLE_FETCH ) != 0;
+	//The interpreter zeroes the results first, so anything unsupported samples zero
+	if ( image == NULL || image->layout == NULL || op->dimension != ( uint32 )spvDim_t::DIM_2D || ( !fetch && sampler == NULL ) ) {
+		return;
+	}
+	if ( image->decode != NULL ) {
+		Sampler_ValidateBlockCache();
+	}
+	uint32 texel[ FORMAT_TEXEL_LANES ];
+	if ( fetch ) {
+		for ( uint32 remaining = laneMask; remaining != 0; remaining &= remaining - 1 ) {
+			const uint32 lane = LowestBitIndex( remaining );
+			if ( Sampler_Fetch( image, op, pRegisters, lane, texel ) ) {
+				Sampler_Write( image, texel, lane, resultCount, pResult );
+			}
+		}
+		return;
+	}
+
+	const shaderRegister_t & u = pRegisters[ op->coordinateRegister + 0 ];
+	const shaderRegister_t & v = pRegisters[ op->coordinateRegister + 1 ];
+	for ( uint32 q = 0; q < ARRAY_LENGTH( samplerQuadBases ); q++ ) {
+		const uint32 base = samplerQuadBases[ q ];
+		const uint32 quadMask = laneMask & ( SAMPLER_QUAD_LANES << base );
+		if ( quadMask == 0 ) {
+			continue;
+		}
+		//Coarse derivatives, shared by the quad; helper lanes hold coordinates even when masked off
+		samplerFootprint_t footprint = { 0.0f, 1, 0.0f, 0.0f };
+		if ( ( op->flags & SHADER_SAMPLE_IMPLICIT_LOD ) != 0 ) {
+			const float dudx = u.f[ base + 1 ] - u.f[ base ];
+			const float dvdx = v.f[ base + 1 ] - v.f[ base ];
+			const float dudy = u.f[ base + 4 ] - u.f[ base ];
+			const float dvdy = v.f[ base + 4 ] - v.f[ base ];
+			Sampler_Footprint( sampler, image, dudx, dvdx, dudy, dvdy, &footprint );
+		}
+		for ( uint32 remaining = quadMask; remaining != 0; remaining &= remaining - 1 ) {
+			const uint32 lane = LowestBitIndex( remaining );
+			if ( ( op->flags & SHADER_SAMPLE_GRAD ) != 0 ) {
+				const shaderRegister_t * pGradients = pRegisters + op->gradientRegister;
+				Sampler_Footprint( sampler, image, pGradients[ 0 ].f[ lane ], pGradients[ 1 ].f[ lane ], pGradients[ 2 ].f[ lane ], pGradients[ 3 ].f[ lane ], &footprint );
+			} else if ( ( op->flags & SHADER_SAMPLE_EXPLICIT_LOD ) != 0 ) {
+				footprint.lambda = ( op->lodRegister != SHADER_NO_REGISTER ) ? pRegisters[ op->lodRegister ].f[ lane ] : 0.0f;
+			}
+			Sampler_Filter( sampler, image, op, pRegisters, lane, footprint, texel );
+			Sampler_Write( image, texel, lane, resultCount, pResult );
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Common.h"
+#include "Cpu.h"
+#include "Format.h"
+#include "ImageClear.h"
+#include "ImageLayout.h"
+#include "Shader.h"
+#include "vulkan/vulkan.h"
+
+//Matches maxSamplerAnisotropy and maxSamplerLodBias
+#define SAMPLER_MAX_ANISOTROPY 16
+#define SAMPLER_MAX_LOD_BIAS 15.0f
+//A bilinear footprint on each of two levels for every anisotropic sample
+#define SAMPLER_MAX_TAPS ( 4 * 2 * SAMPLER_MAX_ANISOTROPY )
+
+//Where each result component comes from: an unpacked lane, or a constant
+enum class samplerSwizzle_t : uint8 {
+	R,
+	G,
+	B,
+	A,
+	ZERO,
+	ONE
+};
+
+/*
+================================================
+sampledImage_t
+
+The sampling side of an image view: the subresources it covers and how its texels are decoded.  Built
+once when the view is created, so sampling never looks at the view's create info again.  Block-compressed
+views sample through the converter of the format their blocks decode to, and taps read their texels from
+a per-thread cache of decoded blocks rather than from the image.
+================================================
+*/
+struct sampledImage_t {
+	const imageLayout_t *	layout;				//NULL when the view's format cannot be sampled
+	uint8 *					data;
+	imageClearState_t *		clearState;			//pending tiles are written before anything samples the view; NULL when untracked
+	formatConverter_t		converter;
+	formatDecodeFunc_t		decode;				//NULL unless block-compressed
+	uint32					baseMipLevel;
+	uint32					levelCount;
+	uint32					baseArrayLayer;
+	uint32					layerCount;
+	bool					integer;			//nearest only, and results are copied rather than filtered
+	bool					fixedPoint;			//depth comparison references are clamped to [ 0, 1 ]
+	bool					identitySwizzle;
+	samplerSwizzle_t		swizzle[ 4 ];
+};
+
+bool	SampledImage_Init( sampledImage_t * image, const imageLayout_t * layout, uint8 * data, imageClearState_t * clearState, const VkImageViewCreateInfo * pCreateInfo, cpuIsa_t isa );
+
+/*
+================================================
+sampler_t
+
+A VkSampler specialized when it is created.  Filters and address modes pick tap functions compiled for
+that exact combination, so the per-texel loop never switches on sampler state; only samplers whose U and
+V modes differ take the generic one.  Taps are gathered raw, decoded for the whole footprint in one call
+to the format's converter and blended with the widest accumulate kernel the host runs.
+================================================
+*/
+struct sampler_t;
+
+struct samplerTap_t {
+	const uint8 *	pTexel;				//NULL outside a border-clamped image
+	float			weight;
+};
+
+//Appends the taps of one filter footprint around texel-space ( x, y ) of a level and layer; returns how many
+typedef uint32 ( * samplerTapFunc_t )( const sampler_t * sampler, const sampledImage_t * image, uint32 level, uint32 layer, float x, float y, float weight, samplerTap_t * pTaps );
+//Weighted sum of count unpacked texels into four float lanes
+typedef void ( * samplerAccumulateFunc_t )( const uint32 * pTexels, const samplerTap_t * pTaps, uint32 count, uint32 * pResult );
+
+struct sampler_t {
+	samplerTapFunc_t			magTaps;
+	samplerTapFunc_t			minTaps;
+	samplerTapFunc_t			nearestTaps;		//integer formats take one texel whatever the filters say
+	samplerAccumulateFunc_t		accumulate;
+	VkSamplerAddressMode		addressU;
+	VkSamplerAddressMode		addressV;
+	bool						mipmapLinear;
+	bool						unnormalized;
+	bool						compareEnable;
+	VkCompareOp					compareOp;
+	float						lodBias;
+	float						minLod;
+	float						maxLod;
+	uint32						maxAnisotropy;		//1 when anisotropic filtering is off
+	uint32						floatBorder[ FORMAT_TEXEL_LANES ];
+	uint32						intBorder[ FORMAT_TEXEL_LANES ];
+};
+
+void	Sampler_Init( sampler_t * sampler, const VkSamplerCreateInfo * pCreateInfo, cpuIsa_t isa );
+
+//What an image, sampler or combined descriptor element holds; either half is NULL when not written
+struct samplerDescriptor_t {
+	const sampledImage_t *	image;
+	const sampler_t *		sampler;
+};
+
+//The shaderSampleFunc_t of every program; pImage and pSampler point at samplerDescriptor_t elements.  Implicit
+//levels of detail come from the coarse derivatives of each 2x2 quad of the 4x4 lane block
+void	Sampler_Sample( const void * pImage, const void * pSampler, const shaderSampleOp_t * op, const shaderRegister_t * pRegisters, uint32 laneMask, shaderRegister_t * pResult );
+//Drops every thread's decoded blocks before they are next used; called whenever compressed image memory may have changed
+void	Sampler_InvalidateBlockCache();
@@ -0,0 +1,414 @@
+#pragma once
+
+#include "Common.h"
+#include "SpirV.h"
+#include "vulkan/vulkan.h"
+
+//Invocations run side by side, one per lane: 16 vertices, one 4x4 fragment block or 16 compute invocations
+#define SHADER_LANES 16
+#define SHADER_ALL_LANES 0xFFFF
+#define SHADER_NO_REGISTER 0xFFFFFFFF
+#define SHADER_NO_BUILTIN 0xFFFFFFFF
+#define SHADER_NO_MEMBER 0xFFFFFFFF
+//Push constants are addressed as one more resource slot past the descriptor bindings
+#define SHADER_PUSH_CONSTANT_SLOT 0xFFFFFFFE
+//and workgroup variables as one more again, in memory shared by every batch of the workgroup
+#define SHADER_WORKGROUP_SLOT 0xFFFFFFFD
+//Match maxComputeWorkGroupInvocations and maxComputeSharedMemorySize
+#define SHADER_MAX_WORKGROUP_INVOCATIONS 256
+#define SHADER_MAX_WORKGROUP_MEMORY ( 16 * 1024 )
+
+/*
+================================================
+shaderModule_t
+
+A validated copy of the SPIR-V words of a VkShaderModule with the lookups every program built from it
+needs: where each id is defined, its decorations sorted by ( id, member ), and the entry points.
+================================================
+*/
+struct shaderDecoration_t {
+	uint32				id;
+	uint32				member;			//SHADER_NO_MEMBER for decorations of the id itself
+	spvDecoration_t		decoration;
+	uint32				value;			//first literal, 0 when there is none
+};
+
+struct shaderEntryPoint_t {
+	spvExecutionModel_t	model;
+	uint32				function;
+	uint32				nameOffset;		//word offset of the nul-terminated name
+	uint32				interfaceOffset;
+	uint32				interfaceCount;
+};
+
+struct shaderModule_t {
+	const VkAllocationCallbacks *	allocator;
+	uint32 *						pWords;
+	uint32							wordCount;
+	uint32							bound;
+	uint32 *						pDefinitions;		//word offset of the instruction defining each id, 0 when undefined
+	shaderDecoration_t *			pDecorations;
+	uint32							decorationCount;
+	shaderEntryPoint_t *			pEntryPoints;
+	uint32							entryPointCount;
+	uint32							glslStd450;			//id of the imported GLSL.std.450 set, 0 when not imported
+};
+
+//codeSize is in bytes, as in VkShaderModuleCreateInfo
+VkResult	ShaderModule_Init( shaderModule_t * module, const uint32 * pCode, size_t codeSize, const VkAllocationCallbacks * allocator );
+void		ShaderModule_Shutdown( shaderModule_t * module );
+
+/*
+================================================
+Program IR
+
+Programs are lowered to scalar SSA over registers of SHADER_LANES 32-bit words: vectors, matrices,
+arrays and structs are flattened to runs of consecutive registers and every instruction works on one
+component of all lanes at once.  Registers below constantCount hold constants and are written once
+when a context is created.
+
+Structured control flow becomes mask operations rather than jumps: IF narrows the execution mask,
+ELSE flips it, ENDIF restores it, and loops keep running while any lane is still active.  Results are
+written to every lane unless the instruction is flagged SHADER_MASKED, which is set on writes that can
+be observed after the lanes that skipped them rejoin: stores to variables, phi copies and anything
+inside a loop.
+================================================
+*/
+//Opcodes are stored in pipeline caches: add new ones just before COUNT and bump PIPELINE_CACHE_FORMAT_VERSION
+enum class shaderOp_t : uint32 {
+	MOV,							//dst = src0
+
+	FADD,
+	FSUB,
+	FMUL,
+	FDIV,
+	FREM,							//sign of src0, as fmod
+	FMOD,							//sign of src1
+	FNEG,
+	FABS,
+	FSIGN,
+	FMIN,
+	FMAX,
+	FFLOOR,
+	FCEIL,
+	FTRUNC,
+	FROUND_EVEN,
+	FSQRT,
+	FRSQRT,
+	FSIN,
+	FCOS,
+	FTAN,
+	FASIN,
+	FACOS,
+	FATAN,
+	FATAN2,							//atan( src0 / src1 )
+	FPOW,
+	FEXP,
+	FLOG,
+	FEXP2,
+	FLOG2,
+
+	IADD,
+	ISUB,
+	IMUL,
+	UDIV,							//division by zero gives all ones, as the quotient is undefined
+	SDIV,
+	UMOD,
+	SREM,
+	SMOD,
+	INEG,
+	IABS,
+	ISIGN,
+	UMIN,
+	UMAX,
+	SMIN,
+	SMAX,
+	AND,
+	OR,
+	XOR,
+	NOT,
+	SHL,
+	SHR,
+	SAR,
+	BIT_COUNT,
+	FIND_LSB,						//-1 when no bit is set
+	FIND_UMSB,
+
+	F2S,							//saturating, NaN gives 0
+	F2U,
+	S2F,
+	U2F,
+
+	//Comparisons write all ones or zero
+	FORD_EQ,
+	FORD_NE,
+	FORD_LT,
+	FORD_LE,
+	FUNORD_EQ,
+	FUNORD_NE,
+	FUNORD_LT,
+	FUNORD_LE,
+	IEQ,
+	INE,
+	ULT,
+	ULE,
+	SLT,
+	SLE,
+	ISNAN,
+	ISINF,
+	SELECT,							//dst = src0 ? src1 : src2
+
+	//Fragment derivatives across the 2x2 quads of the 4x4 lane block
+	DPDX_FINE,
+	DPDY_FINE,
+	DPDX_COARSE,
+	DPDY_COARSE,
+
+	LOAD_INDEXED,					//dst = register[ src0 + min( src1, src2 ) ]
+	STORE_INDEXED,					//register[ dst + min( src1, src2 ) ] = src0
+	LOAD_BUFFER,					//dst = the word at buffer access src0
+	STORE_BUFFER,					//the word at buffer access src0 = src1
+	SAMPLE,							//dst .. dst + 3 = sample operation src0
+
+	//Subgroups are aligned runs of context->subgroupSize lanes; lanes outside the execution mask take no part
+	SUBGROUP_BUILTIN,				//dst = builtin src0: SubgroupSize, SubgroupLocalInvocationId or the first word of a Subgroup*Mask
+	SUBGROUP_ELECT,					//dst = true in the lowest active lane of each subgroup
+	SUBGROUP_ALL,					//dst = src0 is true in every active lane of the subgroup
+	SUBGROUP_ANY,
+	SUBGROUP_ALL_EQUAL,				//every active lane holds the same bits in src0
+	SUBGROUP_BALLOT,				//dst bit i = subgroup lane i is active and src0 is true there
+	SUBGROUP_INVERSE_BALLOT,		//dst = the lane's own bit of src0
+	SUBGROUP_BROADCAST_FIRST,		//dst = src0 of the lowest active lane, or of the first lane when none is
+	SUBGROUP_SHUFFLE,				//dst = src0 of subgroup lane src1, or of the lane itself when that is past the subgroup
+	SUBGROUP_SHUFFLE_XOR,			//of lane id ^ src1
+	SUBGROUP_SHUFFLE_UP,			//of lane id - src1
+	SUBGROUP_SHUFFLE_DOWN,			//of lane id + src1
+	SUBGROUP_REDUCE,				//dst = src0 of the active lanes combined by op src1, over clusters of src2 lanes or the whole subgroup for 0
+	SUBGROUP_INCLUSIVE_SCAN,		//over the active lanes up to and including this one
+	SUBGROUP_EXCLUSIVE_SCAN,		//over those before it, the identity of op src1 in the first
+
+	IF,								//src0 condition, src1 ELSE, src2 ENDIF
+	ELSE,							//src1 ENDIF
+	ENDIF,
+	LOOP_BEGIN,
+	CONTINUE_TARGET,
+	LOOP_END,						//src0 first instruction of the body
+	BREAK,
+	CONTINUE,
+	SWITCH_BEGIN,
+	SWITCH_END,
+	CALL_BEGIN,
+	CALL_END,
+	RETURN,
+	KILL,
+	BARRIER,						//waits for every other batch of the workgroup to get here
+
+	COUNT
+};
+
+#define SHADER_MASKED BIT( 0 )
+
+struct shaderInstruction_t {
+	shaderOp_t	op;
+	uint32		flags;
+	uint32		dst;
+	uint32		src[ 3 ];
+};
+
+//A 32-bit word of buffer memory: descriptor element plus byte offset, either part optionally varying per lane
+struct shaderBufferAccess_t {
+	uint32		slot;				//binding slot, SHADER_PUSH_CONSTANT_SLOT or SHADER_WORKGROUP_SLOT
+	uint32		element;			//array element of the binding
+	uint32		elementRegister;	//added to element when not SHADER_NO_REGISTER
+	uint32		offset;				//bytes
+	uint32		offsetRegister;		//added to offset when not SHADER_NO_REGISTER
+};
+
+enum shaderSampleFlags_t {
+	SHADER_SAMPLE_IMPLICIT_LOD	= BIT( 0 ),
+	SHADER_SAMPLE_EXPLICIT_LOD	= BIT( 1 ),
+	SHADER_SAMPLE_BIAS			= BIT( 2 ),
+	SHADER_SAMPLE_GRAD			= BIT( 3 ),
+	SHADER_SAMPLE_DREF			= BIT( 4 ),
+	SHADER_SAMPLE_FETCH			= BIT( 5 ),
+	SHADER_SAMPLE_OFFSET		= BIT( 6 )
+};
+
+struct shaderSampleOp_t {
+	uint32		flags;
+	uint32		imageSlot;
+	uint32		imageElement;
+	uint32		imageElementRegister;
+	uint32		samplerSlot;			//equal to imageSlot for combined image samplers
+	uint32		samplerElement;
+	uint32		samplerElementRegister;
+	uint32		dimension;				//SPIR-V Dim
+	bool		arrayed;
+	uint32		coordinateRegister;
+	uint32		coordinateCount;
+	uint32		lodRegister;			//level for explicit lod and fetch, bias otherwise
+	uint32		drefRegister;
+	uint32		gradientRegister;		//dx components followed by dy components
+	uint32		offsetRegister;
+	uint32		resultCount;			//4, or 1 for depth comparisons
+};
+
+enum class shaderBindingKind_t : uint32 {
+	UNIFORM_BUFFER,
+	STORAGE_BUFFER,
+	SAMPLED_IMAGE,
+	SAMPLER,
+	COMBINED_IMAGE_SAMPLER,
+	STORAGE_IMAGE
+};
+
+//Resource slot i of a program is its i-th binding
+struct shaderBinding_t {
+	uint32				set;
+	uint32				binding;
+	shaderBindingKind_t	kind;
+	uint32				arraySize;
+};
+
+//One scalar of the stage interface: a builtin component, or a location and component
+struct shaderInterface_t {
+	uint32		builtIn;			//spvBuiltIn_t, or SHADER_NO_BUILTIN for user locations
+	uint32		location;
+	uint32		component;
+	uint32		reg;
+	bool		flat;
+	bool		noPerspective;
+};
+
+enum shaderProgramFlags_t {
+	SHADER_PROGRAM_USES_KILL			= BIT( 0 ),
+	SHADER_PROGRAM_USES_DERIVATIVES		= BIT( 1 ),
+	SHADER_PROGRAM_ORIGIN_UPPER_LEFT	= BIT( 2 ),
+	SHADER_PROGRAM_EARLY_FRAGMENT_TESTS	= BIT( 3 ),
+	SHADER_PROGRAM_DEPTH_REPLACING		= BIT( 4 ),
+	SHADER_PROGRAM_WRITES_BUFFERS		= BIT( 5 ),
+	SHADER_PROGRAM_USES_BARRIERS		= BIT( 6 )		//the workgroup is wider than a batch and its batches must meet
+};
+
+struct shaderProgram_t {
+	const VkAllocationCallbacks *	allocator;
+	VkShaderStageFlagBits			stage;
+	uint32							flags;
+	uint32							localSize[ 3 ];
+	shaderInstruction_t *			pInstructions;
+	uint32							instructionCount;
+	uint32 *						pConstants;			//initial value of registers 0 .. constantCount - 1
+	uint32							constantCount;
+	uint32							registerCount;
+	uint32							frameDepth;			//deepest nesting of control constructs
+	uint32							workgroupMemorySize;	//bytes of workgroup variables
+	shaderInterface_t *				pInputs;
+	uint32							inputCount;
+	shaderInterface_t *				pOutputs;
+	uint32							outputCount;
+	shaderBinding_t *				pBindings;
+	uint32							bindingCount;
+	shaderBufferAccess_t *			pBufferAccesses;
+	uint32							bufferAccessCount;
+	shaderSampleOp_t *				pSampleOps;
+	uint32							sampleOpCount;
+};
+
+//Fails, with a debug message, on modules using anything outside the supported subset
+bool	ShaderProgram_Build( shaderProgram_t * program, const shaderModule_t * module, VkShaderStageFlagBits stage, const char * pEntryName, const VkSpecializationInfo * pSpecializationInfo, const VkAllocationCallbacks * allocator );
+void	ShaderProgram_Destroy( shaderProgram_t * program );
+//Register of an interface scalar, or SHADER_NO_REGISTER when the program does not use it
+uint32	ShaderProgram_FindBuiltIn( const shaderProgram_t * program, bool output, spvBuiltIn_t builtIn, uint32 component );
+uint32	ShaderProgram_FindLocation( const shaderProgram_t * program, bool output, uint32 location, uint32 component );
+
+/*
+================================================
+shaderContext_t
+
+Per-thread execution state of one program.  Callers write the input registers, run, and read the
+output registers back.  Resource slots follow the program's bindings; buffer elements point at a
+shaderBufferView_t and image or sampler elements are passed through to the sample callback untouched.
+Buffer accesses outside the bound range read zero and drop writes.
+
+Batches of one compute workgroup each have a context of their own, all pointing at the same workgroup
+memory.  BARRIER calls the barrier callback, which is expected to return only once every other batch has
+reached the barrier too; a workgroup of one batch needs none, since its lanes get there together.
+
+The subgroup size is the caller's choice and only changes how the lanes of a batch are split up, so the
+same program runs at any width: the pipelines match it to the host's vector width.
+================================================
+*/
+union shaderRegister_t {
+	float	f[ SHADER_LANES ];
+	uint32	u[ SHADER_LANES ];
+	int32	i[ SHADER_LANES ];
+};
+
+struct shaderBufferView_t {
+	uint8 *		data;
+	uint64		range;
+};
+
+struct shaderResource_t {
+	const void * const *	ppElements;
+	uint32					elementCount;
+};
+
+//Fills op->resultCount registers for the lanes in laneMask
+typedef void ( * shaderSampleFunc_t )( const void * pImage, const void * pSampler, const shaderSampleOp_t * op, const shaderRegister_t * pRegisters, uint32 laneMask, shaderRegister_t * pResult );
+
+struct shaderResources_t {
+	const shaderResource_t *	pSlots;
+	const uint8 *				pPushConstants;
+	uint32						pushConstantSize;
+	shaderSampleFunc_t			sample;				//NULL samples zero
+};
+
+struct shaderFrame_t;
+
+typedef void ( * shaderBarrierFunc_t )( void * pArgument );
+
+struct shaderContext_t {
+	const shaderProgram_t *			program;
+	const VkAllocationCallbacks *	allocator;
+	shaderRegister_t *				pRegisters;
+	shaderFrame_t *					pFrames;
+	uint8 *							pWorkgroupMemory;	//program->workgroupMemorySize bytes, set by the caller
+	uint32							subgroupSize;		//4, 8 or 16
+	shaderBarrierFunc_t				barrier;			//NULL makes BARRIER a no-op
+	void *							pBarrierArgument;
+};
+
+bool	ShaderContext_Init( shaderContext_t * context, const shaderProgram_t * program, uint32 subgroupSize, const VkAllocationCallbacks * allocator );
+void	ShaderContext_Shutdown( shaderContext_t * context );
+//Runs the lanes in laneMask and returns those that did not execute OpKill.  Lanes in helperMask run only
+//to feed derivatives and never write buffer memory.
+uint32	ShaderContext_Run( shaderContext_t * context, uint32 laneMask, uint32 helperMask, const shaderResources_t * resources );
+
+/*
+Masks of one run.  ShaderContext_Run is a loop over ShaderExecution_Step; compiled code keeps the same
+state and calls ShaderExecution_Step for every instruction it has no inline sequence for, so both paths
+share one definition of every op and of the control-flow rules.
+*/
+struct shaderExecution_t {
+	alignas( 16 ) uint32	lanes[ SHADER_LANES ];		//exec expanded to one all-ones or zero word per lane
+	shaderFrame_t *			pFrames;
+	uint32					depth;
+	uint32					live;						//laneMask of the run
+	uint32					helpers;
+	uint32					killed;
+	uint32					exec;
+};
+
+void	ShaderExecution_Begin( shaderExecution_t * execution, shaderContext_t * context, uint32 laneMask, uint32 helperMask );
+//Executes the instruction at pc and returns the pc to continue at
+uint32	ShaderExecution_Step( shaderExecution_t * execution, shaderContext_t * context, const shaderResources_t * resources, uint32 pc );
+
+//What SUBGROUP_BUILTIN writes to one lane, for compiled code to fold into constants
+uint32	ShaderSubgroup_BuiltIn( spvBuiltIn_t builtIn, uint32 lane, uint32 subgroupSize );
+//Start value of a SUBGROUP_REDUCE or scan over op: what lanes outside the execution mask contribute
+uint32	ShaderSubgroup_Identity( shaderOp_t op );
+
+inline shaderRegister_t * ShaderContext_Register( shaderContext_t * context, uint32 reg ) {
+	return &context->pRegisters[ reg ];
+}
@@ -0,0 +1,3063 @@
+#include "Shader.h"
+#include "Platform.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Registers are numbered per region while lowering; constants carry the tag until the final renumbering
+#define SHADER_CONSTANT_TAG 0x80000000
+//64 KiB registers, 4 MiB of state per context
+#define SHADER_MAX_REGISTERS ( 64 * 1024 )
+#define SHADER_CONSTANT_TABLE_MIN 256
+//Bounds on inlining and unrolled emission, so malformed control flow fails instead of running away
+#define SHADER_MAX_FRAMES 256
+#define SHADER_MAX_INSTRUCTIONS ( 1024 * 1024 )
+
+static spvOp_t Spv_Op( const uint32 * inst ) {
+	return ( spvOp_t )( inst[ 0 ] & SPV_OPCODE_MASK );
+}
+
+static uint32 Spv_WordCount( const uint32 * inst ) {
+	return inst[ 0 ] >> SPV_WORD_COUNT_SHIFT;
+}
+
+//Word index of the result id of an instruction, 0 when it has none
+static uint32 Spv_ResultIndex( spvOp_t op ) {
+	switch ( op ) {
+		case spvOp_t::NOP:
+		case spvOp_t::SOURCE_CONTINUED:
+		case spvOp_t::SOURCE:
+		case spvOp_t::SOURCE_EXTENSION:
+		case spvOp_t::NAME:
+		case spvOp_t::MEMBER_NAME:
+		case spvOp_t::LINE:
+		case spvOp_t::EXTENSION:
+		case spvOp_t::MEMORY_MODEL:
+		case spvOp_t::ENTRY_POINT:
+		case spvOp_t::EXECUTION_MODE:
+		case spvOp_t::CAPABILITY:
+		case spvOp_t::TYPE_FORWARD_POINTER:
+		case spvOp_t::FUNCTION_END:
+		case spvOp_t::STORE:
+		case spvOp_t::COPY_MEMORY:
+		case spvOp_t::DECORATE:
+		case spvOp_t::MEMBER_DECORATE:
+		case spvOp_t::GROUP_DECORATE:
+		case spvOp_t::GROUP_MEMBER_DECORATE:
+		case spvOp_t::IMAGE_WRITE:
+		case spvOp_t::CONTROL_BARRIER:
+		case spvOp_t::MEMORY_BARRIER:
+		case spvOp_t::LOOP_MERGE:
+		case spvOp_t::SELECTION_MERGE:
+		case spvOp_t::BRANCH:
+		case spvOp_t::BRANCH_CONDITIONAL:
+		case spvOp_t::SWITCH:
+		case spvOp_t::KILL:
+		case spvOp_t::RETURN:
+		case spvOp_t::RETURN_VALUE:
+		case spvOp_t::UNREACHABLE:
+		case spvOp_t::NO_LINE:
+		case spvOp_t::MODULE_PROCESSED:
+			return 0;
+		case spvOp_t::STRING:
+		case spvOp_t::EXT_INST_IMPORT:
+		case spvOp_t::DECORATION_GROUP:
+		case spvOp_t::LABEL:
+			return 1;
+		default:
+			if ( op >= spvOp_t::TYPE_VOID && op < spvOp_t::TYPE_FORWARD_POINTER ) {
+				return 1;
+			}
+			return 2;
+	}
+}
+
+/*
+================================================
+Module
+================================================
+*/
+static int CompareDecorations( const void * a, const void * b ) {
+	const shaderDecoration_t * da = reinterpret_cast< const shaderDecoration_t * >( a );
+	const shaderDecoration_t * db = reinterpret_cast< const shaderDecoration_t * >( b );
+	if ( da->id != db->id ) {
+		return da->id < db->id ? -1 : 1;
+	}
+	if ( da->member != db->member ) {
+		return da->member < db->member ? -1 : 1;
+	}
+	return 0;
+}
+
+static bool Module_AddDecoration( shaderModule_t * module, uint32 * pCapacity, uint32 id, uint32 member, uint32 decoration, uint32 value ) {
+	if ( module->decorationCount == *pCapacity ) {
+		const uint32 newCapacity = Max( *pCapacity * 2, 64u );
+		shaderDecoration_t * newArray = reinterpret_cast< shaderDecoration_t * >( module->allocator->pfnReallocation( module->allocator->pUserData, module->pDecorations, sizeof( shaderDecoration_t ) * newCapacity, 4, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+		if ( newArray == NULL ) {
+			return false;
+		}
+		module->pDecorations = newArray;
+		*pCapacity = newCapacity;
+	}
+	shaderDecoration_t * entry = &module->pDecorations[ module->decorationCount++ ];
+	entry->id = id;
+	entry->member = member;
+	entry->decoration = ( spvDecoration_t )decoration;
+	entry->value = value;
+	return true;
+}
+
+//Decorations of a group are declared before the group is applied, so they are copied in module order
+static bool Module_ApplyGroup( shaderModule_t * module, uint32 * pCapacity, uint32 group, uint32 target, uint32 member ) {
+	const uint32 count = module->decorationCount;
+	for ( uint32 i = 0; i < count; i++ ) {
+		const shaderDecoration_t entry = module->pDecorations[ i ];
+		if ( entry.id == group && entry.member == SHADER_NO_MEMBER ) {
+			if ( !Module_AddDecoration( module, pCapacity, target, member, ( uint32 )entry.decoration, entry.value ) ) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+VkResult ShaderModule_Init( shaderModule_t * module, const uint32 * pCode, size_t codeSize, const VkAllocationCallbacks * allocator ) {
+	memset( module, 0, sizeof( shaderModule_t ) );
+	module->allocator = allocator;
+	const uint32 wordCount = ( uint32 )( codeSize / sizeof( uint32 ) );
+	if ( codeSize % sizeof( uint32 ) != 0 || wordCount < SPV_HEADER_WORDS || pCode[ 0 ] != SPV_MAGIC || pCode[ 3 ] == 0 ) {
+		return VK_ERROR_VALIDATION_FAILED_EXT;
+	}
+	const uint32 bound = pCode[ 3 ];
+	module->wordCount = wordCount;
+	module->bound = bound;
+	module->pWords = reinterpret_cast< uint32 * >( allocator->pfnAllocation( allocator->pUserData, codeSize, 4, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	module->pDefinitions = reinterpret_cast< uint32 * >( allocator->pfnAllocation( allocator->pUserData, sizeof( uint32 ) * bound, 4, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( module->pWords == NULL || module->pDefinitions == NULL ) {
+		ShaderModule_Shutdown( module );
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	memcpy( module->pWords, pCode, codeSize );
+	memset( module->pDefinitions, 0, sizeof( uint32 ) * bound );
+
+	uint32 decorationCapacity = 0;
+	uint32 entryPointCapacity = 0;
+	const uint32 * words = module->pWords;
+	for ( uint32 offset = SPV_HEADER_WORDS; offset < wordCount; ) {
+		const uint32 * inst = words + offset;
+		const uint32 length = Spv_WordCount( inst );
+		if ( length == 0 || offset + length > wordCount ) {
+			goto moduleFailed;
+		}
+		const spvOp_t op = Spv_Op( inst );
+		const uint32 resultIndex = Spv_ResultIndex( op );
+		if ( resultIndex != 0 && resultIndex < length ) {
+			const uint32 id = inst[ resultIndex ];
+			if ( id == 0 || id >= bound ) {
+				goto moduleFailed;
+			}
+			//The first definition wins, so an opcode this table does not know cannot clobber one
+			if ( module->pDefinitions[ id ] == 0 ) {
+				module->pDefinitions[ id ] = offset;
+			}
+		}
+		switch ( op ) {
+			case spvOp_t::DECORATE:
+				if ( length < 3 ) {
+					goto moduleFailed;
+				}
+				if ( !Module_AddDecoration( module, &decorationCapacity, inst[ 1 ], SHADER_NO_MEMBER, inst[ 2 ], length > 3 ? inst[ 3 ] : 0 ) ) {
+					goto moduleOutOfMemory;
+				}
+				break;
+			case spvOp_t::MEMBER_DECORATE:
+				if ( length < 4 ) {
+					goto moduleFailed;
+				}
+				if ( !Module_AddDecoration( module, &decorationCapacity, inst[ 1 ], inst[ 2 ], inst[ 3 ], length > 4 ? inst[ 4 ] : 0 ) ) {
+					goto moduleOutOfMemory;
+				}
+				break;
+			case spvOp_t::GROUP_DECORATE:
+				for ( uint32 i = 2; i < length; i++ ) {
+					if ( !Module_ApplyGroup( module, &decorationCapacity, inst[ 1 ], inst[ i ], SHADER_NO_MEMBER ) ) {
+						goto moduleOutOfMemory;
+					}
+				}
+				break;
+			case spvOp_t::GROUP_MEMBER_DECORATE:
+				for ( uint32 i = 2; i + 1 < length; i += 2 ) {
+					if ( !Module_ApplyGroup( module, &decorationCapacity, inst[ 1 ], inst[ i ], inst[ i + 1 ] ) ) {
+						goto moduleOutOfMemory;
+					}
+				}
+				break;
+			case spvOp_t::EXT_INST_IMPORT:
+				if ( length > 2 && strncmp( reinterpret_cast< const char * >( inst + 2 ), "GLSL.std.450", ( length - 2 ) * sizeof( uint32 ) ) == 0 ) {
+					module->glslStd450 = inst[ 1 ];
+				}
+				break;
+			case spvOp_t::ENTRY_POINT: {
+				if ( length < 4 ) {
+					goto moduleFailed;
+				}
+				if ( module->entryPointCount == entryPointCapacity ) {
+					entryPointCapacity = Max( entryPointCapacity * 2, 4u );
+					shaderEntryPoint_t * newArray = reinterpret_cast< shaderEntryPoint_t * >( allocator->pfnReallocation( allocator->pUserData, module->pEntryPoints, sizeof( shaderEntryPoint_t ) * entryPointCapacity, 4, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+					if ( newArray == NULL ) {
+						goto moduleOutOfMemory;
+					}
+					module->pEntryPoints = newArray;
+				}
+				const size_t nameLength = strnlen( reinterpret_cast< const char * >( inst + 3 ), ( length - 3 ) * sizeof( uint32 ) );
+				const uint32 nameWords = ( uint32 )( nameLength / sizeof( uint32 ) ) + 1;
+				if ( 3 + nameWords > length ) {
+					goto moduleFailed;
+				}
+				shaderEntryPoint_t * entryPoint = &module->pEntryPoints[ module->entryPointCount++ ];
+				entryPoint->model = ( spvExecutionModel_t )inst[ 1 ];
+				entryPoint->function = inst[ 2 ];
+				entryPoint->nameOffset = offset + 3;
+				entryPoint->interfaceOffset = offset + 3 + nameWords;
+				entryPoint->interfaceCount = length - 3 - nameWords;
+				break;
+			}
+			default:
+				break;
+		}
+		offset += length;
+	}
+	qsort( module->pDecorations, module->decorationCount, sizeof( shaderDecoration_t ), CompareDecorations );
+	return VK_SUCCESS;
+
+moduleOutOfMemory:
+	ShaderModule_Shutdown( module );
+	return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+moduleFailed:
+	ShaderModule_Shutdown( module );
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void ShaderModule_Shutdown( shaderModule_t * module ) {
+	const VkAllocationCallbacks * allocator = module->allocator;
+	if ( allocator == NULL ) {
+		return;
+	}
+	allocator->pfnFree( allocator->pUserData, module->pWords );
+	allocator->pfnFree( allocator->pUserData, module->pDefinitions );
+	allocator->pfnFree( allocator->pUserData, module->pDecorations );
+	allocator->pfnFree( allocator->pUserData, module->pEntryPoints );
+	memset( module, 0, sizeof( shaderModule_t ) );
+}
+
+static const uint32 * Module_Instruction( const shaderModule_t * module, uint32 id ) {
+	if ( id == 0 || id >= module->bound || module->pDefinitions[ id ] == 0 ) {
+		return NULL;
+	}
+	return module->pWords + module->pDefinitions[ id ];
+}
+
+static bool Module_FindDecoration( const shaderModule_t * module, uint32 id, uint32 member, spvDecoration_t decoration, uint32 * pValue ) {
+	uint32 low = 0;
+	uint32 high = module->decorationCount;
+	while ( low < high ) {
+		const uint32 middle = ( low + high ) / 2;
+		const shaderDecoration_t & entry = module->pDecorations[ middle ];
+		if ( entry.id < id || ( entry.id == id && entry.member < member ) ) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	for ( uint32 i = low; i < module->decorationCount && module->pDecorations[ i ].id == id && module->pDecorations[ i ].member == member; i++ ) {
+		if ( module->pDecorations[ i ].decoration == decoration ) {
+			if ( pValue != NULL ) {
+				*pValue = module->pDecorations[ i ].value;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+================================================
+Compiler state
+
+Every SPIR-V id maps to one shaderValue_t.  SSA values are runs of registers; pointers to variables
+are a root run plus a constant and an optional per-lane register offset; pointers into buffers are a
+descriptor element plus a byte offset with the layout decorations picked up along the access chain.
+Functions are inlined at every call site, so the values of a callee's ids are reset on each call.
+================================================
+*/
+enum class shaderValueKind_t : uint32 {
+	NONE,
+	REGISTERS,
+	REGISTER_POINTER,
+	BUFFER_POINTER,
+	IMAGE_POINTER,
+	IMAGE
+};
+
+struct shaderValue_t {
+	shaderValueKind_t	kind;
+	uint32				type;					//the pointee type for pointers
+	uint32				reg;					//first register, or first register of the root variable
+	uint32				count;					//registers in the value or in the root variable
+	uint32				offset;					//registers into the root, or bytes into the buffer
+	uint32				indexRegister;			//per-lane addition to offset
+	uint32				slot;
+	uint32				element;
+	uint32				elementRegister;
+	uint32				samplerSlot;
+	uint32				samplerElement;
+	uint32				samplerElementRegister;
+	uint32				componentStride;
+	uint32				matrixStride;
+	bool				rowMajor;
+	bool				descriptorArray;		//the next access chain index selects the descriptor element
+	bool				packed;					//workgroup memory, which has no layout decorations and is laid out like registers
+};
+
+enum class shaderConstructKind_t : uint32 {
+	LOOP,
+	SWITCH
+};
+
+struct shaderConstruct_t {
+	shaderConstructKind_t	kind;
+	uint32					merge;
+	uint32					continueTarget;
+};
+
+struct shaderConstantEntry_t {
+	uint32	value;
+	uint32	index;				//constant index + 1, 0 for an empty entry
+};
+
+template< typename __type__ >
+struct shaderList_t {
+	__type__ *	pData;
+	uint32		count;
+	uint32		capacity;
+	__type__	overflow;		//handed out once growing fails, so emitters need not check every append
+};
+
+struct shaderCompiler_t {
+	const shaderModule_t *				module;
+	const VkAllocationCallbacks *		allocator;
+	const VkSpecializationInfo *		specialization;
+	VkShaderStageFlagBits				stage;
+	const shaderEntryPoint_t *			entryPoint;
+	bool								failed;
+	uint32								flags;
+	uint32								localSize[ 3 ];
+	uint32								workgroupMemorySize;
+	shaderValue_t *						pValues;
+	shaderValue_t						nullValue;
+	shaderConstantEntry_t *				pConstantTable;
+	uint32								constantTableSize;
+	uint32								registerCount;
+	uint32								loopDepth;
+	uint32								frameDepth;
+	uint32								maxFrameDepth;
+	uint32								returnRegister;
+	shaderList_t< shaderInstruction_t >	instructions;
+	shaderList_t< uint32 >				constants;
+	shaderList_t< shaderInterface_t >	inputs;
+	shaderList_t< shaderInterface_t >	outputs;
+	shaderList_t< shaderBinding_t >		bindings;
+	shaderList_t< shaderBufferAccess_t >	bufferAccesses;
+	shaderList_t< shaderSampleOp_t >	sampleOps;
+	shaderList_t< shaderConstruct_t >	constructs;
+};
+
+static void Compiler_Fail( shaderCompiler_t * c, const char * reason, uint32 detail ) {
+	if ( !c->failed ) {
+		Platform_DebugPrintf( "ShaderCompiler: %s (%u)\n", reason, detail );
+	}
+	c->failed = true;
+}
+
+template< typename __type__ >
+static __type__ * Compiler_Push( shaderCompiler_t * c, shaderList_t< __type__ > * list ) {
+	if ( list->count == list->capacity ) {
+		const uint32 newCapacity = Max( list->capacity * 2, 64u );
+		__type__ * newData = reinterpret_cast< __type__ * >( c->allocator->pfnReallocation( c->allocator->pUserData, list->pData, sizeof( __type__ ) * newCapacity, 64, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+		if ( newData == NULL ) {
+			Compiler_Fail( c, "out of memory", newCapacity );
+			memset( &list->overflow, 0, sizeof( __type__ ) );
+			return &list->overflow;
+		}
+		list->pData = newData;
+		list->capacity = newCapacity;
+	}
+	__type__ * element = &list->pData[ list->count++ ];
+	memset( element, 0, sizeof( __type__ ) );
+	return element;
+}
+
+template< typename __type__ >
+static void Compiler_FreeList( shaderCompiler_t * c, shaderList_t< __type__ > * list ) {
+	c->allocator->pfnFree( c->allocator->pUserData, list->pData );
+	list->pData = NULL;
+	list->count = 0;
+	list->capacity = 0;
+}
+
+static const uint32 * Compiler_Instruction( shaderCompiler_t * c, uint32 id ) {
+	const uint32 * inst = Module_Instruction( c->module, id );
+	if ( inst == NULL ) {
+		Compiler_Fail( c, "undefined id", id );
+	}
+	return inst;
+}
+
+static bool Compiler_Decoration( shaderCompiler_t * c, uint32 id, uint32 member, spvDecoration_t decoration, uint32 * pValue ) {
+	return Module_FindDecoration( c->module, id, member, decoration, pValue );
+}
+
+static uint32 Compiler_Allocate( shaderCompiler_t * c, uint32 count ) {
+	const uint32 first = c->registerCount;
+	if ( count > SHADER_MAX_REGISTERS - first ) {
+		Compiler_Fail( c, "register file exhausted", count );
+		return 0;
+	}
+	c->registerCount += count;
+	return first;
+}
+
+static uint32 Compiler_Emit( shaderCompiler_t * c, shaderOp_t op, uint32 dst, uint32 src0 = SHADER_NO_REGISTER, uint32 src1 = SHADER_NO_REGISTER, uint32 src2 = SHADER_NO_REGISTER ) {
+	const uint32 index = c->instructions.count;
+	if ( index >= SHADER_MAX_INSTRUCTIONS ) {
+		Compiler_Fail( c, "program too long", index );
+		return index;
+	}
+	shaderInstruction_t * inst = Compiler_Push( c, &c->instructions );
+	inst->op = op;
+	inst->flags = ( c->loopDepth != 0 && op < shaderOp_t::IF ) ? SHADER_MASKED : 0;
+	inst->dst = dst;
+	inst->src[ 0 ] = src0;
+	inst->src[ 1 ] = src1;
+	inst->src[ 2 ] = src2;
+	return index;
+}
+
+//Writes that lanes outside the current mask must not see: variables, phis and return values
+static void Compiler_EmitMasked( shaderCompiler_t * c, shaderOp_t op, uint32 dst, uint32 src0, uint32 src1 = SHADER_NO_REGISTER, uint32 src2 = SHADER_NO_REGISTER ) {
+	const uint32 index = Compiler_Emit( c, op, dst, src0, src1, src2 );
+	if ( index < c->instructions.count ) {
+		c->instructions.pData[ index ].flags |= SHADER_MASKED;
+	}
+}
+
+static uint32 Compiler_Op( shaderCompiler_t * c, shaderOp_t op, uint32 src0, uint32 src1 = SHADER_NO_REGISTER, uint32 src2 = SHADER_NO_REGISTER ) {
+	const uint32 dst = Compiler_Allocate( c, 1 );
+	Compiler_Emit( c, op, dst, src0, src1, src2 );
+	return dst;
+}
+
+static void Compiler_PushFrame( shaderCompiler_t * c ) {
+	c->frameDepth++;
+	if ( c->frameDepth > SHADER_MAX_FRAMES ) {
+		Compiler_Fail( c, "control flow nested too deeply", c->frameDepth );
+	}
+	c->maxFrameDepth = Max( c->maxFrameDepth, c->frameDepth );
+}
+
+static void Compiler_PopFrame( shaderCompiler_t * c ) {
+	c->frameDepth--;
+}
+
+/*
+================================================
+Constants
+================================================
+*/
+static bool Compiler_GrowConstantTable( shaderCompiler_t * c ) {
+	const uint32 newSize = Max( c->constantTableSize * 2, ( uint32 )SHADER_CONSTANT_TABLE_MIN );
+	shaderConstantEntry_t * newTable = reinterpret_cast< shaderConstantEntry_t * >( c->allocator->pfnAllocation( c->allocator->pUserData, sizeof( shaderConstantEntry_t ) * newSize, 64, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ) );
+	if ( newTable == NULL ) {
+		Compiler_Fail( c, "out of memory", newSize );
+		return false;
+	}
+	memset( newTable, 0, sizeof( shaderConstantEntry_t ) * newSize );
+	for ( uint32 i = 0; i < c->constantTableSize; i++ ) {
+		const shaderConstantEntry_t & entry = c->pConstantTable[ i ];
+		if ( entry.index != 0 ) {
+			uint32 slot = ( entry.value * 2654435761u ) & ( newSize - 1 );
+			while ( newTable[ slot ].index != 0 ) {
+				slot = ( slot + 1 ) & ( newSize - 1 );
+			}
+			newTable[ slot ] = entry;
+		}
+	}
+	c->allocator->pfnFree( c->allocator->pUserData, c->pConstantTable );
+	c->pConstantTable = newTable;
+	c->constantTableSize = newSize;
+	return true;
+}
+
+//A single-register constant, shared by every use of the same bits
+static uint32 Compiler_Constant( shaderCompiler_t * c, uint32 value ) {
+	if ( ( c->constants.count + 1 ) * 2 > c->constantTableSize && !Compiler_GrowConstantTable( c ) ) {
+		return SHADER_CONSTANT_TAG;
+	}
+	uint32 slot = ( value * 2654435761u ) & ( c->constantTableSize - 1 );
+	while ( c->pConstantTable[ slot ].index != 0 ) {
+		if ( c->pConstantTable[ slot ].value == value ) {
+			return SHADER_CONSTANT_TAG | ( c->pConstantTable[ slot ].index - 1 );
+		}
+		slot = ( slot + 1 ) & ( c->constantTableSize - 1 );
+	}
+	const uint32 index = c->constants.count;
+	*Compiler_Push( c, &c->constants ) = value;
+	c->pConstantTable[ slot ].value = value;
+	c->pConstantTable[ slot ].index = index + 1;
+	return SHADER_CONSTANT_TAG | index;
+}
+
+static uint32 Compiler_FloatConstant( shaderCompiler_t * c, float value ) {
+	uint32 bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	return Compiler_Constant( c, bits );
+}
+
+static bool Compiler_IsConstant( uint32 reg ) {
+	return reg != SHADER_NO_REGISTER && ( reg & SHADER_CONSTANT_TAG ) != 0;
+}
+
+static uint32 Compiler_ConstantValue( shaderCompiler_t * c, uint32 reg ) {
+	const uint32 index = reg & ~SHADER_CONSTANT_TAG;
+	return index < c->constants.count ? c->constants.pData[ index ] : 0;
+}
+
+/*
+================================================
+Types
+================================================
+*/
+static bool Compiler_ScalarConstant( shaderCompiler_t * c, uint32 id, uint32 * pValue );
+
+static uint32 Compiler_ArrayLength( shaderCompiler_t * c, const uint32 * arrayType ) {
+	uint32 length = 0;
+	if ( Spv_Op( arrayType ) != spvOp_t::TYPE_ARRAY || !Compiler_ScalarConstant( c, arrayType[ 3 ], &length ) ) {
+		Compiler_Fail( c, "unsized array", arrayType[ 1 ] );
+		return 0;
+	}
+	return length;
+}
+
+static uint32 Compiler_RegisterCount( shaderCompiler_t * c, uint32 type ) {
+	const uint32 * inst = Compiler_Instruction( c, type );
+	if ( inst == NULL ) {
+		return 0;
+	}
+	uint64 count = 0;
+	switch ( Spv_Op( inst ) ) {
+		case spvOp_t::TYPE_BOOL:
+			return 1;
+		case spvOp_t::TYPE_INT:
+		case spvOp_t::TYPE_FLOAT:
+			if ( inst[ 2 ] != 32 ) {
+				Compiler_Fail( c, "only 32-bit scalars are supported", inst[ 2 ] );
+			}
+			return 1;
+		case spvOp_t::TYPE_VECTOR:
+		case spvOp_t::TYPE_MATRIX:
+			count = ( uint64 )inst[ 3 ] * Compiler_RegisterCount( c, inst[ 2 ] );
+			break;
+		case spvOp_t::TYPE_ARRAY:
+			count = ( uint64 )Compiler_ArrayLength( c, inst ) * Compiler_RegisterCount( c, inst[ 2 ] );
+			break;
+		case spvOp_t::TYPE_STRUCT:
+			for ( uint32 i = 2; i < Spv_WordCount( inst ); i++ ) {
+				count += Compiler_RegisterCount( c, inst[ i ] );
+			}
+			break;
+		default:
+			Compiler_Fail( c, "unsupported type", ( uint32 )Spv_Op( inst ) );
+			return 0;
+	}
+	if ( count > SHADER_MAX_REGISTERS ) {
+		Compiler_Fail( c, "type too large", type );
+		return 0;
+	}
+	return ( uint32 )count;
+}
+
+//Registers from the start of a composite to element index; *pType becomes the element type
+static uint32 Compiler_ElementOffset( shaderCompiler_t * c, uint32 * pType, uint32 index ) {
+	const uint32 * inst = Compiler_Instruction( c, *pType );
+	if ( inst == NULL ) {
+		return 0;
+	}
+	switch ( Spv_Op( inst ) ) {
+		case spvOp_t::TYPE_STRUCT: {
+			if ( 2 + index >= Spv_WordCount( inst ) ) {
+				Compiler_Fail( c, "member out of range", index );
+				return 0;
+			}
+			uint32 offset = 0;
+			for ( uint32 i = 0; i < index; i++ ) {
+				offset += Compiler_RegisterCount( c, inst[ 2 + i ] );
+			}
+			*pType = inst[ 2 + index ];
+			return offset;
+		}
+		case spvOp_t::TYPE_VECTOR:
+		case spvOp_t::TYPE_MATRIX:
+		case spvOp_t::TYPE_ARRAY:
+			*pType = inst[ 2 ];
+			return index * Compiler_RegisterCount( c, inst[ 2 ] );
+		default:
+			Compiler_Fail( c, "not a composite", *pType );
+			return 0;
+	}
+}
+
+static bool Compiler_IsVoid( shaderCompiler_t * c, uint32 type ) {
+	const uint32 * inst = Compiler_Instruction( c, type );
+	return inst != NULL && Spv_Op( inst ) == spvOp_t::TYPE_VOID;
+}
+
+//Columns and rows of a matrix type
+static void Compiler_MatrixShape( shaderCompiler_t * c, uint32 type, uint32 * pColumns, uint32 * pRows ) {
+	const uint32 * inst = Compiler_Instruction( c, type );
+	*pColumns = 1;
+	*pRows = 1;
+	if ( inst != NULL && Spv_Op( inst ) == spvOp_t::TYPE_MATRIX ) {
+		*pColumns = inst[ 3 ];
+		*pRows = Compiler_RegisterCount( c, inst[ 2 ] );
+	} else if ( inst != NULL && Spv_Op( inst ) == spvOp_t::TYPE_VECTOR ) {
+		*pRows = inst[ 3 ];
+	}
+}
+
+//Packed memory strides the columns of a matrix, or of each matrix in an array of them, by their size
+static uint32 Compiler_PackedMatrixStride( shaderCompiler_t * c, uint32 type ) {
+	const uint32 * inst = Compiler_Instruction( c, type );
+	while ( inst != NULL && Spv_Op( inst ) == spvOp_t::TYPE_ARRAY ) {
+		inst = Compiler_Instruction( c, inst[ 2 ] );
+	}
+	if ( inst == NULL || Spv_Op( inst ) != spvOp_t::TYPE_MATRIX ) {
+		return 0;
+	}
+	return Compiler_RegisterCount( c, inst[ 2 ] ) * ( uint32 )sizeof( uint32 );
+}
+
+/*
+================================================
+Constant evaluation
+
+Specialization constants take their value from VkSpecializationInfo when a map entry names their SpecId;
+OpSpecConstantOp is folded here for the scalar integer and logical operations.
+================================================
+*/
+static uint32 Compiler_SpecializedValue( shaderCompiler_t * c, uint32 id, uint32 defaultValue ) {
+	uint32 specId;
+	const VkSpecializationInfo * info = c->specialization;
+	if ( info == NULL || !Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::SPEC_ID, &specId ) ) {
+		return defaultValue;
+	}
+	for ( uint32 i = 0; i < info->mapEntryCount; i++ ) {
+		const VkSpecializationMapEntry & entry = info->pMapEntries[ i ];
+		if ( entry.constantID == specId && entry.offset + entry.size <= info->dataSize ) {
+			uint32 value = 0;
+			memcpy( &value, reinterpret_cast< const uint8 * >( info->pData ) + entry.offset, Min( entry.size, sizeof( uint32 ) ) );
+			return value;
+		}
+	}
+	return defaultValue;
+}
+
+static bool Compiler_ExtractConstant( shaderCompiler_t * c, uint32 composite, const uint32 * pIndices, uint32 indexCount, uint32 * pValue ) {
+	for ( uint32 i = 0; i < indexCount; i++ ) {
+		const uint32 * inst = Compiler_Instruction( c, composite );
+		if ( inst == NULL ) {
+			return false;
+		}
+		const spvOp_t op = Spv_Op( inst );
+		if ( op == spvOp_t::CONSTANT_NULL ) {
+			*pValue = 0;
+			return true;
+		}
+		if ( ( op != spvOp_t::CONSTANT_COMPOSITE && op != spvOp_t::SPEC_CONSTANT_COMPOSITE ) || 3 + pIndices[ i ] >= Spv_WordCount( inst ) ) {
+			Compiler_Fail( c, "unsupported constant extract", composite );
+			return false;
+		}
+		composite = inst[ 3 + pIndices[ i ] ];
+	}
+	return Compiler_ScalarConstant( c, composite, pValue );
+}
+
+static bool Compiler_EvaluateSpecOp( shaderCompiler_t * c, const uint32 * inst, uint32 * pValue ) {
+	const spvOp_t op = ( spvOp_t )inst[ 3 ];
+	const uint32 length = Spv_WordCount( inst );
+	if ( op == spvOp_t::COMPOSITE_EXTRACT ) {
+		return length > 4 && Compiler_ExtractConstant( c, inst[ 4 ], inst + 5, length - 5, pValue );
+	}
+	uint32 operands[ 3 ] = { 0, 0, 0 };
+	for ( uint32 i = 0; i < 3 && 4 + i < length; i++ ) {
+		if ( !Compiler_ScalarConstant( c, inst[ 4 + i ], &operands[ i ] ) ) {
+			return false;
+		}
+	}
+	const uint32 a = operands[ 0 ];
+	const uint32 b = operands[ 1 ];
+	const int32 sa = ( int32 )a;
+	const int32 sb = ( int32 )b;
+	switch ( op ) {
+		case spvOp_t::U_CONVERT:
+		case spvOp_t::S_CONVERT:
+		case spvOp_t::F_CONVERT:
+		case spvOp_t::BITCAST:					*pValue = a; return true;
+		case spvOp_t::S_NEGATE:					*pValue = 0u - a; return true;
+		case spvOp_t::NOT:						*pValue = ~a; return true;
+		case spvOp_t::I_ADD:					*pValue = a + b; return true;
+		case spvOp_t::I_SUB:					*pValue = a - b; return true;
+		case spvOp_t::I_MUL:					*pValue = a * b; return true;
+		case spvOp_t::U_DIV:					*pValue = b != 0 ? a / b : ~0u; return true;
+		case spvOp_t::S_DIV:					*pValue = ( b != 0 && sb != -1 ) ? ( uint32 )( sa / sb ) : ( sb == -1 ? 0u - a : ~0u ); return true;
+		case spvOp_t::U_MOD:					*pValue = b != 0 ? a % b : 0; return true;
+		case spvOp_t::S_REM:					*pValue = ( b != 0 && sb != -1 ) ? ( uint32 )( sa % sb ) : 0; return true;
+		case spvOp_t::S_MOD: {
+			int32 r = ( b != 0 && sb != -1 ) ? sa % sb : 0;
+			if ( r != 0 && ( r ^ sb ) < 0 ) {
+				r += sb;
+			}
+			*pValue = ( uint32 )r;
+			return true;
+		}
+		case spvOp_t::SHIFT_RIGHT_LOGICAL:		*pValue = a >> ( b & 31 ); return true;
+		case spvOp_t::SHIFT_RIGHT_ARITHMETIC:	*pValue = ( uint32 )( sa >> ( b & 31 ) ); return true;
+		case spvOp_t::SHIFT_LEFT_LOGICAL:		*pValue = a << ( b & 31 ); return true;
+		case spvOp_t::BITWISE_OR:
+		case spvOp_t::LOGICAL_OR:				*pValue = a | b; return true;
+		case spvOp_t::BITWISE_XOR:
+		case spvOp_t::LOGICAL_NOT_EQUAL:		*pValue = a ^ b; return true;
+		case spvOp_t::BITWISE_AND:
+		case spvOp_t::LOGICAL_AND:				*pValue = a & b; return true;
+		case spvOp_t::LOGICAL_NOT:				*pValue = ~a; return true;
+		case spvOp_t::LOGICAL_EQUAL:			*pValue = ~( a ^ b ); return true;
+		case spvOp_t::SELECT:					*pValue = a != 0 ? b : operands[ 2 ]; return true;
+		case spvOp_t::I_EQUAL:					*pValue = a == b ? ~0u : 0; return true;
+		case spvOp_t::I_NOT_EQUAL:				*pValue = a != b ? ~0u : 0; return true;
+		case spvOp_t::U_LESS_THAN:				*pValue = a < b ? ~0u : 0; return true;
+		case spvOp_t::U_LESS_THAN_EQUAL:		*pValue = a <= b ? ~0u : 0; return true;
+		case spvOp_t::U_GREATER_THAN:			*pValue = a > b ? ~0u : 0; return true;
+		case spvOp_t::U_GREATER_THAN_EQUAL:		*pValue = a >= b ? ~0u : 0; return true;
+		case spvOp_t::S_LESS_THAN:				*pValue = sa < sb ? ~0u : 0; return true;
+		case spvOp_t::S_LESS_THAN_EQUAL:		*pValue = sa <= sb ? ~0u : 0; return true;
+		case spvOp_t::S_GREATER_THAN:			*pValue = sa > sb ? ~0u : 0; return true;
+		case spvOp_t::S_GREATER_THAN_EQUAL:		*pValue = sa >= sb ? ~0u : 0; return true;
+		default:
+			Compiler_Fail( c, "unsupported specialization constant op", ( uint32 )op );
+			return false;
+	}
+}
+
+//Booleans are all ones or zero, the same as comparison results
+static bool Compiler_ScalarConstant( shaderCompiler_t * c, uint32 id, uint32 * pValue ) {
+	const uint32 * inst = Compiler_Instruction( c, id );
+	if ( inst == NULL ) {
+		return false;
+	}
+	switch ( Spv_Op( inst ) ) {
+		case spvOp_t::CONSTANT:
+			if ( Compiler_RegisterCount( c, inst[ 1 ] ) != 1 ) {
+				return false;
+			}
+			*pValue = inst[ 3 ];
+			return true;
+		case spvOp_t::CONSTANT_TRUE:
+			*pValue = ~0u;
+			return true;
+		case spvOp_t::CONSTANT_FALSE:
+		case spvOp_t::CONSTANT_NULL:
+		case spvOp_t::UNDEF:
+			*pValue = 0;
+			return true;
+		case spvOp_t::SPEC_CONSTANT_TRUE:
+			*pValue = Compiler_SpecializedValue( c, id, 1 ) != 0 ? ~0u : 0;
+			return true;
+		case spvOp_t::SPEC_CONSTANT_FALSE:
+			*pValue = Compiler_SpecializedValue( c, id, 0 ) != 0 ? ~0u : 0;
+			return true;
+		case spvOp_t::SPEC_CONSTANT:
+			if ( Compiler_RegisterCount( c, inst[ 1 ] ) != 1 ) {
+				return false;
+			}
+			*pValue = Compiler_SpecializedValue( c, id, inst[ 3 ] );
+			return true;
+		case spvOp_t::SPEC_CONSTANT_OP:
+			return Compiler_EvaluateSpecOp( c, inst, pValue );
+		default:
+			Compiler_Fail( c, "not a scalar constant", id );
+			return false;
+	}
+}
+
+//Appends the flattened words of a constant to the constant region, in register order
+static void Compiler_PushConstantWords( shaderCompiler_t * c, uint32 id ) {
+	const uint32 * inst = Compiler_Instruction( c, id );
+	if ( inst == NULL ) {
+		return;
+	}
+	switch ( Spv_Op( inst ) ) {
+		case spvOp_t::CONSTANT_COMPOSITE:
+		case spvOp_t::SPEC_CONSTANT_COMPOSITE:
+			for ( uint32 i = 3; i < Spv_WordCount( inst ) && !c->failed; i++ ) {
+				Compiler_PushConstantWords( c, inst[ i ] );
+			}
+			break;
+		case spvOp_t::CONSTANT_NULL:
+		case spvOp_t::UNDEF: {
+			const uint32 count = Compiler_RegisterCount( c, inst[ 1 ] );
+			for ( uint32 i = 0; i < count && !c->failed; i++ ) {
+				*Compiler_Push( c, &c->constants ) = 0;
+			}
+			break;
+		}
+		default: {
+			uint32 value = 0;
+			Compiler_ScalarConstant( c, id, &value );
+			*Compiler_Push( c, &c->constants ) = value;
+			break;
+		}
+	}
+}
+
+/*
+================================================
+Values
+================================================
+*/
+static void Compiler_Define( shaderCompiler_t * c, uint32 id, uint32 type, uint32 reg, uint32 count ) {
+	if ( id == 0 || id >= c->module->bound ) {
+		Compiler_Fail( c, "id out of range", id );
+		return;
+	}
+	shaderValue_t * value = &c->pValues[ id ];
+	memset( value, 0, sizeof( shaderValue_t ) );
+	value->kind = shaderValueKind_t::REGISTERS;
+	value->type = type;
+	value->reg = reg;
+	value->count = count;
+}
+
+static shaderValue_t * Compiler_Value( shaderCompiler_t * c, uint32 id ) {
+	if ( id == 0 || id >= c->module->bound ) {
+		Compiler_Fail( c, "id out of range", id );
+		return &c->nullValue;
+	}
+	shaderValue_t * value = &c->pValues[ id ];
+	if ( value->kind != shaderValueKind_t::NONE ) {
+		return value;
+	}
+	//Constants and undefined values become constant registers on first use
+	const uint32 * inst = Compiler_Instruction( c, id );
+	if ( inst == NULL ) {
+		return &c->nullValue;
+	}
+	switch ( Spv_Op( inst ) ) {
+		case spvOp_t::CONSTANT_TRUE:
+		case spvOp_t::CONSTANT_FALSE:
+		case spvOp_t::CONSTANT:
+		case spvOp_t::CONSTANT_COMPOSITE:
+		case spvOp_t::CONSTANT_NULL:
+		case spvOp_t::SPEC_CONSTANT_TRUE:
+		case spvOp_t::SPEC_CONSTANT_FALSE:
+		case spvOp_t::SPEC_CONSTANT:
+		case spvOp_t::SPEC_CONSTANT_COMPOSITE:
+		case spvOp_t::SPEC_CONSTANT_OP:
+		case spvOp_t::UNDEF: {
+			const uint32 count = Compiler_RegisterCount( c, inst[ 1 ] );
+			if ( count == 1 ) {
+				uint32 word = 0;
+				Compiler_ScalarConstant( c, id, &word );
+				Compiler_Define( c, id, inst[ 1 ], Compiler_Constant( c, word ), 1 );
+			} else {
+				const uint32 first = c->constants.count;
+				Compiler_PushConstantWords( c, id );
+				if ( !c->failed && c->constants.count - first != count ) {
+					Compiler_Fail( c, "constant does not match its type", id );
+				}
+				Compiler_Define( c, id, inst[ 1 ], SHADER_CONSTANT_TAG | first, count );
+			}
+			return value;
+		}
+		default:
+			Compiler_Fail( c, "value used before its definition", id );
+			return &c->nullValue;
+	}
+}
+
+static const shaderValue_t * Compiler_Operand( shaderCompiler_t * c, uint32 id ) {
+	const shaderValue_t * value = Compiler_Value( c, id );
+	if ( value->kind != shaderValueKind_t::REGISTERS ) {
+		Compiler_Fail( c, "operand is not a value", id );
+		return &c->nullValue;
+	}
+	return value;
+}
+
+//Register i of an operand, with scalars standing in for every component
+static uint32 Compiler_Component( const shaderValue_t * value, uint32 i ) {
+	return value->reg + ( value->count > 1 ? i : 0 );
+}
+
+/*
+================================================
+Interface and resource variables
+================================================
+*/
+static void Compiler_AddInterface( shaderCompiler_t * c, bool output, uint32 builtIn, uint32 location, uint32 component, uint32 reg, bool flat, bool noPerspective ) {
+	shaderInterface_t * entry = Compiler_Push( c, output ? &c->outputs : &c->inputs );
+	entry->builtIn = builtIn;
+	entry->location = location;
+	entry->component = component;
+	entry->reg = reg;
+	entry->flat = flat;
+	entry->noPerspective = noPerspective;
+}
+
+static void Compiler_AddBuiltIn( shaderCompiler_t * c, bool output, uint32 builtIn, uint32 type, uint32 reg ) {
+	const uint32 count = Compiler_RegisterCount( c, type );
+	for ( uint32 i = 0; i < count; i++ ) {
+		Compiler_AddInterface( c, output, builtIn, 0, i, reg + i, true, false );
+	}
+}
+
+//Returns the number of locations the type consumes
+static uint32 Compiler_AddLocations( shaderCompiler_t * c, bool output, uint32 type, uint32 reg, uint32 location, uint32 component, bool flat, bool noPerspective ) {
+	const uint32 * inst = Compiler_Instruction( c, type );
+	if ( inst == NULL ) {
+		return 0;
+	}
+	switch ( Spv_Op( inst ) ) {
+		case spvOp_t::TYPE_BOOL:
+		case spvOp_t::TYPE_INT:
+		case spvOp_t::TYPE_FLOAT:
+			Compiler_AddInterface( c, output, SHADER_NO_BUILTIN, location, component, reg, flat, noPerspective );
+			return 1;
+		case spvOp_t::TYPE_VECTOR:
+			for ( uint32 i = 0; i < inst[ 3 ]; i++ ) {
+				Compiler_AddInterface( c, output, SHADER_NO_BUILTIN, location, component + i, reg + i, flat, noPerspective );
+			}
+			return 1;
+		case spvOp_t::TYPE_MATRIX:
+		case spvOp_t::TYPE_ARRAY: {
+			const uint32 elementCount = Spv_Op( inst ) == spvOp_t::TYPE_MATRIX ? inst[ 3 ] : Compiler_ArrayLength( c, inst );
+			const uint32 elementRegisters = Compiler_RegisterCount( c, inst[ 2 ] );
+			uint32 used = 0;
+			for ( uint32 e = 0; e < elementCount && !c->failed; e++ ) {
+				used += Compiler_AddLocations( c, output, inst[ 2 ], reg + e * elementRegisters, location + used, component, flat, noPerspective );
+			}
+			return used;
+		}
+		case spvOp_t::TYPE_STRUCT: {
+			uint32 used = 0;
+			for ( uint32 m = 0; m + 2 < Spv_WordCount( inst ) && !c->failed; m++ ) {
+				uint32 memberType = type;
+				const uint32 memberReg = reg + Compiler_ElementOffset( c, &memberType, m );
+				used += Compiler_AddLocations( c, output, memberType, memberReg, location + used, 0, flat, noPerspective );
+			}
+			return used;
+		}
+		default:
+			Compiler_Fail( c, "unsupported interface type", type );
+			return 0;
+	}
+}
+
+//Built-ins that follow from the lane alone are computed in the shader rather than filled in by the pipeline
+static bool Compiler_SubgroupBuiltIn( shaderCompiler_t * c, uint32 builtIn, uint32 type, uint32 reg ) {
+	switch ( ( spvBuiltIn_t )builtIn ) {
+		case spvBuiltIn_t::SUBGROUP_SIZE:
+		case spvBuiltIn_t::SUBGROUP_LOCAL_INVOCATION_ID:
+		case spvBuiltIn_t::SUBGROUP_EQ_MASK:
+		case spvBuiltIn_t::SUBGROUP_GE_MASK:
+		case spvBuiltIn_t::SUBGROUP_GT_MASK:
+		case spvBuiltIn_t::SUBGROUP_LE_MASK:
+		case spvBuiltIn_t::SUBGROUP_LT_MASK:
+			break;
+		default:
+			return false;
+	}
+	//Masks are uvec4s, of which only x can have bits set
+	const uint32 count = Compiler_RegisterCount( c, type );
+	Compiler_Emit( c, shaderOp_t::SUBGROUP_BUILTIN, reg, builtIn );
+	for ( uint32 i = 1; i < count; i++ ) {
+		Compiler_Emit( c, shaderOp_t::MOV, reg + i, Compiler_Constant( c, 0 ) );
+	}
+	return true;
+}
+
+static void Compiler_DeclareInterface( shaderCompiler_t * c, uint32 id, uint32 type, uint32 reg, bool output ) {
+	const bool flat = Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::FLAT, NULL );
+	const bool noPerspective = Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::NO_PERSPECTIVE, NULL );
+	uint32 builtIn;
+	uint32 location;
+	if ( Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::BUILT_IN, &builtIn ) ) {
+		if ( !output && Compiler_SubgroupBuiltIn( c, builtIn, type, reg ) ) {
+			return;
+		}
+		Compiler_AddBuiltIn( c, output, builtIn, type, reg );
+		return;
+	}
+	if ( Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::LOCATION, &location ) ) {
+		uint32 component = 0;
+		Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::COMPONENT, &component );
+		Compiler_AddLocations( c, output, type, reg, location, component, flat, noPerspective );
+		return;
+	}
+	//Blocks decorate their members instead, as gl_PerVertex does
+	const uint32 * inst = Compiler_Instruction( c, type );
+	if ( inst == NULL || Spv_Op( inst ) != spvOp_t::TYPE_STRUCT ) {
+		return;
+	}
+	for ( uint32 m = 0; m + 2 < Spv_WordCount( inst ) && !c->failed; m++ ) {
+		uint32 memberType = type;
+		const uint32 memberReg = reg + Compiler_ElementOffset( c, &memberType, m );
+		if ( Compiler_Decoration( c, type, m, spvDecoration_t::BUILT_IN, &builtIn ) ) {
+			Compiler_AddBuiltIn( c, output, builtIn, memberType, memberReg );
+		} else if ( Compiler_Decoration( c, type, m, spvDecoration_t::LOCATION, &location ) ) {
+			uint32 component = 0;
+			Compiler_Decoration( c, type, m, spvDecoration_t::COMPONENT, &component );
+			const bool memberFlat = flat || Compiler_Decoration( c, type, m, spvDecoration_t::FLAT, NULL );
+			const bool memberNoPerspective = noPerspective || Compiler_Decoration( c, type, m, spvDecoration_t::NO_PERSPECTIVE, NULL );
+			Compiler_AddLocations( c, output, memberType, memberReg, location, component, memberFlat, memberNoPerspective );
+		}
+	}
+}
+
+static bool Compiler_InEntryInterface( shaderCompiler_t * c, uint32 id ) {
+	const uint32 * pInterface = c->module->pWords + c->entryPoint->interfaceOffset;
+	for ( uint32 i = 0; i < c->entryPoint->interfaceCount; i++ ) {
+		if ( pInterface[ i ] == id ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static uint32 Compiler_AddBinding( shaderCompiler_t * c, uint32 id, shaderBindingKind_t kind, uint32 arraySize ) {
+	const uint32 slot = c->bindings.count;
+	shaderBinding_t * binding = Compiler_Push( c, &c->bindings );
+	Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::DESCRIPTOR_SET, &binding->set );
+	Compiler_Decoration( c, id, SHADER_NO_MEMBER, spvDecoration_t::BINDING, &binding->binding );
+	binding->kind = kind;
+	binding->arraySize = arraySize;
+	return slot;
+}
+
+static void Compiler_DeclareVariable( shaderCompiler_t * c, uint32 id, const uint32 * inst ) {
+	const uint32 * pointerType = Compiler_Instruction( c, inst[ 1 ] );
+	if ( pointerType == NULL ) {
+		return;
+	}
+	const uint32 type = pointerType[ 3 ];
+	const spvStorageClass_t storage = ( spvStorageClass_t )inst[ 3 ];
+	shaderValue_t * value = &c->pValues[ id ];
+	memset( value, 0, sizeof( shaderValue_t ) );
+	value->type = type;
+	value->indexRegister = SHADER_NO_REGISTER;
+	value->elementRegister = SHADER_NO_REGISTER;
+	value->samplerSlot = SHADER_NO_REGISTER;
+	value->samplerElementRegister = SHADER_NO_REGISTER;
+	value->componentStride = sizeof( uint32 );
+	switch ( storage ) {
+		case spvStorageClass_t::INPUT:
+		case spvStorageClass_t::OUTPUT:
+		case spvStorageClass_t::PRIVATE:
+		case spvStorageClass_t::FUNCTION: {
+			value->kind = shaderValueKind_t::REGISTER_POINTER;
+			value->count = Compiler_RegisterCount( c, type );
+			value->reg = Compiler_Allocate( c, value->count );
+			if ( Spv_WordCount( inst ) > 4 ) {
+				const shaderValue_t * initializer = Compiler_Operand( c, inst[ 4 ] );
+				for ( uint32 i = 0; i < value->count && i < initializer->count; i++ ) {
+					Compiler_EmitMasked( c, shaderOp_t::MOV, value->reg + i, initializer->reg + i );
+				}
+			}
+			if ( storage != spvStorageClass_t::PRIVATE && storage != spvStorageClass_t::FUNCTION && Compiler_InEntryInterface( c, id ) ) {
+				Compiler_DeclareInterface( c, id, type, value->reg, storage == spvStorageClass_t::OUTPUT );
+			}
+			break;
+		}
+		case spvStorageClass_t::UNIFORM:
+		case spvStorageClass_t::STORAGE_BUFFER:
+		case spvStorageClass_t::PUSH_CONSTANT: {
+			value->kind = shaderValueKind_t::BUFFER_POINTER;
+			uint32 block = type;
+			uint32 arraySize = 1;
+			const uint32 * typeInst = Compiler_Instruction( c, type );
+			if ( typeInst != NULL && Spv_Op( typeInst ) == spvOp_t::TYPE_ARRAY ) {
+				arraySize = Compiler_ArrayLength( c, typeInst );
+				block = typeInst[ 2 ];
+				value->descriptorArray = true;
+			} else if ( typeInst != NULL && Spv_Op( typeInst ) != spvOp_t::TYPE_STRUCT ) {
+				Compiler_Fail( c, "unsupported buffer variable", id );
+				return;
+			}
+			if ( storage == spvStorageClass_t::PUSH_CONSTANT ) {
+				value->slot = SHADER_PUSH_CONSTANT_SLOT;
+			} else {
+				const bool storageBuffer = storage == spvStorageClass_t::STORAGE_BUFFER || Compiler_Decoration( c, block, SHADER_NO_MEMBER, spvDecoration_t::BUFFER_BLOCK, NULL );
+				value->slot = Compiler_AddBinding( c, id, storageBuffer ? shaderBindingKind_t::STORAGE_BUFFER : shaderBindingKind_t::UNIFORM_BUFFER, arraySize );
+			}
+			break;
+		}
+		case spvStorageClass_t::WORKGROUP: {
+			//Each variable takes the next bytes of the workgroup's memory
+			const uint64 end = ( uint64 )c->workgroupMemorySize + ( uint64 )Compiler_RegisterCount( c, type ) * sizeof( uint32 );
+			if ( Spv_WordCount( inst ) > 4 ) {
+				Compiler_Fail( c, "initialized workgroup variable", id );
+				return;
+			}
+			if ( end > SHADER_MAX_WORKGROUP_MEMORY ) {
+				Compiler_Fail( c, "workgroup memory exhausted", ( uint32 )end );
+				return;
+			}
+			value->kind = shaderValueKind_t::BUFFER_POINTER;
+			value->slot = SHADER_WORKGROUP_SLOT;
+			value->offset = c->workgroupMemorySize;
+			value->packed = true;
+			value->matrixStride = Compiler_PackedMatrixStride( c, type );
+			c->workgroupMemorySize = ( uint32 )end;
+			break;
+		}
+		case spvStorageClass_t::UNIFORM_CONSTANT: {
+			value->kind = shaderValueKind_t::IMAGE_POINTER;
+			uint32 arraySize = 1;
+			const uint32 * typeInst = Compiler_Instruction( c, type );
+			if ( typeInst != NULL && Spv_Op( typeInst ) == spvOp_t::TYPE_ARRAY ) {
+				arraySize = Compiler_ArrayLength( c, typeInst );
+				typeInst = Compiler_Instruction( c, typeInst[ 2 ] );
+				value->descriptorArray = true;
+			}
+			if ( typeInst == NULL ) {
+				return;
+			}
+			shaderBindingKind_t kind;
+			switch ( Spv_Op( typeInst ) ) {
+				case spvOp_t::TYPE_IMAGE:
+					kind = typeInst[ 7 ] == 2 ? shaderBindingKind_t::STORAGE_IMAGE : shaderBindingKind_t::SAMPLED_IMAGE;
+					break;
+				case spvOp_t::TYPE_SAMPLER:
+					kind = shaderBindingKind_t::SAMPLER;
+					break;
+				case spvOp_t::TYPE_SAMPLED_IMAGE:
+					kind = shaderBindingKind_t::COMBINED_IMAGE_SAMPLER;
+					break;
+				default:
+					Compiler_Fail( c, "unsupported uniform constant", id );
+					return;
+			}
+			value->slot = Compiler_AddBinding( c, id, kind, arraySize );
+			break;
+		}
+		default:
+			Compiler_Fail( c, "unsupported storage class", ( uint32 )storage );
+			break;
+	}
+}
+
+/*
+================================================
+Access chains
+================================================
+*/
+
+//*pRegister += index * scale, starting from nothing when *pRegister is SHADER_NO_REGISTER
+static void Compiler_AddScaled( shaderCompiler_t * c, uint32 * pRegister, uint32 index, uint32 scale ) {
+	const uint32 scaled = ( scale == 1 ) ? index : Compiler_Op( c, shaderOp_t::IMUL, index, Compiler_Constant( c, scale ) );
+	*pRegister = ( *pRegister == SHADER_NO_REGISTER ) ? scaled : Compiler_Op( c, shaderOp_t::IADD, *pRegister, scaled );
+}
+
+static uint32 Compiler_ArrayStride( shaderCompiler_t * c, uint32 type, bool packed ) {
+	uint32 stride = 0;
+	if ( packed ) {
+		const uint32 * inst = Compiler_Instruction( c, type );
+		return ( inst != NULL ) ? Compiler_RegisterCount( c, inst[ 2 ] ) * ( uint32 )sizeof( uint32 ) : 0;
+	}
+	if ( !Compiler_Decoration( c, type, SHADER_NO_MEMBER, spvDecoration_t::ARRAY_STRIDE, &stride ) ) {
+		Compiler_Fail( c, "buffer array without ArrayStride", type );
+	}
+	return stride;
+}
+
+static uint32 Compiler_MemberOffset( shaderCompiler_t * c, uint32 type, uint32 member, bool packed, shaderValue_t * pointer ) {
+	uint32 offset = 0;
+	if ( packed ) {
+		uint32 memberType = type;
+		offset = Compiler_ElementOffset( c, &memberType, member ) * ( uint32 )sizeof( uint32 );
+		pointer->matrixStride = Compiler_PackedMatrixStride( c, memberType );
+		pointer->rowMajor = false;
+		return offset;
+	}
+	if ( !Compiler_Decoration( c, type, member, spvDecoration_t::OFFSET, &offset ) ) {
+		Compiler_Fail( c, "buffer member without Offset", type );
+	}
+	uint32 matrixStride;
+	if ( Compiler_Decoration( c, type, member, spvDecoration_t::MATRIX_STRIDE, &matrixStride ) ) {
+		pointer->matrixStride = matrixStride;
+		pointer->rowMajor = Compiler_Decoration( c, type, member, spvDecoration_t::ROW_MAJOR, NULL );
+	}
+	return offset;
+}
+
+static void Compiler_AccessChain( shaderCompiler_t * c, const uint32 * inst ) {
+	shaderValue_t pointer = *Compiler_Value( c, inst[ 3 ] );
+	uint32 type = pointer.type;
+	for ( uint32 k = 4; k < Spv_WordCount( inst ) && !c->failed; k++ ) {
+		const uint32 index = Compiler_Operand( c, inst[ k ] )->reg;
+		const bool constant = Compiler_IsConstant( index );
+		const uint32 constantIndex = constant ? Compiler_ConstantValue( c, index ) : 0;
+		const uint32 * typeInst = Compiler_Instruction( c, type );
+		if ( typeInst == NULL ) {
+			return;
+		}
+		const spvOp_t typeOp = Spv_Op( typeInst );
+		if ( typeOp == spvOp_t::TYPE_STRUCT && !constant ) {
+			Compiler_Fail( c, "dynamic struct member", inst[ 2 ] );
+			return;
+		}
+		if ( pointer.descriptorArray ) {
+			if ( constant ) {
+				pointer.element += constantIndex;
+			} else {
+				pointer.elementRegister = index;
+			}
+			pointer.descriptorArray = false;
+			type = typeInst[ 2 ];
+			continue;
+		}
+		switch ( pointer.kind ) {
+			case shaderValueKind_t::REGISTER_POINTER: {
+				if ( typeOp == spvOp_t::TYPE_STRUCT ) {
+					pointer.offset += Compiler_ElementOffset( c, &type, constantIndex );
+					break;
+				}
+				const uint32 elementRegisters = Compiler_RegisterCount( c, typeInst[ 2 ] );
+				type = typeInst[ 2 ];
+				if ( constant ) {
+					pointer.offset += constantIndex * elementRegisters;
+				} else {
+					Compiler_AddScaled( c, &pointer.indexRegister, index, elementRegisters );
+				}
+				break;
+			}
+			case shaderValueKind_t::BUFFER_POINTER: {
+				uint32 stride;
+				switch ( typeOp ) {
+					case spvOp_t::TYPE_STRUCT:
+						pointer.offset += Compiler_MemberOffset( c, type, constantIndex, pointer.packed, &pointer );
+						pointer.componentStride = sizeof( uint32 );
+						type = typeInst[ 2 + constantIndex ];
+						continue;
+					case spvOp_t::TYPE_ARRAY:
+					case spvOp_t::TYPE_RUNTIME_ARRAY:
+						stride = Compiler_ArrayStride( c, type, pointer.packed );
+						break;
+					case spvOp_t::TYPE_MATRIX:
+						//A column of a row-major matrix is strided by the matrix stride
+						stride = pointer.rowMajor ? sizeof( uint32 ) : pointer.matrixStride;
+						pointer.componentStride = pointer.rowMajor ? pointer.matrixStride : sizeof( uint32 );
+						break;
+					case spvOp_t::TYPE_VECTOR:
+						stride = pointer.componentStride;
+						break;
+					default:
+						Compiler_Fail( c, "access chain into a scalar", inst[ 2 ] );
+						return;
+				}
+				type = typeInst[ 2 ];
+				if ( constant ) {
+					pointer.offset += constantIndex * stride;
+				} else {
+					Compiler_AddScaled( c, &pointer.indexRegister, index, stride );
+				}
+				break;
+			}
+			default:
+				Compiler_Fail( c, "unsupported access chain base", inst[ 3 ] );
+				return;
+		}
+	}
+	pointer.type = type;
+	c->pValues[ inst[ 2 ] ] = pointer;
+}
+
+/*
+================================================
+Buffer memory
+
+Loads and stores are split into one access per 32-bit leaf, following Offset, ArrayStride,
+MatrixStride and RowMajor.  Workgroup variables carry none of those and are packed, one word after
+another in the order of their registers.
+================================================
+*/
+static void Compiler_BufferLeaves( shaderCompiler_t * c, const shaderValue_t * pointer, uint32 type, uint32 offset, uint32 componentStride, uint32 matrixStride, bool rowMajor, bool store, uint32 reg, uint32 * pLeaf ) {
+	const uint32 * inst = Compiler_Instruction( c, type );
+	if ( inst == NULL || c->failed ) {
+		return;
+	}
+	switch ( Spv_Op( inst ) ) {
+		case spvOp_t::TYPE_BOOL:				//only workgroup memory holds booleans, as the register words they are
+		case spvOp_t::TYPE_INT:
+		case spvOp_t::TYPE_FLOAT: {
+			const uint32 accessIndex = c->bufferAccesses.count;
+			shaderBufferAccess_t * access = Compiler_Push( c, &c->bufferAccesses );
+			access->slot = pointer->slot;
+			access->element = pointer->element;
+			access->elementRegister = pointer->elementRegister;
+			access->offset = pointer->offset + offset;
+			access->offsetRegister = pointer->indexRegister;
+			if ( store ) {
+				Compiler_Emit( c, shaderOp_t::STORE_BUFFER, SHADER_NO_REGISTER, accessIndex, reg + *pLeaf );
+			} else {
+				Compiler_Emit( c, shaderOp_t::LOAD_BUFFER, reg + *pLeaf, accessIndex );
+			}
+			( *pLeaf )++;
+			break;
+		}
+		case spvOp_t::TYPE_VECTOR:
+			for ( uint32 i = 0; i < inst[ 3 ]; i++ ) {
+				Compiler_BufferLeaves( c, pointer, inst[ 2 ], offset + i * componentStride, sizeof( uint32 ), matrixStride, rowMajor, store, reg, pLeaf );
+			}
+			break;
+		case spvOp_t::TYPE_MATRIX:
+			for ( uint32 i = 0; i < inst[ 3 ]; i++ ) {
+				const uint32 columnOffset = rowMajor ? i * ( uint32 )sizeof( uint32 ) : i * matrixStride;
+				Compiler_BufferLeaves( c, pointer, inst[ 2 ], offset + columnOffset, rowMajor ? matrixStride : ( uint32 )sizeof( uint32 ), matrixStride, rowMajor, store, reg, pLeaf );
+			}
+			break;
+		case spvOp_t::TYPE_ARRAY: {
+			const uint32 length = Compiler_ArrayLength( c, inst );
+			const uint32 stride = Compiler_ArrayStride( c, type, pointer->packed );
+			for ( uint32 i = 0; i < length && !c->failed; i++ ) {
+				Compiler_BufferLeaves( c, pointer, inst[ 2 ], offset + i * stride, sizeof( uint32 ), matrixStride, rowMajor, store, reg, pLeaf );
+			}
+			break;
+		}
+		case spvOp_t::TYPE_STRUCT:
+			for ( uint32 m = 0; m + 2 < Spv_WordCount( inst ) && !c->failed; m++ ) {
+				shaderValue_t layout;
+				layout.matrixStride = matrixStride;
+				layout.rowMajor = rowMajor;
+				const uint32 memberOffset = Compiler_MemberOffset( c, type, m, pointer->packed, &layout );
+				Compiler_BufferLeaves( c, pointer, inst[ 2 + m ], offset + memberOffset, sizeof( uint32 ), layout.matrixStride, layout.rowMajor, store, reg, pLeaf );
+			}
+			break;
+		default:
+			Compiler_Fail( c, "unsupported buffer type", type );
+			break;
+	}
+}
+
+//Reads the pointee of pointerId into *pResult as a value of the given type
+static void Compiler_LoadValue( shaderCompiler_t * c, uint32 type, uint32 pointerId, shaderValue_t * pResult ) {
+	const shaderValue_t * pointer = Compiler_Value( c, pointerId );
+	switch ( pointer->kind ) {
+		case shaderValueKind_t::REGISTER_POINTER:
+		case shaderValueKind_t::BUFFER_POINTER: {
+			const uint32 count = Compiler_RegisterCount( c, type );
+			const uint32 dst = Compiler_Allocate( c, count );
+			if ( pointer->kind == shaderValueKind_t::BUFFER_POINTER ) {
+				uint32 leaf = 0;
+				Compiler_BufferLeaves( c, pointer, type, 0, pointer->componentStride, pointer->matrixStride, pointer->rowMajor, false, dst, &leaf );
+			} else {
+				for ( uint32 j = 0; j < count; j++ ) {
+					const uint32 src = pointer->reg + pointer->offset + j;
+					if ( pointer->indexRegister == SHADER_NO_REGISTER ) {
+						Compiler_Emit( c, shaderOp_t::MOV, dst + j, src );
+					} else {
+						Compiler_Emit( c, shaderOp_t::LOAD_INDEXED, dst + j, src, pointer->indexRegister, pointer->count - pointer->offset - j - 1 );
+					}
+				}
+			}
+			memset( pResult, 0, sizeof( shaderValue_t ) );
+			pResult->kind = shaderValueKind_t::REGISTERS;
+			pResult->type = type;
+			pResult->reg = dst;
+			pResult->count = count;
+			break;
+		}
+		case shaderValueKind_t::IMAGE_POINTER: {
+			*pResult = *pointer;
+			pResult->kind = shaderValueKind_t::IMAGE;
+			pResult->type = type;
+			const shaderBindingKind_t kind = c->bindings.pData[ pointer->slot ].kind;
+			if ( kind == shaderBindingKind_t::SAMPLER || kind == shaderBindingKind_t::COMBINED_IMAGE_SAMPLER ) {
+				pResult->samplerSlot = pointer->slot;
+				pResult->samplerElement = pointer->element;
+				pResult->samplerElementRegister = pointer->elementRegister;
+			}
+			break;
+		}
+		default:
+			Compiler_Fail( c, "load through a non-pointer", pointerId );
+			*pResult = c->nullValue;
+			break;
+	}
+}
+
+static void Compiler_Load( shaderCompiler_t * c, const uint32 * inst ) {
+	if ( inst[ 2 ] == 0 || inst[ 2 ] >= c->module->bound ) {
+		Compiler_Fail( c, "id out of range", inst[ 2 ] );
+		return;
+	}
+	Compiler_LoadValue( c, inst[ 1 ], inst[ 3 ], &c->pValues[ inst[ 2 ] ] );
+}
+
+static void Compiler_Store( shaderCompiler_t * c, uint32 pointerId, const shaderValue_t * source ) {
+	const shaderValue_t * pointer = Compiler_Value( c, pointerId );
+	switch ( pointer->kind ) {
+		case shaderValueKind_t::REGISTER_POINTER:
+			for ( uint32 j = 0; j < source->count; j++ ) {
+				const uint32 dst = pointer->reg + pointer->offset + j;
+				if ( pointer->indexRegister == SHADER_NO_REGISTER ) {
+					Compiler_EmitMasked( c, shaderOp_t::MOV, dst, source->reg + j );
+				} else {
+					Compiler_EmitMasked( c, shaderOp_t::STORE_INDEXED, dst, source->reg + j, pointer->indexRegister, pointer->count - pointer->offset - j - 1 );
+				}
+			}
+			break;
+		case shaderValueKind_t::BUFFER_POINTER: {
+			const bool workgroup = pointer->slot == SHADER_WORKGROUP_SLOT;
+			if ( !workgroup && ( pointer->slot == SHADER_PUSH_CONSTANT_SLOT || c->bindings.pData[ pointer->slot ].kind != shaderBindingKind_t::STORAGE_BUFFER ) ) {
+				Compiler_Fail( c, "store to read-only memory", pointerId );
+				return;
+			}
+			uint32 leaf = 0;
+			Compiler_BufferLeaves( c, pointer, pointer->type, 0, pointer->componentStride, pointer->matrixStride, pointer->rowMajor, true, source->reg, &leaf );
+			c->flags |= workgroup ? 0 : SHADER_PROGRAM_WRITES_BUFFERS;
+			break;
+		}
+		default:
+			Compiler_Fail( c, "store through a non-pointer", pointerId );
+			break;
+	}
+}
+
+/*
+================================================
+Arithmetic
+
+Vector and matrix operations are scalarized here; the IR only knows single components.
+================================================
+*/
+static void Compiler_Elementwise( shaderCompiler_t * c, const uint32 * inst, uint32 firstOperand, shaderOp_t op, uint32 operandCount, bool swap ) {
+	const uint32 type = inst[ 1 ];
+	const uint32 count = Compiler_RegisterCount( c, type );
+	const shaderValue_t * operands[ 3 ] = { &c->nullValue, &c->nullValue, &c->nullValue };
+	for ( uint32 k = 0; k < operandCount; k++ ) {
+		operands[ k ] = Compiler_Operand( c, inst[ firstOperand + k ] );
+	}
+	if ( swap ) {
+		const shaderValue_t * first = operands[ 0 ];
+		operands[ 0 ] = operands[ 1 ];
+		operands[ 1 ] = first;
+	}
+	const uint32 dst = Compiler_Allocate( c, count );
+	for ( uint32 i = 0; i < count; i++ ) {
+		uint32 src[ 3 ] = { SHADER_NO_REGISTER, SHADER_NO_REGISTER, SHADER_NO_REGISTER };
+		for ( uint32 k = 0; k < operandCount; k++ ) {
+			src[ k ] = Compiler_Component( operands[ k ], i );
+		}
+		Compiler_Emit( c, op, dst + i, src[ 0 ], src[ 1 ], src[ 2 ] );
+	}
+	Compiler_Define( c, inst[ 2 ], type, dst, count );
+}
+
+//Sum of a[ i * aStride ] * b[ i * bStride ]
+static uint32 Compiler_Dot( shaderCompiler_t * c, uint32 a, uint32 aStride, uint32 b, uint32 bStride, uint32 count ) {
+	uint32 sum = Compiler_Op( c, shaderOp_t::FMUL, a, b );
+	for ( uint32 i = 1; i < count; i++ ) {
+		sum = Compiler_Op( c, shaderOp_t::FADD, sum, Compiler_Op( c, shaderOp_t::FMUL, a + i * aStride, b + i * bStride ) );
+	}
+	return sum;
+}
+
+static uint32 Compiler_Determinant( shaderCompiler_t * c, const uint32 * pElements, uint32 n ) {
+	if ( n == 1 ) {
+		return pElements[ 0 ];
+	}
+	if ( n == 2 ) {
+		return Compiler_Op( c, shaderOp_t::FSUB, Compiler_Op( c, shaderOp_t::FMUL, pElements[ 0 ], pElements[ 3 ] ), Compiler_Op( c, shaderOp_t::FMUL, pElements[ 2 ], pElements[ 1 ] ) );
+	}
+	//Cofactor expansion down the first column; elements are column-major
+	uint32 result = SHADER_NO_REGISTER;
+	for ( uint32 r = 0; r < n; r++ ) {
+		uint32 minor[ 9 ];
+		uint32 m = 0;
+		for ( uint32 col = 1; col < n; col++ ) {
+			for ( uint32 row = 0; row < n; row++ ) {
+				if ( row != r ) {
+					minor[ m++ ] = pElements[ col * n + row ];
+				}
+			}
+		}
+		const uint32 term = Compiler_Op( c, shaderOp_t::FMUL, pElements[ r ], Compiler_Determinant( c, minor, n - 1 ) );
+		if ( result == SHADER_NO_REGISTER ) {
+			result = term;
+		} else {
+			result = Compiler_Op( c, ( r & 1 ) ? shaderOp_t::FSUB : shaderOp_t::FADD, result, term );
+		}
+	}
+	return result;
+}
+
+static void Compiler_MatrixProduct( shaderCompiler_t * c, const uint32 * inst ) {
+	const spvOp_t op = Spv_Op( inst );
+	const uint32 type = inst[ 1 ];
+	const shaderValue_t * a = Compiler_Operand( c, inst[ 3 ] );
+	const shaderValue_t * b = Compiler_Operand( c, inst[ 4 ] );
+	const uint32 count = Compiler_RegisterCount( c, type );
+	const uint32 dst = Compiler_Allocate( c, count );
+	uint32 aColumns;
+	uint32 aRows;
+	uint32 bColumns;
+	uint32 bRows;
+	Compiler_MatrixShape( c, a->type, &aColumns, &aRows );
+	Compiler_MatrixShape( c, b->type, &bColumns, &bRows );
+	switch ( op ) {
+		case spvOp_t::MATRIX_TIMES_VECTOR:
+			for ( uint32 i = 0; i < aRows; i++ ) {
+				Compiler_Emit( c, shaderOp_t::MOV, dst + i, Compiler_Dot( c, a->reg + i, aRows, b->reg, 1, aColumns ) );
+			}
+			break;
+		case spvOp_t::VECTOR_TIMES_MATRIX:
+			for ( uint32 col = 0; col < bColumns; col++ ) {
+				Compiler_Emit( c, shaderOp_t::MOV, dst + col, Compiler_Dot( c, a->reg, 1, b->reg + col * bRows, 1, bRows ) );
+			}
+			break;
+		case spvOp_t::MATRIX_TIMES_MATRIX:
+			for ( uint32 col = 0; col < bColumns; col++ ) {
+				for ( uint32 i = 0; i < aRows; i++ ) {
+					Compiler_Emit( c, shaderOp_t::MOV, dst + col * aRows + i, Compiler_Dot( c, a->reg + i, aRows, b->reg + col * bRows, 1, aColumns ) );
+				}
+			}
+			break;
+		default:
+			//Outer product: a is the column, b supplies one scale per column
+			for ( uint32 col = 0; col < b->count; col++ ) {
+				for ( uint32 i = 0; i < a->count; i++ ) {
+					Compiler_Emit( c, shaderOp_t::FMUL, dst + col * a->count + i, a->reg + i, b->reg + col );
+				}
+			}
+			break;
+	}
+	Compiler_Define( c, inst[ 2 ], type, dst, count );
+}
+
+static void Compiler_Transpose( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * m = Compiler_Operand( c, inst[ 3 ] );
+	uint32 columns;
+	uint32 rows;
+	Compiler_MatrixShape( c, m->type, &columns, &rows );
+	const uint32 dst = Compiler_Allocate( c, m->count );
+	for ( uint32 col = 0; col < columns; col++ ) {
+		for ( uint32 row = 0; row < rows; row++ ) {
+			Compiler_Emit( c, shaderOp_t::MOV, dst + row * columns + col, m->reg + col * rows + row );
+		}
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, m->count );
+}
+
+//OpAny and OpAll
+static void Compiler_Reduce( shaderCompiler_t * c, const uint32 * inst, shaderOp_t op ) {
+	const shaderValue_t * v = Compiler_Operand( c, inst[ 3 ] );
+	uint32 result = v->reg;
+	for ( uint32 i = 1; i < v->count; i++ ) {
+		result = Compiler_Op( c, op, result, v->reg + i );
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], result, 1 );
+}
+
+static void Compiler_Derivative( shaderCompiler_t * c, const uint32 * inst, shaderOp_t dx, shaderOp_t dy, bool width ) {
+	const shaderValue_t * v = Compiler_Operand( c, inst[ 3 ] );
+	const uint32 dst = Compiler_Allocate( c, v->count );
+	for ( uint32 i = 0; i < v->count; i++ ) {
+		//Derivatives only exist between the fragments of a quad
+		if ( c->stage != VK_SHADER_STAGE_FRAGMENT_BIT ) {
+			Compiler_Emit( c, shaderOp_t::MOV, dst + i, Compiler_Constant( c, 0 ) );
+		} else if ( width ) {
+			const uint32 ax = Compiler_Op( c, shaderOp_t::FABS, Compiler_Op( c, dx, v->reg + i ) );
+			const uint32 ay = Compiler_Op( c, shaderOp_t::FABS, Compiler_Op( c, dy, v->reg + i ) );
+			Compiler_Emit( c, shaderOp_t::FADD, dst + i, ax, ay );
+		} else {
+			Compiler_Emit( c, dx, dst + i, v->reg + i );
+		}
+	}
+	if ( c->stage == VK_SHADER_STAGE_FRAGMENT_BIT ) {
+		c->flags |= SHADER_PROGRAM_USES_DERIVATIVES;
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, v->count );
+}
+
+static void Compiler_Select( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * condition = Compiler_Operand( c, inst[ 3 ] );
+	const shaderValue_t * a = Compiler_Operand( c, inst[ 4 ] );
+	const shaderValue_t * b = Compiler_Operand( c, inst[ 5 ] );
+	const uint32 count = a->count;
+	const uint32 dst = Compiler_Allocate( c, count );
+	for ( uint32 i = 0; i < count; i++ ) {
+		Compiler_Emit( c, shaderOp_t::SELECT, dst + i, Compiler_Component( condition, i ), a->reg + i, b->reg + i );
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, count );
+}
+
+/*
+================================================
+GLSL.std.450
+================================================
+*/
+static void Compiler_ExtInst( shaderCompiler_t * c, const uint32 * inst ) {
+	if ( inst[ 3 ] != c->module->glslStd450 || c->module->glslStd450 == 0 ) {
+		Compiler_Fail( c, "unsupported extended instruction set", inst[ 3 ] );
+		return;
+	}
+	const glslStd450_t function = ( glslStd450_t )inst[ 4 ];
+	const uint32 type = inst[ 1 ];
+	const uint32 id = inst[ 2 ];
+	switch ( function ) {
+		case glslStd450_t::ROUND:
+		case glslStd450_t::ROUND_EVEN:		Compiler_Elementwise( c, inst, 5, shaderOp_t::FROUND_EVEN, 1, false ); return;
+		case glslStd450_t::TRUNC:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FTRUNC, 1, false ); return;
+		case glslStd450_t::F_ABS:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FABS, 1, false ); return;
+		case glslStd450_t::S_ABS:			Compiler_Elementwise( c, inst, 5, shaderOp_t::IABS, 1, false ); return;
+		case glslStd450_t::F_SIGN:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FSIGN, 1, false ); return;
+		case glslStd450_t::S_SIGN:			Compiler_Elementwise( c, inst, 5, shaderOp_t::ISIGN, 1, false ); return;
+		case glslStd450_t::FLOOR:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FFLOOR, 1, false ); return;
+		case glslStd450_t::CEIL:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FCEIL, 1, false ); return;
+		case glslStd450_t::SIN:				Compiler_Elementwise( c, inst, 5, shaderOp_t::FSIN, 1, false ); return;
+		case glslStd450_t::COS:				Compiler_Elementwise( c, inst, 5, shaderOp_t::FCOS, 1, false ); return;
+		case glslStd450_t::TAN:				Compiler_Elementwise( c, inst, 5, shaderOp_t::FTAN, 1, false ); return;
+		case glslStd450_t::ASIN:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FASIN, 1, false ); return;
+		case glslStd450_t::ACOS:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FACOS, 1, false ); return;
+		case glslStd450_t::ATAN:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FATAN, 1, false ); return;
+		case glslStd450_t::ATAN2:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FATAN2, 2, false ); return;
+		case glslStd450_t::POW:				Compiler_Elementwise( c, inst, 5, shaderOp_t::FPOW, 2, false ); return;
+		case glslStd450_t::EXP:				Compiler_Elementwise( c, inst, 5, shaderOp_t::FEXP, 1, false ); return;
+		case glslStd450_t::LOG:				Compiler_Elementwise( c, inst, 5, shaderOp_t::FLOG, 1, false ); return;
+		case glslStd450_t::EXP2:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FEXP2, 1, false ); return;
+		case glslStd450_t::LOG2:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FLOG2, 1, false ); return;
+		case glslStd450_t::SQRT:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FSQRT, 1, false ); return;
+		case glslStd450_t::INVERSE_SQRT:	Compiler_Elementwise( c, inst, 5, shaderOp_t::FRSQRT, 1, false ); return;
+		case glslStd450_t::F_MIN:
+		case glslStd450_t::N_MIN:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FMIN, 2, false ); return;
+		case glslStd450_t::U_MIN:			Compiler_Elementwise( c, inst, 5, shaderOp_t::UMIN, 2, false ); return;
+		case glslStd450_t::S_MIN:			Compiler_Elementwise( c, inst, 5, shaderOp_t::SMIN, 2, false ); return;
+		case glslStd450_t::F_MAX:
+		case glslStd450_t::N_MAX:			Compiler_Elementwise( c, inst, 5, shaderOp_t::FMAX, 2, false ); return;
+		case glslStd450_t::U_MAX:			Compiler_Elementwise( c, inst, 5, shaderOp_t::UMAX, 2, false ); return;
+		case glslStd450_t::S_MAX:			Compiler_Elementwise( c, inst, 5, shaderOp_t::SMAX, 2, false ); return;
+		case glslStd450_t::FIND_I_LSB:		Compiler_Elementwise( c, inst, 5, shaderOp_t::FIND_LSB, 1, false ); return;
+		case glslStd450_t::FIND_U_MSB:		Compiler_Elementwise( c, inst, 5, shaderOp_t::FIND_UMSB, 1, false ); return;
+		default:
+			break;
+	}
+
+	const uint32 count = Compiler_RegisterCount( c, type );
+	const shaderValue_t * x = Compiler_Operand( c, inst[ 5 ] );
+	const shaderValue_t * y = Spv_WordCount( inst ) > 6 ? Compiler_Operand( c, inst[ 6 ] ) : &c->nullValue;
+	const shaderValue_t * z = Spv_WordCount( inst ) > 7 ? Compiler_Operand( c, inst[ 7 ] ) : &c->nullValue;
+	const uint32 zero = Compiler_FloatConstant( c, 0.0f );
+	const uint32 one = Compiler_FloatConstant( c, 1.0f );
+	const uint32 dst = Compiler_Allocate( c, count );
+	switch ( function ) {
+		case glslStd450_t::FRACT:
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::FSUB, dst + i, x->reg + i, Compiler_Op( c, shaderOp_t::FFLOOR, x->reg + i ) );
+			}
+			break;
+		case glslStd450_t::RADIANS:
+		case glslStd450_t::DEGREES: {
+			const uint32 scale = Compiler_FloatConstant( c, function == glslStd450_t::RADIANS ? 0.017453292519943295f : 57.29577951308232f );
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::FMUL, dst + i, x->reg + i, scale );
+			}
+			break;
+		}
+		case glslStd450_t::SINH:
+		case glslStd450_t::COSH: {
+			const uint32 half = Compiler_FloatConstant( c, 0.5f );
+			for ( uint32 i = 0; i < count; i++ ) {
+				const uint32 positive = Compiler_Op( c, shaderOp_t::FEXP, x->reg + i );
+				const uint32 negative = Compiler_Op( c, shaderOp_t::FEXP, Compiler_Op( c, shaderOp_t::FNEG, x->reg + i ) );
+				const uint32 sum = Compiler_Op( c, function == glslStd450_t::SINH ? shaderOp_t::FSUB : shaderOp_t::FADD, positive, negative );
+				Compiler_Emit( c, shaderOp_t::FMUL, dst + i, sum, half );
+			}
+			break;
+		}
+		case glslStd450_t::TANH: {
+			//1 - 2 / ( e^2x + 1 ) saturates cleanly where the quotient form overflows
+			const uint32 two = Compiler_FloatConstant( c, 2.0f );
+			for ( uint32 i = 0; i < count; i++ ) {
+				const uint32 e2x = Compiler_Op( c, shaderOp_t::FEXP, Compiler_Op( c, shaderOp_t::FMUL, x->reg + i, two ) );
+				const uint32 quotient = Compiler_Op( c, shaderOp_t::FDIV, two, Compiler_Op( c, shaderOp_t::FADD, e2x, one ) );
+				Compiler_Emit( c, shaderOp_t::FSUB, dst + i, one, quotient );
+			}
+			break;
+		}
+		case glslStd450_t::F_CLAMP:
+		case glslStd450_t::N_CLAMP:
+		case glslStd450_t::U_CLAMP:
+		case glslStd450_t::S_CLAMP: {
+			shaderOp_t minOp = shaderOp_t::FMIN;
+			shaderOp_t maxOp = shaderOp_t::FMAX;
+			if ( function == glslStd450_t::U_CLAMP ) {
+				minOp = shaderOp_t::UMIN;
+				maxOp = shaderOp_t::UMAX;
+			} else if ( function == glslStd450_t::S_CLAMP ) {
+				minOp = shaderOp_t::SMIN;
+				maxOp = shaderOp_t::SMAX;
+			}
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, minOp, dst + i, Compiler_Op( c, maxOp, x->reg + i, Compiler_Component( y, i ) ), Compiler_Component( z, i ) );
+			}
+			break;
+		}
+		case glslStd450_t::F_MIX:
+			for ( uint32 i = 0; i < count; i++ ) {
+				const uint32 delta = Compiler_Op( c, shaderOp_t::FSUB, Compiler_Component( y, i ), x->reg + i );
+				Compiler_Emit( c, shaderOp_t::FADD, dst + i, x->reg + i, Compiler_Op( c, shaderOp_t::FMUL, delta, Compiler_Component( z, i ) ) );
+			}
+			break;
+		case glslStd450_t::STEP:
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::SELECT, dst + i, Compiler_Op( c, shaderOp_t::FORD_LT, y->reg + i, Compiler_Component( x, i ) ), zero, one );
+			}
+			break;
+		case glslStd450_t::SMOOTH_STEP: {
+			const uint32 two = Compiler_FloatConstant( c, 2.0f );
+			const uint32 three = Compiler_FloatConstant( c, 3.0f );
+			for ( uint32 i = 0; i < count; i++ ) {
+				const uint32 e0 = Compiler_Component( x, i );
+				const uint32 range = Compiler_Op( c, shaderOp_t::FSUB, Compiler_Component( y, i ), e0 );
+				const uint32 ratio = Compiler_Op( c, shaderOp_t::FDIV, Compiler_Op( c, shaderOp_t::FSUB, z->reg + i, e0 ), range );
+				const uint32 t = Compiler_Op( c, shaderOp_t::FMIN, Compiler_Op( c, shaderOp_t::FMAX, ratio, zero ), one );
+				const uint32 shape = Compiler_Op( c, shaderOp_t::FSUB, three, Compiler_Op( c, shaderOp_t::FMUL, two, t ) );
+				Compiler_Emit( c, shaderOp_t::FMUL, dst + i, Compiler_Op( c, shaderOp_t::FMUL, t, t ), shape );
+			}
+			break;
+		}
+		case glslStd450_t::FMA:
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::FADD, dst + i, Compiler_Op( c, shaderOp_t::FMUL, x->reg + i, y->reg + i ), z->reg + i );
+			}
+			break;
+		case glslStd450_t::LENGTH:
+			Compiler_Emit( c, shaderOp_t::FSQRT, dst, Compiler_Dot( c, x->reg, 1, x->reg, 1, x->count ) );
+			break;
+		case glslStd450_t::DISTANCE: {
+			const uint32 delta = Compiler_Allocate( c, x->count );
+			for ( uint32 i = 0; i < x->count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::FSUB, delta + i, x->reg + i, y->reg + i );
+			}
+			Compiler_Emit( c, shaderOp_t::FSQRT, dst, Compiler_Dot( c, delta, 1, delta, 1, x->count ) );
+			break;
+		}
+		case glslStd450_t::CROSS:
+			for ( uint32 i = 0; i < 3; i++ ) {
+				const uint32 j = ( i + 1 ) % 3;
+				const uint32 k = ( i + 2 ) % 3;
+				const uint32 a = Compiler_Op( c, shaderOp_t::FMUL, x->reg + j, y->reg + k );
+				const uint32 b = Compiler_Op( c, shaderOp_t::FMUL, x->reg + k, y->reg + j );
+				Compiler_Emit( c, shaderOp_t::FSUB, dst + i, a, b );
+			}
+			break;
+		case glslStd450_t::NORMALIZE: {
+			const uint32 scale = Compiler_Op( c, shaderOp_t::FRSQRT, Compiler_Dot( c, x->reg, 1, x->reg, 1, count ) );
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::FMUL, dst + i, x->reg + i, scale );
+			}
+			break;
+		}
+		case glslStd450_t::FACE_FORWARD: {
+			const uint32 facing = Compiler_Op( c, shaderOp_t::FORD_LT, Compiler_Dot( c, z->reg, 1, y->reg, 1, count ), zero );
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::SELECT, dst + i, facing, x->reg + i, Compiler_Op( c, shaderOp_t::FNEG, x->reg + i ) );
+			}
+			break;
+		}
+		case glslStd450_t::REFLECT: {
+			const uint32 d = Compiler_Dot( c, y->reg, 1, x->reg, 1, count );
+			const uint32 twice = Compiler_Op( c, shaderOp_t::FADD, d, d );
+			for ( uint32 i = 0; i < count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::FSUB, dst + i, x->reg + i, Compiler_Op( c, shaderOp_t::FMUL, twice, y->reg + i ) );
+			}
+			break;
+		}
+		case glslStd450_t::REFRACT: {
+			const uint32 eta = z->reg;
+			const uint32 d = Compiler_Dot( c, y->reg, 1, x->reg, 1, count );
+			const uint32 sine = Compiler_Op( c, shaderOp_t::FSUB, one, Compiler_Op( c, shaderOp_t::FMUL, d, d ) );
+			const uint32 k = Compiler_Op( c, shaderOp_t::FSUB, one, Compiler_Op( c, shaderOp_t::FMUL, Compiler_Op( c, shaderOp_t::FMUL, eta, eta ), sine ) );
+			const uint32 total = Compiler_Op( c, shaderOp_t::FORD_LT, k, zero );
+			const uint32 t = Compiler_Op( c, shaderOp_t::FADD, Compiler_Op( c, shaderOp_t::FMUL, eta, d ), Compiler_Op( c, shaderOp_t::FSQRT, Compiler_Op( c, shaderOp_t::FMAX, k, zero ) ) );
+			for ( uint32 i = 0; i < count; i++ ) {
+				const uint32 r = Compiler_Op( c, shaderOp_t::FSUB, Compiler_Op( c, shaderOp_t::FMUL, eta, x->reg + i ), Compiler_Op( c, shaderOp_t::FMUL, t, y->reg + i ) );
+				Compiler_Emit( c, shaderOp_t::SELECT, dst + i, total, zero, r );
+			}
+			break;
+		}
+		case glslStd450_t::DETERMINANT: {
+			uint32 columns;
+			uint32 rows;
+			Compiler_MatrixShape( c, x->type, &columns, &rows );
+			if ( columns != rows || columns > 4 ) {
+				Compiler_Fail( c, "determinant of a non-square matrix", x->type );
+				return;
+			}
+			uint32 elements[ 16 ];
+			for ( uint32 i = 0; i < columns * rows; i++ ) {
+				elements[ i ] = x->reg + i;
+			}
+			Compiler_Emit( c, shaderOp_t::MOV, dst, Compiler_Determinant( c, elements, columns ) );
+			break;
+		}
+		default:
+			Compiler_Fail( c, "unsupported GLSL.std.450 instruction", ( uint32 )function );
+			return;
+	}
+	Compiler_Define( c, id, type, dst, count );
+}
+
+/*
+================================================
+Images
+================================================
+*/
+static const uint32 * Compiler_ImageType( shaderCompiler_t * c, uint32 type ) {
+	const uint32 * inst = Compiler_Instruction( c, type );
+	if ( inst != NULL && Spv_Op( inst ) == spvOp_t::TYPE_SAMPLED_IMAGE ) {
+		inst = Compiler_Instruction( c, inst[ 2 ] );
+	}
+	if ( inst == NULL || Spv_Op( inst ) != spvOp_t::TYPE_IMAGE ) {
+		Compiler_Fail( c, "not an image type", type );
+		return NULL;
+	}
+	return inst;
+}
+
+static void Compiler_Sample( shaderCompiler_t * c, const uint32 * inst ) {
+	const spvOp_t op = Spv_Op( inst );
+	const uint32 length = Spv_WordCount( inst );
+	const shaderValue_t * image = Compiler_Value( c, inst[ 3 ] );
+	const shaderValue_t * coordinate = Compiler_Operand( c, inst[ 4 ] );
+	const uint32 * imageType = ( image->kind == shaderValueKind_t::IMAGE ) ? Compiler_ImageType( c, image->type ) : NULL;
+	if ( imageType == NULL ) {
+		Compiler_Fail( c, "sample from a non-image", inst[ 3 ] );
+		return;
+	}
+	shaderSampleOp_t sample;
+	memset( &sample, 0, sizeof( sample ) );
+	sample.imageSlot = image->slot;
+	sample.imageElement = image->element;
+	sample.imageElementRegister = image->elementRegister;
+	sample.samplerSlot = image->samplerSlot;
+	sample.samplerElement = image->samplerElement;
+	sample.samplerElementRegister = image->samplerElementRegister;
+	sample.dimension = imageType[ 3 ];
+	sample.arrayed = imageType[ 5 ] != 0;
+	sample.coordinateRegister = coordinate->reg;
+	sample.coordinateCount = coordinate->count;
+	sample.lodRegister = SHADER_NO_REGISTER;
+	sample.drefRegister = SHADER_NO_REGISTER;
+	sample.gradientRegister = SHADER_NO_REGISTER;
+	sample.offsetRegister = SHADER_NO_REGISTER;
+	sample.resultCount = Compiler_RegisterCount( c, inst[ 1 ] );
+	uint32 next = 5;
+	switch ( op ) {
+		case spvOp_t::IMAGE_SAMPLE_IMPLICIT_LOD:
+			sample.flags = SHADER_SAMPLE_IMPLICIT_LOD;
+			break;
+		case spvOp_t::IMAGE_SAMPLE_EXPLICIT_LOD:
+			sample.flags = SHADER_SAMPLE_EXPLICIT_LOD;
+			break;
+		case spvOp_t::IMAGE_SAMPLE_DREF_IMPLICIT_LOD:
+			sample.flags = SHADER_SAMPLE_IMPLICIT_LOD | SHADER_SAMPLE_DREF;
+			sample.drefRegister = Compiler_Operand( c, inst[ next++ ] )->reg;
+			break;
+		case spvOp_t::IMAGE_SAMPLE_DREF_EXPLICIT_LOD:
+			sample.flags = SHADER_SAMPLE_EXPLICIT_LOD | SHADER_SAMPLE_DREF;
+			sample.drefRegister = Compiler_Operand( c, inst[ next++ ] )->reg;
+			break;
+		default:
+			sample.flags = SHADER_SAMPLE_FETCH;
+			break;
+	}
+	if ( next < length ) {
+		const uint32 operands = inst[ next++ ];
+		if ( ( operands & ( SPV_IMAGE_OPERAND_CONST_OFFSETS | SPV_IMAGE_OPERAND_SAMPLE | SPV_IMAGE_OPERAND_MIN_LOD ) ) != 0 ) {
+			Compiler_Fail( c, "unsupported image operands", operands );
+			return;
+		}
+		if ( ( operands & SPV_IMAGE_OPERAND_BIAS ) != 0 && next < length ) {
+			sample.flags |= SHADER_SAMPLE_BIAS;
+			sample.lodRegister = Compiler_Operand( c, inst[ next++ ] )->reg;
+		}
+		if ( ( operands & SPV_IMAGE_OPERAND_LOD ) != 0 && next < length ) {
+			sample.lodRegister = Compiler_Operand( c, inst[ next++ ] )->reg;
+		}
+		if ( ( operands & SPV_IMAGE_OPERAND_GRAD ) != 0 && next + 1 < length ) {
+			const shaderValue_t * dx = Compiler_Operand( c, inst[ next++ ] );
+			const shaderValue_t * dy = Compiler_Operand( c, inst[ next++ ] );
+			sample.flags |= SHADER_SAMPLE_GRAD;
+			sample.gradientRegister = Compiler_Allocate( c, dx->count * 2 );
+			for ( uint32 i = 0; i < dx->count; i++ ) {
+				Compiler_Emit( c, shaderOp_t::MOV, sample.gradientRegister + i, dx->reg + i );
+				Compiler_Emit( c, shaderOp_t::MOV, sample.gradientRegister + dx->count + i, Compiler_Component( dy, i ) );
+			}
+		}
+		if ( ( operands & ( SPV_IMAGE_OPERAND_CONST_OFFSET | SPV_IMAGE_OPERAND_OFFSET ) ) != 0 && next < length ) {
+			sample.flags |= SHADER_SAMPLE_OFFSET;
+			sample.offsetRegister = Compiler_Operand( c, inst[ next++ ] )->reg;
+		}
+	}
+	if ( ( sample.flags & SHADER_SAMPLE_IMPLICIT_LOD ) != 0 && c->stage == VK_SHADER_STAGE_FRAGMENT_BIT ) {
+		c->flags |= SHADER_PROGRAM_USES_DERIVATIVES;
+	} else if ( ( sample.flags & SHADER_SAMPLE_IMPLICIT_LOD ) != 0 ) {
+		//Other stages have no derivatives, so implicit lods sample the base level as the spec has it
+		sample.flags = ( sample.flags & ~( SHADER_SAMPLE_IMPLICIT_LOD | SHADER_SAMPLE_BIAS ) ) | SHADER_SAMPLE_EXPLICIT_LOD;
+		sample.lodRegister = SHADER_NO_REGISTER;
+	}
+	const uint32 sampleIndex = c->sampleOps.count;
+	*Compiler_Push( c, &c->sampleOps ) = sample;
+	const uint32 dst = Compiler_Allocate( c, sample.resultCount );
+	Compiler_Emit( c, shaderOp_t::SAMPLE, dst, sampleIndex );
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, sample.resultCount );
+}
+
+/*
+================================================
+Composites
+================================================
+*/
+static void Compiler_CompositeExtract( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * composite = Compiler_Operand( c, inst[ 3 ] );
+	uint32 type = composite->type;
+	uint32 offset = 0;
+	for ( uint32 k = 4; k < Spv_WordCount( inst ) && !c->failed; k++ ) {
+		offset += Compiler_ElementOffset( c, &type, inst[ k ] );
+	}
+	//Components of a flattened composite are already registers of their own
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], composite->reg + offset, Compiler_RegisterCount( c, inst[ 1 ] ) );
+}
+
+static void Compiler_CompositeConstruct( shaderCompiler_t * c, const uint32 * inst ) {
+	const uint32 count = Compiler_RegisterCount( c, inst[ 1 ] );
+	const uint32 dst = Compiler_Allocate( c, count );
+	uint32 next = 0;
+	for ( uint32 k = 3; k < Spv_WordCount( inst ) && !c->failed; k++ ) {
+		const shaderValue_t * part = Compiler_Operand( c, inst[ k ] );
+		for ( uint32 i = 0; i < part->count && next < count; i++ ) {
+			Compiler_Emit( c, shaderOp_t::MOV, dst + next++, part->reg + i );
+		}
+	}
+	if ( next != count ) {
+		Compiler_Fail( c, "composite does not match its type", inst[ 2 ] );
+		return;
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, count );
+}
+
+static void Compiler_CompositeInsert( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * object = Compiler_Operand( c, inst[ 3 ] );
+	const shaderValue_t * composite = Compiler_Operand( c, inst[ 4 ] );
+	uint32 type = composite->type;
+	uint32 offset = 0;
+	for ( uint32 k = 5; k < Spv_WordCount( inst ) && !c->failed; k++ ) {
+		offset += Compiler_ElementOffset( c, &type, inst[ k ] );
+	}
+	const uint32 dst = Compiler_Allocate( c, composite->count );
+	for ( uint32 i = 0; i < composite->count; i++ ) {
+		const bool replaced = i >= offset && i - offset < object->count;
+		Compiler_Emit( c, shaderOp_t::MOV, dst + i, replaced ? object->reg + i - offset : composite->reg + i );
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, composite->count );
+}
+
+static void Compiler_VectorShuffle( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * a = Compiler_Operand( c, inst[ 3 ] );
+	const shaderValue_t * b = Compiler_Operand( c, inst[ 4 ] );
+	const uint32 count = Spv_WordCount( inst ) - 5;
+	const uint32 dst = Compiler_Allocate( c, count );
+	for ( uint32 i = 0; i < count; i++ ) {
+		const uint32 select = inst[ 5 + i ];
+		uint32 src;
+		if ( select < a->count ) {
+			src = a->reg + select;
+		} else if ( select - a->count < b->count ) {
+			src = b->reg + select - a->count;
+		} else {
+			//0xFFFFFFFF leaves the component undefined
+			src = Compiler_Constant( c, 0 );
+		}
+		Compiler_Emit( c, shaderOp_t::MOV, dst + i, src );
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, count );
+}
+
+static void Compiler_VectorExtractDynamic( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * vector = Compiler_Operand( c, inst[ 3 ] );
+	const shaderValue_t * index = Compiler_Operand( c, inst[ 4 ] );
+	const uint32 dst = Compiler_Op( c, shaderOp_t::LOAD_INDEXED, vector->reg, index->reg, vector->count - 1 );
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, 1 );
+}
+
+static void Compiler_VectorInsertDynamic( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * vector = Compiler_Operand( c, inst[ 3 ] );
+	const shaderValue_t * component = Compiler_Operand( c, inst[ 4 ] );
+	const shaderValue_t * index = Compiler_Operand( c, inst[ 5 ] );
+	const uint32 dst = Compiler_Allocate( c, vector->count );
+	for ( uint32 i = 0; i < vector->count; i++ ) {
+		Compiler_Emit( c, shaderOp_t::MOV, dst + i, vector->reg + i );
+	}
+	Compiler_Emit( c, shaderOp_t::STORE_INDEXED, dst, component->reg, index->reg, vector->count - 1 );
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, vector->count );
+}
+
+//Conversions between 32-bit types that keep the bits
+static void Compiler_Alias( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * source = Compiler_Value( c, inst[ 3 ] );
+	if ( source->kind != shaderValueKind_t::REGISTERS ) {
+		shaderValue_t copy = *source;
+		c->pValues[ inst[ 2 ] ] = copy;
+		return;
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], source->reg, source->count );
+}
+
+static void Compiler_SampledImage( shaderCompiler_t * c, const uint32 * inst ) {
+	const shaderValue_t * image = Compiler_Value( c, inst[ 3 ] );
+	if ( image->kind != shaderValueKind_t::IMAGE ) {
+		Compiler_Fail( c, "operand is not an image", inst[ 3 ] );
+		return;
+	}
+	shaderValue_t value = *image;
+	value.type = inst[ 1 ];
+	if ( Spv_Op( inst ) == spvOp_t::SAMPLED_IMAGE ) {
+		const shaderValue_t * sampler = Compiler_Value( c, inst[ 4 ] );
+		if ( sampler->kind != shaderValueKind_t::IMAGE ) {
+			Compiler_Fail( c, "operand is not a sampler", inst[ 4 ] );
+			return;
+		}
+		value.samplerSlot = sampler->samplerSlot;
+		value.samplerElement = sampler->samplerElement;
+		value.samplerElementRegister = sampler->samplerElementRegister;
+	}
+	c->pValues[ inst[ 2 ] ] = value;
+}
+
+/*
+================================================
+Subgroups
+
+Every GroupNonUniform instruction maps onto one IR op per component.  Ballots are uvec4s whose words
+past x are always zero, since no subgroup is wider than 32 lanes.
+================================================
+*/
+static shaderOp_t Compiler_SubgroupCombine( spvOp_t op ) {
+	switch ( op ) {
+		case spvOp_t::GROUP_NON_UNIFORM_I_ADD:			return shaderOp_t::IADD;
+		case spvOp_t::GROUP_NON_UNIFORM_F_ADD:			return shaderOp_t::FADD;
+		case spvOp_t::GROUP_NON_UNIFORM_I_MUL:			return shaderOp_t::IMUL;
+		case spvOp_t::GROUP_NON_UNIFORM_F_MUL:			return shaderOp_t::FMUL;
+		case spvOp_t::GROUP_NON_UNIFORM_S_MIN:			return shaderOp_t::SMIN;
+		case spvOp_t::GROUP_NON_UNIFORM_U_MIN:			return shaderOp_t::UMIN;
+		case spvOp_t::GROUP_NON_UNIFORM_F_MIN:			return shaderOp_t::FMIN;
+		case spvOp_t::GROUP_NON_UNIFORM_S_MAX:			return shaderOp_t::SMAX;
+		case spvOp_t::GROUP_NON_UNIFORM_U_MAX:			return shaderOp_t::UMAX;
+		case spvOp_t::GROUP_NON_UNIFORM_F_MAX:			return shaderOp_t::FMAX;
+		case spvOp_t::GROUP_NON_UNIFORM_BITWISE_AND:
+		case spvOp_t::GROUP_NON_UNIFORM_LOGICAL_AND:	return shaderOp_t::AND;
+		case spvOp_t::GROUP_NON_UNIFORM_BITWISE_OR:
+		case spvOp_t::GROUP_NON_UNIFORM_LOGICAL_OR:		return shaderOp_t::OR;
+		default:										return shaderOp_t::XOR;
+	}
+}
+
+static void Compiler_SubgroupArithmetic( shaderCompiler_t * c, const uint32 * inst ) {
+	shaderOp_t op;
+	uint32 clusterSize = 0;
+	switch ( ( spvGroupOperation_t )inst[ 4 ] ) {
+		case spvGroupOperation_t::REDUCE:			op = shaderOp_t::SUBGROUP_REDUCE; break;
+		case spvGroupOperation_t::INCLUSIVE_SCAN:	op = shaderOp_t::SUBGROUP_INCLUSIVE_SCAN; break;
+		case spvGroupOperation_t::EXCLUSIVE_SCAN:	op = shaderOp_t::SUBGROUP_EXCLUSIVE_SCAN; break;
+		case spvGroupOperation_t::CLUSTERED_REDUCE:
+			op = shaderOp_t::SUBGROUP_REDUCE;
+			if ( Spv_WordCount( inst ) < 7 || !Compiler_ScalarConstant( c, inst[ 6 ], &clusterSize ) || clusterSize == 0 ) {
+				Compiler_Fail( c, "cluster size is not a constant", inst[ 2 ] );
+				return;
+			}
+			break;
+		default:
+			Compiler_Fail( c, "unsupported group operation", inst[ 4 ] );
+			return;
+	}
+	const shaderOp_t combine = Compiler_SubgroupCombine( Spv_Op( inst ) );
+	const shaderValue_t * value = Compiler_Operand( c, inst[ 5 ] );
+	const uint32 count = Compiler_RegisterCount( c, inst[ 1 ] );
+	const uint32 dst = Compiler_Allocate( c, count );
+	for ( uint32 i = 0; i < count; i++ ) {
+		Compiler_Emit( c, op, dst + i, Compiler_Component( value, i ), ( uint32 )combine, clusterSize );
+	}
+	Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, count );
+}
+
+//Bits of a ballot that belong to subgroup lanes
+static uint32 Compiler_SubgroupBallotBits( shaderCompiler_t * c, uint32 ballot ) {
+	const uint32 ge = Compiler_Op( c, shaderOp_t::SUBGROUP_BUILTIN, ( uint32 )spvBuiltIn_t::SUBGROUP_GE_MASK );
+	const uint32 lt = Compiler_Op( c, shaderOp_t::SUBGROUP_BUILTIN, ( uint32 )spvBuiltIn_t::SUBGROUP_LT_MASK );
+	return Compiler_Op( c, shaderOp_t::AND, ballot, Compiler_Op( c, shaderOp_t::OR, ge, lt ) );
+}
+
+static void Compiler_Subgroup( shaderCompiler_t * c, const uint32 * inst ) {
+	const spvOp_t op = Spv_Op( inst );
+	uint32 scope;
+	if ( !Compiler_ScalarConstant( c, inst[ 3 ], &scope ) || scope != ( uint32 )spvScope_t::SUBGROUP ) {
+		Compiler_Fail( c, "group operation outside subgroup scope", inst[ 2 ] );
+		return;
+	}
+	switch ( op ) {
+		case spvOp_t::GROUP_NON_UNIFORM_ELECT:
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], Compiler_Op( c, shaderOp_t::SUBGROUP_ELECT, SHADER_NO_REGISTER ), 1 );
+			return;
+		case spvOp_t::GROUP_NON_UNIFORM_ALL:				Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_ALL, 1, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_ANY:				Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_ANY, 1, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_BROADCAST:			Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_SHUFFLE, 2, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_BROADCAST_FIRST:	Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_BROADCAST_FIRST, 1, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE:			Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_SHUFFLE, 2, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE_XOR:		Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_SHUFFLE_XOR, 2, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE_UP:			Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_SHUFFLE_UP, 2, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE_DOWN:		Compiler_Elementwise( c, inst, 4, shaderOp_t::SUBGROUP_SHUFFLE_DOWN, 2, false ); return;
+		case spvOp_t::GROUP_NON_UNIFORM_ALL_EQUAL: {
+			//Vectors are equal when every component is
+			const shaderValue_t * value = Compiler_Operand( c, inst[ 4 ] );
+			uint32 result = Compiler_Op( c, shaderOp_t::SUBGROUP_ALL_EQUAL, value->reg );
+			for ( uint32 i = 1; i < value->count; i++ ) {
+				result = Compiler_Op( c, shaderOp_t::AND, result, Compiler_Op( c, shaderOp_t::SUBGROUP_ALL_EQUAL, value->reg + i ) );
+			}
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], result, 1 );
+			return;
+		}
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT: {
+			const uint32 dst = Compiler_Allocate( c, 4 );
+			Compiler_Emit( c, shaderOp_t::SUBGROUP_BALLOT, dst, Compiler_Operand( c, inst[ 4 ] )->reg );
+			for ( uint32 i = 1; i < 4; i++ ) {
+				Compiler_Emit( c, shaderOp_t::MOV, dst + i, Compiler_Constant( c, 0 ) );
+			}
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], dst, 4 );
+			return;
+		}
+		case spvOp_t::GROUP_NON_UNIFORM_INVERSE_BALLOT:
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], Compiler_Op( c, shaderOp_t::SUBGROUP_INVERSE_BALLOT, Compiler_Operand( c, inst[ 4 ] )->reg ), 1 );
+			return;
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_BIT_EXTRACT: {
+			const uint32 ballot = Compiler_Operand( c, inst[ 4 ] )->reg;
+			const uint32 index = Compiler_Operand( c, inst[ 5 ] )->reg;
+			const uint32 bit = Compiler_Op( c, shaderOp_t::AND, Compiler_Op( c, shaderOp_t::SHR, ballot, Compiler_Op( c, shaderOp_t::AND, index, Compiler_Constant( c, 31 ) ) ), Compiler_Constant( c, 1 ) );
+			const uint32 inX = Compiler_Op( c, shaderOp_t::ULT, index, Compiler_Constant( c, 32 ) );
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], Compiler_Op( c, shaderOp_t::AND, Compiler_Op( c, shaderOp_t::INE, bit, Compiler_Constant( c, 0 ) ), inX ), 1 );
+			return;
+		}
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_BIT_COUNT: {
+			const uint32 ballot = Compiler_Operand( c, inst[ 5 ] )->reg;
+			uint32 bits;
+			switch ( ( spvGroupOperation_t )inst[ 4 ] ) {
+				case spvGroupOperation_t::REDUCE:
+					bits = Compiler_SubgroupBallotBits( c, ballot );
+					break;
+				case spvGroupOperation_t::INCLUSIVE_SCAN:
+					bits = Compiler_Op( c, shaderOp_t::AND, ballot, Compiler_Op( c, shaderOp_t::SUBGROUP_BUILTIN, ( uint32 )spvBuiltIn_t::SUBGROUP_LE_MASK ) );
+					break;
+				case spvGroupOperation_t::EXCLUSIVE_SCAN:
+					bits = Compiler_Op( c, shaderOp_t::AND, ballot, Compiler_Op( c, shaderOp_t::SUBGROUP_BUILTIN, ( uint32 )spvBuiltIn_t::SUBGROUP_LT_MASK ) );
+					break;
+				default:
+					Compiler_Fail( c, "unsupported group operation", inst[ 4 ] );
+					return;
+			}
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], Compiler_Op( c, shaderOp_t::BIT_COUNT, bits ), 1 );
+			return;
+		}
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_FIND_LSB:
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_FIND_MSB: {
+			const uint32 bits = Compiler_SubgroupBallotBits( c, Compiler_Operand( c, inst[ 4 ] )->reg );
+			const shaderOp_t find = ( op == spvOp_t::GROUP_NON_UNIFORM_BALLOT_FIND_LSB ) ? shaderOp_t::FIND_LSB : shaderOp_t::FIND_UMSB;
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], Compiler_Op( c, find, bits ), 1 );
+			return;
+		}
+		default:
+			Compiler_SubgroupArithmetic( c, inst );
+			return;
+	}
+}
+
+/*
+================================================
+Instruction lowering
+
+Everything but the block structure: merges, phis and terminators are consumed by the control flow
+emitter below.
+================================================
+*/
+static void Compiler_Call( shaderCompiler_t * c, const uint32 * inst );
+
+static void Compiler_LowerInstruction( shaderCompiler_t * c, const uint32 * inst ) {
+	const spvOp_t op = Spv_Op( inst );
+	switch ( op ) {
+		case spvOp_t::NOP:
+		case spvOp_t::LINE:
+		case spvOp_t::NO_LINE:
+		case spvOp_t::UNDEF:			//materialized on first use
+		case spvOp_t::PHI:				//allocated when the block is entered
+		case spvOp_t::MEMORY_BARRIER:	//lanes run in lockstep against the same memory
+			return;
+		default:
+			break;
+	}
+	if ( Spv_ResultIndex( op ) == 2 && Spv_WordCount( inst ) < 4 ) {
+		Compiler_Fail( c, "truncated instruction", ( uint32 )op );
+		return;
+	}
+	switch ( op ) {
+		case spvOp_t::VARIABLE:
+			if ( ( spvStorageClass_t )inst[ 3 ] != spvStorageClass_t::FUNCTION ) {
+				Compiler_Fail( c, "non-function variable inside a function", inst[ 2 ] );
+				return;
+			}
+			Compiler_DeclareVariable( c, inst[ 2 ], inst );
+			return;
+		case spvOp_t::LOAD:						Compiler_Load( c, inst ); return;
+		case spvOp_t::STORE:					Compiler_Store( c, inst[ 1 ], Compiler_Operand( c, inst[ 2 ] ) ); return;
+		case spvOp_t::COPY_MEMORY: {
+			const shaderValue_t * source = Compiler_Value( c, inst[ 2 ] );
+			shaderValue_t value;
+			Compiler_LoadValue( c, source->type, inst[ 2 ], &value );
+			Compiler_Store( c, inst[ 1 ], &value );
+			return;
+		}
+		case spvOp_t::ACCESS_CHAIN:
+		case spvOp_t::IN_BOUNDS_ACCESS_CHAIN:	Compiler_AccessChain( c, inst ); return;
+		case spvOp_t::FUNCTION_CALL:			Compiler_Call( c, inst ); return;
+		case spvOp_t::EXT_INST:					Compiler_ExtInst( c, inst ); return;
+
+		case spvOp_t::COMPOSITE_EXTRACT:		Compiler_CompositeExtract( c, inst ); return;
+		case spvOp_t::COMPOSITE_CONSTRUCT:		Compiler_CompositeConstruct( c, inst ); return;
+		case spvOp_t::COMPOSITE_INSERT:			Compiler_CompositeInsert( c, inst ); return;
+		case spvOp_t::VECTOR_SHUFFLE:			Compiler_VectorShuffle( c, inst ); return;
+		case spvOp_t::VECTOR_EXTRACT_DYNAMIC:	Compiler_VectorExtractDynamic( c, inst ); return;
+		case spvOp_t::VECTOR_INSERT_DYNAMIC:	Compiler_VectorInsertDynamic( c, inst ); return;
+		case spvOp_t::TRANSPOSE:				Compiler_Transpose( c, inst ); return;
+		case spvOp_t::COPY_OBJECT:
+		case spvOp_t::BITCAST:
+		case spvOp_t::U_CONVERT:
+		case spvOp_t::S_CONVERT:
+		case spvOp_t::F_CONVERT:				Compiler_Alias( c, inst ); return;
+
+		case spvOp_t::CONVERT_F_TO_U:			Compiler_Elementwise( c, inst, 3, shaderOp_t::F2U, 1, false ); return;
+		case spvOp_t::CONVERT_F_TO_S:			Compiler_Elementwise( c, inst, 3, shaderOp_t::F2S, 1, false ); return;
+		case spvOp_t::CONVERT_S_TO_F:			Compiler_Elementwise( c, inst, 3, shaderOp_t::S2F, 1, false ); return;
+		case spvOp_t::CONVERT_U_TO_F:			Compiler_Elementwise( c, inst, 3, shaderOp_t::U2F, 1, false ); return;
+		case spvOp_t::S_NEGATE:					Compiler_Elementwise( c, inst, 3, shaderOp_t::INEG, 1, false ); return;
+		case spvOp_t::F_NEGATE:					Compiler_Elementwise( c, inst, 3, shaderOp_t::FNEG, 1, false ); return;
+		case spvOp_t::I_ADD:					Compiler_Elementwise( c, inst, 3, shaderOp_t::IADD, 2, false ); return;
+		case spvOp_t::F_ADD:					Compiler_Elementwise( c, inst, 3, shaderOp_t::FADD, 2, false ); return;
+		case spvOp_t::I_SUB:					Compiler_Elementwise( c, inst, 3, shaderOp_t::ISUB, 2, false ); return;
+		case spvOp_t::F_SUB:					Compiler_Elementwise( c, inst, 3, shaderOp_t::FSUB, 2, false ); return;
+		case spvOp_t::I_MUL:					Compiler_Elementwise( c, inst, 3, shaderOp_t::IMUL, 2, false ); return;
+		case spvOp_t::F_MUL:
+		case spvOp_t::VECTOR_TIMES_SCALAR:
+		case spvOp_t::MATRIX_TIMES_SCALAR:		Compiler_Elementwise( c, inst, 3, shaderOp_t::FMUL, 2, false ); return;
+		case spvOp_t::U_DIV:					Compiler_Elementwise( c, inst, 3, shaderOp_t::UDIV, 2, false ); return;
+		case spvOp_t::S_DIV:					Compiler_Elementwise( c, inst, 3, shaderOp_t::SDIV, 2, false ); return;
+		case spvOp_t::F_DIV:					Compiler_Elementwise( c, inst, 3, shaderOp_t::FDIV, 2, false ); return;
+		case spvOp_t::U_MOD:					Compiler_Elementwise( c, inst, 3, shaderOp_t::UMOD, 2, false ); return;
+		case spvOp_t::S_REM:					Compiler_Elementwise( c, inst, 3, shaderOp_t::SREM, 2, false ); return;
+		case spvOp_t::S_MOD:					Compiler_Elementwise( c, inst, 3, shaderOp_t::SMOD, 2, false ); return;
+		case spvOp_t::F_REM:					Compiler_Elementwise( c, inst, 3, shaderOp_t::FREM, 2, false ); return;
+		case spvOp_t::F_MOD:					Compiler_Elementwise( c, inst, 3, shaderOp_t::FMOD, 2, false ); return;
+		case spvOp_t::VECTOR_TIMES_MATRIX:
+		case spvOp_t::MATRIX_TIMES_VECTOR:
+		case spvOp_t::MATRIX_TIMES_MATRIX:
+		case spvOp_t::OUTER_PRODUCT:			Compiler_MatrixProduct( c, inst ); return;
+		case spvOp_t::DOT: {
+			const shaderValue_t * a = Compiler_Operand( c, inst[ 3 ] );
+			const shaderValue_t * b = Compiler_Operand( c, inst[ 4 ] );
+			Compiler_Define( c, inst[ 2 ], inst[ 1 ], Compiler_Dot( c, a->reg, 1, b->reg, 1, a->count ), 1 );
+			return;
+		}
+
+		case spvOp_t::ANY:						Compiler_Reduce( c, inst, shaderOp_t::OR ); return;
+		case spvOp_t::ALL:						Compiler_Reduce( c, inst, shaderOp_t::AND ); return;
+		case spvOp_t::IS_NAN:					Compiler_Elementwise( c, inst, 3, shaderOp_t::ISNAN, 1, false ); return;
+		case spvOp_t::IS_INF:					Compiler_Elementwise( c, inst, 3, shaderOp_t::ISINF, 1, false ); return;
+		case spvOp_t::LOGICAL_EQUAL:			Compiler_Elementwise( c, inst, 3, shaderOp_t::IEQ, 2, false ); return;
+		case spvOp_t::LOGICAL_NOT_EQUAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::INE, 2, false ); return;
+		case spvOp_t::LOGICAL_OR:				Compiler_Elementwise( c, inst, 3, shaderOp_t::OR, 2, false ); return;
+		case spvOp_t::LOGICAL_AND:				Compiler_Elementwise( c, inst, 3, shaderOp_t::AND, 2, false ); return;
+		case spvOp_t::LOGICAL_NOT:				Compiler_Elementwise( c, inst, 3, shaderOp_t::NOT, 1, false ); return;
+		case spvOp_t::SELECT:					Compiler_Select( c, inst ); return;
+		case spvOp_t::I_EQUAL:					Compiler_Elementwise( c, inst, 3, shaderOp_t::IEQ, 2, false ); return;
+		case spvOp_t::I_NOT_EQUAL:				Compiler_Elementwise( c, inst, 3, shaderOp_t::INE, 2, false ); return;
+		case spvOp_t::U_GREATER_THAN:			Compiler_Elementwise( c, inst, 3, shaderOp_t::ULT, 2, true ); return;
+		case spvOp_t::S_GREATER_THAN:			Compiler_Elementwise( c, inst, 3, shaderOp_t::SLT, 2, true ); return;
+		case spvOp_t::U_GREATER_THAN_EQUAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::ULE, 2, true ); return;
+		case spvOp_t::S_GREATER_THAN_EQUAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::SLE, 2, true ); return;
+		case spvOp_t::U_LESS_THAN:				Compiler_Elementwise( c, inst, 3, shaderOp_t::ULT, 2, false ); return;
+		case spvOp_t::S_LESS_THAN:				Compiler_Elementwise( c, inst, 3, shaderOp_t::SLT, 2, false ); return;
+		case spvOp_t::U_LESS_THAN_EQUAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::ULE, 2, false ); return;
+		case spvOp_t::S_LESS_THAN_EQUAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::SLE, 2, false ); return;
+		case spvOp_t::F_ORD_EQUAL:				Compiler_Elementwise( c, inst, 3, shaderOp_t::FORD_EQ, 2, false ); return;
+		case spvOp_t::F_UNORD_EQUAL:			Compiler_Elementwise( c, inst, 3, shaderOp_t::FUNORD_EQ, 2, false ); return;
+		case spvOp_t::F_ORD_NOT_EQUAL:			Compiler_Elementwise( c, inst, 3, shaderOp_t::FORD_NE, 2, false ); return;
+		case spvOp_t::F_UNORD_NOT_EQUAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::FUNORD_NE, 2, false ); return;
+		case spvOp_t::F_ORD_LESS_THAN:			Compiler_Elementwise( c, inst, 3, shaderOp_t::FORD_LT, 2, false ); return;
+		case spvOp_t::F_UNORD_LESS_THAN:		Compiler_Elementwise( c, inst, 3, shaderOp_t::FUNORD_LT, 2, false ); return;
+		case spvOp_t::F_ORD_GREATER_THAN:		Compiler_Elementwise( c, inst, 3, shaderOp_t::FORD_LT, 2, true ); return;
+		case spvOp_t::F_UNORD_GREATER_THAN:		Compiler_Elementwise( c, inst, 3, shaderOp_t::FUNORD_LT, 2, true ); return;
+		case spvOp_t::F_ORD_LESS_THAN_EQUAL:	Compiler_Elementwise( c, inst, 3, shaderOp_t::FORD_LE, 2, false ); return;
+		case spvOp_t::F_UNORD_LESS_THAN_EQUAL:	Compiler_Elementwise( c, inst, 3, shaderOp_t::FUNORD_LE, 2, false ); return;
+		case spvOp_t::F_ORD_GREATER_THAN_EQUAL:	Compiler_Elementwise( c, inst, 3, shaderOp_t::FORD_LE, 2, true ); return;
+		case spvOp_t::F_UNORD_GREATER_THAN_EQUAL:	Compiler_Elementwise( c, inst, 3, shaderOp_t::FUNORD_LE, 2, true ); return;
+		case spvOp_t::SHIFT_RIGHT_LOGICAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::SHR, 2, false ); return;
+		case spvOp_t::SHIFT_RIGHT_ARITHMETIC:	Compiler_Elementwise( c, inst, 3, shaderOp_t::SAR, 2, false ); return;
+		case spvOp_t::SHIFT_LEFT_LOGICAL:		Compiler_Elementwise( c, inst, 3, shaderOp_t::SHL, 2, false ); return;
+		case spvOp_t::BITWISE_OR:				Compiler_Elementwise( c, inst, 3, shaderOp_t::OR, 2, false ); return;
+		case spvOp_t::BITWISE_XOR:				Compiler_Elementwise( c, inst, 3, shaderOp_t::XOR, 2, false ); return;
+		case spvOp_t::BITWISE_AND:				Compiler_Elementwise( c, inst, 3, shaderOp_t::AND, 2, false ); return;
+		case spvOp_t::NOT:						Compiler_Elementwise( c, inst, 3, shaderOp_t::NOT, 1, false ); return;
+		case spvOp_t::BIT_COUNT:				Compiler_Elementwise( c, inst, 3, shaderOp_t::BIT_COUNT, 1, false ); return;
+
+		case spvOp_t::DPDX:
+		case spvOp_t::DPDX_FINE:				Compiler_Derivative( c, inst, shaderOp_t::DPDX_FINE, shaderOp_t::DPDY_FINE, false ); return;
+		case spvOp_t::DPDY:
+		case spvOp_t::DPDY_FINE:				Compiler_Derivative( c, inst, shaderOp_t::DPDY_FINE, shaderOp_t::DPDY_FINE, false ); return;
+		case spvOp_t::DPDX_COARSE:				Compiler_Derivative( c, inst, shaderOp_t::DPDX_COARSE, shaderOp_t::DPDY_COARSE, false ); return;
+		case spvOp_t::DPDY_COARSE:				Compiler_Derivative( c, inst, shaderOp_t::DPDY_COARSE, shaderOp_t::DPDY_COARSE, false ); return;
+		case spvOp_t::FWIDTH:
+		case spvOp_t::FWIDTH_FINE:				Compiler_Derivative( c, inst, shaderOp_t::DPDX_FINE, shaderOp_t::DPDY_FINE, true ); return;
+		case spvOp_t::FWIDTH_COARSE:			Compiler_Derivative( c, inst, shaderOp_t::DPDX_COARSE, shaderOp_t::DPDY_COARSE, true ); return;
+
+		case spvOp_t::SAMPLED_IMAGE:
+		case spvOp_t::IMAGE:					Compiler_SampledImage( c, inst ); return;
+		case spvOp_t::IMAGE_SAMPLE_IMPLICIT_LOD:
+		case spvOp_t::IMAGE_SAMPLE_EXPLICIT_LOD:
+		case spvOp_t::IMAGE_SAMPLE_DREF_IMPLICIT_LOD:
+		case spvOp_t::IMAGE_SAMPLE_DREF_EXPLICIT_LOD:
+		case spvOp_t::IMAGE_FETCH:				Compiler_Sample( c, inst ); return;
+
+		case spvOp_t::GROUP_NON_UNIFORM_ELECT:
+		case spvOp_t::GROUP_NON_UNIFORM_ALL:
+		case spvOp_t::GROUP_NON_UNIFORM_ANY:
+		case spvOp_t::GROUP_NON_UNIFORM_ALL_EQUAL:
+		case spvOp_t::GROUP_NON_UNIFORM_BROADCAST:
+		case spvOp_t::GROUP_NON_UNIFORM_BROADCAST_FIRST:
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT:
+		case spvOp_t::GROUP_NON_UNIFORM_INVERSE_BALLOT:
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_BIT_EXTRACT:
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_BIT_COUNT:
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_FIND_LSB:
+		case spvOp_t::GROUP_NON_UNIFORM_BALLOT_FIND_MSB:
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE:
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE_XOR:
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE_UP:
+		case spvOp_t::GROUP_NON_UNIFORM_SHUFFLE_DOWN:
+		case spvOp_t::GROUP_NON_UNIFORM_I_ADD:
+		case spvOp_t::GROUP_NON_UNIFORM_F_ADD:
+		case spvOp_t::GROUP_NON_UNIFORM_I_MUL:
+		case spvOp_t::GROUP_NON_UNIFORM_F_MUL:
+		case spvOp_t::GROUP_NON_UNIFORM_S_MIN:
+		case spvOp_t::GROUP_NON_UNIFORM_U_MIN:
+		case spvOp_t::GROUP_NON_UNIFORM_F_MIN:
+		case spvOp_t::GROUP_NON_UNIFORM_S_MAX:
+		case spvOp_t::GROUP_NON_UNIFORM_U_MAX:
+		case spvOp_t::GROUP_NON_UNIFORM_F_MAX:
+		case spvOp_t::GROUP_NON_UNIFORM_BITWISE_AND:
+		case spvOp_t::GROUP_NON_UNIFORM_BITWISE_OR:
+		case spvOp_t::GROUP_NON_UNIFORM_BITWISE_XOR:
+		case spvOp_t::GROUP_NON_UNIFORM_LOGICAL_AND:
+		case spvOp_t::GROUP_NON_UNIFORM_LOGICAL_OR:
+		case spvOp_t::GROUP_NON_UNIFORM_LOGICAL_XOR:	Compiler_Subgroup( c, inst ); return;
+
+		case spvOp_t::CONTROL_BARRIER: {
+			//A workgroup that fits in one lane batch reaches every barrier together, as do the lanes of a subgroup
+			const shaderValue_t * scope = Compiler_Operand( c, inst[ 1 ] );
+			const bool workgroupScope = !Compiler_IsConstant( scope->reg ) || Compiler_ConstantValue( c, scope->reg ) <= ( uint32 )spvScope_t::WORKGROUP;
+			if ( workgroupScope && c->stage == VK_SHADER_STAGE_COMPUTE_BIT && c->localSize[ 0 ] * c->localSize[ 1 ] * c->localSize[ 2 ] > SHADER_LANES ) {
+				Compiler_Emit( c, shaderOp_t::BARRIER, SHADER_NO_REGISTER );
+				c->flags |= SHADER_PROGRAM_USES_BARRIERS;
+			}
+			return;
+		}
+		default:
+			Compiler_Fail( c, "unsupported instruction", ( uint32 )op );
+			return;
+	}
+}
+
+/*
+================================================
+Control flow
+
+Blocks are emitted in structured order starting from a function's first label.  Each region runs
+until it reaches its stop label: the merge of the enclosing selection, the continue target of the
+enclosing loop body, or the loop header for a continue construct.  Branches to the merge of an
+enclosing loop or switch become BREAK, branches to a loop's continue target become CONTINUE, and phis
+become masked copies on the incoming edges.  Emission returns the label to carry on from, or 0 once
+every path has left the region.
+================================================
+*/
+static bool Compiler_IsTerminator( spvOp_t op ) {
+	switch ( op ) {
+		case spvOp_t::BRANCH:
+		case spvOp_t::BRANCH_CONDITIONAL:
+		case spvOp_t::SWITCH:
+		case spvOp_t::KILL:
+		case spvOp_t::RETURN:
+		case spvOp_t::RETURN_VALUE:
+		case spvOp_t::UNREACHABLE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+//The first instruction after a label, or NULL when the id is not a label
+static const uint32 * Compiler_BlockStart( shaderCompiler_t * c, uint32 label ) {
+	const uint32 * inst = Compiler_Instruction( c, label );
+	if ( inst == NULL || Spv_Op( inst ) != spvOp_t::LABEL ) {
+		Compiler_Fail( c, "branch to a non-label", label );
+		return NULL;
+	}
+	return inst + Spv_WordCount( inst );
+}
+
+//Next instruction of a block, NULL past the end of the block
+static const uint32 * Compiler_NextInBlock( shaderCompiler_t * c, const uint32 * inst ) {
+	if ( Compiler_IsTerminator( Spv_Op( inst ) ) ) {
+		return NULL;
+	}
+	const uint32 * next = inst + Spv_WordCount( inst );
+	if ( next >= c->module->pWords + c->module->wordCount || Spv_Op( next ) == spvOp_t::LABEL || Spv_Op( next ) == spvOp_t::FUNCTION_END ) {
+		Compiler_Fail( c, "block without a terminator", ( uint32 )( inst - c->module->pWords ) );
+		return NULL;
+	}
+	return next;
+}
+
+static const uint32 * Compiler_LoopMerge( shaderCompiler_t * c, uint32 label ) {
+	for ( const uint32 * inst = Compiler_BlockStart( c, label ); inst != NULL; inst = Compiler_NextInBlock( c, inst ) ) {
+		if ( Spv_Op( inst ) == spvOp_t::LOOP_MERGE ) {
+			return inst;
+		}
+	}
+	return NULL;
+}
+
+//Phi registers are allocated by whichever comes first, the block or one of its incoming edges
+static const shaderValue_t * Compiler_PhiValue( shaderCompiler_t * c, const uint32 * phi ) {
+	const uint32 id = phi[ 2 ];
+	if ( id == 0 || id >= c->module->bound ) {
+		Compiler_Fail( c, "id out of range", id );
+		return &c->nullValue;
+	}
+	if ( c->pValues[ id ].kind == shaderValueKind_t::NONE ) {
+		const uint32 count = Compiler_RegisterCount( c, phi[ 1 ] );
+		Compiler_Define( c, id, phi[ 1 ], Compiler_Allocate( c, count ), count );
+	}
+	return &c->pValues[ id ];
+}
+
+static uint32 Compiler_PhiSource( shaderCompiler_t * c, const uint32 * phi, uint32 from ) {
+	for ( uint32 k = 3; k + 1 < Spv_WordCount( phi ); k += 2 ) {
+		if ( phi[ k + 1 ] == from ) {
+			return phi[ k ];
+		}
+	}
+	Compiler_Fail( c, "phi without a value for an incoming edge", phi[ 2 ] );
+	return 0;
+}
+
+//Phis, and the debug lines allowed between them, lead a block
+static bool Compiler_IsPhiSection( const uint32 * inst ) {
+	const spvOp_t op = Spv_Op( inst );
+	return op == spvOp_t::PHI || op == spvOp_t::LINE || op == spvOp_t::NO_LINE;
+}
+
+static uint32 Compiler_Continue( shaderCompiler_t * c, uint32 to, uint32 stop ) {
+	if ( to == stop ) {
+		return stop;
+	}
+	uint32 depth = 0;
+	for ( uint32 i = c->constructs.count; i-- > 0; depth++ ) {
+		const shaderConstruct_t & construct = c->constructs.pData[ i ];
+		if ( construct.merge == to ) {
+			Compiler_Emit( c, shaderOp_t::BREAK, SHADER_NO_REGISTER, depth );
+			return 0;
+		}
+		if ( construct.kind == shaderConstructKind_t::LOOP && construct.continueTarget == to ) {
+			Compiler_Emit( c, shaderOp_t::CONTINUE, SHADER_NO_REGISTER, depth );
+			return 0;
+		}
+	}
+	return to;
+}
+
+static uint32 Compiler_EmitEdge( shaderCompiler_t * c, uint32 from, uint32 to, uint32 stop ) {
+	const uint32 * first = Compiler_BlockStart( c, to );
+	//Copies go through temporaries when one phi feeds another of the same block, as in a swap
+	bool overlap = false;
+	for ( const uint32 * phi = first; phi != NULL && Compiler_IsPhiSection( phi ); phi = Compiler_NextInBlock( c, phi ) ) {
+		if ( Spv_Op( phi ) != spvOp_t::PHI ) {
+			continue;
+		}
+		const uint32 source = Compiler_PhiSource( c, phi, from );
+		for ( const uint32 * other = first; other != NULL && Compiler_IsPhiSection( other ); other = Compiler_NextInBlock( c, other ) ) {
+			overlap |= Spv_Op( other ) == spvOp_t::PHI && other[ 2 ] == source;
+		}
+	}
+	const uint32 temporaries = c->registerCount;
+	if ( overlap ) {
+		for ( const uint32 * phi = first; phi != NULL && Compiler_IsPhiSection( phi ); phi = Compiler_NextInBlock( c, phi ) ) {
+			if ( Spv_Op( phi ) == spvOp_t::PHI ) {
+				const shaderValue_t * source = Compiler_Operand( c, Compiler_PhiSource( c, phi, from ) );
+				const uint32 temporary = Compiler_Allocate( c, source->count );
+				for ( uint32 i = 0; i < source->count; i++ ) {
+					Compiler_Emit( c, shaderOp_t::MOV, temporary + i, source->reg + i );
+				}
+			}
+		}
+	}
+	uint32 next = temporaries;
+	for ( const uint32 * phi = first; phi != NULL && Compiler_IsPhiSection( phi ) && !c->failed; phi = Compiler_NextInBlock( c, phi ) ) {
+		if ( Spv_Op( phi ) != spvOp_t::PHI ) {
+			continue;
+		}
+		const shaderValue_t * target = Compiler_PhiValue( c, phi );
+		uint32 source = next;
+		if ( !overlap ) {
+			source = Compiler_Operand( c, Compiler_PhiSource( c, phi, from ) )->reg;
+		}
+		for ( uint32 i = 0; i < target->count; i++ ) {
+			Compiler_EmitMasked( c, shaderOp_t::MOV, target->reg + i, source + i );
+		}
+		next += target->count;
+	}
+	return Compiler_Continue( c, to, stop );
+}
+
+static uint32 Compiler_EmitRegion( shaderCompiler_t * c, uint32 label, uint32 stop );
+
+static uint32 Compiler_EmitConditional( shaderCompiler_t * c, uint32 label, const uint32 * inst, uint32 merge, uint32 stop ) {
+	const uint32 condition = Compiler_Operand( c, inst[ 1 ] )->reg;
+	const uint32 ifIndex = Compiler_Emit( c, shaderOp_t::IF, SHADER_NO_REGISTER, condition );
+	Compiler_PushFrame( c );
+	uint32 taken = Compiler_EmitEdge( c, label, inst[ 2 ], merge != 0 ? merge : stop );
+	if ( merge != 0 ) {
+		Compiler_EmitRegion( c, taken, merge );
+	}
+	const uint32 elseIndex = Compiler_Emit( c, shaderOp_t::ELSE, SHADER_NO_REGISTER );
+	uint32 notTaken = Compiler_EmitEdge( c, label, inst[ 3 ], merge != 0 ? merge : stop );
+	if ( merge != 0 ) {
+		Compiler_EmitRegion( c, notTaken, merge );
+	}
+	const uint32 endIndex = Compiler_Emit( c, shaderOp_t::ENDIF, SHADER_NO_REGISTER );
+	Compiler_PopFrame( c );
+	if ( c->failed ) {
+		return 0;
+	}
+	c->instructions.pData[ ifIndex ].src[ 1 ] = elseIndex;
+	c->instructions.pData[ ifIndex ].src[ 2 ] = endIndex;
+	c->instructions.pData[ elseIndex ].src[ 1 ] = endIndex;
+	if ( merge != 0 ) {
+		return Compiler_Continue( c, merge, stop );
+	}
+	//Without a merge one side must leave the construct, as a conditional break or continue does
+	if ( taken == 0 || taken == notTaken ) {
+		return notTaken;
+	}
+	if ( notTaken == 0 ) {
+		return taken;
+	}
+	Compiler_Fail( c, "unstructured conditional branch", label );
+	return 0;
+}
+
+static uint32 Compiler_EmitSwitch( shaderCompiler_t * c, uint32 label, const uint32 * inst, uint32 merge, uint32 stop ) {
+	if ( merge == 0 ) {
+		Compiler_Fail( c, "switch without a merge", label );
+		return 0;
+	}
+	const uint32 selector = Compiler_Operand( c, inst[ 1 ] )->reg;
+	const uint32 length = Spv_WordCount( inst );
+	const uint32 beginIndex = Compiler_Emit( c, shaderOp_t::SWITCH_BEGIN, SHADER_NO_REGISTER );
+	Compiler_PushFrame( c );
+	shaderConstruct_t * construct = Compiler_Push( c, &c->constructs );
+	construct->kind = shaderConstructKind_t::SWITCH;
+	construct->merge = merge;
+	//Each distinct target runs once under the lanes selecting it; fall-through re-emits the next case
+	for ( uint32 k = 2; k < length && !c->failed; k += 2 ) {
+		const uint32 target = inst[ k ];
+		bool seen = false;
+		for ( uint32 j = 2; j < k; j += 2 ) {
+			seen |= inst[ j ] == target;
+		}
+		if ( seen ) {
+			continue;
+		}
+		uint32 condition = SHADER_NO_REGISTER;
+		for ( uint32 j = 3; j + 1 < length; j += 2 ) {
+			if ( inst[ j + 1 ] == target ) {
+				const uint32 equal = Compiler_Op( c, shaderOp_t::IEQ, selector, Compiler_Constant( c, inst[ j ] ) );
+				condition = ( condition == SHADER_NO_REGISTER ) ? equal : Compiler_Op( c, shaderOp_t::OR, condition, equal );
+			}
+		}
+		if ( target == inst[ 2 ] ) {
+			uint32 other = Compiler_Constant( c, ~0u );
+			for ( uint32 j = 3; j + 1 < length; j += 2 ) {
+				other = Compiler_Op( c, shaderOp_t::AND, other, Compiler_Op( c, shaderOp_t::INE, selector, Compiler_Constant( c, inst[ j ] ) ) );
+			}
+			condition = ( condition == SHADER_NO_REGISTER ) ? other : Compiler_Op( c, shaderOp_t::OR, condition, other );
+		}
+		const uint32 ifIndex = Compiler_Emit( c, shaderOp_t::IF, SHADER_NO_REGISTER, condition );
+		Compiler_PushFrame( c );
+		Compiler_EmitRegion( c, Compiler_EmitEdge( c, label, target, merge ), merge );
+		const uint32 endIndex = Compiler_Emit( c, shaderOp_t::ENDIF, SHADER_NO_REGISTER );
+		Compiler_PopFrame( c );
+		if ( !c->failed ) {
+			c->instructions.pData[ ifIndex ].src[ 1 ] = endIndex;
+			c->instructions.pData[ ifIndex ].src[ 2 ] = endIndex;
+		}
+	}
+	const uint32 endIndex = Compiler_Emit( c, shaderOp_t::SWITCH_END, SHADER_NO_REGISTER );
+	Compiler_PopFrame( c );
+	if ( c->failed ) {
+		return 0;
+	}
+	c->constructs.count--;
+	c->instructions.pData[ beginIndex ].src[ 1 ] = endIndex;
+	return Compiler_Continue( c, merge, stop );
+}
+
+static uint32 Compiler_EmitBlock( shaderCompiler_t * c, uint32 label, uint32 stop ) {
+	uint32 selectionMerge = 0;
+	for ( const uint32 * inst = Compiler_BlockStart( c, label ); inst != NULL && !c->failed; inst = Compiler_NextInBlock( c, inst ) ) {
+		switch ( Spv_Op( inst ) ) {
+			case spvOp_t::PHI:
+				Compiler_PhiValue( c, inst );
+				break;
+			case spvOp_t::SELECTION_MERGE:
+				selectionMerge = inst[ 1 ];
+				break;
+			case spvOp_t::LOOP_MERGE:
+				break;
+			case spvOp_t::BRANCH:
+				return Compiler_EmitEdge( c, label, inst[ 1 ], stop );
+			case spvOp_t::BRANCH_CONDITIONAL:
+				return Compiler_EmitConditional( c, label, inst, selectionMerge, stop );
+			case spvOp_t::SWITCH:
+				return Compiler_EmitSwitch( c, label, inst, selectionMerge, stop );
+			case spvOp_t::RETURN_VALUE:
+				if ( c->returnRegister != SHADER_NO_REGISTER ) {
+					const shaderValue_t * value = Compiler_Operand( c, inst[ 1 ] );
+					for ( uint32 i = 0; i < value->count; i++ ) {
+						Compiler_EmitMasked( c, shaderOp_t::MOV, c->returnRegister + i, value->reg + i );
+					}
+				}
+				Compiler_Emit( c, shaderOp_t::RETURN, SHADER_NO_REGISTER );
+				return 0;
+			case spvOp_t::RETURN:
+				Compiler_Emit( c, shaderOp_t::RETURN, SHADER_NO_REGISTER );
+				return 0;
+			case spvOp_t::KILL:
+				if ( c->stage != VK_SHADER_STAGE_FRAGMENT_BIT ) {
+					Compiler_Fail( c, "OpKill outside a fragment shader", label );
+					return 0;
+				}
+				c->flags |= SHADER_PROGRAM_USES_KILL;
+				Compiler_Emit( c, shaderOp_t::KILL, SHADER_NO_REGISTER );
+				return 0;
+			case spvOp_t::UNREACHABLE:
+				return 0;
+			default:
+				Compiler_LowerInstruction( c, inst );
+				break;
+		}
+	}
+	return 0;
+}
+
+static uint32 Compiler_EmitLoop( shaderCompiler_t * c, uint32 header, uint32 stop ) {
+	const uint32 * loopMerge = Compiler_LoopMerge( c, header );
+	const uint32 merge = loopMerge[ 1 ];
+	const uint32 continueTarget = loopMerge[ 2 ];
+	const uint32 beginIndex = Compiler_Emit( c, shaderOp_t::LOOP_BEGIN, SHADER_NO_REGISTER );
+	Compiler_PushFrame( c );
+	c->loopDepth++;
+	shaderConstruct_t * construct = Compiler_Push( c, &c->constructs );
+	construct->kind = shaderConstructKind_t::LOOP;
+	construct->merge = merge;
+	construct->continueTarget = continueTarget;
+
+	Compiler_EmitRegion( c, Compiler_EmitBlock( c, header, continueTarget ), continueTarget );
+	Compiler_Emit( c, shaderOp_t::CONTINUE_TARGET, SHADER_NO_REGISTER );
+	if ( continueTarget != header ) {
+		Compiler_EmitRegion( c, continueTarget, header );
+	}
+	const uint32 endIndex = Compiler_Emit( c, shaderOp_t::LOOP_END, SHADER_NO_REGISTER, beginIndex + 1 );
+
+	c->loopDepth--;
+	Compiler_PopFrame( c );
+	if ( c->failed ) {
+		return 0;
+	}
+	c->constructs.count--;
+	c->instructions.pData[ beginIndex ].src[ 1 ] = endIndex;
+	return Compiler_Continue( c, merge, stop );
+}
+
+static uint32 Compiler_EmitRegion( shaderCompiler_t * c, uint32 label, uint32 stop ) {
+	while ( label != 0 && label != stop && !c->failed ) {
+		if ( Compiler_LoopMerge( c, label ) != NULL ) {
+			label = Compiler_EmitLoop( c, label, stop );
+		} else {
+			label = Compiler_EmitBlock( c, label, stop );
+		}
+	}
+	return c->failed ? 0 : label;
+}
+
+/*
+================================================
+Functions
+================================================
+*/
+
+//Clears the values of every id the function defines, returning its first label and binding its parameters
+static uint32 Compiler_EnterFunction( shaderCompiler_t * c, uint32 function, const uint32 * pArguments, uint32 argumentCount ) {
+	const uint32 * inst = Compiler_Instruction( c, function );
+	if ( inst == NULL || Spv_Op( inst ) != spvOp_t::FUNCTION ) {
+		Compiler_Fail( c, "call to a non-function", function );
+		return 0;
+	}
+	const uint32 * end = c->module->pWords + c->module->wordCount;
+	uint32 firstLabel = 0;
+	uint32 parameter = 0;
+	for ( const uint32 * next = inst + Spv_WordCount( inst ); next < end && Spv_Op( next ) != spvOp_t::FUNCTION_END; next += Spv_WordCount( next ) ) {
+		const uint32 resultIndex = Spv_ResultIndex( Spv_Op( next ) );
+		if ( resultIndex != 0 && resultIndex < Spv_WordCount( next ) ) {
+			memset( &c->pValues[ next[ resultIndex ] ], 0, sizeof( shaderValue_t ) );
+		}
+		if ( Spv_Op( next ) == spvOp_t::FUNCTION_PARAMETER ) {
+			if ( parameter >= argumentCount ) {
+				Compiler_Fail( c, "too few arguments", function );
+				return 0;
+			}
+			c->pValues[ next[ 2 ] ] = *Compiler_Value( c, pArguments[ parameter++ ] );
+		} else if ( Spv_Op( next ) == spvOp_t::LABEL && firstLabel == 0 ) {
+			firstLabel = next[ 1 ];
+		}
+	}
+	if ( firstLabel == 0 || parameter != argumentCount ) {
+		Compiler_Fail( c, "malformed function", function );
+		return 0;
+	}
+	return firstLabel;
+}
+
+//Calls are inlined inside a frame of their own, so OpReturn only retires the lanes of this call
+static void Compiler_Call( shaderCompiler_t * c, const uint32 * inst ) {
+	const uint32 type = inst[ 1 ];
+	const uint32 count = Compiler_IsVoid( c, type ) ? 0 : Compiler_RegisterCount( c, type );
+	const uint32 result = ( count != 0 ) ? Compiler_Allocate( c, count ) : SHADER_NO_REGISTER;
+	const uint32 firstLabel = Compiler_EnterFunction( c, inst[ 3 ], inst + 4, Spv_WordCount( inst ) - 4 );
+	const uint32 savedReturn = c->returnRegister;
+	c->returnRegister = result;
+	Compiler_Emit( c, shaderOp_t::CALL_BEGIN, SHADER_NO_REGISTER );
+	Compiler_PushFrame( c );
+	Compiler_EmitRegion( c, firstLabel, 0 );
+	Compiler_Emit( c, shaderOp_t::CALL_END, SHADER_NO_REGISTER );
+	Compiler_PopFrame( c );
+	c->returnRegister = savedReturn;
+	if ( count != 0 ) {
+		Compiler_Define( c, inst[ 2 ], type, result, count );
+	}
+}
+
+/*
+================================================
+Programs
+================================================
+*/
+//Constants move to the bottom of the register file, everything else above them
+static uint32 Compiler_Remap( const shaderCompiler_t * c, uint32 reg ) {
+	if ( reg == SHADER_NO_REGISTER ) {
+		return reg;
+	}
+	if ( ( reg & SHADER_CONSTANT_TAG ) != 0 ) {
+		return reg & ~SHADER_CONSTANT_TAG;
+	}
+	return reg + c->constants.count;
+}
+
+static void Compiler_Finalize( shaderCompiler_t * c ) {
+	if ( c->constants.count + c->registerCount > SHADER_MAX_REGISTERS ) {
+		Compiler_Fail( c, "register file exhausted", c->constants.count + c->registerCount );
+		return;
+	}
+	for ( uint32 i = 0; i < c->instructions.count; i++ ) {
+		shaderInstruction_t & inst = c->instructions.pData[ i ];
+		if ( inst.op < shaderOp_t::LOAD_INDEXED ) {
+			inst.dst = Compiler_Remap( c, inst.dst );
+			for ( uint32 k = 0; k < 3; k++ ) {
+				inst.src[ k ] = Compiler_Remap( c, inst.src[ k ] );
+			}
+			continue;
+		}
+		switch ( inst.op ) {
+			case shaderOp_t::LOAD_INDEXED:
+			case shaderOp_t::STORE_INDEXED:
+				inst.dst = Compiler_Remap( c, inst.dst );
+				inst.src[ 0 ] = Compiler_Remap( c, inst.src[ 0 ] );
+				inst.src[ 1 ] = Compiler_Remap( c, inst.src[ 1 ] );
+				break;
+			case shaderOp_t::LOAD_BUFFER:
+			case shaderOp_t::SAMPLE:
+			case shaderOp_t::SUBGROUP_BUILTIN:
+			case shaderOp_t::SUBGROUP_ELECT:
+				inst.dst = Compiler_Remap( c, inst.dst );
+				break;
+			case shaderOp_t::SUBGROUP_ALL:
+			case shaderOp_t::SUBGROUP_ANY:
+			case shaderOp_t::SUBGROUP_ALL_EQUAL:
+			case shaderOp_t::SUBGROUP_BALLOT:
+			case shaderOp_t::SUBGROUP_INVERSE_BALLOT:
+			case shaderOp_t::SUBGROUP_BROADCAST_FIRST:
+			case shaderOp_t::SUBGROUP_REDUCE:
+			case shaderOp_t::SUBGROUP_INCLUSIVE_SCAN:
+			case shaderOp_t::SUBGROUP_EXCLUSIVE_SCAN:
+				inst.dst = Compiler_Remap( c, inst.dst );
+				inst.src[ 0 ] = Compiler_Remap( c, inst.src[ 0 ] );
+				break;
+			case shaderOp_t::SUBGROUP_SHUFFLE:
+			case shaderOp_t::SUBGROUP_SHUFFLE_XOR:
+			case shaderOp_t::SUBGROUP_SHUFFLE_UP:
+			case shaderOp_t::SUBGROUP_SHUFFLE_DOWN:
+				inst.dst = Compiler_Remap( c, inst.dst );
+				inst.src[ 0 ] = Compiler_Remap( c, inst.src[ 0 ] );
+				inst.src[ 1 ] = Compiler_Remap( c, inst.src[ 1 ] );
+				break;
+			case shaderOp_t::STORE_BUFFER:
+				inst.src[ 1 ] = Compiler_Remap( c, inst.src[ 1 ] );
+				break;
+			case shaderOp_t::IF:
+				inst.src[ 0 ] = Compiler_Remap( c, inst.src[ 0 ] );
+				break;
+			default:
+				break;
+		}
+	}
+	for ( uint32 i = 0; i < c->bufferAccesses.count; i++ ) {
+		shaderBufferAccess_t & access = c->bufferAccesses.pData[ i ];
+		access.elementRegister = Compiler_Remap( c, access.elementRegister );
+		access.offsetRegister = Compiler_Remap( c, access.offsetRegister );
+	}
+	for ( uint32 i = 0; i < c->sampleOps.count; i++ ) {
+		shaderSampleOp_t & sample = c->sampleOps.pData[ i ];
+		sample.imageElementRegister = Compiler_Remap( c, sample.imageElementRegister );
+		sample.samplerElementRegister = Compiler_Remap( c, sample.samplerElementRegister );
+		sample.coordinateRegister = Compiler_Remap( c, sample.coordinateRegister );
+		sample.lodRegister = Compiler_Remap( c, sample.lodRegister );
+		sample.drefRegister = Compiler_Remap( c, sample.drefRegister );
+		sample.gradientRegister = Compiler_Remap( c, sample.gradientRegister );
+		sample.offsetRegister = Compiler_Remap( c, sample.offsetRegister );
+	}
+	for ( uint32 i = 0; i < c->inputs.count; i++ ) {
+		c->inputs.pData[ i ].reg = Compiler_Remap( c, c->inputs.pData[ i ].reg );
+	}
+	for ( uint32 i = 0; i < c->outputs.count; i++ ) {
+		c->outputs.pData[ i ].reg = Compiler_Remap( c, c->outputs.pData[ i ].reg );
+	}
+}
+
+static bool Compiler_FindEntryPoint( shaderCompiler_t * c, const char * pEntryName ) {
+	spvExecutionModel_t model;
+	switch ( c->stage ) {
+		case VK_SHADER_STAGE_VERTEX_BIT:	model = spvExecutionModel_t::VERTEX; break;
+		case VK_SHADER_STAGE_FRAGMENT_BIT:	model = spvExecutionModel_t::FRAGMENT; break;
+		case VK_SHADER_STAGE_COMPUTE_BIT:	model = spvExecutionModel_t::GL_COMPUTE; break;
+		default:
+			Compiler_Fail( c, "unsupported stage", c->stage );
+			return false;
+	}
+	for ( uint32 i = 0; i < c->module->entryPointCount; i++ ) {
+		const shaderEntryPoint_t * entryPoint = &c->module->pEntryPoints[ i ];
+		if ( entryPoint->model == model && strcmp( reinterpret_cast< const char * >( c->module->pWords + entryPoint->nameOffset ), pEntryName ) == 0 ) {
+			c->entryPoint = entryPoint;
+			return true;
+		}
+	}
+	Compiler_Fail( c, "entry point not found", c->stage );
+	return false;
+}
+
+//Execution modes, then every module-scope variable, which all come before the first function
+static void Compiler_DeclareGlobals( shaderCompiler_t * c ) {
+	const uint32 * end = c->module->pWords + c->module->wordCount;
+	for ( const uint32 * inst = c->module->pWords + SPV_HEADER_WORDS; inst < end && !c->failed; inst += Spv_WordCount( inst ) ) {
+		const spvOp_t op = Spv_Op( inst );
+		if ( op == spvOp_t::FUNCTION ) {
+			break;
+		}
+		if ( op == spvOp_t::EXECUTION_MODE && Spv_WordCount( inst ) >= 3 && inst[ 1 ] == c->entryPoint->function ) {
+			switch ( ( spvExecutionMode_t )inst[ 2 ] ) {
+				case spvExecutionMode_t::ORIGIN_UPPER_LEFT:		c->flags |= SHADER_PROGRAM_ORIGIN_UPPER_LEFT; break;
+				case spvExecutionMode_t::EARLY_FRAGMENT_TESTS:	c->flags |= SHADER_PROGRAM_EARLY_FRAGMENT_TESTS; break;
+				case spvExecutionMode_t::DEPTH_REPLACING:		c->flags |= SHADER_PROGRAM_DEPTH_REPLACING; break;
+				case spvExecutionMode_t::LOCAL_SIZE:
+					if ( Spv_WordCount( inst ) >= 6 ) {
+						c->localSize[ 0 ] = inst[ 3 ];
+						c->localSize[ 1 ] = inst[ 4 ];
+						c->localSize[ 2 ] = inst[ 5 ];
+						if ( ( uint64 )inst[ 3 ] * inst[ 4 ] * inst[ 5 ] > SHADER_MAX_WORKGROUP_INVOCATIONS ) {
+							Compiler_Fail( c, "workgroup too large", inst[ 3 ] * inst[ 4 ] * inst[ 5 ] );
+						}
+					}
+					break;
+				default:
+					break;
+			}
+		} else if ( op == spvOp_t::VARIABLE && Spv_WordCount( inst ) >= 4 && ( spvStorageClass_t )inst[ 3 ] != spvStorageClass_t::FUNCTION ) {
+			Compiler_DeclareVariable( c, inst[ 2 ], inst );
+		}
+	}
+}
+
+static void Compiler_Free( shaderCompiler_t * c ) {
+	c->allocator->pfnFree( c->allocator->pUserData, c->pValues );
+	c->allocator->pfnFree( c->allocator->pUserData, c->pConstantTable );
+	Compiler_FreeList( c, &c->constructs );
+	Compiler_FreeList( c, &c->instructions );
+	Compiler_FreeList( c, &c->constants );
+	Compiler_FreeList( c, &c->inputs );
+	Compiler_FreeList( c, &c->outputs );
+	Compiler_FreeList( c, &c->bindings );
+	Compiler_FreeList( c, &c->bufferAccesses );
+	Compiler_FreeList( c, &c->sampleOps );
+}
+
+bool ShaderProgram_Build( shaderProgram_t * program, const shaderModule_t * module, VkShaderStageFlagBits stage, const char * pEntryName, const VkSpecializationInfo * pSpecializationInfo, const VkAllocationCallbacks * allocator ) {
+	memset( program, 0, sizeof( shaderProgram_t ) );
+	shaderCompiler_t compiler;
+	memset( &compiler, 0, sizeof( compiler ) );
+	shaderCompiler_t * c = &compiler;
+	c->module = module;
+	c->allocator = allocator;
+	c->specialization = pSpecializationInfo;
+	c->stage = stage;
+	c->localSize[ 0 ] = 1;
+	c->localSize[ 1 ] = 1;
+	c->localSize[ 2 ] = 1;
+	c->returnRegister = SHADER_NO_REGISTER;
+	c->frameDepth = 1;
+	c->maxFrameDepth = 1;
+	c->nullValue.reg = 0;
+	c->nullValue.count = 1;
+	c->pValues = reinterpret_cast< shaderValue_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( shaderValue_t ) * module->bound, 64, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ) );
+	if ( c->pValues == NULL ) {
+		Compiler_Fail( c, "out of memory", module->bound );
+	} else {
+		memset( c->pValues, 0, sizeof( shaderValue_t ) * module->bound );
+	}
+
+	if ( !c->failed && Compiler_FindEntryPoint( c, pEntryName ) ) {
+		Compiler_DeclareGlobals( c );
+		const uint32 firstLabel = Compiler_EnterFunction( c, c->entryPoint->function, NULL, 0 );
+		Compiler_EmitRegion( c, firstLabel, 0 );
+		Compiler_Finalize( c );
+	}
+	if ( c->failed ) {
+		Compiler_Free( c );
+		return false;
+	}
+
+	program->allocator = allocator;
+	program->stage = stage;
+	program->flags = c->flags;
+	program->localSize[ 0 ] = c->localSize[ 0 ];
+	program->localSize[ 1 ] = c->localSize[ 1 ];
+	program->localSize[ 2 ] = c->localSize[ 2 ];
+	program->pInstructions = c->instructions.pData;
+	program->instructionCount = c->instructions.count;
+	program->pConstants = c->constants.pData;
+	program->constantCount = c->constants.count;
+	program->registerCount = c->constants.count + c->registerCount;
+	program->frameDepth = c->maxFrameDepth;
+	program->workgroupMemorySize = c->workgroupMemorySize;
+	program->pInputs = c->inputs.pData;
+	program->inputCount = c->inputs.count;
+	program->pOutputs = c->outputs.pData;
+	program->outputCount = c->outputs.count;
+	program->pBindings = c->bindings.pData;
+	program->bindingCount = c->bindings.count;
+	program->pBufferAccesses = c->bufferAccesses.pData;
+	program->bufferAccessCount = c->bufferAccesses.count;
+	program->pSampleOps = c->sampleOps.pData;
+	program->sampleOpCount = c->sampleOps.count;
+	//The program owns the lists now
+	c->instructions.pData = NULL;
+	c->constants.pData = NULL;
+	c->inputs.pData = NULL;
+	c->outputs.pData = NULL;
+	c->bindings.pData = NULL;
+	c->bufferAccesses.pData = NULL;
+	c->sampleOps.pData = NULL;
+	Compiler_Free( c );
+	return true;
+}
+
+void ShaderProgram_Destroy( shaderProgram_t * program ) {
+	const VkAllocationCallbacks * allocator = program->allocator;
+	if ( allocator == NULL ) {
+		return;
+	}
+	allocator->pfnFree( allocator->pUserData, program->pInstructions );
+	allocator->pfnFree( allocator->pUserData, program->pConstants );
+	allocator->pfnFree( allocator->pUserData, program->pInputs );
+	allocator->pfnFree( allocator->pUserData, program->pOutputs );
+	allocator->pfnFree( allocator->pUserData, program->pBindings );
+	allocator->pfnFree( allocator->pUserData, program->pBufferAccesses );
+	allocator->pfnFree( allocator->pUserData, program->pSampleOps );
+	memset( program, 0, sizeof( shaderProgram_t ) );
+}
+
+static uint32 Program_FindInterface( const shaderInterface_t * pInterface, uint32 count, uint32 builtIn, uint32 location, uint32 component ) {
+	for ( uint32 i = 0; i < count; i++ ) {
+		if ( pInterface[ i ].builtIn == builtIn && ( builtIn != SHADER_NO_BUILTIN || pInterface[ i ].location == location ) && pInterface[ i ].component == component ) {
+			return pInterface[ i ].reg;
+		}
+	}
+	return SHADER_NO_REGISTER;
+}
+
+uint32 ShaderProgram_FindBuiltIn( const shaderProgram_t * program, bool output, spvBuiltIn_t builtIn, uint32 component ) {
+	if ( output ) {
+		return Program_FindInterface( program->pOutputs, program->outputCount, ( uint32 )builtIn, 0, component );
+	}
+	return Program_FindInterface( program->pInputs, program->inputCount, ( uint32 )builtIn, 0, component );
+}
+
+uint32 ShaderProgram_FindLocation( const shaderProgram_t * program, bool output, uint32 location, uint32 component ) {
+	if ( output ) {
+		return Program_FindInterface( program->pOutputs, program->outputCount, SHADER_NO_BUILTIN, location, component );
+	}
+	return Program_FindInterface( program->pInputs, program->inputCount, SHADER_NO_BUILTIN, location, component );
+}
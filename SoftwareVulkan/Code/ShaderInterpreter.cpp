@@ -0,0 +1,732 @@
+#include "Shader.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#define SHADER_LANE_LOOP( statement ) for ( uint32 l = 0; l < SHADER_LANES; l++ ) { statement; }
+
+enum class shaderFrameKind_t : uint32 {
+	FUNCTION,
+	IF,
+	LOOP,
+	SWITCH
+};
+
+/*
+Lanes leave a construct by breaking, continuing or returning into the frame that owns it; they stay
+disabled until that frame is popped, or for continues until the loop reaches its continue target.
+*/
+struct shaderFrame_t {
+	shaderFrameKind_t	kind;
+	uint32				saved;			//execution mask on entry
+	uint32				pending;		//lanes waiting for the ELSE of an IF
+	uint32				broken;
+	uint32				continued;
+};
+
+/*
+================================================
+Arithmetic
+================================================
+*/
+static uint32 Lane_Bool( bool value ) {
+	return value ? ~0u : 0u;
+}
+
+static int32 Lane_FloatToInt( float value ) {
+	if ( value != value ) {
+		return 0;
+	}
+	if ( value >= 2147483648.0f ) {
+		return INT_MAX;
+	}
+	if ( value < -2147483648.0f ) {
+		return INT_MIN;
+	}
+	return ( int32 )value;
+}
+
+static uint32 Lane_FloatToUint( float value ) {
+	if ( !( value > 0.0f ) ) {
+		return 0;
+	}
+	if ( value >= 4294967296.0f ) {
+		return UINT_MAX;
+	}
+	return ( uint32 )value;
+}
+
+static int32 Lane_SignedDivide( int32 a, int32 b ) {
+	if ( b == 0 ) {
+		return -1;
+	}
+	if ( a == INT_MIN && b == -1 ) {
+		return INT_MIN;
+	}
+	return a / b;
+}
+
+static int32 Lane_SignedRemainder( int32 a, int32 b ) {
+	if ( b == 0 || ( a == INT_MIN && b == -1 ) ) {
+		return 0;
+	}
+	return a % b;
+}
+
+static int32 Lane_SignedModulo( int32 a, int32 b ) {
+	const int32 r = Lane_SignedRemainder( a, b );
+	return ( r != 0 && ( r < 0 ) != ( b < 0 ) ) ? r + b : r;
+}
+
+static float Lane_FloatModulo( float a, float b ) {
+	return a - b * floorf( a / b );
+}
+
+static float Lane_Sign( float value ) {
+	return ( value > 0.0f ) ? 1.0f : ( ( value < 0.0f ) ? -1.0f : value );
+}
+
+static const shaderRegister_t * Interpreter_Source( const shaderContext_t * context, uint32 reg ) {
+	return &context->pRegisters[ reg < context->program->registerCount ? reg : 0 ];
+}
+
+static uint32 Lane_BitCount( uint32 value ) {
+	uint32 count = 0;
+	for ( ; value != 0; value &= value - 1 ) {
+		count++;
+	}
+	return count;
+}
+
+static uint32 Lane_FindLsb( uint32 value ) {
+	if ( value == 0 ) {
+		return ~0u;
+	}
+	uint32 bit = 0;
+	while ( ( value & BIT( bit ) ) == 0 ) {
+		bit++;
+	}
+	return bit;
+}
+
+static uint32 Lane_FindMsb( uint32 value ) {
+	uint32 bit = ~0u;
+	for ( ; value != 0; value >>= 1 ) {
+		bit++;
+	}
+	return bit;
+}
+
+//Every op before LOAD_INDEXED: a pure function of its source registers, lane by lane
+static void Interpreter_Lanes( shaderOp_t op, const shaderRegister_t * a, const shaderRegister_t * b, const shaderRegister_t * s, shaderRegister_t * out ) {
+	switch ( op ) {
+		case shaderOp_t::MOV:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] ); break;
+
+		case shaderOp_t::FADD:			SHADER_LANE_LOOP( out->f[ l ] = a->f[ l ] + b->f[ l ] ); break;
+		case shaderOp_t::FSUB:			SHADER_LANE_LOOP( out->f[ l ] = a->f[ l ] - b->f[ l ] ); break;
+		case shaderOp_t::FMUL:			SHADER_LANE_LOOP( out->f[ l ] = a->f[ l ] * b->f[ l ] ); break;
+		case shaderOp_t::FDIV:			SHADER_LANE_LOOP( out->f[ l ] = a->f[ l ] / b->f[ l ] ); break;
+		case shaderOp_t::FREM:			SHADER_LANE_LOOP( out->f[ l ] = fmodf( a->f[ l ], b->f[ l ] ) ); break;
+		case shaderOp_t::FMOD:			SHADER_LANE_LOOP( out->f[ l ] = Lane_FloatModulo( a->f[ l ], b->f[ l ] ) ); break;
+		case shaderOp_t::FNEG:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] ^ 0x80000000u ); break;
+		case shaderOp_t::FABS:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] & 0x7FFFFFFFu ); break;
+		case shaderOp_t::FSIGN:			SHADER_LANE_LOOP( out->f[ l ] = Lane_Sign( a->f[ l ] ) ); break;
+		case shaderOp_t::FMIN:			SHADER_LANE_LOOP( out->f[ l ] = ( b->f[ l ] < a->f[ l ] ) ? b->f[ l ] : a->f[ l ] ); break;
+		case shaderOp_t::FMAX:			SHADER_LANE_LOOP( out->f[ l ] = ( a->f[ l ] < b->f[ l ] ) ? b->f[ l ] : a->f[ l ] ); break;
+		case shaderOp_t::FFLOOR:		SHADER_LANE_LOOP( out->f[ l ] = floorf( a->f[ l ] ) ); break;
+		case shaderOp_t::FCEIL:			SHADER_LANE_LOOP( out->f[ l ] = ceilf( a->f[ l ] ) ); break;
+		case shaderOp_t::FTRUNC:		SHADER_LANE_LOOP( out->f[ l ] = truncf( a->f[ l ] ) ); break;
+		case shaderOp_t::FROUND_EVEN:	SHADER_LANE_LOOP( out->f[ l ] = nearbyintf( a->f[ l ] ) ); break;
+		case shaderOp_t::FSQRT:			SHADER_LANE_LOOP( out->f[ l ] = sqrtf( a->f[ l ] ) ); break;
+		case shaderOp_t::FRSQRT:		SHADER_LANE_LOOP( out->f[ l ] = 1.0f / sqrtf( a->f[ l ] ) ); break;
+		case shaderOp_t::FSIN:			SHADER_LANE_LOOP( out->f[ l ] = sinf( a->f[ l ] ) ); break;
+		case shaderOp_t::FCOS:			SHADER_LANE_LOOP( out->f[ l ] = cosf( a->f[ l ] ) ); break;
+		case shaderOp_t::FTAN:			SHADER_LANE_LOOP( out->f[ l ] = tanf( a->f[ l ] ) ); break;
+		case shaderOp_t::FASIN:			SHADER_LANE_LOOP( out->f[ l ] = asinf( a->f[ l ] ) ); break;
+		case shaderOp_t::FACOS:			SHADER_LANE_LOOP( out->f[ l ] = acosf( a->f[ l ] ) ); break;
+		case shaderOp_t::FATAN:			SHADER_LANE_LOOP( out->f[ l ] = atanf( a->f[ l ] ) ); break;
+		case shaderOp_t::FATAN2:		SHADER_LANE_LOOP( out->f[ l ] = atan2f( a->f[ l ], b->f[ l ] ) ); break;
+		case shaderOp_t::FPOW:			SHADER_LANE_LOOP( out->f[ l ] = powf( a->f[ l ], b->f[ l ] ) ); break;
+		case shaderOp_t::FEXP:			SHADER_LANE_LOOP( out->f[ l ] = expf( a->f[ l ] ) ); break;
+		case shaderOp_t::FLOG:			SHADER_LANE_LOOP( out->f[ l ] = logf( a->f[ l ] ) ); break;
+		case shaderOp_t::FEXP2:			SHADER_LANE_LOOP( out->f[ l ] = exp2f( a->f[ l ] ) ); break;
+		case shaderOp_t::FLOG2:			SHADER_LANE_LOOP( out->f[ l ] = log2f( a->f[ l ] ) ); break;
+
+		case shaderOp_t::IADD:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] + b->u[ l ] ); break;
+		case shaderOp_t::ISUB:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] - b->u[ l ] ); break;
+		case shaderOp_t::IMUL:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] * b->u[ l ] ); break;
+		case shaderOp_t::UDIV:			SHADER_LANE_LOOP( out->u[ l ] = ( b->u[ l ] != 0 ) ? a->u[ l ] / b->u[ l ] : UINT_MAX ); break;
+		case shaderOp_t::SDIV:			SHADER_LANE_LOOP( out->i[ l ] = Lane_SignedDivide( a->i[ l ], b->i[ l ] ) ); break;
+		case shaderOp_t::UMOD:			SHADER_LANE_LOOP( out->u[ l ] = ( b->u[ l ] != 0 ) ? a->u[ l ] % b->u[ l ] : 0 ); break;
+		case shaderOp_t::SREM:			SHADER_LANE_LOOP( out->i[ l ] = Lane_SignedRemainder( a->i[ l ], b->i[ l ] ) ); break;
+		case shaderOp_t::SMOD:			SHADER_LANE_LOOP( out->i[ l ] = Lane_SignedModulo( a->i[ l ], b->i[ l ] ) ); break;
+		case shaderOp_t::INEG:			SHADER_LANE_LOOP( out->u[ l ] = 0u - a->u[ l ] ); break;
+		case shaderOp_t::IABS:			SHADER_LANE_LOOP( out->u[ l ] = ( a->i[ l ] < 0 ) ? 0u - a->u[ l ] : a->u[ l ] ); break;
+		case shaderOp_t::ISIGN:			SHADER_LANE_LOOP( out->i[ l ] = ( a->i[ l ] > 0 ) - ( a->i[ l ] < 0 ) ); break;
+		case shaderOp_t::UMIN:			SHADER_LANE_LOOP( out->u[ l ] = ( b->u[ l ] < a->u[ l ] ) ? b->u[ l ] : a->u[ l ] ); break;
+		case shaderOp_t::UMAX:			SHADER_LANE_LOOP( out->u[ l ] = ( a->u[ l ] < b->u[ l ] ) ? b->u[ l ] : a->u[ l ] ); break;
+		case shaderOp_t::SMIN:			SHADER_LANE_LOOP( out->i[ l ] = ( b->i[ l ] < a->i[ l ] ) ? b->i[ l ] : a->i[ l ] ); break;
+		case shaderOp_t::SMAX:			SHADER_LANE_LOOP( out->i[ l ] = ( a->i[ l ] < b->i[ l ] ) ? b->i[ l ] : a->i[ l ] ); break;
+		case shaderOp_t::AND:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] & b->u[ l ] ); break;
+		case shaderOp_t::OR:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] | b->u[ l ] ); break;
+		case shaderOp_t::XOR:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] ^ b->u[ l ] ); break;
+		case shaderOp_t::NOT:			SHADER_LANE_LOOP( out->u[ l ] = ~a->u[ l ] ); break;
+		case shaderOp_t::SHL:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] << ( b->u[ l ] & 31 ) ); break;
+		case shaderOp_t::SHR:			SHADER_LANE_LOOP( out->u[ l ] = a->u[ l ] >> ( b->u[ l ] & 31 ) ); break;
+		case shaderOp_t::SAR:			SHADER_LANE_LOOP( out->i[ l ] = a->i[ l ] >> ( b->u[ l ] & 31 ) ); break;
+		case shaderOp_t::BIT_COUNT:		SHADER_LANE_LOOP( out->u[ l ] = Lane_BitCount( a->u[ l ] ) ); break;
+		case shaderOp_t::FIND_LSB:		SHADER_LANE_LOOP( out->u[ l ] = Lane_FindLsb( a->u[ l ] ) ); break;
+		case shaderOp_t::FIND_UMSB:		SHADER_LANE_LOOP( out->u[ l ] = Lane_FindMsb( a->u[ l ] ) ); break;
+
+		case shaderOp_t::F2S:			SHADER_LANE_LOOP( out->i[ l ] = Lane_FloatToInt( a->f[ l ] ) ); break;
+		case shaderOp_t::F2U:			SHADER_LANE_LOOP( out->u[ l ] = Lane_FloatToUint( a->f[ l ] ) ); break;
+		case shaderOp_t::S2F:			SHADER_LANE_LOOP( out->f[ l ] = ( float )a->i[ l ] ); break;
+		case shaderOp_t::U2F:			SHADER_LANE_LOOP( out->f[ l ] = ( float )a->u[ l ] ); break;
+
+		case shaderOp_t::FORD_EQ:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->f[ l ] == b->f[ l ] ) ); break;
+		case shaderOp_t::FORD_NE:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->f[ l ] < b->f[ l ] || a->f[ l ] > b->f[ l ] ) ); break;
+		case shaderOp_t::FORD_LT:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->f[ l ] < b->f[ l ] ) ); break;
+		case shaderOp_t::FORD_LE:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->f[ l ] <= b->f[ l ] ) ); break;
+		case shaderOp_t::FUNORD_EQ:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( !( a->f[ l ] < b->f[ l ] || a->f[ l ] > b->f[ l ] ) ) ); break;
+		case shaderOp_t::FUNORD_NE:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( !( a->f[ l ] == b->f[ l ] ) ) ); break;
+		case shaderOp_t::FUNORD_LT:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( !( a->f[ l ] >= b->f[ l ] ) ) ); break;
+		case shaderOp_t::FUNORD_LE:		SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( !( a->f[ l ] > b->f[ l ] ) ) ); break;
+		case shaderOp_t::IEQ:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->u[ l ] == b->u[ l ] ) ); break;
+		case shaderOp_t::INE:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->u[ l ] != b->u[ l ] ) ); break;
+		case shaderOp_t::ULT:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->u[ l ] < b->u[ l ] ) ); break;
+		case shaderOp_t::ULE:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->u[ l ] <= b->u[ l ] ) ); break;
+		case shaderOp_t::SLT:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->i[ l ] < b->i[ l ] ) ); break;
+		case shaderOp_t::SLE:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( a->i[ l ] <= b->i[ l ] ) ); break;
+		case shaderOp_t::ISNAN:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( ( a->u[ l ] & 0x7FFFFFFFu ) > 0x7F800000u ) ); break;
+		case shaderOp_t::ISINF:			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( ( a->u[ l ] & 0x7FFFFFFFu ) == 0x7F800000u ) ); break;
+		case shaderOp_t::SELECT:		SHADER_LANE_LOOP( out->u[ l ] = ( a->u[ l ] != 0 ) ? b->u[ l ] : s->u[ l ] ); break;
+
+		//Lane = y * 4 + x: the horizontal neighbour differs in bit 0, the vertical one in bit 2
+		case shaderOp_t::DPDX_FINE:		SHADER_LANE_LOOP( out->f[ l ] = a->f[ l | 1 ] - a->f[ l & ~1u ] ); break;
+		case shaderOp_t::DPDY_FINE:		SHADER_LANE_LOOP( out->f[ l ] = a->f[ l | 4 ] - a->f[ l & ~4u ] ); break;
+		case shaderOp_t::DPDX_COARSE:	SHADER_LANE_LOOP( out->f[ l ] = a->f[ ( l & ~5u ) | 1 ] - a->f[ l & ~5u ] ); break;
+		case shaderOp_t::DPDY_COARSE:	SHADER_LANE_LOOP( out->f[ l ] = a->f[ ( l & ~5u ) | 4 ] - a->f[ l & ~5u ] ); break;
+		default:
+			break;
+	}
+}
+
+static void Interpreter_Compute( const shaderContext_t * context, const shaderInstruction_t & inst, shaderRegister_t * out ) {
+	Interpreter_Lanes( inst.op, Interpreter_Source( context, inst.src[ 0 ] ), Interpreter_Source( context, inst.src[ 1 ] ), Interpreter_Source( context, inst.src[ 2 ] ), out );
+}
+
+/*
+================================================
+Memory
+================================================
+*/
+static const shaderBufferView_t * Interpreter_BufferView( const shaderResources_t * resources, uint32 slot, uint32 element ) {
+	const shaderResource_t & resource = resources->pSlots[ slot ];
+	if ( element >= resource.elementCount ) {
+		return NULL;
+	}
+	return reinterpret_cast< const shaderBufferView_t * >( resource.ppElements[ element ] );
+}
+
+//Address of the word an access reaches in one lane, NULL when it falls outside the bound range
+static uint8 * Interpreter_BufferWord( const shaderContext_t * context, const shaderResources_t * resources, const shaderBufferAccess_t & access, uint32 lane ) {
+	uint64 offset = access.offset;
+	if ( access.offsetRegister != SHADER_NO_REGISTER ) {
+		offset += context->pRegisters[ access.offsetRegister ].u[ lane ];
+	}
+	if ( access.slot == SHADER_PUSH_CONSTANT_SLOT ) {
+		return ( offset + sizeof( uint32 ) <= resources->pushConstantSize ) ? const_cast< uint8 * >( resources->pPushConstants ) + offset : NULL;
+	}
+	if ( access.slot == SHADER_WORKGROUP_SLOT ) {
+		return ( offset + sizeof( uint32 ) <= context->program->workgroupMemorySize ) ? context->pWorkgroupMemory + offset : NULL;
+	}
+	uint32 element = access.element;
+	if ( access.elementRegister != SHADER_NO_REGISTER ) {
+		element += context->pRegisters[ access.elementRegister ].u[ lane ];
+	}
+	const shaderBufferView_t * view = Interpreter_BufferView( resources, access.slot, element );
+	if ( view == NULL || offset + sizeof( uint32 ) > view->range ) {
+		return NULL;
+	}
+	return view->data + offset;
+}
+
+static void Interpreter_LoadBuffer( const shaderContext_t * context, const shaderResources_t * resources, const shaderBufferAccess_t & access, uint32 laneMask, shaderRegister_t * out ) {
+	//Uniform addresses, the common case for uniform blocks and push constants, load once
+	if ( access.elementRegister == SHADER_NO_REGISTER && access.offsetRegister == SHADER_NO_REGISTER ) {
+		const uint8 * word = Interpreter_BufferWord( context, resources, access, 0 );
+		uint32 value = 0;
+		if ( word != NULL ) {
+			memcpy( &value, word, sizeof( value ) );
+		}
+		SHADER_LANE_LOOP( out->u[ l ] = value );
+		return;
+	}
+	for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+		const uint8 * word = ( laneMask & BIT( l ) ) ? Interpreter_BufferWord( context, resources, access, l ) : NULL;
+		out->u[ l ] = 0;
+		if ( word != NULL ) {
+			memcpy( &out->u[ l ], word, sizeof( uint32 ) );
+		}
+	}
+}
+
+static void Interpreter_StoreBuffer( const shaderContext_t * context, const shaderResources_t * resources, const shaderBufferAccess_t & access, uint32 laneMask, const shaderRegister_t * value ) {
+	for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+		if ( ( laneMask & BIT( l ) ) != 0 ) {
+			uint8 * word = Interpreter_BufferWord( context, resources, access, l );
+			if ( word != NULL ) {
+				memcpy( word, &value->u[ l ], sizeof( uint32 ) );
+			}
+		}
+	}
+}
+
+static const void * Interpreter_Descriptor( const shaderResources_t * resources, uint32 slot, uint32 element ) {
+	if ( slot == SHADER_NO_REGISTER || element >= resources->pSlots[ slot ].elementCount ) {
+		return NULL;
+	}
+	return resources->pSlots[ slot ].ppElements[ element ];
+}
+
+//Lanes indexing different descriptor elements are sampled in separate groups
+static void Interpreter_Sample( const shaderContext_t * context, const shaderResources_t * resources, const shaderSampleOp_t & op, uint32 laneMask, shaderRegister_t * pResult ) {
+	memset( pResult, 0, sizeof( shaderRegister_t ) * op.resultCount );
+	const shaderRegister_t * pRegisters = context->pRegisters;
+	uint32 remaining = laneMask;
+	while ( remaining != 0 ) {
+		uint32 first = 0;
+		while ( ( remaining & BIT( first ) ) == 0 ) {
+			first++;
+		}
+		const uint32 imageOffset = ( op.imageElementRegister != SHADER_NO_REGISTER ) ? pRegisters[ op.imageElementRegister ].u[ first ] : 0;
+		const uint32 samplerOffset = ( op.samplerElementRegister != SHADER_NO_REGISTER ) ? pRegisters[ op.samplerElementRegister ].u[ first ] : 0;
+		uint32 group = 0;
+		for ( uint32 l = first; l < SHADER_LANES; l++ ) {
+			if ( ( remaining & BIT( l ) ) != 0
+				&& ( op.imageElementRegister == SHADER_NO_REGISTER || pRegisters[ op.imageElementRegister ].u[ l ] == imageOffset )
+				&& ( op.samplerElementRegister == SHADER_NO_REGISTER || pRegisters[ op.samplerElementRegister ].u[ l ] == samplerOffset ) ) {
+				group |= BIT( l );
+			}
+		}
+		remaining &= ~group;
+		const void * pImage = Interpreter_Descriptor( resources, op.imageSlot, op.imageElement + imageOffset );
+		const void * pSampler = Interpreter_Descriptor( resources, op.samplerSlot, op.samplerElement + samplerOffset );
+		if ( resources->sample != NULL && pImage != NULL ) {
+			resources->sample( pImage, pSampler, &op, pRegisters, group, pResult );
+		}
+	}
+}
+
+/*
+================================================
+Subgroups
+
+Lanes outside the execution mask take no part: reductions and scans see the identity of their op in
+their place.  Reductions combine lanes as a butterfly and scans in Hillis-Steele steps, each step as
+op( lane, other ), which is exactly the order compiled code combines its vectors in.
+================================================
+*/
+uint32 ShaderSubgroup_BuiltIn( spvBuiltIn_t builtIn, uint32 lane, uint32 subgroupSize ) {
+	const uint32 id = lane & ( subgroupSize - 1 );
+	const uint32 all = ( uint32 )( ( 1ull << subgroupSize ) - 1 );
+	const uint32 eq = 1u << id;
+	switch ( builtIn ) {
+		case spvBuiltIn_t::SUBGROUP_SIZE:					return subgroupSize;
+		case spvBuiltIn_t::SUBGROUP_LOCAL_INVOCATION_ID:	return id;
+		case spvBuiltIn_t::SUBGROUP_EQ_MASK:				return eq;
+		case spvBuiltIn_t::SUBGROUP_GE_MASK:				return all & ~( eq - 1 );
+		case spvBuiltIn_t::SUBGROUP_GT_MASK:				return all & ~( ( eq << 1 ) - 1 );
+		case spvBuiltIn_t::SUBGROUP_LE_MASK:				return ( eq << 1 ) - 1;
+		case spvBuiltIn_t::SUBGROUP_LT_MASK:				return eq - 1;
+		default:											return 0;
+	}
+}
+
+uint32 ShaderSubgroup_Identity( shaderOp_t op ) {
+	switch ( op ) {
+		case shaderOp_t::IMUL:	return 1;
+		case shaderOp_t::FADD:	return 0x80000000u;		//-0, as +0 would turn a lone -0 into +0
+		case shaderOp_t::FMUL:	return 0x3F800000u;
+		case shaderOp_t::FMIN:	return 0x7F800000u;
+		case shaderOp_t::FMAX:	return 0xFF800000u;
+		case shaderOp_t::SMIN:	return 0x7FFFFFFFu;
+		case shaderOp_t::SMAX:	return 0x80000000u;
+		case shaderOp_t::UMIN:
+		case shaderOp_t::AND:	return ~0u;
+		default:				return 0;
+	}
+}
+
+//Lanes of the subgroup holding lane
+static uint32 Subgroup_Lanes( uint32 lane, uint32 size ) {
+	return ( uint32 )( ( 1ull << size ) - 1 ) << ( lane & ~( size - 1 ) );
+}
+
+//Lowest active lane of the subgroup holding lane, or its first lane when none is active
+static uint32 Subgroup_First( uint32 exec, uint32 lane, uint32 size ) {
+	const uint32 active = exec & Subgroup_Lanes( lane, size );
+	return ( active != 0 ) ? Lane_FindLsb( active ) : ( lane & ~( size - 1 ) );
+}
+
+static uint32 Subgroup_Truth( uint32 exec, const shaderRegister_t * value ) {
+	uint32 mask = 0;
+	for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+		mask |= ( value->u[ l ] != 0 ) ? BIT( l ) : 0;
+	}
+	return mask & exec;
+}
+
+//Moves every lane step lanes up its subgroup, filling the lanes at the bottom with fill
+static void Subgroup_ShiftUp( uint32 size, uint32 step, uint32 fill, const shaderRegister_t * value, shaderRegister_t * out ) {
+	SHADER_LANE_LOOP( out->u[ l ] = ( ( l & ( size - 1 ) ) >= step ) ? value->u[ l - step ] : fill );
+}
+
+static void Subgroup_Arithmetic( const shaderExecution_t * execution, const shaderInstruction_t & inst, uint32 size, const shaderRegister_t * value, shaderRegister_t * out ) {
+	const shaderOp_t op = ( shaderOp_t )inst.src[ 1 ];
+	const uint32 identity = ShaderSubgroup_Identity( op );
+	shaderRegister_t other;
+	SHADER_LANE_LOOP( out->u[ l ] = ( value->u[ l ] & execution->lanes[ l ] ) | ( identity & ~execution->lanes[ l ] ) );
+	if ( inst.op == shaderOp_t::SUBGROUP_REDUCE ) {
+		const uint32 width = ( inst.src[ 2 ] != 0 && inst.src[ 2 ] < size ) ? inst.src[ 2 ] : size;
+		for ( uint32 step = 1; step < width; step <<= 1 ) {
+			SHADER_LANE_LOOP( other.u[ l ] = out->u[ l ^ step ] );
+			Interpreter_Lanes( op, out, &other, NULL, out );
+		}
+		return;
+	}
+	if ( inst.op == shaderOp_t::SUBGROUP_EXCLUSIVE_SCAN ) {
+		Subgroup_ShiftUp( size, 1, identity, out, &other );
+		*out = other;
+	}
+	for ( uint32 step = 1; step < size; step <<= 1 ) {
+		Subgroup_ShiftUp( size, step, identity, out, &other );
+		Interpreter_Lanes( op, out, &other, NULL, out );
+	}
+}
+
+static void Interpreter_Subgroup( const shaderContext_t * context, const shaderExecution_t * execution, const shaderInstruction_t & inst, shaderRegister_t * out ) {
+	const uint32 size = context->subgroupSize;
+	const uint32 exec = execution->exec;
+	const shaderRegister_t * a = Interpreter_Source( context, inst.src[ 0 ] );
+	const shaderRegister_t * b = Interpreter_Source( context, inst.src[ 1 ] );
+	switch ( inst.op ) {
+		case shaderOp_t::SUBGROUP_BUILTIN:
+			SHADER_LANE_LOOP( out->u[ l ] = ShaderSubgroup_BuiltIn( ( spvBuiltIn_t )inst.src[ 0 ], l, size ) );
+			break;
+		case shaderOp_t::SUBGROUP_ELECT:
+			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( Subgroup_First( exec, l, size ) == l && ( exec & BIT( l ) ) != 0 ) );
+			break;
+		case shaderOp_t::SUBGROUP_ALL: {
+			const uint32 truth = Subgroup_Truth( exec, a );
+			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( ( exec & ~truth & Subgroup_Lanes( l, size ) ) == 0 ) );
+			break;
+		}
+		case shaderOp_t::SUBGROUP_ANY: {
+			const uint32 truth = Subgroup_Truth( exec, a );
+			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( ( truth & Subgroup_Lanes( l, size ) ) != 0 ) );
+			break;
+		}
+		case shaderOp_t::SUBGROUP_ALL_EQUAL: {
+			uint32 differing = 0;
+			for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+				differing |= ( a->u[ l ] != a->u[ Subgroup_First( exec, l, size ) ] ) ? BIT( l ) : 0;
+			}
+			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( ( exec & differing & Subgroup_Lanes( l, size ) ) == 0 ) );
+			break;
+		}
+		case shaderOp_t::SUBGROUP_BALLOT: {
+			const uint32 truth = Subgroup_Truth( exec, a );
+			SHADER_LANE_LOOP( out->u[ l ] = ( truth & Subgroup_Lanes( l, size ) ) >> ( l & ~( size - 1 ) ) );
+			break;
+		}
+		case shaderOp_t::SUBGROUP_INVERSE_BALLOT:
+			SHADER_LANE_LOOP( out->u[ l ] = Lane_Bool( ( ( a->u[ l ] >> ( l & ( size - 1 ) ) ) & 1 ) != 0 ) );
+			break;
+		case shaderOp_t::SUBGROUP_BROADCAST_FIRST:
+			SHADER_LANE_LOOP( out->u[ l ] = a->u[ Subgroup_First( exec, l, size ) ] );
+			break;
+		case shaderOp_t::SUBGROUP_SHUFFLE:
+		case shaderOp_t::SUBGROUP_SHUFFLE_XOR:
+		case shaderOp_t::SUBGROUP_SHUFFLE_UP:
+		case shaderOp_t::SUBGROUP_SHUFFLE_DOWN:
+			for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+				const uint32 id = l & ( size - 1 );
+				uint32 source = b->u[ l ];
+				switch ( inst.op ) {
+					case shaderOp_t::SUBGROUP_SHUFFLE_XOR:	source ^= id; break;
+					case shaderOp_t::SUBGROUP_SHUFFLE_UP:	source = id - source; break;
+					case shaderOp_t::SUBGROUP_SHUFFLE_DOWN:	source = id + source; break;
+					default:								break;
+				}
+				out->u[ l ] = ( source < size ) ? a->u[ l - id + source ] : a->u[ l ];
+			}
+			break;
+		default:
+			Subgroup_Arithmetic( execution, inst, size, a, out );
+			break;
+	}
+}
+
+/*
+================================================
+shaderContext_t
+================================================
+*/
+bool ShaderContext_Init( shaderContext_t * context, const shaderProgram_t * program, uint32 subgroupSize, const VkAllocationCallbacks * allocator ) {
+	memset( context, 0, sizeof( shaderContext_t ) );
+	context->program = program;
+	context->allocator = allocator;
+	context->subgroupSize = subgroupSize;
+	const uint32 registerCount = Max( program->registerCount, 1u );
+	context->pRegisters = reinterpret_cast< shaderRegister_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( shaderRegister_t ) * registerCount, 64, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	context->pFrames = reinterpret_cast< shaderFrame_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( shaderFrame_t ) * Max( program->frameDepth, 1u ), 64, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( context->pRegisters == NULL || context->pFrames == NULL ) {
+		ShaderContext_Shutdown( context );
+		return false;
+	}
+	memset( context->pRegisters, 0, sizeof( shaderRegister_t ) * registerCount );
+	for ( uint32 i = 0; i < program->constantCount; i++ ) {
+		const uint32 value = program->pConstants[ i ];
+		SHADER_LANE_LOOP( context->pRegisters[ i ].u[ l ] = value );
+	}
+	return true;
+}
+
+void ShaderContext_Shutdown( shaderContext_t * context ) {
+	if ( context->allocator == NULL ) {
+		return;
+	}
+	context->allocator->pfnFree( context->allocator->pUserData, context->pRegisters );
+	context->allocator->pfnFree( context->allocator->pUserData, context->pFrames );
+	memset( context, 0, sizeof( shaderContext_t ) );
+}
+
+static void Execution_SetMask( shaderExecution_t * execution, uint32 exec ) {
+	execution->exec = exec;
+	SHADER_LANE_LOOP( execution->lanes[ l ] = ( exec & BIT( l ) ) ? ~0u : 0u );
+}
+
+static uint32 Execution_Disabled( const shaderExecution_t * execution ) {
+	uint32 disabled = execution->killed;
+	for ( uint32 i = 0; i < execution->depth; i++ ) {
+		disabled |= execution->pFrames[ i ].broken | execution->pFrames[ i ].continued;
+	}
+	return disabled;
+}
+
+static shaderFrame_t * Execution_Push( shaderExecution_t * execution, shaderFrameKind_t kind ) {
+	shaderFrame_t * frame = &execution->pFrames[ execution->depth++ ];
+	frame->kind = kind;
+	frame->saved = execution->exec;
+	frame->pending = 0;
+	frame->broken = 0;
+	frame->continued = 0;
+	return frame;
+}
+
+//Pops the innermost frame and rejoins the lanes that entered it and are still running
+static void Execution_Pop( shaderExecution_t * execution ) {
+	const uint32 saved = execution->pFrames[ --execution->depth ].saved;
+	Execution_SetMask( execution, saved & ~Execution_Disabled( execution ) );
+}
+
+//The depth-th enclosing loop or switch, counting outwards from 0
+static shaderFrame_t * Execution_Breakable( shaderExecution_t * execution, uint32 depth ) {
+	for ( uint32 i = execution->depth; i-- > 0; ) {
+		shaderFrame_t * frame = &execution->pFrames[ i ];
+		if ( frame->kind == shaderFrameKind_t::LOOP || frame->kind == shaderFrameKind_t::SWITCH ) {
+			if ( depth-- == 0 ) {
+				return frame;
+			}
+		}
+	}
+	return &execution->pFrames[ 0 ];
+}
+
+static uint32 Register_Mask( const shaderRegister_t * reg ) {
+	uint32 mask = 0;
+	for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+		mask |= ( reg->u[ l ] != 0 ) ? BIT( l ) : 0;
+	}
+	return mask;
+}
+
+static void Register_Write( shaderRegister_t * dst, const shaderRegister_t * value, const shaderExecution_t * execution, bool blend ) {
+	if ( blend ) {
+		SHADER_LANE_LOOP( dst->u[ l ] = ( value->u[ l ] & execution->lanes[ l ] ) | ( dst->u[ l ] & ~execution->lanes[ l ] ) );
+	} else {
+		*dst = *value;
+	}
+}
+
+void ShaderExecution_Begin( shaderExecution_t * execution, shaderContext_t * context, uint32 laneMask, uint32 helperMask ) {
+	execution->pFrames = context->pFrames;
+	execution->depth = 0;
+	execution->live = laneMask;
+	execution->helpers = helperMask;
+	execution->killed = 0;
+	Execution_SetMask( execution, laneMask );
+	Execution_Push( execution, shaderFrameKind_t::FUNCTION );
+}
+
+uint32 ShaderExecution_Step( shaderExecution_t * execution, shaderContext_t * context, const shaderResources_t * resources, uint32 pc ) {
+	const shaderProgram_t * program = context->program;
+	shaderRegister_t * pRegisters = context->pRegisters;
+	const shaderInstruction_t & inst = program->pInstructions[ pc ];
+	shaderRegister_t temporary[ 4 ];
+	//Masked writes keep every lane outside the execution mask, dead and killed lanes included, exactly as compiled code does
+	const bool blend = ( inst.flags & SHADER_MASKED ) != 0 && execution->exec != SHADER_ALL_LANES;
+	if ( inst.op < shaderOp_t::LOAD_INDEXED ) {
+		if ( !blend && inst.op < shaderOp_t::DPDX_FINE ) {
+			Interpreter_Compute( context, inst, &pRegisters[ inst.dst ] );
+		} else {
+			Interpreter_Compute( context, inst, &temporary[ 0 ] );
+			Register_Write( &pRegisters[ inst.dst ], &temporary[ 0 ], execution, blend );
+		}
+		return pc + 1;
+	}
+	switch ( inst.op ) {
+		case shaderOp_t::LOAD_INDEXED: {
+			const uint32 limit = inst.src[ 2 ];
+			const shaderRegister_t * index = &pRegisters[ inst.src[ 1 ] ];
+			SHADER_LANE_LOOP( temporary[ 0 ].u[ l ] = pRegisters[ inst.src[ 0 ] + Min( index->u[ l ], limit ) ].u[ l ] );
+			Register_Write( &pRegisters[ inst.dst ], &temporary[ 0 ], execution, blend );
+			break;
+		}
+		case shaderOp_t::STORE_INDEXED: {
+			const uint32 limit = inst.src[ 2 ];
+			const uint32 mask = ( inst.flags & SHADER_MASKED ) ? execution->exec : SHADER_ALL_LANES;
+			const shaderRegister_t * index = &pRegisters[ inst.src[ 1 ] ];
+			const shaderRegister_t * value = &pRegisters[ inst.src[ 0 ] ];
+			for ( uint32 l = 0; l < SHADER_LANES; l++ ) {
+				if ( ( mask & BIT( l ) ) != 0 ) {
+					pRegisters[ inst.dst + Min( index->u[ l ], limit ) ].u[ l ] = value->u[ l ];
+				}
+			}
+			break;
+		}
+		case shaderOp_t::LOAD_BUFFER:
+			Interpreter_LoadBuffer( context, resources, program->pBufferAccesses[ inst.src[ 0 ] ], execution->exec, &temporary[ 0 ] );
+			Register_Write( &pRegisters[ inst.dst ], &temporary[ 0 ], execution, blend );
+			break;
+		case shaderOp_t::STORE_BUFFER:
+			Interpreter_StoreBuffer( context, resources, program->pBufferAccesses[ inst.src[ 0 ] ], execution->exec & ~execution->helpers, &pRegisters[ inst.src[ 1 ] ] );
+			break;
+		case shaderOp_t::SAMPLE: {
+			const shaderSampleOp_t & op = program->pSampleOps[ inst.src[ 0 ] ];
+			Interpreter_Sample( context, resources, op, execution->exec, temporary );
+			for ( uint32 i = 0; i < op.resultCount; i++ ) {
+				Register_Write( &pRegisters[ inst.dst + i ], &temporary[ i ], execution, blend );
+			}
+			break;
+		}
+
+		case shaderOp_t::SUBGROUP_BUILTIN:
+		case shaderOp_t::SUBGROUP_ELECT:
+		case shaderOp_t::SUBGROUP_ALL:
+		case shaderOp_t::SUBGROUP_ANY:
+		case shaderOp_t::SUBGROUP_ALL_EQUAL:
+		case shaderOp_t::SUBGROUP_BALLOT:
+		case shaderOp_t::SUBGROUP_INVERSE_BALLOT:
+		case shaderOp_t::SUBGROUP_BROADCAST_FIRST:
+		case shaderOp_t::SUBGROUP_SHUFFLE:
+		case shaderOp_t::SUBGROUP_SHUFFLE_XOR:
+		case shaderOp_t::SUBGROUP_SHUFFLE_UP:
+		case shaderOp_t::SUBGROUP_SHUFFLE_DOWN:
+		case shaderOp_t::SUBGROUP_REDUCE:
+		case shaderOp_t::SUBGROUP_INCLUSIVE_SCAN:
+		case shaderOp_t::SUBGROUP_EXCLUSIVE_SCAN:
+			Interpreter_Subgroup( context, execution, inst, &temporary[ 0 ] );
+			Register_Write( &pRegisters[ inst.dst ], &temporary[ 0 ], execution, blend );
+			break;
+
+		case shaderOp_t::IF: {
+			const uint32 condition = Register_Mask( &pRegisters[ inst.src[ 0 ] ] );
+			shaderFrame_t * frame = Execution_Push( execution, shaderFrameKind_t::IF );
+			frame->pending = execution->exec & ~condition;
+			Execution_SetMask( execution, execution->exec & condition );
+			if ( execution->exec == 0 ) {
+				return inst.src[ 1 ];
+			}
+			break;
+		}
+		case shaderOp_t::ELSE:
+			Execution_SetMask( execution, execution->pFrames[ execution->depth - 1 ].pending & ~Execution_Disabled( execution ) );
+			if ( execution->exec == 0 ) {
+				return inst.src[ 1 ];
+			}
+			break;
+		case shaderOp_t::ENDIF:
+		case shaderOp_t::SWITCH_END:
+		case shaderOp_t::CALL_END:
+			Execution_Pop( execution );
+			break;
+		case shaderOp_t::LOOP_BEGIN:
+		case shaderOp_t::SWITCH_BEGIN:
+			Execution_Push( execution, inst.op == shaderOp_t::LOOP_BEGIN ? shaderFrameKind_t::LOOP : shaderFrameKind_t::SWITCH );
+			if ( execution->exec == 0 ) {
+				return inst.src[ 1 ];
+			}
+			break;
+		case shaderOp_t::CONTINUE_TARGET: {
+			shaderFrame_t * frame = &execution->pFrames[ execution->depth - 1 ];
+			frame->continued = 0;
+			Execution_SetMask( execution, frame->saved & ~Execution_Disabled( execution ) );
+			break;
+		}
+		case shaderOp_t::LOOP_END: {
+			shaderFrame_t * frame = &execution->pFrames[ execution->depth - 1 ];
+			frame->continued = 0;
+			Execution_SetMask( execution, frame->saved & ~Execution_Disabled( execution ) );
+			if ( execution->exec != 0 ) {
+				return inst.src[ 0 ];
+			}
+			Execution_Pop( execution );
+			break;
+		}
+		case shaderOp_t::BREAK:
+			Execution_Breakable( execution, inst.src[ 0 ] )->broken |= execution->exec;
+			Execution_SetMask( execution, 0 );
+			break;
+		case shaderOp_t::CONTINUE:
+			Execution_Breakable( execution, inst.src[ 0 ] )->continued |= execution->exec;
+			Execution_SetMask( execution, 0 );
+			break;
+		case shaderOp_t::CALL_BEGIN:
+			Execution_Push( execution, shaderFrameKind_t::FUNCTION );
+			break;
+		case shaderOp_t::RETURN: {
+			uint32 i = execution->depth - 1;
+			while ( i > 0 && execution->pFrames[ i ].kind != shaderFrameKind_t::FUNCTION ) {
+				i--;
+			}
+			execution->pFrames[ i ].broken |= execution->exec;
+			Execution_SetMask( execution, 0 );
+			break;
+		}
+		case shaderOp_t::KILL:
+			execution->killed |= execution->exec;
+			Execution_SetMask( execution, 0 );
+			break;
+		case shaderOp_t::BARRIER:
+			if ( context->barrier != NULL ) {
+				context->barrier( context->pBarrierArgument );
+			}
+			break;
+		default:
+			break;
+	}
+	return pc + 1;
+}
+
+uint32 ShaderContext_Run( shaderContext_t * context, uint32 laneMask, uint32 helperMask, const shaderResources_t * resources ) {
+	shaderExecution_t execution;
+	ShaderExecution_Begin( &execution, context, laneMask, helperMask );
+	const uint32 instructionCount = context->program->instructionCount;
+	for ( uint32 pc = 0; pc < instructionCount; ) {
+		pc = ShaderExecution_Step( &execution, context, resources, pc );
+	}
+	return laneMask & ~execution.killed;
+}
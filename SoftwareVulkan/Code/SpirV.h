@@ -0,0 +1,389 @@
+#pragma once
+
+#include "Common.h"
+
+//The subset of the SPIR-V 1.0 and GLSL.std.450 grammars the shader compiler reads; values are from the Khronos specifications
+
+#define SPV_MAGIC 0x07230203
+#define SPV_HEADER_WORDS 5
+#define SPV_WORD_COUNT_SHIFT 16
+#define SPV_OPCODE_MASK 0xFFFF
+
+enum class spvOp_t : uint32 {
+	NOP							= 0,
+	UNDEF						= 1,
+	SOURCE_CONTINUED			= 2,
+	SOURCE						= 3,
+	SOURCE_EXTENSION			= 4,
+	NAME						= 5,
+	MEMBER_NAME					= 6,
+	STRING						= 7,
+	LINE						= 8,
+	EXTENSION					= 10,
+	EXT_INST_IMPORT				= 11,
+	EXT_INST					= 12,
+	MEMORY_MODEL				= 14,
+	ENTRY_POINT					= 15,
+	EXECUTION_MODE				= 16,
+	CAPABILITY					= 17,
+	TYPE_VOID					= 19,
+	TYPE_BOOL					= 20,
+	TYPE_INT					= 21,
+	TYPE_FLOAT					= 22,
+	TYPE_VECTOR					= 23,
+	TYPE_MATRIX					= 24,
+	TYPE_IMAGE					= 25,
+	TYPE_SAMPLER				= 26,
+	TYPE_SAMPLED_IMAGE			= 27,
+	TYPE_ARRAY					= 28,
+	TYPE_RUNTIME_ARRAY			= 29,
+	TYPE_STRUCT					= 30,
+	TYPE_POINTER				= 32,
+	TYPE_FUNCTION				= 33,
+	TYPE_FORWARD_POINTER		= 39,
+	CONSTANT_TRUE				= 41,
+	CONSTANT_FALSE				= 42,
+	CONSTANT					= 43,
+	CONSTANT_COMPOSITE			= 44,
+	CONSTANT_NULL				= 46,
+	SPEC_CONSTANT_TRUE			= 48,
+	SPEC_CONSTANT_FALSE			= 49,
+	SPEC_CONSTANT				= 50,
+	SPEC_CONSTANT_COMPOSITE		= 51,
+	SPEC_CONSTANT_OP			= 52,
+	FUNCTION					= 54,
+	FUNCTION_PARAMETER			= 55,
+	FUNCTION_END				= 56,
+	FUNCTION_CALL				= 57,
+	VARIABLE					= 59,
+	LOAD						= 61,
+	STORE						= 62,
+	COPY_MEMORY					= 63,
+	ACCESS_CHAIN				= 65,
+	IN_BOUNDS_ACCESS_CHAIN		= 66,
+	DECORATE					= 71,
+	MEMBER_DECORATE				= 72,
+	DECORATION_GROUP			= 73,
+	GROUP_DECORATE				= 74,
+	GROUP_MEMBER_DECORATE		= 75,
+	VECTOR_EXTRACT_DYNAMIC		= 77,
+	VECTOR_INSERT_DYNAMIC		= 78,
+	VECTOR_SHUFFLE				= 79,
+	COMPOSITE_CONSTRUCT			= 80,
+	COMPOSITE_EXTRACT			= 81,
+	COMPOSITE_INSERT			= 82,
+	COPY_OBJECT					= 83,
+	TRANSPOSE					= 84,
+	SAMPLED_IMAGE				= 86,
+	IMAGE_SAMPLE_IMPLICIT_LOD	= 87,
+	IMAGE_SAMPLE_EXPLICIT_LOD	= 88,
+	IMAGE_SAMPLE_DREF_IMPLICIT_LOD	= 89,
+	IMAGE_SAMPLE_DREF_EXPLICIT_LOD	= 90,
+	IMAGE_FETCH					= 95,
+	IMAGE_WRITE					= 99,
+	IMAGE						= 100,
+	CONVERT_F_TO_U				= 109,
+	CONVERT_F_TO_S				= 110,
+	CONVERT_S_TO_F				= 111,
+	CONVERT_U_TO_F				= 112,
+	U_CONVERT					= 113,
+	S_CONVERT					= 114,
+	F_CONVERT					= 115,
+	BITCAST						= 124,
+	S_NEGATE					= 126,
+	F_NEGATE					= 127,
+	I_ADD						= 128,
+	F_ADD						= 129,
+	I_SUB						= 130,
+	F_SUB						= 131,
+	I_MUL						= 132,
+	F_MUL						= 133,
+	U_DIV						= 134,
+	S_DIV						= 135,
+	F_DIV						= 136,
+	U_MOD						= 137,
+	S_REM						= 138,
+	S_MOD						= 139,
+	F_REM						= 140,
+	F_MOD						= 141,
+	VECTOR_TIMES_SCALAR			= 142,
+	MATRIX_TIMES_SCALAR			= 143,
+	VECTOR_TIMES_MATRIX			= 144,
+	MATRIX_TIMES_VECTOR			= 145,
+	MATRIX_TIMES_MATRIX			= 146,
+	OUTER_PRODUCT				= 147,
+	DOT							= 148,
+	ANY							= 154,
+	ALL							= 155,
+	IS_NAN						= 156,
+	IS_INF						= 157,
+	LOGICAL_EQUAL				= 164,
+	LOGICAL_NOT_EQUAL			= 165,
+	LOGICAL_OR					= 166,
+	LOGICAL_AND					= 167,
+	LOGICAL_NOT					= 168,
+	SELECT						= 169,
+	I_EQUAL						= 170,
+	I_NOT_EQUAL					= 171,
+	U_GREATER_THAN				= 172,
+	S_GREATER_THAN				= 173,
+	U_GREATER_THAN_EQUAL		= 174,
+	S_GREATER_THAN_EQUAL		= 175,
+	U_LESS_THAN					= 176,
+	S_LESS_THAN					= 177,
+	U_LESS_THAN_EQUAL			= 178,
+	S_LESS_THAN_EQUAL			= 179,
+	F_ORD_EQUAL					= 180,
+	F_UNORD_EQUAL				= 181,
+	F_ORD_NOT_EQUAL				= 182,
+	F_UNORD_NOT_EQUAL			= 183,
+	F_ORD_LESS_THAN				= 184,
+	F_UNORD_LESS_THAN			= 185,
+	F_ORD_GREATER_THAN			= 186,
+	F_UNORD_GREATER_THAN		= 187,
+	F_ORD_LESS_THAN_EQUAL		= 188,
+	F_UNORD_LESS_THAN_EQUAL		= 189,
+	F_ORD_GREATER_THAN_EQUAL	= 190,
+	F_UNORD_GREATER_THAN_EQUAL	= 191,
+	SHIFT_RIGHT_LOGICAL			= 194,
+	SHIFT_RIGHT_ARITHMETIC		= 195,
+	SHIFT_LEFT_LOGICAL			= 196,
+	BITWISE_OR					= 197,
+	BITWISE_XOR					= 198,
+	BITWISE_AND					= 199,
+	NOT							= 200,
+	BIT_COUNT					= 205,
+	DPDX						= 207,
+	DPDY						= 208,
+	FWIDTH						= 209,
+	DPDX_FINE					= 210,
+	DPDY_FINE					= 211,
+	FWIDTH_FINE					= 212,
+	DPDX_COARSE					= 213,
+	DPDY_COARSE					= 214,
+	FWIDTH_COARSE				= 215,
+	CONTROL_BARRIER				= 224,
+	MEMORY_BARRIER				= 225,
+	PHI							= 245,
+	LOOP_MERGE					= 246,
+	SELECTION_MERGE				= 247,
+	LABEL						= 248,
+	BRANCH						= 249,
+	BRANCH_CONDITIONAL			= 250,
+	SWITCH						= 251,
+	KILL						= 252,
+	RETURN						= 253,
+	RETURN_VALUE				= 254,
+	UNREACHABLE					= 255,
+	NO_LINE						= 317,
+	MODULE_PROCESSED			= 330,
+	GROUP_NON_UNIFORM_ELECT				= 333,
+	GROUP_NON_UNIFORM_ALL				= 334,
+	GROUP_NON_UNIFORM_ANY				= 335,
+	GROUP_NON_UNIFORM_ALL_EQUAL			= 336,
+	GROUP_NON_UNIFORM_BROADCAST			= 337,
+	GROUP_NON_UNIFORM_BROADCAST_FIRST	= 338,
+	GROUP_NON_UNIFORM_BALLOT			= 339,
+	GROUP_NON_UNIFORM_INVERSE_BALLOT	= 340,
+	GROUP_NON_UNIFORM_BALLOT_BIT_EXTRACT	= 341,
+	GROUP_NON_UNIFORM_BALLOT_BIT_COUNT	= 342,
+	GROUP_NON_UNIFORM_BALLOT_FIND_LSB	= 343,
+	GROUP_NON_UNIFORM_BALLOT_FIND_MSB	= 344,
+	GROUP_NON_UNIFORM_SHUFFLE			= 345,
+	GROUP_NON_UNIFORM_SHUFFLE_XOR		= 346,
+	GROUP_NON_UNIFORM_SHUFFLE_UP		= 347,
+	GROUP_NON_UNIFORM_SHUFFLE_DOWN		= 348,
+	GROUP_NON_UNIFORM_I_ADD				= 349,
+	GROUP_NON_UNIFORM_F_ADD				= 350,
+	GROUP_NON_UNIFORM_I_MUL				= 351,
+	GROUP_NON_UNIFORM_F_MUL				= 352,
+	GROUP_NON_UNIFORM_S_MIN				= 353,
+	GROUP_NON_UNIFORM_U_MIN				= 354,
+	GROUP_NON_UNIFORM_F_MIN				= 355,
+	GROUP_NON_UNIFORM_S_MAX				= 356,
+	GROUP_NON_UNIFORM_U_MAX				= 357,
+	GROUP_NON_UNIFORM_F_MAX				= 358,
+	GROUP_NON_UNIFORM_BITWISE_AND		= 359,
+	GROUP_NON_UNIFORM_BITWISE_OR		= 360,
+	GROUP_NON_UNIFORM_BITWISE_XOR		= 361,
+	GROUP_NON_UNIFORM_LOGICAL_AND		= 362,
+	GROUP_NON_UNIFORM_LOGICAL_OR		= 363,
+	GROUP_NON_UNIFORM_LOGICAL_XOR		= 364
+};
+
+enum class spvDecoration_t : uint32 {
+	SPEC_ID			= 1,
+	BLOCK			= 2,
+	BUFFER_BLOCK	= 3,
+	ROW_MAJOR		= 4,
+	COL_MAJOR		= 5,
+	ARRAY_STRIDE	= 6,
+	MATRIX_STRIDE	= 7,
+	BUILT_IN		= 11,
+	NO_PERSPECTIVE	= 13,
+	FLAT			= 14,
+	LOCATION		= 30,
+	COMPONENT		= 31,
+	BINDING			= 33,
+	DESCRIPTOR_SET	= 34,
+	OFFSET			= 35
+};
+
+enum class spvBuiltIn_t : uint32 {
+	POSITION				= 0,
+	POINT_SIZE				= 1,
+	CLIP_DISTANCE			= 3,
+	CULL_DISTANCE			= 4,
+	VERTEX_ID				= 5,
+	INSTANCE_ID				= 6,
+	PRIMITIVE_ID			= 7,
+	FRAG_COORD				= 15,
+	POINT_COORD				= 16,
+	FRONT_FACING			= 17,
+	SAMPLE_MASK				= 20,
+	FRAG_DEPTH				= 22,
+	HELPER_INVOCATION		= 23,
+	NUM_WORKGROUPS			= 24,
+	WORKGROUP_SIZE			= 25,
+	WORKGROUP_ID			= 26,
+	LOCAL_INVOCATION_ID		= 27,
+	GLOBAL_INVOCATION_ID	= 28,
+	LOCAL_INVOCATION_INDEX	= 29,
+	SUBGROUP_SIZE			= 36,
+	NUM_SUBGROUPS			= 38,
+	SUBGROUP_ID				= 40,
+	SUBGROUP_LOCAL_INVOCATION_ID	= 41,
+	VERTEX_INDEX			= 42,
+	INSTANCE_INDEX			= 43,
+	SUBGROUP_EQ_MASK		= 4416,
+	SUBGROUP_GE_MASK		= 4417,
+	SUBGROUP_GT_MASK		= 4418,
+	SUBGROUP_LE_MASK		= 4419,
+	SUBGROUP_LT_MASK		= 4420
+};
+
+enum class spvStorageClass_t : uint32 {
+	UNIFORM_CONSTANT	= 0,
+	INPUT				= 1,
+	UNIFORM				= 2,
+	OUTPUT				= 3,
+	WORKGROUP			= 4,
+	CROSS_WORKGROUP		= 5,
+	PRIVATE				= 6,
+	FUNCTION			= 7,
+	GENERIC				= 8,
+	PUSH_CONSTANT		= 9,
+	ATOMIC_COUNTER		= 10,
+	IMAGE				= 11,
+	STORAGE_BUFFER		= 12
+};
+
+enum class spvScope_t : uint32 {
+	CROSS_DEVICE		= 0,
+	DEVICE				= 1,
+	WORKGROUP			= 2,
+	SUBGROUP			= 3,
+	INVOCATION			= 4
+};
+
+enum class spvGroupOperation_t : uint32 {
+	REDUCE				= 0,
+	INCLUSIVE_SCAN		= 1,
+	EXCLUSIVE_SCAN		= 2,
+	CLUSTERED_REDUCE	= 3
+};
+
+enum class spvExecutionModel_t : uint32 {
+	VERTEX					= 0,
+	TESSELLATION_CONTROL	= 1,
+	TESSELLATION_EVALUATION	= 2,
+	GEOMETRY				= 3,
+	FRAGMENT				= 4,
+	GL_COMPUTE				= 5
+};
+
+enum class spvExecutionMode_t : uint32 {
+	ORIGIN_UPPER_LEFT		= 7,
+	EARLY_FRAGMENT_TESTS	= 9,
+	DEPTH_REPLACING			= 12,
+	LOCAL_SIZE				= 17
+};
+
+enum class spvDim_t : uint32 {
+	DIM_1D					= 0,
+	DIM_2D					= 1,
+	DIM_3D					= 2,
+	CUBE					= 3,
+	RECT					= 4,
+	BUFFER					= 5,
+	SUBPASS_DATA			= 6
+};
+
+enum spvImageOperands_t {
+	SPV_IMAGE_OPERAND_BIAS			= BIT( 0 ),
+	SPV_IMAGE_OPERAND_LOD			= BIT( 1 ),
+	SPV_IMAGE_OPERAND_GRAD			= BIT( 2 ),
+	SPV_IMAGE_OPERAND_CONST_OFFSET	= BIT( 3 ),
+	SPV_IMAGE_OPERAND_OFFSET		= BIT( 4 ),
+	SPV_IMAGE_OPERAND_CONST_OFFSETS	= BIT( 5 ),
+	SPV_IMAGE_OPERAND_SAMPLE		= BIT( 6 ),
+	SPV_IMAGE_OPERAND_MIN_LOD		= BIT( 7 )
+};
+
+enum class glslStd450_t : uint32 {
+	ROUND			= 1,
+	ROUND_EVEN		= 2,
+	TRUNC			= 3,
+	F_ABS			= 4,
+	S_ABS			= 5,
+	F_SIGN			= 6,
+	S_SIGN			= 7,
+	FLOOR			= 8,
+	CEIL			= 9,
+	FRACT			= 10,
+	RADIANS			= 11,
+	DEGREES			= 12,
+	SIN				= 13,
+	COS				= 14,
+	TAN				= 15,
+	ASIN			= 16,
+	ACOS			= 17,
+	ATAN			= 18,
+	SINH			= 19,
+	COSH			= 20,
+	TANH			= 21,
+	ATAN2			= 25,
+	POW				= 26,
+	EXP				= 27,
+	LOG				= 28,
+	EXP2			= 29,
+	LOG2			= 30,
+	SQRT			= 31,
+	INVERSE_SQRT	= 32,
+	DETERMINANT		= 33,
+	F_MIN			= 37,
+	U_MIN			= 38,
+	S_MIN			= 39,
+	F_MAX			= 40,
+	U_MAX			= 41,
+	S_MAX			= 42,
+	F_CLAMP			= 43,
+	U_CLAMP			= 44,
+	S_CLAMP			= 45,
+	F_MIX			= 46,
+	STEP			= 48,
+	SMOOTH_STEP		= 49,
+	FMA				= 50,
+	LENGTH			= 66,
+	DISTANCE		= 67,
+	CROSS			= 68,
+	NORMALIZE		= 69,
+	FACE_FORWARD	= 70,
+	REFLECT			= 71,
+	REFRACT			= 72,
+	FIND_I_LSB		= 73,
+	FIND_U_MSB		= 75,
+	N_MIN			= 79,
+	N_MAX			= 80,
+	N_CLAMP			= 81
+};
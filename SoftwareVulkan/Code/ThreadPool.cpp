@@ -0,0 +1,325 @@
+#include "ThreadPool.h"
+#include <new>
+#include <string.h>
+
+#define THREAD_POOL_DEQUE_MASK ( THREAD_POOL_DEQUE_SIZE - 1 )
+#define THREAD_POOL_IDLE_SPINS 64
+#define THREAD_POOL_WAIT_SLICE_NS 1000000ULL
+
+static thread_local threadPoolWorker_t * currentWorker;
+
+/*
+================================================
+Chase-Lev deque
+================================================
+*/
+static void Deque_Init( jobDeque_t * deque ) {
+	deque->top.store( 0, std::memory_order_relaxed );
+	deque->bottom.store( 0, std::memory_order_relaxed );
+	for ( uint32 i = 0; i < THREAD_POOL_DEQUE_SIZE; i++ ) {
+		deque->slots[ i ].store( NULL, std::memory_order_relaxed );
+	}
+}
+
+static bool Deque_Push( jobDeque_t * deque, job_t * job ) {
+	int64 bottom = deque->bottom.load( std::memory_order_relaxed );
+	int64 top = deque->top.load( std::memory_order_acquire );
+	if ( bottom - top >= THREAD_POOL_DEQUE_SIZE ) {
+		return false;
+	}
+	deque->slots[ bottom & THREAD_POOL_DEQUE_MASK ].store( job, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+	deque->bottom.store( bottom + 1, std::memory_order_relaxed );
+	return true;
+}
+
+static job_t * Deque_Pop( jobDeque_t * deque ) {
+	int64 bottom = deque->bottom.load( std::memory_order_relaxed ) - 1;
+	deque->bottom.store( bottom, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	int64 top = deque->top.load( std::memory_order_relaxed );
+	if ( top > bottom ) {
+		deque->bottom.store( bottom + 1, std::memory_order_relaxed );
+		return NULL;
+	}
+	job_t * job = deque->slots[ bottom & THREAD_POOL_DEQUE_MASK ].load( std::memory_order_relaxed );
+	if ( top == bottom ) {
+		//Last job: race any thief for it
+		if ( !deque->top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+			job = NULL;
+		}
+		deque->bottom.store( bottom + 1, std::memory_order_relaxed );
+	}
+	return job;
+}
+
+static job_t * Deque_Steal( jobDeque_t * deque ) {
+	int64 top = deque->top.load( std::memory_order_acquire );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	int64 bottom = deque->bottom.load( std::memory_order_acquire );
+	if ( top >= bottom ) {
+		return NULL;
+	}
+	job_t * job = deque->slots[ top & THREAD_POOL_DEQUE_MASK ].load( std::memory_order_relaxed );
+	if ( !deque->top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+		return NULL;
+	}
+	return job;
+}
+
+/*
+================================================
+Injection queue
+================================================
+*/
+static void Injection_Push( threadPool_t * pool, job_t * pJobs, uint32 jobCount ) {
+	for ( uint32 i = 0; i < jobCount; i++ ) {
+		pJobs[ i ].pNextInjected = ( i + 1 < jobCount ) ? &pJobs[ i + 1 ] : NULL;
+	}
+	Platform_MutexLock( &pool->injectionLock );
+	if ( pool->pInjectedTail != NULL ) {
+		pool->pInjectedTail->pNextInjected = &pJobs[ 0 ];
+	} else {
+		pool->pInjectedHead = &pJobs[ 0 ];
+	}
+	pool->pInjectedTail = &pJobs[ jobCount - 1 ];
+	pool->injectedCount.fetch_add( jobCount, std::memory_order_seq_cst );
+	Platform_MutexUnlock( &pool->injectionLock );
+}
+
+//Takes the oldest injected job, or the oldest one of onlyGroup when it is set
+static job_t * Injection_Pop( threadPool_t * pool, jobGroup_t * onlyGroup ) {
+	if ( pool->injectedCount.load( std::memory_order_seq_cst ) == 0 ) {
+		return NULL;
+	}
+	Platform_MutexLock( &pool->injectionLock );
+	job_t * prev = NULL;
+	job_t * job = pool->pInjectedHead;
+	while ( job != NULL && onlyGroup != NULL && job->group != onlyGroup ) {
+		prev = job;
+		job = job->pNextInjected;
+	}
+	if ( job != NULL ) {
+		if ( prev != NULL ) {
+			prev->pNextInjected = job->pNextInjected;
+		} else {
+			pool->pInjectedHead = job->pNextInjected;
+		}
+		if ( pool->pInjectedTail == job ) {
+			pool->pInjectedTail = prev;
+		}
+		pool->injectedCount.fetch_sub( 1, std::memory_order_relaxed );
+	}
+	Platform_MutexUnlock( &pool->injectionLock );
+	return job;
+}
+
+/*
+================================================
+Workers
+================================================
+*/
+static void Job_Execute( job_t * job, uint32 workerIndex ) {
+	jobGroup_t * group = job->group;
+	job->func( job->pData, job->index, workerIndex );
+	if ( group->pending.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+		Platform_FutexWake( &group->pending, true );
+	}
+}
+
+static job_t * Worker_FindJob( threadPool_t * pool, threadPoolWorker_t * self ) {
+	job_t * job = Deque_Pop( &self->deque );
+	if ( job != NULL ) {
+		return job;
+	}
+	job = Injection_Pop( pool, NULL );
+	if ( job != NULL ) {
+		return job;
+	}
+	//xorshift picks where the sweep starts so thieves spread over victims instead of all hitting worker 1
+	self->stealSeed ^= self->stealSeed << 13;
+	self->stealSeed ^= self->stealSeed >> 17;
+	self->stealSeed ^= self->stealSeed << 5;
+	uint32 start = self->stealSeed % pool->workerCount;
+	for ( uint32 i = 0; i < pool->workerCount; i++ ) {
+		threadPoolWorker_t * victim = &pool->pWorkers[ ( start + i ) % pool->workerCount ];
+		if ( victim == self ) {
+			continue;
+		}
+		job = Deque_Steal( &victim->deque );
+		if ( job != NULL ) {
+			return job;
+		}
+	}
+	return NULL;
+}
+
+static void Worker_Main( void * pArgument ) {
+	threadPoolWorker_t * self = reinterpret_cast< threadPoolWorker_t * >( pArgument );
+	threadPool_t * pool = self->pool;
+	currentWorker = self;
+	uint32 idleSpins = 0;
+	while ( pool->shutdown.load( std::memory_order_acquire ) == 0 ) {
+		job_t * job = Worker_FindJob( pool, self );
+		if ( job != NULL ) {
+			Job_Execute( job, self->index );
+			idleSpins = 0;
+			continue;
+		}
+		if ( ++idleSpins < THREAD_POOL_IDLE_SPINS ) {
+			Platform_Yield();
+			continue;
+		}
+
+		//Announce the sleep before the final look, pairing with the fence in ThreadPool_Submit
+		uint32 epoch = pool->wakeEpoch.load( std::memory_order_acquire );
+		pool->sleeperCount.fetch_add( 1, std::memory_order_seq_cst );
+		job = Worker_FindJob( pool, self );
+		if ( job == NULL && pool->shutdown.load( std::memory_order_acquire ) == 0 ) {
+			Platform_FutexWait( &pool->wakeEpoch, epoch, PLATFORM_WAIT_INFINITE );
+		}
+		pool->sleeperCount.fetch_sub( 1, std::memory_order_relaxed );
+		if ( job != NULL ) {
+			Job_Execute( job, self->index );
+		}
+		idleSpins = 0;
+	}
+	currentWorker = NULL;
+}
+
+static void ThreadPool_WakeWorkers( threadPool_t * pool ) {
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	if ( pool->sleeperCount.load( std::memory_order_seq_cst ) != 0 ) {
+		pool->wakeEpoch.fetch_add( 1, std::memory_order_release );
+		Platform_FutexWake( &pool->wakeEpoch, true );
+	}
+}
+
+void ThreadPool_Init( threadPool_t * pool, const VkAllocationCallbacks * allocator, uint32 workerCount ) {
+	pool->allocator = allocator;
+	pool->workerCount = 0;
+	pool->pWorkers = NULL;
+	pool->shutdown.store( 0, std::memory_order_relaxed );
+	pool->wakeEpoch.store( 0, std::memory_order_relaxed );
+	pool->sleeperCount.store( 0, std::memory_order_relaxed );
+	Platform_MutexInit( &pool->injectionLock );
+	pool->pInjectedHead = NULL;
+	pool->pInjectedTail = NULL;
+	pool->injectedCount.store( 0, std::memory_order_relaxed );
+
+	if ( workerCount == 0 ) {
+		uint32 processors = Platform_ProcessorCount();
+		workerCount = ( processors > 1 ) ? processors - 1 : 0;
+	}
+	workerCount = Platform_GetEnvironmentUInt( "SOFTWARE_VULKAN_THREADS", workerCount );
+	workerCount = Min( workerCount, ( uint32 )THREAD_POOL_MAX_WORKERS );
+	if ( workerCount == 0 ) {
+		return;
+	}
+
+	pool->pWorkers = reinterpret_cast< threadPoolWorker_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( threadPoolWorker_t ) * workerCount, 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+	if ( pool->pWorkers == NULL ) {
+		return;
+	}
+	for ( uint32 i = 0; i < workerCount; i++ ) {
+		threadPoolWorker_t * worker = &pool->pWorkers[ i ];
+		worker->pool = pool;
+		worker->index = i + 1;
+		worker->stealSeed = 0x9E3779B9u * ( i + 1 );
+		Deque_Init( &worker->deque );
+	}
+	pool->workerCount = workerCount;
+	for ( uint32 i = 0; i < workerCount; i++ ) {
+		if ( !Platform_CreateThread( Worker_Main, &pool->pWorkers[ i ], &pool->pWorkers[ i ].thread ) ) {
+			//Run with the workers that did start; their deques are the only ones thieves will see
+			pool->workerCount = i;
+			break;
+		}
+	}
+}
+
+void ThreadPool_Shutdown( threadPool_t * pool ) {
+	pool->shutdown.store( 1, std::memory_order_release );
+	pool->wakeEpoch.fetch_add( 1, std::memory_order_release );
+	Platform_FutexWake( &pool->wakeEpoch, true );
+	for ( uint32 i = 0; i < pool->workerCount; i++ ) {
+		Platform_JoinThread( &pool->pWorkers[ i ].thread );
+	}
+	if ( pool->pWorkers != NULL ) {
+		pool->allocator->pfnFree( pool->allocator->pUserData, pool->pWorkers );
+	}
+	Platform_MutexDestroy( &pool->injectionLock );
+	pool->workerCount = 0;
+	pool->pWorkers = NULL;
+}
+
+uint32 ThreadPool_Concurrency( const threadPool_t * pool ) {
+	return pool->workerCount + 1;
+}
+
+uint32 ThreadPool_CurrentWorker() {
+	return ( currentWorker != NULL ) ? currentWorker->index : THREAD_POOL_EXTERNAL_WORKER;
+}
+
+void ThreadPool_Submit( threadPool_t * pool, job_t * pJobs, uint32 jobCount ) {
+	if ( jobCount == 0 ) {
+		return;
+	}
+	for ( uint32 i = 0; i < jobCount; i++ ) {
+		pJobs[ i ].group->pending.fetch_add( 1, std::memory_order_relaxed );
+	}
+	threadPoolWorker_t * self = currentWorker;
+	if ( self != NULL && self->pool == pool ) {
+		for ( uint32 i = 0; i < jobCount; i++ ) {
+			if ( !Deque_Push( &self->deque, &pJobs[ i ] ) ) {
+				//Deque full; running the job here keeps submission from ever failing
+				Job_Execute( &pJobs[ i ], self->index );
+			}
+		}
+	} else {
+		Injection_Push( pool, pJobs, jobCount );
+	}
+	if ( pool->workerCount != 0 ) {
+		ThreadPool_WakeWorkers( pool );
+	}
+}
+
+void ThreadPool_Wait( threadPool_t * pool, jobGroup_t * group ) {
+	threadPoolWorker_t * self = currentWorker;
+	if ( self != NULL && self->pool != pool ) {
+		self = NULL;
+	}
+	uint32 idleSpins = 0;
+	for ( ;; ) {
+		uint32 pending = group->pending.load( std::memory_order_acquire );
+		if ( pending == 0 ) {
+			return;
+		}
+		job_t * job = ( self != NULL ) ? Worker_FindJob( pool, self ) : Injection_Pop( pool, group );
+		if ( job != NULL ) {
+			Job_Execute( job, ( self != NULL ) ? self->index : THREAD_POOL_EXTERNAL_WORKER );
+			idleSpins = 0;
+			continue;
+		}
+		if ( ++idleSpins < THREAD_POOL_IDLE_SPINS ) {
+			Platform_Yield();
+			continue;
+		}
+		//Bounded sleep: work can appear in a deque without anyone waking this thread
+		Platform_FutexWait( &group->pending, pending, THREAD_POOL_WAIT_SLICE_NS );
+	}
+}
+
+void ThreadPool_ParallelFor( threadPool_t * pool, job_t * pJobs, uint32 jobCount, jobFunc_t func, void * pData ) {
+	jobGroup_t group;
+	group.pending.store( 0, std::memory_order_relaxed );
+	for ( uint32 i = 0; i < jobCount; i++ ) {
+		pJobs[ i ].func = func;
+		pJobs[ i ].pData = pData;
+		pJobs[ i ].index = i;
+		pJobs[ i ].group = &group;
+		pJobs[ i ].pNextInjected = NULL;
+	}
+	ThreadPool_Submit( pool, pJobs, jobCount );
+	ThreadPool_Wait( pool, &group );
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Common.h"
+#include "Platform.h"
+#include "vulkan/vulkan.h"
+#include <atomic>
+
+#define THREAD_POOL_MAX_WORKERS 256
+#define THREAD_POOL_DEQUE_SIZE 4096
+//Index reported by ThreadPool_CurrentWorker for any thread the pool did not create
+#define THREAD_POOL_EXTERNAL_WORKER 0
+
+struct jobGroup_t {
+	std::atomic< uint32 >	pending;
+};
+
+//workerIndex is 1..workerCount on pool threads and THREAD_POOL_EXTERNAL_WORKER on the thread that waits
+typedef void ( * jobFunc_t )( void * pData, uint32 index, uint32 workerIndex );
+
+struct job_t {
+	jobFunc_t		func;
+	void *			pData;
+	uint32			index;
+	jobGroup_t *	group;
+	job_t *			pNextInjected;
+};
+
+//Chase-Lev deque: the owning worker pushes and pops at the bottom, thieves take from the top
+struct jobDeque_t {
+	alignas( 64 ) std::atomic< int64 >	top;
+	alignas( 64 ) std::atomic< int64 >	bottom;
+	std::atomic< job_t * >				slots[ THREAD_POOL_DEQUE_SIZE ];
+};
+
+struct threadPool_t;
+
+struct threadPoolWorker_t {
+	threadPool_t *		pool;
+	uint32				index;
+	uint32				stealSeed;
+	platformThread_t	thread;
+	jobDeque_t			deque;
+};
+
+/*
+================================================
+threadPool_t
+
+Work-stealing pool with one worker per hardware thread, minus the thread that submits and waits, which
+executes jobs too.  Jobs submitted from outside the pool land in a shared injection queue; jobs submitted
+from a worker go to the bottom of its own deque, so nested work stays cache-warm, and idle workers steal
+from the top of a random victim.  Workers that find nothing sleep on a futex until the next submission.
+
+A waiting thread from outside the pool only runs injected jobs of the group it waits on, so a job sees
+THREAD_POOL_EXTERNAL_WORKER only on the thread that owns its group, and the owner can keep one slot of
+per-worker scratch for it.
+
+Jobs and their group must stay alive until ThreadPool_Wait on that group returns.
+================================================
+*/
+struct threadPool_t {
+	const VkAllocationCallbacks *	allocator;
+	uint32							workerCount;
+	threadPoolWorker_t *			pWorkers;
+	std::atomic< uint32 >			shutdown;
+	std::atomic< uint32 >			wakeEpoch;
+	std::atomic< uint32 >			sleeperCount;
+
+	platformMutex_t					injectionLock;
+	job_t *							pInjectedHead;
+	job_t *							pInjectedTail;
+	std::atomic< uint32 >			injectedCount;
+};
+
+//workerCount of 0 sizes the pool to the machine; SOFTWARE_VULKAN_THREADS overrides either
+void	ThreadPool_Init( threadPool_t * pool, const VkAllocationCallbacks * allocator, uint32 workerCount );
+void	ThreadPool_Shutdown( threadPool_t * pool );
+//Threads that can run jobs concurrently, counting the waiting thread
+uint32	ThreadPool_Concurrency( const threadPool_t * pool );
+uint32	ThreadPool_CurrentWorker();
+void	ThreadPool_Submit( threadPool_t * pool, job_t * pJobs, uint32 jobCount );
+void	ThreadPool_Wait( threadPool_t * pool, jobGroup_t * group );
+//Fills pJobs with jobCount calls of func over [ 0, jobCount ), submits them and waits
+void	ThreadPool_ParallelFor( threadPool_t * pool, job_t * pJobs, uint32 jobCount, jobFunc_t func, void * pData );
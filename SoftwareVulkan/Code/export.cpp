@@ -1,26 +1,44 @@
 #include "Common.h"
+#if defined( _WIN32 )
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #include "vulkan/vk_icd.h"
+#include "ObjectTable.h"
+#include "DeviceHeap.h"
+#include "Format.h"
+#include "HostAllocator.h"
+#include "CommandBuffer.h"
+#include "Cpu.h"
+#include "Descriptor.h"
+#include "ImageClear.h"
+#include "ImageLayout.h"
+#include "Pipeline.h"
+#include "PresentRing.h"
+#include "PresentScheduler.h"
+#include "Queue.h"
+#include "Rasterizer.h"
+#include "Sampler.h"
+#include "Shader.h"
+#include "ThreadPool.h"
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
 #include <windows.h>
+#endif
+#include <stdio.h>
 #include <string.h>
 #include <vector>
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
 #include <dxgi.h>
 #include <d3d11.h>
 
 #pragma comment( lib, "dxgi" )
 #pragma comment( lib, "d3d11" )
+#endif
 
+#if defined( _WIN32 )
 #define VK_ICD_EXPORT extern "C" __declspec( dllexport )
-#define VK_PATCH_FUNCTION( funcName ) do {\
-if ( !strcmp( pName, #funcName ) ) {\
-	return ( PFN_vkVoidFunction )&funcName;\
-} } while ( false )
-
-#define VK_DENY_FUNCTION( funcName ) do {\
-if ( !strcmp( pName, #funcName ) ) {\
-	return NULL;\
-} } while ( false )
-
+#else
+#define VK_ICD_EXPORT extern "C" __attribute__( ( visibility( "default" ) ) )
+#endif
 #define VK_VALIDATION_FAILED_LABEL validationFailed
 
 #define VK_VALIDATE( cond ) do { if ( ( cond ) == false ) { goto VK_VALIDATION_FAILED_LABEL; } } while ( false )
@@ -29,76 +47,6 @@ if ( !strcmp( pName, #funcName ) ) {\
 
 #define VK_ASSERT_SUBCALL( result ) do { if ( ( result ) != VK_SUCCESS ) { goto VK_SUBCALL_FAILED_LABEL; } } while ( false )
 
-struct allocationInfo_t {
-	size_t offsetFromBeginningOfBlock;
-	size_t alignment;
-	size_t size;
-};
-
-static void * VKAPI_PTR vkAllocateHostMemory( void *, size_t size, size_t alignment, VkSystemAllocationScope ) {
-	size_t fullAllocation = size + ( alignment - 1 ) + sizeof( allocationInfo_t );
-	void * baseAllocation = malloc( fullAllocation );
-	size_t valuePtr = reinterpret_cast< size_t >( baseAllocation );
-	size_t offsetFromAlignment = ( alignment - ( valuePtr % alignment ) );
-	while ( offsetFromAlignment < sizeof( allocationInfo_t ) ) {
-		offsetFromAlignment += alignment;
-	}
-	offsetFromAlignment -= sizeof( allocationInfo_t );
-	valuePtr += offsetFromAlignment;
-	allocationInfo_t * offsetStorage = reinterpret_cast< allocationInfo_t * >( valuePtr );
-	offsetStorage->offsetFromBeginningOfBlock = offsetFromAlignment;
-	offsetStorage->alignment = alignment;
-	offsetStorage->size = fullAllocation - offsetFromAlignment - sizeof( allocationInfo_t );
-	return offsetStorage + 1;
-}
-
-static void VKAPI_PTR vkFreeHostMemory( void *, void * pMemory ) {
-	allocationInfo_t * offsetStorage = reinterpret_cast< allocationInfo_t * >( pMemory );
-	--offsetStorage;
-	size_t offsetFromBlockBeginning = offsetStorage->offsetFromBeginningOfBlock;
-	size_t valuePtr = reinterpret_cast< size_t >( offsetStorage );
-	valuePtr -= offsetFromBlockBeginning;
-	void * toDelete = reinterpret_cast< void * >( valuePtr );
-	free( toDelete );
-}
-
-static void * VKAPI_PTR vkReallocateHostMemory( void * pUserData, void * pOriginal, size_t size, size_t alignment, VkSystemAllocationScope allocationScope ) {
-	if ( pOriginal == NULL ) {
-		return vkAllocateHostMemory( pUserData, size, alignment, allocationScope );
-	}
-
-	if ( size == 0 ) {
-		vkFreeHostMemory( pUserData, pOriginal );
-		return NULL;
-	}
-
-	allocationInfo_t * allocInfo = reinterpret_cast< allocationInfo_t * >( pOriginal );
-	--allocInfo;
-	if ( allocInfo->alignment != alignment ) {
-		return NULL;
-	}
-
-	if ( allocInfo->size >= size ) {
-		return pOriginal;
-	}
-
-	void * result = vkAllocateHostMemory( pUserData, size, alignment, allocationScope );
-	memcpy( result, pOriginal, Min( size, allocInfo->size ) );
-
-	vkFreeHostMemory( pUserData, pOriginal );
-
-	return result;
-}
-
-VkAllocationCallbacks defaultAllocator = {
-	NULL,
-	vkAllocateHostMemory,
-	vkReallocateHostMemory,
-	vkFreeHostMemory,
-	NULL,
-	NULL
-};
-
 struct VkDispatchObject_t {
 	VK_LOADER_DATA loaderData;
 };
@@ -108,15 +56,23 @@ struct VkPhysicalDevice_t : VkDispatchObject_t {
 	VkPhysicalDeviceFeatures	supportedFeatures;
 	VkQueueFamilyProperties *	pQueueFamilyProperties;
 	uint32						queueFamilyPropertyCount;
+	cpuIsa_t					isa;				//widest SIMD the kernels may use on this host
 };
 
+//Bits follow the order of supportedInstanceExtensions, so platform-specific names go last
 enum class instanceExtensions_t {
-	SURFACE_KHR =		BIT( 0 ),
-	WIN32_SURFACE_KHR = BIT( 1 )
+	SURFACE_KHR =							BIT( 0 ),
+	HEADLESS_SURFACE_EXT =					BIT( 1 ),
+	GET_PHYSICAL_DEVICE_PROPERTIES_2_KHR =	BIT( 2 ),
+	WIN32_SURFACE_KHR =						BIT( 3 )
 };
 static const char * supportedInstanceExtensions[] = {
 	VK_KHR_SURFACE_EXTENSION_NAME,
+	VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME,
+	VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
 	VK_KHR_WIN32_SURFACE_EXTENSION_NAME
+#endif
 };
 
 template< typename __enumType__ >
@@ -173,6 +129,7 @@ VkResult VKAPI_CALL vkCreateInstance( const VkInstanceCreateInfo * pCreateInfo,
 
 	VkPhysicalDevice_t * device = &instance->physicalDevices[ 0 ];
 	set_loader_magic_value( device );
+	device->isa = Cpu_DetectIsa();
 	VkPhysicalDeviceProperties & properties = device->properties;
 	properties.apiVersion = VK_MAKE_VERSION( 1, 0, VK_HEADER_VERSION );
 	properties.deviceID = 'R' << 24 | 'C' << 16 | 'S' << 8 | 'R';
@@ -203,7 +160,7 @@ VkResult VKAPI_CALL vkCreateInstance( const VkInstanceCreateInfo * pCreateInfo,
 		/* uint32_t              maxSamplerAllocationCount;						  */ 1024,
 		/* VkDeviceSize          bufferImageGranularity;						  */ 4,
 		/* VkDeviceSize          sparseAddressSpaceSize;						  */ 0,
-		/* uint32_t              maxBoundDescriptorSets;						  */ 16,
+		/* uint32_t              maxBoundDescriptorSets;						  */ COMMAND_MAX_DESCRIPTOR_SETS,
 		/* uint32_t              maxPerStageDescriptorSamplers;					  */ 128,
 		/* uint32_t              maxPerStageDescriptorUniformBuffers;			  */ 128,
 		/* uint32_t              maxPerStageDescriptorStorageBuffers;			  */ 128,
@@ -213,9 +170,9 @@ VkResult VKAPI_CALL vkCreateInstance( const VkInstanceCreateInfo * pCreateInfo,
 		/* uint32_t              maxPerStageResources;							  */ 256,
 		/* uint32_t              maxDescriptorSetSamplers;						  */ 256,
 		/* uint32_t              maxDescriptorSetUniformBuffers;				  */ 256,
-		/* uint32_t              maxDescriptorSetUniformBuffersDynamic;			  */ 256,
+		/* uint32_t              maxDescriptorSetUniformBuffersDynamic;			  */ DESCRIPTOR_MAX_DYNAMIC_BUFFERS / 2,
 		/* uint32_t              maxDescriptorSetStorageBuffers;				  */ 256,
-		/* uint32_t              maxDescriptorSetStorageBuffersDynamic;			  */ 256,
+		/* uint32_t              maxDescriptorSetStorageBuffersDynamic;			  */ DESCRIPTOR_MAX_DYNAMIC_BUFFERS / 2,
 		/* uint32_t              maxDescriptorSetSampledImages;					  */ 256,
 		/* uint32_t              maxDescriptorSetStorageImages;					  */ 256,
 		/* uint32_t              maxDescriptorSetInputAttachments;				  */ 256,
@@ -241,17 +198,17 @@ VkResult VKAPI_CALL vkCreateInstance( const VkInstanceCreateInfo * pCreateInfo,
 		/* uint32_t              maxFragmentOutputAttachments;					  */ 16,
 		/* uint32_t              maxFragmentDualSrcAttachments;					  */ 0,
 		/* uint32_t              maxFragmentCombinedOutputResources;			  */ 64,
-		/* uint32_t              maxComputeSharedMemorySize;					  */ 16 * 1024,
+		/* uint32_t              maxComputeSharedMemorySize;					  */ SHADER_MAX_WORKGROUP_MEMORY,
 		/* uint32_t              maxComputeWorkGroupCount[ 3 ];					  */ { 4ULL * 1024 * 1024 * 1024 - 1, 65536, 64 },
-		/* uint32_t              maxComputeWorkGroupInvocations;				  */ 256,
+		/* uint32_t              maxComputeWorkGroupInvocations;				  */ SHADER_MAX_WORKGROUP_INVOCATIONS,
 		/* uint32_t              maxComputeWorkGroupSize[ 3 ];					  */ { 64, 64, 32 },
-		/* uint32_t              subPixelPrecisionBits;							  */ 8,
+		/* uint32_t              subPixelPrecisionBits;							  */ RASTER_SUBPIXEL_BITS,
 		/* uint32_t              subTexelPrecisionBits;							  */ 12,
 		/* uint32_t              mipmapPrecisionBits;							  */ 5,
 		/* uint32_t              maxDrawIndexedIndexValue;						  */ 4ULL * 1024 * 1024 * 1024 - 1,
 		/* uint32_t              maxDrawIndirectCount;							  */ 2048,
-		/* float                 maxSamplerLodBias;								  */ 0.0f,
-		/* float                 maxSamplerAnisotropy;							  */ 0.0f,
+		/* float                 maxSamplerLodBias;								  */ SAMPLER_MAX_LOD_BIAS,
+		/* float                 maxSamplerAnisotropy;							  */ SAMPLER_MAX_ANISOTROPY,
 		/* uint32_t              maxViewports;									  */ 8,
 		/* uint32_t              maxViewportDimensions[ 2 ];					  */ { 2048, 2048 },
 		/* float                 viewportBoundsRange[ 2 ];						  */ { -2048.0f, 2047.0f },
@@ -304,6 +261,9 @@ VkResult VKAPI_CALL vkCreateInstance( const VkInstanceCreateInfo * pCreateInfo,
 	features.independentBlend = VK_TRUE;
 	features.multiDrawIndirect = VK_TRUE;
 	features.multiViewport = VK_TRUE;
+	features.samplerAnisotropy = VK_TRUE;
+	features.textureCompressionETC2 = VK_TRUE;
+	features.textureCompressionBC = VK_TRUE;
 	device->queueFamilyPropertyCount = 1;
 	device->pQueueFamilyProperties = reinterpret_cast< VkQueueFamilyProperties * >( allocator->pfnAllocation( allocator->pUserData, sizeof( VkQueueFamilyProperties ), 4, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE ) );
 	VkQueueFamilyProperties & queueFamilyProperties = device->pQueueFamilyProperties[ 0 ];
@@ -329,7 +289,7 @@ VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties( const char * pLayerN
 	uint32 propertiesToWrite = Min( *pPropertyCount, ARRAY_LENGTH( supportedInstanceExtensions ) );
 	for ( uint32 i = 0; i < propertiesToWrite; i++ ) {
 		pProperties[ i ].specVersion = VK_MAKE_VERSION( 1, 0, VK_HEADER_VERSION );
-		strcpy_s( pProperties[ i ].extensionName, supportedInstanceExtensions[ i ] );
+		snprintf( pProperties[ i ].extensionName, sizeof( pProperties[ i ].extensionName ), "%s", supportedInstanceExtensions[ i ] );
 	}
 	*pPropertyCount = propertiesToWrite;
 	if ( propertiesToWrite < ARRAY_LENGTH( supportedInstanceExtensions ) ) {
@@ -363,14 +323,37 @@ VkResult VKAPI_CALL vkEnumeratePhysicalDevices( VkInstance instance, uint32 * pP
 	return VK_SUCCESS;
 }
 
+//Walks a pNext chain for the structure of type sType
+static const void * Vk_FindInChain( const void * pNext, VkStructureType sType ) {
+	struct chainHeader_t {
+		VkStructureType	sType;
+		const void *	pNext;
+	};
+	while ( pNext != NULL ) {
+		const chainHeader_t * header = reinterpret_cast< const chainHeader_t * >( pNext );
+		if ( header->sType == sType ) {
+			return pNext;
+		}
+		pNext = header->pNext;
+	}
+	return NULL;
+}
+
 void VKAPI_CALL vkGetPhysicalDeviceFeatures( VkPhysicalDevice vPhysicalDevice, VkPhysicalDeviceFeatures * pFeatures ) {
 	VkPhysicalDevice_t * physicalDevice = reinterpret_cast< VkPhysicalDevice_t * >( vPhysicalDevice );
 	*pFeatures = physicalDevice->supportedFeatures;
 }
 
 void VKAPI_CALL vkGetPhysicalDeviceFormatProperties( VkPhysicalDevice physicalDevice, VkFormat format, VkFormatProperties * pFormatProperties ) {
-	pFormatProperties = NULL;
 	*pFormatProperties = VkFormatProperties();
+	const formatInfo_t * info = Format_Find( format );
+	if ( info != NULL ) {
+		pFormatProperties->linearTilingFeatures = info->linearFeatures;
+		pFormatProperties->optimalTilingFeatures = info->optimalFeatures;
+	}
+	if ( Pipeline_FindVertexFormat( format ) != NULL ) {
+		pFormatProperties->bufferFeatures |= VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT;
+	}
 }
 
 void VKAPI_CALL vkGetPhysicalDeviceProperties( VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties * pProperties ) {
@@ -394,15 +377,22 @@ void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties( VkPhysicalDevice vPhys
 }
 
 enum class deviceExtension_t {
-	SWAPCHAIN_KHR = BIT( 0 )
+	SWAPCHAIN_KHR =				BIT( 0 ),
+	TIMELINE_SEMAPHORE_KHR =	BIT( 1 ),
+	DRAW_INDIRECT_COUNT_KHR =	BIT( 2 )
 };
 typedef VkBitFlags< deviceExtension_t > idDeviceExtensionFlags;
 static const char * supportedDeviceExtensions[] = {
-	VK_KHR_SWAPCHAIN_EXTENSION_NAME
+	VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+	VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
+	VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME
 };
 
-struct VkQueue_t : public VkDispatchObject_t {
+struct VkDevice_t;
 
+struct VkQueue_t : public VkDispatchObject_t {
+	VkDevice_t *	device;
+	queue_t *		queue;				//separate allocation, the worker holds on to it while pQueues grows
 };
 
 struct VkDeviceObject_t {
@@ -415,19 +405,31 @@ struct VkQueueFamily_t {
 };
 
 struct VkSwapchainImage_t {
-	VkImage			image;
-	VkDeviceMemory	memory;
+	VkImage				image;
+	VkDeviceMemory		memory;
+	uint8 *				data;				//linear rows inside the presentation backing store
+	imageClearState_t *	clearState;			//resolved before every present
 };
 
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+//A DIB section over a pagefile-backed section; the swapchain image's memory is the DIB's pixels
 struct VkInternalImage_t {
+	HANDLE	section;
 	HBITMAP	bitmap;
 	HDC		dc;
 };
+#endif
 
 struct VkSwapchain_t : public VkDeviceObject_t {
+	VkIcdWsiPlatform		platform;
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
 	IDXGISwapChain *		internalSwapchain;
 	IDXGISurface1 *			internalBackbuffer;
 	VkInternalImage_t *		pInternalImages;
+#endif
+	presentRing_t			ring;				//headless: the images live in it
+	presentScheduler_t		scheduler;
+	queueCall_t				presentCall;		//queued by vkQueuePresentKHR behind the present's waits
 	VkExtent2D				extent;
 	VkFormat				imageFormat;
 	VkPresentModeKHR		presentMode;
@@ -444,31 +446,149 @@ enum class handleClass_t {
 	IMAGE,
 	DEVICE_MEMORY,
 	RENDER_PASS,
+	SHADER_MODULE,
+	PIPELINE,
+	PIPELINE_CACHE,
+	BUFFER,
+	IMAGE_VIEW,
+	FRAMEBUFFER,
+	COMMAND_POOL,
+	FENCE,
+	SEMAPHORE,
+	SAMPLER,
+	DESCRIPTOR_SET_LAYOUT,
+	PIPELINE_LAYOUT,
+	DESCRIPTOR_POOL,
+	DESCRIPTOR_SET,
 };
 
-#define HANDLE_CLASS_BITS 16
-#define ENCODE_OBJECT_HANDLE( handleClass, handle ) ( ( ( uint64 )handleClass << ( 64ULL - HANDLE_CLASS_BITS ) ) + ( uint64 )handle )
-#define DECODE_OBJECT_HANDLE( handle ) ( ( uint64 )handle & ( ( 1ULL << ( 64ULL - HANDLE_CLASS_BITS ) ) - 1ULL ) )
-#define DECODE_OBJECT_CLASS( handle ) ( ( ( uint64 )handle >> ( 64ULL - HANDLE_CLASS_BITS ) ) & ( ( 1ULL << HANDLE_CLASS_BITS ) - 1ULL ) )
+struct VkDeviceMemory_t;
 
 struct VkImage_t : public VkDeviceObject_t {
-	VkExtent3D	extent;
-	void *		data;
+	VkExtent3D			extent;
+	VkFormat			format;
+	VkImageUsageFlags	usage;
+	imageLayout_t		layout;
+	imageClearState_t	clearState;			//untracked images are cleared in full by every clear
+	VkDeviceMemory_t *	memory;				//NULL until bound
+	VkDeviceSize		memoryOffset;
+	void *				data;				//NULL while the bound memory is lazily allocated and not yet committed
 };
 
 struct VkDeviceMemory_t : public VkDeviceObject_t {
-	void * data;
+	void *				data;
+	deviceAllocation_t	allocation;
+	bool				lazy;				//lazily allocated: data stays NULL until an image bound to it needs storage
 };
 
 struct VkAttachmentDescription_t {
 	VkFormat			format;
 	VkAttachmentLoadOp	loadOp;
 	VkAttachmentStoreOp storeOp;
+	VkAttachmentLoadOp	stencilLoadOp;
+	VkAttachmentStoreOp	stencilStoreOp;
+};
+
+//Attachment indices, VK_ATTACHMENT_UNUSED when the subpass has none; only the first color attachment is rendered
+struct VkSubpassDescription_t {
+	uint32	colorAttachment;
+	uint32	depthAttachment;
 };
 
 struct VkRenderPass_t : public VkDeviceObject_t {
 	VkAttachmentDescription_t *	pAttachments;
 	uint32						attachmentCount;
+	VkSubpassDescription_t *	pSubpasses;
+	uint32						subpassCount;
+};
+
+struct VkShaderModule_t : public VkDeviceObject_t {
+	shaderModule_t	module;
+};
+
+struct VkPipelineCache_t : public VkDeviceObject_t {
+	pipelineCache_t	cache;
+};
+
+struct VkPipeline_t : public VkDeviceObject_t {
+	VkPipelineBindPoint	bindPoint;
+	graphicsPipeline_t	graphics;
+	computePipeline_t	compute;
+};
+
+struct VkBuffer_t : public VkDeviceObject_t {
+	VkDeviceSize	size;
+	uint8 *			data;				//NULL until memory is bound
+};
+
+struct VkImageView_t : public VkDeviceObject_t {
+	VkImage_t *		image;
+	VkFormat		format;
+	uint32			baseMipLevel;
+	uint32			baseArrayLayer;
+	sampledImage_t	sampled;			//what descriptors point at; its layout is NULL when the view cannot be sampled
+};
+
+struct VkSampler_t : public VkDeviceObject_t {
+	sampler_t	sampler;
+};
+
+struct VkDescriptorSetLayout_t : public VkDeviceObject_t {
+	descriptorSetLayout_t	layout;
+};
+
+//Sets are laid out from the descriptor set layouts at bind time, so a pipeline layout has nothing to hold
+struct VkPipelineLayout_t : public VkDeviceObject_t {
+};
+
+struct VkDescriptorSet_t;
+
+struct VkDescriptorPool_t : public VkDeviceObject_t {
+	VkDescriptorSet_t *	pSets;				//every set allocated from the pool, so resetting or destroying it frees them
+};
+
+struct VkDescriptorSet_t : public VkDeviceObject_t {
+	VkDescriptorSet			handle;
+	VkDescriptorPool_t *	pool;
+	VkDescriptorSet_t *		pPrev;
+	VkDescriptorSet_t *		pNext;
+	descriptorSet_t			set;
+};
+
+struct VkFramebuffer_t : public VkDeviceObject_t {
+	VkImageView_t **	ppAttachments;
+	uint32				attachmentCount;
+	uint32				width;
+	uint32				height;
+};
+
+struct VkCommandBuffer_t;
+
+struct VkCommandPool_t : public VkDeviceObject_t {
+	commandPool_t		pool;
+	VkCommandBuffer_t *	pCommandBuffers;	//every buffer allocated from the pool, so destroying it frees them
+};
+
+struct VkCommandBuffer_t : public VkDispatchObject_t {
+	VkDevice_t *			device;
+	VkCommandPool_t *		pool;
+	VkCommandBuffer_t *		pPrev;
+	VkCommandBuffer_t *		pNext;
+	//Render pass being recorded
+	const VkRenderPass_t *	renderPass;
+	const VkFramebuffer_t *	framebuffer;
+	uint32					subpass;
+	VkRect2D				renderArea;
+	const VkClearValue *	pClearValues;		//copied into the pool's arena
+	commandBuffer_t			commandBuffer;
+};
+
+struct VkFence_t : public VkDeviceObject_t {
+	syncFence_t		fence;
+};
+
+struct VkSemaphore_t : public VkDeviceObject_t {
+	syncSemaphore_t	semaphore;
 };
 
 struct VkDevice_t : public VkDispatchObject_t {
@@ -477,16 +597,48 @@ struct VkDevice_t : public VkDispatchObject_t {
 	VkPhysicalDeviceFeatures	enabledFeatures;
 	VkQueueFamily_t *			pQueueFamilies;
 	uint32						queueFamilyCount;
-	VkSwapchain_t *				pSwapchains;
-	uint64						currentSwapchainHandle;
-	VkImage_t *					pImages;
-	uint64						currentImageHandle;
-	VkDeviceMemory_t *			pMemories;
-	uint64						currentMemoryHandle;
-	VkRenderPass_t *			pRenderPasses;
-	uint64						currentRenderPassHandle;
+	VkAllocationCallbacks		allocator;
+	hostArena_t					hostArena;
+	deviceHeap_t				heap;
+	platformMutex_t				commitLock;			//lazily allocated memory getting its backing store
+	threadPool_t				threadPool;
+	rasterizer_t				rasterizer;
+	commandExecutor_t			executor;
+	syncEvent_t					syncEvent;			//notified by every fence and semaphore signal
+	VkObjectTable< VkSwapchain_t >		swapchains;
+	VkObjectTable< VkImage_t >			images;
+	VkObjectTable< VkDeviceMemory_t >	memories;
+	VkObjectTable< VkRenderPass_t >		renderPasses;
+	VkObjectTable< VkShaderModule_t >	shaderModules;
+	VkObjectTable< VkPipeline_t >		pipelines;
+	VkObjectTable< VkPipelineCache_t >	pipelineCaches;
+	VkObjectTable< VkBuffer_t >			buffers;
+	VkObjectTable< VkImageView_t >		imageViews;
+	VkObjectTable< VkFramebuffer_t >	framebuffers;
+	VkObjectTable< VkCommandPool_t >	commandPools;
+	VkObjectTable< VkFence_t >			fences;
+	VkObjectTable< VkSemaphore_t >		semaphores;
+	VkObjectTable< VkSampler_t >		samplers;
+	VkObjectTable< VkDescriptorSetLayout_t >	descriptorSetLayouts;
+	VkObjectTable< VkPipelineLayout_t >	pipelineLayouts;
+	VkObjectTable< VkDescriptorPool_t >	descriptorPools;
+	VkObjectTable< VkDescriptorSet_t >	descriptorSets;
 };
 
+static void Device_ShutdownQueues( VkDevice_t * device ) {
+	for ( uint32 i = 0; i < device->queueFamilyCount; i++ ) {
+		VkQueueFamily_t * queueFamily = &device->pQueueFamilies[ i ];
+		for ( uint32 j = 0; j < queueFamily->queueCount; j++ ) {
+			queue_t * queue = queueFamily->pQueues[ j ].queue;
+			if ( queue != NULL ) {
+				Queue_Shutdown( queue );
+				device->allocator.pfnFree( device->allocator.pUserData, queue );
+				queueFamily->pQueues[ j ].queue = NULL;
+			}
+		}
+	}
+}
+
 VkResult VKAPI_CALL vkCreateDevice( VkPhysicalDevice vPhysicalDevice, const VkDeviceCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkDevice * pDevice ) {
 	for ( uint32 i = 0; i < pCreateInfo->enabledExtensionCount; i++ ) {
 		bool foundExtension = false;
@@ -506,9 +658,33 @@ VkResult VKAPI_CALL vkCreateDevice( VkPhysicalDevice vPhysicalDevice, const VkDe
 
 	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( VkDevice_t ), 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
-	memset( device, 0, sizeof( *device ) );
+	new ( device ) VkDevice_t();
 	set_loader_magic_value( device );
 	device->physicalDevice = physicalDevice;
+	if ( pAllocator != NULL ) {
+		device->allocator = *pAllocator;
+	} else {
+		HostArena_Init( &device->hostArena, true );
+		HostAllocator_MakeDeviceCallbacks( &device->hostArena, &device->allocator );
+	}
+	device->swapchains.Init( ( uint32 )handleClass_t::SWAPCHAIN, &device->allocator );
+	device->images.Init( ( uint32 )handleClass_t::IMAGE, &device->allocator );
+	device->memories.Init( ( uint32 )handleClass_t::DEVICE_MEMORY, &device->allocator );
+	device->renderPasses.Init( ( uint32 )handleClass_t::RENDER_PASS, &device->allocator );
+	device->shaderModules.Init( ( uint32 )handleClass_t::SHADER_MODULE, &device->allocator );
+	device->pipelines.Init( ( uint32 )handleClass_t::PIPELINE, &device->allocator );
+	device->pipelineCaches.Init( ( uint32 )handleClass_t::PIPELINE_CACHE, &device->allocator );
+	device->buffers.Init( ( uint32 )handleClass_t::BUFFER, &device->allocator );
+	device->imageViews.Init( ( uint32 )handleClass_t::IMAGE_VIEW, &device->allocator );
+	device->framebuffers.Init( ( uint32 )handleClass_t::FRAMEBUFFER, &device->allocator );
+	device->commandPools.Init( ( uint32 )handleClass_t::COMMAND_POOL, &device->allocator );
+	device->fences.Init( ( uint32 )handleClass_t::FENCE, &device->allocator );
+	device->semaphores.Init( ( uint32 )handleClass_t::SEMAPHORE, &device->allocator );
+	device->samplers.Init( ( uint32 )handleClass_t::SAMPLER, &device->allocator );
+	device->descriptorSetLayouts.Init( ( uint32 )handleClass_t::DESCRIPTOR_SET_LAYOUT, &device->allocator );
+	device->pipelineLayouts.Init( ( uint32 )handleClass_t::PIPELINE_LAYOUT, &device->allocator );
+	device->descriptorPools.Init( ( uint32 )handleClass_t::DESCRIPTOR_POOL, &device->allocator );
+	device->descriptorSets.Init( ( uint32 )handleClass_t::DESCRIPTOR_SET, &device->allocator );
 	device->enabledExtensions.Clear();
 	for ( uint32 i = 0; i < pCreateInfo->enabledExtensionCount; i++ ) {
 		for ( uint32 j = 0; j < ARRAY_LENGTH( supportedDeviceExtensions ); j++ ) {
@@ -556,17 +732,56 @@ VkResult VKAPI_CALL vkCreateDevice( VkPhysicalDevice vPhysicalDevice, const VkDe
 		}
 		VkQueueFamily_t * queueFamily = &device->pQueueFamilies[ queueCreateInfo.queueFamilyIndex ];
 		uint32 oldQueueCount = queueFamily->queueCount;
-		queueFamily->pQueues = reinterpret_cast< VkQueue_t * >( allocator->pfnReallocation( allocator->pUserData, queueFamily->pQueues, sizeof( VkQueue_t ) * queueFamily->queueCount + queueCreateInfo.queueCount, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+		queueFamily->pQueues = reinterpret_cast< VkQueue_t * >( allocator->pfnReallocation( allocator->pUserData, queueFamily->pQueues, sizeof( VkQueue_t ) * ( queueFamily->queueCount + queueCreateInfo.queueCount ), 8, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
 		queueFamily->queueCount += queueCreateInfo.queueCount;
 		for ( uint32 j = oldQueueCount; j < queueFamily->queueCount; j++ ) {
 			memset( &queueFamily->pQueues[ j ], 0, sizeof( queueFamily->pQueues[ j ] ) );
 			set_loader_magic_value( &queueFamily->pQueues[ j ] );
+			queueFamily->pQueues[ j ].device = device;
+		}
+	}
+
+	DeviceHeap_Init( &device->heap, &device->allocator, Platform_GetEnvironmentFlag( "SOFTWARE_VULKAN_LARGE_PAGES" ) );
+	Platform_MutexInit( &device->commitLock );
+	ThreadPool_Init( &device->threadPool, &device->allocator, 0 );
+	if ( !Rasterizer_Init( &device->rasterizer, &device->threadPool, &device->allocator, physicalDevice->isa ) ) {
+		result = VK_ERROR_OUT_OF_HOST_MEMORY;
+		goto deviceCreateShutdownEngine;
+	}
+	CommandExecutor_Init( &device->executor, &device->rasterizer );
+	SyncEvent_Init( &device->syncEvent );
+
+	//Workers start once pQueues has stopped moving
+	for ( uint32 i = 0; i < device->queueFamilyCount; i++ ) {
+		VkQueueFamily_t * queueFamily = &device->pQueueFamilies[ i ];
+		for ( uint32 j = 0; j < queueFamily->queueCount; j++ ) {
+			queue_t * queue = reinterpret_cast< queue_t * >( device->allocator.pfnAllocation( device->allocator.pUserData, sizeof( queue_t ), 64, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+			if ( queue == NULL ) {
+				result = VK_ERROR_OUT_OF_HOST_MEMORY;
+				goto deviceCreateShutdownQueues;
+			}
+			if ( !Queue_Init( queue, &device->executor ) ) {
+				device->allocator.pfnFree( device->allocator.pUserData, queue );
+				result = VK_ERROR_INITIALIZATION_FAILED;
+				goto deviceCreateShutdownQueues;
+			}
+			queueFamily->pQueues[ j ].queue = queue;
 		}
 	}
 
 	*pDevice = reinterpret_cast< VkDevice >( device );
 	return VK_SUCCESS;
 
+deviceCreateShutdownQueues:
+	Device_ShutdownQueues( device );
+	CommandExecutor_Shutdown( &device->executor );
+
+deviceCreateShutdownEngine:
+	Rasterizer_Shutdown( &device->rasterizer );
+	ThreadPool_Shutdown( &device->threadPool );
+	Platform_MutexDestroy( &device->commitLock );
+	DeviceHeap_Shutdown( &device->heap );
+
 deviceCreateDestroyQueues:
 	for ( uint32 i = 0; i < device->queueFamilyCount; i++ ) {
 		allocator->pfnFree( allocator->pUserData, device->pQueueFamilies[ i ].pQueues );
@@ -579,6 +794,45 @@ deviceCreateKillDevice:
 	return result;
 }
 
+void VKAPI_CALL vkDestroyDevice( VkDevice vDevice, const VkAllocationCallbacks * pAllocator ) {
+	if ( vDevice == VK_NULL_HANDLE ) {
+		return;
+	}
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	Device_ShutdownQueues( device );
+	//The application must have destroyed every child object by now, so only the table pages remain
+	device->swapchains.Shutdown();
+	device->images.Shutdown();
+	device->memories.Shutdown();
+	device->renderPasses.Shutdown();
+	device->shaderModules.Shutdown();
+	device->pipelines.Shutdown();
+	device->pipelineCaches.Shutdown();
+	device->buffers.Shutdown();
+	device->imageViews.Shutdown();
+	device->framebuffers.Shutdown();
+	device->commandPools.Shutdown();
+	device->fences.Shutdown();
+	device->semaphores.Shutdown();
+	device->samplers.Shutdown();
+	device->descriptorSetLayouts.Shutdown();
+	device->pipelineLayouts.Shutdown();
+	device->descriptorPools.Shutdown();
+	device->descriptorSets.Shutdown();
+	CommandExecutor_Shutdown( &device->executor );
+	Rasterizer_Shutdown( &device->rasterizer );
+	ThreadPool_Shutdown( &device->threadPool );
+	Platform_MutexDestroy( &device->commitLock );
+	DeviceHeap_Shutdown( &device->heap );
+	HostArena_Destroy( &device->hostArena );
+	for ( uint32 i = 0; i < device->queueFamilyCount; i++ ) {
+		allocator->pfnFree( allocator->pUserData, device->pQueueFamilies[ i ].pQueues );
+	}
+	allocator->pfnFree( allocator->pUserData, device->pQueueFamilies );
+	allocator->pfnFree( allocator->pUserData, device );
+}
+
 VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties( VkPhysicalDevice physicalDevice, const char * pLayerName, uint32 * pPropertyCount, VkExtensionProperties * pProperties ) {
 	if ( pLayerName != NULL ) {
 		*pPropertyCount = 0;
@@ -593,7 +847,7 @@ VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties( VkPhysicalDevice physi
 	uint32 propertiesToWrite = Min( *pPropertyCount, ARRAY_LENGTH( supportedDeviceExtensions ) );
 	for ( uint32 i = 0; i < propertiesToWrite; i++ ) {
 		pProperties[ i ].specVersion = VK_MAKE_VERSION( 1, 0, VK_HEADER_VERSION );
-		strcpy_s( pProperties[ i ].extensionName, supportedDeviceExtensions[ i ] );
+		snprintf( pProperties[ i ].extensionName, sizeof( pProperties[ i ].extensionName ), "%s", supportedDeviceExtensions[ i ] );
 	}
 	*pPropertyCount = propertiesToWrite;
 
@@ -608,20 +862,35 @@ void VKAPI_CALL vkGetPhysicalDeviceSparseImageFormatProperties( VkPhysicalDevice
 }
 
 VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceCapabilitiesKHR( VkPhysicalDevice physicalDevice, VkSurfaceKHR vSurface, VkSurfaceCapabilitiesKHR * pSurfaceCapabilities ) {
-	VkIcdSurfaceWin32 * surface = reinterpret_cast< VkIcdSurfaceWin32 * >( vSurface );
+	VkIcdSurfaceBase * base = reinterpret_cast< VkIcdSurfaceBase * >( vSurface );
 	VkResult result;
-	RECT rect;
-	BOOL success = GetClientRect( surface->hwnd, &rect );
-	if ( success == FALSE ) {
+	if ( base->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) {
+		//Nothing on screen to match, so the swapchain picks any size an image can have
+		const uint32 maxDimension = reinterpret_cast< VkPhysicalDevice_t * >( physicalDevice )->properties.limits.maxImageDimension2D;
+		pSurfaceCapabilities->currentExtent = { 0xFFFFFFFF, 0xFFFFFFFF };
+		pSurfaceCapabilities->minImageExtent = { 1, 1 };
+		pSurfaceCapabilities->maxImageExtent = { maxDimension, maxDimension };
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+	} else if ( base->platform == VK_ICD_WSI_PLATFORM_WIN32 ) {
+		VkIcdSurfaceWin32 * surface = reinterpret_cast< VkIcdSurfaceWin32 * >( vSurface );
+		RECT rect;
+		BOOL success = GetClientRect( surface->hwnd, &rect );
+		if ( success == FALSE ) {
+			result = VK_ERROR_SURFACE_LOST_KHR;
+			goto surfaceCapabilitiesFail;
+		}
+		pSurfaceCapabilities->currentExtent = { ( uint32 )rect.right - rect.left, ( uint32 )rect.bottom - rect.top };
+		pSurfaceCapabilities->minImageExtent = pSurfaceCapabilities->currentExtent;
+		pSurfaceCapabilities->maxImageExtent = pSurfaceCapabilities->currentExtent;
+#endif
+	} else {
 		result = VK_ERROR_SURFACE_LOST_KHR;
 		goto surfaceCapabilitiesFail;
 	}
 
+	//A third image is what lets MAILBOX render while one frame waits and another is shown
 	pSurfaceCapabilities->minImageCount = 2;
-	pSurfaceCapabilities->maxImageCount = 2;
-	pSurfaceCapabilities->currentExtent = { ( uint32 )rect.right - rect.left, ( uint32 )rect.bottom - rect.top };
-	pSurfaceCapabilities->minImageExtent = pSurfaceCapabilities->currentExtent;
-	pSurfaceCapabilities->maxImageExtent = pSurfaceCapabilities->currentExtent;
+	pSurfaceCapabilities->maxImageCount = 3;
 	pSurfaceCapabilities->maxImageArrayLayers = 1;
 	pSurfaceCapabilities->supportedTransforms = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 	pSurfaceCapabilities->currentTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
@@ -637,7 +906,11 @@ surfaceCapabilitiesFail:
 
 VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR( VkPhysicalDevice physicalDevice, uint32 queueFamilyIndex, VkSurfaceKHR surface, VkBool32 * pSupported ) {
 	VkIcdSurfaceBase * base = reinterpret_cast< VkIcdSurfaceBase * >( surface );
-	*pSupported = ( base->platform == VK_ICD_WSI_PLATFORM_WIN32 ) ? VK_TRUE : VK_FALSE;
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+	*pSupported = ( base->platform == VK_ICD_WSI_PLATFORM_WIN32 || base->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) ? VK_TRUE : VK_FALSE;
+#else
+	*pSupported = ( base->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) ? VK_TRUE : VK_FALSE;
+#endif
 	return VK_SUCCESS;
 }
 
@@ -667,7 +940,9 @@ VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceFormatsKHR( VkPhysicalDevice physi
 
 VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR( VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, uint32 * pPresentModeCount, VkPresentModeKHR * pPresentModes ) {
 	static VkPresentModeKHR supportedPresentModes[] = {
-		VK_PRESENT_MODE_FIFO_KHR
+		VK_PRESENT_MODE_FIFO_KHR,
+		VK_PRESENT_MODE_MAILBOX_KHR,
+		VK_PRESENT_MODE_IMMEDIATE_KHR
 	};
 	if ( pPresentModes == NULL ) {
 		*pPresentModeCount = ARRAY_LENGTH( supportedPresentModes );
@@ -687,13 +962,25 @@ VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR( VkPhysicalDevice
 }
 
 VkResult VKAPI_CALL vkGetPhysicalDeviceImageFormatProperties( VkPhysicalDevice physicalDevice, VkFormat format, VkImageType type, VkImageTiling tiling, VkImageUsageFlags usage, VkImageCreateFlags flags, VkImageFormatProperties * pImageFormatProperties ) {
-	if ( format != VK_FORMAT_R8G8B8A8_UNORM && format != VK_FORMAT_B8G8R8A8_UNORM ) {
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties( physicalDevice, format, &formatProperties );
+	const VkFormatFeatureFlags features = ( tiling == VK_IMAGE_TILING_LINEAR ) ? formatProperties.linearTilingFeatures : formatProperties.optimalTilingFeatures;
+	if ( features == 0 ) {
+		return VK_ERROR_FORMAT_NOT_SUPPORTED;
+	}
+	if ( ( usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT ) != 0 && ( features & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT ) == 0 ) {
+		return VK_ERROR_FORMAT_NOT_SUPPORTED;
+	}
+	if ( ( usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT ) != 0 && ( features & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT ) == 0 ) {
+		return VK_ERROR_FORMAT_NOT_SUPPORTED;
+	}
+	if ( ( usage & VK_IMAGE_USAGE_SAMPLED_BIT ) != 0 && ( features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT ) == 0 ) {
 		return VK_ERROR_FORMAT_NOT_SUPPORTED;
 	}
 	if ( type != VK_IMAGE_TYPE_2D ) {
 		return VK_ERROR_FORMAT_NOT_SUPPORTED;
 	}
-	if ( ( usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT ) != 0 ) {
+	if ( ( usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT ) != 0 && ( usage & ~( VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT ) ) != 0 ) {
 		return VK_ERROR_FORMAT_NOT_SUPPORTED;
 	}
 	if ( flags != 0 ) {
@@ -702,7 +989,7 @@ VkResult VKAPI_CALL vkGetPhysicalDeviceImageFormatProperties( VkPhysicalDevice p
 
 	pImageFormatProperties->maxArrayLayers = 1;
 	pImageFormatProperties->maxExtent = { 2048, 2048, 1 };
-	pImageFormatProperties->maxMipLevels = 1;
+	pImageFormatProperties->maxMipLevels = 12;		//a full chain for maxExtent
 	pImageFormatProperties->maxResourceSize = 4ULL * 1024 * 1024 * 1024 - 1;
 	pImageFormatProperties->sampleCounts = VK_SAMPLE_COUNT_1_BIT;
 
@@ -710,10 +997,11 @@ VkResult VKAPI_CALL vkGetPhysicalDeviceImageFormatProperties( VkPhysicalDevice p
 }
 
 VkResult VKAPI_CALL vkCreateImage( VkDevice vDevice, const VkImageCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkImage * pImage ) {
-	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
 	VkPhysicalDevice physicalDevice = reinterpret_cast< VkPhysicalDevice >( device->physicalDevice );
 	VkImageFormatProperties imageFormatProperties;
+	uint64 handle;
+	VkImage_t * image;
 	VkResult result = vkGetPhysicalDeviceImageFormatProperties( physicalDevice, pCreateInfo->format, pCreateInfo->imageType, pCreateInfo->tiling, pCreateInfo->usage, pCreateInfo->flags, &imageFormatProperties );
 	VK_ASSERT_SUBCALL( result );
 	VK_VALIDATE( pCreateInfo->arrayLayers <= imageFormatProperties.maxArrayLayers );
@@ -722,14 +1010,21 @@ VkResult VKAPI_CALL vkCreateImage( VkDevice vDevice, const VkImageCreateInfo * p
 	VK_VALIDATE( pCreateInfo->extent.depth <= imageFormatProperties.maxExtent.depth );
 	VK_VALIDATE( pCreateInfo->mipLevels <= imageFormatProperties.maxMipLevels );
 	VK_VALIDATE( ( pCreateInfo->samples & ( ~imageFormatProperties.sampleCounts ) ) == 0 );
-	VK_VALIDATE( pCreateInfo->initialLayout == VK_IMAGE_LAYOUT_UNDEFINED || VK_IMAGE_LAYOUT_PREINITIALIZED );
-	uint64 baseHandle = device->currentImageHandle;
-	device->currentImageHandle++;
-	device->pImages = reinterpret_cast< VkImage_t * >( allocator->pfnReallocation( allocator->pUserData, device->pImages, sizeof( VkImage_t ) * device->currentImageHandle, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
-	VkImage_t * image = &device->pImages[ baseHandle ];
-	memset( image, 0, sizeof( *image ) );
+	VK_VALIDATE( pCreateInfo->initialLayout == VK_IMAGE_LAYOUT_UNDEFINED || pCreateInfo->initialLayout == VK_IMAGE_LAYOUT_PREINITIALIZED );
+	image = device->images.Allocate( &handle );
+	if ( image == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
 	image->valid = true;
-	*pImage = reinterpret_cast< VkImage >( ENCODE_OBJECT_HANDLE( handleClass_t::IMAGE, baseHandle ) );
+	image->extent = pCreateInfo->extent;
+	image->format = pCreateInfo->format;
+	image->usage = pCreateInfo->usage;
+	ImageLayout_Init( &image->layout, pCreateInfo );
+	//Render targets the host cannot read defer their clears; a linear image may be mapped and read at any time
+	if ( pCreateInfo->tiling == VK_IMAGE_TILING_OPTIMAL && pCreateInfo->imageType == VK_IMAGE_TYPE_2D && ( pCreateInfo->usage & ( VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT ) ) != 0 ) {
+		ImageClear_Init( &image->clearState, &image->layout, &device->allocator );
+	}
+	*pImage = reinterpret_cast< VkImage >( handle );
 	return VK_SUCCESS;
 
 VK_SUBCALL_FAILED_LABEL:
@@ -741,62 +1036,201 @@ VK_VALIDATION_FAILED_LABEL:
 
 void VKAPI_CALL vkGetImageMemoryRequirements( VkDevice vDevice, VkImage vImage, VkMemoryRequirements * pMemoryRequirements ) {
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	VkImage_t * image = &device->pImages[ DECODE_OBJECT_HANDLE( vImage ) ];
-	//We currently only have 1 heap and two types (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT and VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+	VkImage_t * image = device->images.Get( vImage );
+	if ( image == NULL ) {
+		memset( pMemoryRequirements, 0, sizeof( *pMemoryRequirements ) );
+		return;
+	}
+	//We currently only have 1 heap and three types (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+	//and VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT for transient attachments)
 	//TODO: Make this more variable-based
-	pMemoryRequirements->memoryTypeBits = 3;
-	pMemoryRequirements->alignment = 16;
-	pMemoryRequirements->size = image->extent.width * image->extent.height * sizeof( uint32 );
+	pMemoryRequirements->memoryTypeBits = ( ( image->usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT ) != 0 ) ? 7 : 3;
+	pMemoryRequirements->alignment = image->layout.alignment;
+	pMemoryRequirements->size = image->layout.size;
+}
+
+void VKAPI_CALL vkGetImageSubresourceLayout( VkDevice vDevice, VkImage vImage, const VkImageSubresource * pSubresource, VkSubresourceLayout * pLayout ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkImage_t * image = device->images.Get( vImage );
+	if ( image == NULL ) {
+		memset( pLayout, 0, sizeof( *pLayout ) );
+		return;
+	}
+	ImageLayout_GetSubresourceLayout( &image->layout, pSubresource->mipLevel, pSubresource->arrayLayer, pLayout );
 }
 
 void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties( VkPhysicalDevice vPhysicalDevice, VkPhysicalDeviceMemoryProperties * pMemoryProperties ) {
 	pMemoryProperties->memoryHeapCount = 1;
 	pMemoryProperties->memoryHeaps[ 0 ].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
 	pMemoryProperties->memoryHeaps[ 0 ].size = 8ULL * 1024 * 1024 * 1024;
-	pMemoryProperties->memoryTypeCount = 2;
+	pMemoryProperties->memoryTypeCount = 3;
 	pMemoryProperties->memoryTypes[ 0 ].heapIndex = 0;
 	pMemoryProperties->memoryTypes[ 0 ].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	pMemoryProperties->memoryTypes[ 1 ].heapIndex = 0;
 	pMemoryProperties->memoryTypes[ 1 ].propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	pMemoryProperties->memoryTypes[ 2 ].heapIndex = 0;
+	pMemoryProperties->memoryTypes[ 2 ].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+}
+
+/*
+VK_KHR_get_physical_device_properties2 is how a 1.0 device reports what 1.0 has no structure for, which
+here is the subgroup size and operations
+*/
+void VKAPI_CALL vkGetPhysicalDeviceFeatures2KHR( VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures2KHR * pFeatures ) {
+	vkGetPhysicalDeviceFeatures( physicalDevice, &pFeatures->features );
+}
+
+void VKAPI_CALL vkGetPhysicalDeviceProperties2KHR( VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties2KHR * pProperties ) {
+	VkPhysicalDevice_t * device = reinterpret_cast< VkPhysicalDevice_t * >( physicalDevice );
+	pProperties->properties = device->properties;
+	VkPhysicalDeviceSubgroupProperties * subgroup = reinterpret_cast< VkPhysicalDeviceSubgroupProperties * >( const_cast< void * >( Vk_FindInChain( pProperties->pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES ) ) );
+	if ( subgroup != NULL ) {
+		subgroup->subgroupSize = Pipeline_SubgroupSize( device->isa );
+		subgroup->supportedStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+		subgroup->supportedOperations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_VOTE_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT
+			| VK_SUBGROUP_FEATURE_SHUFFLE_BIT | VK_SUBGROUP_FEATURE_SHUFFLE_RELATIVE_BIT | VK_SUBGROUP_FEATURE_CLUSTERED_BIT;
+		subgroup->quadOperationsInAllStages = VK_FALSE;
+	}
+}
+
+void VKAPI_CALL vkGetPhysicalDeviceFormatProperties2KHR( VkPhysicalDevice physicalDevice, VkFormat format, VkFormatProperties2KHR * pFormatProperties ) {
+	vkGetPhysicalDeviceFormatProperties( physicalDevice, format, &pFormatProperties->formatProperties );
+}
+
+VkResult VKAPI_CALL vkGetPhysicalDeviceImageFormatProperties2KHR( VkPhysicalDevice physicalDevice, const VkPhysicalDeviceImageFormatInfo2KHR * pImageFormatInfo, VkImageFormatProperties2KHR * pImageFormatProperties ) {
+	return vkGetPhysicalDeviceImageFormatProperties( physicalDevice, pImageFormatInfo->format, pImageFormatInfo->type, pImageFormatInfo->tiling, pImageFormatInfo->usage, pImageFormatInfo->flags, &pImageFormatProperties->imageFormatProperties );
+}
+
+void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties2KHR( VkPhysicalDevice physicalDevice, uint32 * pQueueFamilyPropertyCount, VkQueueFamilyProperties2KHR * pQueueFamilyProperties ) {
+	const VkPhysicalDevice_t * device = reinterpret_cast< const VkPhysicalDevice_t * >( physicalDevice );
+	if ( pQueueFamilyProperties == NULL ) {
+		*pQueueFamilyPropertyCount = device->queueFamilyPropertyCount;
+		return;
+	}
+	const uint32 count = Min( *pQueueFamilyPropertyCount, device->queueFamilyPropertyCount );
+	for ( uint32 i = 0; i < count; i++ ) {
+		pQueueFamilyProperties[ i ].queueFamilyProperties = device->pQueueFamilyProperties[ i ];
+	}
+	*pQueueFamilyPropertyCount = count;
+}
+
+void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties2KHR( VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2KHR * pMemoryProperties ) {
+	vkGetPhysicalDeviceMemoryProperties( physicalDevice, &pMemoryProperties->memoryProperties );
+}
+
+void VKAPI_CALL vkGetPhysicalDeviceSparseImageFormatProperties2KHR( VkPhysicalDevice physicalDevice, const VkPhysicalDeviceSparseImageFormatInfo2KHR * pFormatInfo, uint32 * pPropertyCount, VkSparseImageFormatProperties2KHR * pProperties ) {
+	*pPropertyCount = 0;
 }
 
 VkResult VKAPI_CALL vkAllocateMemory( VkDevice vDevice, const VkMemoryAllocateInfo * pAllocateInfo, const VkAllocationCallbacks * pAllocator, VkDeviceMemory * pMemory ) {
-	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	uint64 baseHandle = device->currentMemoryHandle;
-	device->currentMemoryHandle++;
-	device->pMemories = reinterpret_cast< VkDeviceMemory_t * >( allocator->pfnReallocation( allocator->pUserData, device->pMemories, sizeof( VkDeviceMemory_t ) * device->currentMemoryHandle, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
-	VkDeviceMemory_t * memory = &device->pMemories[ baseHandle ];
+	uint64 handle;
+	VkDeviceMemory_t * memory = device->memories.Allocate( &handle );
+	if ( memory == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
 	memory->valid = true;
-	memory->data = defaultAllocator.pfnAllocation( NULL, pAllocateInfo->allocationSize, 16, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE );
-	*pMemory = reinterpret_cast< VkDeviceMemory >( ENCODE_OBJECT_HANDLE( handleClass_t::DEVICE_MEMORY, baseHandle ) );
+	//Lazily allocated memory reserves nothing; an attachment that stays in tile memory never commits it
+	if ( pAllocateInfo->memoryTypeIndex == 2 ) {
+		memory->data = NULL;
+		memory->allocation.size = pAllocateInfo->allocationSize;
+		memory->allocation.kind = deviceAllocationKind_t::NONE;
+		memory->lazy = true;
+		*pMemory = reinterpret_cast< VkDeviceMemory >( handle );
+		return VK_SUCCESS;
+	}
+	VkResult result = DeviceHeap_Allocate( &device->heap, pAllocateInfo->allocationSize, &memory->allocation );
+	if ( result != VK_SUCCESS ) {
+		device->memories.Free( handle );
+		return result;
+	}
+	memory->data = memory->allocation.data;
+	*pMemory = reinterpret_cast< VkDeviceMemory >( handle );
 	return VK_SUCCESS;
 }
 
 VkResult VKAPI_CALL vkBindImageMemory( VkDevice vDevice, VkImage vImage, VkDeviceMemory vMemory, VkDeviceSize memoryOffset ) {
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	VkImage_t * image = &device->pImages[ DECODE_OBJECT_HANDLE( vImage ) ];
-	VkDeviceMemory_t * memory = &device->pMemories[ DECODE_OBJECT_HANDLE( vMemory ) ];
+	VkImage_t * image = device->images.Get( vImage );
+	VkDeviceMemory_t * memory = device->memories.Get( vMemory );
+	if ( image == NULL || memory == NULL ) {
+		return VK_ERROR_VALIDATION_FAILED_EXT;
+	}
 	uint8 * bytes = reinterpret_cast< uint8 * >( memory->data );
-	if ( image->data != NULL ) {
+	if ( image->memory != NULL ) {
+		return VK_ERROR_VALIDATION_FAILED_EXT;
+	}
+	if ( ( memoryOffset & ( image->layout.alignment - 1 ) ) != 0 || memoryOffset + image->layout.size > memory->allocation.size ) {
 		return VK_ERROR_VALIDATION_FAILED_EXT;
 	}
-	image->data = bytes + memoryOffset;
+	image->memory = memory;
+	image->memoryOffset = memoryOffset;
+	image->data = ( bytes != NULL ) ? bytes + memoryOffset : NULL;
 	return VK_SUCCESS;
 }
 
+//Gives an image bound to lazily allocated memory somewhere to live; the whole allocation is committed the first
+//time any image bound to it needs storage, and stays committed until freed
+static bool Image_Commit( VkDevice_t * device, VkImage_t * image ) {
+	if ( image->data != NULL ) {
+		return true;
+	}
+	VkDeviceMemory_t * memory = image->memory;
+	if ( memory == NULL ) {
+		return false;
+	}
+	Platform_MutexLock( &device->commitLock );
+	if ( memory->data == NULL ) {
+		deviceAllocation_t allocation;
+		if ( DeviceHeap_Allocate( &device->heap, memory->allocation.size, &allocation ) == VK_SUCCESS ) {
+			memory->allocation = allocation;
+			memory->data = allocation.data;
+		}
+	}
+	Platform_MutexUnlock( &device->commitLock );
+	if ( memory->data == NULL ) {
+		return false;
+	}
+	image->data = reinterpret_cast< uint8 * >( memory->data ) + image->memoryOffset;
+	return true;
+}
+
+void VKAPI_CALL vkGetDeviceMemoryCommitment( VkDevice vDevice, VkDeviceMemory vMemory, VkDeviceSize * pCommittedMemoryInBytes ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkDeviceMemory_t * memory = device->memories.Get( vMemory );
+	*pCommittedMemoryInBytes = ( memory != NULL && memory->data != NULL ) ? memory->allocation.size : 0;
+}
+
 void VKAPI_CALL vkFreeMemory( VkDevice vDevice, VkDeviceMemory vMemory, const VkAllocationCallbacks * ) {
 	if ( vMemory == VK_NULL_HANDLE ) {
 		return;
 	}
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	VkDeviceMemory_t * memory = &device->pMemories[ DECODE_OBJECT_HANDLE( vMemory ) ];
-	defaultAllocator.pfnFree( NULL, memory->data );
+	VkDeviceMemory_t * memory = device->memories.Get( vMemory );
+	if ( memory == NULL ) {
+		return;
+	}
+	DeviceHeap_Free( &device->heap, &memory->allocation );
 	memset( memory, 0, sizeof( *memory ) );
-	do {
-		device->currentMemoryHandle--;
-	} while ( device->pMemories[ device->currentMemoryHandle ].valid == false );
-	device->currentMemoryHandle++;
+	device->memories.Free( vMemory );
+}
+
+//A VkDeviceMemory over bytes the heap does not own, such as a presentation backing store; the allocation kind
+//stays NONE, so vkFreeMemory leaves them alone
+static VkResult Memory_Wrap( VkDevice_t * device, void * data, uint64 size, VkDeviceMemory * pMemory ) {
+	uint64 handle;
+	VkDeviceMemory_t * memory = device->memories.Allocate( &handle );
+	if ( memory == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	memory->valid = true;
+	memory->data = data;
+	memory->allocation.data = data;
+	memory->allocation.size = size;
+	memory->allocation.reservedSize = size;
+	memory->allocation.kind = deviceAllocationKind_t::NONE;
+	*pMemory = reinterpret_cast< VkDeviceMemory >( handle );
+	return VK_SUCCESS;
 }
 
 void VKAPI_CALL vkDestroyImage( VkDevice vDevice, VkImage vImage, const VkAllocationCallbacks * ) {
@@ -804,14 +1238,16 @@ void VKAPI_CALL vkDestroyImage( VkDevice vDevice, VkImage vImage, const VkAlloca
 		return;
 	}
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	VkImage_t * image = &device->pImages[ DECODE_OBJECT_HANDLE( vImage ) ];
+	VkImage_t * image = device->images.Get( vImage );
+	if ( image == NULL ) {
+		return;
+	}
+	ImageClear_Shutdown( &image->clearState, &device->allocator );
 	memset( image, 0, sizeof( *image ) );
-	do {
-		device->currentImageHandle--;
-	} while ( device->pImages[ device->currentImageHandle ].valid == false );
-	device->currentImageHandle++;
+	device->images.Free( vImage );
 }
 
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
 void Swapchain_InitializePresentTiming( VkSwapchain_t * swapchain ) {
 	LARGE_INTEGER freq;
 	QueryPerformanceFrequency( &freq );
@@ -832,7 +1268,7 @@ void Swapchain_InitializePresentTiming( VkSwapchain_t * swapchain ) {
 	swapchain->approximateSyncInterval = static_cast< double >( endCounter.QuadPart - startCounter.QuadPart );
 }
 
-VkResult Swapchain_Init( VkSwapchain_t * swapchain, const VkAllocationCallbacks * pAllocator, VkDevice vDevice, VkIcdSurfaceWin32 * surface ) {
+VkResult Swapchain_InitWin32( VkSwapchain_t * swapchain, const VkAllocationCallbacks * pAllocator, VkIcdSurfaceWin32 * surface ) {
 	DXGI_SWAP_CHAIN_DESC internalSwapchainDesc;
 	memset( &internalSwapchainDesc, 0, sizeof( internalSwapchainDesc ) );
 	internalSwapchainDesc.BufferCount = 1;
@@ -865,29 +1301,114 @@ VkResult Swapchain_Init( VkSwapchain_t * swapchain, const VkAllocationCallbacks
 		swapchain->internalSwapchain->Release();
 		return VK_ERROR_SURFACE_LOST_KHR;
 	}
-	HDC backbufferDC;
-	swapchain->internalBackbuffer->GetDC( TRUE, &backbufferDC );
 	Swapchain_InitializePresentTiming( swapchain );
 	swapchain->pInternalImages = reinterpret_cast< VkInternalImage_t * >( pAllocator->pfnAllocation( pAllocator->pUserData, sizeof( VkInternalImage_t ) * swapchain->imageCount, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
-	for ( uint32 i = 0; i < swapchain->imageCount; i++ ) {
-		VkInternalImage_t * currentImage = &swapchain->pInternalImages[ i ];
-		currentImage->dc = CreateCompatibleDC( backbufferDC );
-		currentImage->bitmap = CreateBitmap( swapchain->extent.width, swapchain->extent.height, 1, 32, NULL );
-		SelectObject( currentImage->dc, currentImage->bitmap );
+	memset( swapchain->pInternalImages, 0, sizeof( VkInternalImage_t ) * swapchain->imageCount );
+	return VK_SUCCESS;
+}
+
+//The backing store of one image: a top-down 32-bit DIB section whose rows are exactly the linear image's rows.  Its
+//pixels live in a section created here, so the mapping covers the whole of size even where the image layout pads
+//past width * height texels
+VkResult Swapchain_InitInternalImage( VkSwapchain_t * swapchain, uint32 imageIndex, uint64 size, uint8 ** ppBits ) {
+	VkInternalImage_t * internalImage = &swapchain->pInternalImages[ imageIndex ];
+	internalImage->section = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, ( DWORD )( size >> 32 ), ( DWORD )size, NULL );
+	if ( internalImage->section == NULL ) {
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
 	}
-	uint32 * bits = new uint32[ swapchain->extent.width * swapchain->extent.height ];
-	uint32 color = 0xFF00FF00;
-	for ( uint32 row = 0; row < swapchain->extent.height; row++ ) {
-		for ( uint32 column = 0; column < swapchain->extent.width; column++ ) {
-			bits[ row * swapchain->extent.width + column ] = color;
+	internalImage->dc = CreateCompatibleDC( NULL );
+	if ( internalImage->dc == NULL ) {
+		return VK_ERROR_SURFACE_LOST_KHR;
+	}
+	BITMAPINFO bitmapInfo;
+	memset( &bitmapInfo, 0, sizeof( bitmapInfo ) );
+	bitmapInfo.bmiHeader.biSize = sizeof( bitmapInfo.bmiHeader );
+	bitmapInfo.bmiHeader.biWidth = ( LONG )swapchain->extent.width;
+	bitmapInfo.bmiHeader.biHeight = -( LONG )swapchain->extent.height;
+	bitmapInfo.bmiHeader.biPlanes = 1;
+	bitmapInfo.bmiHeader.biBitCount = 32;
+	bitmapInfo.bmiHeader.biCompression = BI_RGB;
+	void * pBits = NULL;
+	internalImage->bitmap = CreateDIBSection( internalImage->dc, &bitmapInfo, DIB_RGB_COLORS, &pBits, internalImage->section, 0 );
+	if ( internalImage->bitmap == NULL ) {
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+	SelectObject( internalImage->dc, internalImage->bitmap );
+	*ppBits = reinterpret_cast< uint8 * >( pBits );
+	return VK_SUCCESS;
+}
+
+void Swapchain_ShutdownWin32( VkSwapchain_t * swapchain, const VkAllocationCallbacks * pAllocator ) {
+	//Images that failed part way have zeroed handles
+	for ( uint32 i = 0; i < swapchain->imageCount; i++ ) {
+		VkInternalImage_t * internalImage = &swapchain->pInternalImages[ i ];
+		if ( internalImage->dc != NULL ) {
+			DeleteDC( internalImage->dc );
+		}
+		if ( internalImage->bitmap != NULL ) {
+			DeleteObject( internalImage->bitmap );
 		}
+		if ( internalImage->section != NULL ) {
+			CloseHandle( internalImage->section );
+		}
+	}
+	pAllocator->pfnFree( pAllocator->pUserData, swapchain->pInternalImages );
+	swapchain->internalBackbuffer->Release();
+	swapchain->internalSwapchain->Release();
+}
+#endif
+
+//Runs on the presenting queue's worker once the present's waits are satisfied
+void Swapchain_Present( void * pArgument, uint64 imageIndex ) {
+	VkSwapchain_t * swapchain = reinterpret_cast< VkSwapchain_t * >( pArgument );
+	const VkSwapchainImage_t & image = swapchain->pImages[ imageIndex ];
+	ImageClear_Resolve( image.clearState, image.data );
+	PresentScheduler_Present( &swapchain->scheduler, ( uint32 )imageIndex );
+}
+
+//Called by the scheduler when a frame is due; a headless swapchain has no display to wait for
+void Swapchain_Display( void * pArgument, uint32 imageIndex, bool vsync ) {
+	VkSwapchain_t * swapchain = reinterpret_cast< VkSwapchain_t * >( pArgument );
+	if ( swapchain->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) {
+		PresentRing_Present( &swapchain->ring, imageIndex );
+		return;
 	}
-	SetBitmapBits( swapchain->pInternalImages[ 0 ].bitmap, swapchain->extent.width * swapchain->extent.height * sizeof( uint32 ), bits );
-	BitBlt( backbufferDC, 0, 0, swapchain->extent.width, swapchain->extent.height, swapchain->pInternalImages[ 0 ].dc, 0, 0, SRCCOPY );
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+	//The image was rendered straight into its DIB, so the blit into the window's backbuffer is the only copy.  GDI
+	//batches per thread; flushing makes sure the blit has read the image before it can be acquired again
+	HDC backbufferDC;
+	swapchain->internalBackbuffer->GetDC( FALSE, &backbufferDC );
+	BitBlt( backbufferDC, 0, 0, swapchain->extent.width, swapchain->extent.height, swapchain->pInternalImages[ imageIndex ].dc, 0, 0, SRCCOPY );
+	GdiFlush();
 	swapchain->internalBackbuffer->ReleaseDC( NULL );
-	swapchain->internalSwapchain->Present( 1, 0 );
+	swapchain->internalSwapchain->Present( vsync ? 1 : 0, 0 );
+#endif
+}
 
+//Images are linear and bound straight into the presentation backing store, so presenting never copies them: a
+//headless swapchain's present ring, sized from the layout of the first image since all of them share it, or one DIB
+//section per image on Win32
+VkResult Swapchain_Init( VkSwapchain_t * swapchain, const VkAllocationCallbacks * pAllocator, VkDevice vDevice, VkIcdSurfaceBase * surface ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
 	VkImageCreateInfo imageCreateInfo;
+	uint64 syncInterval = 0;
+	VkResult result = VK_SUCCESS;
+	swapchain->platform = surface->platform;
+	swapchain->presentCall.func = Swapchain_Present;
+	swapchain->presentCall.pArgument = swapchain;
+	swapchain->pImages = new VkSwapchainImage_t[ swapchain->imageCount ];
+	memset( swapchain->pImages, 0, sizeof( *swapchain->pImages ) * swapchain->imageCount );
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+	if ( surface->platform == VK_ICD_WSI_PLATFORM_WIN32 ) {
+		result = Swapchain_InitWin32( swapchain, pAllocator, reinterpret_cast< VkIcdSurfaceWin32 * >( surface ) );
+		if ( result != VK_SUCCESS ) {
+			delete[] swapchain->pImages;
+			return result;
+		}
+		syncInterval = ( uint64 )( swapchain->approximateSyncInterval * 1e9 / swapchain->performanceFrequency );
+	}
+#endif
+
 	memset( &imageCreateInfo, 0, sizeof( imageCreateInfo ) );
 	imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageCreateInfo.arrayLayers = 1;
@@ -901,39 +1422,47 @@ VkResult Swapchain_Init( VkSwapchain_t * swapchain, const VkAllocationCallbacks
 	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	imageCreateInfo.mipLevels = 1;
 	imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_LINEAR;
 	imageCreateInfo.usage = swapchain->imageUsage;
-	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	VkPhysicalDevice physicalDevice = reinterpret_cast< VkPhysicalDevice >( device->physicalDevice );
 
-	swapchain->pImages = new VkSwapchainImage_t[ swapchain->imageCount ];
-	memset( swapchain->pImages, 0, sizeof( *swapchain->pImages ) * swapchain->imageCount );
-	VkResult result;
 	for ( uint32 i = 0; i < swapchain->imageCount; i++ ) {
 		result = vkCreateImage( vDevice, &imageCreateInfo, pAllocator, &swapchain->pImages[ i ].image );
 		VK_ASSERT_SUBCALL( result );
 		VkMemoryRequirements memReq;
 		vkGetImageMemoryRequirements( vDevice, swapchain->pImages[ i ].image, &memReq );
-		VkMemoryAllocateInfo memoryAllocateInfo;
-		memset( &memoryAllocateInfo, 0, sizeof( memoryAllocateInfo ) );
-
-		VkPhysicalDeviceMemoryProperties memProps;
-		vkGetPhysicalDeviceMemoryProperties( physicalDevice, &memProps );
-		uint32 memoryTypeIndex;
-		for ( memoryTypeIndex = 0; memoryTypeIndex < memProps.memoryTypeCount; memoryTypeIndex++ ) {
-			if ( ( memReq.memoryTypeBits & ( 1 << memoryTypeIndex ) ) != 0 ) {
-				if ( ( memProps.memoryTypes[ memoryTypeIndex ].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT ) == VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT ) {
-					break;
+		uint8 * backingStore = NULL;
+		if ( swapchain->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) {
+			if ( i == 0 ) {
+				VkImageSubresource subresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0 };
+				VkSubresourceLayout subresourceLayout;
+				vkGetImageSubresourceLayout( vDevice, swapchain->pImages[ 0 ].image, &subresource, &subresourceLayout );
+				if ( !PresentRing_Init( &swapchain->ring, swapchain->imageCount, swapchain->extent.width, swapchain->extent.height, swapchain->imageFormat, ( uint32 )subresourceLayout.rowPitch, memReq.size ) ) {
+					result = VK_ERROR_SURFACE_LOST_KHR;
+					VK_ASSERT_SUBCALL( result );
 				}
 			}
+			backingStore = PresentRing_Image( &swapchain->ring, i );
 		}
-		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memoryAllocateInfo.allocationSize = memReq.size;
-		memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
-		result = vkAllocateMemory( vDevice, &memoryAllocateInfo, pAllocator, &swapchain->pImages[ i ].memory );
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+		if ( swapchain->platform == VK_ICD_WSI_PLATFORM_WIN32 ) {
+			result = Swapchain_InitInternalImage( swapchain, i, memReq.size, &backingStore );
+			VK_ASSERT_SUBCALL( result );
+		}
+#endif
+		result = Memory_Wrap( device, backingStore, memReq.size, &swapchain->pImages[ i ].memory );
 		VK_ASSERT_SUBCALL( result );
+		swapchain->pImages[ i ].data = backingStore;
 		result = vkBindImageMemory( vDevice, swapchain->pImages[ i ].image, swapchain->pImages[ i ].memory, 0 );
 		VK_ASSERT_SUBCALL( result );
+		//Linear, but only read by presenting, which resolves pending clears first
+		VkImage_t * image = device->images.Get( swapchain->pImages[ i ].image );
+		ImageClear_Init( &image->clearState, &image->layout, &device->allocator );
+		swapchain->pImages[ i ].clearState = &image->clearState;
+	}
+	//Readers of a present ring map the newest frame in place, so the scheduler keeps it until a newer one lands
+	if ( !PresentScheduler_Init( &swapchain->scheduler, swapchain->imageCount, swapchain->presentMode, syncInterval, swapchain->platform == VK_ICD_WSI_PLATFORM_HEADLESS, Swapchain_Display, swapchain ) ) {
+		result = VK_ERROR_OUT_OF_HOST_MEMORY;
+		VK_ASSERT_SUBCALL( result );
 	}
 
 	return VK_SUCCESS;
@@ -943,36 +1472,66 @@ VK_SUBCALL_FAILED_LABEL:
 		vkFreeMemory( vDevice, swapchain->pImages[ i ].memory, pAllocator );
 		vkDestroyImage( vDevice, swapchain->pImages[ i ].image, pAllocator );
 	}
+	delete[] swapchain->pImages;
+	if ( swapchain->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) {
+		PresentRing_Shutdown( &swapchain->ring );
+	}
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+	if ( swapchain->platform == VK_ICD_WSI_PLATFORM_WIN32 ) {
+		Swapchain_ShutdownWin32( swapchain, pAllocator );
+	}
+#endif
 	return result;
 }
 
+void Swapchain_Shutdown( VkSwapchain_t * swapchain, const VkAllocationCallbacks * pAllocator, VkDevice vDevice ) {
+	PresentScheduler_Shutdown( &swapchain->scheduler );
+	for ( uint32 i = 0; i < swapchain->imageCount; i++ ) {
+		vkFreeMemory( vDevice, swapchain->pImages[ i ].memory, pAllocator );
+		vkDestroyImage( vDevice, swapchain->pImages[ i ].image, pAllocator );
+	}
+	delete[] swapchain->pImages;
+	if ( swapchain->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) {
+		PresentRing_Shutdown( &swapchain->ring );
+	}
+#if defined( VK_USE_PLATFORM_WIN32_KHR )
+	if ( swapchain->platform == VK_ICD_WSI_PLATFORM_WIN32 ) {
+		Swapchain_ShutdownWin32( swapchain, pAllocator );
+	}
+#endif
+}
+
 VkResult VKAPI_CALL vkCreateSwapchainKHR( VkDevice vDevice, const VkSwapchainCreateInfoKHR * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkSwapchainKHR * pSwapchain ) {
 	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	uint64 baseHandle = device->currentSwapchainHandle;
-	device->currentSwapchainHandle++;
+	VkIcdSurfaceBase * surface = reinterpret_cast< VkIcdSurfaceBase * >( pCreateInfo->surface );
+	VkSurfaceCapabilitiesKHR capabilities;
+	uint64 handle = 0;
+	VkSwapchain_t * swapchain = NULL;
+	VkResult result;
 	VK_VALIDATE( device->enabledExtensions.CheckFlag( deviceExtension_t::SWAPCHAIN_KHR ) );
-	device->pSwapchains = reinterpret_cast< VkSwapchain_t * >( allocator->pfnReallocation( allocator->pUserData, device->pSwapchains, sizeof( VkSwapchain_t ) * device->currentSwapchainHandle, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
-	VkSwapchain_t * swapchain = &device->pSwapchains[ baseHandle ];
-	memset( swapchain, 0, sizeof( *swapchain ) );
 	VK_VALIDATE( pCreateInfo->compositeAlpha == VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR );
 	VK_VALIDATE( pCreateInfo->imageArrayLayers == 1 );
 	VK_VALIDATE( pCreateInfo->imageColorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR );
-	VkIcdSurfaceWin32 * surface = reinterpret_cast< VkIcdSurfaceWin32 * >( pCreateInfo->surface );
-	RECT clientRect;
-	BOOL getExtentSuccess = GetClientRect( surface->hwnd, &clientRect );
-	if ( getExtentSuccess == FALSE ) {
-		device->currentSwapchainHandle--;
-		return VK_ERROR_SURFACE_LOST_KHR;
+	result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR( reinterpret_cast< VkPhysicalDevice >( device->physicalDevice ), pCreateInfo->surface, &capabilities );
+	if ( result != VK_SUCCESS ) {
+		return result;
 	}
-	VK_VALIDATE( pCreateInfo->imageExtent.width == ( clientRect.right - clientRect.left ) && pCreateInfo->imageExtent.height == ( clientRect.bottom - clientRect.top ) );
+	VK_VALIDATE( pCreateInfo->imageExtent.width >= capabilities.minImageExtent.width && pCreateInfo->imageExtent.width <= capabilities.maxImageExtent.width );
+	VK_VALIDATE( pCreateInfo->imageExtent.height >= capabilities.minImageExtent.height && pCreateInfo->imageExtent.height <= capabilities.maxImageExtent.height );
 	VK_VALIDATE( ( pCreateInfo->imageUsage & ( ~( VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT ) ) ) == 0 );
 	VK_VALIDATE( pCreateInfo->minImageCount <= 3 && pCreateInfo->minImageCount >= 2 );
 	VK_VALIDATE( pCreateInfo->preTransform == VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR );
-	VK_VALIDATE( pCreateInfo->presentMode == VK_PRESENT_MODE_FIFO_KHR || pCreateInfo->presentMode == VK_PRESENT_MODE_MAILBOX_KHR );
+	VK_VALIDATE( pCreateInfo->presentMode == VK_PRESENT_MODE_FIFO_KHR || pCreateInfo->presentMode == VK_PRESENT_MODE_MAILBOX_KHR || pCreateInfo->presentMode == VK_PRESENT_MODE_IMMEDIATE_KHR );
+	swapchain = device->swapchains.Allocate( &handle );
+	if ( swapchain == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
 	if ( pCreateInfo->oldSwapchain != VK_NULL_HANDLE ) {
-		uint64 oldHandle = DECODE_OBJECT_HANDLE( pCreateInfo->oldSwapchain );
-		device->pSwapchains[ oldHandle ].valid = false;
+		VkSwapchain_t * oldSwapchain = device->swapchains.Get( pCreateInfo->oldSwapchain );
+		if ( oldSwapchain != NULL ) {
+			oldSwapchain->valid = false;
+		}
 	}
 	swapchain->valid = true;
 	swapchain->extent = pCreateInfo->imageExtent;
@@ -980,50 +1539,45 @@ VkResult VKAPI_CALL vkCreateSwapchainKHR( VkDevice vDevice, const VkSwapchainCre
 	swapchain->presentMode = pCreateInfo->presentMode;
 	swapchain->imageCount = pCreateInfo->minImageCount;
 	swapchain->imageUsage = pCreateInfo->imageUsage;
-	VkResult result = Swapchain_Init( swapchain, allocator, vDevice, surface );
+	result = Swapchain_Init( swapchain, allocator, vDevice, surface );
 	VK_ASSERT_SUBCALL( result );
-	*pSwapchain = reinterpret_cast< VkSwapchainKHR >( ENCODE_OBJECT_HANDLE( handleClass_t::SWAPCHAIN, baseHandle ) );
+	*pSwapchain = reinterpret_cast< VkSwapchainKHR >( handle );
 
 	return VK_SUCCESS;
 
 VK_VALIDATION_FAILED_LABEL:
-	device->currentSwapchainHandle--;
 	return VK_ERROR_VALIDATION_FAILED_EXT;
 
 VK_SUBCALL_FAILED_LABEL:
-	device->currentSwapchainHandle--;
+	device->swapchains.Free( handle );
 	return result;
 }
 
-VK_ICD_EXPORT PFN_vkVoidFunction VKAPI_CALL vk_icdGetInstanceProcAddr( VkInstance instance, const char * pName ) {
-	VK_PATCH_FUNCTION( vkCreateInstance );
-	VK_PATCH_FUNCTION( vkEnumerateInstanceExtensionProperties );
-	VK_PATCH_FUNCTION( vkDestroyInstance );
-	VK_PATCH_FUNCTION( vkEnumeratePhysicalDevices );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceFeatures );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceFormatProperties );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceImageFormatProperties );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceProperties );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceQueueFamilyProperties );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceMemoryProperties );
-	VK_PATCH_FUNCTION( vkGetDeviceProcAddr );
-	VK_PATCH_FUNCTION( vkCreateDevice );
-	VK_PATCH_FUNCTION( vkEnumerateDeviceExtensionProperties );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceSparseImageFormatProperties );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceSurfaceCapabilitiesKHR );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceSurfaceSupportKHR );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceSurfaceFormatsKHR );
-	VK_PATCH_FUNCTION( vkGetPhysicalDeviceSurfacePresentModesKHR );
-	VK_PATCH_FUNCTION( vkCreateSwapchainKHR );
-	VK_DENY_FUNCTION( vkEnumerateInstanceVersion );
-
-	return ( PFN_vkVoidFunction )_strdup( pName );
+void VKAPI_CALL vkDestroySwapchainKHR( VkDevice vDevice, VkSwapchainKHR vSwapchain, const VkAllocationCallbacks * pAllocator ) {
+	if ( vSwapchain == VK_NULL_HANDLE ) {
+		return;
+	}
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkSwapchain_t * swapchain = device->swapchains.Get( vSwapchain );
+	if ( swapchain == NULL ) {
+		return;
+	}
+	//Presents still queued point at the swapchain and read its images
+	vkDeviceWaitIdle( vDevice );
+	Swapchain_Shutdown( swapchain, allocator, vDevice );
+	swapchain->valid = false;
+	swapchain->pImages = NULL;
+	swapchain->imageCount = 0;
+	device->swapchains.Free( vSwapchain );
 }
 
 VkResult VKAPI_CALL vkGetSwapchainImagesKHR( VkDevice vDevice, VkSwapchainKHR vSwapchain, uint32 * pSwapchainImageCount, VkImage * pSwapchainImages ) {
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
-	uint64 handle = DECODE_OBJECT_HANDLE( vSwapchain );
-	VkSwapchain_t * swapchain = &device->pSwapchains[ handle ];
+	VkSwapchain_t * swapchain = device->swapchains.Get( vSwapchain );
+	if ( swapchain == NULL ) {
+		return VK_ERROR_VALIDATION_FAILED_EXT;
+	}
 	if ( pSwapchainImages == NULL ) {
 		*pSwapchainImageCount = swapchain->imageCount;
 		return VK_SUCCESS;
@@ -1042,6 +1596,69 @@ VkResult VKAPI_CALL vkGetSwapchainImagesKHR( VkDevice vDevice, VkSwapchainKHR vS
 	return VK_SUCCESS;
 }
 
+//An image comes back only once presentation is done with it, so the semaphore and fence are signaled on return
+VkResult VKAPI_CALL vkAcquireNextImageKHR( VkDevice vDevice, VkSwapchainKHR vSwapchain, uint64_t timeout, VkSemaphore vSemaphore, VkFence vFence, uint32_t * pImageIndex ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkSwapchain_t * swapchain = device->swapchains.Get( vSwapchain );
+	if ( swapchain == NULL ) {
+		return VK_ERROR_VALIDATION_FAILED_EXT;
+	}
+	if ( !swapchain->valid ) {
+		return VK_ERROR_OUT_OF_DATE_KHR;
+	}
+	uint32 imageIndex;
+	VkResult result = PresentScheduler_Acquire( &swapchain->scheduler, timeout, &imageIndex );
+	if ( result != VK_SUCCESS ) {
+		return result;
+	}
+	if ( swapchain->platform == VK_ICD_WSI_PLATFORM_HEADLESS ) {
+		PresentRing_Acquire( &swapchain->ring, imageIndex );
+	}
+	if ( vSemaphore != VK_NULL_HANDLE ) {
+		syncSemaphore_t * semaphore = &device->semaphores.Get( vSemaphore )->semaphore;
+		Semaphore_Signal( semaphore, Semaphore_NextSignal( semaphore ) );
+	}
+	if ( vFence != VK_NULL_HANDLE ) {
+		Fence_Signal( &device->fences.Get( vFence )->fence );
+	}
+	*pImageIndex = imageIndex;
+	return VK_SUCCESS;
+}
+
+//Queues the presents behind the waits and returns; the queue's worker runs them in order with its other work
+VkResult VKAPI_CALL vkQueuePresentKHR( VkQueue vQueue, const VkPresentInfoKHR * pPresentInfo ) {
+	VkQueue_t * queue = reinterpret_cast< VkQueue_t * >( vQueue );
+	VkDevice_t * device = queue->device;
+	VkResult result = VK_SUCCESS;
+	for ( uint32 i = 0; i < pPresentInfo->waitSemaphoreCount; i++ ) {
+		VkSemaphore_t * semaphore = device->semaphores.Get( pPresentInfo->pWaitSemaphores[ i ] );
+		if ( semaphore == NULL || semaphore->semaphore.timeline ) {
+			return VK_ERROR_VALIDATION_FAILED_EXT;
+		}
+	}
+	for ( uint32 i = 0; i < pPresentInfo->waitSemaphoreCount; i++ ) {
+		syncSemaphore_t * semaphore = &device->semaphores.Get( pPresentInfo->pWaitSemaphores[ i ] )->semaphore;
+		Queue_Push( queue->queue, queueOp_t::WAIT, semaphore, Semaphore_NextWait( semaphore ) );
+	}
+	for ( uint32 i = 0; i < pPresentInfo->swapchainCount; i++ ) {
+		VkSwapchain_t * swapchain = device->swapchains.Get( pPresentInfo->pSwapchains[ i ] );
+		VkResult swapchainResult = VK_SUCCESS;
+		if ( swapchain == NULL || !PresentScheduler_Queue( &swapchain->scheduler, pPresentInfo->pImageIndices[ i ] ) ) {
+			swapchainResult = VK_ERROR_VALIDATION_FAILED_EXT;
+		} else {
+			Queue_Push( queue->queue, queueOp_t::CALL, &swapchain->presentCall, pPresentInfo->pImageIndices[ i ] );
+		}
+		if ( pPresentInfo->pResults != NULL ) {
+			pPresentInfo->pResults[ i ] = swapchainResult;
+		}
+		if ( swapchainResult != VK_SUCCESS ) {
+			result = swapchainResult;
+		}
+	}
+	Queue_Publish( queue->queue );
+	return result;
+}
+
 VkResult RenderPass_Init( VkRenderPass_t * renderPass, const VkRenderPassCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator ) {
 	renderPass->pAttachments = reinterpret_cast< VkAttachmentDescription_t * >( pAllocator->pfnAllocation( pAllocator->pUserData, sizeof( VkAttachmentDescription_t ) * pCreateInfo->attachmentCount, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
 	renderPass->attachmentCount = pCreateInfo->attachmentCount;
@@ -1052,32 +1669,1664 @@ VkResult RenderPass_Init( VkRenderPass_t * renderPass, const VkRenderPassCreateI
 		dst->format = src->format;
 		dst->loadOp = src->loadOp;
 		dst->storeOp = src->storeOp;
+		dst->stencilLoadOp = src->stencilLoadOp;
+		dst->stencilStoreOp = src->stencilStoreOp;
+	}
+	renderPass->pSubpasses = reinterpret_cast< VkSubpassDescription_t * >( pAllocator->pfnAllocation( pAllocator->pUserData, sizeof( VkSubpassDescription_t ) * pCreateInfo->subpassCount, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
+	renderPass->subpassCount = pCreateInfo->subpassCount;
+	for ( uint32 i = 0; i < renderPass->subpassCount; i++ ) {
+		VkSubpassDescription_t * dst = &renderPass->pSubpasses[ i ];
+		const VkSubpassDescription * src = &pCreateInfo->pSubpasses[ i ];
+		dst->colorAttachment = ( src->colorAttachmentCount > 0 ) ? src->pColorAttachments[ 0 ].attachment : VK_ATTACHMENT_UNUSED;
+		dst->depthAttachment = ( src->pDepthStencilAttachment != NULL ) ? src->pDepthStencilAttachment->attachment : VK_ATTACHMENT_UNUSED;
 	}
 
 	return VK_SUCCESS;
 }
 
+static VkFormat RenderPass_AttachmentFormat( const VkRenderPass_t * renderPass, uint32 attachment ) {
+	return ( attachment < renderPass->attachmentCount ) ? renderPass->pAttachments[ attachment ].format : VK_FORMAT_UNDEFINED;
+}
+
 VkResult VKAPI_CALL vkCreateRenderPass( VkDevice vDevice, const VkRenderPassCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkRenderPass * pRenderPass ) {
 	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
 	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
-	uint64 baseHandle = device->currentRenderPassHandle;
-	device->currentRenderPassHandle++;
-	device->pRenderPasses = reinterpret_cast< VkRenderPass_t * >( allocator->pfnReallocation( allocator->pUserData, device->pRenderPasses, sizeof( VkRenderPass_t ) * device->currentRenderPassHandle, 4, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE ) );
-	VkRenderPass_t * renderPass = &device->pRenderPasses[ baseHandle ];
-	memset( renderPass, 0, sizeof( *renderPass ) );
+	uint64 handle;
+	VkRenderPass_t * renderPass = device->renderPasses.Allocate( &handle );
+	if ( renderPass == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
 	renderPass->valid = true;
 	VkResult result = RenderPass_Init( renderPass, pCreateInfo, allocator );
 	VK_ASSERT_SUBCALL( result );
-	*pRenderPass = reinterpret_cast< VkRenderPass >( ENCODE_OBJECT_HANDLE( handleClass_t::RENDER_PASS, baseHandle ) );
+	*pRenderPass = reinterpret_cast< VkRenderPass >( handle );
 
 	return VK_SUCCESS;
 
 VK_SUBCALL_FAILED_LABEL:
+	device->renderPasses.Free( handle );
 	return result;
 }
 
-PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr( VkDevice device, const char * pName ) {
-	VK_PATCH_FUNCTION( vkGetSwapchainImagesKHR );
-	VK_PATCH_FUNCTION( vkCreateRenderPass );
-	return ( PFN_vkVoidFunction )_strdup( pName );
-}
\ No newline at end of file
+//Modules are parsed and indexed here; lowering to the vector IR waits for pipeline creation, where the entry point,
+//stage and specialization constants are known
+VkResult VKAPI_CALL vkCreateShaderModule( VkDevice vDevice, const VkShaderModuleCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkShaderModule * pShaderModule ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	uint64 handle;
+	VkShaderModule_t * shaderModule;
+	VkResult result;
+	VK_VALIDATE( pCreateInfo->pCode != NULL );
+	VK_VALIDATE( pCreateInfo->codeSize % sizeof( uint32 ) == 0 );
+	VK_VALIDATE( pCreateInfo->codeSize >= SPV_HEADER_WORDS * sizeof( uint32 ) );
+	VK_VALIDATE( pCreateInfo->pCode[ 0 ] == SPV_MAGIC );
+
+	shaderModule = device->shaderModules.Allocate( &handle );
+	if ( shaderModule == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	shaderModule->valid = true;
+	result = ShaderModule_Init( &shaderModule->module, pCreateInfo->pCode, pCreateInfo->codeSize, allocator );
+	VK_ASSERT_SUBCALL( result );
+	*pShaderModule = reinterpret_cast< VkShaderModule >( handle );
+
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+
+VK_SUBCALL_FAILED_LABEL:
+	device->shaderModules.Free( handle );
+	return result;
+}
+
+void VKAPI_CALL vkDestroyShaderModule( VkDevice vDevice, VkShaderModule vShaderModule, const VkAllocationCallbacks * ) {
+	if ( vShaderModule == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkShaderModule_t * shaderModule = device->shaderModules.Get( vShaderModule );
+	if ( shaderModule == NULL ) {
+		return;
+	}
+	ShaderModule_Shutdown( &shaderModule->module );
+	memset( shaderModule, 0, sizeof( *shaderModule ) );
+	device->shaderModules.Free( vShaderModule );
+}
+
+static void Pipeline_Destroy( VkDevice_t * device, VkPipeline vPipeline ) {
+	VkPipeline_t * pipeline = device->pipelines.Get( vPipeline );
+	if ( pipeline == NULL ) {
+		return;
+	}
+	if ( pipeline->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS ) {
+		GraphicsPipeline_Shutdown( &pipeline->graphics );
+	} else {
+		ComputePipeline_Shutdown( &pipeline->compute );
+	}
+	memset( pipeline, 0, sizeof( *pipeline ) );
+	device->pipelines.Free( vPipeline );
+}
+
+//A failed create destroys the pipelines already made by the same call and leaves every handle null
+static void Pipeline_DestroyAll( VkDevice_t * device, uint32 count, VkPipeline * pPipelines ) {
+	for ( uint32 i = 0; i < count; i++ ) {
+		if ( pPipelines[ i ] != VK_NULL_HANDLE ) {
+			Pipeline_Destroy( device, pPipelines[ i ] );
+			pPipelines[ i ] = VK_NULL_HANDLE;
+		}
+	}
+}
+
+//Shaders are lowered, through the pipeline cache when one is given, and compiled to native code here; layouts are not consulted yet
+VkResult VKAPI_CALL vkCreateGraphicsPipelines( VkDevice vDevice, VkPipelineCache vPipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo * pCreateInfos, const VkAllocationCallbacks * pAllocator, VkPipeline * pPipelines ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	VkPipelineCache_t * pipelineCache = device->pipelineCaches.Get( vPipelineCache );
+	pipelineCache_t * cache = ( pipelineCache != NULL ) ? &pipelineCache->cache : NULL;
+	VkResult result = VK_SUCCESS;
+	for ( uint32 i = 0; i < createInfoCount; i++ ) {
+		pPipelines[ i ] = VK_NULL_HANDLE;
+	}
+	for ( uint32 i = 0; i < createInfoCount; i++ ) {
+		const VkGraphicsPipelineCreateInfo * pCreateInfo = &pCreateInfos[ i ];
+		const VkRenderPass_t * renderPass = device->renderPasses.Get( pCreateInfo->renderPass );
+		const shaderModule_t * modules[ 5 ];
+		VK_VALIDATE( renderPass != NULL && pCreateInfo->subpass < renderPass->subpassCount );
+		VK_VALIDATE( pCreateInfo->stageCount <= ARRAY_LENGTH( modules ) );
+		VK_VALIDATE( pCreateInfo->pInputAssemblyState != NULL && pCreateInfo->pRasterizationState != NULL );
+		for ( uint32 s = 0; s < pCreateInfo->stageCount; s++ ) {
+			const VkShaderModule_t * shaderModule = device->shaderModules.Get( pCreateInfo->pStages[ s ].module );
+			VK_VALIDATE( shaderModule != NULL );
+			modules[ s ] = &shaderModule->module;
+		}
+		const VkSubpassDescription_t & subpass = renderPass->pSubpasses[ pCreateInfo->subpass ];
+		pipelineTargetFormats_t targetFormats;
+		targetFormats.color = RenderPass_AttachmentFormat( renderPass, subpass.colorAttachment );
+		targetFormats.depth = RenderPass_AttachmentFormat( renderPass, subpass.depthAttachment );
+
+		uint64 handle;
+		VkPipeline_t * pipeline = device->pipelines.Allocate( &handle );
+		if ( pipeline == NULL ) {
+			result = VK_ERROR_OUT_OF_HOST_MEMORY;
+			break;
+		}
+		pipeline->valid = true;
+		pipeline->bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		result = GraphicsPipeline_Init( &pipeline->graphics, pCreateInfo, modules, cache, targetFormats, device->rasterizer.workerCount, device->physicalDevice->isa, allocator );
+		if ( result != VK_SUCCESS ) {
+			device->pipelines.Free( handle );
+			break;
+		}
+		pPipelines[ i ] = reinterpret_cast< VkPipeline >( handle );
+	}
+	if ( result != VK_SUCCESS ) {
+		Pipeline_DestroyAll( device, createInfoCount, pPipelines );
+	}
+	return result;
+
+VK_VALIDATION_FAILED_LABEL:
+	Pipeline_DestroyAll( device, createInfoCount, pPipelines );
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+VkResult VKAPI_CALL vkCreateComputePipelines( VkDevice vDevice, VkPipelineCache vPipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo * pCreateInfos, const VkAllocationCallbacks * pAllocator, VkPipeline * pPipelines ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	VkPipelineCache_t * pipelineCache = device->pipelineCaches.Get( vPipelineCache );
+	pipelineCache_t * cache = ( pipelineCache != NULL ) ? &pipelineCache->cache : NULL;
+	VkResult result = VK_SUCCESS;
+	for ( uint32 i = 0; i < createInfoCount; i++ ) {
+		pPipelines[ i ] = VK_NULL_HANDLE;
+	}
+	for ( uint32 i = 0; i < createInfoCount; i++ ) {
+		const VkComputePipelineCreateInfo * pCreateInfo = &pCreateInfos[ i ];
+		const VkShaderModule_t * shaderModule = device->shaderModules.Get( pCreateInfo->stage.module );
+		VK_VALIDATE( shaderModule != NULL );
+
+		uint64 handle;
+		VkPipeline_t * pipeline = device->pipelines.Allocate( &handle );
+		if ( pipeline == NULL ) {
+			result = VK_ERROR_OUT_OF_HOST_MEMORY;
+			break;
+		}
+		pipeline->valid = true;
+		pipeline->bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+		result = ComputePipeline_Init( &pipeline->compute, pCreateInfo, &shaderModule->module, cache, device->rasterizer.workerCount, device->physicalDevice->isa, allocator );
+		if ( result != VK_SUCCESS ) {
+			device->pipelines.Free( handle );
+			break;
+		}
+		pPipelines[ i ] = reinterpret_cast< VkPipeline >( handle );
+	}
+	if ( result != VK_SUCCESS ) {
+		Pipeline_DestroyAll( device, createInfoCount, pPipelines );
+	}
+	return result;
+
+VK_VALIDATION_FAILED_LABEL:
+	Pipeline_DestroyAll( device, createInfoCount, pPipelines );
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroyPipeline( VkDevice vDevice, VkPipeline vPipeline, const VkAllocationCallbacks * ) {
+	if ( vPipeline == VK_NULL_HANDLE ) {
+		return;
+	}
+	Pipeline_Destroy( reinterpret_cast< VkDevice_t * >( vDevice ), vPipeline );
+}
+
+VkResult VKAPI_CALL vkCreatePipelineCache( VkDevice vDevice, const VkPipelineCacheCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkPipelineCache * pPipelineCache ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	uint64 handle;
+	VkPipelineCache_t * pipelineCache = NULL;
+	VkResult result = VK_SUCCESS;
+	VK_VALIDATE( pCreateInfo->initialDataSize == 0 || pCreateInfo->pInitialData != NULL );
+
+	pipelineCache = device->pipelineCaches.Allocate( &handle );
+	if ( pipelineCache == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	pipelineCache->valid = true;
+	result = PipelineCache_Init( &pipelineCache->cache, device->physicalDevice->properties, device->physicalDevice->isa, pCreateInfo->pInitialData, pCreateInfo->initialDataSize, allocator );
+	if ( result != VK_SUCCESS ) {
+		device->pipelineCaches.Free( handle );
+		return result;
+	}
+	*pPipelineCache = reinterpret_cast< VkPipelineCache >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroyPipelineCache( VkDevice vDevice, VkPipelineCache vPipelineCache, const VkAllocationCallbacks * ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkPipelineCache_t * pipelineCache = device->pipelineCaches.Get( vPipelineCache );
+	if ( pipelineCache == NULL ) {
+		return;
+	}
+	PipelineCache_Shutdown( &pipelineCache->cache );
+	memset( pipelineCache, 0, sizeof( *pipelineCache ) );
+	device->pipelineCaches.Free( vPipelineCache );
+}
+
+VkResult VKAPI_CALL vkGetPipelineCacheData( VkDevice vDevice, VkPipelineCache vPipelineCache, size_t * pDataSize, void * pData ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkPipelineCache_t * pipelineCache = device->pipelineCaches.Get( vPipelineCache );
+	VK_VALIDATE( pipelineCache != NULL && pDataSize != NULL );
+	return PipelineCache_GetData( &pipelineCache->cache, pDataSize, pData );
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+VkResult VKAPI_CALL vkMergePipelineCaches( VkDevice vDevice, VkPipelineCache vDstCache, uint32_t srcCacheCount, const VkPipelineCache * pSrcCaches ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkPipelineCache_t * dstCache = device->pipelineCaches.Get( vDstCache );
+	VkResult result = VK_SUCCESS;
+	VK_VALIDATE( dstCache != NULL );
+	for ( uint32 i = 0; i < srcCacheCount; i++ ) {
+		VkPipelineCache_t * srcCache = device->pipelineCaches.Get( pSrcCaches[ i ] );
+		VK_VALIDATE( srcCache != NULL && srcCache != dstCache );
+		VK_ASSERT_SUBCALL( result = PipelineCache_Merge( &dstCache->cache, &srcCache->cache ) );
+	}
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+VK_SUBCALL_FAILED_LABEL:
+	return result;
+}
+
+/* ==== Buffers ==== */
+VkResult VKAPI_CALL vkCreateBuffer( VkDevice vDevice, const VkBufferCreateInfo * pCreateInfo, const VkAllocationCallbacks *, VkBuffer * pBuffer ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	uint64 handle;
+	VkBuffer_t * buffer = NULL;
+	VK_VALIDATE( pCreateInfo->size > 0 );
+	VK_VALIDATE( ( pCreateInfo->flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT ) == 0 );
+	buffer = device->buffers.Allocate( &handle );
+	if ( buffer == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	buffer->valid = true;
+	buffer->size = pCreateInfo->size;
+	buffer->data = NULL;
+	*pBuffer = reinterpret_cast< VkBuffer >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroyBuffer( VkDevice vDevice, VkBuffer vBuffer, const VkAllocationCallbacks * ) {
+	if ( vBuffer == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkBuffer_t * buffer = device->buffers.Get( vBuffer );
+	if ( buffer == NULL ) {
+		return;
+	}
+	memset( buffer, 0, sizeof( *buffer ) );
+	device->buffers.Free( vBuffer );
+}
+
+void VKAPI_CALL vkGetBufferMemoryRequirements( VkDevice vDevice, VkBuffer vBuffer, VkMemoryRequirements * pMemoryRequirements ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkBuffer_t * buffer = device->buffers.Get( vBuffer );
+	if ( buffer == NULL ) {
+		memset( pMemoryRequirements, 0, sizeof( *pMemoryRequirements ) );
+		return;
+	}
+	pMemoryRequirements->memoryTypeBits = 3;
+	pMemoryRequirements->alignment = 16;
+	pMemoryRequirements->size = ( buffer->size + 15 ) & ~15ULL;
+}
+
+VkResult VKAPI_CALL vkBindBufferMemory( VkDevice vDevice, VkBuffer vBuffer, VkDeviceMemory vMemory, VkDeviceSize memoryOffset ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkBuffer_t * buffer = device->buffers.Get( vBuffer );
+	VkDeviceMemory_t * memory = device->memories.Get( vMemory );
+	VK_VALIDATE( buffer != NULL && memory != NULL && buffer->data == NULL && !memory->lazy );
+	VK_VALIDATE( ( memoryOffset & 15 ) == 0 && memoryOffset + buffer->size <= memory->allocation.size );
+	buffer->data = reinterpret_cast< uint8 * >( memory->data ) + memoryOffset;
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+//All memory is host memory, so mapping hands out the allocation itself and coherence is free
+VkResult VKAPI_CALL vkMapMemory( VkDevice vDevice, VkDeviceMemory vMemory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags, void ** ppData ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkDeviceMemory_t * memory = device->memories.Get( vMemory );
+	VK_VALIDATE( memory != NULL && offset < memory->allocation.size && !memory->lazy );
+	VK_VALIDATE( size == VK_WHOLE_SIZE || offset + size <= memory->allocation.size );
+	*ppData = reinterpret_cast< uint8 * >( memory->data ) + offset;
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkUnmapMemory( VkDevice, VkDeviceMemory ) {
+}
+
+VkResult VKAPI_CALL vkFlushMappedMemoryRanges( VkDevice, uint32_t, const VkMappedMemoryRange * ) {
+	return VK_SUCCESS;
+}
+
+VkResult VKAPI_CALL vkInvalidateMappedMemoryRanges( VkDevice, uint32_t, const VkMappedMemoryRange * ) {
+	return VK_SUCCESS;
+}
+
+/* ==== Image views and framebuffers ==== */
+VkResult VKAPI_CALL vkCreateImageView( VkDevice vDevice, const VkImageViewCreateInfo * pCreateInfo, const VkAllocationCallbacks *, VkImageView * pView ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkImage_t * image = device->images.Get( pCreateInfo->image );
+	uint64 handle;
+	VkImageView_t * view = NULL;
+	VK_VALIDATE( image != NULL && image->data != NULL );
+	VK_VALIDATE( pCreateInfo->subresourceRange.baseMipLevel < image->layout.mipLevels );
+	VK_VALIDATE( pCreateInfo->subresourceRange.baseArrayLayer < image->layout.arrayLayers );
+	VK_VALIDATE( pCreateInfo->viewType == VK_IMAGE_VIEW_TYPE_2D || pCreateInfo->viewType == VK_IMAGE_VIEW_TYPE_2D_ARRAY );
+	view = device->imageViews.Allocate( &handle );
+	if ( view == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	view->valid = true;
+	view->image = image;
+	view->format = pCreateInfo->format;
+	view->baseMipLevel = pCreateInfo->subresourceRange.baseMipLevel;
+	view->baseArrayLayer = pCreateInfo->subresourceRange.baseArrayLayer;
+	if ( ( image->usage & VK_IMAGE_USAGE_SAMPLED_BIT ) != 0 ) {
+		imageClearState_t * clearState = ( image->clearState.pTiles != NULL ) ? &image->clearState : NULL;
+		SampledImage_Init( &view->sampled, &image->layout, reinterpret_cast< uint8 * >( image->data ), clearState, pCreateInfo, device->physicalDevice->isa );
+	}
+	*pView = reinterpret_cast< VkImageView >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroyImageView( VkDevice vDevice, VkImageView vView, const VkAllocationCallbacks * ) {
+	if ( vView == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkImageView_t * view = device->imageViews.Get( vView );
+	if ( view == NULL ) {
+		return;
+	}
+	memset( view, 0, sizeof( *view ) );
+	device->imageViews.Free( vView );
+}
+
+VkResult VKAPI_CALL vkCreateFramebuffer( VkDevice vDevice, const VkFramebufferCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkFramebuffer * pFramebuffer ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	uint64 handle;
+	VkFramebuffer_t * framebuffer = NULL;
+	VK_VALIDATE( pCreateInfo->layers == 1 );
+	for ( uint32 i = 0; i < pCreateInfo->attachmentCount; i++ ) {
+		VK_VALIDATE( device->imageViews.Get( pCreateInfo->pAttachments[ i ] ) != NULL );
+	}
+	framebuffer = device->framebuffers.Allocate( &handle );
+	if ( framebuffer == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	framebuffer->valid = true;
+	framebuffer->width = pCreateInfo->width;
+	framebuffer->height = pCreateInfo->height;
+	framebuffer->attachmentCount = pCreateInfo->attachmentCount;
+	framebuffer->ppAttachments = reinterpret_cast< VkImageView_t ** >( allocator->pfnAllocation( allocator->pUserData, sizeof( VkImageView_t * ) * Max( pCreateInfo->attachmentCount, 1U ), 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+	if ( framebuffer->ppAttachments == NULL ) {
+		device->framebuffers.Free( handle );
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	for ( uint32 i = 0; i < pCreateInfo->attachmentCount; i++ ) {
+		framebuffer->ppAttachments[ i ] = device->imageViews.Get( pCreateInfo->pAttachments[ i ] );
+	}
+	*pFramebuffer = reinterpret_cast< VkFramebuffer >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroyFramebuffer( VkDevice vDevice, VkFramebuffer vFramebuffer, const VkAllocationCallbacks * pAllocator ) {
+	if ( vFramebuffer == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	VkFramebuffer_t * framebuffer = device->framebuffers.Get( vFramebuffer );
+	if ( framebuffer == NULL ) {
+		return;
+	}
+	allocator->pfnFree( allocator->pUserData, framebuffer->ppAttachments );
+	memset( framebuffer, 0, sizeof( *framebuffer ) );
+	device->framebuffers.Free( vFramebuffer );
+}
+
+/* ==== Samplers and descriptor sets ==== */
+VkResult VKAPI_CALL vkCreateSampler( VkDevice vDevice, const VkSamplerCreateInfo * pCreateInfo, const VkAllocationCallbacks *, VkSampler * pSampler ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	uint64 handle;
+	VkSampler_t * sampler = NULL;
+	VK_VALIDATE( pCreateInfo->anisotropyEnable == VK_FALSE || device->enabledFeatures.samplerAnisotropy );
+	VK_VALIDATE( pCreateInfo->addressModeU != VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE && pCreateInfo->addressModeV != VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE );
+	sampler = device->samplers.Allocate( &handle );
+	if ( sampler == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	sampler->valid = true;
+	Sampler_Init( &sampler->sampler, pCreateInfo, device->physicalDevice->isa );
+	*pSampler = reinterpret_cast< VkSampler >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroySampler( VkDevice vDevice, VkSampler vSampler, const VkAllocationCallbacks * ) {
+	if ( vSampler == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkSampler_t * sampler = device->samplers.Get( vSampler );
+	if ( sampler == NULL ) {
+		return;
+	}
+	memset( sampler, 0, sizeof( *sampler ) );
+	device->samplers.Free( vSampler );
+}
+
+VkResult VKAPI_CALL vkCreateDescriptorSetLayout( VkDevice vDevice, const VkDescriptorSetLayoutCreateInfo * pCreateInfo, const VkAllocationCallbacks * pAllocator, VkDescriptorSetLayout * pSetLayout ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	uint64 handle;
+	VkDescriptorSetLayout_t * setLayout = NULL;
+	VkResult result;
+	uint32 dynamicCount = 0;
+	for ( uint32 i = 0; i < pCreateInfo->bindingCount; i++ ) {
+		const VkDescriptorSetLayoutBinding & binding = pCreateInfo->pBindings[ i ];
+		VK_VALIDATE( binding.descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER && binding.descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER );
+		dynamicCount += DescriptorSet_IsDynamic( binding.descriptorType ) ? binding.descriptorCount : 0;
+	}
+	VK_VALIDATE( dynamicCount <= DESCRIPTOR_MAX_DYNAMIC_BUFFERS );
+	setLayout = device->descriptorSetLayouts.Allocate( &handle );
+	if ( setLayout == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	result = DescriptorSetLayout_Init( &setLayout->layout, pCreateInfo, allocator );
+	if ( result != VK_SUCCESS ) {
+		device->descriptorSetLayouts.Free( handle );
+		return result;
+	}
+	setLayout->valid = true;
+	for ( uint32 i = 0; i < pCreateInfo->bindingCount; i++ ) {
+		const VkDescriptorSetLayoutBinding & src = pCreateInfo->pBindings[ i ];
+		const descriptorLayoutBinding_t * binding = DescriptorSetLayout_FindBinding( &setLayout->layout, src.binding );
+		if ( binding == NULL || !binding->immutableSamplers ) {
+			continue;
+		}
+		for ( uint32 j = 0; j < binding->count; j++ ) {
+			const VkSampler_t * sampler = device->samplers.Get( src.pImmutableSamplers[ j ] );
+			setLayout->layout.ppImmutableSamplers[ binding->firstElement + j ] = ( sampler != NULL ) ? &sampler->sampler : NULL;
+		}
+	}
+	*pSetLayout = reinterpret_cast< VkDescriptorSetLayout >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroyDescriptorSetLayout( VkDevice vDevice, VkDescriptorSetLayout vSetLayout, const VkAllocationCallbacks * ) {
+	if ( vSetLayout == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkDescriptorSetLayout_t * setLayout = device->descriptorSetLayouts.Get( vSetLayout );
+	if ( setLayout == NULL ) {
+		return;
+	}
+	DescriptorSetLayout_Shutdown( &setLayout->layout );
+	memset( setLayout, 0, sizeof( *setLayout ) );
+	device->descriptorSetLayouts.Free( vSetLayout );
+}
+
+VkResult VKAPI_CALL vkCreatePipelineLayout( VkDevice vDevice, const VkPipelineLayoutCreateInfo * pCreateInfo, const VkAllocationCallbacks *, VkPipelineLayout * pPipelineLayout ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	uint64 handle;
+	VkPipelineLayout_t * pipelineLayout = NULL;
+	VK_VALIDATE( pCreateInfo->setLayoutCount <= COMMAND_MAX_DESCRIPTOR_SETS );
+	pipelineLayout = device->pipelineLayouts.Allocate( &handle );
+	if ( pipelineLayout == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	pipelineLayout->valid = true;
+	*pPipelineLayout = reinterpret_cast< VkPipelineLayout >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroyPipelineLayout( VkDevice vDevice, VkPipelineLayout vPipelineLayout, const VkAllocationCallbacks * ) {
+	if ( vPipelineLayout == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkPipelineLayout_t * pipelineLayout = device->pipelineLayouts.Get( vPipelineLayout );
+	if ( pipelineLayout == NULL ) {
+		return;
+	}
+	memset( pipelineLayout, 0, sizeof( *pipelineLayout ) );
+	device->pipelineLayouts.Free( vPipelineLayout );
+}
+
+VkResult VKAPI_CALL vkCreateDescriptorPool( VkDevice vDevice, const VkDescriptorPoolCreateInfo *, const VkAllocationCallbacks *, VkDescriptorPool * pDescriptorPool ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	uint64 handle;
+	VkDescriptorPool_t * descriptorPool = device->descriptorPools.Allocate( &handle );
+	if ( descriptorPool == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	descriptorPool->valid = true;
+	descriptorPool->pSets = NULL;
+	*pDescriptorPool = reinterpret_cast< VkDescriptorPool >( handle );
+	return VK_SUCCESS;
+}
+
+static void DescriptorSet_Free( VkDevice_t * device, VkDescriptorSet vSet ) {
+	VkDescriptorSet_t * set = device->descriptorSets.Get( vSet );
+	if ( set == NULL ) {
+		return;
+	}
+	VkDescriptorPool_t * descriptorPool = set->pool;
+	if ( set->pPrev != NULL ) {
+		set->pPrev->pNext = set->pNext;
+	} else {
+		descriptorPool->pSets = set->pNext;
+	}
+	if ( set->pNext != NULL ) {
+		set->pNext->pPrev = set->pPrev;
+	}
+	DescriptorSet_Shutdown( &set->set );
+	memset( set, 0, sizeof( *set ) );
+	device->descriptorSets.Free( vSet );
+}
+
+static void DescriptorPool_FreeSets( VkDevice_t * device, VkDescriptorPool_t * descriptorPool ) {
+	while ( descriptorPool->pSets != NULL ) {
+		DescriptorSet_Free( device, descriptorPool->pSets->handle );
+	}
+}
+
+void VKAPI_CALL vkDestroyDescriptorPool( VkDevice vDevice, VkDescriptorPool vDescriptorPool, const VkAllocationCallbacks * ) {
+	if ( vDescriptorPool == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkDescriptorPool_t * descriptorPool = device->descriptorPools.Get( vDescriptorPool );
+	if ( descriptorPool == NULL ) {
+		return;
+	}
+	DescriptorPool_FreeSets( device, descriptorPool );
+	memset( descriptorPool, 0, sizeof( *descriptorPool ) );
+	device->descriptorPools.Free( vDescriptorPool );
+}
+
+VkResult VKAPI_CALL vkResetDescriptorPool( VkDevice vDevice, VkDescriptorPool vDescriptorPool, VkDescriptorPoolResetFlags ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkDescriptorPool_t * descriptorPool = device->descriptorPools.Get( vDescriptorPool );
+	VK_VALIDATE( descriptorPool != NULL );
+	DescriptorPool_FreeSets( device, descriptorPool );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+//Set memory comes from the device's allocator, since vkFreeDescriptorSets cannot name the pool's
+VkResult VKAPI_CALL vkAllocateDescriptorSets( VkDevice vDevice, const VkDescriptorSetAllocateInfo * pAllocateInfo, VkDescriptorSet * pDescriptorSets ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkDescriptorPool_t * descriptorPool = device->descriptorPools.Get( pAllocateInfo->descriptorPool );
+	VK_VALIDATE( descriptorPool != NULL );
+	for ( uint32 i = 0; i < pAllocateInfo->descriptorSetCount; i++ ) {
+		VK_VALIDATE( device->descriptorSetLayouts.Get( pAllocateInfo->pSetLayouts[ i ] ) != NULL );
+	}
+	for ( uint32 i = 0; i < pAllocateInfo->descriptorSetCount; i++ ) {
+		const VkDescriptorSetLayout_t * setLayout = device->descriptorSetLayouts.Get( pAllocateInfo->pSetLayouts[ i ] );
+		uint64 handle;
+		VkDescriptorSet_t * set = device->descriptorSets.Allocate( &handle );
+		if ( set != NULL && DescriptorSet_Init( &set->set, &setLayout->layout, &device->allocator ) != VK_SUCCESS ) {
+			device->descriptorSets.Free( handle );
+			set = NULL;
+		}
+		if ( set == NULL ) {
+			for ( uint32 j = 0; j < i; j++ ) {
+				DescriptorSet_Free( device, pDescriptorSets[ j ] );
+				pDescriptorSets[ j ] = VK_NULL_HANDLE;
+			}
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		set->valid = true;
+		set->handle = reinterpret_cast< VkDescriptorSet >( handle );
+		set->pool = descriptorPool;
+		set->pNext = descriptorPool->pSets;
+		if ( descriptorPool->pSets != NULL ) {
+			descriptorPool->pSets->pPrev = set;
+		}
+		descriptorPool->pSets = set;
+		pDescriptorSets[ i ] = set->handle;
+	}
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+VkResult VKAPI_CALL vkFreeDescriptorSets( VkDevice vDevice, VkDescriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet * pDescriptorSets ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	for ( uint32 i = 0; i < descriptorSetCount; i++ ) {
+		DescriptorSet_Free( device, pDescriptorSets[ i ] );
+	}
+	return VK_SUCCESS;
+}
+
+//Resolves what one write points at to the element the shaders read
+static void DescriptorSet_ResolveWrite( const VkDevice_t * device, const VkWriteDescriptorSet & write, uint32 index, descriptorElement_t * pElement ) {
+	memset( pElement, 0, sizeof( *pElement ) );
+	switch ( write.descriptorType ) {
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: {
+			const VkDescriptorBufferInfo & info = write.pBufferInfo[ index ];
+			const VkBuffer_t * buffer = device->buffers.Get( info.buffer );
+			if ( buffer == NULL || buffer->data == NULL || info.offset >= buffer->size ) {
+				break;
+			}
+			pElement->buffer.data = buffer->data + info.offset;
+			const VkDeviceSize available = buffer->size - info.offset;
+			pElement->buffer.range = ( info.range == VK_WHOLE_SIZE || info.range > available ) ? available : info.range;
+			break;
+		}
+		case VK_DESCRIPTOR_TYPE_SAMPLER:
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: {
+			const VkDescriptorImageInfo & info = write.pImageInfo[ index ];
+			const VkImageView_t * view = ( write.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER ) ? device->imageViews.Get( info.imageView ) : NULL;
+			const VkSampler_t * sampler = ( write.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ) ? device->samplers.Get( info.sampler ) : NULL;
+			pElement->image.image = ( view != NULL && view->sampled.layout != NULL ) ? &view->sampled : NULL;
+			pElement->image.sampler = ( sampler != NULL ) ? &sampler->sampler : NULL;
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+//Writes go through a small stack batch, each batch one run of DescriptorSet_Write
+void VKAPI_CALL vkUpdateDescriptorSets( VkDevice vDevice, uint32_t descriptorWriteCount, const VkWriteDescriptorSet * pDescriptorWrites, uint32_t descriptorCopyCount, const VkCopyDescriptorSet * pDescriptorCopies ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	descriptorElement_t batch[ 16 ];
+	for ( uint32 i = 0; i < descriptorWriteCount; i++ ) {
+		const VkWriteDescriptorSet & write = pDescriptorWrites[ i ];
+		VkDescriptorSet_t * set = device->descriptorSets.Get( write.dstSet );
+		if ( set == NULL ) {
+			continue;
+		}
+		for ( uint32 first = 0; first < write.descriptorCount; first += ARRAY_LENGTH( batch ) ) {
+			const uint32 count = Min( write.descriptorCount - first, ARRAY_LENGTH( batch ) );
+			for ( uint32 j = 0; j < count; j++ ) {
+				DescriptorSet_ResolveWrite( device, write, first + j, &batch[ j ] );
+			}
+			DescriptorSet_Write( &set->set, write.dstBinding, write.dstArrayElement + first, count, batch );
+		}
+	}
+	for ( uint32 i = 0; i < descriptorCopyCount; i++ ) {
+		const VkCopyDescriptorSet & copy = pDescriptorCopies[ i ];
+		const VkDescriptorSet_t * src = device->descriptorSets.Get( copy.srcSet );
+		VkDescriptorSet_t * dst = device->descriptorSets.Get( copy.dstSet );
+		if ( src == NULL || dst == NULL ) {
+			continue;
+		}
+		for ( uint32 first = 0; first < copy.descriptorCount; first += ARRAY_LENGTH( batch ) ) {
+			const uint32 count = Min( copy.descriptorCount - first, ARRAY_LENGTH( batch ) );
+			memset( batch, 0, sizeof( batch ) );
+			DescriptorSet_Read( &src->set, copy.srcBinding, copy.srcArrayElement + first, count, batch );
+			DescriptorSet_Write( &dst->set, copy.dstBinding, copy.dstArrayElement + first, count, batch );
+		}
+	}
+}
+
+/* ==== Command pools and buffers ==== */
+VkResult VKAPI_CALL vkCreateCommandPool( VkDevice vDevice, const VkCommandPoolCreateInfo *, const VkAllocationCallbacks *, VkCommandPool * pCommandPool ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	uint64 handle;
+	VkCommandPool_t * commandPool = device->commandPools.Allocate( &handle );
+	if ( commandPool == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	commandPool->valid = true;
+	CommandPool_Init( &commandPool->pool );
+	commandPool->pCommandBuffers = NULL;
+	*pCommandPool = reinterpret_cast< VkCommandPool >( handle );
+	return VK_SUCCESS;
+}
+
+static void CommandBuffer_Free( VkCommandPool_t * commandPool, VkCommandBuffer_t * commandBuffer, const VkAllocationCallbacks * allocator ) {
+	if ( commandBuffer->pPrev != NULL ) {
+		commandBuffer->pPrev->pNext = commandBuffer->pNext;
+	} else {
+		commandPool->pCommandBuffers = commandBuffer->pNext;
+	}
+	if ( commandBuffer->pNext != NULL ) {
+		commandBuffer->pNext->pPrev = commandBuffer->pPrev;
+	}
+	CommandBuffer_Reset( &commandBuffer->commandBuffer );
+	allocator->pfnFree( allocator->pUserData, commandBuffer );
+}
+
+void VKAPI_CALL vkDestroyCommandPool( VkDevice vDevice, VkCommandPool vCommandPool, const VkAllocationCallbacks * pAllocator ) {
+	if ( vCommandPool == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkAllocationCallbacks * allocator = ( pAllocator != NULL ) ? pAllocator : &defaultAllocator;
+	VkCommandPool_t * commandPool = device->commandPools.Get( vCommandPool );
+	if ( commandPool == NULL ) {
+		return;
+	}
+	while ( commandPool->pCommandBuffers != NULL ) {
+		CommandBuffer_Free( commandPool, commandPool->pCommandBuffers, allocator );
+	}
+	CommandPool_Shutdown( &commandPool->pool );
+	commandPool->valid = false;
+	device->commandPools.Free( vCommandPool );
+}
+
+//Rewinds the pool's arena; no command buffer is visited, each notices the new generation when next used
+VkResult VKAPI_CALL vkResetCommandPool( VkDevice vDevice, VkCommandPool vCommandPool, VkCommandPoolResetFlags ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkCommandPool_t * commandPool = device->commandPools.Get( vCommandPool );
+	VK_VALIDATE( commandPool != NULL );
+	CommandPool_Reset( &commandPool->pool );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+//Command buffers come from the allocator the pool was created with, which vkFreeCommandBuffers cannot name, so the default one
+VkResult VKAPI_CALL vkAllocateCommandBuffers( VkDevice vDevice, const VkCommandBufferAllocateInfo * pAllocateInfo, VkCommandBuffer * pCommandBuffers ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkCommandPool_t * commandPool = device->commandPools.Get( pAllocateInfo->commandPool );
+	const VkAllocationCallbacks * allocator = &defaultAllocator;
+	VK_VALIDATE( commandPool != NULL );
+	for ( uint32 i = 0; i < pAllocateInfo->commandBufferCount; i++ ) {
+		VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( allocator->pfnAllocation( allocator->pUserData, sizeof( VkCommandBuffer_t ), 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT ) );
+		if ( commandBuffer == NULL ) {
+			for ( uint32 j = 0; j < i; j++ ) {
+				CommandBuffer_Free( commandPool, reinterpret_cast< VkCommandBuffer_t * >( pCommandBuffers[ j ] ), allocator );
+				pCommandBuffers[ j ] = VK_NULL_HANDLE;
+			}
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		memset( commandBuffer, 0, sizeof( *commandBuffer ) );
+		set_loader_magic_value( commandBuffer );
+		commandBuffer->device = device;
+		commandBuffer->pool = commandPool;
+		commandBuffer->pNext = commandPool->pCommandBuffers;
+		if ( commandPool->pCommandBuffers != NULL ) {
+			commandPool->pCommandBuffers->pPrev = commandBuffer;
+		}
+		commandPool->pCommandBuffers = commandBuffer;
+		CommandBuffer_Init( &commandBuffer->commandBuffer, &commandPool->pool );
+		pCommandBuffers[ i ] = reinterpret_cast< VkCommandBuffer >( commandBuffer );
+	}
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkFreeCommandBuffers( VkDevice, VkCommandPool, uint32_t commandBufferCount, const VkCommandBuffer * pCommandBuffers ) {
+	for ( uint32 i = 0; i < commandBufferCount; i++ ) {
+		VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( pCommandBuffers[ i ] );
+		if ( commandBuffer != NULL ) {
+			CommandBuffer_Free( commandBuffer->pool, commandBuffer, &defaultAllocator );
+		}
+	}
+}
+
+VkResult VKAPI_CALL vkBeginCommandBuffer( VkCommandBuffer vCommandBuffer, const VkCommandBufferBeginInfo * ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	commandBuffer->renderPass = NULL;
+	commandBuffer->framebuffer = NULL;
+	CommandBuffer_Begin( &commandBuffer->commandBuffer );
+	return VK_SUCCESS;
+}
+
+VkResult VKAPI_CALL vkEndCommandBuffer( VkCommandBuffer vCommandBuffer ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	return CommandBuffer_End( &commandBuffer->commandBuffer );
+}
+
+VkResult VKAPI_CALL vkResetCommandBuffer( VkCommandBuffer vCommandBuffer, VkCommandBufferResetFlags ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	CommandBuffer_Reset( &commandBuffer->commandBuffer );
+	return VK_SUCCESS;
+}
+
+/* ==== Commands ==== */
+static bool RenderPass_FirstUse( const VkRenderPass_t * renderPass, uint32 subpass, uint32 attachment ) {
+	for ( uint32 i = 0; i < subpass; i++ ) {
+		if ( renderPass->pSubpasses[ i ].colorAttachment == attachment || renderPass->pSubpasses[ i ].depthAttachment == attachment ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool RenderPass_OnlyUse( const VkRenderPass_t * renderPass, uint32 subpass, uint32 attachment ) {
+	for ( uint32 i = 0; i < renderPass->subpassCount; i++ ) {
+		if ( i != subpass && ( renderPass->pSubpasses[ i ].colorAttachment == attachment || renderPass->pSubpasses[ i ].depthAttachment == attachment ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//An attachment in lazily allocated memory stays in the rasterizer's tile memory when its contents die with the subpass:
+//nothing is stored and no other subpass uses it.  Otherwise its memory is committed here, at record time
+static bool CommandBuffer_TransientAttachment( VkCommandBuffer_t * commandBuffer, uint32 attachment, VkImage_t * image, bool hasStencil ) {
+	if ( image->data != NULL ) {
+		return false;
+	}
+	const VkAttachmentDescription_t & description = commandBuffer->renderPass->pAttachments[ attachment ];
+	const bool discarded = ( description.storeOp == VK_ATTACHMENT_STORE_OP_DONT_CARE ) && ( !hasStencil || description.stencilStoreOp == VK_ATTACHMENT_STORE_OP_DONT_CARE );
+	if ( discarded && RenderPass_OnlyUse( commandBuffer->renderPass, commandBuffer->subpass, attachment ) ) {
+		return true;
+	}
+	Image_Commit( commandBuffer->device, image );
+	return false;
+}
+
+//Each subpass is its own rasterizer pass; attachments with a clear load op are cleared by the first subpass that uses them
+static void CommandBuffer_BeginSubpass( VkCommandBuffer_t * commandBuffer ) {
+	const VkRenderPass_t * renderPass = commandBuffer->renderPass;
+	const VkFramebuffer_t * framebuffer = commandBuffer->framebuffer;
+	const VkSubpassDescription_t & subpass = renderPass->pSubpasses[ commandBuffer->subpass ];
+	rasterTarget_t target;
+	memset( &target, 0, sizeof( target ) );
+	target.width = framebuffer->width;
+	target.height = framebuffer->height;
+	const float * pClearColor = NULL;
+	const float * pClearDepth = NULL;
+	const uint32 * pClearStencil = NULL;
+	if ( subpass.colorAttachment < framebuffer->attachmentCount ) {
+		const VkImageView_t * view = framebuffer->ppAttachments[ subpass.colorAttachment ];
+		target.transient = CommandBuffer_TransientAttachment( commandBuffer, subpass.colorAttachment, view->image, false );
+		target.data = reinterpret_cast< uint8 * >( view->image->data );
+		target.layout = &view->image->layout;
+		target.clearState = ( view->image->clearState.pTiles != NULL && !target.transient ) ? &view->image->clearState : NULL;
+		target.mipLevel = view->baseMipLevel;
+		target.arrayLayer = view->baseArrayLayer;
+		target.format = view->format;
+		if ( renderPass->pAttachments[ subpass.colorAttachment ].loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR && RenderPass_FirstUse( renderPass, commandBuffer->subpass, subpass.colorAttachment ) && commandBuffer->pClearValues != NULL ) {
+			pClearColor = commandBuffer->pClearValues[ subpass.colorAttachment ].color.float32;
+		}
+	}
+	if ( subpass.depthAttachment < framebuffer->attachmentCount ) {
+		const VkImageView_t * view = framebuffer->ppAttachments[ subpass.depthAttachment ];
+		target.depthTransient = CommandBuffer_TransientAttachment( commandBuffer, subpass.depthAttachment, view->image, view->format == VK_FORMAT_D24_UNORM_S8_UINT );
+		target.depthData = reinterpret_cast< uint8 * >( view->image->data );
+		target.depthLayout = &view->image->layout;
+		target.depthClearState = ( view->image->clearState.pTiles != NULL && !target.depthTransient ) ? &view->image->clearState : NULL;
+		target.depthFormat = view->format;
+		const VkAttachmentDescription_t & attachment = renderPass->pAttachments[ subpass.depthAttachment ];
+		if ( RenderPass_FirstUse( renderPass, commandBuffer->subpass, subpass.depthAttachment ) && commandBuffer->pClearValues != NULL ) {
+			if ( attachment.loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR ) {
+				pClearDepth = &commandBuffer->pClearValues[ subpass.depthAttachment ].depthStencil.depth;
+			}
+			if ( attachment.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_CLEAR ) {
+				pClearStencil = &commandBuffer->pClearValues[ subpass.depthAttachment ].depthStencil.stencil;
+			}
+		}
+	}
+	CommandBuffer_BeginRenderPass( &commandBuffer->commandBuffer, target, commandBuffer->renderArea, pClearColor, pClearDepth, pClearStencil );
+}
+
+void VKAPI_CALL vkCmdBeginRenderPass( VkCommandBuffer vCommandBuffer, const VkRenderPassBeginInfo * pRenderPassBegin, VkSubpassContents ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	VkDevice_t * device = commandBuffer->device;
+	commandBuffer->renderPass = device->renderPasses.Get( pRenderPassBegin->renderPass );
+	commandBuffer->framebuffer = device->framebuffers.Get( pRenderPassBegin->framebuffer );
+	commandBuffer->subpass = 0;
+	commandBuffer->renderArea = pRenderPassBegin->renderArea;
+	commandBuffer->pClearValues = NULL;
+	if ( commandBuffer->renderPass == NULL || commandBuffer->framebuffer == NULL ) {
+		return;
+	}
+	if ( pRenderPassBegin->clearValueCount > 0 ) {
+		const size_t clearSize = sizeof( VkClearValue ) * pRenderPassBegin->clearValueCount;
+		VkClearValue * pClearValues = reinterpret_cast< VkClearValue * >( HostArena_Allocate( &commandBuffer->pool->pool.arena, clearSize, 16 ) );
+		if ( pClearValues != NULL ) {
+			memcpy( pClearValues, pRenderPassBegin->pClearValues, clearSize );
+		}
+		commandBuffer->pClearValues = pClearValues;
+	}
+	CommandBuffer_BeginSubpass( commandBuffer );
+}
+
+void VKAPI_CALL vkCmdNextSubpass( VkCommandBuffer vCommandBuffer, VkSubpassContents ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	if ( commandBuffer->renderPass == NULL || commandBuffer->framebuffer == NULL || commandBuffer->subpass + 1 >= commandBuffer->renderPass->subpassCount ) {
+		return;
+	}
+	CommandBuffer_EndRenderPass( &commandBuffer->commandBuffer );
+	commandBuffer->subpass++;
+	CommandBuffer_BeginSubpass( commandBuffer );
+}
+
+void VKAPI_CALL vkCmdEndRenderPass( VkCommandBuffer vCommandBuffer ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	if ( commandBuffer->renderPass == NULL || commandBuffer->framebuffer == NULL ) {
+		return;
+	}
+	CommandBuffer_EndRenderPass( &commandBuffer->commandBuffer );
+	commandBuffer->renderPass = NULL;
+	commandBuffer->framebuffer = NULL;
+}
+
+void VKAPI_CALL vkCmdBindPipeline( VkCommandBuffer vCommandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline vPipeline ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkPipeline_t * pipeline = commandBuffer->device->pipelines.Get( vPipeline );
+	if ( pipeline == NULL || pipeline->bindPoint != pipelineBindPoint ) {
+		return;
+	}
+	if ( pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS ) {
+		CommandBuffer_BindGraphicsPipeline( &commandBuffer->commandBuffer, &pipeline->graphics );
+	} else {
+		CommandBuffer_BindComputePipeline( &commandBuffer->commandBuffer, &pipeline->compute );
+	}
+}
+
+//maxViewports is 1, so only the first viewport and scissor exist
+void VKAPI_CALL vkCmdSetViewport( VkCommandBuffer vCommandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport * pViewports ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	if ( firstViewport == 0 && viewportCount > 0 ) {
+		CommandBuffer_SetViewport( &commandBuffer->commandBuffer, pViewports[ 0 ] );
+	}
+}
+
+void VKAPI_CALL vkCmdSetScissor( VkCommandBuffer vCommandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D * pScissors ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	if ( firstScissor == 0 && scissorCount > 0 ) {
+		CommandBuffer_SetScissor( &commandBuffer->commandBuffer, pScissors[ 0 ] );
+	}
+}
+
+void VKAPI_CALL vkCmdBindVertexBuffers( VkCommandBuffer vCommandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer * pBuffers, const VkDeviceSize * pOffsets ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const uint8 * ppData[ PIPELINE_MAX_VERTEX_BINDINGS ];
+	bindingCount = Min( bindingCount, ( uint32 )PIPELINE_MAX_VERTEX_BINDINGS );
+	for ( uint32 i = 0; i < bindingCount; i++ ) {
+		const VkBuffer_t * buffer = commandBuffer->device->buffers.Get( pBuffers[ i ] );
+		ppData[ i ] = ( buffer != NULL && buffer->data != NULL ) ? buffer->data + pOffsets[ i ] : NULL;
+	}
+	CommandBuffer_BindVertexBuffers( &commandBuffer->commandBuffer, firstBinding, bindingCount, ppData );
+}
+
+void VKAPI_CALL vkCmdBindIndexBuffer( VkCommandBuffer vCommandBuffer, VkBuffer vBuffer, VkDeviceSize offset, VkIndexType indexType ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * buffer = commandBuffer->device->buffers.Get( vBuffer );
+	CommandBuffer_BindIndexBuffer( &commandBuffer->commandBuffer, ( buffer != NULL && buffer->data != NULL ) ? buffer->data + offset : NULL, indexType );
+}
+
+void VKAPI_CALL vkCmdBindDescriptorSets( VkCommandBuffer vCommandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet * pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t * pDynamicOffsets ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const descriptorSet_t * ppSets[ COMMAND_MAX_DESCRIPTOR_SETS ];
+	descriptorSetCount = Min( descriptorSetCount, ( uint32 )COMMAND_MAX_DESCRIPTOR_SETS );
+	for ( uint32 i = 0; i < descriptorSetCount; i++ ) {
+		const VkDescriptorSet_t * set = commandBuffer->device->descriptorSets.Get( pDescriptorSets[ i ] );
+		ppSets[ i ] = ( set != NULL ) ? &set->set : NULL;
+	}
+	CommandBuffer_BindDescriptorSets( &commandBuffer->commandBuffer, pipelineBindPoint, firstSet, descriptorSetCount, ppSets, dynamicOffsetCount, pDynamicOffsets );
+}
+
+void VKAPI_CALL vkCmdPushConstants( VkCommandBuffer vCommandBuffer, VkPipelineLayout, VkShaderStageFlags, uint32_t offset, uint32_t size, const void * pValues ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	CommandBuffer_PushConstants( &commandBuffer->commandBuffer, offset, size, pValues );
+}
+
+void VKAPI_CALL vkCmdDraw( VkCommandBuffer vCommandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	CommandBuffer_Draw( &commandBuffer->commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance );
+}
+
+void VKAPI_CALL vkCmdDrawIndexed( VkCommandBuffer vCommandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	CommandBuffer_DrawIndexed( &commandBuffer->commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance );
+}
+
+//Argument and count buffers are only resolved to memory here; their contents are read when the draw replays
+void VKAPI_CALL vkCmdDrawIndirect( VkCommandBuffer vCommandBuffer, VkBuffer vBuffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * buffer = commandBuffer->device->buffers.Get( vBuffer );
+	if ( buffer == NULL || buffer->data == NULL ) {
+		return;
+	}
+	CommandBuffer_DrawIndirect( &commandBuffer->commandBuffer, buffer->data + offset, drawCount, stride, NULL );
+}
+
+void VKAPI_CALL vkCmdDrawIndexedIndirect( VkCommandBuffer vCommandBuffer, VkBuffer vBuffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * buffer = commandBuffer->device->buffers.Get( vBuffer );
+	if ( buffer == NULL || buffer->data == NULL ) {
+		return;
+	}
+	CommandBuffer_DrawIndexedIndirect( &commandBuffer->commandBuffer, buffer->data + offset, drawCount, stride, NULL );
+}
+
+void VKAPI_CALL vkCmdDrawIndirectCountKHR( VkCommandBuffer vCommandBuffer, VkBuffer vBuffer, VkDeviceSize offset, VkBuffer vCountBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * buffer = commandBuffer->device->buffers.Get( vBuffer );
+	const VkBuffer_t * countBuffer = commandBuffer->device->buffers.Get( vCountBuffer );
+	if ( buffer == NULL || buffer->data == NULL || countBuffer == NULL || countBuffer->data == NULL ) {
+		return;
+	}
+	CommandBuffer_DrawIndirect( &commandBuffer->commandBuffer, buffer->data + offset, maxDrawCount, stride, countBuffer->data + countBufferOffset );
+}
+
+void VKAPI_CALL vkCmdDrawIndexedIndirectCountKHR( VkCommandBuffer vCommandBuffer, VkBuffer vBuffer, VkDeviceSize offset, VkBuffer vCountBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * buffer = commandBuffer->device->buffers.Get( vBuffer );
+	const VkBuffer_t * countBuffer = commandBuffer->device->buffers.Get( vCountBuffer );
+	if ( buffer == NULL || buffer->data == NULL || countBuffer == NULL || countBuffer->data == NULL ) {
+		return;
+	}
+	CommandBuffer_DrawIndexedIndirect( &commandBuffer->commandBuffer, buffer->data + offset, maxDrawCount, stride, countBuffer->data + countBufferOffset );
+}
+
+void VKAPI_CALL vkCmdDispatch( VkCommandBuffer vCommandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	CommandBuffer_Dispatch( &commandBuffer->commandBuffer, groupCountX, groupCountY, groupCountZ );
+}
+
+void VKAPI_CALL vkCmdCopyBuffer( VkCommandBuffer vCommandBuffer, VkBuffer vSrcBuffer, VkBuffer vDstBuffer, uint32_t regionCount, const VkBufferCopy * pRegions ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * src = commandBuffer->device->buffers.Get( vSrcBuffer );
+	const VkBuffer_t * dst = commandBuffer->device->buffers.Get( vDstBuffer );
+	if ( src == NULL || dst == NULL || src->data == NULL || dst->data == NULL ) {
+		return;
+	}
+	for ( uint32 i = 0; i < regionCount; i++ ) {
+		CommandBuffer_CopyBuffer( &commandBuffer->commandBuffer, src->data + pRegions[ i ].srcOffset, dst->data + pRegions[ i ].dstOffset, pRegions[ i ].size );
+	}
+}
+
+//Tiles still pending a lazy clear are written into the buffer from the clear value, without reading the image
+void VKAPI_CALL vkCmdCopyImageToBuffer( VkCommandBuffer vCommandBuffer, VkImage vSrcImage, VkImageLayout, VkBuffer vDstBuffer, uint32_t regionCount, const VkBufferImageCopy * pRegions ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkImage_t * src = commandBuffer->device->images.Get( vSrcImage );
+	const VkBuffer_t * dst = commandBuffer->device->buffers.Get( vDstBuffer );
+	if ( src == NULL || dst == NULL || src->data == NULL || dst->data == NULL ) {
+		return;
+	}
+	const imageClearState_t * clearState = ( src->clearState.pTiles != NULL ) ? &src->clearState : NULL;
+	for ( uint32 i = 0; i < regionCount; i++ ) {
+		const VkBufferImageCopy & region = pRegions[ i ];
+		const VkImageSubresourceLayers & subresource = region.imageSubresource;
+		if ( subresource.mipLevel >= src->layout.mipLevels || subresource.baseArrayLayer + subresource.layerCount > src->layout.arrayLayers ) {
+			continue;
+		}
+		const uint64 rowPitch = ( uint64 )ImageLayout_Blocks( &src->layout, ( region.bufferRowLength != 0 ) ? region.bufferRowLength : region.imageExtent.width ) * src->layout.bytesPerTexel;
+		const uint64 depthPitch = rowPitch * ImageLayout_Blocks( &src->layout, ( region.bufferImageHeight != 0 ) ? region.bufferImageHeight : region.imageExtent.height );
+		for ( uint32 layer = 0; layer < subresource.layerCount; layer++ ) {
+			uint8 * pDestination = dst->data + region.bufferOffset + layer * depthPitch * region.imageExtent.depth;
+			CommandBuffer_CopyImageToBuffer( &commandBuffer->commandBuffer, &src->layout, clearState, reinterpret_cast< const uint8 * >( src->data ), subresource.mipLevel, subresource.baseArrayLayer + layer, region.imageOffset, region.imageExtent, pDestination, rowPitch, depthPitch );
+		}
+	}
+}
+
+//Texels are copied as they are; a buffer already in the image's format is uploaded in one pass
+void VKAPI_CALL vkCmdCopyBufferToImage( VkCommandBuffer vCommandBuffer, VkBuffer vSrcBuffer, VkImage vDstImage, VkImageLayout, uint32_t regionCount, const VkBufferImageCopy * pRegions ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * src = commandBuffer->device->buffers.Get( vSrcBuffer );
+	VkImage_t * dst = commandBuffer->device->images.Get( vDstImage );
+	if ( src == NULL || dst == NULL || src->data == NULL || dst->data == NULL ) {
+		return;
+	}
+	imageClearState_t * clearState = ( dst->clearState.pTiles != NULL ) ? &dst->clearState : NULL;
+	for ( uint32 i = 0; i < regionCount; i++ ) {
+		const VkBufferImageCopy & region = pRegions[ i ];
+		const VkImageSubresourceLayers & subresource = region.imageSubresource;
+		if ( subresource.mipLevel >= dst->layout.mipLevels || subresource.baseArrayLayer + subresource.layerCount > dst->layout.arrayLayers ) {
+			continue;
+		}
+		const uint64 rowPitch = ( uint64 )ImageLayout_Blocks( &dst->layout, ( region.bufferRowLength != 0 ) ? region.bufferRowLength : region.imageExtent.width ) * dst->layout.bytesPerTexel;
+		const uint64 depthPitch = rowPitch * ImageLayout_Blocks( &dst->layout, ( region.bufferImageHeight != 0 ) ? region.bufferImageHeight : region.imageExtent.height );
+		for ( uint32 layer = 0; layer < subresource.layerCount; layer++ ) {
+			const uint8 * pSource = src->data + region.bufferOffset + layer * depthPitch * region.imageExtent.depth;
+			CommandBuffer_CopyBufferToImage( &commandBuffer->commandBuffer, &dst->layout, clearState, reinterpret_cast< uint8 * >( dst->data ), subresource.mipLevel, subresource.baseArrayLayer + layer, region.imageOffset, region.imageExtent, pSource, rowPitch, depthPitch );
+		}
+	}
+}
+
+//feature is the blit bit the image's format must have in its tiling; depth formats have neither
+static bool BlitSurface_Init( imageBlitSurface_t * surface, const VkImage_t * image, const VkImageSubresourceLayers & subresource, uint32 layer, const VkOffset3D * pOffsets, VkFormatFeatureFlags feature, cpuIsa_t isa ) {
+	const formatInfo_t * info = Format_Find( image->format );
+	const VkFormatFeatureFlags features = ( info == NULL ) ? 0 : ( image->layout.tiled ? info->optimalFeatures : info->linearFeatures );
+	if ( ( features & feature ) == 0 ) {
+		return false;
+	}
+	if ( subresource.mipLevel >= image->layout.mipLevels || subresource.baseArrayLayer + subresource.layerCount > image->layout.arrayLayers ) {
+		return false;
+	}
+	surface->layout = &image->layout;
+	surface->data = reinterpret_cast< uint8 * >( image->data );
+	surface->mipLevel = subresource.mipLevel;
+	surface->arrayLayer = subresource.baseArrayLayer + layer;
+	surface->offsets[ 0 ] = pOffsets[ 0 ];
+	surface->offsets[ 1 ] = pOffsets[ 1 ];
+	//Compressed sources decode a block at a time into a format the converters know
+	surface->decode = Format_SelectDecoder( image->format, isa );
+	return Format_SelectConverter( ( surface->decode != NULL ) ? info->decodedFormat : image->format, isa, &surface->converter );
+}
+
+//Any two color formats with converters blit into each other, except that integers only go to integers of the same signedness
+void VKAPI_CALL vkCmdBlitImage( VkCommandBuffer vCommandBuffer, VkImage vSrcImage, VkImageLayout, VkImage vDstImage, VkImageLayout, uint32_t regionCount, const VkImageBlit * pRegions, VkFilter filter ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	VkImage_t * src = commandBuffer->device->images.Get( vSrcImage );
+	VkImage_t * dst = commandBuffer->device->images.Get( vDstImage );
+	if ( src == NULL || dst == NULL || src->data == NULL || dst->data == NULL ) {
+		return;
+	}
+	const cpuIsa_t isa = commandBuffer->device->physicalDevice->isa;
+	imageClearState_t * srcClearState = ( src->clearState.pTiles != NULL ) ? &src->clearState : NULL;
+	imageClearState_t * dstClearState = ( dst->clearState.pTiles != NULL ) ? &dst->clearState : NULL;
+	for ( uint32 i = 0; i < regionCount; i++ ) {
+		const VkImageBlit & region = pRegions[ i ];
+		for ( uint32 layer = 0; layer < region.dstSubresource.layerCount; layer++ ) {
+			imageBlitSurface_t srcSurface;
+			imageBlitSurface_t dstSurface;
+			if ( !BlitSurface_Init( &srcSurface, src, region.srcSubresource, layer, region.srcOffsets, VK_FORMAT_FEATURE_BLIT_SRC_BIT, isa ) || !BlitSurface_Init( &dstSurface, dst, region.dstSubresource, layer, region.dstOffsets, VK_FORMAT_FEATURE_BLIT_DST_BIT, isa ) ) {
+				break;
+			}
+			if ( Format_IsInteger( srcSurface.converter.info ) != Format_IsInteger( dstSurface.converter.info ) || ( Format_IsInteger( srcSurface.converter.info ) && srcSurface.converter.info->numeric != dstSurface.converter.info->numeric ) ) {
+				break;
+			}
+			CommandBuffer_BlitImage( &commandBuffer->commandBuffer, srcSurface, srcClearState, dstSurface, dstClearState, filter );
+		}
+	}
+}
+
+void VKAPI_CALL vkCmdFillBuffer( VkCommandBuffer vCommandBuffer, VkBuffer vDstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * dst = commandBuffer->device->buffers.Get( vDstBuffer );
+	if ( dst == NULL || dst->data == NULL || dstOffset >= dst->size ) {
+		return;
+	}
+	if ( size == VK_WHOLE_SIZE ) {
+		size = ( dst->size - dstOffset ) & ~3ULL;
+	}
+	CommandBuffer_FillBuffer( &commandBuffer->commandBuffer, dst->data + dstOffset, size, data );
+}
+
+void VKAPI_CALL vkCmdUpdateBuffer( VkCommandBuffer vCommandBuffer, VkBuffer vDstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void * pData ) {
+	VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( vCommandBuffer );
+	const VkBuffer_t * dst = commandBuffer->device->buffers.Get( vDstBuffer );
+	if ( dst == NULL || dst->data == NULL || dataSize > 65536 ) {
+		return;
+	}
+	CommandBuffer_UpdateBuffer( &commandBuffer->commandBuffer, dst->data + dstOffset, dataSize, pData );
+}
+
+//Commands replay in order on one thread and each draw, dispatch and transfer completes before the next starts
+void VKAPI_CALL vkCmdPipelineBarrier( VkCommandBuffer, VkPipelineStageFlags, VkPipelineStageFlags, VkDependencyFlags, uint32_t, const VkMemoryBarrier *, uint32_t, const VkBufferMemoryBarrier *, uint32_t, const VkImageMemoryBarrier * ) {
+}
+
+/* ==== Fences and semaphores ==== */
+
+VkResult VKAPI_CALL vkCreateFence( VkDevice vDevice, const VkFenceCreateInfo * pCreateInfo, const VkAllocationCallbacks *, VkFence * pFence ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	uint64 handle;
+	VkFence_t * fence = device->fences.Allocate( &handle );
+	if ( fence == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	fence->valid = true;
+	Fence_Init( &fence->fence, &device->syncEvent, ( pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT ) != 0 );
+	*pFence = reinterpret_cast< VkFence >( handle );
+	return VK_SUCCESS;
+}
+
+void VKAPI_CALL vkDestroyFence( VkDevice vDevice, VkFence vFence, const VkAllocationCallbacks * ) {
+	if ( vFence == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkFence_t * fence = device->fences.Get( vFence );
+	if ( fence == NULL ) {
+		return;
+	}
+	Fence_Init( &fence->fence, NULL, false );
+	fence->valid = false;
+	device->fences.Free( vFence );
+}
+
+VkResult VKAPI_CALL vkResetFences( VkDevice vDevice, uint32_t fenceCount, const VkFence * pFences ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	for ( uint32 i = 0; i < fenceCount; i++ ) {
+		VkFence_t * fence = device->fences.Get( pFences[ i ] );
+		VK_VALIDATE( fence != NULL );
+		Fence_Reset( &fence->fence );
+	}
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+VkResult VKAPI_CALL vkGetFenceStatus( VkDevice vDevice, VkFence vFence ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkFence_t * fence = device->fences.Get( vFence );
+	VK_VALIDATE( fence != NULL );
+	return Fence_IsSignaled( &fence->fence ) ? VK_SUCCESS : VK_NOT_READY;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+//Waits of up to this many objects resolve their handles on the stack
+#define SYNC_LOCAL_WAIT_COUNT 16
+
+VkResult VKAPI_CALL vkWaitForFences( VkDevice vDevice, uint32_t fenceCount, const VkFence * pFences, VkBool32 waitAll, uint64_t timeout ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	syncFence_t * pLocalFences[ SYNC_LOCAL_WAIT_COUNT ];
+	syncFence_t ** ppFences = pLocalFences;
+	VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
+	if ( fenceCount > SYNC_LOCAL_WAIT_COUNT ) {
+		ppFences = reinterpret_cast< syncFence_t ** >( device->allocator.pfnAllocation( device->allocator.pUserData, sizeof( syncFence_t * ) * fenceCount, 8, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ) );
+		if ( ppFences == NULL ) {
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+	for ( uint32 i = 0; i < fenceCount; i++ ) {
+		VkFence_t * fence = device->fences.Get( pFences[ i ] );
+		if ( fence == NULL ) {
+			goto waitDone;
+		}
+		ppFences[ i ] = &fence->fence;
+	}
+	result = Fence_Wait( &device->syncEvent, ppFences, fenceCount, waitAll != VK_FALSE, timeout );
+
+waitDone:
+	if ( ppFences != pLocalFences ) {
+		device->allocator.pfnFree( device->allocator.pUserData, ppFences );
+	}
+	return result;
+}
+
+VkResult VKAPI_CALL vkCreateSemaphore( VkDevice vDevice, const VkSemaphoreCreateInfo * pCreateInfo, const VkAllocationCallbacks *, VkSemaphore * pSemaphore ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	const VkSemaphoreTypeCreateInfoKHR * typeInfo = reinterpret_cast< const VkSemaphoreTypeCreateInfoKHR * >( Vk_FindInChain( pCreateInfo->pNext, VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR ) );
+	const bool timeline = ( typeInfo != NULL && typeInfo->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE_KHR );
+	uint64 handle;
+	VkSemaphore_t * semaphore = NULL;
+	VK_VALIDATE( !timeline || device->enabledExtensions.CheckFlag( deviceExtension_t::TIMELINE_SEMAPHORE_KHR ) );
+	semaphore = device->semaphores.Allocate( &handle );
+	if ( semaphore == NULL ) {
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	semaphore->valid = true;
+	Semaphore_Init( &semaphore->semaphore, &device->syncEvent, timeline, timeline ? typeInfo->initialValue : 0 );
+	*pSemaphore = reinterpret_cast< VkSemaphore >( handle );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+void VKAPI_CALL vkDestroySemaphore( VkDevice vDevice, VkSemaphore vSemaphore, const VkAllocationCallbacks * ) {
+	if ( vSemaphore == VK_NULL_HANDLE ) {
+		return;
+	}
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkSemaphore_t * semaphore = device->semaphores.Get( vSemaphore );
+	if ( semaphore == NULL ) {
+		return;
+	}
+	Semaphore_Init( &semaphore->semaphore, NULL, false, 0 );
+	semaphore->valid = false;
+	device->semaphores.Free( vSemaphore );
+}
+
+VkResult VKAPI_CALL vkGetSemaphoreCounterValueKHR( VkDevice vDevice, VkSemaphore vSemaphore, uint64_t * pValue ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkSemaphore_t * semaphore = device->semaphores.Get( vSemaphore );
+	VK_VALIDATE( semaphore != NULL && semaphore->semaphore.timeline );
+	*pValue = Semaphore_Value( &semaphore->semaphore );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+VkResult VKAPI_CALL vkSignalSemaphoreKHR( VkDevice vDevice, const VkSemaphoreSignalInfoKHR * pSignalInfo ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	VkSemaphore_t * semaphore = device->semaphores.Get( pSignalInfo->semaphore );
+	VK_VALIDATE( semaphore != NULL && semaphore->semaphore.timeline );
+	VK_VALIDATE( pSignalInfo->value > Semaphore_Value( &semaphore->semaphore ) );
+	Semaphore_Signal( &semaphore->semaphore, pSignalInfo->value );
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+VkResult VKAPI_CALL vkWaitSemaphoresKHR( VkDevice vDevice, const VkSemaphoreWaitInfoKHR * pWaitInfo, uint64_t timeout ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	syncSemaphore_t * pLocalSemaphores[ SYNC_LOCAL_WAIT_COUNT ];
+	syncSemaphore_t ** ppSemaphores = pLocalSemaphores;
+	VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
+	if ( pWaitInfo->semaphoreCount > SYNC_LOCAL_WAIT_COUNT ) {
+		ppSemaphores = reinterpret_cast< syncSemaphore_t ** >( device->allocator.pfnAllocation( device->allocator.pUserData, sizeof( syncSemaphore_t * ) * pWaitInfo->semaphoreCount, 8, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ) );
+		if ( ppSemaphores == NULL ) {
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+	for ( uint32 i = 0; i < pWaitInfo->semaphoreCount; i++ ) {
+		VkSemaphore_t * semaphore = device->semaphores.Get( pWaitInfo->pSemaphores[ i ] );
+		if ( semaphore == NULL || !semaphore->semaphore.timeline ) {
+			goto waitDone;
+		}
+		ppSemaphores[ i ] = &semaphore->semaphore;
+	}
+	result = Semaphore_Wait( &device->syncEvent, ppSemaphores, pWaitInfo->pValues, pWaitInfo->semaphoreCount, ( pWaitInfo->flags & VK_SEMAPHORE_WAIT_ANY_BIT_KHR ) == 0, timeout );
+
+waitDone:
+	if ( ppSemaphores != pLocalSemaphores ) {
+		device->allocator.pfnFree( device->allocator.pUserData, ppSemaphores );
+	}
+	return result;
+}
+
+/* ==== Queues ==== */
+void VKAPI_CALL vkGetDeviceQueue( VkDevice vDevice, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue * pQueue ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	if ( queueFamilyIndex >= device->queueFamilyCount || queueIndex >= device->pQueueFamilies[ queueFamilyIndex ].queueCount ) {
+		*pQueue = VK_NULL_HANDLE;
+		return;
+	}
+	*pQueue = reinterpret_cast< VkQueue >( &device->pQueueFamilies[ queueFamilyIndex ].pQueues[ queueIndex ] );
+}
+
+//Everything is validated before the first operation is written, so a failed submission leaves the queue untouched
+static VkResult QueueSubmit_Validate( VkDevice_t * device, uint32 submitCount, const VkSubmitInfo * pSubmits, VkFence vFence ) {
+	VK_VALIDATE( vFence == VK_NULL_HANDLE || device->fences.Get( vFence ) != NULL );
+	for ( uint32 i = 0; i < submitCount; i++ ) {
+		const VkSubmitInfo & submit = pSubmits[ i ];
+		const VkTimelineSemaphoreSubmitInfoKHR * timelineInfo = reinterpret_cast< const VkTimelineSemaphoreSubmitInfoKHR * >( Vk_FindInChain( submit.pNext, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR ) );
+		for ( uint32 j = 0; j < submit.waitSemaphoreCount; j++ ) {
+			const VkSemaphore_t * semaphore = device->semaphores.Get( submit.pWaitSemaphores[ j ] );
+			VK_VALIDATE( semaphore != NULL );
+			VK_VALIDATE( !semaphore->semaphore.timeline || ( timelineInfo != NULL && j < timelineInfo->waitSemaphoreValueCount ) );
+		}
+		for ( uint32 j = 0; j < submit.signalSemaphoreCount; j++ ) {
+			const VkSemaphore_t * semaphore = device->semaphores.Get( submit.pSignalSemaphores[ j ] );
+			VK_VALIDATE( semaphore != NULL );
+			VK_VALIDATE( !semaphore->semaphore.timeline || ( timelineInfo != NULL && j < timelineInfo->signalSemaphoreValueCount ) );
+		}
+		for ( uint32 j = 0; j < submit.commandBufferCount; j++ ) {
+			const VkCommandBuffer_t * commandBuffer = reinterpret_cast< const VkCommandBuffer_t * >( submit.pCommandBuffers[ j ] );
+			VK_VALIDATE( CommandBuffer_IsRecorded( &commandBuffer->commandBuffer ) );
+		}
+	}
+	return VK_SUCCESS;
+
+VK_VALIDATION_FAILED_LABEL:
+	return VK_ERROR_VALIDATION_FAILED_EXT;
+}
+
+//Returns once the work is in the queue's ring; waits block the whole queue, whatever pWaitDstStageMask says
+VkResult VKAPI_CALL vkQueueSubmit( VkQueue vQueue, uint32_t submitCount, const VkSubmitInfo * pSubmits, VkFence vFence ) {
+	VkQueue_t * queue = reinterpret_cast< VkQueue_t * >( vQueue );
+	VkDevice_t * device = queue->device;
+	VkResult result = QueueSubmit_Validate( device, submitCount, pSubmits, vFence );
+	if ( result != VK_SUCCESS ) {
+		return result;
+	}
+	for ( uint32 i = 0; i < submitCount; i++ ) {
+		const VkSubmitInfo & submit = pSubmits[ i ];
+		const VkTimelineSemaphoreSubmitInfoKHR * timelineInfo = reinterpret_cast< const VkTimelineSemaphoreSubmitInfoKHR * >( Vk_FindInChain( submit.pNext, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR ) );
+		for ( uint32 j = 0; j < submit.waitSemaphoreCount; j++ ) {
+			syncSemaphore_t * semaphore = &device->semaphores.Get( submit.pWaitSemaphores[ j ] )->semaphore;
+			const uint64 value = semaphore->timeline ? timelineInfo->pWaitSemaphoreValues[ j ] : Semaphore_NextWait( semaphore );
+			Queue_Push( queue->queue, queueOp_t::WAIT, semaphore, value );
+		}
+		for ( uint32 j = 0; j < submit.commandBufferCount; j++ ) {
+			VkCommandBuffer_t * commandBuffer = reinterpret_cast< VkCommandBuffer_t * >( submit.pCommandBuffers[ j ] );
+			Queue_Push( queue->queue, queueOp_t::EXECUTE, &commandBuffer->commandBuffer, 0 );
+		}
+		for ( uint32 j = 0; j < submit.signalSemaphoreCount; j++ ) {
+			syncSemaphore_t * semaphore = &device->semaphores.Get( submit.pSignalSemaphores[ j ] )->semaphore;
+			const uint64 value = semaphore->timeline ? timelineInfo->pSignalSemaphoreValues[ j ] : Semaphore_NextSignal( semaphore );
+			Queue_Push( queue->queue, queueOp_t::SIGNAL, semaphore, value );
+		}
+	}
+	if ( vFence != VK_NULL_HANDLE ) {
+		Queue_Push( queue->queue, queueOp_t::FENCE, &device->fences.Get( vFence )->fence, 0 );
+	}
+	Queue_Publish( queue->queue );
+	return VK_SUCCESS;
+}
+
+VkResult VKAPI_CALL vkQueueWaitIdle( VkQueue vQueue ) {
+	VkQueue_t * queue = reinterpret_cast< VkQueue_t * >( vQueue );
+	Queue_WaitIdle( queue->queue );
+	return VK_SUCCESS;
+}
+
+VkResult VKAPI_CALL vkDeviceWaitIdle( VkDevice vDevice ) {
+	VkDevice_t * device = reinterpret_cast< VkDevice_t * >( vDevice );
+	for ( uint32 i = 0; i < device->queueFamilyCount; i++ ) {
+		for ( uint32 j = 0; j < device->pQueueFamilies[ i ].queueCount; j++ ) {
+			Queue_WaitIdle( device->pQueueFamilies[ i ].pQueues[ j ].queue );
+		}
+	}
+	return VK_SUCCESS;
+}
+
+
+enum class procScope_t {
+	INSTANCE,	//Global, instance and physical device level entry points
+	DEVICE,		//Entry points that are also reachable through vkGetDeviceProcAddr
+};
+
+//Every entry point the ICD implements, with the dispatch level it belongs to
+#define VK_ENTRY_POINTS( X ) \
+	X( vkCreateInstance,								INSTANCE ) \
+	X( vkEnumerateInstanceExtensionProperties,			INSTANCE ) \
+	X( vkDestroyInstance,								INSTANCE ) \
+	X( vkEnumeratePhysicalDevices,						INSTANCE ) \
+	X( vkGetPhysicalDeviceFeatures,						INSTANCE ) \
+	X( vkGetPhysicalDeviceFormatProperties,				INSTANCE ) \
+	X( vkGetPhysicalDeviceImageFormatProperties,		INSTANCE ) \
+	X( vkGetPhysicalDeviceProperties,					INSTANCE ) \
+	X( vkGetPhysicalDeviceQueueFamilyProperties,		INSTANCE ) \
+	X( vkGetPhysicalDeviceMemoryProperties,				INSTANCE ) \
+	X( vkCreateDevice,									INSTANCE ) \
+	X( vkEnumerateDeviceExtensionProperties,			INSTANCE ) \
+	X( vkGetPhysicalDeviceSparseImageFormatProperties,	INSTANCE ) \
+	X( vkGetPhysicalDeviceFeatures2KHR,					INSTANCE ) \
+	X( vkGetPhysicalDeviceProperties2KHR,				INSTANCE ) \
+	X( vkGetPhysicalDeviceFormatProperties2KHR,			INSTANCE ) \
+	X( vkGetPhysicalDeviceImageFormatProperties2KHR,	INSTANCE ) \
+	X( vkGetPhysicalDeviceQueueFamilyProperties2KHR,	INSTANCE ) \
+	X( vkGetPhysicalDeviceMemoryProperties2KHR,			INSTANCE ) \
+	X( vkGetPhysicalDeviceSparseImageFormatProperties2KHR,	INSTANCE ) \
+	X( vkGetPhysicalDeviceSurfaceCapabilitiesKHR,		INSTANCE ) \
+	X( vkGetPhysicalDeviceSurfaceSupportKHR,			INSTANCE ) \
+	X( vkGetPhysicalDeviceSurfaceFormatsKHR,			INSTANCE ) \
+	X( vkGetPhysicalDeviceSurfacePresentModesKHR,		INSTANCE ) \
+	X( vkGetDeviceProcAddr,								DEVICE ) \
+	X( vkDestroyDevice,									DEVICE ) \
+	X( vkCreateImage,									DEVICE ) \
+	X( vkDestroyImage,									DEVICE ) \
+	X( vkGetImageMemoryRequirements,					DEVICE ) \
+	X( vkGetImageSubresourceLayout,						DEVICE ) \
+	X( vkAllocateMemory,								DEVICE ) \
+	X( vkFreeMemory,									DEVICE ) \
+	X( vkBindImageMemory,								DEVICE ) \
+	X( vkGetDeviceMemoryCommitment,						DEVICE ) \
+	X( vkCreateSwapchainKHR,							DEVICE ) \
+	X( vkDestroySwapchainKHR,							DEVICE ) \
+	X( vkGetSwapchainImagesKHR,							DEVICE ) \
+	X( vkAcquireNextImageKHR,							DEVICE ) \
+	X( vkQueuePresentKHR,								DEVICE ) \
+	X( vkCreateRenderPass,								DEVICE ) \
+	X( vkCreateShaderModule,							DEVICE ) \
+	X( vkDestroyShaderModule,							DEVICE ) \
+	X( vkCreateGraphicsPipelines,						DEVICE ) \
+	X( vkCreateComputePipelines,						DEVICE ) \
+	X( vkDestroyPipeline,								DEVICE ) \
+	X( vkCreatePipelineCache,							DEVICE ) \
+	X( vkDestroyPipelineCache,							DEVICE ) \
+	X( vkGetPipelineCacheData,							DEVICE ) \
+	X( vkMergePipelineCaches,							DEVICE ) \
+	X( vkCreateBuffer,									DEVICE ) \
+	X( vkDestroyBuffer,									DEVICE ) \
+	X( vkGetBufferMemoryRequirements,					DEVICE ) \
+	X( vkBindBufferMemory,								DEVICE ) \
+	X( vkMapMemory,										DEVICE ) \
+	X( vkUnmapMemory,									DEVICE ) \
+	X( vkFlushMappedMemoryRanges,						DEVICE ) \
+	X( vkInvalidateMappedMemoryRanges,					DEVICE ) \
+	X( vkCreateImageView,								DEVICE ) \
+	X( vkDestroyImageView,								DEVICE ) \
+	X( vkCreateFramebuffer,								DEVICE ) \
+	X( vkDestroyFramebuffer,							DEVICE ) \
+	X( vkCreateSampler,									DEVICE ) \
+	X( vkDestroySampler,								DEVICE ) \
+	X( vkCreateDescriptorSetLayout,						DEVICE ) \
+	X( vkDestroyDescriptorSetLayout,					DEVICE ) \
+	X( vkCreatePipelineLayout,							DEVICE ) \
+	X( vkDestroyPipelineLayout,							DEVICE ) \
+	X( vkCreateDescriptorPool,							DEVICE ) \
+	X( vkDestroyDescriptorPool,							DEVICE ) \
+	X( vkResetDescriptorPool,							DEVICE ) \
+	X( vkAllocateDescriptorSets,						DEVICE ) \
+	X( vkFreeDescriptorSets,							DEVICE ) \
+	X( vkUpdateDescriptorSets,							DEVICE ) \
+	X( vkCreateCommandPool,								DEVICE ) \
+	X( vkDestroyCommandPool,							DEVICE ) \
+	X( vkResetCommandPool,								DEVICE ) \
+	X( vkAllocateCommandBuffers,						DEVICE ) \
+	X( vkFreeCommandBuffers,							DEVICE ) \
+	X( vkBeginCommandBuffer,							DEVICE ) \
+	X( vkEndCommandBuffer,								DEVICE ) \
+	X( vkResetCommandBuffer,							DEVICE ) \
+	X( vkCmdBeginRenderPass,							DEVICE ) \
+	X( vkCmdNextSubpass,								DEVICE ) \
+	X( vkCmdEndRenderPass,								DEVICE ) \
+	X( vkCmdBindPipeline,								DEVICE ) \
+	X( vkCmdSetViewport,								DEVICE ) \
+	X( vkCmdSetScissor,									DEVICE ) \
+	X( vkCmdBindVertexBuffers,							DEVICE ) \
+	X( vkCmdBindIndexBuffer,							DEVICE ) \
+	X( vkCmdBindDescriptorSets,							DEVICE ) \
+	X( vkCmdPushConstants,								DEVICE ) \
+	X( vkCmdDraw,										DEVICE ) \
+	X( vkCmdDrawIndexed,								DEVICE ) \
+	X( vkCmdDrawIndirect,								DEVICE ) \
+	X( vkCmdDrawIndexedIndirect,						DEVICE ) \
+	X( vkCmdDrawIndirectCountKHR,						DEVICE ) \
+	X( vkCmdDrawIndexedIndirectCountKHR,				DEVICE ) \
+	X( vkCmdDispatch,									DEVICE ) \
+	X( vkCmdCopyBuffer,									DEVICE ) \
+	X( vkCmdCopyImageToBuffer,							DEVICE ) \
+	X( vkCmdCopyBufferToImage,							DEVICE ) \
+	X( vkCmdBlitImage,									DEVICE ) \
+	X( vkCmdFillBuffer,									DEVICE ) \
+	X( vkCmdUpdateBuffer,								DEVICE ) \
+	X( vkCmdPipelineBarrier,							DEVICE ) \
+	X( vkGetDeviceQueue,								DEVICE ) \
+	X( vkQueueSubmit,									DEVICE ) \
+	X( vkQueueWaitIdle,									DEVICE ) \
+	X( vkDeviceWaitIdle,								DEVICE ) \
+	X( vkCreateFence,									DEVICE ) \
+	X( vkDestroyFence,									DEVICE ) \
+	X( vkResetFences,									DEVICE ) \
+	X( vkGetFenceStatus,								DEVICE ) \
+	X( vkWaitForFences,									DEVICE ) \
+	X( vkCreateSemaphore,								DEVICE ) \
+	X( vkDestroySemaphore,								DEVICE ) \
+	X( vkGetSemaphoreCounterValueKHR,					DEVICE ) \
+	X( vkSignalSemaphoreKHR,							DEVICE ) \
+	X( vkWaitSemaphoresKHR,								DEVICE )
+
+//Names are resolved with a seeded FNV-1a hash folded down to PROC_TABLE_BITS.  The seed is picked so that no two entry points
+//share a slot, which makes the switch in ProcTable_Lookup a perfect hash: one hash, one jump, one strcmp to reject unknown names.
+//Adding an entry point that collides fails to compile with a duplicate case label; bump PROC_TABLE_SEED until it builds again.
+#define PROC_TABLE_BITS 10
+#define PROC_TABLE_SEED 0x811C9FA7
+
+constexpr uint32 ProcTable_HashStep( const char * pName, uint32 hash ) {
+	return ( *pName == '\0' ) ? hash : ProcTable_HashStep( pName + 1, ( hash ^ ( uint8 )*pName ) * 16777619U );
+}
+
+constexpr uint32 ProcTable_Slot( uint32 hash ) {
+	return ( hash ^ ( hash >> 15 ) ) & ( ( 1U << PROC_TABLE_BITS ) - 1 );
+}
+
+constexpr uint32 ProcTable_ConstSlot( const char * pName ) {
+	return ProcTable_Slot( ProcTable_HashStep( pName, PROC_TABLE_SEED ) );
+}
+
+//Runtime twin of ProcTable_ConstSlot; kept iterative so lookups never depend on the optimizer removing the recursion
+static uint32 ProcTable_RuntimeSlot( const char * pName ) {
+	uint32 hash = PROC_TABLE_SEED;
+	for ( const char * c = pName; *c != '\0'; c++ ) {
+		hash = ( hash ^ ( uint8 )*c ) * 16777619U;
+	}
+	return ProcTable_Slot( hash );
+}
+
+#define PROC_TABLE_CASE( funcName, scope ) \
+	case ProcTable_ConstSlot( #funcName ): \
+		if ( ( procScope_t::scope >= minimumScope ) && !strcmp( pName, #funcName ) ) { \
+			return ( PFN_vkVoidFunction )&funcName; \
+		} \
+		return NULL;
+
+static PFN_vkVoidFunction ProcTable_Lookup( const char * pName, procScope_t minimumScope ) {
+	if ( pName == NULL ) {
+		return NULL;
+	}
+
+	switch ( ProcTable_RuntimeSlot( pName ) ) {
+		VK_ENTRY_POINTS( PROC_TABLE_CASE )
+	}
+	return NULL;
+}
+
+#undef PROC_TABLE_CASE
+
+VK_ICD_EXPORT PFN_vkVoidFunction VKAPI_CALL vk_icdGetInstanceProcAddr( VkInstance instance, const char * pName ) {
+	return ProcTable_Lookup( pName, procScope_t::INSTANCE );
+}
+
+PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr( VkDevice device, const char * pName ) {
+	return ProcTable_Lookup( pName, procScope_t::DEVICE );
+}
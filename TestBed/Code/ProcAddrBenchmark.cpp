@@ -0,0 +1,120 @@
+#include "../../SoftwareVulkan/Code/Common.h"
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <string.h>
+
+#define VK_USE_PLATFORM_WIN32_KHR
+#include <vulkan/vulkan.h>
+
+void DebuggerPrintf( const char * fmt, ... );
+
+typedef PFN_vkVoidFunction ( VKAPI_PTR * PFN_vk_icdGetInstanceProcAddr )( VkInstance instance, const char * pName );
+
+//Names the loader and a typical layer stack resolve at startup; the last few are not implemented by the ICD
+static const char * benchmarkNames[] = {
+	"vkCreateInstance",
+	"vkEnumerateInstanceExtensionProperties",
+	"vkDestroyInstance",
+	"vkEnumeratePhysicalDevices",
+	"vkGetPhysicalDeviceFeatures",
+	"vkGetPhysicalDeviceFormatProperties",
+	"vkGetPhysicalDeviceImageFormatProperties",
+	"vkGetPhysicalDeviceProperties",
+	"vkGetPhysicalDeviceQueueFamilyProperties",
+	"vkGetPhysicalDeviceMemoryProperties",
+	"vkGetDeviceProcAddr",
+	"vkCreateDevice",
+	"vkEnumerateDeviceExtensionProperties",
+	"vkGetPhysicalDeviceSparseImageFormatProperties",
+	"vkGetPhysicalDeviceSurfaceCapabilitiesKHR",
+	"vkGetPhysicalDeviceSurfaceSupportKHR",
+	"vkGetPhysicalDeviceSurfaceFormatsKHR",
+	"vkGetPhysicalDeviceSurfacePresentModesKHR",
+	"vkCreateSwapchainKHR",
+	"vkGetSwapchainImagesKHR",
+	"vkCreateRenderPass",
+	"vkEnumerateInstanceVersion",
+	"vkCmdDrawIndexedIndirectCountAMD",
+	"vkGetPhysicalDeviceDisplayPropertiesKHR",
+	"vkCreateDebugReportCallbackEXT",
+};
+
+//Reproduces the strcmp chain the ICD used before the hashed table, so both can be timed in one run
+static PFN_vkVoidFunction LegacyChain_Lookup( const char * pName ) {
+	static const char * chain[] = {
+		"vkCreateInstance",
+		"vkEnumerateInstanceExtensionProperties",
+		"vkDestroyInstance",
+		"vkEnumeratePhysicalDevices",
+		"vkGetPhysicalDeviceFeatures",
+		"vkGetPhysicalDeviceFormatProperties",
+		"vkGetPhysicalDeviceImageFormatProperties",
+		"vkGetPhysicalDeviceProperties",
+		"vkGetPhysicalDeviceQueueFamilyProperties",
+		"vkGetPhysicalDeviceMemoryProperties",
+		"vkGetDeviceProcAddr",
+		"vkCreateDevice",
+		"vkEnumerateDeviceExtensionProperties",
+		"vkGetPhysicalDeviceSparseImageFormatProperties",
+		"vkGetPhysicalDeviceSurfaceCapabilitiesKHR",
+		"vkGetPhysicalDeviceSurfaceSupportKHR",
+		"vkGetPhysicalDeviceSurfaceFormatsKHR",
+		"vkGetPhysicalDeviceSurfacePresentModesKHR",
+		"vkCreateSwapchainKHR",
+	};
+	for ( uint32 i = 0; i < ARRAY_LENGTH( chain ); i++ ) {
+		if ( !strcmp( pName, chain[ i ] ) ) {
+			return ( PFN_vkVoidFunction )chain[ i ];
+		}
+	}
+	return NULL;
+}
+
+static double ProcAddrBenchmark_Time( PFN_vk_icdGetInstanceProcAddr lookup, uint32 iterations, uint32 * pResolved ) {
+	LARGE_INTEGER freq;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	QueryPerformanceFrequency( &freq );
+	uint32 resolved = 0;
+	QueryPerformanceCounter( &start );
+	for ( uint32 i = 0; i < iterations; i++ ) {
+		for ( uint32 j = 0; j < ARRAY_LENGTH( benchmarkNames ); j++ ) {
+			resolved += ( lookup( VK_NULL_HANDLE, benchmarkNames[ j ] ) != NULL ) ? 1 : 0;
+		}
+	}
+	QueryPerformanceCounter( &end );
+	*pResolved = resolved / iterations;
+	double seconds = static_cast< double >( end.QuadPart - start.QuadPart ) / static_cast< double >( freq.QuadPart );
+	return seconds * 1e9 / ( static_cast< double >( iterations ) * ARRAY_LENGTH( benchmarkNames ) );
+}
+
+static PFN_vkVoidFunction VKAPI_PTR LegacyChain_GetInstanceProcAddr( VkInstance, const char * pName ) {
+	return LegacyChain_Lookup( pName );
+}
+
+//Times name resolution through the ICD's hashed dispatch table against the old linear strcmp chain
+void ProcAddrBenchmark_Run() {
+	HMODULE icd = LoadLibraryA( "SoftwareVulkan.dll" );
+	if ( icd == NULL ) {
+		DebuggerPrintf( "ProcAddrBenchmark: could not load SoftwareVulkan.dll\n" );
+		return;
+	}
+	PFN_vk_icdGetInstanceProcAddr icdLookup = reinterpret_cast< PFN_vk_icdGetInstanceProcAddr >( GetProcAddress( icd, "vk_icdGetInstanceProcAddr" ) );
+	if ( icdLookup == NULL ) {
+		DebuggerPrintf( "ProcAddrBenchmark: vk_icdGetInstanceProcAddr is not exported\n" );
+		return;
+	}
+
+	const uint32 ITERATIONS = 200000;
+	uint32 chainResolved;
+	uint32 tableResolved;
+	//Warm both paths once so neither run pays for cold caches
+	ProcAddrBenchmark_Time( LegacyChain_GetInstanceProcAddr, 1000, &chainResolved );
+	ProcAddrBenchmark_Time( icdLookup, 1000, &tableResolved );
+	double chainNs = ProcAddrBenchmark_Time( LegacyChain_GetInstanceProcAddr, ITERATIONS, &chainResolved );
+	double tableNs = ProcAddrBenchmark_Time( icdLookup, ITERATIONS, &tableResolved );
+	DebuggerPrintf( "ProcAddrBenchmark: %u names x %u iterations\n", ( uint32 )ARRAY_LENGTH( benchmarkNames ), ITERATIONS );
+	DebuggerPrintf( "  strcmp chain: %7.2f ns/lookup (%u resolved)\n", chainNs, chainResolved );
+	DebuggerPrintf( "  hashed table: %7.2f ns/lookup (%u resolved)\n", tableNs, tableResolved );
+	DebuggerPrintf( "  speedup:      %7.2fx\n", chainNs / tableNs );
+}
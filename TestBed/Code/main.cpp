@@ -29,7 +29,14 @@ void DebuggerPrintf( const char * fmt, ... ) {
 	OutputDebugString( buff );
 }
 
+void ProcAddrBenchmark_Run();
+
 int WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd ) {
+	if ( strstr( lpCmdLine, "-benchProcAddr" ) != NULL ) {
+		ProcAddrBenchmark_Run();
+		return 0;
+	}
+
 	WNDCLASSEX windowClass;
 	memset( &windowClass, 0, sizeof( windowClass ) );
 	windowClass.cbSize = sizeof( windowClass );